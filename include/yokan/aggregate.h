@@ -0,0 +1,98 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#ifndef __YOKAN_AGGREGATE_H
+#define __YOKAN_AGGREGATE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <yokan/common.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/**
+ * @brief Maximum number of bins of a histogram.
+ */
+#define YOKAN_AGGREGATE_MAX_BINS 64
+
+/**
+ * @brief Type of the field aggregated by yk_aggregate and yk_doc_aggregate.
+ * - YOKAN_FIELD_JSON: the field is a number at a path in JSON values or
+ *   documents (see YOKAN_MODE_JSON_FILTER for the syntax of paths; the
+ *   empty path designates the whole value). Entries whose field is
+ *   missing or is not a number are counted but not aggregated.
+ * - YOKAN_FIELD_INT32 ... YOKAN_FIELD_DOUBLE: the field is a binary
+ *   number, in the server's byte order, at a fixed offset of the values
+ *   or documents. Entries that are too small to hold the field are
+ *   counted but not aggregated.
+ */
+typedef enum yk_field_type {
+    YOKAN_FIELD_JSON,
+    YOKAN_FIELD_INT32,
+    YOKAN_FIELD_INT64,
+    YOKAN_FIELD_UINT32,
+    YOKAN_FIELD_UINT64,
+    YOKAN_FIELD_FLOAT,
+    YOKAN_FIELD_DOUBLE
+} yk_field_type_t;
+
+/**
+ * @brief Description of the field to aggregate and of the histogram to
+ * compute (hist_bins = 0 to skip the histogram). The histogram splits
+ * [hist_min, hist_max) into hist_bins bins of equal width.
+ */
+typedef struct yk_aggregate_spec {
+    yk_field_type_t type;
+    const char*     field;     /* path of a YOKAN_FIELD_JSON field */
+    size_t          offset;    /* offset of a binary field */
+    double          hist_min;
+    double          hist_max;
+    size_t          hist_bins; /* at most YOKAN_AGGREGATE_MAX_BINS */
+} yk_aggregate_spec_t;
+
+/**
+ * @brief Result of an aggregation. Partial results computed with the
+ * same specification (e.g. on several databases) can be combined with
+ * yk_aggregate_merge.
+ */
+typedef struct yk_aggregate {
+    uint64_t count;          /* number of entries that passed the filter */
+    uint64_t num_values;     /* number of entries with a valid field */
+    double   sum;            /* sum of the fields */
+    double   min;            /* smallest field (+inf if num_values == 0) */
+    double   max;            /* largest field (-inf if num_values == 0) */
+    uint64_t hist_underflow; /* number of fields < hist_min */
+    uint64_t hist_overflow;  /* number of fields >= hist_max */
+    size_t   hist_bins;
+    uint64_t hist[YOKAN_AGGREGATE_MAX_BINS];
+} yk_aggregate_t;
+
+/**
+ * @brief Initializes an empty aggregate with the specified number
+ * of histogram bins.
+ *
+ * @param[out] agg Aggregate to initialize.
+ * @param[in] hist_bins Number of histogram bins.
+ */
+void yk_aggregate_init(yk_aggregate_t* agg, size_t hist_bins);
+
+/**
+ * @brief Merges the partial aggregate src into dst.
+ *
+ * @param[inout] dst Aggregate to merge into.
+ * @param[in] src Aggregate to merge.
+ *
+ * @return YOKAN_SUCCESS, or YOKAN_ERR_INVALID_ARGS if the two aggregates
+ * do not have the same number of histogram bins.
+ */
+yk_return_t yk_aggregate_merge(yk_aggregate_t* dst, const yk_aggregate_t* src);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif
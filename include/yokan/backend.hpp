@@ -18,6 +18,7 @@
 #include <yokan/usermem.hpp>
 #include <yokan/filters.hpp>
 #include <yokan/migration.hpp>
+#include <yokan/doc-index.hpp>
 
 template <typename T> class __YOKANBackendRegistration;
 
@@ -94,6 +95,45 @@ constexpr auto KeyNotFound = YOKAN_KEY_NOT_FOUND;
  */
 constexpr auto BufTooSmall = YOKAN_SIZE_TOO_SMALL;
 
+/**
+ * @brief A ScanCursor represents a position in a sorted database,
+ * obtained using DatabaseInterface::openCursor, that can be kept
+ * alive across calls so that consecutive batches of a scan resume
+ * where the previous batch stopped instead of seeking again.
+ *
+ * A ScanCursor is not thread-safe: calls to next must be serialized
+ * by the caller. It must be destroyed before the database it was
+ * opened on.
+ */
+class ScanCursor {
+
+    public:
+
+    using Callback = std::function<Status(const UserMem& key, const UserMem& val)>;
+
+    virtual ~ScanCursor() = default;
+
+    /**
+     * @brief Call func on up to max key/value pairs that pass the
+     * cursor's filter, advancing the cursor. The key and value passed
+     * to func are those stored in the database (the filter's keyCopy
+     * and valCopy functions have not been applied).
+     *
+     * If func returns something other than Status::OK, the cursor
+     * stays on the pair that was passed to func (the next call will
+     * start with it) and next returns the status returned by func.
+     *
+     * @param [in] max Max number of key/value pairs to produce.
+     * @param [in] ignore_values Whether to pass empty values to func.
+     * @param [in] func Function to call on each key/value pair.
+     * @param [out] done Set to true if the end of the scan was reached.
+     *
+     * @return Status.
+     */
+    virtual Status next(uint64_t max, bool ignore_values,
+                        const Callback& func, bool& done) = 0;
+};
+
 /**
  * @brief Abstract embedded database object.
  */
@@ -320,6 +360,28 @@ class DatabaseInterface {
         return Status::NotSupported;
     }
 
+    /**
+     * @brief Erase all the key/value pairs with a key in [fromKey, toKey),
+     * in lexicographic order of the keys, without listing them first.
+     * Backends should only implement this function if they can do so
+     * more efficiently than by erasing keys one by one (e.g. RocksDB's
+     * DeleteRange), and should return Status::NotSupported if their
+     * keys are not sorted in lexicographic order.
+     *
+     * @param [in] mode Mode.
+     * @param [in] fromKey First key of the range (included).
+     * @param [in] toKey Last key of the range (excluded).
+     *
+     * @return Status.
+     */
+    virtual Status eraseRange(int32_t mode, const UserMem& fromKey,
+                              const UserMem& toKey) {
+        (void)mode;
+        (void)fromKey;
+        (void)toKey;
+        return Status::NotSupported;
+    }
+
     /**
      * @brief This version of listKeys uses a single contiguous buffer
      * to hold all the keys. Their size is stored in the keySizes user-allocated
@@ -399,6 +461,27 @@ class DatabaseInterface {
         return Status::NotSupported;
     }
 
+    /**
+     * @brief Open a ScanCursor positioned at fromKey (included if
+     * the mode has YOKAN_MODE_INCLUSIVE). The filter must remain
+     * valid for the lifetime of the cursor.
+     *
+     * The default implementation, for sorted backends, remembers the
+     * last key produced and relies on iter to resume from it. Backends
+     * whose iterators are costly to create should override it to keep
+     * their native iterator alive in the cursor.
+     *
+     * @param [in] mode Mode.
+     * @param [in] fromKey Starting key.
+     * @param [in] filter Key filter.
+     * @param [out] cursor Resulting cursor.
+     *
+     * @return Status.
+     */
+    virtual Status openCursor(int32_t mode, const UserMem& fromKey,
+                              const std::shared_ptr<KeyValueFilter>& filter,
+                              std::unique_ptr<ScanCursor>& cursor) const;
+
     /**
      * @brief Create a collection in the underlying database.
      *
@@ -477,6 +560,28 @@ class DatabaseInterface {
         return Status::NotSupported;
     }
 
+    /**
+     * @brief Reserve a range of count ids that docStore will never
+     * assign, so that the caller can fill it using docUpdate with
+     * YOKAN_MODE_UPDATE_NEW. The ids of the range that are never
+     * filled must behave like ids of erased documents.
+     *
+     * @param mode Mode
+     * @param name Collection name
+     * @param count Number of ids to reserve
+     * @param first_id First id of the range
+     *
+     * @return Status
+     */
+    virtual Status collReserveIDs(int32_t mode, const char* name,
+                                  size_t count, yk_id_t* first_id) {
+        (void)mode;
+        (void)name;
+        (void)count;
+        (void)first_id;
+        return Status::NotSupported;
+    }
+
     /**
      * @brief Get the size of document associated with ids.
      *
@@ -662,7 +767,9 @@ class DatabaseInterface {
      * @param max Max number of documents to list (0 to list everything).
      * @param from_id starting ID.
      * @param filter Document filter.
-     * @param func Function to call on each key.
+     * @param func Function to call on each document passing the filter.
+     * The document is passed as stored: the filter's docSizeFrom and
+     * docCopy (e.g. a projection) are applied by the caller.
      *
      * @return Status.
      */
@@ -679,6 +786,78 @@ class DatabaseInterface {
         return Status::NotSupported;
     }
 
+    /**
+     * @brief Create a secondary index on a field of the documents of
+     * a collection, indexing the documents it already contains.
+     *
+     * @param mode Mode.
+     * @param collection Collection.
+     * @param spec Definition of the index.
+     *
+     * @return Status (KeyExists if an index with the same name exists).
+     */
+    virtual Status collCreateIndex(int32_t mode, const char* collection,
+                                   const DocIndexSpec& spec) {
+        (void)mode;
+        (void)collection;
+        (void)spec;
+        return Status::NotSupported;
+    }
+
+    /**
+     * @brief Drop a secondary index of a collection.
+     *
+     * @param mode Mode.
+     * @param collection Collection.
+     * @param index Name of the index.
+     *
+     * @return Status (NotFound if the index does not exist).
+     */
+    virtual Status collDropIndex(int32_t mode, const char* collection,
+                                 const char* index) {
+        (void)mode;
+        (void)collection;
+        (void)index;
+        return Status::NotSupported;
+    }
+
+    /**
+     * @brief Find, using a secondary index, the documents whose indexed
+     * field is within [lower, upper) ([lower, upper] if YOKAN_MODE_INCLUSIVE
+     * is set). The ids are returned in index order, starting after the
+     * position given by after (or at lower if it is empty), and the extra
+     * ids are set to YOKAN_NO_MORE_DOCS. If documents were found, last is
+     * set to the position of the last one, from which a following query
+     * can resume.
+     *
+     * @param[in] collection Collection.
+     * @param[in] mode Mode.
+     * @param[in] index Name of the index.
+     * @param[in] lower Lower bound (nullptr for no lower bound).
+     * @param[in] upper Upper bound (nullptr for no upper bound).
+     * @param[in] after Position to resume after (empty to start at lower).
+     * @param[out] ids Resulting ids.
+     * @param[out] last Position of the last document found.
+     *
+     * @return Status.
+     */
+    virtual Status docQuery(const char* collection, int32_t mode,
+                            const char* index,
+                            const UserMem* lower, const UserMem* upper,
+                            const UserMem& after,
+                            BasicUserMem<yk_id_t>& ids,
+                            std::string& last) const {
+        (void)collection;
+        (void)mode;
+        (void)index;
+        (void)lower;
+        (void)upper;
+        (void)after;
+        (void)ids;
+        (void)last;
+        return Status::NotSupported;
+    }
+
     /**
      * @brief Set the provided unique_ptr to point to a MigrationHandle
      * that can be used by the provider to retrieve the files used by
@@ -691,6 +870,67 @@ class DatabaseInterface {
 
 };
 
+/**
+ * @brief ScanCursor used by the default implementation of
+ * DatabaseInterface::openCursor. It does not keep any backend
+ * state between calls, only the key at which to resume.
+ */
+class IterScanCursor : public ScanCursor {
+
+    public:
+
+    IterScanCursor(const DatabaseInterface& db, int32_t mode,
+                   const UserMem& fromKey,
+                   std::shared_ptr<KeyValueFilter> filter)
+    : m_db(db)
+    , m_mode(mode & ~YOKAN_MODE_INCLUSIVE)
+    , m_position(fromKey.data, fromKey.size)
+    , m_inclusive(mode & YOKAN_MODE_INCLUSIVE)
+    , m_filter(std::move(filter)) {}
+
+    Status next(uint64_t max, bool ignore_values,
+                const Callback& func, bool& done) override {
+        done = false;
+        if(max == 0) return Status::OK;
+        uint64_t count   = 0;
+        Status   refused = Status::OK;
+        // iter reads the start key while the callback updates m_position
+        auto from = m_position;
+        auto mode = m_inclusive ? (m_mode | YOKAN_MODE_INCLUSIVE) : m_mode;
+        auto status = m_db.iter(mode, max, UserMem{&from[0], from.size()},
+            m_filter, ignore_values,
+            [&](const UserMem& key, const UserMem& val) {
+                auto s = func(key, val);
+                m_position.assign(key.data, key.size);
+                m_inclusive = (s != Status::OK);
+                if(s != Status::OK) refused = s;
+                else count += 1;
+                return s;
+            });
+        if(refused != Status::OK) return refused;
+        if(status != Status::OK) return status;
+        done = count < max;
+        return Status::OK;
+    }
+
+    private:
+
+    const DatabaseInterface&        m_db;
+    int32_t                         m_mode;
+    std::string                     m_position;
+    bool                            m_inclusive;
+    std::shared_ptr<KeyValueFilter> m_filter;
+};
+
+inline Status DatabaseInterface::openCursor(
+        int32_t mode, const UserMem& fromKey,
+        const std::shared_ptr<KeyValueFilter>& filter,
+        std::unique_ptr<ScanCursor>& cursor) const {
+    if(!isSorted()) return Status::NotSupported;
+    cursor.reset(new IterScanCursor(*this, mode, fromKey, filter));
+    return Status::OK;
+}
+
 /**
  * @brief The DatabaseFactory is used by the provider to build
  * key/value store instances of various types.
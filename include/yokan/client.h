@@ -35,6 +35,94 @@ yk_return_t yk_client_init(margo_instance_id mid, yk_client_t* client);
  */
 yk_return_t yk_client_finalize(yk_client_t client);
 
+/**
+ * @brief Enables (or resizes) a cache of memory registrations in the
+ * client. When enabled, the bulk handles created to expose user buffers
+ * in put, get, exists, length, and erase operations are kept around and
+ * reused by subsequent operations that expose exactly the same buffers,
+ * avoiding the cost of registering memory on every call.
+ * A capacity of 0 disables the cache (the default).
+ *
+ * Only key and value buffers are cached. Arrays of sizes and flags
+ * are copied into memory owned by the cache rather than registered.
+ *
+ * Important: when the cache is enabled, the application must call
+ * yk_client_invalidate_registrations on any key or value buffer it
+ * has used in a Yokan operation before freeing it.
+ *
+ * @param[in] client YOKAN client
+ * @param[in] capacity Maximum number of registrations to keep
+ *
+ * @return YOKAN_SUCCESS or error code defined in common.h
+ */
+yk_return_t yk_client_set_registration_cache(yk_client_t client, size_t capacity);
+
+/**
+ * @brief Removes from the client's registration cache any registration
+ * overlapping the provided address range.
+ *
+ * @param[in] client YOKAN client
+ * @param[in] ptr Start of the address range
+ * @param[in] size Size of the address range
+ *
+ * @return YOKAN_SUCCESS or error code defined in common.h
+ */
+yk_return_t yk_client_invalidate_registrations(yk_client_t client,
+                                               const void* ptr,
+                                               size_t size);
+
+/**
+ * @brief Sets how the client reacts to a provider's admission control
+ * refusing an operation because it is overloaded: the operation, which
+ * was not executed, is retried up to max_retries times, waiting before each retry
+ * for a random time between 0 and a delay that starts at base_delay_ms
+ * and doubles after each retry, up to max_delay_ms. Once the retries are
+ * exhausted, YOKAN_ERR_BUSY or YOKAN_ERR_TRY_AGAIN is returned to the caller
+ * (right away with a max_retries of 0). These errors, when returned by the
+ * operation itself, are never retried. By default, operations are
+ * retried 10 times with delays from 1 to 500 milliseconds.
+ *
+ * @param[in] client YOKAN client
+ * @param[in] max_retries Maximum number of retries
+ * @param[in] base_delay_ms Initial maximum delay, in milliseconds
+ * @param[in] max_delay_ms Upper bound on the maximum delay, in milliseconds
+ *
+ * @return YOKAN_SUCCESS or error code defined in common.h
+ */
+yk_return_t yk_client_set_retry_policy(yk_client_t client,
+                                       unsigned max_retries,
+                                       double base_delay_ms,
+                                       double max_delay_ms);
+
+/**
+ * @brief Enables request tracing on the client: operations are sampled
+ * with the given rate (between 0 and 1) and the time they spend being
+ * forwarded, waiting for their response, and backing off is recorded,
+ * keeping at most max_requests requests in memory. The ID of a sampled
+ * request is sent to the provider, which (if its own tracing is enabled)
+ * traces the request as well. A sample_rate of 0 disables tracing.
+ *
+ * @param[in] client YOKAN client
+ * @param[in] sample_rate Fraction of the operations to trace
+ * @param[in] max_requests Maximum number of requests kept
+ *
+ * @return YOKAN_SUCCESS or error code defined in common.h
+ */
+yk_return_t yk_client_set_tracing(yk_client_t client,
+                                  double sample_rate,
+                                  size_t max_requests);
+
+/**
+ * @brief Writes the requests traced by the client in the given file,
+ * in the Chrome trace event format, and clears them.
+ *
+ * @param[in] client YOKAN client
+ * @param[in] filename File to write
+ *
+ * @return YOKAN_SUCCESS or error code defined in common.h
+ */
+yk_return_t yk_client_dump_trace(yk_client_t client, const char* filename);
+
 #ifdef __cplusplus
 }
 #endif
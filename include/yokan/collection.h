@@ -120,6 +120,91 @@ yk_return_t yk_collection_last_id(yk_database_handle_t dbh,
                                   int32_t mode,
                                   yk_id_t* id);
 
+/**
+ * @brief Reserve a contiguous range of count document ids, which
+ * yk_doc_store will never assign, so that the caller can store
+ * documents with these ids using yk_doc_update with
+ * YOKAN_MODE_UPDATE_NEW, in any order and without contending with
+ * other clients for the allocation of ids. Reserved ids that are never
+ * filled (e.g. because the caller gave up on its reservation) behave
+ * like ids of erased documents. Reservations are not tracked by the
+ * provider: the caller is responsible for not writing outside of its
+ * ranges, nor twice to the same new id concurrently.
+ *
+ * @param[in] dbh Database handle
+ * @param[in] collection Collection
+ * @param[in] mode Mode
+ * @param[in] count Number of ids to reserve (between 1 and the
+ *            provider's "max_reserved_ids", 1048576 by default)
+ * @param[out] first_id First id of the range [first_id, first_id+count)
+ *
+ * @return YOKAN_SUCCESS or error code defined in common.h
+ */
+yk_return_t yk_collection_reserve_ids(yk_database_handle_t dbh,
+                                      const char* collection,
+                                      int32_t mode,
+                                      size_t count,
+                                      yk_id_t* first_id);
+
+/**
+ * @brief Definition of a secondary index. The indexed field is described
+ * as in yk_aggregate_spec_t, except that JSON fields may also be strings
+ * (numbers sort before strings, and strings are compared by their raw
+ * JSON text). Alternatively, extractor may designate a function
+ * ("<library>:<function>") loaded by the provider, with the signature
+ *
+ *     size_t fn(const void* doc, size_t docsize, void* key, size_t max_ksize)
+ *
+ * which copies into key the key under which the document is indexed and
+ * returns its size (0 if the document should not be indexed, or a size
+ * larger than max_ksize to be called again with a larger buffer). Keys
+ * are compared as strings of bytes.
+ */
+typedef struct yk_index_spec {
+    yk_field_type_t type;
+    const char*     field;     /* path of a YOKAN_FIELD_JSON field */
+    size_t          offset;    /* offset of a binary field */
+    const char*     extractor; /* "<library>:<function>", or NULL */
+} yk_index_spec_t;
+
+/**
+ * @brief Create a secondary index on a field of the documents of the
+ * collection, indexing the documents it already contains. The index
+ * is then updated by yk_doc_store, yk_doc_update, and yk_doc_erase,
+ * and can be queried with yk_doc_query. Indexes are only supported
+ * by backends that keep keys sorted.
+ *
+ * @param[in] dbh Database handle
+ * @param[in] collection Collection name (null-terminated)
+ * @param[in] mode Mode
+ * @param[in] name Name of the index (null-terminated)
+ * @param[in] spec Definition of the index
+ *
+ * @return YOKAN_SUCCESS or error code defined in common.h
+ * (YOKAN_ERR_KEY_EXISTS if the index already exists).
+ */
+yk_return_t yk_collection_create_index(yk_database_handle_t dbh,
+                                       const char* collection,
+                                       int32_t mode,
+                                       const char* name,
+                                       const yk_index_spec_t* spec);
+
+/**
+ * @brief Drop a secondary index of the collection.
+ *
+ * @param[in] dbh Database handle
+ * @param[in] collection Collection name (null-terminated)
+ * @param[in] mode Mode
+ * @param[in] name Name of the index (null-terminated)
+ *
+ * @return YOKAN_SUCCESS or error code defined in common.h
+ * (YOKAN_ERR_KEY_NOT_FOUND if the index does not exist).
+ */
+yk_return_t yk_collection_drop_index(yk_database_handle_t dbh,
+                                     const char* collection,
+                                     int32_t mode,
+                                     const char* name);
+
 /**
  * @brief Store a document into the collection.
  *
@@ -229,6 +314,31 @@ yk_return_t yk_doc_load(yk_database_handle_t dbh,
                         void* data,
                         size_t* size);
 
+/**
+ * @brief Same as yk_doc_load but applies a filter to the document
+ * (see yk_doc_load_packed_filtered). YOKAN_ERR_KEY_NOT_FOUND is
+ * returned if the document does not pass the filter.
+ *
+ * @param[in] dbh Database handle
+ * @param[in] collection Collection
+ * @param[in] mode Mode
+ * @param[int] id Record id
+ * @param[in] filter Filter
+ * @param[in] filter_size Size of the filter
+ * @param[out] data Buffer to load the document
+ * @param[inout] size Size of the buffer (in) / document (out)
+ *
+ * @return YOKAN_SUCCESS or error code defined in common.h
+ */
+yk_return_t yk_doc_load_filtered(yk_database_handle_t dbh,
+                                 const char* collection,
+                                 int32_t mode,
+                                 yk_id_t id,
+                                 const void* filter,
+                                 size_t filter_size,
+                                 void* data,
+                                 size_t* size);
+
 /**
  * @brief Load multiple documents from the collection.
  *
@@ -274,6 +384,40 @@ yk_return_t yk_doc_load_packed(yk_database_handle_t dbh,
                                 void* documents,
                                 size_t* rsizes);
 
+/**
+ * @brief Same as yk_doc_load_packed but applies a filter to the
+ * documents, interpreted according to the mode as in yk_doc_list.
+ * Documents that do not pass the filter are reported as not found
+ * (YOKAN_KEY_NOT_FOUND size), and the others are loaded as transformed
+ * by the filter, e.g. projected onto some of their fields by a
+ * YOKAN_MODE_JSON_FILTER query with "select" or "range". The buffer
+ * only needs to be large enough for the transformed documents.
+ * An empty filter loads the documents as stored.
+ *
+ * @param[in] dbh Database handle
+ * @param[in] collection Collection
+ * @param[in] mode Mode
+ * @param[in] count Number of documents to load
+ * @param[in] ids Record ids
+ * @param[in] filter Filter
+ * @param[in] filter_size Size of the filter
+ * @param[in] rbufsize Size of the buffer
+ * @param[out] documents Buffer to load the documents
+ * @param[out] rsizes Sizes of the documents
+ *
+ * @return YOKAN_SUCCESS or error code defined in common.h
+ */
+yk_return_t yk_doc_load_packed_filtered(yk_database_handle_t dbh,
+                                         const char* collection,
+                                         int32_t mode,
+                                         size_t count,
+                                         const yk_id_t* ids,
+                                         const void* filter,
+                                         size_t filter_size,
+                                         size_t rbufsize,
+                                         void* documents,
+                                         size_t* rsizes);
+
 /**
  * @brief Low-level load operation based on a bulk handle.
  * This function will take the data in [offset, offset+size[
@@ -342,6 +486,31 @@ yk_return_t yk_doc_fetch(yk_database_handle_t dbh,
                          yk_document_callback_t cb,
                          void* uargs);
 
+/**
+ * @brief Same as yk_doc_fetch but applies a filter to the document
+ * (see yk_doc_load_packed_filtered). The callback is called with a
+ * YOKAN_KEY_NOT_FOUND size if the document does not pass the filter.
+ *
+ * @param[in] dbh Database handle
+ * @param[in] collection Collection
+ * @param[in] mode Mode
+ * @param[in] id Record id
+ * @param[in] filter Filter
+ * @param[in] filter_size Size of the filter
+ * @param[in] cb Callback to call on the document
+ * @param[in] uargs Arguments for the callback
+ *
+ * @return YOKAN_SUCCESS or error code defined in common.h
+ */
+yk_return_t yk_doc_fetch_filtered(yk_database_handle_t dbh,
+                                  const char* collection,
+                                  int32_t mode,
+                                  yk_id_t id,
+                                  const void* filter,
+                                  size_t filter_size,
+                                  yk_document_callback_t cb,
+                                  void* uargs);
+
 /**
  * @brief Options to provide to yk_doc_fetch_multi.
  */
@@ -376,6 +545,34 @@ yk_return_t yk_doc_fetch_multi(yk_database_handle_t dbh,
                                void* uargs,
                                const yk_doc_fetch_options_t* options);
 
+/**
+ * @brief Same as yk_doc_fetch_multi but applies a filter to the
+ * documents (see yk_doc_load_packed_filtered).
+ *
+ * @param[in] dbh Database handle
+ * @param[in] collection Collection
+ * @param[in] mode Mode
+ * @param[in] count Number of ids
+ * @param[in] ids Record ids
+ * @param[in] filter Filter
+ * @param[in] filter_size Size of the filter
+ * @param[in] cb Callback to call on the document
+ * @param[in] uargs Arguments for the callback
+ * @param[in] options Extra options
+ *
+ * @return YOKAN_SUCCESS or error code defined in common.h
+ */
+yk_return_t yk_doc_fetch_multi_filtered(yk_database_handle_t dbh,
+                                        const char* collection,
+                                        int32_t mode,
+                                        size_t count,
+                                        const yk_id_t* ids,
+                                        const void* filter,
+                                        size_t filter_size,
+                                        yk_document_callback_t cb,
+                                        void* uargs,
+                                        const yk_doc_fetch_options_t* options);
+
 /**
  * @brief Fetch documents from the collection, calling a function
  * on the bulk handle containing the documents. This function will not pull
@@ -658,6 +855,41 @@ yk_return_t yk_doc_list_bulk(yk_database_handle_t dbh,
                              bool packed,
                              size_t count);
 
+/**
+ * @brief Same as yk_doc_list_packed with a scan budget and a resume
+ * token (see yk_list_keys_packed_budgeted). The token needs a capacity
+ * of at least sizeof(yk_id_t); when it is not empty, start_id is ignored.
+ *
+ * @param[in] dbh Database handle.
+ * @param[in] collection Collection.
+ * @param[in] mode Mode.
+ * @param[in] start_id Starting document id.
+ * @param[in] filter Filter.
+ * @param[in] filter_size Filter size.
+ * @param[in] max Maximum number of documents to list.
+ * @param[out] ids Resulting ids.
+ * @param[in] bufsize Size of the document buffer.
+ * @param[out] docs Document buffer.
+ * @param[out] doc_sizes Resulting document sizes.
+ * @param[in] budget Scan budget (may be NULL).
+ * @param[inout] token Resume token (may be NULL).
+ *
+ * @return YOKAN_SUCCESS, YOKAN_ERR_INCOMPLETE, or corresponding error code.
+ */
+yk_return_t yk_doc_list_packed_budgeted(yk_database_handle_t dbh,
+                                        const char* collection,
+                                        int32_t mode,
+                                        yk_id_t start_id,
+                                        const void* filter,
+                                        size_t filter_size,
+                                        size_t max,
+                                        yk_id_t* ids,
+                                        size_t bufsize,
+                                        void* docs,
+                                        size_t* doc_sizes,
+                                        const yk_scan_budget_t* budget,
+                                        yk_resume_token_t* token);
+
 /**
  * @brief Options to pass to yk_doc_iter.
  */
@@ -725,6 +957,131 @@ yk_return_t yk_doc_iter_bulk(yk_database_handle_t dbh,
                              void* uargs,
                              const yk_doc_iter_options_t* options);
 
+/**
+ * @brief Aggregates a numeric field of the documents starting at start_id
+ * (inclusive) that pass the filter, computing their count, sum, min, max,
+ * and histogram inside the provider (see yk_aggregate in database.h).
+ *
+ * @param[in] dbh Database handle.
+ * @param[in] collection Collection
+ * @param[in] mode Mode
+ * @param[in] start_id Starting document id
+ * @param[in] filter Filter content
+ * @param[in] filter_size Filter size
+ * @param[in] spec Field to aggregate and histogram to compute
+ * @param[out] result Aggregate
+ *
+ * @return YOKAN_SUCCESS or error code defined in common.h
+ */
+yk_return_t yk_doc_aggregate(yk_database_handle_t dbh,
+                             const char* collection,
+                             int32_t mode,
+                             yk_id_t start_id,
+                             const void* filter,
+                             size_t filter_size,
+                             const yk_aggregate_spec_t* spec,
+                             yk_aggregate_t* result);
+
+/**
+ * @brief Position of a yk_doc_query in its index, used to retrieve the
+ * results of a query page by page. A position of size 0 starts at the
+ * lower bound of the query. After a query that found documents, the
+ * position holds the index entry of the last one, so that passing it to
+ * the next query (with the same bounds) resumes right after it.
+ */
+typedef struct yk_query_position {
+    void*  data;     /* buffer holding the position */
+    size_t size;     /* size of the position */
+    size_t capacity; /* size of the buffer */
+} yk_query_position_t;
+
+/**
+ * @brief Find, using a secondary index, up to max documents whose
+ * indexed field is within [lower, upper) ([lower, upper] if
+ * YOKAN_MODE_INCLUSIVE is set), returning their ids in index order
+ * (by indexed value, then by id) starting after position. A NULL (or
+ * empty) bound means no bound, and an equality query is done with
+ * lower = upper and YOKAN_MODE_INCLUSIVE.
+ * Bounds are given as they appear in the documents: the JSON text of a
+ * number or a string for a JSON field (e.g. "12" or "\"abc\""), the
+ * binary number for a binary field, or a key for an extractor.
+ * If fewer than max documents are found, the extra ids are set to
+ * YOKAN_NO_MORE_DOCS.
+ *
+ * If position is not NULL, it is updated as described for
+ * yk_query_position_t. If its buffer is too small for the new position,
+ * YOKAN_ERR_BUFFER_SIZE is returned and the position is left unchanged.
+ * A position takes at most 28 bytes for a number (JSON or binary), and
+ * 2*n+10 bytes for a JSON string of n characters or an extractor key of
+ * n bytes.
+ *
+ * Queries check each index entry against the current version of its
+ * document, so a document is only returned if it matches the bounds.
+ *
+ * @param[in] dbh Database handle
+ * @param[in] collection Collection
+ * @param[in] mode Mode
+ * @param[in] index Name of the index
+ * @param[in] lower Lower bound
+ * @param[in] lower_size Size of the lower bound
+ * @param[in] upper Upper bound
+ * @param[in] upper_size Size of the upper bound
+ * @param[inout] position Position in the index (may be NULL)
+ * @param[in] max Maximum number of ids to return
+ * @param[out] ids Ids of the documents found
+ *
+ * @return YOKAN_SUCCESS or error code defined in common.h
+ */
+yk_return_t yk_doc_query(yk_database_handle_t dbh,
+                         const char* collection,
+                         int32_t mode,
+                         const char* index,
+                         const void* lower,
+                         size_t lower_size,
+                         const void* upper,
+                         size_t upper_size,
+                         yk_query_position_t* position,
+                         size_t max,
+                         yk_id_t* ids);
+
+/**
+ * @brief Same as yk_doc_query but also returns the documents found,
+ * back to back in a single buffer (as yk_doc_list_packed). The sizes
+ * of the documents that do not fit in the buffer are set to
+ * YOKAN_SIZE_TOO_SMALL, and the extra sizes to YOKAN_NO_MORE_DOCS.
+ *
+ * @param[in] dbh Database handle
+ * @param[in] collection Collection
+ * @param[in] mode Mode
+ * @param[in] index Name of the index
+ * @param[in] lower Lower bound
+ * @param[in] lower_size Size of the lower bound
+ * @param[in] upper Upper bound
+ * @param[in] upper_size Size of the upper bound
+ * @param[inout] position Position in the index (may be NULL)
+ * @param[in] max Maximum number of documents to return
+ * @param[out] ids Ids of the documents found
+ * @param[in] bufsize Size of the document buffer
+ * @param[out] docs Buffer in which to receive documents
+ * @param[out] doc_sizes Document sizes
+ *
+ * @return YOKAN_SUCCESS or error code defined in common.h
+ */
+yk_return_t yk_doc_query_packed(yk_database_handle_t dbh,
+                                const char* collection,
+                                int32_t mode,
+                                const char* index,
+                                const void* lower,
+                                size_t lower_size,
+                                const void* upper,
+                                size_t upper_size,
+                                yk_query_position_t* position,
+                                size_t max,
+                                yk_id_t* ids,
+                                size_t bufsize,
+                                void* docs,
+                                size_t* doc_sizes);
+
 
 #ifdef __cplusplus
 }
@@ -102,11 +102,15 @@ typedef enum yk_return_t {
  * - YOKAN_MODE_IGNORE_DOCS: only return IDs of documents matching a filter.
  * - YOKAN_MODE_FILTER_VALUE: filter requires value to be provided.
  * - YOKAN_MODE_LIB_FILTER: filter is the name of a library and a function,
- *   separated by a column character.
+ *   separated by a column character. The built-in ":record:<query>" document
+ *   filter compares and projects the fields of fixed-size binary documents.
  * - YOKAN_MODE_NO_RDMA: use a version of the RPC that does not use RDMA for data
  *   transfers, when multiple underlying implementations of the RPC exists.
  * - YOKAN_MODE_UPDATE_NEW: allow yk_doc_update to create a document with the
  *   specified ID if it does not exist.
+ * - YOKAN_MODE_JSON_FILTER: interpret the filter as a JSON predicate over the
+ *   fields of JSON documents (or values), evaluated natively by the server,
+ *   or as a query that also projects the documents (see below).
  *
  * Important: not all backends support all modes.
  */
@@ -128,6 +132,37 @@ typedef enum yk_return_t {
 #define YOKAN_MODE_LIB_FILTER   0b0010000000000000
 #define YOKAN_MODE_NO_RDMA      0b0100000000000000
 #define YOKAN_MODE_UPDATE_NEW   0b1000000000000000
+#define YOKAN_MODE_JSON_FILTER  0b10000000000000000
+
+/**
+ * @brief Syntax of the filters used with YOKAN_MODE_JSON_FILTER.
+ *
+ * A predicate is a JSON object with a single entry among:
+ * - {"and": [P1, P2, ...]}, {"or": [P1, P2, ...]}, {"not": P}
+ * - {"exists": "path"}
+ * - {"eq": ["path", value]}, and likewise "ne", "lt", "le", "gt", "ge"
+ * - {"in": ["path", [value1, value2, ...]]}
+ *
+ * A path is a list of object fields and array indices separated by dots
+ * (e.g. "a.b.0.c"); the empty path designates the whole document.
+ * Comparisons are false when the field is missing or when its type
+ * differs from the value's type (numbers are compared as numbers, strings
+ * lexicographically, and objects and arrays only for equality), except
+ * "ne" which is true for an existing field of a different type.
+ *
+ * A filter is either a predicate or a query, i.e. an object with the
+ * following optional entries:
+ * - "where": a predicate the documents must match;
+ * - "select": an array of paths to project the documents onto. The result
+ *   is a flat JSON object mapping each path found to its value, e.g.
+ *   selecting "name" and "meta.i" produces {"name":"abc","meta.i":3};
+ * - "range": an [offset, length] pair projecting the (possibly binary)
+ *   documents onto these bytes, truncated to the document's size.
+ *   "range" cannot be used with "select".
+ *
+ * Example: {"where": {"gt": ["a.b", 3]}, "select": ["name"]}.
+ * An invalid filter makes the operation fail with YOKAN_ERR_INVALID_FILTER.
+ */
 
 /**
  * @brief Record when working with collections.
@@ -60,6 +60,34 @@ class Client {
         return Database(db, false);
     }
 
+    void setRegistrationCache(size_t capacity) const {
+        auto err = yk_client_set_registration_cache(m_client, capacity);
+        YOKAN_CONVERT_AND_THROW(err);
+    }
+
+    void invalidateRegistrations(const void* ptr, size_t size) const {
+        auto err = yk_client_invalidate_registrations(m_client, ptr, size);
+        YOKAN_CONVERT_AND_THROW(err);
+    }
+
+    void setRetryPolicy(unsigned max_retries,
+                        double base_delay_ms,
+                        double max_delay_ms) const {
+        auto err = yk_client_set_retry_policy(
+            m_client, max_retries, base_delay_ms, max_delay_ms);
+        YOKAN_CONVERT_AND_THROW(err);
+    }
+
+    void setTracing(double sample_rate, size_t max_requests = 100000) const {
+        auto err = yk_client_set_tracing(m_client, sample_rate, max_requests);
+        YOKAN_CONVERT_AND_THROW(err);
+    }
+
+    void dumpTrace(const std::string& filename) const {
+        auto err = yk_client_dump_trace(m_client, filename.c_str());
+        YOKAN_CONVERT_AND_THROW(err);
+    }
+
     auto handle() const {
         return m_client;
     }
@@ -41,6 +41,14 @@ class Collection {
         return last;
     }
 
+    yk_id_t reserve_ids(size_t count, int32_t mode = YOKAN_MODE_DEFAULT) const {
+        yk_id_t first;
+        auto err = yk_collection_reserve_ids(m_db.handle(), m_name.c_str(),
+                                             mode, count, &first);
+        YOKAN_CONVERT_AND_THROW(err);
+        return first;
+    }
+
     yk_id_t store(const void* doc, size_t docsize,
                   int32_t mode = YOKAN_MODE_DEFAULT) const {
         yk_id_t id;
@@ -108,6 +116,31 @@ class Collection {
         YOKAN_CONVERT_AND_THROW(err);
     }
 
+    void loadFiltered(yk_id_t id,
+                      const void* filter,
+                      size_t filter_size,
+                      void* data, size_t* size,
+                      int32_t mode = YOKAN_MODE_DEFAULT) const {
+        auto err = yk_doc_load_filtered(m_db.handle(), m_name.c_str(),
+                                        mode, id, filter, filter_size,
+                                        data, size);
+        YOKAN_CONVERT_AND_THROW(err);
+    }
+
+    void loadPackedFiltered(size_t count,
+                            const yk_id_t* ids,
+                            const void* filter,
+                            size_t filter_size,
+                            size_t bufsize,
+                            void* documents,
+                            size_t* docsizes,
+                            int32_t mode = YOKAN_MODE_DEFAULT) const {
+        auto err = yk_doc_load_packed_filtered(m_db.handle(), m_name.c_str(),
+                                               mode, count, ids, filter, filter_size,
+                                               bufsize, documents, docsizes);
+        YOKAN_CONVERT_AND_THROW(err);
+    }
+
     void loadBulk(size_t count,
                   const yk_id_t* ids,
                   hg_bulk_t data,
@@ -171,6 +204,30 @@ class Collection {
         YOKAN_CONVERT_AND_THROW(err);
     }
 
+    void fetchFiltered(yk_id_t id,
+                       const void* filter,
+                       size_t filter_size,
+                       const fetch_callback_type& cb,
+                       int32_t mode = YOKAN_MODE_DEFAULT) const {
+        auto err = yk_doc_fetch_filtered(m_db.handle(), m_name.c_str(), mode, id,
+                                         filter, filter_size, _fetch_dispatch, (void*)&cb);
+        YOKAN_CONVERT_AND_THROW(err);
+    }
+
+    void fetchMultiFiltered(size_t count,
+                            const yk_id_t* ids,
+                            const void* filter,
+                            size_t filter_size,
+                            const fetch_callback_type& cb,
+                            const yk_doc_fetch_options_t* options = nullptr,
+                            int32_t mode = YOKAN_MODE_DEFAULT) const {
+        auto err= yk_doc_fetch_multi_filtered(
+                m_db.handle(), m_name.c_str(),
+                mode, count, ids, filter, filter_size,
+                _fetch_dispatch, (void*)&cb, options);
+        YOKAN_CONVERT_AND_THROW(err);
+    }
+
     size_t length(yk_id_t id,
                   int32_t mode = YOKAN_MODE_DEFAULT) const {
         size_t size;
@@ -275,6 +332,26 @@ class Collection {
         YOKAN_CONVERT_AND_THROW(err);
     }
 
+    bool listPackedBudgeted(yk_id_t start_id,
+                            const void* filter,
+                            size_t filter_size,
+                            size_t max,
+                            yk_id_t* ids,
+                            size_t bufsize,
+                            void* docs,
+                            size_t* doc_sizes,
+                            const yk_scan_budget_t& budget,
+                            yk_resume_token_t& token,
+                            int32_t mode = YOKAN_MODE_DEFAULT) const {
+        auto err = yk_doc_list_packed_budgeted(m_db.handle(), m_name.c_str(),
+                               mode, start_id, filter, filter_size,
+                               max, ids, bufsize, docs, doc_sizes,
+                               &budget, &token);
+        if(err == YOKAN_ERR_INCOMPLETE) return false;
+        YOKAN_CONVERT_AND_THROW(err);
+        return true;
+    }
+
     void listBulk(yk_id_t from_id,
                   size_t filter_size,
                   hg_bulk_t data,
@@ -329,6 +406,58 @@ class Collection {
         YOKAN_CONVERT_AND_THROW(err);
     }
 
+    yk_aggregate_t aggregate(yk_id_t from_id,
+                             const void* filter,
+                             size_t filter_size,
+                             const yk_aggregate_spec_t& spec,
+                             int32_t mode = YOKAN_MODE_DEFAULT) const {
+        yk_aggregate_t result;
+        auto err = yk_doc_aggregate(m_db.handle(), m_name.c_str(),
+                                    mode, from_id, filter, filter_size,
+                                    &spec, &result);
+        YOKAN_CONVERT_AND_THROW(err);
+        return result;
+    }
+
+    void createIndex(const char* name,
+                     const yk_index_spec_t& spec,
+                     int32_t mode = YOKAN_MODE_DEFAULT) const {
+        auto err = yk_collection_create_index(m_db.handle(), m_name.c_str(),
+                                              mode, name, &spec);
+        YOKAN_CONVERT_AND_THROW(err);
+    }
+
+    void dropIndex(const char* name,
+                   int32_t mode = YOKAN_MODE_DEFAULT) const {
+        auto err = yk_collection_drop_index(m_db.handle(), m_name.c_str(),
+                                            mode, name);
+        YOKAN_CONVERT_AND_THROW(err);
+    }
+
+    void query(const char* index,
+               const void* lower, size_t lower_size,
+               const void* upper, size_t upper_size,
+               yk_query_position_t* position, size_t max, yk_id_t* ids,
+               int32_t mode = YOKAN_MODE_DEFAULT) const {
+        auto err = yk_doc_query(m_db.handle(), m_name.c_str(),
+                                mode, index, lower, lower_size,
+                                upper, upper_size, position, max, ids);
+        YOKAN_CONVERT_AND_THROW(err);
+    }
+
+    void queryPacked(const char* index,
+                     const void* lower, size_t lower_size,
+                     const void* upper, size_t upper_size,
+                     yk_query_position_t* position, size_t max, yk_id_t* ids,
+                     size_t bufsize, void* docs, size_t* doc_sizes,
+                     int32_t mode = YOKAN_MODE_DEFAULT) const {
+        auto err = yk_doc_query_packed(m_db.handle(), m_name.c_str(),
+                                       mode, index, lower, lower_size,
+                                       upper, upper_size, position, max, ids,
+                                       bufsize, docs, doc_sizes);
+        YOKAN_CONVERT_AND_THROW(err);
+    }
+
     private:
 
     Database    m_db;
@@ -10,6 +10,8 @@
 #include <yokan/collection.h>
 #include <yokan/cxx/exception.hpp>
 #include <vector>
+#include <string>
+#include <cstdlib>
 #include <functional>
 
 namespace yokan {
@@ -435,6 +437,30 @@ class Database {
         YOKAN_CONVERT_AND_THROW(err);
     }
 
+    /**
+     * @brief Returns false if the scan stopped because the budget
+     * was exhausted, in which case token can be used to resume it.
+     */
+    bool listKeysPackedBudgeted(
+            const void* from_key,
+            size_t from_ksize,
+            const void* filter,
+            size_t filter_size,
+            size_t count,
+            void* keys,
+            size_t keys_buf_size,
+            size_t* ksizes,
+            const yk_scan_budget_t& budget,
+            yk_resume_token_t& token,
+            int32_t mode = YOKAN_MODE_DEFAULT) const {
+        auto err = yk_list_keys_packed_budgeted(m_db, mode, from_key,
+            from_ksize, filter, filter_size, count, keys,
+            keys_buf_size, ksizes, &budget, &token);
+        if(err == YOKAN_ERR_INCOMPLETE) return false;
+        YOKAN_CONVERT_AND_THROW(err);
+        return true;
+    }
+
     void listKeysBulk(
             size_t from_ksize,
             size_t filter_size,
@@ -485,6 +511,30 @@ class Database {
         YOKAN_CONVERT_AND_THROW(err);
     }
 
+    bool listKeyValsPackedBudgeted(
+            const void* from_key,
+            size_t from_ksize,
+            const void* filter,
+            size_t filter_size,
+            size_t count,
+            void* keys,
+            size_t keys_buf_size,
+            size_t* ksizes,
+            void* vals,
+            size_t vals_buf_size,
+            size_t* vsizes,
+            const yk_scan_budget_t& budget,
+            yk_resume_token_t& token,
+            int32_t mode = YOKAN_MODE_DEFAULT) const {
+        auto err = yk_list_keyvals_packed_budgeted(m_db, mode, from_key,
+            from_ksize, filter, filter_size, count, keys,
+            keys_buf_size, ksizes, vals, vals_buf_size, vsizes,
+            &budget, &token);
+        if(err == YOKAN_ERR_INCOMPLETE) return false;
+        YOKAN_CONVERT_AND_THROW(err);
+        return true;
+    }
+
     void listKeyValsBulk(
             size_t from_ksize,
             size_t filter_size,
@@ -540,6 +590,63 @@ class Database {
         YOKAN_CONVERT_AND_THROW(err);
     }
 
+    yk_cursor_id_t openCursor(
+            const void* from_key,
+            size_t from_ksize,
+            const void* filter,
+            size_t filter_size,
+            int32_t mode = YOKAN_MODE_DEFAULT) const {
+        yk_cursor_id_t cursor;
+        auto err = yk_cursor_open(m_db, mode, from_key, from_ksize,
+                                  filter, filter_size, &cursor);
+        YOKAN_CONVERT_AND_THROW(err);
+        return cursor;
+    }
+
+    bool cursorNextPacked(
+            yk_cursor_id_t cursor,
+            size_t count,
+            void* keys,
+            size_t keys_buf_size,
+            size_t* ksizes,
+            void* vals = nullptr,
+            size_t vals_buf_size = 0,
+            size_t* vsizes = nullptr) const {
+        bool done = false;
+        auto err = yk_cursor_next_packed(m_db, cursor, count,
+            keys, keys_buf_size, ksizes, vals, vals_buf_size, vsizes, &done);
+        YOKAN_CONVERT_AND_THROW(err);
+        return done;
+    }
+
+    void closeCursor(yk_cursor_id_t cursor) const {
+        auto err = yk_cursor_close(m_db, cursor);
+        YOKAN_CONVERT_AND_THROW(err);
+    }
+
+    yk_aggregate_t aggregate(
+            const void* from_key,
+            size_t from_ksize,
+            const void* filter,
+            size_t filter_size,
+            const yk_aggregate_spec_t& spec,
+            int32_t mode = YOKAN_MODE_DEFAULT) const {
+        yk_aggregate_t result;
+        auto err = yk_aggregate(m_db, mode, from_key, from_ksize,
+                                filter, filter_size, &spec, &result);
+        YOKAN_CONVERT_AND_THROW(err);
+        return result;
+    }
+
+    std::string stats() const {
+        char* stats = nullptr;
+        auto err = yk_get_stats(m_db, &stats);
+        YOKAN_CONVERT_AND_THROW(err);
+        auto result = std::string{stats};
+        free(stats);
+        return result;
+    }
+
     void createCollection(const char* name,
                           int32_t mode = YOKAN_MODE_DEFAULT) const {
         auto err = yk_collection_create(m_db, name, mode);
@@ -36,9 +36,11 @@ class Provider {
              remi_client_t remi_client=nullptr,
              remi_provider_t remi_provider=nullptr) {
         m_mid = mid;
-        struct yk_provider_args args = {
-            pool, cache, { remi_client, remi_provider }
-        };
+        struct yk_provider_args args = YOKAN_PROVIDER_ARGS_INIT;
+        args.pool            = pool;
+        args.cache           = cache;
+        args.remi.client     = remi_client;
+        args.remi.provider   = remi_provider;
         auto err = yk_provider_register(mid, provider_id, config, &args, &m_provider);
         YOKAN_CONVERT_AND_THROW(err);
         margo_provider_push_finalize_callback(
@@ -68,6 +70,18 @@ class Provider {
         return result;
     }
 
+    void dumpTrace(const char* filename) const {
+        auto err = yk_provider_dump_trace(m_provider, filename);
+        YOKAN_CONVERT_AND_THROW(err);
+    }
+
+    std::string getStats() const {
+        char* stats = yk_provider_get_stats(m_provider);
+        auto result = std::string{stats ? stats : ""};
+        free(stats);
+        return result;
+    }
+
     private:
 
     static void finalizeCallback(void* arg) {
@@ -10,6 +10,7 @@
 #include <margo.h>
 #include <yokan/common.h>
 #include <yokan/client.h>
+#include <yokan/aggregate.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -21,6 +22,14 @@ typedef struct yk_database_handle *yk_database_handle_t;
 /**
  * @brief Type of callback used by the fetch and iter functions.
  *
+ * If the provider is configured with a "back_rpc_window" larger than 1,
+ * several batches may be in flight at once, and callbacks from different
+ * batches may run concurrently and in any order (with or without a pool
+ * in the options). The callback must then be thread-safe and should rely
+ * on the index rather than on the order of invocation to identify the
+ * key/value pair. With the default window of 1, batches are processed
+ * one after the other.
+ *
  * @param void* User-provided arguments.
  * @param size_t Index of the key/value pair (if fetching multiple).
  * @param const void* Key data.
@@ -89,6 +98,42 @@ yk_return_t yk_database_handle_ref_incr(
  */
 yk_return_t yk_database_handle_release(yk_database_handle_t handle);
 
+/**
+ * @brief Set the payload size (in bytes) under which the packed and multi
+ * variants of put, get, exists, length, and erase will send their data
+ * inline in the RPC instead of exposing it for RDMA. By default this
+ * threshold is derived from the eager buffer size of the underlying
+ * Mercury class when the handle is created. A threshold of 0 disables
+ * the inline path (unless YOKAN_MODE_NO_RDMA is used explicitly).
+ *
+ * @param[in] handle database handle
+ * @param[in] threshold payload size threshold
+ *
+ * @return YOKAN_SUCCESS or error code defined in common.h
+ */
+yk_return_t yk_database_handle_set_eager_threshold(
+        yk_database_handle_t handle,
+        size_t threshold);
+
+/**
+ * @brief Retrieve the payload size threshold used by the database handle
+ * to choose between inline and RDMA transfers, as well as the number of
+ * operations that have been sent either way. Any NULL pointer will be
+ * ignored.
+ *
+ * @param[in] handle database handle
+ * @param[out] threshold payload size threshold
+ * @param[out] num_eager number of operations sent inline
+ * @param[out] num_rdma number of operations sent using RDMA
+ *
+ * @return YOKAN_SUCCESS or error code defined in common.h
+ */
+yk_return_t yk_database_handle_get_eager_stats(
+        yk_database_handle_t handle,
+        size_t* threshold,
+        uint64_t* num_eager,
+        uint64_t* num_rdma);
+
 /**
  * @brief Get the number of key/val pairs stored in the database.
  *
@@ -583,7 +628,7 @@ yk_return_t yk_fetch(yk_database_handle_t dbh,
 typedef struct yk_fetch_options {
     ABT_pool pool;       /* pool in which to run the callback */
     unsigned batch_size; /* value are sent back in batches of this size */
-} yk_fetch_options_t;
+} yk_fetch_options_t; /* see yk_keyvalue_callback_t for callback ordering */
 
 /**
  * @brief Packed version of yk_fetch meant to fetch multiple values at once
@@ -972,11 +1017,110 @@ yk_return_t yk_list_keyvals_bulk(yk_database_handle_t dbh,
                                  bool packed,
                                  size_t count);
 
+/**
+ * @brief Limits on the work a provider may do for a single list
+ * operation. A value of 0 means no limit.
+ */
+typedef struct yk_scan_budget {
+    uint64_t max_examined; /* maximum number of entries examined */
+    uint64_t max_time_us;  /* maximum time spent scanning, in microseconds */
+} yk_scan_budget_t;
+
+/**
+ * @brief Opaque token used to resume a list operation that stopped
+ * because it exhausted its budget. The caller provides the buffer
+ * (data, capacity); size is the size of the token currently held,
+ * 0 meaning that there is nothing to resume from.
+ */
+typedef struct yk_resume_token {
+    void*  data;
+    size_t capacity;
+    size_t size;
+} yk_resume_token_t;
+
+/**
+ * @brief Same as yk_list_keys_packed but the provider stops scanning
+ * once the budget is exhausted, even if fewer than count keys were found.
+ * In that case, the keys found so far are returned (the remaining key
+ * sizes being set to YOKAN_NO_MORE_KEYS), the token is filled and the
+ * function returns YOKAN_ERR_INCOMPLETE. Calling the function again with
+ * the same token resumes the scan (from_key is then ignored). When the
+ * scan completes, YOKAN_SUCCESS is returned and the token's size is set to 0.
+ *
+ * If the token's capacity is too small, YOKAN_ERR_BUFFER_SIZE is returned.
+ * Budgets are only supported by backends that store keys in order.
+ *
+ * @param[in] dbh Database handle.
+ * @param[in] mode 0 or bitwise "or" of YOKAN_MODE_* flags.
+ * @param[in] from_key Starting key.
+ * @param[in] from_ksize Starting key size.
+ * @param[in] filter Key filter.
+ * @param[in] filter_size Filter size.
+ * @param[in] count Max keys to read.
+ * @param[out] keys Buffer to hold keys.
+ * @param[in] keys_buf_size Size of the buffer to hold keys.
+ * @param[out] ksizes Array of key sizes.
+ * @param[in] budget Scan budget (may be NULL).
+ * @param[inout] token Resume token (may be NULL).
+ *
+ * @return YOKAN_SUCCESS, YOKAN_ERR_INCOMPLETE, or corresponding error code.
+ */
+yk_return_t yk_list_keys_packed_budgeted(yk_database_handle_t dbh,
+                                         int32_t mode,
+                                         const void* from_key,
+                                         size_t from_ksize,
+                                         const void* filter,
+                                         size_t filter_size,
+                                         size_t count,
+                                         void* keys,
+                                         size_t keys_buf_size,
+                                         size_t* ksizes,
+                                         const yk_scan_budget_t* budget,
+                                         yk_resume_token_t* token);
+
+/**
+ * @brief Same as yk_list_keyvals_packed with a scan budget and
+ * a resume token (see yk_list_keys_packed_budgeted).
+ *
+ * @param[in] dbh Database handle.
+ * @param[in] mode 0 or bitwise "or" of YOKAN_MODE_* flags.
+ * @param[in] from_key Starting key.
+ * @param[in] from_ksize Starting key size.
+ * @param[in] filter Key filter.
+ * @param[in] filter_size Filter size.
+ * @param[in] count Max keys to read.
+ * @param[out] keys Buffer to hold keys.
+ * @param[in] keys_buf_size Size of the buffer to hold keys.
+ * @param[out] ksizes Array of key sizes.
+ * @param[out] values Buffer to hold values.
+ * @param[in] vals_buf_size Size of the buffer to hold values.
+ * @param[out] vsizes Array of value sizes.
+ * @param[in] budget Scan budget (may be NULL).
+ * @param[inout] token Resume token (may be NULL).
+ *
+ * @return YOKAN_SUCCESS, YOKAN_ERR_INCOMPLETE, or corresponding error code.
+ */
+yk_return_t yk_list_keyvals_packed_budgeted(yk_database_handle_t dbh,
+                                            int32_t mode,
+                                            const void* from_key,
+                                            size_t from_ksize,
+                                            const void* filter,
+                                            size_t filter_size,
+                                            size_t count,
+                                            void* keys,
+                                            size_t keys_buf_size,
+                                            size_t* ksizes,
+                                            void* values,
+                                            size_t vals_buf_size,
+                                            size_t* vsizes,
+                                            const yk_scan_budget_t* budget,
+                                            yk_resume_token_t* token);
+
 typedef struct yk_iter_options {
     unsigned batch_size;    /* how many items to receive at once */
     ABT_pool pool;          /* pool in which to execute the callback */
     bool     ignore_values; /* ignore the values if set to true */
-} yk_iter_options_t;
+} yk_iter_options_t; /* see yk_keyvalue_callback_t for callback ordering */
 
 /**
  * @brief Iterate up to max key/value pairs from from_key (included if
@@ -1013,6 +1157,125 @@ yk_return_t yk_iter(yk_database_handle_t dbh,
                     void* uargs,
                     const yk_iter_options_t* options);
 
+/**
+ * @brief Identifier of a scan cursor opened on a provider.
+ */
+typedef uint64_t yk_cursor_id_t;
+
+/**
+ * @brief Open a scan cursor on the provider, starting at from_key
+ * (included if inclusive is set in the mode) and filtering keys if
+ * a filter is provided. The provider keeps the cursor (and, depending
+ * on the backend, the underlying database iterator) alive between calls
+ * to yk_cursor_next_packed, so that each batch resumes where the previous
+ * one stopped instead of seeking from a start key again.
+ *
+ * The cursor is leased: the provider discards it if it is not used for
+ * longer than the lease timeout set in its configuration, after which
+ * yk_cursor_next_packed and yk_cursor_close return YOKAN_ERR_EXPIRED.
+ *
+ * @param[in] dbh Database handle.
+ * @param[in] mode 0 or bitwise "or" of YOKAN_MODE_* flags.
+ * @param[in] from_key Starting key.
+ * @param[in] from_ksize Starting key size.
+ * @param[in] filter Key filter.
+ * @param[in] filter_size Filter size.
+ * @param[out] cursor Resulting cursor id.
+ *
+ * @return YOKAN_SUCCESS or corresponding error code.
+ */
+yk_return_t yk_cursor_open(yk_database_handle_t dbh,
+                           int32_t mode,
+                           const void* from_key,
+                           size_t from_ksize,
+                           const void* filter,
+                           size_t filter_size,
+                           yk_cursor_id_t* cursor);
+
+/**
+ * @brief Read the next batch of up to count key/value pairs from the
+ * cursor into contiguous buffers, as yk_list_keyvals_packed would.
+ * Entries of ksizes (and vsizes) past the last pair read are set to
+ * YOKAN_NO_MORE_KEYS if the end of the scan was reached, or to
+ * YOKAN_SIZE_TOO_SMALL if the next pair did not fit in the buffers,
+ * in which case it will be returned by the next call.
+ *
+ * If vsizes is NULL, only keys are read and values is ignored.
+ *
+ * @param[in] dbh Database handle.
+ * @param[in] cursor Cursor id.
+ * @param[in] count Max key/value pairs to read.
+ * @param[out] keys Buffer to hold keys.
+ * @param[in] keys_buf_size Size of the buffer to hold keys.
+ * @param[out] ksizes Array of key sizes.
+ * @param[out] values Buffer to hold values.
+ * @param[in] vals_buf_size Size of the buffer to hold values.
+ * @param[out] vsizes Array of value sizes (NULL to read only keys).
+ * @param[out] done Set to true if the end of the scan was reached (may be NULL).
+ *
+ * @return YOKAN_SUCCESS or corresponding error code.
+ */
+yk_return_t yk_cursor_next_packed(yk_database_handle_t dbh,
+                                  yk_cursor_id_t cursor,
+                                  size_t count,
+                                  void* keys,
+                                  size_t keys_buf_size,
+                                  size_t* ksizes,
+                                  void* values,
+                                  size_t vals_buf_size,
+                                  size_t* vsizes,
+                                  bool* done);
+
+/**
+ * @brief Close a cursor, releasing the resources held by the provider.
+ *
+ * @param[in] dbh Database handle.
+ * @param[in] cursor Cursor id.
+ *
+ * @return YOKAN_SUCCESS or corresponding error code.
+ */
+yk_return_t yk_cursor_close(yk_database_handle_t dbh,
+                            yk_cursor_id_t cursor);
+
+/**
+ * @brief Aggregates a numeric field of the values of the key/value pairs
+ * from from_key (included if inclusive is set in the mode) that pass the
+ * filter (see yk_iter), computing their count, sum, min, max, and
+ * histogram inside the provider, so that only the result is sent back.
+ *
+ * @param[in] dbh Database handle.
+ * @param[in] mode 0 or bitwise "or" of YOKAN_MODE_* flags.
+ * @param[in] from_key Starting key.
+ * @param[in] from_ksize Starting key size.
+ * @param[in] filter Key filter.
+ * @param[in] filter_size Filter size.
+ * @param[in] spec Field to aggregate and histogram to compute.
+ * @param[out] result Aggregate.
+ *
+ * @return YOKAN_SUCCESS or corresponding error code.
+ */
+yk_return_t yk_aggregate(yk_database_handle_t dbh,
+                         int32_t mode,
+                         const void* from_key,
+                         size_t from_ksize,
+                         const void* filter,
+                         size_t filter_size,
+                         const yk_aggregate_spec_t* spec,
+                         yk_aggregate_t* result);
+
+/**
+ * @brief Get the metrics of the provider managing the database,
+ * as a JSON string (see yk_provider_get_stats in server.h).
+ * The returned string must be free-ed by the caller.
+ *
+ * @param[in] dbh Database handle.
+ * @param[out] stats JSON string.
+ *
+ * @return YOKAN_SUCCESS or corresponding error code.
+ */
+yk_return_t yk_get_stats(yk_database_handle_t dbh,
+                         char** stats);
+
 #ifdef __cplusplus
 }
 #endif
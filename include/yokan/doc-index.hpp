@@ -0,0 +1,97 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#ifndef __YOKAN_DOC_INDEX_HPP
+#define __YOKAN_DOC_INDEX_HPP
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include <yokan/common.h>
+#include <yokan/aggregate.h>
+
+namespace yokan {
+
+/**
+ * @brief Signature of the functions that can be used to compute the
+ * key under which a document is indexed (see yk_index_spec_t). The
+ * function copies the key into the key buffer and returns its size,
+ * or returns 0 if the document should not be indexed. If the returned
+ * size is larger than max_ksize, the function is called again with a
+ * buffer large enough.
+ */
+typedef size_t (*yk_index_extractor_fn)(const void* doc, size_t docsize,
+                                        void* key, size_t max_ksize);
+
+/**
+ * @brief Definition of a secondary index on a field of the documents
+ * of a collection. If the extractor ("<library>:<function>") is not
+ * empty, it is used instead of the type, field, and offset.
+ */
+struct DocIndexSpec {
+
+    std::string name;
+    int32_t     type = YOKAN_FIELD_JSON;
+    std::string field;
+    uint64_t    offset = 0;
+    std::string extractor;
+
+    /**
+     * @brief Serializes a list of index definitions, so that they
+     * can be stored along with the collection.
+     */
+    static std::string pack(const std::vector<DocIndexSpec>& specs);
+
+    /**
+     * @brief Deserializes a list of index definitions serialized with
+     * pack. Returns false if the data is not a valid list.
+     */
+    static bool unpack(const char* data, size_t size, std::vector<DocIndexSpec>& specs);
+};
+
+/**
+ * @brief Computes the keys under which documents are indexed. Keys
+ * are compared as strings of bytes, so they must sort like the values
+ * of the indexed field.
+ */
+class DocIndexer {
+
+    public:
+
+    virtual ~DocIndexer() = default;
+
+    /**
+     * @brief Computes the key of a document. Returns false if the
+     * document should not be indexed (e.g. if it lacks the field).
+     */
+    virtual bool indexKey(const void* doc, size_t docsize, std::string& key) const = 0;
+
+    /**
+     * @brief Computes the key of a bound of a query, given as a value of
+     * the indexed field (e.g. the JSON text of a number or a string for
+     * a JSON index, or the binary number for a binary field). Returns
+     * false if the value is not valid for this index.
+     */
+    virtual bool boundKey(const void* value, size_t size, std::string& key) const = 0;
+};
+
+class DocIndexerFactory {
+
+    public:
+
+    DocIndexerFactory() = delete;
+
+    /**
+     * @brief Creates the DocIndexer of an index, or returns nullptr
+     * if the definition is invalid (e.g. unknown type, or extractor
+     * that cannot be loaded).
+     */
+    static std::shared_ptr<DocIndexer> makeDocIndexer(const DocIndexSpec& spec);
+};
+
+}
+
+#endif
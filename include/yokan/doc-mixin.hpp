@@ -10,7 +10,13 @@
 #include <limits>
 #include <yokan/backend.hpp>
 #include <yokan/util/locks.hpp>
+#include <algorithm>
+#include <atomic>
+#include <map>
 #include <memory>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
 #include <cstring>
 
 namespace yokan {
@@ -24,13 +30,104 @@ namespace yokan {
 template <typename DB>
 class DocumentStoreMixin : public DB {
 
+    /* Metadata of a collection, stored as the value of the collection's
+     * name. Documents may exist with ids in [next_id, reserved_id) if the
+     * database was not closed cleanly, in which case size and next_id are
+     * recovered by looking up these ids. Databases created by older versions
+     * store only size and next_id. */
     struct CollectionMetadata {
-        yk_id_t size    = 0;
-        yk_id_t next_id = 0;
+        yk_id_t size        = 0;
+        yk_id_t next_id     = 0;
+        yk_id_t reserved_id = 0;
     };
 
+    static constexpr size_t s_legacy_metadata_size = 2*sizeof(yk_id_t);
+
+    /* A dropped collection whose documents have not all been erased yet
+     * has a tombstone instead of its metadata: the end of its range of ids. */
+    static constexpr size_t s_tombstone_size = sizeof(yk_id_t);
+
+    /* Number of ids reserved ahead of next_id each time the metadata
+     * is checkpointed, and number of ids allocated by docStore after
+     * which the metadata is checkpointed again. */
+    static constexpr yk_id_t s_id_reservation    = 1024;
+    static constexpr yk_id_t s_checkpoint_period = s_id_reservation/2;
+
+    /* Number of documents erased at a time by collDrop when the backend
+     * cannot erase the whole range of ids of the collection at once, and
+     * number of documents (or index entries) read at a time when creating
+     * (or dropping) an index. */
+    static constexpr yk_id_t s_chunk_size = 4096;
+
+    /* Secondary index of a collection. Its entries are keys made of its
+     * prefix ('\0' + collection + '\0' + index + '\0'), the key computed
+     * by its indexer with each '\0' escaped as "\0\1" and terminated by
+     * "\0\0" (so that entries sort like the indexer's keys even when one
+     * is a prefix of another), and the big-endian id of the document; the
+     * values are empty. The definitions of the indexes of a collection are
+     * stored under '\0' + collection + '\0'. Collection names are not
+     * empty, so none of these keys can be mistaken for a document's key. */
+    struct Index {
+        DocIndexSpec                spec;
+        std::shared_ptr<DocIndexer> indexer;
+        std::string                 prefix;
+    };
+
+    using IndexPtr = std::shared_ptr<const Index>;
+
+    /* In-memory state of a collection. Ids are allocated atomically from
+     * next_id while holding the read lock, which docStore, docLoad, etc.
+     * hold for the duration of their operation; the write lock is held by
+     * operations that need the collection to be quiescent (erasing,
+     * updating indexed documents or creating documents past the
+     * checkpointed next_id, checkpointing, reserving ids, dropping,
+     * changing the indexes). The checkpointed values are those of the
+     * metadata last written, and are protected by mutex. */
+    struct Collection {
+
+        ABT_rwlock           lock  = ABT_RWLOCK_NULL;
+        ABT_mutex            mutex = ABT_MUTEX_NULL;
+        std::atomic<yk_id_t> size{0};
+        std::atomic<yk_id_t> next_id{0};
+        std::atomic<yk_id_t> reserved_id{0};
+        std::atomic<yk_id_t> checkpoint_next_id{0};
+        yk_id_t              checkpoint_size = 0;
+        bool                 dropped         = false;
+        std::vector<IndexPtr> indexes;
+        // ids reserved by collReserveIDs and not filled yet, as [first, end)
+        // ranges indexed by first (guarded by mutex, not persisted)
+        std::map<yk_id_t, yk_id_t> unfilled;
+
+        Collection(bool use_lock, const CollectionMetadata& metadata)
+        : size(metadata.size)
+        , next_id(metadata.next_id)
+        , reserved_id(metadata.reserved_id)
+        , checkpoint_next_id(metadata.next_id)
+        , checkpoint_size(metadata.size) {
+            if(use_lock) {
+                ABT_rwlock_create(&lock);
+                ABT_mutex_create(&mutex);
+            }
+        }
+
+        ~Collection() {
+            if(lock != ABT_RWLOCK_NULL) ABT_rwlock_free(&lock);
+            if(mutex != ABT_MUTEX_NULL) ABT_mutex_free(&mutex);
+        }
+
+        Collection(const Collection&) = delete;
+        Collection& operator=(const Collection&) = delete;
+    };
+
+    using CollectionPtr = std::shared_ptr<Collection>;
+
+    /* m_lock only protects m_collections, i.e. the set of collections
+     * that have been opened, not the collections themselves, and
+     * m_dropping, the set of collections whose documents are being
+     * erased by collDrop. */
     ABT_rwlock m_lock = ABT_RWLOCK_NULL;
-    mutable std::unordered_map<std::string, CollectionMetadata> m_cached_metadata;
+    mutable std::unordered_map<std::string, CollectionPtr> m_collections;
+    std::unordered_set<std::string> m_dropping;
 
     public:
 
@@ -56,6 +153,7 @@ class DocumentStoreMixin : public DB {
     using DB::put;
     using DB::get;
     using DB::erase;
+    using DB::eraseRange;
     using DB::listKeys;
     using DB::listKeyValues;
 
@@ -64,67 +162,151 @@ class DocumentStoreMixin : public DB {
         m_lock = ABT_RWLOCK_NULL;
     }
 
+    /**
+     * @brief Writes the metadata of all the opened collections, so that
+     * no recovery is needed when the database is opened again. Backends
+     * should call this function before closing or migrating the database.
+     */
+    Status flushCollections() {
+        ScopedReadLock lock(m_lock);
+        auto status = Status::OK;
+        for(auto& p : m_collections) {
+            auto& coll = *p.second;
+            ScopedWriteLock coll_lock(coll.lock);
+            if(coll.dropped) continue;
+            auto next_id = coll.next_id.load();
+            if(coll.reserved_id == next_id
+            && coll.checkpoint_next_id == next_id
+            && coll.checkpoint_size == coll.size)
+                continue;
+            auto s = _collCheckpoint(p.first.data(), p.first.size(), coll, next_id);
+            if(s != Status::OK) status = s;
+        }
+        return status;
+    }
+
     Status collCreate(int32_t mode, const char* name) override {
         (void)mode;
+        if(name == nullptr || name[0] == '\0')
+            return Status::InvalidArg;
         ScopedWriteLock lock(m_lock);
-        bool coll_exists;
         auto name_len = strlen(name);
+        auto coll_name = std::string(name, name_len);
+        if(m_collections.count(coll_name))
+            return Status::KeyExists;
+        // the documents of a collection with the same name are being erased
+        if(m_dropping.count(coll_name))
+            return Status::TryAgain;
+        bool coll_exists;
         auto status = _collExists(name, name_len, &coll_exists);
         if(status != Status::OK) return status;
         if(coll_exists) return Status::KeyExists;
+        // a previous collDrop may have been interrupted by a crash
+        bool dropped = false;
+        yk_id_t end_id = 0;
+        status = _collGetDropped(name, name_len, &dropped, &end_id);
+        if(status != Status::OK) return status;
+        if(dropped) {
+            status = _collPurge(name, name_len, end_id);
+            if(status != Status::OK) return status;
+        }
         CollectionMetadata metadata;
-        return _collPutMetadata(name, name_len, &metadata);
+        status = _collPutMetadata(name, name_len, metadata);
+        if(status != Status::OK) return status;
+        m_collections.emplace(std::move(coll_name),
+            std::make_shared<Collection>(m_lock != ABT_RWLOCK_NULL, metadata));
+        return Status::OK;
     }
 
     Status collDrop(int32_t mode, const char* collection) override {
         (void)mode;
-        ScopedWriteLock lock(m_lock);
-        bool coll_exists;
+        if(collection == nullptr || collection[0] == '\0')
+            return Status::InvalidArg;
         auto name_len = strlen(collection);
-        auto status = _collExists(collection, name_len, &coll_exists);
-        if(status != Status::OK) return status;
-        CollectionMetadata metadata;
-        status = _collGetMetadata(collection, name_len, &metadata);
-        if(status != Status::OK) return status;
-        std::vector<yk_id_t> ids(metadata.next_id);
-        for(yk_id_t id = 0; id < ids.size(); id++) {
-            ids[id] = id;
+        auto coll_name = std::string(collection, name_len);
+        yk_id_t end_id;
+        {
+            ScopedWriteLock lock(m_lock);
+            CollectionPtr coll;
+            auto status = _collOpenLocked(collection, name_len, coll);
+            if(status != Status::OK) return status;
+            ScopedWriteLock coll_lock(coll->lock);
+            // documents may have been stored with any id below reserved_id
+            end_id = coll->reserved_id;
+            // replacing the metadata with a tombstone makes the collection
+            // invisible right away, and lets collCreate finish erasing its
+            // documents if the database is closed before they are all erased
+            status = _collPutDropped(collection, name_len, end_id);
+            if(status != Status::OK) return status;
+            coll->dropped = true;
+            m_collections.erase(coll_name);
+            m_dropping.insert(coll_name);
         }
-        auto keys = _keysFromIds(collection, name_len, ids);
-        std::vector<size_t> ksizes(ids.size()+1, name_len+1+sizeof(yk_id_t));
-        keys.resize(keys.size() + name_len);
-        std::memcpy(keys.data() + keys.size() - name_len, collection, name_len);
-        ksizes[ksizes.size()-1] = name_len;
-        m_cached_metadata.erase(std::string(collection, name_len));
-        return erase(mode, keys, ksizes);
+        auto status = _collPurge(collection, name_len, end_id);
+        ScopedWriteLock lock(m_lock);
+        m_dropping.erase(coll_name);
+        return status;
     }
 
     Status collExists(int32_t mode, const char* collection, bool* flag) const override {
         (void)mode;
-        ScopedReadLock lock(m_lock);
-        return _collExists(collection, strlen(collection), flag);
+        if(collection == nullptr || collection[0] == '\0')
+            return Status::InvalidArg;
+        auto name_len = strlen(collection);
+        {
+            ScopedReadLock lock(m_lock);
+            if(m_collections.count(std::string(collection, name_len))) {
+                *flag = true;
+                return Status::OK;
+            }
+        }
+        return _collExists(collection, name_len, flag);
     }
 
     Status collLastID(int32_t mode, const char* collection, yk_id_t* id) const override {
         (void)mode;
-        CollectionMetadata metadata;
-        ScopedReadLock lock(m_lock);
-        auto status = _collGetMetadata(collection, strlen(collection), &metadata);
+        CollectionPtr coll;
+        auto status = _collOpen(collection, coll);
         if(status == Status::OK)
-            *id = metadata.next_id-1;
+            *id = coll->next_id-1;
         return status;
     }
 
     Status collSize(int32_t mode, const char* collection, size_t* size) const override {
         (void)mode;
-        ScopedReadLock lock(m_lock);
-        CollectionMetadata metadata;
-        auto status = _collGetMetadata(collection, strlen(collection), &metadata);
+        CollectionPtr coll;
+        auto status = _collOpen(collection, coll);
         if(status == Status::OK)
-            *size = metadata.size;
+            *size = coll->size;
         return status;
     }
 
+    Status collReserveIDs(int32_t mode, const char* collection,
+                          size_t count, yk_id_t* first_id) override {
+        (void)mode;
+        if(collection == nullptr || collection[0] == 0)
+            return Status::InvalidArg;
+        auto name_len = strlen(collection);
+        CollectionPtr coll;
+        auto status = _collOpen(collection, coll);
+        if(status != Status::OK) return status;
+        // the new next_id is checkpointed right away, so that the ids
+        // are never assigned again, even if the database is not closed
+        // cleanly, and so that the documents later stored with them
+        // are below the checkpointed next_id (see docUpdate)
+        ScopedWriteLock coll_lock(coll->lock);
+        if(coll->dropped) return Status::NotFound;
+        if(count == 0 || count > std::numeric_limits<yk_id_t>::max() - coll->next_id)
+            return Status::InvalidArg;
+        *first_id = coll->next_id;
+        coll->next_id += count;
+        status = _collCheckpoint(collection, name_len, *coll, coll->reserved_id);
+        if(status != Status::OK) return status;
+        ScopedMutex mutex(coll->mutex);
+        coll->unfilled.emplace(*first_id, *first_id + count);
+        return Status::OK;
+    }
+
     Status docSize(const char* collection,
                    int32_t mode,
                    const BasicUserMem<yk_id_t>& ids,
@@ -143,27 +325,35 @@ class DocumentStoreMixin : public DB {
                     const BasicUserMem<size_t>& sizes,
                     BasicUserMem<yk_id_t>& ids) override {
         auto count = ids.size;
-        CollectionMetadata metadata;
         auto name_len = strlen(collection);
+        CollectionPtr coll;
+        auto status = _collOpen(collection, coll);
+        if(status != Status::OK) return status;
         {
-            ScopedWriteLock lock(m_lock);
-            auto status = _collGetMetadata(collection, name_len, &metadata);
-            if(status != Status::OK) return status;
+            ScopedReadLock coll_lock(coll->lock);
+            if(coll->dropped) return Status::NotFound;
+            auto first_id = coll->next_id.fetch_add(count);
             for(uint64_t i = 0; i < count; i++) {
-                ids[i] = metadata.next_id + i;
+                ids[i] = first_id + i;
             }
-            metadata.next_id += count;
-            status = _collPutMetadata(collection, name_len, &metadata, false);
+            // documents must never be written past the reserved ids,
+            // otherwise they could not be recovered
+            status = _collReserve(collection, name_len, *coll, first_id + count);
+            if(status != Status::OK) return status;
+            auto keys = _keysFromIds(collection, name_len, ids);
+            std::vector<size_t> ksizes(ids.size, name_len+1+sizeof(yk_id_t));
+            status = _docPut(mode, *coll, name_len, ids, keys, ksizes, documents, sizes, false);
             if(status != Status::OK) return status;
+            coll->size += count;
         }
-        auto keys = _keysFromIds(collection, name_len, ids);
-        std::vector<size_t> ksizes(ids.size, name_len+1+sizeof(yk_id_t));
-        auto status = put(mode, keys, ksizes, documents, sizes);
-        if(status != Status::OK) return status;
-        ScopedWriteLock lock(m_lock);
-        _collGetMetadata(collection, name_len, &metadata);
-        metadata.size += count;
-        return _collPutMetadata(collection, name_len, &metadata);
+        // write-behind: the metadata is only written every s_checkpoint_period ids
+        if(coll->next_id - coll->checkpoint_next_id < s_checkpoint_period)
+            return Status::OK;
+        ScopedWriteLock coll_lock(coll->lock);
+        auto next_id = coll->next_id.load();
+        if(coll->dropped || next_id - coll->checkpoint_next_id < s_checkpoint_period)
+            return Status::OK;
+        return _collCheckpoint(collection, name_len, *coll, next_id + s_id_reservation);
     }
 
     Status docUpdate(const char* collection,
@@ -176,34 +366,71 @@ class DocumentStoreMixin : public DB {
         auto name_len = strlen(collection);
         auto keys = _keysFromIds(collection, name_len, ids);
         std::vector<size_t> ksizes(ids.size, name_len+1+sizeof(yk_id_t));
-        ScopedWriteLock lock(m_lock);
-        CollectionMetadata metadata;
-        auto status = _collGetMetadata(collection, name_len, &metadata);
+        CollectionPtr coll;
+        auto status = _collOpen(collection, coll);
         if(status != Status::OK) return status;
         if(mode & YOKAN_MODE_UPDATE_NEW) {
+            {
+                // ids reserved by collReserveIDs and not filled yet are
+                // filled under the read lock, so that clients filling their
+                // own ranges do not serialize. Claiming them first ensures
+                // that each of them is only counted once, by one update.
+                ScopedReadLock coll_lock(coll->lock);
+                if(coll->dropped) return Status::NotFound;
+                if(coll->indexes.empty() && _collClaimReserved(*coll, ids)) {
+                    status = put(mode, keys, ksizes, documents, sizes);
+                    if(status != Status::OK) {
+                        ScopedMutex mutex(coll->mutex);
+                        for(unsigned i=0; i < ids.size; i++)
+                            coll->unfilled.emplace(ids[i], ids[i] + 1);
+                        return status;
+                    }
+                    return _collGrow(collection, name_len, *coll, ids.size);
+                }
+            }
+            ScopedWriteLock coll_lock(coll->lock);
+            if(coll->dropped) return Status::NotFound;
             std::vector<uint8_t> existsBuffer(1 + sizes.size/8);
             BitField existsBitfield{existsBuffer.data(), sizes.size};
             status = exists(mode, keys, ksizes, existsBitfield);
             if(status != Status::OK) return status;
-            size_t extraKeys = 0;
-            yk_id_t maxID = 0;
+            std::unordered_set<yk_id_t> newIds; // an id may appear twice
+            yk_id_t next_id = coll->next_id;
             for(unsigned i=0; i < ids.size; i++) {
-                if(!existsBitfield[i]) extraKeys += 1;
-                maxID = std::max(maxID, ids[i]);
+                if(!existsBitfield[i]) newIds.insert(ids[i]);
+                next_id = std::max(next_id, ids[i] + 1);
             }
-            status = put(mode, keys, ksizes, documents, sizes);
+            size_t extraKeys = newIds.size();
+            status = _collReserve(collection, name_len, *coll, next_id);
+            if(status != Status::OK) return status;
+            status = _docPut(mode, *coll, name_len, ids, keys, ksizes, documents, sizes, true);
             if(status != Status::OK) return status;
-            metadata.size += extraKeys;
-            metadata.next_id = maxID + 1;
-            return _collPutMetadata(collection, name_len, &metadata);
+            {
+                ScopedMutex mutex(coll->mutex);
+                for(unsigned i=0; i < ids.size; i++)
+                    _collClaimReserved(*coll, ids[i]);
+            }
+            coll->size += extraKeys;
+            coll->next_id = next_id;
+            return _collCheckpoint(collection, name_len, *coll, coll->reserved_id);
         } else {
-            for(unsigned i=0; i < ids.size; i++) {
-                if(ids[i] >= metadata.next_id)
-                    return Status::InvalidID;
+            {
+                ScopedReadLock coll_lock(coll->lock);
+                if(coll->dropped) return Status::NotFound;
+                for(unsigned i=0; i < ids.size; i++) {
+                    if(ids[i] >= coll->next_id)
+                        return Status::InvalidID;
+                }
+                // FIXME: we may be updating keys that have been previously deleted,
+                // leading the metadata to no longer be correct.
+                if(coll->indexes.empty())
+                    return put(mode, keys, ksizes, documents, sizes);
             }
-            // FIXME: we may be updating keys that have been previously deleted,
-            // leading the metadata to no longer be correct.
-            return put(mode, keys, ksizes, documents, sizes);
+            // replacing the index entries of the documents must not
+            // race with another update of the same documents
+            ScopedWriteLock coll_lock(coll->lock);
+            if(coll->dropped) return Status::NotFound;
+            return _docPut(mode, *coll, name_len, ids, keys, ksizes, documents, sizes, true);
         }
     }
 
@@ -215,11 +442,11 @@ class DocumentStoreMixin : public DB {
         if(collection == nullptr || collection[0] == 0)
             return Status::InvalidArg;
         auto name_len = strlen(collection);
-        ScopedReadLock lock(m_lock);
-        bool e;
-        auto status = _collExists(collection, name_len, &e);
+        CollectionPtr coll;
+        auto status = _collOpen(collection, coll);
         if(status != Status::OK) return status;
-        if(!e) return Status::NotFound;
+        ScopedReadLock coll_lock(coll->lock);
+        if(coll->dropped) return Status::NotFound;
         auto keys = _keysFromIds(collection, name_len, ids);
         std::vector<size_t> ksizes(ids.size, name_len+1+sizeof(yk_id_t));
         return get(mode, packed, keys, ksizes, documents, sizes);
@@ -232,10 +459,11 @@ class DocumentStoreMixin : public DB {
         if(collection == nullptr || collection[0] == 0)
               return Status::InvalidArg;
         auto name_len = strlen(collection);
-        ScopedReadLock lock(m_lock);
-        bool e;
-        auto status = _collExists(collection, name_len, &e);
-        if(status != Status::OK) return status;
+        CollectionPtr coll;
+        auto status = _collOpen(collection, coll);
+        if(status != Status::OK && status != Status::NotFound) return status;
+        // documents of a collection that does not exist are reported as not found
+        ScopedReadLock coll_lock(coll ? coll->lock : ABT_RWLOCK_NULL);
         auto keys = _keysFromIds(collection, name_len, ids);
         std::vector<size_t> ksizes(ids.size, name_len+1+sizeof(yk_id_t));
         return this->fetch(mode, keys, ksizes,
@@ -250,25 +478,43 @@ class DocumentStoreMixin : public DB {
                     const BasicUserMem<yk_id_t>& ids) override {
         if(collection == nullptr || collection[0] == 0)
             return Status::InvalidArg;
-        CollectionMetadata metadata;
         auto name_len = strlen(collection);
         auto keys = _keysFromIds(collection, name_len, ids);
         std::vector<size_t> ksizes(ids.size, name_len+1+sizeof(yk_id_t));
         std::vector<uint8_t> docs_exist(1+ids.size/8);
         auto docs_exist_bf = BitField{docs_exist.data(), ids.size};
-        ScopedWriteLock lock(m_lock);
-        auto status = exists(mode, keys, ksizes, docs_exist_bf);
+        CollectionPtr coll;
+        auto status = _collOpen(collection, coll);
+        if(status != Status::OK) return status;
+        ScopedWriteLock coll_lock(coll->lock);
+        if(coll->dropped) return Status::NotFound;
+        status = exists(mode, keys, ksizes, docs_exist_bf);
         if(status != Status::OK) return status;
         size_t num_keys_to_erase = 0;
         for(size_t i=0; i < ids.size; i++) {
             if(docs_exist_bf[i]) num_keys_to_erase += 1;
         }
-        status = _collGetMetadata(collection, name_len, &metadata);
-        if(status != Status::OK) return status;
+        if(!coll->indexes.empty() && num_keys_to_erase) {
+            // the index entries are erased along with the documents
+            std::vector<char>   entries;
+            std::vector<size_t> esizes;
+            status = this->fetch(0, keys, ksizes,
+                [&](const UserMem& key, const UserMem& val) -> Status {
+                    if(val.size != YOKAN_KEY_NOT_FOUND)
+                        _indexEntries(coll->indexes, _idFromKey(name_len, key.data),
+                                      val.data, val.size, entries, esizes);
+                    return Status::OK;
+                });
+            if(status != Status::OK) return status;
+            keys.insert(keys.end(), entries.begin(), entries.end());
+            ksizes.insert(ksizes.end(), esizes.begin(), esizes.end());
+        }
         status = erase(mode, keys, ksizes);
         if(status != Status::OK) return status;
-        metadata.size -= num_keys_to_erase;
-        return _collPutMetadata(collection, name_len, &metadata);
+        coll->size -= num_keys_to_erase;
+        // erasing documents below the checkpointed next_id is not
+        // something recovery can detect, so the metadata is written now
+        return _collCheckpoint(collection, name_len, *coll, coll->reserved_id);
     }
 
     Status docList(const char* collection,
@@ -289,14 +535,12 @@ class DocumentStoreMixin : public DB {
         auto count = ids.size;
         auto kv_filter = FilterFactory::docToKeyValueFilter(filter, collection);
 
-        CollectionMetadata metadata;
-        {
-            ScopedReadLock lock(m_lock);
-            status = _collGetMetadata(collection, name_len, &metadata);
-            if(status != Status::OK) {
-                return status;
-            }
+        CollectionPtr coll;
+        status = _collOpen(collection, coll);
+        if(status != Status::OK) {
+            return status;
         }
+        yk_id_t next_id = coll->next_id;
 
         if(isSorted()) { // use the underlying listKeyValues function
 
@@ -322,7 +566,7 @@ class DocumentStoreMixin : public DB {
             yk_id_t id = from_id;
             size_t docs_offset = 0;
             size_t i = 0;
-            while(i != count && id < metadata.next_id && docs_offset < documents.size) {
+            while(i != count && id < next_id && docs_offset < documents.size) {
                 auto key = _keyFromId(collection, name_len, id);
                 auto ksize = key.size();
                 auto doc_umem = UserMem{
@@ -339,7 +583,9 @@ class DocumentStoreMixin : public DB {
                 if(docSizes[i] >= YOKAN_SIZE_TOO_SMALL) break;
 
                 if(!kv_filter->check(key.data(), ksize, doc_umem.data, docsize_umem[0])) {
+                    bool stop = kv_filter->shouldStop(key.data(), ksize, doc_umem.data, docsize_umem[0]);
                     docsize_umem[0] = original_vsize;
+                    if(stop) break;
                     id += 1;
                     continue;
                 }
@@ -369,14 +615,12 @@ class DocumentStoreMixin : public DB {
         auto name_len = strlen(collection);
         auto kv_filter = FilterFactory::docToKeyValueFilter(filter, collection);
 
-        CollectionMetadata metadata;
-        {
-            ScopedReadLock lock(m_lock);
-            status = _collGetMetadata(collection, name_len, &metadata);
-            if(status != Status::OK) {
-                return status;
-            }
+        CollectionPtr coll;
+        status = _collOpen(collection, coll);
+        if(status != Status::OK) {
+            return status;
         }
+        yk_id_t next_id = coll->next_id;
 
         if(isSorted()) { // use the underlying iters function
 
@@ -392,7 +636,7 @@ class DocumentStoreMixin : public DB {
 
             yk_id_t id = from_id;
             size_t i = 0;
-            while((max == 0 || i < max) && id < metadata.next_id) {
+            while((max == 0 || i < max) && id < next_id) {
                 auto key = _keyFromId(collection, name_len, id);
                 auto ksize = key.size();
                 auto kv_func   = [&func, &filter, &i, &collection, name_len](const UserMem& key, const UserMem& val) -> Status {
@@ -416,6 +660,227 @@ class DocumentStoreMixin : public DB {
         return Status::OK;
     }
 
+    Status collCreateIndex(int32_t mode, const char* collection,
+                           const DocIndexSpec& spec) override {
+        (void)mode;
+        if(collection == nullptr || collection[0] == 0
+        || spec.name.empty() || spec.name.find('\0') != std::string::npos)
+            return Status::InvalidArg;
+        // queries scan the entries of an index in order
+        if(!isSorted()) return Status::NotSupported;
+        auto indexer = DocIndexerFactory::makeDocIndexer(spec);
+        if(!indexer) return Status::InvalidArg;
+        auto name_len = strlen(collection);
+        CollectionPtr coll;
+        auto status = _collOpen(collection, coll);
+        if(status != Status::OK) return status;
+        ScopedWriteLock coll_lock(coll->lock);
+        if(coll->dropped) return Status::NotFound;
+        for(auto& index : coll->indexes) {
+            if(index->spec.name == spec.name) return Status::KeyExists;
+        }
+        auto index = _makeIndex(collection, name_len, spec, std::move(indexer));
+        // entries left by an index of the same name that was being dropped
+        status = _erasePrefix(index->prefix);
+        if(status != Status::OK) return status;
+        // the documents already stored are indexed s_chunk_size ids at a
+        // time, and the definition of the index is written last, so that an
+        // interrupted creation leaves only entries that are ignored
+        std::vector<IndexPtr> new_index{index};
+        std::vector<yk_id_t>  ids;
+        std::vector<char>     entries;
+        std::vector<size_t>   esizes;
+        yk_id_t end_id = coll->next_id;
+        for(yk_id_t first = 0; first < end_id; first += s_chunk_size) {
+            ids.resize(std::min(s_chunk_size, end_id - first));
+            for(size_t i = 0; i < ids.size(); i++) {
+                ids[i] = first + i;
+            }
+            auto keys = _keysFromIds(collection, name_len, ids);
+            std::vector<size_t> ksizes(ids.size(), name_len+1+sizeof(yk_id_t));
+            entries.clear();
+            esizes.clear();
+            status = this->fetch(0, keys, ksizes,
+                [&](const UserMem& key, const UserMem& val) -> Status {
+                    if(val.size != YOKAN_KEY_NOT_FOUND)
+                        _indexEntries(new_index, _idFromKey(name_len, key.data),
+                                      val.data, val.size, entries, esizes);
+                    return Status::OK;
+                });
+            if(status == Status::OK && !esizes.empty()) {
+                std::vector<size_t> vsizes(esizes.size(), 0);
+                status = put(0, entries, esizes, UserMem{entries.data(), 0}, vsizes);
+            }
+            if(status != Status::OK) return status;
+            ABT_thread_yield();
+        }
+        auto indexes = coll->indexes;
+        indexes.push_back(std::move(index));
+        status = _collPutIndexes(collection, name_len, indexes);
+        if(status == Status::OK)
+            coll->indexes = std::move(indexes);
+        return status;
+    }
+
+    Status collDropIndex(int32_t mode, const char* collection,
+                         const char* index) override {
+        (void)mode;
+        if(collection == nullptr || collection[0] == 0 || index == nullptr)
+            return Status::InvalidArg;
+        auto name_len = strlen(collection);
+        CollectionPtr coll;
+        auto status = _collOpen(collection, coll);
+        if(status != Status::OK) return status;
+        ScopedWriteLock coll_lock(coll->lock);
+        if(coll->dropped) return Status::NotFound;
+        auto indexes = coll->indexes;
+        auto it = std::find_if(indexes.begin(), indexes.end(),
+            [index](const IndexPtr& i) { return i->spec.name == index; });
+        if(it == indexes.end()) return Status::NotFound;
+        auto dropped = *it;
+        indexes.erase(it);
+        status = _collPutIndexes(collection, name_len, indexes);
+        if(status != Status::OK) return status;
+        coll->indexes = std::move(indexes);
+        // the entries are ignored once the definition is gone, and
+        // collCreateIndex erases those that remain after a crash
+        return _erasePrefix(dropped->prefix);
+    }
+
+    Status docQuery(const char* collection, int32_t mode, const char* index,
+                    const UserMem* lower, const UserMem* upper,
+                    const UserMem& after,
+                    BasicUserMem<yk_id_t>& ids,
+                    std::string& last) const override {
+        if(collection == nullptr || collection[0] == 0 || index == nullptr)
+            return Status::InvalidArg;
+        if(!isSorted()) return Status::NotSupported;
+        CollectionPtr coll;
+        auto status = _collOpen(collection, coll);
+        if(status != Status::OK) return status;
+        ScopedReadLock coll_lock(coll->lock);
+        if(coll->dropped) return Status::NotFound;
+        IndexPtr idx;
+        for(auto& i : coll->indexes) {
+            if(i->spec.name == index) idx = i;
+        }
+        if(!idx) return Status::NotFound;
+
+        std::string key, lower_key, upper_key;
+        if(lower) {
+            if(!idx->indexer->boundKey(lower->data, lower->size, key))
+                return Status::InvalidArg;
+            _appendEscaped(lower_key, key);
+        }
+        if(upper) {
+            if(!idx->indexer->boundKey(upper->data, upper->size, key))
+                return Status::InvalidArg;
+            _appendEscaped(upper_key, key);
+        }
+        if(after.size != 0 && after.size < sizeof(yk_id_t))
+            return Status::InvalidArg;
+        const bool inclusive = mode & YOKAN_MODE_INCLUSIVE;
+        const auto max = ids.size;
+        const auto& prefix = idx->prefix;
+
+        // entries are sorted by value then by id, so the results are
+        // returned in that order and each page is scanned with bounded
+        // iters starting at the lower bound or right after the previous page
+        const bool resume = after.size != 0 && std::string_view{after.data, after.size} >= lower_key;
+        std::vector<char> from_key(prefix.begin(), prefix.end());
+        if(resume)
+            from_key.insert(from_key.end(), after.data, after.data + after.size);
+        else
+            from_key.insert(from_key.end(), lower_key.begin(), lower_key.end());
+        auto filter = FilterFactory::makeKeyValueFilter(MARGO_INSTANCE_NULL, 0,
+            UserMem{const_cast<char*>(prefix.data()), prefix.size()});
+
+        // an entry may be stale if erasing it after its document was
+        // updated failed (see _docPut), so each entry is checked against
+        // the current document, and skipped if it does not match it
+        auto self = const_cast<DocumentStoreMixin*>(this);
+        auto name_len = strlen(collection);
+        std::vector<char>   stale_entries;
+        std::vector<size_t> stale_esizes;
+        size_t found = 0;
+        bool first = true, end = false;
+        while(found < max && !end) {
+            const auto requested = max - found;
+            std::vector<std::string> entries;
+            std::vector<yk_id_t>     entry_ids;
+            status = this->iter(first && !resume ? YOKAN_MODE_INCLUSIVE : 0,
+                requested, from_key, filter, true,
+                [&](const UserMem& entry, const UserMem&) -> Status {
+                    if(entry.size < prefix.size() + sizeof(yk_id_t))
+                        return Status::Corruption;
+                    auto value = std::string_view{entry.data + prefix.size(),
+                                                  entry.size - prefix.size() - sizeof(yk_id_t)};
+                    if(upper) {
+                        auto c = value.compare(upper_key);
+                        if(c > 0 || (c == 0 && !inclusive)) {
+                            end = true;
+                            return Status::StopIteration;
+                        }
+                    }
+                    yk_id_t be_id;
+                    std::memcpy(&be_id, entry.data + entry.size - sizeof(yk_id_t), sizeof(be_id));
+                    entry_ids.push_back(_ensureBigEndian(be_id));
+                    entries.emplace_back(entry.data, entry.size);
+                    return Status::OK;
+                });
+            if(status == Status::StopIteration) status = Status::OK;
+            if(status != Status::OK) return status;
+            if(entries.size() < requested) end = true;
+            if(entries.empty()) break;
+            first = false;
+
+            // current entry of each document (empty if it has none)
+            std::unordered_map<yk_id_t, std::string> current;
+            std::vector<yk_id_t> doc_ids;
+            for(auto id : entry_ids)
+                if(current.emplace(id, std::string{}).second) doc_ids.push_back(id);
+            BasicUserMem<yk_id_t> doc_ids_umem{doc_ids.data(), doc_ids.size()};
+            auto keys = _keysFromIds(collection, name_len, doc_ids_umem);
+            std::vector<size_t> ksizes(doc_ids.size(), name_len+1+sizeof(yk_id_t));
+            std::unordered_set<yk_id_t> missing;
+            std::string key;
+            status = self->fetch(0, keys, ksizes,
+                [&](const UserMem& k, const UserMem& val) -> Status {
+                    auto id = _idFromKey(name_len, k.data);
+                    if(val.size == YOKAN_KEY_NOT_FOUND)
+                        missing.insert(id);
+                    else if(idx->indexer->indexKey(val.data, val.size, key))
+                        _appendEscaped(current[id], key);
+                    return Status::OK;
+                });
+            if(status != Status::OK) return status;
+
+            for(size_t i = 0; i < entries.size(); i++) {
+                auto& entry = entries[i];
+                auto value = std::string_view{entry.data() + prefix.size(),
+                                              entry.size() - prefix.size() - sizeof(yk_id_t)};
+                if(value == current[entry_ids[i]]) {
+                    ids[found++] = entry_ids[i];
+                } else if(!missing.count(entry_ids[i])) {
+                    // a document being stored under the read lock may not
+                    // be visible yet, so only entries of documents that
+                    // exist with other values are known to be stale
+                    stale_entries.insert(stale_entries.end(), entry.begin(), entry.end());
+                    stale_esizes.push_back(entry.size());
+                }
+            }
+            last.assign(entries.back(), prefix.size(), std::string::npos);
+            from_key.assign(entries.back().begin(), entries.back().end());
+        }
+        // erasing them is only an optimization for later queries, and
+        // writers replacing entries hold the write lock, so errors are ignored
+        if(!stale_esizes.empty())
+            self->erase(0, stale_entries, stale_esizes);
+        for(size_t i = found; i < max; i++)
+            ids[i] = YOKAN_NO_MORE_DOCS;
+        return Status::OK;
+    }
+
     private:
 
     Status _collExists(const char* name, size_t name_size, bool* e) const {
@@ -428,20 +893,50 @@ class DocumentStoreMixin : public DB {
         BasicUserMem<size_t> vsize_umem{&vlen, 1};
         auto stt = length(0, key_umem, ksize_umem, vsize_umem);
         if(stt == Status::OK)
-            *e = (vlen == sizeof(CollectionMetadata));
+            *e = (vlen == sizeof(CollectionMetadata) || vlen == s_legacy_metadata_size);
         return stt;
     }
 
-    Status _collGetMetadata(const char* name, size_t name_size, CollectionMetadata* metadata,
-                            bool from_disk=false) const {
+    Status _collOpen(const char* name, CollectionPtr& coll) const {
         if(name == nullptr || name[0] == '\0')
             return Status::InvalidArg;
-        auto coll_name = std::string(name, name_size);
-        auto it = m_cached_metadata.find(coll_name);
-        if(it != m_cached_metadata.end() && !from_disk) {
-            *metadata = it->second;
+        auto name_len = strlen(name);
+        {
+            ScopedReadLock lock(m_lock);
+            auto it = m_collections.find(std::string(name, name_len));
+            if(it != m_collections.end()) {
+                coll = it->second;
+                return Status::OK;
+            }
+        }
+        ScopedWriteLock lock(m_lock);
+        return _collOpenLocked(name, name_len, coll);
+    }
+
+    /* Same as _collOpen, with m_lock already held in write mode. */
+    Status _collOpenLocked(const char* name, size_t name_len, CollectionPtr& coll) const {
+        auto coll_name = std::string(name, name_len);
+        auto it = m_collections.find(coll_name);
+        if(it != m_collections.end()) {
+            coll = it->second;
             return Status::OK;
         }
+        CollectionMetadata metadata;
+        auto status = _collGetMetadata(name, name_len, &metadata);
+        if(status != Status::OK) return status;
+        if(metadata.reserved_id > metadata.next_id) {
+            status = _collRecover(name, name_len, metadata);
+            if(status != Status::OK) return status;
+        }
+        auto new_coll = std::make_shared<Collection>(m_lock != ABT_RWLOCK_NULL, metadata);
+        status = _collLoadIndexes(name, name_len, *new_coll);
+        if(status != Status::OK) return status;
+        coll = std::move(new_coll);
+        m_collections.emplace(std::move(coll_name), coll);
+        return Status::OK;
+    }
+
+    Status _collGetMetadata(const char* name, size_t name_size, CollectionMetadata* metadata) const {
         size_t klen = name_size;
         size_t vlen = sizeof(*metadata);
         UserMem key_umem{const_cast<char*>(name), klen};
@@ -450,34 +945,366 @@ class DocumentStoreMixin : public DB {
         BasicUserMem<size_t> vsize_umem{&vlen, 1};
         auto status = const_cast<DocumentStoreMixin*>(this)->get(0, true, key_umem, ksize_umem, val_umem, vsize_umem);
         if(status != Status::OK) return status;
-        if(vlen == YOKAN_KEY_NOT_FOUND) return Status::NotFound;
-        if(vlen != sizeof(*metadata)) return Status::Corruption;
-        if(it != m_cached_metadata.end())
-            it->second = *metadata;
-        else
-            m_cached_metadata[coll_name] = *metadata;
+        if(vlen == YOKAN_KEY_NOT_FOUND || vlen == s_tombstone_size) return Status::NotFound;
+        if(vlen == s_legacy_metadata_size)
+            metadata->reserved_id = metadata->next_id;
+        else if(vlen != sizeof(*metadata))
+            return Status::Corruption;
         return Status::OK;
     }
 
-    Status _collPutMetadata(const char* name, size_t name_size, CollectionMetadata* metadata, bool flush_to_disk=true) {
-        if(name == nullptr || name[0] == '\0')
-            return Status::InvalidArg;
-        if(flush_to_disk) {
-            size_t klen = name_size;
-            size_t vlen = sizeof(*metadata);
-            UserMem key_umem{const_cast<char*>(name), klen};
-            BasicUserMem<size_t> ksize_umem{&klen, 1};
-            UserMem val_umem{reinterpret_cast<char*>(metadata), vlen};
-            BasicUserMem<size_t> vsize_umem{&vlen, 1};
-            auto ret = put(0, key_umem, ksize_umem, val_umem, vsize_umem);
-            if(ret != Status::OK)
-                return ret;
-        }
-        auto coll_name = std::string(name, name_size);
-        m_cached_metadata[coll_name] = *metadata;
+    Status _collPutMetadata(const char* name, size_t name_size, const CollectionMetadata& metadata) {
+        size_t klen = name_size;
+        size_t vlen = sizeof(metadata);
+        UserMem key_umem{const_cast<char*>(name), klen};
+        BasicUserMem<size_t> ksize_umem{&klen, 1};
+        UserMem val_umem{reinterpret_cast<char*>(const_cast<CollectionMetadata*>(&metadata)), vlen};
+        BasicUserMem<size_t> vsize_umem{&vlen, 1};
+        return put(0, key_umem, ksize_umem, val_umem, vsize_umem);
+    }
+
+    Status _collGetDropped(const char* name, size_t name_size, bool* dropped, yk_id_t* end_id) {
+        size_t klen = name_size;
+        size_t vlen = s_tombstone_size;
+        UserMem key_umem{const_cast<char*>(name), klen};
+        BasicUserMem<size_t> ksize_umem{&klen, 1};
+        UserMem val_umem{reinterpret_cast<char*>(end_id), vlen};
+        BasicUserMem<size_t> vsize_umem{&vlen, 1};
+        auto status = get(0, true, key_umem, ksize_umem, val_umem, vsize_umem);
+        if(status != Status::OK) return status;
+        *dropped = (vlen == s_tombstone_size);
+        return Status::OK;
+    }
+
+    Status _collPutDropped(const char* name, size_t name_size, yk_id_t end_id) {
+        size_t klen = name_size;
+        size_t vlen = s_tombstone_size;
+        UserMem key_umem{const_cast<char*>(name), klen};
+        BasicUserMem<size_t> ksize_umem{&klen, 1};
+        UserMem val_umem{reinterpret_cast<char*>(&end_id), vlen};
+        BasicUserMem<size_t> vsize_umem{&vlen, 1};
+        return put(0, key_umem, ksize_umem, val_umem, vsize_umem);
+    }
+
+    /* Erases the documents of a dropped collection, then its indexes,
+     * then its tombstone.
+     * The documents are erased with a single eraseRange if the backend
+     * supports it, otherwise s_chunk_size ids at a time, so that
+     * neither the memory needed nor the duration of each erase grows
+     * with the number of ids the collection ever allocated. */
+    Status _collPurge(const char* name, size_t name_len, yk_id_t end_id) {
+        auto from_key = _keyFromId(name, name_len, 0);
+        auto to_key   = _keyFromId(name, name_len, end_id);
+        auto status = eraseRange(0, from_key, to_key);
+        if(status == Status::NotSupported) {
+            status = Status::OK;
+            std::vector<yk_id_t> ids;
+            for(yk_id_t first = 0; first < end_id && status == Status::OK; first += s_chunk_size) {
+                ids.resize(std::min(s_chunk_size, end_id - first));
+                for(size_t i = 0; i < ids.size(); i++) {
+                    ids[i] = first + i;
+                }
+                auto keys = _keysFromIds(name, name_len, ids);
+                std::vector<size_t> ksizes(ids.size(), name_len+1+sizeof(yk_id_t));
+                status = erase(0, keys, ksizes);
+                ABT_thread_yield();
+            }
+        }
+        if(status != Status::OK) return status;
+        status = _erasePrefix(_indexesKey(name, name_len));
+        if(status != Status::OK) return status;
+        size_t klen = name_len;
+        UserMem key_umem{const_cast<char*>(name), klen};
+        return erase(0, key_umem, BasicUserMem<size_t>{&klen, 1});
+    }
+
+    /* Looks up the documents that may have been stored after the last
+     * checkpoint, i.e. with ids in [next_id, reserved_id), to recover
+     * the size and next_id of a collection that was not closed cleanly,
+     * then writes the recovered metadata. */
+    Status _collRecover(const char* name, size_t name_len, CollectionMetadata& metadata) const {
+        auto count = metadata.reserved_id - metadata.next_id;
+        std::vector<yk_id_t> ids(count);
+        for(yk_id_t i = 0; i < count; i++) {
+            ids[i] = metadata.next_id + i;
+        }
+        auto keys = _keysFromIds(name, name_len, ids);
+        std::vector<size_t> ksizes(count, name_len+1+sizeof(yk_id_t));
+        std::vector<uint8_t> docs_exist(1+count/8);
+        auto docs_exist_bf = BitField{docs_exist.data(), count};
+        auto status = exists(0, keys, ksizes, docs_exist_bf);
+        if(status != Status::OK) return status;
+        for(size_t i = 0; i < count; i++) {
+            if(!docs_exist_bf[i]) continue;
+            metadata.size += 1;
+            metadata.next_id = ids[i] + 1;
+        }
+        metadata.reserved_id = metadata.next_id;
+        return const_cast<DocumentStoreMixin*>(this)->_collPutMetadata(name, name_len, metadata);
+    }
+
+    /* Makes sure that the stored metadata reserves the ids below end
+     * before documents are written with them. */
+    Status _collReserve(const char* name, size_t name_len, Collection& coll, yk_id_t end) {
+        if(end <= coll.reserved_id) return Status::OK;
+        ScopedMutex mutex(coll.mutex);
+        if(end <= coll.reserved_id) return Status::OK;
+        CollectionMetadata metadata;
+        metadata.size        = coll.checkpoint_size;
+        metadata.next_id     = coll.checkpoint_next_id;
+        metadata.reserved_id = end + s_id_reservation;
+        auto status = _collPutMetadata(name, name_len, metadata);
+        if(status == Status::OK)
+            coll.reserved_id = metadata.reserved_id;
+        return status;
+    }
+
+    /* Adds to the size of the collection documents stored with ids below
+     * the checkpointed next_id, which recovery would not find, writing
+     * the new size right away. The caller must hold the read lock, and
+     * these documents must not be counted by the checkpointed size yet. */
+    Status _collGrow(const char* name, size_t name_len, Collection& coll, yk_id_t added) {
+        if(added == 0) return Status::OK;
+        coll.size += added;
+        ScopedMutex mutex(coll.mutex);
+        CollectionMetadata metadata;
+        metadata.size        = coll.checkpoint_size + added;
+        metadata.next_id     = coll.checkpoint_next_id;
+        metadata.reserved_id = coll.reserved_id;
+        auto status = _collPutMetadata(name, name_len, metadata);
+        if(status == Status::OK)
+            coll.checkpoint_size = metadata.size;
+        return status;
+    }
+
+    /* Removes the id from the collection's unfilled reserved ids, returning
+     * false if it was not one of them. The caller must hold coll.mutex. */
+    static bool _collClaimReserved(Collection& coll, yk_id_t id) {
+        auto it = coll.unfilled.upper_bound(id);
+        if(it == coll.unfilled.begin()) return false;
+        --it;
+        auto first = it->first, end = it->second;
+        if(id >= end) return false;
+        coll.unfilled.erase(it);
+        if(first < id) coll.unfilled.emplace(first, id);
+        if(id + 1 < end) coll.unfilled.emplace(id + 1, end);
+        return true;
+    }
+
+    /* Removes all the ids from the collection's unfilled reserved ids, or
+     * none of them if one is not (or appears twice in ids). */
+    static bool _collClaimReserved(Collection& coll, const BasicUserMem<yk_id_t>& ids) {
+        ScopedMutex mutex(coll.mutex);
+        size_t i = 0;
+        for(; i < ids.size; i++) {
+            if(!_collClaimReserved(coll, ids[i])) break;
+        }
+        if(i == ids.size) return true;
+        for(size_t j = 0; j < i; j++)
+            coll.unfilled.emplace(ids[j], ids[j] + 1);
+        return false;
+    }
+
+    /* Writes the current size and next_id of the collection, reserving
+     * the ids below reserved_id. The caller must hold the collection's
+     * write lock, so that no document is being stored or erased. */
+    Status _collCheckpoint(const char* name, size_t name_len, Collection& coll, yk_id_t reserved_id) {
+        ScopedMutex mutex(coll.mutex);
+        CollectionMetadata metadata;
+        metadata.size        = coll.size;
+        metadata.next_id     = coll.next_id;
+        metadata.reserved_id = std::max(reserved_id, metadata.next_id);
+        auto status = _collPutMetadata(name, name_len, metadata);
+        if(status != Status::OK) return status;
+        coll.checkpoint_size    = metadata.size;
+        coll.checkpoint_next_id = metadata.next_id;
+        coll.reserved_id        = metadata.reserved_id;
+        return Status::OK;
+    }
+
+    static std::string _indexesKey(const char* name, size_t name_len) {
+        std::string key(1, '\0');
+        key.append(name, name_len);
+        key.push_back('\0');
+        return key;
+    }
+
+    static IndexPtr _makeIndex(const char* name, size_t name_len,
+                               const DocIndexSpec& spec,
+                               std::shared_ptr<DocIndexer> indexer) {
+        auto index = std::make_shared<Index>();
+        index->spec    = spec;
+        index->indexer = std::move(indexer);
+        index->prefix  = _indexesKey(name, name_len) + spec.name;
+        index->prefix.push_back('\0');
+        return index;
+    }
+
+    static void _appendEscaped(std::string& entry, const std::string& key) {
+        for(auto c : key) {
+            entry.push_back(c);
+            if(c == '\0') entry.push_back('\1');
+        }
+        entry.append(2, '\0');
+    }
+
+    /* Appends to keys and ksizes the entries of a document in the indexes. */
+    static void _indexEntries(const std::vector<IndexPtr>& indexes, yk_id_t id,
+                              const void* doc, size_t docsize,
+                              std::vector<char>& keys, std::vector<size_t>& ksizes) {
+        std::string key, entry;
+        auto be_id = _ensureBigEndian(id);
+        for(auto& index : indexes) {
+            if(!index->indexer->indexKey(doc, docsize, key)) continue;
+            entry = index->prefix;
+            _appendEscaped(entry, key);
+            entry.append(reinterpret_cast<const char*>(&be_id), sizeof(be_id));
+            keys.insert(keys.end(), entry.begin(), entry.end());
+            ksizes.push_back(entry.size());
+        }
+    }
+
+    /* Puts documents along with their entries in the indexes of the
+     * collection, with a single put so that backends that write batches
+     * atomically never expose a document without its entries. keys and
+     * ksizes, those of the documents, are extended with the entries. If
+     * replace is true, the entries of the previous versions of the
+     * documents are erased afterwards (except those that did not change),
+     * and the caller must hold the collection's write lock. This second
+     * step is not atomic with the put: if it fails, or if the provider
+     * stops in between, the stale entries remain until docQuery, which
+     * checks each entry against the current document, skips and erases
+     * them. */
+    Status _docPut(int32_t mode, const Collection& coll, size_t name_len,
+                   const BasicUserMem<yk_id_t>& ids,
+                   std::vector<char>& keys, std::vector<size_t>& ksizes,
+                   const UserMem& documents, const BasicUserMem<size_t>& sizes,
+                   bool replace) {
+        if(coll.indexes.empty())
+            return put(mode, keys, ksizes, documents, sizes);
+        auto count = ids.size;
+        auto status = Status::OK;
+        std::vector<char>   old_entries;
+        std::vector<size_t> old_esizes;
+        if(replace) {
+            status = this->fetch(0, keys, ksizes,
+                [&](const UserMem& key, const UserMem& val) -> Status {
+                    if(val.size != YOKAN_KEY_NOT_FOUND)
+                        _indexEntries(coll.indexes, _idFromKey(name_len, key.data),
+                                      val.data, val.size, old_entries, old_esizes);
+                    return Status::OK;
+                });
+            if(status != Status::OK) return status;
+        }
+        // a document may appear several times, in which case only the
+        // last version is kept, and so are only its entries
+        std::unordered_map<yk_id_t, size_t> last_version;
+        for(size_t i = 0; i < count; i++)
+            last_version[ids[i]] = i;
+        size_t offset = 0;
+        for(size_t i = 0; i < count; i++) {
+            if(last_version[ids[i]] == i)
+                _indexEntries(coll.indexes, ids[i], documents.data + offset, sizes[i], keys, ksizes);
+            offset += sizes[i];
+        }
+        std::vector<size_t> vsizes(ksizes.size(), 0);
+        std::copy(sizes.data, sizes.data + count, vsizes.begin());
+        status = put(mode, keys, ksizes, documents, vsizes);
+        if(status != Status::OK || old_esizes.empty()) return status;
+
+        std::unordered_set<std::string_view> new_entries;
+        offset = count*(name_len+1+sizeof(yk_id_t));
+        for(size_t i = count; i < ksizes.size(); i++) {
+            new_entries.emplace(keys.data() + offset, ksizes[i]);
+            offset += ksizes[i];
+        }
+        std::vector<char>   stale_entries;
+        std::vector<size_t> stale_esizes;
+        offset = 0;
+        for(auto esize : old_esizes) {
+            auto entry = old_entries.data() + offset;
+            if(!new_entries.count(std::string_view{entry, esize})) {
+                stale_entries.insert(stale_entries.end(), entry, entry + esize);
+                stale_esizes.push_back(esize);
+            }
+            offset += esize;
+        }
+        if(stale_esizes.empty()) return Status::OK;
+        return erase(0, stale_entries, stale_esizes);
+    }
+
+    /* Erases the keys that start with prefix (which ends with '\0'), with
+     * a single eraseRange if the backend supports it, otherwise listing
+     * them s_chunk_size at a time. Only sorted backends have such keys. */
+    Status _erasePrefix(const std::string& prefix) {
+        std::vector<char> from_key(prefix.begin(), prefix.end());
+        auto to_key = from_key;
+        to_key.back() = '\1';
+        auto status = eraseRange(0, from_key, to_key);
+        if(status != Status::NotSupported) return status;
+        if(!isSorted()) return Status::OK;
+        auto filter = FilterFactory::makeKeyValueFilter(MARGO_INSTANCE_NULL, 0, from_key);
+        std::vector<char>   keys;
+        std::vector<size_t> ksizes;
+        do {
+            keys.clear();
+            ksizes.clear();
+            status = this->iter(YOKAN_MODE_INCLUSIVE, s_chunk_size, from_key, filter, true,
+                [&keys, &ksizes](const UserMem& key, const UserMem&) -> Status {
+                    keys.insert(keys.end(), key.data, key.data + key.size);
+                    ksizes.push_back(key.size);
+                    return Status::OK;
+                });
+            if(status == Status::OK && !ksizes.empty())
+                status = erase(0, keys, ksizes);
+            ABT_thread_yield();
+        } while(status == Status::OK && ksizes.size() == s_chunk_size);
+        return status;
+    }
+
+    /* Loads the definitions of the indexes of a collection. */
+    Status _collLoadIndexes(const char* name, size_t name_len, Collection& coll) const {
+        if(!isSorted()) return Status::OK;
+        auto key = _indexesKey(name, name_len);
+        size_t klen = key.size();
+        size_t vlen;
+        UserMem key_umem{&key[0], klen};
+        BasicUserMem<size_t> ksize_umem{&klen, 1};
+        BasicUserMem<size_t> vsize_umem{&vlen, 1};
+        auto status = length(0, key_umem, ksize_umem, vsize_umem);
+        if(status != Status::OK) return status;
+        if(vlen == YOKAN_KEY_NOT_FOUND) return Status::OK;
+        std::vector<char> value(vlen);
+        UserMem val_umem{value};
+        status = const_cast<DocumentStoreMixin*>(this)->get(0, true, key_umem, ksize_umem, val_umem, vsize_umem);
+        if(status != Status::OK) return status;
+        std::vector<DocIndexSpec> specs;
+        if(vlen != value.size() || !DocIndexSpec::unpack(value.data(), vlen, specs))
+            return Status::Corruption;
+        for(auto& spec : specs) {
+            auto indexer = DocIndexerFactory::makeDocIndexer(spec);
+            // documents cannot be written without updating the index
+            if(!indexer) return Status::InvalidConf;
+            coll.indexes.push_back(_makeIndex(name, name_len, spec, std::move(indexer)));
+        }
         return Status::OK;
     }
 
+    Status _collPutIndexes(const char* name, size_t name_len, const std::vector<IndexPtr>& indexes) {
+        auto key = _indexesKey(name, name_len);
+        size_t klen = key.size();
+        UserMem key_umem{&key[0], klen};
+        BasicUserMem<size_t> ksize_umem{&klen, 1};
+        if(indexes.empty())
+            return erase(0, key_umem, ksize_umem);
+        std::vector<DocIndexSpec> specs;
+        for(auto& index : indexes) specs.push_back(index->spec);
+        auto value = DocIndexSpec::pack(specs);
+        size_t vlen = value.size();
+        UserMem val_umem{&value[0], vlen};
+        return put(0, key_umem, ksize_umem, val_umem, BasicUserMem<size_t>{&vlen, 1});
+    }
+
     static std::vector<char> _keysFromIds(const char* name, size_t name_size, const BasicUserMem<yk_id_t>& ids) {
         auto count = ids.size;
         auto len = name_size;
@@ -6,6 +6,7 @@
 #ifndef __YOKAN_FILTERS_H
 #define __YOKAN_FILTERS_H
 
+#include <cstdint>
 #include <limits>
 #include <vector>
 #include <string>
@@ -107,6 +108,24 @@ class KeyValueFilter {
         (void)vsize;
         return false;
     }
+
+    /**
+     * @brief Checks a block of n key/value pairs at once, setting
+     * results[i] to 1 if the i-th pair passes the filter, 0 otherwise.
+     * Backends call this function on blocks of consecutive candidates
+     * instead of calling check for each of them, so filters may override
+     * it to amortize the cost of a virtual call per key, or to vectorize
+     * the check (e.g. on fixed-size keys). vals and vsizes may contain
+     * nullptr and 0 if requiresValue() returns false. The default
+     * implementation calls check on each pair. It is declared last so that
+     * filter libraries built before it was added keep their vtable layout.
+     */
+    virtual void checkBatch(const void* const* keys, const size_t* ksizes,
+                            const void* const* vals, const size_t* vsizes,
+                            uint8_t* results, size_t n) const {
+        for(size_t i = 0; i < n; i++)
+            results[i] = check(keys[i], ksizes[i], vals[i], vsizes[i]);
+    }
 };
 
 /**
@@ -167,6 +186,21 @@ class DocFilter {
         (void)size;
         return false;
     }
+
+    /**
+     * @brief Checks a block of n documents of a collection at once,
+     * setting results[i] to 1 if the i-th document passes the filter,
+     * 0 otherwise (see KeyValueFilter::checkBatch). The default
+     * implementation calls check on each document. It is declared last
+     * for the same reason as KeyValueFilter::checkBatch.
+     */
+    virtual void checkBatch(
+        const char* collection,
+        const yk_id_t* ids, const void* const* docs, const size_t* docsizes,
+        uint8_t* results, size_t n) const {
+        for(size_t i = 0; i < n; i++)
+            results[i] = check(collection, ids[i], docs[i], docsizes[i]);
+    }
 };
 
 /**
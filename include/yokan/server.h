@@ -30,9 +30,17 @@ struct yk_provider_args {
         remi_client_t   client;
         remi_provider_t provider;
     } remi; // REMI information (yokan needs to be built with ENABLE_REMI)
+    struct {
+        ABT_pool read;  // count, get, fetch, length, exists
+        ABT_pool write; // put, erase
+        ABT_pool scan;  // list_keys, list_keyvals, iter, doc_list, doc_iter
+        ABT_pool doc;   // other collection and document operations
+        ABT_pool admin; // administrative operations
+    } pools; // Per-class pools, overriding the above pool (if not ABT_POOL_NULL)
 };
 
-#define YOKAN_PROVIDER_ARGS_INIT { ABT_POOL_NULL, NULL, {NULL, NULL} }
+#define YOKAN_PROVIDER_ARGS_INIT { ABT_POOL_NULL, NULL, {NULL, NULL}, \
+    { ABT_POOL_NULL, ABT_POOL_NULL, ABT_POOL_NULL, ABT_POOL_NULL, ABT_POOL_NULL } }
 
 /**
  * @brief Creates a new YOKAN provider. If YOKAN_PROVIDER_IGNORE
@@ -86,6 +94,27 @@ yk_return_t yk_provider_migrate_database(
  */
 char* yk_provider_get_config(yk_provider_t provider);
 
+/**
+ * @brief Returns the YOKAN provider's metrics as a JSON string:
+ * per-RPC and per-backend-call counts, errors, bytes, and latency
+ * histograms, the bulk cache hit ratio, the size of its pools, and
+ * (if enabled with the "hot_keys" configuration) the most accessed keys
+ * and collections. The returned string must be free-ed by the caller.
+ */
+char* yk_provider_get_stats(yk_provider_t provider);
+
+/**
+ * @brief Writes the requests traced by the YOKAN provider (see the
+ * "tracing" section of its configuration) to the given file in the
+ * Chrome trace event format, and clears them.
+ *
+ * @param provider Provider.
+ * @param filename Output file.
+ *
+ * @return YOKAN_SUCCESS or error code defined in common.h
+ */
+yk_return_t yk_provider_dump_trace(yk_provider_t provider, const char* filename);
+
 #ifdef __cplusplus
 }
 #endif
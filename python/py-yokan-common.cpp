@@ -27,5 +27,6 @@ PYBIND11_MODULE(pyyokan_common, m) {
     m.attr("YOKAN_MODE_FILTER_VALUE") = YOKAN_MODE_FILTER_VALUE;
     m.attr("YOKAN_MODE_LIB_FILTER")   = YOKAN_MODE_LIB_FILTER;
     m.attr("YOKAN_MODE_NO_RDMA")      = YOKAN_MODE_NO_RDMA;
+    m.attr("YOKAN_MODE_JSON_FILTER")  = YOKAN_MODE_JSON_FILTER;
 }
 
@@ -11,6 +11,7 @@
 #include "../common/allocator.hpp"
 #include "../common/modes.hpp"
 #include "util/key-copy.hpp"
+#include "util/filter-batch.hpp"
 #include <nlohmann/json.hpp>
 #include <unistd.h>
 #include <abt.h>
@@ -149,6 +150,7 @@ class ArrayDatabase : public DatabaseInterface {
                     |YOKAN_MODE_IGNORE_DOCS
                     |YOKAN_MODE_FILTER_VALUE
                     |YOKAN_MODE_LIB_FILTER
+                    |YOKAN_MODE_JSON_FILTER
                     |YOKAN_MODE_NO_RDMA
                     |YOKAN_MODE_UPDATE_NEW
                     )
@@ -206,6 +208,24 @@ class ArrayDatabase : public DatabaseInterface {
         return Status::OK;
     }
 
+    Status collReserveIDs(int32_t mode, const char* name,
+                          size_t count, yk_id_t* first_id) override {
+        (void)mode;
+        ScopedReadLock db_lock(m_lock);
+        auto p = m_collections.find(name);
+        if(p == m_collections.end())
+            return Status::NotFound;
+        auto& coll = p->second;
+
+        ScopedWriteLock coll_lock(coll.m_lock);
+        if(count == 0 || count > coll.m_sizes.max_size() - coll.m_sizes.size())
+            return Status::InvalidArg;
+        *first_id = coll.m_sizes.size();
+        coll.m_sizes.resize(coll.m_sizes.size() + count, YOKAN_KEY_NOT_FOUND);
+        coll.m_offsets.resize(coll.m_offsets.size() + count, YOKAN_KEY_NOT_FOUND);
+        return Status::OK;
+    }
+
     Status docSize(const char* collection,
                    int32_t mode,
                    const BasicUserMem<yk_id_t>& ids,
@@ -498,30 +518,30 @@ class ArrayDatabase : public DatabaseInterface {
         ScopedReadLock coll_lock(coll.m_lock);
         yk_id_t id = from_id;
         size_t i = 0;
-        std::vector<char> doc_buffer;
-        while(i < max && id < coll.m_sizes.size()) {
-            if(coll.m_sizes[id] == YOKAN_KEY_NOT_FOUND) {
-                ++id;
-                continue;
+        DocBatch<> batch;
+        bool stop = false;
+        while(!stop && (max == 0 || i < max) && id < coll.m_sizes.size()) {
+            batch.clear();
+            auto n = batch.limit(max, i);
+            for(; batch.size < n && id < coll.m_sizes.size(); ++id) {
+                if(coll.m_sizes[id] == YOKAN_KEY_NOT_FOUND)
+                    continue;
+                batch.push(id, coll.m_data.data() + coll.m_offsets[id], coll.m_sizes[id]);
             }
-            auto doc_size = coll.m_sizes[id];
-            auto doc_offset = coll.m_offsets[id];
-            auto doc_ptr = coll.m_data.data() + doc_offset;
-            if(!filter->check(collection, id, doc_ptr, doc_size)) {
-                if(filter->shouldStop(collection, doc_ptr, doc_size))
-                    break;
-                ++id;
-                continue;
+            batch.check(collection, filter);
+            for(size_t j = 0; j < batch.size && !stop; j++) {
+                auto doc_size = batch.docsizes[j];
+                auto doc_ptr = static_cast<const char*>(batch.docs[j]);
+                if(!batch.results[j]) {
+                    stop = filter->shouldStop(collection, doc_ptr, doc_size);
+                    continue;
+                }
+                // the filter's docCopy is applied by the caller
+                auto status = func(batch.ids[j], UserMem{const_cast<char*>(doc_ptr), doc_size});
+                if(status != Status::OK)
+                    return status;
+                ++i;
             }
-            auto filtered_size = filter->docSizeFrom(collection, doc_ptr, doc_size);
-            doc_buffer.resize(filtered_size);
-            filtered_size = filter->docCopy(
-                collection, doc_buffer.data(), filtered_size, doc_ptr, doc_size);
-            auto status = func(id, UserMem{doc_buffer.data(), filtered_size});
-            if(status != Status::OK)
-                return status;
-            ++id;
-            ++i;
         }
 
         return Status::OK;
@@ -170,6 +170,7 @@ class BerkeleyDBDatabase : public DocumentStoreMixin<DatabaseInterface> {
                     |YOKAN_MODE_IGNORE_DOCS
                     |YOKAN_MODE_FILTER_VALUE
                     |YOKAN_MODE_LIB_FILTER
+                    |YOKAN_MODE_JSON_FILTER
                     |YOKAN_MODE_NO_RDMA
                     |YOKAN_MODE_UPDATE_NEW
                     )
@@ -822,6 +823,7 @@ class BerkeleyDBDatabase : public DocumentStoreMixin<DatabaseInterface> {
 
     ~BerkeleyDBDatabase() {
         if(m_db) {
+            flushCollections();
             m_db->close(0);
             delete m_db;
         }
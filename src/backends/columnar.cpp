@@ -0,0 +1,823 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#include "yokan/backend.hpp"
+#include "yokan/util/locks.hpp"
+#include "../server/util/record_filter.hpp"
+#include "util/filter-batch.hpp"
+#include <nlohmann/json.hpp>
+#include <abt.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace yokan {
+
+using json = nlohmann::json;
+
+/**
+ * Backend storing collections of fixed-size binary documents (records)
+ * column by column: the bytes of each field declared by the schema of a
+ * collection are stored contiguously, chunk_size records at a time, so
+ * that scanning a few fields only reads these fields. Full chunks are
+ * run-length encoded column by column if "compression" is "rle" (and
+ * if that makes the column smaller). Records are reassembled from their
+ * columns by docLoad and docFetch, and the conditions of a
+ * RecordDocFilter are evaluated on the columns by docIter and docList,
+ * which only reassemble the parts of the records that are selected.
+ *
+ * Configuration:
+ *
+ * {
+ *     "use_lock": true,
+ *     "chunk_size": 4096,
+ *     "compression": "none",
+ *     "schema": {
+ *         "record_size": 20,
+ *         "fields": [ {"name": "time",  "offset": 0,  "size": 8},
+ *                     {"name": "value", "offset": 8,  "size": 8},
+ *                     {"name": "flags", "offset": 16, "size": 4} ]
+ *     },
+ *     "collections": { "<name>": <schema>, ... }
+ * }
+ *
+ * "schema" is the schema of the collections that are not listed in
+ * "collections"; collections without a schema cannot be created. The
+ * bytes of the records that are not part of any field are stored as
+ * additional columns.
+ */
+class ColumnarDatabase : public DatabaseInterface {
+
+    /* Layout of the records of a collection: columns, as [offset, width]
+     * pairs sorted by offset, cover the records without overlapping. */
+    struct Schema {
+        size_t                                record_size = 0;
+        std::vector<std::pair<size_t,size_t>> columns;
+    };
+
+    /* Values of a column for the records of a chunk: either width bytes
+     * per record or, if the column is run-length encoded, width bytes per
+     * run of identical values, run i ending before record ends[i]. */
+    struct ColumnChunk {
+
+        std::vector<char>     data;
+        std::vector<uint32_t> ends;
+
+        bool encoded() const {
+            return !ends.empty();
+        }
+
+        const char* value(size_t row, size_t width) const {
+            if(!encoded()) return data.data() + row*width;
+            auto run = std::upper_bound(ends.begin(), ends.end(), row) - ends.begin();
+            return data.data() + run*width;
+        }
+
+        void encode(size_t count, size_t width) {
+            std::vector<char>     runs;
+            std::vector<uint32_t> run_ends;
+            for(size_t row = 0; row < count; row++) {
+                auto v = data.data() + row*width;
+                if(row == 0 || std::memcmp(v, runs.data() + runs.size() - width, width) != 0) {
+                    if(row != 0) run_ends.push_back(row);
+                    runs.insert(runs.end(), v, v + width);
+                }
+            }
+            run_ends.push_back(count);
+            if(runs.size() + run_ends.size()*sizeof(uint32_t) >= data.size())
+                return;
+            data = std::move(runs);
+            ends = std::move(run_ends);
+        }
+
+        void decode(size_t width) {
+            std::vector<char> values;
+            values.reserve(ends.back()*width);
+            uint32_t row = 0;
+            for(size_t run = 0; run < ends.size(); run++) {
+                for(; row < ends[run]; row++)
+                    values.insert(values.end(), data.data() + run*width, data.data() + (run+1)*width);
+            }
+            data = std::move(values);
+            ends.clear();
+        }
+    };
+
+    struct Chunk {
+        size_t                   count = 0; // number of ids in the chunk
+        std::vector<uint8_t>     present;   // whether each id has a document
+        std::vector<ColumnChunk> columns;
+    };
+
+    struct Collection {
+
+        Schema             m_schema;
+        std::vector<Chunk> m_chunks;
+        size_t             m_next_id = 0;
+        size_t             m_count   = 0;
+        ABT_rwlock         m_lock    = ABT_RWLOCK_NULL;
+
+        Collection(Schema schema, bool use_lock)
+        : m_schema(std::move(schema)) {
+            if(use_lock)
+                ABT_rwlock_create(&m_lock);
+        }
+
+        ~Collection() {
+            if(m_lock != ABT_RWLOCK_NULL)
+                ABT_rwlock_free(&m_lock);
+        }
+
+        Collection(const Collection&) = delete;
+        Collection& operator=(const Collection&) = delete;
+
+        bool exists(yk_id_t id, size_t chunk_size) const {
+            if(id >= m_next_id) return false;
+            return m_chunks[id / chunk_size].present[id % chunk_size];
+        }
+
+        /* Copies bytes [offset, offset+length) of the record of the given
+         * row of the chunk, taking them from the columns they belong to. */
+        void read(const Chunk& chunk, size_t row, size_t offset, size_t length, char* dst) const {
+            auto end = offset + length;
+            for(size_t c = 0; c < m_schema.columns.size(); c++) {
+                auto col_offset = m_schema.columns[c].first;
+                auto width      = m_schema.columns[c].second;
+                if(col_offset >= end) break;
+                if(col_offset + width <= offset) continue;
+                auto from = std::max(offset, col_offset);
+                auto to   = std::min(end, col_offset + width);
+                auto src  = chunk.columns[c].value(row, width) + (from - col_offset);
+                std::memcpy(dst + (from - offset), src, to - from);
+            }
+        }
+
+        void readRecord(yk_id_t id, size_t chunk_size, char* dst) const {
+            read(m_chunks[id / chunk_size], id % chunk_size, 0, m_schema.record_size, dst);
+        }
+
+        /* Adds ids up to id (included) without documents. */
+        void extend(yk_id_t id, size_t chunk_size) {
+            for(; m_next_id <= id; m_next_id++)
+                append(nullptr, chunk_size);
+        }
+
+        void append(const char* record, size_t chunk_size) {
+            if(m_next_id % chunk_size == 0) {
+                m_chunks.emplace_back();
+                m_chunks.back().columns.resize(m_schema.columns.size());
+            }
+            auto& chunk = m_chunks.back();
+            for(size_t c = 0; c < m_schema.columns.size(); c++) {
+                auto& data = chunk.columns[c].data;
+                auto offset = m_schema.columns[c].first;
+                auto width  = m_schema.columns[c].second;
+                if(record) data.insert(data.end(), record + offset, record + offset + width);
+                else data.resize(data.size() + width, 0);
+            }
+            chunk.present.push_back(record != nullptr);
+            chunk.count += 1;
+            if(record) m_count += 1;
+        }
+
+        void write(yk_id_t id, const char* record, size_t chunk_size) {
+            auto& chunk = m_chunks[id / chunk_size];
+            auto row = id % chunk_size;
+            for(size_t c = 0; c < m_schema.columns.size(); c++) {
+                auto offset = m_schema.columns[c].first;
+                auto width  = m_schema.columns[c].second;
+                auto& col = chunk.columns[c];
+                if(col.encoded()) col.decode(width);
+                std::memcpy(col.data.data() + row*width, record + offset, width);
+            }
+            if(!chunk.present[row]) {
+                chunk.present[row] = 1;
+                m_count += 1;
+            }
+        }
+
+        void encode(Chunk& chunk) {
+            for(size_t c = 0; c < m_schema.columns.size(); c++) {
+                auto& col = chunk.columns[c];
+                if(!col.encoded()) col.encode(chunk.count, m_schema.columns[c].second);
+            }
+        }
+    };
+
+    public:
+
+    static Status create(const std::string& config, DatabaseInterface** kvs) {
+        json cfg;
+        Schema default_schema;
+        std::unordered_map<std::string, Schema> schemas;
+        try {
+            cfg = json::parse(config);
+            if(!cfg.is_object())
+                return Status::InvalidConf;
+            cfg["use_lock"] = cfg.value("use_lock", true);
+            auto chunk_size = cfg.value("chunk_size", (size_t)4096);
+            if(chunk_size == 0 || chunk_size > UINT32_MAX)
+                return Status::InvalidConf;
+            cfg["chunk_size"] = chunk_size;
+            auto compression = cfg.value("compression", std::string{"none"});
+            if(compression != "none" && compression != "rle")
+                return Status::InvalidConf;
+            cfg["compression"] = compression;
+            if(cfg.contains("schema") && !parseSchema(cfg["schema"], default_schema))
+                return Status::InvalidConf;
+            if(cfg.contains("collections")) {
+                if(!cfg["collections"].is_object())
+                    return Status::InvalidConf;
+                for(auto& p : cfg["collections"].items()) {
+                    if(!parseSchema(p.value(), schemas[p.key()]))
+                        return Status::InvalidConf;
+                }
+            }
+        } catch(...) {
+            return Status::InvalidConf;
+        }
+        *kvs = new ColumnarDatabase(std::move(cfg), std::move(default_schema), std::move(schemas));
+        return Status::OK;
+    }
+
+    // LCOV_EXCL_START
+    virtual std::string type() const override {
+        return "columnar";
+    }
+    // LCOV_EXCL_STOP
+
+    // LCOV_EXCL_START
+    virtual std::string config() const override {
+        return m_config.dump();
+    }
+    // LCOV_EXCL_STOP
+
+    virtual bool supportsMode(int32_t mode) const override {
+        return mode ==
+            (mode & (
+                     YOKAN_MODE_INCLUSIVE
+#ifdef YOKAN_HAS_LUA
+                    |YOKAN_MODE_LUA_FILTER
+#endif
+                    |YOKAN_MODE_IGNORE_DOCS
+                    |YOKAN_MODE_FILTER_VALUE
+                    |YOKAN_MODE_LIB_FILTER
+                    |YOKAN_MODE_JSON_FILTER
+                    |YOKAN_MODE_NO_RDMA
+                    |YOKAN_MODE_UPDATE_NEW
+                    )
+            );
+    }
+
+    bool isSorted() const override {
+        return true;
+    }
+
+    Status collCreate(int32_t mode, const char* name) override {
+        (void)mode;
+        ScopedWriteLock lock(m_lock);
+        if(m_collections.count(name))
+            return Status::KeyExists;
+        auto it = m_schemas.find(name);
+        if(it == m_schemas.end() && m_default_schema.record_size == 0)
+            return Status::InvalidArg;
+        auto& schema = it == m_schemas.end() ? m_default_schema : it->second;
+        m_collections.emplace(std::piecewise_construct,
+            std::forward_as_tuple(name),
+            std::forward_as_tuple(schema, m_lock != ABT_RWLOCK_NULL));
+        return Status::OK;
+    }
+
+    Status collDrop(int32_t mode, const char* name) override {
+        (void)mode;
+        ScopedWriteLock lock(m_lock);
+        if(!m_collections.count(name))
+            return Status::NotFound;
+        m_collections.erase(name);
+        return Status::OK;
+    }
+
+    Status collExists(int32_t mode, const char* name, bool* flag) const override {
+        (void)mode;
+        ScopedReadLock lock(m_lock);
+        *flag = m_collections.count(name) != 0;
+        return Status::OK;
+    }
+
+    Status collLastID(int32_t mode, const char* name, yk_id_t* id) const override {
+        (void)mode;
+        ScopedReadLock lock(m_lock);
+        auto p = m_collections.find(name);
+        if(p == m_collections.end())
+            return Status::NotFound;
+        auto& coll = p->second;
+        ScopedReadLock coll_lock(coll.m_lock);
+        *id = coll.m_next_id-1;
+        return Status::OK;
+    }
+
+    Status collSize(int32_t mode, const char* name, size_t* size) const override {
+        (void)mode;
+        ScopedReadLock lock(m_lock);
+        auto p = m_collections.find(name);
+        if(p == m_collections.end())
+            return Status::NotFound;
+        auto& coll = p->second;
+        ScopedReadLock coll_lock(coll.m_lock);
+        *size = coll.m_count;
+        return Status::OK;
+    }
+
+    Status collReserveIDs(int32_t mode, const char* name,
+                          size_t count, yk_id_t* first_id) override {
+        (void)mode;
+        ScopedReadLock db_lock(m_lock);
+        auto p = m_collections.find(name);
+        if(p == m_collections.end())
+            return Status::NotFound;
+        auto& coll = p->second;
+
+        ScopedWriteLock coll_lock(coll.m_lock);
+        if(count == 0 || count > std::numeric_limits<yk_id_t>::max() - coll.m_next_id)
+            return Status::InvalidArg;
+        *first_id = coll.m_next_id;
+        coll.extend(coll.m_next_id + count - 1, m_chunk_size);
+        return Status::OK;
+    }
+
+    Status docSize(const char* collection,
+                   int32_t mode,
+                   const BasicUserMem<yk_id_t>& ids,
+                   BasicUserMem<size_t>& sizes) const override {
+        (void)mode;
+
+        ScopedReadLock db_lock(m_lock);
+        auto p = m_collections.find(collection);
+        if(p == m_collections.end()) {
+            for(size_t i = 0; i < ids.size; ++i)
+                sizes[i] = YOKAN_KEY_NOT_FOUND;
+            return Status::OK;
+        }
+        auto& coll = p->second;
+
+        ScopedReadLock coll_lock(coll.m_lock);
+        for(size_t i = 0; i < ids.size; ++i) {
+            sizes[i] = coll.exists(ids[i], m_chunk_size) ?
+                coll.m_schema.record_size : YOKAN_KEY_NOT_FOUND;
+        }
+        return Status::OK;
+    }
+
+    Status docStore(const char* collection,
+            int32_t mode,
+            const UserMem& documents,
+            const BasicUserMem<size_t>& sizes,
+            BasicUserMem<yk_id_t>& ids) override {
+        (void)mode;
+
+        ScopedReadLock db_lock(m_lock);
+        auto p = m_collections.find(collection);
+        if(p == m_collections.end())
+            return Status::NotFound;
+        auto& coll = p->second;
+
+        auto record_size = coll.m_schema.record_size;
+        for(size_t i = 0; i < sizes.size; ++i) {
+            if(sizes[i] != record_size)
+                return Status::InvalidArg;
+        }
+
+        ScopedWriteLock coll_lock(coll.m_lock);
+        const char* doc_ptr = documents.data;
+        for(size_t i = 0; i < sizes.size; ++i) {
+            ids[i] = coll.m_next_id;
+            coll.append(doc_ptr, m_chunk_size);
+            coll.m_next_id += 1;
+            doc_ptr += record_size;
+            if(m_compress && coll.m_next_id % m_chunk_size == 0)
+                coll.encode(coll.m_chunks.back());
+        }
+        return Status::OK;
+    }
+
+    Status docUpdate(const char* collection,
+                     int32_t mode,
+                     const BasicUserMem<yk_id_t>& ids,
+                     const UserMem& documents,
+                     const BasicUserMem<size_t>& sizes) override {
+
+        ScopedReadLock db_lock(m_lock);
+        auto p = m_collections.find(collection);
+        if(p == m_collections.end())
+            return Status::NotFound;
+        auto& coll = p->second;
+
+        auto record_size = coll.m_schema.record_size;
+        for(size_t i = 0; i < sizes.size; ++i) {
+            if(sizes[i] != record_size)
+                return Status::InvalidArg;
+        }
+
+        ScopedWriteLock coll_lock(coll.m_lock);
+        yk_id_t max_id = 0;
+        for(size_t i = 0; i < ids.size; ++i) {
+            if(!(mode & YOKAN_MODE_UPDATE_NEW) && ids[i] >= coll.m_next_id)
+                return Status::InvalidID;
+            max_id = std::max(max_id, ids[i]);
+        }
+        if(ids.size && max_id >= coll.m_next_id)
+            coll.extend(max_id, m_chunk_size);
+
+        std::unordered_set<size_t> updated_chunks;
+        const char* doc_ptr = documents.data;
+        for(size_t i = 0; i < ids.size; ++i) {
+            coll.write(ids[i], doc_ptr, m_chunk_size);
+            doc_ptr += record_size;
+            updated_chunks.insert(ids[i] / m_chunk_size);
+        }
+        // full chunks are encoded again once all their updates are written
+        if(m_compress) {
+            for(auto c : updated_chunks) {
+                if(coll.m_chunks[c].count == m_chunk_size)
+                    coll.encode(coll.m_chunks[c]);
+            }
+        }
+        return Status::OK;
+    }
+
+    Status docLoad(const char* collection,
+                   int32_t mode, bool packed,
+                   const BasicUserMem<yk_id_t>& ids,
+                   UserMem& documents,
+                   BasicUserMem<size_t>& sizes) override {
+        (void)mode;
+
+        ScopedReadLock db_lock(m_lock);
+        auto p = m_collections.find(collection);
+        if(p == m_collections.end())
+            return Status::NotFound;
+        auto& coll = p->second;
+
+        ScopedReadLock coll_lock(coll.m_lock);
+        const auto count = ids.size;
+        const auto record_size = coll.m_schema.record_size;
+        char* doc_ptr = documents.data;
+
+        if(packed) {
+
+            size_t remaining = documents.size;
+            for(size_t i = 0; i < count; ++i) {
+                if(!coll.exists(ids[i], m_chunk_size)) {
+                    sizes[i] = YOKAN_KEY_NOT_FOUND;
+                    continue;
+                }
+                if(record_size > remaining) {
+                    for(; i < count; ++i) {
+                        sizes[i] = YOKAN_SIZE_TOO_SMALL;
+                    }
+                    continue;
+                }
+                coll.readRecord(ids[i], m_chunk_size, doc_ptr);
+                sizes[i] = record_size;
+                doc_ptr += record_size;
+                remaining -= record_size;
+            }
+
+        } else {
+
+            for(size_t i = 0; i < count; ++i) {
+                auto buffer_size = sizes[i];
+                if(!coll.exists(ids[i], m_chunk_size)) {
+                    doc_ptr += buffer_size;
+                    sizes[i] = YOKAN_KEY_NOT_FOUND;
+                    continue;
+                }
+                if(record_size > buffer_size) {
+                    sizes[i] = YOKAN_SIZE_TOO_SMALL;
+                    continue;
+                }
+                coll.readRecord(ids[i], m_chunk_size, doc_ptr);
+                sizes[i] = record_size;
+                doc_ptr += buffer_size;
+            }
+
+        }
+        return Status::OK;
+    }
+
+    Status docFetch(const char* collection,
+                    int32_t mode,
+                    const BasicUserMem<yk_id_t>& ids,
+                    const DocFetchCallback& func) override {
+        (void)mode;
+        ScopedReadLock db_lock(m_lock);
+        auto p = m_collections.find(collection);
+        if(p == m_collections.end())
+            return Status::NotFound;
+        auto& coll = p->second;
+
+        ScopedReadLock coll_lock(coll.m_lock);
+        std::vector<char> record(coll.m_schema.record_size);
+
+        for(size_t i = 0; i < ids.size; ++i) {
+            const auto id = ids[i];
+            Status status;
+            if(!coll.exists(id, m_chunk_size)) {
+                status = func(id, UserMem{nullptr, KeyNotFound});
+            } else {
+                coll.readRecord(id, m_chunk_size, record.data());
+                status = func(id, UserMem{record.data(), record.size()});
+            }
+            if(status != Status::OK)
+                return status;
+        }
+        return Status::OK;
+    }
+
+    Status docErase(const char* collection,
+                    int32_t mode,
+                    const BasicUserMem<yk_id_t>& ids) override {
+        (void)mode;
+        ScopedReadLock db_lock(m_lock);
+        auto p = m_collections.find(collection);
+        if(p == m_collections.end())
+            return Status::NotFound;
+        auto& coll = p->second;
+
+        ScopedWriteLock coll_lock(coll.m_lock);
+        for(size_t i = 0; i < ids.size; ++i) {
+            const auto id = ids[i];
+            if(!coll.exists(id, m_chunk_size))
+                continue;
+            // the values of the columns are kept, the scans skip them
+            coll.m_chunks[id / m_chunk_size].present[id % m_chunk_size] = 0;
+            coll.m_count -= 1;
+        }
+        return Status::OK;
+    }
+
+    Status docList(const char* collection,
+            int32_t mode, bool packed,
+            yk_id_t from_id,
+            const std::shared_ptr<DocFilter>& filter,
+            BasicUserMem<yk_id_t>& ids,
+            UserMem& documents,
+            BasicUserMem<size_t>& doc_sizes) const override {
+        (void)mode;
+
+        size_t offset = 0;
+        size_t i = 0;
+        DocIterCallback callback = [&](yk_id_t id, const UserMem& doc) mutable {
+            if(packed) {
+                if(offset + doc.size > documents.size) return Status::StopIteration;
+                std::memcpy(documents.data + offset, doc.data, doc.size);
+                offset += doc.size;
+            } else {
+                if(doc.size > doc_sizes[i]) {
+                    doc_sizes[i] = YOKAN_SIZE_TOO_SMALL;
+                    i++;
+                    return Status::OK;
+                }
+                std::memcpy(documents.data + offset, doc.data, doc.size);
+                offset += doc_sizes[i];
+            }
+            ids[i] = id;
+            doc_sizes[i] = doc.size;
+            i++;
+            return Status::OK;
+        };
+
+        // listed documents are not projected, so they are reassembled entirely
+        auto status = iterate(collection, ids.size, from_id, filter, callback, false);
+
+        for(; i < ids.size; ++i) {
+            ids[i] = YOKAN_NO_MORE_DOCS;
+            doc_sizes[i] = YOKAN_NO_MORE_DOCS;
+        }
+
+        return status;
+    }
+
+    virtual Status docIter(const char* collection,
+            int32_t mode, uint64_t max, yk_id_t from_id,
+            const std::shared_ptr<DocFilter>& filter,
+            const DocIterCallback& func) const override {
+        (void)mode;
+        return iterate(collection, max, from_id, filter, func, true);
+    }
+
+    void destroy() override {
+        ScopedWriteLock lock(m_lock);
+        m_collections.clear();
+    }
+
+    ~ColumnarDatabase() {
+        if(m_lock != ABT_RWLOCK_NULL)
+            ABT_rwlock_free(&m_lock);
+    }
+
+    private:
+
+    /* If projected is true, only the byte ranges a RecordDocFilter
+     * projects the documents onto are filled in the documents passed
+     * to func, the caller then applying the filter's docCopy. */
+    Status iterate(const char* collection, uint64_t max, yk_id_t from_id,
+                   const std::shared_ptr<DocFilter>& filter,
+                   const DocIterCallback& func, bool projected) const {
+        ScopedReadLock db_lock(m_lock);
+        auto p = m_collections.find(collection);
+        if(p == m_collections.end())
+            return Status::NotFound;
+        auto& coll = p->second;
+
+        ScopedReadLock coll_lock(coll.m_lock);
+        auto record_filter = std::dynamic_pointer_cast<RecordDocFilter>(filter);
+        if(record_filter)
+            return scanColumns(coll, max, from_id, *record_filter, func, projected);
+
+        const auto record_size = coll.m_schema.record_size;
+        std::vector<char> records(DocBatch<>::capacity * record_size);
+        yk_id_t id = from_id;
+        size_t i = 0;
+        DocBatch<> batch;
+        bool stop = false;
+        while(!stop && (max == 0 || i < max) && id < coll.m_next_id) {
+            batch.clear();
+            auto n = batch.limit(max, i);
+            for(; batch.size < n && id < coll.m_next_id; ++id) {
+                if(!coll.exists(id, m_chunk_size))
+                    continue;
+                auto record = records.data() + batch.size * record_size;
+                coll.readRecord(id, m_chunk_size, record);
+                batch.push(id, record, record_size);
+            }
+            batch.check(collection, filter);
+            for(size_t j = 0; j < batch.size && !stop; j++) {
+                auto doc_ptr = static_cast<const char*>(batch.docs[j]);
+                if(!batch.results[j]) {
+                    stop = filter->shouldStop(collection, doc_ptr, record_size);
+                    continue;
+                }
+                // the filter's docCopy is applied by the caller
+                auto status = func(batch.ids[j], UserMem{const_cast<char*>(doc_ptr), record_size});
+                if(status != Status::OK)
+                    return status;
+                ++i;
+            }
+        }
+
+        return Status::OK;
+    }
+
+    ColumnarDatabase(json cfg, Schema default_schema,
+                     std::unordered_map<std::string, Schema> schemas)
+    : m_config(std::move(cfg))
+    , m_default_schema(std::move(default_schema))
+    , m_schemas(std::move(schemas))
+    {
+        m_chunk_size = m_config["chunk_size"].get<size_t>();
+        m_compress   = m_config["compression"].get<std::string>() == "rle";
+        if(m_config["use_lock"].get<bool>())
+            ABT_rwlock_create(&m_lock);
+    }
+
+    static bool parseSchema(const json& cfg, Schema& schema) {
+        if(!cfg.is_object() || !cfg.contains("record_size")
+        || !cfg["record_size"].is_number_unsigned())
+            return false;
+        schema.record_size = cfg["record_size"].get<size_t>();
+        if(schema.record_size == 0)
+            return false;
+        std::vector<std::pair<size_t,size_t>> fields;
+        if(cfg.contains("fields")) {
+            if(!cfg["fields"].is_array())
+                return false;
+            for(auto& field : cfg["fields"]) {
+                if(!field.is_object()
+                || !field.contains("offset") || !field["offset"].is_number_unsigned()
+                || !field.contains("size")   || !field["size"].is_number_unsigned())
+                    return false;
+                auto offset = field["offset"].get<size_t>();
+                auto size   = field["size"].get<size_t>();
+                if(size == 0 || offset >= schema.record_size
+                || size > schema.record_size - offset)
+                    return false;
+                fields.emplace_back(offset, size);
+            }
+        }
+        std::sort(fields.begin(), fields.end());
+        // the bytes between fields become columns of their own
+        size_t end = 0;
+        for(auto& field : fields) {
+            if(field.first < end) return false; // overlapping fields
+            if(field.first > end) schema.columns.emplace_back(end, field.first - end);
+            schema.columns.push_back(field);
+            end = field.first + field.second;
+        }
+        if(end < schema.record_size)
+            schema.columns.emplace_back(end, schema.record_size - end);
+        return true;
+    }
+
+    /* Evaluates the filter's conditions on the columns, chunk by chunk,
+     * then passes the records selected to func. */
+    Status scanColumns(const Collection& coll, uint64_t max, yk_id_t from_id,
+                       const RecordDocFilter& filter,
+                       const DocIterCallback& func, bool projected) const {
+        const auto& columns = coll.m_schema.columns;
+        const auto record_size = coll.m_schema.record_size;
+
+        // column of each condition, if it is exactly one of the columns
+        std::vector<size_t> cond_columns;
+        for(auto& cond : filter.conditions()) {
+            auto it = std::find(columns.begin(), columns.end(),
+                                std::make_pair(cond.offset, cond.size()));
+            cond_columns.push_back(it - columns.begin());
+        }
+
+        std::vector<uint8_t> selected(m_chunk_size);
+        std::vector<char>    record(record_size);
+        uint64_t found = 0;
+        for(size_t c = from_id / m_chunk_size; c < coll.m_chunks.size(); c++) {
+            auto& chunk = coll.m_chunks[c];
+            size_t start = c == from_id / m_chunk_size ? from_id % m_chunk_size : 0;
+            if(start >= chunk.count) continue;
+            size_t n = chunk.count - start;
+            std::memcpy(selected.data(), chunk.present.data() + start, n);
+
+            for(size_t k = 0; k < filter.conditions().size(); k++) {
+                auto& cond = filter.conditions()[k];
+                auto col = cond_columns[k];
+                if(col < columns.size() && !chunk.columns[col].encoded()) {
+                    auto values = chunk.columns[col].data.data();
+                    cond.scan(values + start*cond.size(), n, selected.data());
+                } else if(col < columns.size()) {
+                    // a run-length encoded column: one comparison per run
+                    auto& column = chunk.columns[col];
+                    size_t row = 0;
+                    for(size_t run = 0; run < column.ends.size(); run++) {
+                        size_t run_end = column.ends[run];
+                        if(run_end > start && !cond.matches(column.data.data() + run*cond.size())) {
+                            auto from = std::max(row, start);
+                            std::memset(selected.data() + from - start, 0, run_end - from);
+                        }
+                        row = run_end;
+                    }
+                } else if(cond.offset > record_size || record_size - cond.offset < cond.size()) {
+                    std::memset(selected.data(), 0, n);
+                } else {
+                    // a field spanning several columns (or part of one)
+                    char field[8];
+                    for(size_t i = 0; i < n; i++) {
+                        if(!selected[i]) continue;
+                        coll.read(chunk, start + i, cond.offset, cond.size(), field);
+                        selected[i] = cond.matches(field);
+                    }
+                }
+            }
+
+            for(size_t i = 0; i < n; i++) {
+                if(!selected[i]) continue;
+                if(!projected || filter.ranges().empty()) {
+                    coll.read(chunk, start + i, 0, record_size, record.data());
+                } else {
+                    for(auto& range : filter.ranges()) {
+                        if(range.first >= record_size) continue;
+                        auto length = std::min(range.second, record_size - range.first);
+                        coll.read(chunk, start + i, range.first, length,
+                                  record.data() + range.first);
+                    }
+                }
+                // the filter's docCopy is applied by the caller
+                yk_id_t id = c * m_chunk_size + start + i;
+                auto status = func(id, UserMem{record.data(), record_size});
+                if(status != Status::OK)
+                    return status;
+                found += 1;
+                if(max != 0 && found == max)
+                    return Status::OK;
+            }
+        }
+        return Status::OK;
+    }
+
+    std::unordered_map<std::string, Collection> m_collections;
+    json                                        m_config;
+    Schema                                      m_default_schema;
+    std::unordered_map<std::string, Schema>     m_schemas;
+    size_t                                      m_chunk_size = 4096;
+    bool                                        m_compress = false;
+    ABT_rwlock                                  m_lock = ABT_RWLOCK_NULL;
+};
+
+}
+
+YOKAN_REGISTER_BACKEND(columnar, yokan::ColumnarDatabase);
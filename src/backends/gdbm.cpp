@@ -122,6 +122,7 @@ class GDBMDatabase : public DocumentStoreMixin<DatabaseInterface> {
                     |YOKAN_MODE_IGNORE_DOCS  // not actually used
                     |YOKAN_MODE_FILTER_VALUE // not actually used
                     |YOKAN_MODE_LIB_FILTER   // not actually used
+                    |YOKAN_MODE_JSON_FILTER  // not actually used
                     |YOKAN_MODE_NO_RDMA
                     |YOKAN_MODE_UPDATE_NEW
                     )
@@ -383,6 +384,8 @@ class GDBMDatabase : public DocumentStoreMixin<DatabaseInterface> {
 
     Status startMigration(std::unique_ptr<MigrationHandle>& mh) override {
         if(m_migrated) return Status::Migrated;
+        auto status = flushCollections();
+        if(status != Status::OK) return status;
         try {
             mh.reset(new GDBMMigrationHandle(*this));
         } catch(...) {
@@ -392,6 +395,7 @@ class GDBMDatabase : public DocumentStoreMixin<DatabaseInterface> {
     }
 
     ~GDBMDatabase() {
+        if(m_db) flushCollections();
         if(m_lock != ABT_RWLOCK_NULL)
             ABT_rwlock_free(&m_lock);
         if(m_db) gdbm_close(m_db);
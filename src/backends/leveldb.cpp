@@ -188,6 +188,7 @@ class LevelDBDatabase : public DocumentStoreMixin<DatabaseInterface> {
                     |YOKAN_MODE_IGNORE_DOCS
                     |YOKAN_MODE_FILTER_VALUE
                     |YOKAN_MODE_LIB_FILTER
+                    |YOKAN_MODE_JSON_FILTER
                     |YOKAN_MODE_NO_RDMA
                     |YOKAN_MODE_UPDATE_NEW
                     )
@@ -196,6 +197,8 @@ class LevelDBDatabase : public DocumentStoreMixin<DatabaseInterface> {
 
     virtual void destroy() override {
         if(m_migrated) return;
+        delete m_db;
+        m_db = nullptr;
         auto path = m_config["path"].get<std::string>();
         fs::remove_all(path);
     }
@@ -688,6 +691,8 @@ class LevelDBDatabase : public DocumentStoreMixin<DatabaseInterface> {
 
     Status startMigration(std::unique_ptr<MigrationHandle>& mh) override {
         if(m_migrated) return Status::Migrated;
+        auto status = flushCollections();
+        if(status != Status::OK) return status;
         try {
             mh.reset(new LevelDBMigrationHandle(*this));
         } catch(...) {
@@ -697,6 +702,7 @@ class LevelDBDatabase : public DocumentStoreMixin<DatabaseInterface> {
     }
 
     ~LevelDBDatabase() {
+        if(m_db) flushCollections();
         delete m_db;
         ABT_rwlock_free(&m_migration_lock);
     }
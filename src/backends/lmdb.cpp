@@ -226,6 +226,7 @@ class LMDBDatabase : public DocumentStoreMixin<DatabaseInterface> {
                     |YOKAN_MODE_IGNORE_DOCS
                     |YOKAN_MODE_FILTER_VALUE
                     |YOKAN_MODE_LIB_FILTER
+                    |YOKAN_MODE_JSON_FILTER
                     |YOKAN_MODE_NO_RDMA
                     |YOKAN_MODE_UPDATE_NEW
                     )
@@ -948,6 +949,8 @@ class LMDBDatabase : public DocumentStoreMixin<DatabaseInterface> {
 
     Status startMigration(std::unique_ptr<MigrationHandle>& mh) override {
         if(m_migrated) return Status::Migrated;
+        auto status = flushCollections();
+        if(status != Status::OK) return status;
         try {
             mh.reset(new LMDBMigrationHandle(*this));
         } catch(...) {
@@ -958,6 +961,7 @@ class LMDBDatabase : public DocumentStoreMixin<DatabaseInterface> {
 
     ~LMDBDatabase() {
         if(m_env) {
+            flushCollections();
             mdb_dbi_close(m_env, m_db);
             mdb_env_close(m_env);
         }
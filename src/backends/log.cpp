@@ -573,6 +573,28 @@ class LogDatabase : public DatabaseInterface {
         }
 
 
+        [[nodiscard]] Status reserve(size_t count, yk_id_t* first_id) {
+            ScopedWriteLock lock{m_lock};
+            // create empty entries, as if the documents existed but had
+            // been erased, so that update can later fill them
+            const auto next_id = m_header->next_id;
+            if(count == 0 || count > std::numeric_limits<yk_id_t>::max() - next_id)
+                return Status::InvalidArg;
+            for(yk_id_t id = next_id; id < next_id + count; ++id) {
+                auto entry = EntryMetadata{
+                    m_header->last_chunk_id,
+                    YOKAN_KEY_NOT_FOUND,
+                    YOKAN_KEY_NOT_FOUND, 0};
+                auto status = writeEntryMetadata(id, entry, false);
+                if(status != Status::OK) return status;
+                m_header->next_id += 1;
+            }
+            (void)flushEntryMetadata(next_id, count);
+            flushHeader();
+            *first_id = next_id;
+            return Status::OK;
+        }
+
         [[nodiscard]] Status read(size_t id, void* buffer, size_t* size) {
             size_t buf_size = *size;
             ScopedReadLock lock{m_lock};
@@ -741,6 +763,7 @@ class LogDatabase : public DatabaseInterface {
                     |YOKAN_MODE_IGNORE_DOCS
                     |YOKAN_MODE_FILTER_VALUE
                     |YOKAN_MODE_LIB_FILTER
+                    |YOKAN_MODE_JSON_FILTER
                     |YOKAN_MODE_NO_RDMA
                     |YOKAN_MODE_UPDATE_NEW
                     )
@@ -803,6 +826,17 @@ class LogDatabase : public DatabaseInterface {
         return Status::OK;
     }
 
+    Status collReserveIDs(int32_t mode, const char* name,
+                          size_t count, yk_id_t* first_id) override {
+        (void)mode;
+        ScopedReadLock lock(m_lock);
+        auto p = m_collections.find(name);
+        if(p == m_collections.end())
+            return Status::NotFound;
+        auto coll = p->second;
+        return coll->reserve(count, first_id);
+    }
+
     Status docSize(const char* collection,
                    int32_t mode,
                    const BasicUserMem<yk_id_t>& ids,
@@ -1016,7 +1050,6 @@ class LogDatabase : public DatabaseInterface {
 
         yk_id_t id = from_id;
         size_t i = 0;
-        std::vector<char> doc_buffer;
         Status status = Status::OK;
 
         auto fetch_cb = [&](yk_id_t, const UserMem& doc) mutable {
@@ -1032,11 +1065,8 @@ class LogDatabase : public DatabaseInterface {
                 ++id;
                 return Status::OK;
             }
-            auto filtered_size = filter->docSizeFrom(collection, doc.data, doc.size);
-            doc_buffer.resize(filtered_size);
-            filtered_size = filter->docCopy(
-                collection, doc_buffer.data(), filtered_size, doc.data, doc.size);
-            status = func(id, UserMem{doc_buffer.data(), filtered_size});
+            // the filter's docCopy is applied by the caller
+            status = func(id, doc);
             if(status != Status::OK) {
                 i = max;
                 return Status::OK;
@@ -1046,7 +1076,7 @@ class LogDatabase : public DatabaseInterface {
             return Status::OK;
         };
 
-        while(i < max && id <= coll->last_id()) {
+        while((max == 0 || i < max) && id <= coll->last_id()) {
             (void)coll->fetch(id, fetch_cb);
             if(status != Status::OK) break;
         }
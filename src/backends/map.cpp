@@ -11,6 +11,7 @@
 #include "../common/allocator.hpp"
 #include "../common/modes.hpp"
 #include "util/key-copy.hpp"
+#include "util/filter-batch.hpp"
 #include <nlohmann/json.hpp>
 #include <unistd.h>
 #include <abt.h>
@@ -86,6 +87,9 @@ class MapDatabase : public DocumentStoreMixin<DatabaseInterface> {
             // check use_lock
             auto use_lock = cfg.value("use_lock", true);
             cfg["use_lock"] = use_lock;
+            // check scan_quantum
+            auto scan_quantum = cfg.value("scan_quantum", (size_t)0);
+            cfg["scan_quantum"] = scan_quantum;
             // check comparator field
             if(!cfg.contains("comparator"))
                 cfg["comparator"] = "default";
@@ -228,6 +232,7 @@ class MapDatabase : public DocumentStoreMixin<DatabaseInterface> {
                     |YOKAN_MODE_IGNORE_DOCS
                     |YOKAN_MODE_FILTER_VALUE
                     |YOKAN_MODE_LIB_FILTER
+                    |YOKAN_MODE_JSON_FILTER
                     |YOKAN_MODE_NO_RDMA
                     |YOKAN_MODE_UPDATE_NEW
                     )
@@ -581,6 +586,17 @@ retry:
         return Status::OK;
     }
 
+    virtual Status eraseRange(int32_t mode, const UserMem& fromKey,
+                              const UserMem& toKey) override {
+        (void)mode;
+        if(m_config.value("comparator", "default") != "default")
+            return Status::NotSupported;
+        ScopedWriteLock lock(m_lock);
+        if(m_migrated) return Status::Migrated;
+        m_db->erase(m_db->lower_bound(fromKey), m_db->lower_bound(toKey));
+        return Status::OK;
+    }
+
     virtual Status listKeys(int32_t mode, bool packed, const UserMem& fromKey,
                             const std::shared_ptr<KeyValueFilter>& filter,
                             UserMem& keys, BasicUserMem<size_t>& keySizes) const override {
@@ -601,41 +617,46 @@ retry:
         size_t offset = 0;
         bool buf_too_small = false;
 
-        for(auto it = fromKeyIt; it != end && i < max; ++it) {
-            auto& key = it->first;
-            auto& val = it->second;
-            if(!filter->check(key.data(), key.size(), val.data(), val.size())) {
-                if(filter->shouldStop(key.data(), key.size(), val.data(), val.size()))
-                    break;
-                continue;
-            }
+        size_t examined = 0;
+        KeyValueBatch<iterator> batch;
+        bool stop = false;
+        for(auto it = fromKeyIt; !stop && it != end && i < max; scanYield(lock, examined, batch, it)) {
+            nextBatch(batch, filter, max, i, examined, it);
+            for(size_t j = 0; j < batch.size && !stop; j++) {
+                auto& key = batch.rows[j]->first;
+                auto& val = batch.rows[j]->second;
+                if(!batch.results[j]) {
+                    stop = filter->shouldStop(key.data(), key.size(), val.data(), val.size());
+                    continue;
+                }
 
-            size_t usize = packed ? (keys.size - offset) : keySizes[i];
-            auto umem = static_cast<char*>(keys.data) + offset;
+                size_t usize = packed ? (keys.size - offset) : keySizes[i];
+                auto umem = static_cast<char*>(keys.data) + offset;
 
-            bool is_last = false;
-            if(mode & YOKAN_MODE_KEEP_LAST) {
-                auto next = it;
-                ++next;
-                is_last = (i+1 == max) || (next == end);
-            }
+                bool is_last = false;
+                if(mode & YOKAN_MODE_KEEP_LAST) {
+                    auto next = batch.rows[j];
+                    ++next;
+                    is_last = (i+1 == max) || (next == end);
+                }
 
-            if(!packed) {
-                keySizes[i] = keyCopy(mode, is_last, filter, umem, usize, key.data(), key.size());
-                offset += usize;
-            } else {
-                if(buf_too_small) {
-                    keySizes[i] = YOKAN_SIZE_TOO_SMALL;
-                } else {
+                if(!packed) {
                     keySizes[i] = keyCopy(mode, is_last, filter, umem, usize, key.data(), key.size());
-                    if(keySizes[i] == YOKAN_SIZE_TOO_SMALL) {
-                        buf_too_small = true;
+                    offset += usize;
+                } else {
+                    if(buf_too_small) {
+                        keySizes[i] = YOKAN_SIZE_TOO_SMALL;
                     } else {
-                        offset += keySizes[i];
+                        keySizes[i] = keyCopy(mode, is_last, filter, umem, usize, key.data(), key.size());
+                        if(keySizes[i] == YOKAN_SIZE_TOO_SMALL) {
+                            buf_too_small = true;
+                        } else {
+                            offset += keySizes[i];
+                        }
                     }
                 }
+                i += 1;
             }
-            i += 1;
         }
 
         keys.size = offset;
@@ -674,63 +695,68 @@ retry:
         bool key_buf_too_small = false;
         bool val_buf_too_small = false;
 
-        for(auto it = fromKeyIt; it != end && i < max; it++) {
-            auto& key = it->first;
-            auto& val = it->second;
-            if(!filter->check(key.data(), key.size(), val.data(), val.size())) {
-                if(filter->shouldStop(key.data(), key.size(), val.data(), val.size()))
-                    break;
-                continue;
-            }
-
-            auto key_umem = static_cast<char*>(keys.data) + key_offset;
-            auto val_umem = static_cast<char*>(vals.data) + val_offset;
-
-            bool is_last = false;
-            if(mode & YOKAN_MODE_KEEP_LAST) {
-                auto next = it;
-                ++next;
-                is_last = (i+1 == max) || (next == end);
-            }
-
-            if(!packed) {
+        size_t examined = 0;
+        KeyValueBatch<iterator> batch;
+        bool stop = false;
+        for(auto it = fromKeyIt; !stop && it != end && i < max; scanYield(lock, examined, batch, it)) {
+            nextBatch(batch, filter, max, i, examined, it);
+            for(size_t j = 0; j < batch.size && !stop; j++) {
+                auto& key = batch.rows[j]->first;
+                auto& val = batch.rows[j]->second;
+                if(!batch.results[j]) {
+                    stop = filter->shouldStop(key.data(), key.size(), val.data(), val.size());
+                    continue;
+                }
 
-                size_t key_usize = keySizes[i];
-                size_t val_usize = valSizes[i];
-                keySizes[i] = keyCopy(mode, is_last, filter, key_umem, key_usize,
-                                      key.data(), key.size());
-                valSizes[i] = filter->valCopy(val_umem, val_usize,
-                                              val.data(), val.size());
-                key_offset += key_usize;
-                val_offset += val_usize;
+                auto key_umem = static_cast<char*>(keys.data) + key_offset;
+                auto val_umem = static_cast<char*>(vals.data) + val_offset;
 
-            } else {
+                bool is_last = false;
+                if(mode & YOKAN_MODE_KEEP_LAST) {
+                    auto next = batch.rows[j];
+                    ++next;
+                    is_last = (i+1 == max) || (next == end);
+                }
 
-                size_t key_usize = keys.size - key_offset;
-                size_t val_usize = vals.size - val_offset;
+                if(!packed) {
 
-                if(key_buf_too_small) {
-                    keySizes[i] = YOKAN_SIZE_TOO_SMALL;
-                } else {
+                    size_t key_usize = keySizes[i];
+                    size_t val_usize = valSizes[i];
                     keySizes[i] = keyCopy(mode, is_last, filter, key_umem, key_usize,
                                           key.data(), key.size());
-                    if(keySizes[i] != YOKAN_SIZE_TOO_SMALL)
-                        key_offset += keySizes[i];
-                    else
-                        key_buf_too_small = true;
-                }
-                if(val_buf_too_small) {
-                    valSizes[i] = YOKAN_SIZE_TOO_SMALL;
-                } else {
                     valSizes[i] = filter->valCopy(val_umem, val_usize,
                                                   val.data(), val.size());
-                    if(valSizes[i] != YOKAN_SIZE_TOO_SMALL)
-                        val_offset += valSizes[i];
-                    else
-                        val_buf_too_small = true;
+                    key_offset += key_usize;
+                    val_offset += val_usize;
+
+                } else {
+
+                    size_t key_usize = keys.size - key_offset;
+                    size_t val_usize = vals.size - val_offset;
+
+                    if(key_buf_too_small) {
+                        keySizes[i] = YOKAN_SIZE_TOO_SMALL;
+                    } else {
+                        keySizes[i] = keyCopy(mode, is_last, filter, key_umem, key_usize,
+                                              key.data(), key.size());
+                        if(keySizes[i] != YOKAN_SIZE_TOO_SMALL)
+                            key_offset += keySizes[i];
+                        else
+                            key_buf_too_small = true;
+                    }
+                    if(val_buf_too_small) {
+                        valSizes[i] = YOKAN_SIZE_TOO_SMALL;
+                    } else {
+                        valSizes[i] = filter->valCopy(val_umem, val_usize,
+                                                      val.data(), val.size());
+                        if(valSizes[i] != YOKAN_SIZE_TOO_SMALL)
+                            val_offset += valSizes[i];
+                        else
+                            val_buf_too_small = true;
+                    }
                 }
+                i += 1;
             }
-            i += 1;
         }
 
         keys.size = key_offset;
@@ -762,23 +788,28 @@ retry:
 
         const auto end = m_db->end();
         size_t i = 0;
-        for(auto it = fromKeyIt; it != end && (max == 0 || i < max); ++it) {
-            auto& key = it->first;
-            auto& val = it->second;
-            if(!filter->check(key.data(), key.size(), val.data(), val.size())) {
-                if(filter->shouldStop(key.data(), key.size(), val.data(), val.size()))
-                    break;
-                continue;
-            }
+        size_t examined = 0;
+        KeyValueBatch<iterator> batch;
+        bool stop = false;
+        for(auto it = fromKeyIt; !stop && it != end && (max == 0 || i < max); scanYield(lock, examined, batch, it)) {
+            nextBatch(batch, filter, max, i, examined, it);
+            for(size_t j = 0; j < batch.size && !stop; j++) {
+                auto& key = batch.rows[j]->first;
+                auto& val = batch.rows[j]->second;
+                if(!batch.results[j]) {
+                    stop = filter->shouldStop(key.data(), key.size(), val.data(), val.size());
+                    continue;
+                }
 
-            auto key_umem = UserMem{(char*)key.data(), key.size()};
-            auto val_umem = (ignore_values && !filter->requiresValue()) ?
-                UserMem{nullptr, 0} : UserMem{(char*)val.data(), val.size()};
+                auto key_umem = UserMem{(char*)key.data(), key.size()};
+                auto val_umem = (ignore_values && !filter->requiresValue()) ?
+                    UserMem{nullptr, 0} : UserMem{(char*)val.data(), val.size()};
 
-            auto status = func(key_umem, val_umem);
-            if(status != Status::OK)
-                return status;
-            ++i;
+                auto status = func(key_umem, val_umem);
+                if(status != Status::OK)
+                    return status;
+                ++i;
+            }
         }
 
         return Status::OK;
@@ -842,6 +873,8 @@ retry:
 
     Status startMigration(std::unique_ptr<MigrationHandle>& mh) override {
         if(m_migrated) return Status::Migrated;
+        auto status = flushCollections();
+        if(status != Status::OK) return status;
         try {
             mh.reset(new MapMigrationHandle(*this));
         } catch(...) {
@@ -861,6 +894,46 @@ retry:
 
     private:
 
+    /**
+     * @brief Collects the next block of candidates of a scan, from it, and
+     * checks them against the filter. Blocks do not cross multiples of
+     * m_scan_quantum entries examined, so that scanYield can release the
+     * lock in between blocks.
+     */
+    template<typename Batch, typename Iterator>
+    void nextBatch(Batch& batch, const std::shared_ptr<KeyValueFilter>& filter,
+                   uint64_t max, uint64_t count, size_t examined, Iterator& it) const {
+        auto n = Batch::limit(max, count);
+        if(m_scan_quantum != 0)
+            n = std::min<size_t>(n, m_scan_quantum - examined % m_scan_quantum);
+        const auto end = m_db->end();
+        batch.clear();
+        for(; it != end && batch.size < n; ++it)
+            batch.push(it, it->first.data(), it->first.size(),
+                       it->second.data(), it->second.size());
+        batch.check(filter);
+    }
+
+    /**
+     * @brief Called after each block of a scan. Every m_scan_quantum
+     * entries examined, the read lock is released and the calling ULT yields,
+     * giving writers and other ULTs a chance to run. Since the map may have
+     * been modified in the mean time, the iterator is then re-positioned right
+     * after the last key of the block.
+     */
+    template<typename Batch, typename Iterator>
+    void scanYield(ScopedReadLock& lock, size_t& examined, const Batch& batch, Iterator& it) const {
+        examined += batch.size;
+        if(m_scan_quantum == 0 || batch.size == 0 || examined % m_scan_quantum != 0)
+            return;
+        auto& last = batch.rows[batch.size-1]->first;
+        std::string last_key{last.data(), last.size()};
+        lock.unlock();
+        ABT_thread_yield();
+        lock.lock();
+        it = m_db->upper_bound(UserMem{last_key.data(), last_key.size()});
+    }
+
     using key_type = std::basic_string<char, std::char_traits<char>,
                                        Allocator<char>>;
     using value_type = std::basic_string<char, std::char_traits<char>,
@@ -882,6 +955,7 @@ retry:
     {
         if(m_config["use_lock"].get<bool>())
             ABT_rwlock_create(&m_lock);
+        m_scan_quantum = m_config["scan_quantum"].get<size_t>();
         m_db = new map_type(cmp_fun, allocator(m_node_allocator));
         auto disable_doc_mixin_lock = m_config.value("disable_doc_mixin_lock", false);
         if(disable_doc_mixin_lock) disableDocMixinLock();
@@ -890,6 +964,7 @@ retry:
     map_type*          m_db;
     json               m_config;
     ABT_rwlock         m_lock = ABT_RWLOCK_NULL;
+    size_t             m_scan_quantum = 0;
     yk_allocator_t     m_node_allocator;
     yk_allocator_t     m_key_allocator;
     yk_allocator_t     m_val_allocator;
@@ -385,6 +385,7 @@ class RocksDBDatabase : public DocumentStoreMixin<DatabaseInterface> {
                     |YOKAN_MODE_IGNORE_DOCS
                     |YOKAN_MODE_FILTER_VALUE
                     |YOKAN_MODE_LIB_FILTER
+                    |YOKAN_MODE_JSON_FILTER
                     |YOKAN_MODE_NO_RDMA
                     |YOKAN_MODE_UPDATE_NEW
                     )
@@ -621,6 +622,17 @@ class RocksDBDatabase : public DocumentStoreMixin<DatabaseInterface> {
         return convertStatus(status);
     }
 
+    virtual Status eraseRange(int32_t mode, const UserMem& fromKey,
+                              const UserMem& toKey) override {
+        ScopedReadLock mlock(m_migration_lock);
+        if(m_migrated) return Status::Migrated;
+        (void)mode;
+        auto status = m_db->DeleteRange(m_write_options, m_db->DefaultColumnFamily(),
+                                        rocksdb::Slice{ fromKey.data, fromKey.size },
+                                        rocksdb::Slice{ toKey.data, toKey.size });
+        return convertStatus(status);
+    }
+
     virtual Status listKeys(int32_t mode, bool packed, const UserMem& fromKey,
                             const std::shared_ptr<KeyValueFilter>& filter,
                             UserMem& keys, BasicUserMem<size_t>& keySizes) const override {
@@ -857,6 +869,87 @@ class RocksDBDatabase : public DocumentStoreMixin<DatabaseInterface> {
          return Status::OK;
      }
 
+    /**
+     * @brief The RocksDBScanCursor keeps its rocksdb::Iterator (and the
+     * implicit snapshot it pins) alive across calls to next, so that
+     * consecutive batches do not pay for an iterator creation and a seek.
+     */
+    struct RocksDBScanCursor : public ScanCursor {
+
+        const RocksDBDatabase&          m_db;
+        rocksdb::Iterator*              m_iterator;
+        std::shared_ptr<KeyValueFilter> m_filter;
+
+        RocksDBScanCursor(const RocksDBDatabase& db,
+                          rocksdb::Iterator* iterator,
+                          std::shared_ptr<KeyValueFilter> filter)
+        : m_db(db)
+        , m_iterator(iterator)
+        , m_filter(std::move(filter)) {}
+
+        ~RocksDBScanCursor() {
+            delete m_iterator;
+        }
+
+        Status next(uint64_t max, bool ignore_values,
+                    const Callback& func, bool& done) override {
+            ScopedReadLock mlock(m_db.m_migration_lock);
+            if(m_db.m_migrated) return Status::Migrated;
+
+            done = false;
+            uint64_t i = 0;
+            while(m_iterator->Valid() && i < max) {
+                auto key = m_iterator->key();
+                auto val = m_iterator->value();
+                if(!m_filter->check(key.data(), key.size(), val.data(), val.size())) {
+                    if(m_filter->shouldStop(key.data(), key.size(), val.data(), val.size())) {
+                        done = true;
+                        return Status::OK;
+                    }
+                    m_iterator->Next();
+                    continue;
+                }
+                auto key_umem = UserMem{(char*)key.data(), key.size()};
+                auto val_umem = ignore_values ? UserMem{nullptr, 0} : UserMem{(char*)val.data(), val.size()};
+
+                auto status = func(key_umem, val_umem);
+                if(status != Status::OK)
+                    return status;
+
+                i += 1;
+                m_iterator->Next();
+            }
+            if(!m_iterator->status().ok())
+                return convertStatus(m_iterator->status());
+            done = !m_iterator->Valid();
+            return Status::OK;
+        }
+    };
+
+    Status openCursor(int32_t mode, const UserMem& fromKey,
+                      const std::shared_ptr<KeyValueFilter>& filter,
+                      std::unique_ptr<ScanCursor>& cursor) const override {
+        ScopedReadLock mlock(m_migration_lock);
+        if(m_migrated) return Status::Migrated;
+
+        auto inclusive = mode & YOKAN_MODE_INCLUSIVE;
+        auto fromKeySlice = rocksdb::Slice{ fromKey.data, fromKey.size };
+
+        auto iterator = m_db->NewIterator(m_read_options);
+        if(fromKey.size == 0) {
+            iterator->SeekToFirst();
+        } else {
+            iterator->Seek(fromKeySlice);
+            if(!inclusive && iterator->Valid()) {
+                if(iterator->key().compare(fromKeySlice) == 0) {
+                    iterator->Next();
+                }
+            }
+        }
+        cursor.reset(new RocksDBScanCursor(*this, iterator, filter));
+        return Status::OK;
+    }
+
     struct RocksDBMigrationHandle : public MigrationHandle {
 
         RocksDBDatabase&   m_db;
@@ -891,6 +984,8 @@ class RocksDBDatabase : public DocumentStoreMixin<DatabaseInterface> {
 
     Status startMigration(std::unique_ptr<MigrationHandle>& mh) override {
         if(m_migrated) return Status::Migrated;
+        auto status = flushCollections();
+        if(status != Status::OK) return status;
         try {
             mh.reset(new RocksDBMigrationHandle(*this));
         } catch(...) {
@@ -900,8 +995,10 @@ class RocksDBDatabase : public DocumentStoreMixin<DatabaseInterface> {
     }
 
     ~RocksDBDatabase() {
-        if(m_db)
+        if(m_db) {
+            flushCollections();
             delete m_db;
+        }
         ABT_rwlock_free(&m_migration_lock);
     }
 
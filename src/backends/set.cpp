@@ -10,6 +10,7 @@
 #include "../common/allocator.hpp"
 #include "../common/modes.hpp"
 #include "util/key-copy.hpp"
+#include "util/filter-batch.hpp"
 #include <unistd.h>
 #include <nlohmann/json.hpp>
 #include <fstream>
@@ -212,6 +213,7 @@ class SetDatabase : public DatabaseInterface {
                     |YOKAN_MODE_IGNORE_DOCS
                     |YOKAN_MODE_FILTER_VALUE
                     |YOKAN_MODE_LIB_FILTER
+                    |YOKAN_MODE_JSON_FILTER
                     |YOKAN_MODE_NO_RDMA
                     )
             );
@@ -487,44 +489,48 @@ class SetDatabase : public DatabaseInterface {
         size_t offset = 0;
         bool buf_too_small = false;
 
-        for(auto it = fromKeyIt; it != end && i < max; ++it) {
-            auto& key = *it;
-            if(!filter->check(key.data(), key.size(), nullptr, 0)) {
-                if(filter->shouldStop(key.data(), key.size(), nullptr, 0))
-                    break;
-                continue;
-            }
-            auto umem = static_cast<char*>(keys.data) + offset;
+        KeyValueBatch<iterator> batch;
+        bool stop = false;
+        for(auto it = fromKeyIt; !stop && it != end && i < max; ) {
+            nextBatch(batch, filter, max, i, it);
+            for(size_t j = 0; j < batch.size && !stop; j++) {
+                auto& key = *batch.rows[j];
+                if(!batch.results[j]) {
+                    stop = filter->shouldStop(key.data(), key.size(), nullptr, 0);
+                    continue;
+                }
+                auto umem = static_cast<char*>(keys.data) + offset;
 
-            bool is_last = false;
-            if(mode & YOKAN_MODE_KEEP_LAST) {
-                auto next = it;
-                ++next;
-                is_last = (i+1 == max) || (next == end);
-            }
+                bool is_last = false;
+                if(mode & YOKAN_MODE_KEEP_LAST) {
+                    auto next = batch.rows[j];
+                    ++next;
+                    is_last = (i+1 == max) || (next == end);
+                }
 
-            if(!packed) {
+                if(!packed) {
 
-                size_t usize = keySizes[i];
-                keySizes[i] = keyCopy(mode, is_last, filter, umem, usize,
-                                      key.data(), key.size());
-                offset += usize;
+                    size_t usize = keySizes[i];
+                    keySizes[i] = keyCopy(mode, is_last, filter, umem, usize,
+                                          key.data(), key.size());
+                    offset += usize;
 
-            } else { // if packed
+                } else { // if packed
 
-                if(buf_too_small)
-                    keySizes[i] = YOKAN_SIZE_TOO_SMALL;
-                else {
-                    keySizes[i] = keyCopy(mode, is_last, filter, umem, keys.size - offset,
-                                          key.data(), key.size());
-                    if(keySizes[i] == YOKAN_SIZE_TOO_SMALL)
-                        buf_too_small = true;
-                    else
-                        offset += keySizes[i];
-                }
+                    if(buf_too_small)
+                        keySizes[i] = YOKAN_SIZE_TOO_SMALL;
+                    else {
+                        keySizes[i] = keyCopy(mode, is_last, filter, umem, keys.size - offset,
+                                              key.data(), key.size());
+                        if(keySizes[i] == YOKAN_SIZE_TOO_SMALL)
+                            buf_too_small = true;
+                        else
+                            offset += keySizes[i];
+                    }
 
+                }
+                i += 1;
             }
-            i += 1;
         }
 
         keys.size = offset;
@@ -563,59 +569,63 @@ class SetDatabase : public DatabaseInterface {
         bool key_buf_too_small = false;
         bool val_buf_too_small = false;
 
-        for(auto it = fromKeyIt; it != end && i < max; it++) {
-            auto& key = *it;
-            if(!filter->check(key.data(), key.size(), nullptr, 0)) {
-                if(filter->shouldStop(key.data(), key.size(), nullptr, 0))
-                    break;
-                continue;
-            }
-            auto key_umem = static_cast<char*>(keys.data) + key_offset;
-            auto val_umem = static_cast<char*>(vals.data) + val_offset;
-
-            bool is_last = false;
-            if(mode & YOKAN_MODE_KEEP_LAST) {
-                auto next = it;
-                ++next;
-                is_last = (i+1 == max) || (next == end);
-            }
-
-            if(!packed) {
-
-                size_t key_usize = keySizes[i];
-                size_t val_usize = valSizes[i];
-                keySizes[i] = keyCopy(mode, is_last, filter, key_umem, key_usize,
-                                      key.data(), key.size());
-                valSizes[i] = filter->valCopy(val_umem, val_usize, "", 0);
-                key_offset += key_usize;
-                val_offset += val_usize;
-
-            } else { // not packed
+        KeyValueBatch<iterator> batch;
+        bool stop = false;
+        for(auto it = fromKeyIt; !stop && it != end && i < max; ) {
+            nextBatch(batch, filter, max, i, it);
+            for(size_t j = 0; j < batch.size && !stop; j++) {
+                auto& key = *batch.rows[j];
+                if(!batch.results[j]) {
+                    stop = filter->shouldStop(key.data(), key.size(), nullptr, 0);
+                    continue;
+                }
+                auto key_umem = static_cast<char*>(keys.data) + key_offset;
+                auto val_umem = static_cast<char*>(vals.data) + val_offset;
+
+                bool is_last = false;
+                if(mode & YOKAN_MODE_KEEP_LAST) {
+                    auto next = batch.rows[j];
+                    ++next;
+                    is_last = (i+1 == max) || (next == end);
+                }
 
-                size_t key_usize = keys.size - key_offset;
-                size_t val_usize = vals.size - val_offset;
+                if(!packed) {
 
-                if(key_buf_too_small) {
-                    keySizes[i] = YOKAN_SIZE_TOO_SMALL;
-                } else {
+                    size_t key_usize = keySizes[i];
+                    size_t val_usize = valSizes[i];
                     keySizes[i] = keyCopy(mode, is_last, filter, key_umem, key_usize,
                                           key.data(), key.size());
-                    if(keySizes[i] != YOKAN_SIZE_TOO_SMALL)
-                        key_offset += keySizes[i];
-                    else
-                        key_buf_too_small = true;
-                }
-                if(val_buf_too_small) {
-                    valSizes[i] = YOKAN_SIZE_TOO_SMALL;
-                } else {
                     valSizes[i] = filter->valCopy(val_umem, val_usize, "", 0);
-                    if(valSizes[i] != YOKAN_SIZE_TOO_SMALL)
-                        val_offset += valSizes[i];
-                    else
-                        val_buf_too_small = true;
+                    key_offset += key_usize;
+                    val_offset += val_usize;
+
+                } else { // not packed
+
+                    size_t key_usize = keys.size - key_offset;
+                    size_t val_usize = vals.size - val_offset;
+
+                    if(key_buf_too_small) {
+                        keySizes[i] = YOKAN_SIZE_TOO_SMALL;
+                    } else {
+                        keySizes[i] = keyCopy(mode, is_last, filter, key_umem, key_usize,
+                                              key.data(), key.size());
+                        if(keySizes[i] != YOKAN_SIZE_TOO_SMALL)
+                            key_offset += keySizes[i];
+                        else
+                            key_buf_too_small = true;
+                    }
+                    if(val_buf_too_small) {
+                        valSizes[i] = YOKAN_SIZE_TOO_SMALL;
+                    } else {
+                        valSizes[i] = filter->valCopy(val_umem, val_usize, "", 0);
+                        if(valSizes[i] != YOKAN_SIZE_TOO_SMALL)
+                            val_offset += valSizes[i];
+                        else
+                            val_buf_too_small = true;
+                    }
                 }
+                i += 1;
             }
-            i += 1;
         }
         keys.size = key_offset;
         vals.size = 0;
@@ -647,25 +657,44 @@ class SetDatabase : public DatabaseInterface {
         const auto end = m_db->end();
         size_t i = 0;
 
-        for(auto it = fromKeyIt; it != end && (max == 0 || i < max); it++) {
-            auto& key = *it;
-            if(!filter->check(key.data(), key.size(), nullptr, 0)) {
-                if(filter->shouldStop(key.data(), key.size(), nullptr, 0))
-                    break;
-                continue;
-            }
+        KeyValueBatch<iterator> batch;
+        bool stop = false;
+        for(auto it = fromKeyIt; !stop && it != end && (max == 0 || i < max); ) {
+            nextBatch(batch, filter, max, i, it);
+            for(size_t j = 0; j < batch.size && !stop; j++) {
+                auto& key = *batch.rows[j];
+                if(!batch.results[j]) {
+                    stop = filter->shouldStop(key.data(), key.size(), nullptr, 0);
+                    continue;
+                }
 
-            auto key_umem = UserMem{(char*)key.data(), key.size()};
-            auto val_umem = UserMem{nullptr, 0};
+                auto key_umem = UserMem{(char*)key.data(), key.size()};
+                auto val_umem = UserMem{nullptr, 0};
 
-            auto status = func(key_umem, val_umem);
-            if(status != Status::OK)
-                return status;
-            ++i;
+                auto status = func(key_umem, val_umem);
+                if(status != Status::OK)
+                    return status;
+                ++i;
+            }
         }
         return Status::OK;
     }
 
+    /**
+     * @brief Collects the next block of candidates of a scan, from it,
+     * and checks them against the filter.
+     */
+    template<typename Batch, typename Iterator>
+    void nextBatch(Batch& batch, const std::shared_ptr<KeyValueFilter>& filter,
+                   uint64_t max, uint64_t count, Iterator& it) const {
+        auto n = Batch::limit(max, count);
+        const auto end = m_db->end();
+        batch.clear();
+        for(; it != end && batch.size < n; ++it)
+            batch.push(it, it->data(), it->size(), nullptr, 0);
+        batch.check(filter);
+    }
+
     struct SetMigrationHandle : public MigrationHandle {
 
         SetDatabase&   m_db;
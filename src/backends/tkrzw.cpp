@@ -363,6 +363,7 @@ class TkrzwDatabase : public DocumentStoreMixin<DatabaseInterface> {
                     |YOKAN_MODE_IGNORE_DOCS
                     |YOKAN_MODE_FILTER_VALUE
                     |YOKAN_MODE_LIB_FILTER
+                    |YOKAN_MODE_JSON_FILTER
                     |YOKAN_MODE_NO_RDMA
                     |YOKAN_MODE_UPDATE_NEW
                     )
@@ -1036,6 +1037,8 @@ class TkrzwDatabase : public DocumentStoreMixin<DatabaseInterface> {
         if(m_migrated) return Status::Migrated;
         if(m_config["type"] == "tiny" || m_config["type"] == "baby")
             return Status::NotSupported;
+        auto status = flushCollections();
+        if(status != Status::OK) return status;
         try {
             mh.reset(new TkrzwDBMigrationHandle(*this));
         } catch(...) {
@@ -1046,6 +1049,7 @@ class TkrzwDatabase : public DocumentStoreMixin<DatabaseInterface> {
 
     ~TkrzwDatabase() {
         if(m_db) {
+            flushCollections();
             m_db->Close();
             delete m_db;
         }
@@ -216,6 +216,7 @@ class UnQLiteDatabase : public DocumentStoreMixin<DatabaseInterface> {
                     |YOKAN_MODE_IGNORE_DOCS
                     |YOKAN_MODE_FILTER_VALUE
                     |YOKAN_MODE_LIB_FILTER
+                    |YOKAN_MODE_JSON_FILTER
                     |YOKAN_MODE_NO_RDMA
                     |YOKAN_MODE_UPDATE_NEW
                     )
@@ -859,6 +860,8 @@ class UnQLiteDatabase : public DocumentStoreMixin<DatabaseInterface> {
     Status startMigration(std::unique_ptr<MigrationHandle>& mh) override {
         if(m_migrated) return Status::Migrated;
         if(m_config["mode"] == "memory") return Status::NotSupported;
+        auto status = flushCollections();
+        if(status != Status::OK) return status;
         try {
             mh.reset(new UnQLiteMigrationHandle(*this));
         } catch(...) {
@@ -868,6 +871,8 @@ class UnQLiteDatabase : public DocumentStoreMixin<DatabaseInterface> {
     }
 
     ~UnQLiteDatabase() {
+        if(m_db)
+            flushCollections();
         if(m_lock != ABT_RWLOCK_NULL)
             ABT_rwlock_free(&m_lock);
         if(m_db)
@@ -0,0 +1,101 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#ifndef __YOKAN_BACKEND_UTIL_FILTER_BATCH_HPP
+#define __YOKAN_BACKEND_UTIL_FILTER_BATCH_HPP
+
+#include "yokan/filters.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+
+namespace yokan {
+
+/**
+ * Block of candidate key/value pairs collected by a backend's scan, along
+ * with the backend-specific position (Row) of each of them, so that they
+ * can be checked with a single call to KeyValueFilter::checkBatch.
+ */
+template<typename Row, size_t N = 64>
+struct KeyValueBatch {
+
+    static constexpr size_t capacity = N;
+
+    Row         rows[N];
+    const void* keys[N];
+    size_t      ksizes[N];
+    const void* vals[N];
+    size_t      vsizes[N];
+    uint8_t     results[N];
+    size_t      size = 0;
+
+    /**
+     * Number of candidates to collect in the next block when at most
+     * max entries (0 meaning no limit) are wanted and count of them have
+     * already been found: since every candidate of the block may pass
+     * the filter, the block must not exceed the number of entries left.
+     */
+    static size_t limit(uint64_t max, uint64_t count) {
+        if(max == 0) return N;
+        return std::min<uint64_t>(N, max - count);
+    }
+
+    void clear() {
+        size = 0;
+    }
+
+    void push(const Row& row, const void* key, size_t ksize,
+              const void* val, size_t vsize) {
+        rows[size]   = row;
+        keys[size]   = key;
+        ksizes[size] = ksize;
+        vals[size]   = val;
+        vsizes[size] = vsize;
+        size += 1;
+    }
+
+    void check(const std::shared_ptr<KeyValueFilter>& filter) {
+        filter->checkBatch(keys, ksizes, vals, vsizes, results, size);
+    }
+};
+
+/**
+ * DocFilter equivalent of KeyValueBatch.
+ */
+template<size_t N = 64>
+struct DocBatch {
+
+    static constexpr size_t capacity = N;
+
+    yk_id_t     ids[N];
+    const void* docs[N];
+    size_t      docsizes[N];
+    uint8_t     results[N];
+    size_t      size = 0;
+
+    static size_t limit(uint64_t max, uint64_t count) {
+        if(max == 0) return N;
+        return std::min<uint64_t>(N, max - count);
+    }
+
+    void clear() {
+        size = 0;
+    }
+
+    void push(yk_id_t id, const void* doc, size_t docsize) {
+        ids[size]      = id;
+        docs[size]     = doc;
+        docsizes[size] = docsize;
+        size += 1;
+    }
+
+    void check(const char* collection, const std::shared_ptr<DocFilter>& filter) {
+        filter->checkBatch(collection, ids, docs, docsizes, results, size);
+    }
+};
+
+}
+
+#endif
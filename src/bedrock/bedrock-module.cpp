@@ -32,6 +32,11 @@ class YokanComponent : public bedrock::AbstractComponent {
         return m_provider->getConfig();
     }
 
+    /* Metrics of the provider as JSON (see yk_provider_get_stats). */
+    std::string getStats() const {
+        return m_provider->getStats();
+    }
+
     static std::shared_ptr<bedrock::AbstractComponent>
         Register(const bedrock::ComponentArgs& args) {
             tl::pool pool;
@@ -51,12 +56,25 @@ class YokanComponent : public bedrock::AbstractComponent {
                 auto component = it->second[0]->getHandle<bedrock::ComponentPtr>();
                 remi_receiver = static_cast<remi_provider_t>(component->getHandle());
             }
+            auto get_pool = [&args](const char* name) {
+                auto it = args.dependencies.find(name);
+                if(it != args.dependencies.end() && !it->second.empty())
+                    return it->second[0]->getHandle<tl::pool>().native_handle();
+                return ABT_POOL_NULL;
+            };
             yk_provider_args yk_args = {
                 /* .pool = */ pool.native_handle(),
                 /* .cache = */ nullptr,
                 /* .remi = */ {
                     /* .client = */ remi_sender,
                     /* .provider = */ remi_receiver
+                },
+                /* .pools = */ {
+                    /* .read = */ get_pool("read_pool"),
+                    /* .write = */ get_pool("write_pool"),
+                    /* .scan = */ get_pool("scan_pool"),
+                    /* .doc = */ get_pool("doc_pool"),
+                    /* .admin = */ get_pool("admin_pool")
                 }
             };
             return std::make_shared<YokanComponent>(
@@ -74,6 +92,41 @@ class YokanComponent : public bedrock::AbstractComponent {
                     /* is_array */ false,
                     /* is_updatable */ false
                 },
+                bedrock::Dependency{
+                    /* name */ "read_pool",
+                    /* type */ "pool",
+                    /* is_required */ false,
+                    /* is_array */ false,
+                    /* is_updatable */ false
+                },
+                bedrock::Dependency{
+                    /* name */ "write_pool",
+                    /* type */ "pool",
+                    /* is_required */ false,
+                    /* is_array */ false,
+                    /* is_updatable */ false
+                },
+                bedrock::Dependency{
+                    /* name */ "scan_pool",
+                    /* type */ "pool",
+                    /* is_required */ false,
+                    /* is_array */ false,
+                    /* is_updatable */ false
+                },
+                bedrock::Dependency{
+                    /* name */ "doc_pool",
+                    /* type */ "pool",
+                    /* is_required */ false,
+                    /* is_array */ false,
+                    /* is_updatable */ false
+                },
+                bedrock::Dependency{
+                    /* name */ "admin_pool",
+                    /* type */ "pool",
+                    /* is_required */ false,
+                    /* is_array */ false,
+                    /* is_updatable */ false
+                },
                 bedrock::Dependency{
                     /* name */ "remi_sender",
                     /* type */ "remi_sender",
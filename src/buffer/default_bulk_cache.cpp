@@ -13,6 +13,7 @@ namespace yokan {
 struct default_bulk_cache {
     margo_instance_id          mid;
     std::atomic<unsigned long> num_allocated;
+    std::atomic<uint64_t>      num_misses;
 };
 
 void* default_bulk_cache_init(margo_instance_id mid, const char* config) {
@@ -20,6 +21,7 @@ void* default_bulk_cache_init(margo_instance_id mid, const char* config) {
     auto cache = new default_bulk_cache;
     cache->mid = mid;
     cache->num_allocated = 0;
+    cache->num_misses = 0;
     return cache;
 }
 
@@ -48,6 +50,7 @@ yk_buffer_t default_bulk_cache_get(void* c, size_t size, hg_uint8_t mode) {
 
     auto buffer = new yk_buffer{size, mode, nullptr, HG_BULK_NULL};
     cache->num_allocated += 1;
+    cache->num_misses += 1;
     buffer->data           = new (std::nothrow) char[size];
     if(!buffer->data) {
         // LCOV_EXCL_START
@@ -86,6 +89,12 @@ void default_bulk_cache_release(void* c, yk_buffer_t buffer) {
 
 }
 
+extern "C" void yk_default_bulk_cache_stats(void* c, uint64_t* hits, uint64_t* misses) {
+    auto cache = static_cast<yokan::default_bulk_cache*>(c);
+    *hits   = 0;
+    *misses = cache->num_misses.load();
+}
+
 extern "C" {
 
 yk_bulk_cache yk_default_bulk_cache = {
@@ -9,4 +9,7 @@ extern "C" {
 
 extern yk_bulk_cache yk_default_bulk_cache;
 
+/* number of buffers served from the cache (hits) and allocated (misses) */
+void yk_default_bulk_cache_stats(void* cache, uint64_t* hits, uint64_t* misses);
+
 }
@@ -26,6 +26,8 @@ struct bulk_less {
 struct keep_all_bulk_cache {
     margo_instance_id                mid;
     std::atomic<unsigned long>       num_in_use;
+    std::atomic<uint64_t>            num_hits;
+    std::atomic<uint64_t>            num_misses;
     std::set<yk_buffer_t, bulk_less> buffer_set_readonly;
     std::set<yk_buffer_t, bulk_less> buffer_set_writeonly;
     std::set<yk_buffer_t, bulk_less> buffer_set_readwrite;
@@ -37,6 +39,8 @@ void* keep_all_bulk_cache_init(margo_instance_id mid, const char* config) {
     auto cache = new keep_all_bulk_cache;
     cache->mid = mid;
     cache->num_in_use = 0;
+    cache->num_hits = 0;
+    cache->num_misses = 0;
     auto cfg = json::parse(config);
     if(cfg.contains("margin") && cfg["margin"].is_number()) {
         cache->margin = cfg["margin"].get<float>();
@@ -103,9 +107,11 @@ yk_buffer_t keep_all_bulk_cache_get(void* c, size_t size, hg_uint8_t mode) {
         set->erase(it);
         cache->num_in_use += 1;
         ABT_mutex_unlock(cache->buffer_set_mtx);
+        cache->num_hits += 1;
         return result;
     }
     ABT_mutex_unlock(cache->buffer_set_mtx);
+    cache->num_misses += 1;
 
     // item not found in cache, allocate a new one
 
@@ -157,6 +163,12 @@ void keep_all_bulk_cache_release(void* c, yk_buffer_t buffer) {
 
 }
 
+extern "C" void yk_keep_all_bulk_cache_stats(void* c, uint64_t* hits, uint64_t* misses) {
+    auto cache = static_cast<yokan::keep_all_bulk_cache*>(c);
+    *hits   = cache->num_hits.load();
+    *misses = cache->num_misses.load();
+}
+
 extern "C" {
 
 yk_bulk_cache yk_keep_all_bulk_cache = {
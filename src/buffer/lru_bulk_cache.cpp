@@ -31,6 +31,8 @@ using map_t      = std::map<yk_buffer_t, iterator_t, bulk_less>;
 struct lru_bulk_cache {
     margo_instance_id          mid;
     std::atomic<unsigned long> num_in_use;
+    std::atomic<uint64_t>      num_hits;
+    std::atomic<uint64_t>      num_misses;
 
     list_t buffer_queue_readonly;
     map_t  buffer_set_readonly;
@@ -50,6 +52,8 @@ void* lru_bulk_cache_init(margo_instance_id mid, const char* config) {
     auto cache = new lru_bulk_cache;
     cache->mid = mid;
     cache->num_in_use = 0;
+    cache->num_hits = 0;
+    cache->num_misses = 0;
     auto cfg = json::parse(config);
     if(cfg.contains("margin") && cfg["margin"].is_number()) {
         cache->margin = cfg["margin"].get<float>();
@@ -125,9 +129,11 @@ yk_buffer_t lru_bulk_cache_get(void* c, size_t size, hg_uint8_t mode) {
         map->erase(it);
         cache->num_in_use += 1;
         ABT_mutex_unlock(cache->buffer_set_mtx);
+        cache->num_hits += 1;
         return result;
     }
     ABT_mutex_unlock(cache->buffer_set_mtx);
+    cache->num_misses += 1;
 
     // item not found in cache, allocate a new one
 
@@ -195,6 +201,12 @@ void lru_bulk_cache_release(void* c, yk_buffer_t buffer) {
 
 }
 
+extern "C" void yk_lru_bulk_cache_stats(void* c, uint64_t* hits, uint64_t* misses) {
+    auto cache = static_cast<yokan::lru_bulk_cache*>(c);
+    *hits   = cache->num_hits.load();
+    *misses = cache->num_misses.load();
+}
+
 extern "C" {
 
 yk_bulk_cache yk_lru_bulk_cache = {
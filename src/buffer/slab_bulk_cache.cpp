@@ -0,0 +1,337 @@
+/*
+ * (C) The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#include "yokan/bulk-cache.h"
+#include "default_bulk_cache.hpp"
+#include "../common/logging.h"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <new>
+#include <cstring>
+#include <sys/mman.h>
+#ifdef __linux__
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#endif
+
+namespace yokan {
+
+using json = nlohmann::json;
+
+/*
+ * The slab bulk cache carves buffers of a few size classes (powers of 2
+ * between min_size and max_size) out of one large region per class.
+ * All the buffers and their bulk handles are created when the cache is
+ * initialized, so no memory registration happens on the critical path.
+ * Each buffer is registered separately (one bulk handle per buffer, not
+ * per region), since users of a yk_buffer address it from offset 0 of
+ * its own bulk handle.
+ *
+ * Free buffers of each class are kept in a lock-free stack (indices
+ * tagged with a counter to avoid ABA problems), shared by all execution
+ * streams. There are no per-execution-stream free lists: a buffer kept
+ * by one execution stream could not be used by another, which would
+ * then fall back to allocation while the class still has free buffers.
+ *
+ * Requests larger than max_size, or made when a class is exhausted,
+ * fall back to the default bulk cache (i.e. per-request allocation).
+ *
+ * Regions are mmap-ed, optionally backed by hugepages ("hugepages": true)
+ * to reduce TLB misses and registration costs, and optionally bound to
+ * a NUMA node ("numa_node": <node>, or "local" for the node on which the
+ * provider is being registered). Regions are touched at initialization
+ * so that their pages are reserved before any RPC comes in.
+ */
+
+static constexpr uint32_t SLAB_EMPTY = UINT32_MAX;
+
+struct slab_class {
+    size_t                                size   = 0;
+    uint32_t                              count  = 0;
+    char*                                 region = nullptr;
+    size_t                                region_size = 0;
+    std::unique_ptr<yk_buffer[]>          buffers;
+    std::unique_ptr<std::atomic<uint32_t>[]> next;
+    std::atomic<uint64_t>                 head; // (tag << 32) | index
+
+    bool owns(yk_buffer_t buffer) const {
+        return buffer >= buffers.get() && buffer < buffers.get() + count;
+    }
+
+    void push(uint32_t index) {
+        uint64_t old_head = head.load(std::memory_order_relaxed);
+        uint64_t new_head;
+        do {
+            next[index].store((uint32_t)(old_head & 0xFFFFFFFF), std::memory_order_relaxed);
+            new_head = (((old_head >> 32) + 1) << 32) | index;
+        } while(!head.compare_exchange_weak(old_head, new_head,
+                    std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    uint32_t pop() {
+        uint64_t old_head = head.load(std::memory_order_acquire);
+        uint64_t new_head;
+        uint32_t index;
+        do {
+            index = (uint32_t)(old_head & 0xFFFFFFFF);
+            if(index == SLAB_EMPTY) return SLAB_EMPTY;
+            new_head = (((old_head >> 32) + 1) << 32)
+                     | next[index].load(std::memory_order_relaxed);
+        } while(!head.compare_exchange_weak(old_head, new_head,
+                    std::memory_order_acquire, std::memory_order_acquire));
+        return index;
+    }
+};
+
+struct slab_bulk_cache {
+    margo_instance_id               mid;
+    std::atomic<unsigned long>      num_in_use;
+    std::atomic<unsigned long>      num_fallbacks;
+    std::atomic<uint64_t>           num_hits;
+    size_t                          min_size;
+    size_t                          max_size;
+    std::vector<slab_class>         classes;
+    void*                           fallback;
+};
+
+static char* slab_allocate_region(margo_instance_id mid, size_t& size,
+                                  bool hugepages, size_t hugepage_size,
+                                  int numa_node) {
+    void* ptr = MAP_FAILED;
+    if(hugepages) {
+        size = ((size + hugepage_size - 1)/hugepage_size)*hugepage_size;
+#ifdef MAP_HUGETLB
+        ptr = mmap(nullptr, size, PROT_READ|PROT_WRITE,
+                   MAP_PRIVATE|MAP_ANONYMOUS|MAP_HUGETLB, -1, 0);
+#endif
+        if(ptr == MAP_FAILED) {
+            YOKAN_LOG_WARNING(mid,
+                "Could not reserve %lu bytes of hugepage memory,"
+                " falling back to transparent hugepages", size);
+        }
+    }
+    if(ptr == MAP_FAILED) {
+        ptr = mmap(nullptr, size, PROT_READ|PROT_WRITE,
+                   MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+        if(ptr == MAP_FAILED) return nullptr;
+#ifdef MADV_HUGEPAGE
+        if(hugepages) madvise(ptr, size, MADV_HUGEPAGE);
+#endif
+    }
+    if(numa_node >= 0) {
+#if defined(__linux__) && defined(SYS_mbind)
+        constexpr int mpol_bind = 2; // MPOL_BIND from numaif.h
+        unsigned long nodemask[16] = {0};
+        if(numa_node < (int)(sizeof(nodemask)*8)) {
+            nodemask[numa_node/(sizeof(unsigned long)*8)] |=
+                1UL << (numa_node % (sizeof(unsigned long)*8));
+            if(syscall(SYS_mbind, ptr, size, mpol_bind, nodemask,
+                       sizeof(nodemask)*8, 0) != 0) {
+                YOKAN_LOG_WARNING(mid,
+                    "Could not bind bulk cache region to NUMA node %d", numa_node);
+            }
+        }
+#else
+        YOKAN_LOG_WARNING(mid,
+            "NUMA binding is not supported on this platform");
+#endif
+    }
+    // touch the pages so they are allocated now rather than on first use
+    std::memset(ptr, 0, size);
+    return static_cast<char*>(ptr);
+}
+
+static int slab_local_numa_node() {
+#if defined(__linux__) && defined(SYS_getcpu)
+    unsigned cpu = 0, node = 0;
+    if(syscall(SYS_getcpu, &cpu, &node, nullptr) == 0)
+        return (int)node;
+#endif
+    return -1;
+}
+
+void slab_bulk_cache_finalize(void* c);
+
+void* slab_bulk_cache_init(margo_instance_id mid, const char* config) {
+    size_t min_size, max_size, buffers_per_class;
+    size_t hugepage_size;
+    bool   hugepages;
+    int    numa_node = -1;
+    try {
+        auto cfg = json::parse(config);
+        min_size          = cfg.value("min_size", (size_t)4096);
+        max_size          = cfg.value("max_size", (size_t)1048576);
+        buffers_per_class = cfg.value("buffers_per_class", (size_t)16);
+        hugepages         = cfg.value("hugepages", false);
+        hugepage_size     = cfg.value("hugepage_size", (size_t)2*1024*1024);
+        if(cfg.contains("numa_node")) {
+            if(cfg["numa_node"].is_string() && cfg["numa_node"] == "local")
+                numa_node = slab_local_numa_node();
+            else
+                numa_node = cfg["numa_node"].get<int>();
+        }
+    } catch(const std::exception& ex) {
+        YOKAN_LOG_ERROR(mid, "Invalid configuration for slab bulk cache: %s", ex.what());
+        return nullptr;
+    }
+
+    if(min_size == 0 || max_size < min_size
+    || buffers_per_class == 0 || buffers_per_class >= SLAB_EMPTY
+    || (hugepages && hugepage_size == 0)) {
+        YOKAN_LOG_ERROR(mid, "Invalid configuration for slab bulk cache");
+        return nullptr;
+    }
+
+    auto cache = new slab_bulk_cache;
+    cache->mid              = mid;
+    cache->num_in_use       = 0;
+    cache->num_fallbacks    = 0;
+    cache->num_hits         = 0;
+    cache->min_size         = min_size;
+    cache->max_size         = max_size;
+    cache->fallback         = yk_default_bulk_cache.init(mid, "{}");
+
+    size_t num_classes = 0;
+    for(size_t s = min_size; s < max_size; s *= 2) num_classes += 1;
+    num_classes += 1;
+    cache->classes = std::vector<slab_class>(num_classes);
+
+    size_t class_size = min_size;
+    for(auto& cls : cache->classes) {
+        cls.size    = std::min(class_size, max_size);
+        cls.count   = buffers_per_class;
+        cls.buffers = std::make_unique<yk_buffer[]>(cls.count);
+        cls.next    = std::make_unique<std::atomic<uint32_t>[]>(cls.count);
+        cls.head    = SLAB_EMPTY;
+        cls.region_size = cls.size*cls.count;
+        cls.region  = slab_allocate_region(mid, cls.region_size,
+                                           hugepages, hugepage_size, numa_node);
+        if(!cls.region) {
+            // LCOV_EXCL_START
+            YOKAN_LOG_ERROR(mid,
+                "Allocation of %lu-byte region failed in slab_bulk_cache",
+                cls.region_size);
+            slab_bulk_cache_finalize(cache);
+            return nullptr;
+            // LCOV_EXCL_STOP
+        }
+        for(uint32_t i = 0; i < cls.count; i++) {
+            auto& buffer = cls.buffers[i];
+            buffer.size = cls.size;
+            buffer.mode = HG_BULK_READWRITE;
+            buffer.data = cls.region + i*cls.size;
+            buffer.bulk = HG_BULK_NULL;
+            void* buf_ptrs[1]      = { buffer.data };
+            hg_size_t buf_sizes[1] = { buffer.size };
+            hg_return_t hret = margo_bulk_create(mid,
+                1, buf_ptrs, buf_sizes, HG_BULK_READWRITE, &buffer.bulk);
+            if(hret != HG_SUCCESS) {
+                // LCOV_EXCL_START
+                YOKAN_LOG_ERROR(mid,
+                    "margo_bulk_create failed with error code %d"
+                    " when creating bulk handle for %lu bytes", hret, cls.size);
+                slab_bulk_cache_finalize(cache);
+                return nullptr;
+                // LCOV_EXCL_STOP
+            }
+            cls.push(i);
+        }
+        class_size *= 2;
+    }
+
+    return cache;
+}
+
+void slab_bulk_cache_finalize(void* c) {
+    auto cache = static_cast<slab_bulk_cache*>(c);
+    auto num_in_use = cache->num_in_use.load();
+    if(num_in_use != 0) {
+        // LCOV_EXCL_START
+        YOKAN_LOG_ERROR(cache->mid,
+            "%ld buffers have not been released to the bulk cache",
+            num_in_use);
+        // LCOV_EXCL_STOP
+    }
+    auto num_fallbacks = cache->num_fallbacks.load();
+    if(num_fallbacks != 0) {
+        YOKAN_LOG_INFO(cache->mid,
+            "slab_bulk_cache had to allocate %ld buffers outside of its slabs",
+            num_fallbacks);
+    }
+    for(auto& cls : cache->classes) {
+        if(!cls.buffers) continue;
+        for(uint32_t i = 0; i < cls.count; i++) {
+            if(cls.buffers[i].bulk != HG_BULK_NULL)
+                margo_bulk_free(cls.buffers[i].bulk);
+        }
+        if(cls.region) munmap(cls.region, cls.region_size);
+    }
+    if(cache->fallback)
+        yk_default_bulk_cache.finalize(cache->fallback);
+    delete cache;
+}
+
+yk_buffer_t slab_bulk_cache_get(void* c, size_t size, hg_uint8_t mode) {
+    auto cache = static_cast<slab_bulk_cache*>(c);
+    if(size == 0) {
+        // LCOV_EXCL_START
+        YOKAN_LOG_ERROR(cache->mid,
+            "requesting a buffer of size 0");
+        return nullptr;
+        // LCOV_EXCL_STOP
+    }
+
+    if(size <= cache->max_size) {
+        size_t class_index = 0;
+        while(cache->classes[class_index].size < size) class_index += 1;
+        auto& cls = cache->classes[class_index];
+
+        uint32_t index = cls.pop();
+        if(index != SLAB_EMPTY) {
+            cache->num_in_use += 1;
+            cache->num_hits += 1;
+            return &cls.buffers[index];
+        }
+    }
+
+    cache->num_fallbacks += 1;
+    auto buffer = yk_default_bulk_cache.get(cache->fallback, size, mode);
+    if(buffer) cache->num_in_use += 1;
+    return buffer;
+}
+
+void slab_bulk_cache_release(void* c, yk_buffer_t buffer) {
+    auto cache = static_cast<slab_bulk_cache*>(c);
+    cache->num_in_use -= 1;
+    for(auto& cls : cache->classes) {
+        if(!cls.owns(buffer)) continue;
+        cls.push(buffer - cls.buffers.get());
+        return;
+    }
+    yk_default_bulk_cache.release(cache->fallback, buffer);
+}
+
+}
+
+extern "C" void yk_slab_bulk_cache_stats(void* c, uint64_t* hits, uint64_t* misses) {
+    auto cache = static_cast<yokan::slab_bulk_cache*>(c);
+    *hits   = cache->num_hits.load();
+    *misses = cache->num_fallbacks.load();
+}
+
+extern "C" {
+
+yk_bulk_cache yk_slab_bulk_cache = {
+    yokan::slab_bulk_cache_init,
+    yokan::slab_bulk_cache_finalize,
+    yokan::slab_bulk_cache_get,
+    yokan::slab_bulk_cache_release
+};
+
+}
@@ -0,0 +1,15 @@
+/*
+ * (C) The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#include "yokan/bulk-cache.h"
+
+extern "C" {
+
+extern yk_bulk_cache yk_slab_bulk_cache;
+
+/* number of buffers served from the cache (hits) and allocated (misses) */
+void yk_slab_bulk_cache_stats(void* cache, uint64_t* hits, uint64_t* misses);
+
+}
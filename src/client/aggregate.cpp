@@ -0,0 +1,105 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#include <cmath>
+#include <cstring>
+#include "client.hpp"
+#include "../common/defer.hpp"
+#include "../common/types.h"
+#include "../common/logging.h"
+#include "../common/checks.h"
+
+extern "C" void yk_aggregate_init(yk_aggregate_t* agg, size_t hist_bins)
+{
+    std::memset(agg, 0, sizeof(*agg));
+    agg->min       = INFINITY;
+    agg->max       = -INFINITY;
+    agg->hist_bins = hist_bins;
+}
+
+extern "C" yk_return_t yk_aggregate_merge(yk_aggregate_t* dst, const yk_aggregate_t* src)
+{
+    if(!dst || !src || dst->hist_bins != src->hist_bins
+    || dst->hist_bins > YOKAN_AGGREGATE_MAX_BINS)
+        return YOKAN_ERR_INVALID_ARGS;
+    dst->count          += src->count;
+    dst->num_values     += src->num_values;
+    dst->sum            += src->sum;
+    dst->min             = std::fmin(dst->min, src->min);
+    dst->max             = std::fmax(dst->max, src->max);
+    dst->hist_underflow += src->hist_underflow;
+    dst->hist_overflow  += src->hist_overflow;
+    for(size_t i = 0; i < dst->hist_bins; i++)
+        dst->hist[i] += src->hist[i];
+    return YOKAN_SUCCESS;
+}
+
+extern "C" yk_return_t yk_aggregate(yk_database_handle_t dbh,
+                                    int32_t mode,
+                                    const void* from_key,
+                                    size_t from_ksize,
+                                    const void* filter,
+                                    size_t filter_size,
+                                    const yk_aggregate_spec_t* spec,
+                                    yk_aggregate_t* result)
+{
+    if(from_key == nullptr && from_ksize > 0)
+        return YOKAN_ERR_INVALID_ARGS;
+    if(filter == nullptr && filter_size > 0)
+        return YOKAN_ERR_INVALID_ARGS;
+    if(spec == nullptr || result == nullptr)
+        return YOKAN_ERR_INVALID_ARGS;
+    if(spec->hist_bins > YOKAN_AGGREGATE_MAX_BINS)
+        return YOKAN_ERR_INVALID_ARGS;
+
+    CHECK_MODE_VALID(mode);
+
+    margo_instance_id mid = dbh->client->mid;
+    yk_return_t ret = YOKAN_SUCCESS;
+    hg_return_t hret = HG_SUCCESS;
+    aggregate_in_t in;
+    aggregate_out_t out;
+    hg_handle_t handle = HG_HANDLE_NULL;
+
+    in.mode          = mode;
+    in.from_key.size = from_ksize;
+    in.from_key.data = (char*)from_key;
+    in.filter.size   = filter_size;
+    in.filter.data   = (char*)filter;
+    in.field_type    = spec->type;
+    in.field         = (char*)(spec->field ? spec->field : "");
+    in.field_offset  = spec->offset;
+    in.hist_min      = spec->hist_min;
+    in.hist_max      = spec->hist_max;
+    in.hist_bins     = spec->hist_bins;
+
+    yk_aggregate_init(result, spec->hist_bins);
+    // the histogram is decoded directly into the result
+    out.hist.count = YOKAN_AGGREGATE_MAX_BINS;
+    out.hist.sizes = result->hist;
+
+    hret = margo_create(mid, dbh->addr, dbh->client->aggregate_id, &handle);
+    CHECK_HRET(hret, margo_create);
+    DEFER(margo_destroy(handle));
+
+    hret = yk_client_forward(dbh, handle, &in, &out);
+    CHECK_HRET(hret, yk_client_forward);
+
+    ret = static_cast<yk_return_t>(out.ret);
+    if(ret == YOKAN_SUCCESS) {
+        result->count          = out.count;
+        result->num_values     = out.num_values;
+        result->sum            = out.sum;
+        result->min            = out.min;
+        result->max            = out.max;
+        result->hist_underflow = out.hist_underflow;
+        result->hist_overflow  = out.hist_overflow;
+    }
+    out.hist.sizes = nullptr;
+    hret = margo_free_output(handle, &out);
+    CHECK_HRET(hret, margo_free_output);
+
+    return ret;
+}
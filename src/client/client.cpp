@@ -7,6 +7,7 @@
 #include "client.hpp"
 #include "yokan/client.h"
 #include <stdio.h>
+#include <algorithm>
 
 extern "C" yk_return_t yk_client_init(margo_instance_id mid, yk_client_t* client)
 {
@@ -15,6 +16,13 @@ extern "C" yk_return_t yk_client_init(margo_instance_id mid, yk_client_t* client
 
     c->mid = mid;
 
+    // disabled until yk_client_set_registration_cache is called
+    c->registration_cache = new yokan::RegistrationCache(mid, 0);
+
+    c->retry.max_retries   = 10;
+    c->retry.base_delay_ms = 1.0;
+    c->retry.max_delay_ms  = 500.0;
+
     hg_bool_t flag;
     hg_id_t id;
     margo_registered_name(mid, "yk_exists", &id, &flag);
@@ -40,6 +48,10 @@ extern "C" yk_return_t yk_client_init(margo_instance_id mid, yk_client_t* client
         margo_registered_name(mid, "yk_list_keyvals_direct", &c->list_keyvals_direct_id, &flag);
         margo_registered_name(mid, "yk_iter",                &c->iter_id,                &flag);
         margo_registered_name(mid, "yk_iter_irect",          &c->iter_direct_id,         &flag);
+        margo_registered_name(mid, "yk_cursor_open",         &c->cursor_open_id,         &flag);
+        margo_registered_name(mid, "yk_cursor_next",         &c->cursor_next_id,         &flag);
+        margo_registered_name(mid, "yk_cursor_close",        &c->cursor_close_id,        &flag);
+        margo_registered_name(mid, "yk_aggregate",           &c->aggregate_id,           &flag);
 
         margo_registered_name(mid, "yk_coll_create",      &c->coll_create_id,      &flag);
         margo_registered_name(mid, "yk_coll_drop",        &c->coll_drop_id,        &flag);
@@ -59,6 +71,13 @@ extern "C" yk_return_t yk_client_init(margo_instance_id mid, yk_client_t* client
         margo_registered_name(mid, "yk_doc_list_direct",  &c->doc_list_direct_id,  &flag);
         margo_registered_name(mid, "yk_doc_iter",         &c->doc_iter_id,         &flag);
         margo_registered_name(mid, "yk_doc_iter_direct",  &c->doc_iter_direct_id,  &flag);
+        margo_registered_name(mid, "yk_doc_aggregate",    &c->doc_aggregate_id,    &flag);
+        margo_registered_name(mid, "yk_coll_create_index", &c->coll_create_index_id, &flag);
+        margo_registered_name(mid, "yk_coll_drop_index",  &c->coll_drop_index_id,  &flag);
+        margo_registered_name(mid, "yk_doc_query",        &c->doc_query_id,        &flag);
+        margo_registered_name(mid, "yk_coll_reserve_ids", &c->coll_reserve_ids_id, &flag);
+
+        margo_registered_name(mid, "yk_get_stats",        &c->get_stats_id,        &flag);
 
     } else {
 
@@ -119,6 +138,18 @@ extern "C" yk_return_t yk_client_init(margo_instance_id mid, yk_client_t* client
         c->iter_direct_id =
             MARGO_REGISTER(mid, "yk_iter_direct",
                            iter_in_t, iter_out_t, NULL);
+        c->cursor_open_id =
+            MARGO_REGISTER(mid, "yk_cursor_open",
+                           cursor_open_in_t, cursor_open_out_t, NULL);
+        c->cursor_next_id =
+            MARGO_REGISTER(mid, "yk_cursor_next",
+                           cursor_next_in_t, cursor_next_out_t, NULL);
+        c->cursor_close_id =
+            MARGO_REGISTER(mid, "yk_cursor_close",
+                           cursor_close_in_t, cursor_close_out_t, NULL);
+        c->aggregate_id =
+            MARGO_REGISTER(mid, "yk_aggregate",
+                           aggregate_in_t, aggregate_out_t, NULL);
 
         c->coll_create_id =
             MARGO_REGISTER(mid, "yk_coll_create",
@@ -174,6 +205,25 @@ extern "C" yk_return_t yk_client_init(margo_instance_id mid, yk_client_t* client
         c->doc_iter_direct_id =
             MARGO_REGISTER(mid, "yk_doc_iter_direct",
                            doc_iter_in_t, doc_iter_out_t, NULL);
+        c->doc_aggregate_id =
+            MARGO_REGISTER(mid, "yk_doc_aggregate",
+                           doc_aggregate_in_t, doc_aggregate_out_t, NULL);
+        c->coll_create_index_id =
+            MARGO_REGISTER(mid, "yk_coll_create_index",
+                           coll_create_index_in_t, coll_create_index_out_t, NULL);
+        c->coll_drop_index_id =
+            MARGO_REGISTER(mid, "yk_coll_drop_index",
+                           coll_drop_index_in_t, coll_drop_index_out_t, NULL);
+        c->doc_query_id =
+            MARGO_REGISTER(mid, "yk_doc_query",
+                           doc_query_in_t, doc_query_out_t, NULL);
+        c->coll_reserve_ids_id =
+            MARGO_REGISTER(mid, "yk_coll_reserve_ids",
+                           coll_reserve_ids_in_t, coll_reserve_ids_out_t, NULL);
+
+        c->get_stats_id =
+            MARGO_REGISTER(mid, "yk_get_stats",
+                           void, get_stats_out_t, NULL);
     }
 
     // The RPCs bellow should be registered regardless of whether they already were registered
@@ -216,10 +266,79 @@ extern "C" yk_return_t yk_client_finalize(yk_client_t client)
             client->num_database_handles);
         // LCOV_EXCL_STOP
     }
+    delete client->registration_cache;
+    delete client->tracer;
     free(client);
     return YOKAN_SUCCESS;
 }
 
+extern "C" yk_return_t yk_client_set_registration_cache(
+        yk_client_t client,
+        size_t capacity)
+{
+    if(client == YOKAN_CLIENT_NULL)
+        return YOKAN_ERR_INVALID_ARGS;
+    client->registration_cache->setCapacity(capacity);
+    return YOKAN_SUCCESS;
+}
+
+extern "C" yk_return_t yk_client_invalidate_registrations(
+        yk_client_t client,
+        const void* ptr,
+        size_t size)
+{
+    if(client == YOKAN_CLIENT_NULL)
+        return YOKAN_ERR_INVALID_ARGS;
+    client->registration_cache->invalidate(ptr, size);
+    return YOKAN_SUCCESS;
+}
+
+extern "C" yk_return_t yk_client_set_retry_policy(
+        yk_client_t client,
+        unsigned max_retries,
+        double base_delay_ms,
+        double max_delay_ms)
+{
+    if(client == YOKAN_CLIENT_NULL)
+        return YOKAN_ERR_INVALID_ARGS;
+    if(base_delay_ms < 0.0 || max_delay_ms < base_delay_ms)
+        return YOKAN_ERR_INVALID_ARGS;
+    client->retry.max_retries   = max_retries;
+    client->retry.base_delay_ms = base_delay_ms;
+    client->retry.max_delay_ms  = max_delay_ms;
+    return YOKAN_SUCCESS;
+}
+
+extern "C" yk_return_t yk_client_set_tracing(
+        yk_client_t client,
+        double sample_rate,
+        size_t max_requests)
+{
+    if(client == YOKAN_CLIENT_NULL)
+        return YOKAN_ERR_INVALID_ARGS;
+    if(sample_rate < 0.0 || sample_rate > 1.0)
+        return YOKAN_ERR_INVALID_ARGS;
+    if(sample_rate == 0.0 && !client->tracer)
+        return YOKAN_SUCCESS;
+    if(!client->tracer)
+        client->tracer = new yokan::Tracer();
+    client->tracer->configure(sample_rate > 0.0, sample_rate, max_requests);
+    return YOKAN_SUCCESS;
+}
+
+extern "C" yk_return_t yk_client_dump_trace(
+        yk_client_t client,
+        const char* filename)
+{
+    if(client == YOKAN_CLIENT_NULL || !filename)
+        return YOKAN_ERR_INVALID_ARGS;
+    if(!client->tracer)
+        client->tracer = new yokan::Tracer();
+    if(!client->tracer->dump(filename))
+        return YOKAN_ERR_IO;
+    return YOKAN_SUCCESS;
+}
+
 extern "C" yk_return_t yk_database_handle_create(
         yk_client_t client,
         hg_addr_t addr,
@@ -255,6 +374,13 @@ extern "C" yk_return_t yk_database_handle_create(
     rh->provider_id = provider_id;
     rh->refcount    = 1;
 
+    // payloads that fit in Mercury's eager buffers (minus some room
+    // for the rest of the RPC's input/output) are sent inline
+    hg_class_t* hg_class = margo_get_class(client->mid);
+    size_t eager_size = std::min<size_t>(HG_Class_get_input_eager_size(hg_class),
+                                 HG_Class_get_output_eager_size(hg_class));
+    rh->eager_threshold = eager_size > 256 ? eager_size - 256 : 0;
+
     client->num_database_handles += 1;
 
     *handle = rh;
@@ -296,3 +422,27 @@ extern "C" yk_return_t yk_database_handle_release(yk_database_handle_t handle)
     }
     return YOKAN_SUCCESS;
 }
+
+extern "C" yk_return_t yk_database_handle_set_eager_threshold(
+        yk_database_handle_t handle,
+        size_t threshold)
+{
+    if(handle == YOKAN_DATABASE_HANDLE_NULL)
+        return YOKAN_ERR_INVALID_ARGS;
+    handle->eager_threshold = threshold;
+    return YOKAN_SUCCESS;
+}
+
+extern "C" yk_return_t yk_database_handle_get_eager_stats(
+        yk_database_handle_t handle,
+        size_t* threshold,
+        uint64_t* num_eager,
+        uint64_t* num_rdma)
+{
+    if(handle == YOKAN_DATABASE_HANDLE_NULL)
+        return YOKAN_ERR_INVALID_ARGS;
+    if(threshold) *threshold = handle->eager_threshold;
+    if(num_eager) *num_eager = handle->num_eager.load(std::memory_order_relaxed);
+    if(num_rdma)  *num_rdma  = handle->num_rdma.load(std::memory_order_relaxed);
+    return YOKAN_SUCCESS;
+}
@@ -9,6 +9,12 @@
 #include "yokan/client.h"
 #include "yokan/database.h"
 #include "yokan/collection.h"
+#include "registration_cache.hpp"
+#include "../common/tracing.hpp"
+#include "../common/types.h"
+#include <algorithm>
+#include <atomic>
+#include <random>
 
 typedef struct yk_client {
     margo_instance_id mid;
@@ -36,6 +42,10 @@ typedef struct yk_client {
     hg_id_t           iter_direct_id;
     hg_id_t           iter_back_id;
     hg_id_t           iter_direct_back_id;
+    hg_id_t           cursor_open_id;
+    hg_id_t           cursor_next_id;
+    hg_id_t           cursor_close_id;
+    hg_id_t           aggregate_id;
 
     hg_id_t           coll_create_id;
     hg_id_t           coll_drop_id;
@@ -59,17 +69,226 @@ typedef struct yk_client {
     hg_id_t           doc_iter_direct_id;
     hg_id_t           doc_iter_back_id;
     hg_id_t           doc_iter_direct_back_id;
+    hg_id_t           doc_aggregate_id;
+    hg_id_t           coll_create_index_id;
+    hg_id_t           coll_drop_index_id;
+    hg_id_t           doc_query_id;
+    hg_id_t           coll_reserve_ids_id;
+
+    hg_id_t           get_stats_id;
 
     uint64_t          num_database_handles;
+
+    // created with the client and never replaced, so that bulk handles
+    // of operations in flight are always released through the cache
+    // that created them (a capacity of 0 disables it)
+    yokan::RegistrationCache* registration_cache;
+
+    yokan::Tracer*    tracer; // Only set once tracing has been enabled
+
+    struct {
+        unsigned      max_retries;
+        double        base_delay_ms;
+        double        max_delay_ms;
+    } retry;        // Backoff when a provider is overloaded
 } yk_client;
 
+/**
+ * @brief Creates a bulk handle exposing user memory, going through
+ * the client's registration cache (which creates a plain bulk handle
+ * if it is disabled). The segments
+ * listed in staged are per-call arrays (sizes, flags) which the cache
+ * copies into its own memory instead of registering them.
+ * The bulk handle must be freed using yk_client_bulk_free.
+ */
+static inline hg_return_t yk_client_bulk_create(yk_client_t client,
+                                                uint32_t count,
+                                                void** ptrs,
+                                                const hg_size_t* sizes,
+                                                hg_uint8_t flags,
+                                                const std::vector<yokan::RegistrationCache::Staged>& staged,
+                                                hg_bulk_t* bulk)
+{
+    return client->registration_cache->create(count, ptrs, sizes, flags, staged, bulk);
+}
+
+/**
+ * @brief Frees a bulk handle created by yk_client_bulk_create, copying
+ * any staged output back into the caller's arrays.
+ */
+static inline void yk_client_bulk_free(yk_client_t client, hg_bulk_t bulk)
+{
+    client->registration_cache->release(bulk);
+}
+
 typedef struct yk_database_handle {
-    yk_client_t      client;
-    hg_addr_t        addr;
-    uint16_t         provider_id;
-    uint64_t         refcount;
+    yk_client_t           client;
+    hg_addr_t             addr;
+    uint16_t              provider_id;
+    uint64_t              refcount;
+    size_t                eager_threshold;
+    // incremented by concurrent operations on the handle
+    std::atomic<uint64_t> num_eager;
+    std::atomic<uint64_t> num_rdma;
 } yk_database_handle;
 
+/**
+ * @brief Decides whether an operation carrying payload_size bytes
+ * should be sent inline in the RPC (i.e. using a *_direct RPC) or
+ * using RDMA, and updates the handle's counters accordingly.
+ */
+static inline bool yk_use_eager_protocol(yk_database_handle_t dbh,
+                                         int32_t mode,
+                                         size_t payload_size)
+{
+    bool eager = (mode & YOKAN_MODE_NO_RDMA)
+              || (payload_size <= dbh->eager_threshold);
+    if(eager) dbh->num_eager.fetch_add(1, std::memory_order_relaxed);
+    else      dbh->num_rdma.fetch_add(1, std::memory_order_relaxed);
+    return eager;
+}
+
+/**
+ * @brief Name of the RPC a handle was created for, used in traces.
+ */
+static inline const char* yk_client_rpc_name(yk_client_t client, hg_handle_t handle)
+{
+    const struct hg_info* info = margo_get_info(handle);
+    if(!info) return "unknown";
+    const std::pair<hg_id_t, const char*> names[] = {
+        { client->count_id, "count" },
+        { client->exists_id, "exists" },
+        { client->exists_direct_id, "exists_direct" },
+        { client->length_id, "length" },
+        { client->length_direct_id, "length_direct" },
+        { client->put_id, "put" },
+        { client->put_direct_id, "put_direct" },
+        { client->get_id, "get" },
+        { client->get_direct_id, "get_direct" },
+        { client->fetch_id, "fetch" },
+        { client->fetch_direct_id, "fetch_direct" },
+        { client->erase_id, "erase" },
+        { client->erase_direct_id, "erase_direct" },
+        { client->list_keys_id, "list_keys" },
+        { client->list_keys_direct_id, "list_keys_direct" },
+        { client->list_keyvals_id, "list_keyvals" },
+        { client->list_keyvals_direct_id, "list_keyvals_direct" },
+        { client->iter_id, "iter" },
+        { client->iter_direct_id, "iter_direct" },
+        { client->cursor_open_id, "cursor_open" },
+        { client->cursor_next_id, "cursor_next" },
+        { client->cursor_close_id, "cursor_close" },
+        { client->aggregate_id, "aggregate" },
+        { client->coll_create_id, "coll_create" },
+        { client->coll_drop_id, "coll_drop" },
+        { client->coll_exists_id, "coll_exists" },
+        { client->coll_last_id_id, "coll_last_id" },
+        { client->coll_size_id, "coll_size" },
+        { client->doc_erase_id, "doc_erase" },
+        { client->doc_load_id, "doc_load" },
+        { client->doc_load_direct_id, "doc_load_direct" },
+        { client->doc_fetch_id, "doc_fetch" },
+        { client->doc_store_id, "doc_store" },
+        { client->doc_store_direct_id, "doc_store_direct" },
+        { client->doc_update_id, "doc_update" },
+        { client->doc_update_direct_id, "doc_update_direct" },
+        { client->doc_length_id, "doc_length" },
+        { client->doc_list_id, "doc_list" },
+        { client->doc_list_direct_id, "doc_list_direct" },
+        { client->doc_iter_id, "doc_iter" },
+        { client->doc_iter_direct_id, "doc_iter_direct" },
+        { client->doc_aggregate_id, "doc_aggregate" },
+        { client->coll_create_index_id, "coll_create_index" },
+        { client->coll_drop_index_id, "coll_drop_index" },
+        { client->doc_query_id, "doc_query" },
+        { client->coll_reserve_ids_id, "coll_reserve_ids" },
+        { client->get_stats_id, "get_stats" }
+    };
+    for(auto& p : names)
+        if(p.first == info->id) return p.second;
+    return "unknown";
+}
+
+/**
+ * @brief Sets the trace ID carried by an RPC's input (RPCs without
+ * input, such as get_stats, are not traced on the server side).
+ */
+template<typename InType>
+static inline void yk_set_trace_id(InType* in, uint64_t trace_id)
+{
+    in->trace_id = trace_id;
+}
+
+static inline void yk_set_trace_id(void*, uint64_t) {}
+
+/**
+ * @brief Forwards an RPC to the database's provider and gets its output.
+ * While the provider's admission control refuses the RPC (responding with
+ * YOKAN_REFUSED_BUSY or YOKAN_REFUSED_TRY_AGAIN, meaning the operation was
+ * not executed), the RPC is forwarded again after a randomized exponential
+ * backoff, up to the client's retry policy, after which the refusal is
+ * reported as YOKAN_ERR_BUSY or YOKAN_ERR_TRY_AGAIN. YOKAN_ERR_BUSY and
+ * YOKAN_ERR_TRY_AGAIN returned by the operation itself are not retried,
+ * since the operation may have had effects (or called the user's
+ * callbacks) before failing. The output must be freed with margo_free_output.
+ *
+ * Outputs whose fields point to user memory (rather than memory allocated
+ * when decoding) must provide a detach function that resets these fields
+ * before the output of a refused attempt is freed.
+ *
+ * If the client's tracer samples the request, its ID is sent in the
+ * input's trace_id field so that the provider traces it as well.
+ */
+template<typename InType, typename OutType, typename DetachFn>
+static inline hg_return_t yk_client_forward(yk_database_handle_t dbh,
+                                            hg_handle_t handle,
+                                            InType* in,
+                                            OutType* out,
+                                            DetachFn&& detach)
+{
+    static thread_local std::minstd_rand rng{std::random_device{}()};
+    yokan::RequestTrace trace;
+    if(dbh->client->tracer)
+        trace.begin(*dbh->client->tracer, "client",
+                    yk_client_rpc_name(dbh->client, handle), nullptr);
+    yk_set_trace_id(in, trace.sample(0));
+    const auto& retry = dbh->client->retry;
+    const OutType initial = *out;
+    double delay_ms = retry.base_delay_ms;
+    for(unsigned attempt = 0; ; attempt++) {
+        hg_return_t hret = margo_provider_forward(dbh->provider_id, handle, in);
+        if(hret != HG_SUCCESS) return hret;
+        trace.stage("forward");
+        hret = margo_get_output(handle, out);
+        if(hret != HG_SUCCESS) return hret;
+        trace.stage("get_output");
+        const bool refused = out->ret == YOKAN_REFUSED_BUSY
+                          || out->ret == YOKAN_REFUSED_TRY_AGAIN;
+        if(!refused) return HG_SUCCESS;
+        if(attempt >= retry.max_retries) {
+            out->ret = out->ret == YOKAN_REFUSED_BUSY ?
+                YOKAN_ERR_BUSY : YOKAN_ERR_TRY_AGAIN;
+            return HG_SUCCESS;
+        }
+        detach(out);
+        margo_free_output(handle, out);
+        *out = initial;
+        std::uniform_real_distribution<double> jitter(0.0, delay_ms);
+        margo_thread_sleep(dbh->client->mid, jitter(rng));
+        delay_ms = std::min(2*delay_ms, retry.max_delay_ms);
+        trace.stage("backoff");
+    }
+}
+
+template<typename InType, typename OutType>
+static inline hg_return_t yk_client_forward(yk_database_handle_t dbh,
+                                            hg_handle_t handle,
+                                            InType* in,
+                                            OutType* out)
+{
+    return yk_client_forward(dbh, handle, in, out, [](OutType*) {});
+}
+
 DECLARE_MARGO_RPC_HANDLER(yk_fetch_back_ult)
 void yk_fetch_back_ult(hg_handle_t h);
 DECLARE_MARGO_RPC_HANDLER(yk_fetch_direct_back_ult)
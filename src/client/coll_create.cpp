@@ -31,11 +31,8 @@ extern "C" yk_return_t yk_collection_create(yk_database_handle_t dbh,
     CHECK_HRET(hret, margo_create);
     DEFER(margo_destroy(handle));
 
-    hret = margo_provider_forward(dbh->provider_id, handle, &in);
-    CHECK_HRET(hret, margo_provider_forward);
-
-    hret = margo_get_output(handle, &out);
-    CHECK_HRET(hret, margo_get_output);
+    hret = yk_client_forward(dbh, handle, &in, &out);
+    CHECK_HRET(hret, yk_client_forward);
 
     ret = static_cast<yk_return_t>(out.ret);
     hret = margo_free_output(handle, &out);
@@ -0,0 +1,49 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#include "client.hpp"
+#include "../common/defer.hpp"
+#include "../common/types.h"
+#include "../common/logging.h"
+#include "../common/checks.h"
+
+extern "C" yk_return_t yk_collection_create_index(yk_database_handle_t dbh,
+                                                  const char* collection,
+                                                  int32_t mode,
+                                                  const char* name,
+                                                  const yk_index_spec_t* spec) {
+    if(collection == nullptr || name == nullptr || spec == nullptr)
+        return YOKAN_ERR_INVALID_ARGS;
+
+    CHECK_MODE_VALID(mode);
+
+    margo_instance_id mid = dbh->client->mid;
+    yk_return_t ret = YOKAN_SUCCESS;
+    hg_return_t hret = HG_SUCCESS;
+    coll_create_index_in_t in;
+    coll_create_index_out_t out;
+    hg_handle_t handle = HG_HANDLE_NULL;
+
+    in.mode         = mode;
+    in.coll_name    = (char*)collection;
+    in.index_name   = (char*)name;
+    in.field_type   = spec->type;
+    in.field        = (char*)(spec->field ? spec->field : "");
+    in.field_offset = spec->offset;
+    in.extractor    = (char*)(spec->extractor ? spec->extractor : "");
+
+    hret = margo_create(mid, dbh->addr, dbh->client->coll_create_index_id, &handle);
+    CHECK_HRET(hret, margo_create);
+    DEFER(margo_destroy(handle));
+
+    hret = yk_client_forward(dbh, handle, &in, &out);
+    CHECK_HRET(hret, yk_client_forward);
+
+    ret = static_cast<yk_return_t>(out.ret);
+    hret = margo_free_output(handle, &out);
+    CHECK_HRET(hret, margo_free_output);
+
+    return ret;
+}
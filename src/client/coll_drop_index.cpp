@@ -0,0 +1,44 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#include "client.hpp"
+#include "../common/defer.hpp"
+#include "../common/types.h"
+#include "../common/logging.h"
+#include "../common/checks.h"
+
+extern "C" yk_return_t yk_collection_drop_index(yk_database_handle_t dbh,
+                                                const char* collection,
+                                                int32_t mode,
+                                                const char* name) {
+    if(collection == nullptr || name == nullptr)
+        return YOKAN_ERR_INVALID_ARGS;
+
+    CHECK_MODE_VALID(mode);
+
+    margo_instance_id mid = dbh->client->mid;
+    yk_return_t ret = YOKAN_SUCCESS;
+    hg_return_t hret = HG_SUCCESS;
+    coll_drop_index_in_t in;
+    coll_drop_index_out_t out;
+    hg_handle_t handle = HG_HANDLE_NULL;
+
+    in.mode       = mode;
+    in.coll_name  = (char*)collection;
+    in.index_name = (char*)name;
+
+    hret = margo_create(mid, dbh->addr, dbh->client->coll_drop_index_id, &handle);
+    CHECK_HRET(hret, margo_create);
+    DEFER(margo_destroy(handle));
+
+    hret = yk_client_forward(dbh, handle, &in, &out);
+    CHECK_HRET(hret, yk_client_forward);
+
+    ret = static_cast<yk_return_t>(out.ret);
+    hret = margo_free_output(handle, &out);
+    CHECK_HRET(hret, margo_free_output);
+
+    return ret;
+}
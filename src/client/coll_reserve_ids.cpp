@@ -0,0 +1,48 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#include <vector>
+#include <array>
+#include <numeric>
+#include "client.hpp"
+#include "../common/defer.hpp"
+#include "../common/types.h"
+#include "../common/logging.h"
+#include "../common/checks.h"
+
+extern "C" yk_return_t yk_collection_reserve_ids(yk_database_handle_t dbh,
+                                                 const char* name,
+                                                 int32_t mode,
+                                                 size_t count,
+                                                 yk_id_t* first_id) {
+    CHECK_MODE_VALID(mode);
+
+    margo_instance_id mid = dbh->client->mid;
+    yk_return_t ret = YOKAN_SUCCESS;
+    hg_return_t hret = HG_SUCCESS;
+    coll_reserve_ids_in_t in;
+    coll_reserve_ids_out_t out;
+    hg_handle_t handle = HG_HANDLE_NULL;
+
+    in.mode      = mode;
+    in.coll_name = (char*)name;
+    in.count     = count;
+
+    hret = margo_create(mid, dbh->addr, dbh->client->coll_reserve_ids_id, &handle);
+    CHECK_HRET(hret, margo_create);
+    DEFER(margo_destroy(handle));
+
+    hret = yk_client_forward(dbh, handle, &in, &out);
+    CHECK_HRET(hret, yk_client_forward);
+
+    ret = static_cast<yk_return_t>(out.ret);
+    if(ret == YOKAN_SUCCESS && first_id)
+        *first_id = out.first_id;
+
+    hret = margo_free_output(handle, &out);
+    CHECK_HRET(hret, margo_free_output);
+
+    return ret;
+}
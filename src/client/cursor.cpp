@@ -0,0 +1,178 @@
+/*
+ * (C) 2021 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#include <array>
+#include "client.hpp"
+#include "../common/defer.hpp"
+#include "../common/types.h"
+#include "../common/logging.h"
+#include "../common/checks.h"
+
+extern "C" yk_return_t yk_cursor_open(yk_database_handle_t dbh,
+                                      int32_t mode,
+                                      const void* from_key,
+                                      size_t from_ksize,
+                                      const void* filter,
+                                      size_t filter_size,
+                                      yk_cursor_id_t* cursor)
+{
+    if(from_key == nullptr && from_ksize > 0)
+        return YOKAN_ERR_INVALID_ARGS;
+    if(filter == nullptr && filter_size > 0)
+        return YOKAN_ERR_INVALID_ARGS;
+    if(cursor == nullptr)
+        return YOKAN_ERR_INVALID_ARGS;
+
+    CHECK_MODE_VALID(mode);
+
+    margo_instance_id mid = dbh->client->mid;
+    yk_return_t ret = YOKAN_SUCCESS;
+    hg_return_t hret = HG_SUCCESS;
+    cursor_open_in_t in;
+    cursor_open_out_t out;
+    hg_handle_t handle = HG_HANDLE_NULL;
+
+    in.mode          = mode;
+    in.from_key.size = from_ksize;
+    in.from_key.data = (char*)from_key;
+    in.filter.size   = filter_size;
+    in.filter.data   = (char*)filter;
+
+    hret = margo_create(mid, dbh->addr, dbh->client->cursor_open_id, &handle);
+    CHECK_HRET(hret, margo_create);
+    DEFER(margo_destroy(handle));
+
+    hret = yk_client_forward(dbh, handle, &in, &out);
+    CHECK_HRET(hret, yk_client_forward);
+
+    ret = static_cast<yk_return_t>(out.ret);
+    if(ret == YOKAN_SUCCESS)
+        *cursor = out.cursor_id;
+    hret = margo_free_output(handle, &out);
+    CHECK_HRET(hret, margo_free_output);
+
+    return ret;
+}
+
+/**
+ * The cursor_next operation uses a single bulk handle exposing data as follows:
+ * - The first count * sizeof(size_t) bytes represent the key sizes.
+ * - The next count * sizeof(size_t) bytes represent the value sizes
+ *   (absent if values are not requested).
+ * - The next keys_buf_size bytes store keys back to back.
+ * - The next vals_buf_size bytes store values back to back
+ *   (absent if values are not requested).
+ */
+
+extern "C" yk_return_t yk_cursor_next_packed(yk_database_handle_t dbh,
+                                             yk_cursor_id_t cursor,
+                                             size_t count,
+                                             void* keys,
+                                             size_t keys_buf_size,
+                                             size_t* ksizes,
+                                             void* values,
+                                             size_t vals_buf_size,
+                                             size_t* vsizes,
+                                             bool* done)
+{
+    if(count == 0)
+        return YOKAN_SUCCESS;
+    if(ksizes == nullptr || (keys == nullptr && keys_buf_size > 0))
+        return YOKAN_ERR_INVALID_ARGS;
+    if(values == nullptr && vals_buf_size > 0)
+        return YOKAN_ERR_INVALID_ARGS;
+
+    bool no_values = (vsizes == nullptr);
+
+    margo_instance_id mid = dbh->client->mid;
+    yk_return_t ret = YOKAN_SUCCESS;
+    hg_return_t hret = HG_SUCCESS;
+    cursor_next_in_t in;
+    cursor_next_out_t out;
+    hg_handle_t handle = HG_HANDLE_NULL;
+    hg_bulk_t bulk = HG_BULK_NULL;
+
+    std::array<void*,4> ptrs;
+    std::array<hg_size_t,4> sizes;
+
+    unsigned i = 0;
+    ptrs[i]  = ksizes;
+    sizes[i] = count * sizeof(*ksizes);
+    i += 1;
+    if(!no_values) {
+        ptrs[i]  = vsizes;
+        sizes[i] = count * sizeof(*vsizes);
+        i += 1;
+    }
+    if(keys_buf_size) {
+        ptrs[i]  = keys;
+        sizes[i] = keys_buf_size;
+        i += 1;
+    }
+    if(!no_values && vals_buf_size) {
+        ptrs[i]  = values;
+        sizes[i] = vals_buf_size;
+        i += 1;
+    }
+
+    std::vector<yokan::RegistrationCache::Staged> staged = {{0, true}};
+    if(!no_values)
+        staged.push_back({1, true});
+
+    hret = yk_client_bulk_create(dbh->client, i, ptrs.data(), sizes.data(),
+                                 HG_BULK_WRITE_ONLY, staged, &bulk);
+    CHECK_HRET(hret, yk_client_bulk_create);
+    DEFER(yk_client_bulk_free(dbh->client, bulk));
+
+    in.cursor_id     = cursor;
+    in.count         = count;
+    in.no_values     = no_values;
+    in.offset        = 0;
+    in.keys_buf_size = keys_buf_size;
+    in.vals_buf_size = no_values ? 0 : vals_buf_size;
+    in.origin        = nullptr;
+    in.bulk          = bulk;
+
+    hret = margo_create(mid, dbh->addr, dbh->client->cursor_next_id, &handle);
+    CHECK_HRET(hret, margo_create);
+    DEFER(margo_destroy(handle));
+
+    hret = yk_client_forward(dbh, handle, &in, &out);
+    CHECK_HRET(hret, yk_client_forward);
+
+    ret = static_cast<yk_return_t>(out.ret);
+    if(ret == YOKAN_SUCCESS && done)
+        *done = out.done;
+    hret = margo_free_output(handle, &out);
+    CHECK_HRET(hret, margo_free_output);
+
+    return ret;
+}
+
+extern "C" yk_return_t yk_cursor_close(yk_database_handle_t dbh,
+                                       yk_cursor_id_t cursor)
+{
+    margo_instance_id mid = dbh->client->mid;
+    yk_return_t ret = YOKAN_SUCCESS;
+    hg_return_t hret = HG_SUCCESS;
+    cursor_close_in_t in;
+    cursor_close_out_t out;
+    hg_handle_t handle = HG_HANDLE_NULL;
+
+    in.cursor_id = cursor;
+
+    hret = margo_create(mid, dbh->addr, dbh->client->cursor_close_id, &handle);
+    CHECK_HRET(hret, margo_create);
+    DEFER(margo_destroy(handle));
+
+    hret = yk_client_forward(dbh, handle, &in, &out);
+    CHECK_HRET(hret, yk_client_forward);
+
+    ret = static_cast<yk_return_t>(out.ret);
+    hret = margo_free_output(handle, &out);
+    CHECK_HRET(hret, margo_free_output);
+
+    return ret;
+}
@@ -0,0 +1,78 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#include "client.hpp"
+#include "../common/defer.hpp"
+#include "../common/types.h"
+#include "../common/logging.h"
+#include "../common/checks.h"
+
+extern "C" yk_return_t yk_doc_aggregate(yk_database_handle_t dbh,
+                                        const char* collection,
+                                        int32_t mode,
+                                        yk_id_t start_id,
+                                        const void* filter,
+                                        size_t filter_size,
+                                        const yk_aggregate_spec_t* spec,
+                                        yk_aggregate_t* result)
+{
+    if(collection == nullptr)
+        return YOKAN_ERR_INVALID_ARGS;
+    if(filter == nullptr && filter_size > 0)
+        return YOKAN_ERR_INVALID_ARGS;
+    if(spec == nullptr || result == nullptr)
+        return YOKAN_ERR_INVALID_ARGS;
+    if(spec->hist_bins > YOKAN_AGGREGATE_MAX_BINS)
+        return YOKAN_ERR_INVALID_ARGS;
+
+    CHECK_MODE_VALID(mode);
+
+    margo_instance_id mid = dbh->client->mid;
+    yk_return_t ret = YOKAN_SUCCESS;
+    hg_return_t hret = HG_SUCCESS;
+    doc_aggregate_in_t in;
+    doc_aggregate_out_t out;
+    hg_handle_t handle = HG_HANDLE_NULL;
+
+    in.mode          = mode;
+    in.coll_name     = (char*)collection;
+    in.from_id       = start_id;
+    in.filter.size   = filter_size;
+    in.filter.data   = (char*)filter;
+    in.field_type    = spec->type;
+    in.field         = (char*)(spec->field ? spec->field : "");
+    in.field_offset  = spec->offset;
+    in.hist_min      = spec->hist_min;
+    in.hist_max      = spec->hist_max;
+    in.hist_bins     = spec->hist_bins;
+
+    yk_aggregate_init(result, spec->hist_bins);
+    // the histogram is decoded directly into the result
+    out.hist.count = YOKAN_AGGREGATE_MAX_BINS;
+    out.hist.sizes = result->hist;
+
+    hret = margo_create(mid, dbh->addr, dbh->client->doc_aggregate_id, &handle);
+    CHECK_HRET(hret, margo_create);
+    DEFER(margo_destroy(handle));
+
+    hret = yk_client_forward(dbh, handle, &in, &out);
+    CHECK_HRET(hret, yk_client_forward);
+
+    ret = static_cast<yk_return_t>(out.ret);
+    if(ret == YOKAN_SUCCESS) {
+        result->count          = out.count;
+        result->num_values     = out.num_values;
+        result->sum            = out.sum;
+        result->min            = out.min;
+        result->max            = out.max;
+        result->hist_underflow = out.hist_underflow;
+        result->hist_overflow  = out.hist_overflow;
+    }
+    out.hist.sizes = nullptr;
+    hret = margo_free_output(handle, &out);
+    CHECK_HRET(hret, margo_free_output);
+
+    return ret;
+}
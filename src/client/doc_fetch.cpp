@@ -37,13 +37,15 @@ static yk_return_t doc_fetch_base(yk_database_handle_t dbh,
                                   int32_t mode,
                                   size_t count,
                                   const yk_id_t* ids,
+                                  const void* filter,
+                                  size_t filter_size,
                                   void* cb,
                                   void* uargs,
                                   const yk_doc_fetch_options_t* options)
 {
     if(count == 0)
         return YOKAN_SUCCESS;
-    else if(!ids || !cb)
+    else if(!ids || !cb || (filter_size && !filter))
         return YOKAN_ERR_INVALID_ARGS;
 
     CHECK_MODE_VALID(mode);
@@ -72,17 +74,16 @@ static yk_return_t doc_fetch_base(yk_database_handle_t dbh,
     in.coll_name  = (char*)collection;
     in.ids.ids    = (yk_id_t*)ids;
     in.ids.count  = count;
+    in.filter.data = (char*)filter;
+    in.filter.size = filter_size;
     in.op_ref     = reinterpret_cast<uint64_t>(&context);
 
     hret = margo_create(mid, dbh->addr, dbh->client->doc_fetch_id, &handle);
     CHECK_HRET(hret, margo_create);
     DEFER(margo_destroy(handle));
 
-    hret = margo_provider_forward(dbh->provider_id, handle, &in);
-    CHECK_HRET(hret, margo_provider_forward);
-
-    hret = margo_get_output(handle, &out);
-    CHECK_HRET(hret, margo_get_output);
+    hret = yk_client_forward(dbh, handle, &in, &out);
+    CHECK_HRET(hret, yk_client_forward);
 
     ret = static_cast<yk_return_t>(out.ret);
     hret = margo_free_output(handle, &out);
@@ -102,7 +103,7 @@ extern "C" yk_return_t yk_doc_fetch_bulk(yk_database_handle_t dbh,
 {
     if(mode & YOKAN_MODE_NO_RDMA)
         return YOKAN_ERR_MODE;
-    return doc_fetch_base(dbh, collection, mode, count, ids, (void*)cb, uargs, options);
+    return doc_fetch_base(dbh, collection, mode, count, ids, nullptr, 0, (void*)cb, uargs, options);
 }
 
 static yk_return_t invoke_callback_on_docs(
@@ -199,20 +200,22 @@ static yk_return_t bulk_to_docs(
             docs.data(), context->cb, context->base.uargs);
 }
 
-extern "C" yk_return_t yk_doc_fetch_multi(yk_database_handle_t dbh,
-                                          const char* collection,
-                                          int32_t mode,
-                                          size_t count,
-                                          const yk_id_t* ids,
-                                          yk_document_callback_t cb,
-                                          void* uargs,
-                                          const yk_doc_fetch_options_t* options)
+extern "C" yk_return_t yk_doc_fetch_multi_filtered(yk_database_handle_t dbh,
+                                                   const char* collection,
+                                                   int32_t mode,
+                                                   size_t count,
+                                                   const yk_id_t* ids,
+                                                   const void* filter,
+                                                   size_t filter_size,
+                                                   yk_document_callback_t cb,
+                                                   void* uargs,
+                                                   const yk_doc_fetch_options_t* options)
 {
     if(mode & YOKAN_MODE_NO_RDMA) {
 
         return doc_fetch_base(
-            dbh, collection, mode, count,
-            ids, (void*)cb, uargs, options);
+            dbh, collection, mode, count, ids,
+            filter, filter_size, (void*)cb, uargs, options);
 
     } else {
 
@@ -225,11 +228,37 @@ extern "C" yk_return_t yk_doc_fetch_multi(yk_database_handle_t dbh,
         context.cb           = cb;
 
         return doc_fetch_base(
-            dbh, collection, mode, count,
-            ids, (void*)bulk_to_docs, &context, options);
+            dbh, collection, mode, count, ids,
+            filter, filter_size, (void*)bulk_to_docs, &context, options);
     }
 }
 
+extern "C" yk_return_t yk_doc_fetch_multi(yk_database_handle_t dbh,
+                                          const char* collection,
+                                          int32_t mode,
+                                          size_t count,
+                                          const yk_id_t* ids,
+                                          yk_document_callback_t cb,
+                                          void* uargs,
+                                          const yk_doc_fetch_options_t* options)
+{
+    return yk_doc_fetch_multi_filtered(dbh, collection, mode, count, ids,
+                                       nullptr, 0, cb, uargs, options);
+}
+
+extern "C" yk_return_t yk_doc_fetch_filtered(yk_database_handle_t dbh,
+                                             const char* collection,
+                                             int32_t mode,
+                                             yk_id_t id,
+                                             const void* filter,
+                                             size_t filter_size,
+                                             yk_document_callback_t cb,
+                                             void* uargs)
+{
+    return yk_doc_fetch_multi_filtered(dbh, collection, mode, 1, &id,
+                                       filter, filter_size, cb, uargs, nullptr);
+}
+
 extern "C" yk_return_t yk_doc_fetch(yk_database_handle_t dbh,
                                     const char* collection,
                                     int32_t mode,
@@ -44,16 +44,18 @@ extern "C" yk_return_t yk_doc_length_multi(yk_database_handle_t dbh,
     CHECK_HRET(hret, margo_create);
     DEFER(margo_destroy(handle));
 
-    hret = margo_provider_forward(dbh->provider_id, handle, &in);
-    CHECK_HRET(hret, margo_provider_forward);
+    // the output's buffers belong to the caller and must not be freed
+    auto detach = [](doc_length_out_t* out) {
+        out->sizes.sizes = nullptr;
+        out->sizes.count = 0;
+    };
 
-    hret = margo_get_output(handle, &out);
-    CHECK_HRET(hret, margo_get_output);
+    hret = yk_client_forward(dbh, handle, &in, &out, detach);
+    CHECK_HRET(hret, yk_client_forward);
 
     ret = static_cast<yk_return_t>(out.ret);
 
-    out.sizes.sizes = nullptr;
-    out.sizes.count = 0;
+    detach(&out);
 
     hret = margo_free_output(handle, &out);
     CHECK_HRET(hret, margo_free_output);
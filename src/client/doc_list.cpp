@@ -5,6 +5,7 @@
  */
 #include <vector>
 #include <array>
+#include <cstring>
 #include <numeric>
 #include <iostream>
 #include "client.hpp"
@@ -61,19 +62,21 @@ static yk_return_t yk_doc_list_direct(yk_database_handle_t dbh,
     CHECK_HRET(hret, margo_create);
     DEFER(margo_destroy(handle));
 
-    hret = margo_provider_forward(dbh->provider_id, handle, &in);
-    CHECK_HRET(hret, margo_provider_forward);
+    // the output's buffers belong to the caller and must not be freed
+    auto detach = [](doc_list_direct_out_t* out) {
+        out->ids.ids     = nullptr;
+        out->ids.count   = 0;
+        out->sizes.sizes = nullptr;
+        out->sizes.count = 0;
+        out->docs.data   = nullptr;
+        out->docs.size   = 0;
+    };
 
-    hret = margo_get_output(handle, &out);
-    CHECK_HRET(hret, margo_get_output);
+    hret = yk_client_forward(dbh, handle, &in, &out, detach);
+    CHECK_HRET(hret, yk_client_forward);
 
     ret = static_cast<yk_return_t>(out.ret);
-    out.ids.ids     = nullptr;
-    out.ids.count   = 0;
-    out.sizes.sizes = nullptr;
-    out.sizes.count = 0;
-    out.docs.data   = nullptr;
-    out.docs.size   = 0;
+    detach(&out);
 
     hret = margo_free_output(handle, &out);
     CHECK_HRET(hret, margo_free_output);
@@ -92,17 +95,19 @@ static yk_return_t yk_doc_list_direct(yk_database_handle_t dbh,
  * sizes specified by the sender.
  */
 
-extern "C" yk_return_t yk_doc_list_bulk(yk_database_handle_t dbh,
-                                        const char* collection,
-                                        int32_t mode,
-                                        yk_id_t from_id,
-                                        size_t filter_size,
-                                        const char* origin,
-                                        hg_bulk_t data,
-                                        size_t offset,
-                                        size_t docs_buf_size,
-                                        bool packed,
-                                        size_t count)
+static yk_return_t yk_doc_list_bulk_budgeted(yk_database_handle_t dbh,
+                                             const char* collection,
+                                             int32_t mode,
+                                             yk_id_t from_id,
+                                             size_t filter_size,
+                                             const char* origin,
+                                             hg_bulk_t data,
+                                             size_t offset,
+                                             size_t docs_buf_size,
+                                             bool packed,
+                                             size_t count,
+                                             const yk_scan_budget_t* budget,
+                                             yk_resume_token_t* token)
 {
     if(count == 0)
         return YOKAN_SUCCESS;
@@ -124,26 +129,55 @@ extern "C" yk_return_t yk_doc_list_bulk(yk_database_handle_t dbh,
     in.filter_size   = filter_size;
     in.offset        = offset;
     in.docs_buf_size = docs_buf_size;
+    in.max_examined  = budget ? budget->max_examined : 0;
+    in.max_time_us   = budget ? budget->max_time_us : 0;
     in.origin        = const_cast<char*>(origin);
     in.bulk          = data;
 
+    out.token.size = 0;
+    out.token.data = nullptr;
+
     hret = margo_create(mid, dbh->addr, dbh->client->doc_list_id, &handle);
     CHECK_HRET(hret, margo_create);
     DEFER(margo_destroy(handle));
 
-    hret = margo_provider_forward(dbh->provider_id, handle, &in);
-    CHECK_HRET(hret, margo_provider_forward);
-
-    hret = margo_get_output(handle, &out);
-    CHECK_HRET(hret, margo_get_output);
+    hret = yk_client_forward(dbh, handle, &in, &out);
+    CHECK_HRET(hret, yk_client_forward);
 
     ret = static_cast<yk_return_t>(out.ret);
+    if(token && ret == YOKAN_SUCCESS) {
+        token->size = 0;
+    } else if(token && ret == YOKAN_ERR_INCOMPLETE) {
+        if(out.token.size > token->capacity) {
+            ret = YOKAN_ERR_BUFFER_SIZE;
+        } else {
+            if(out.token.size) std::memcpy(token->data, out.token.data, out.token.size);
+            token->size = out.token.size;
+        }
+    }
     hret = margo_free_output(handle, &out);
     CHECK_HRET(hret, margo_free_output);
 
     return ret;
 }
 
+extern "C" yk_return_t yk_doc_list_bulk(yk_database_handle_t dbh,
+                                        const char* collection,
+                                        int32_t mode,
+                                        yk_id_t from_id,
+                                        size_t filter_size,
+                                        const char* origin,
+                                        hg_bulk_t data,
+                                        size_t offset,
+                                        size_t docs_buf_size,
+                                        bool packed,
+                                        size_t count)
+{
+    return yk_doc_list_bulk_budgeted(dbh, collection, mode, from_id, filter_size,
+            origin, data, offset, docs_buf_size, packed, count,
+            nullptr, nullptr);
+}
+
 extern "C" yk_return_t yk_doc_list(yk_database_handle_t dbh,
                                    const char* collection,
                                    int32_t mode,
@@ -201,18 +235,25 @@ extern "C" yk_return_t yk_doc_list(yk_database_handle_t dbh,
                             false, count);
 }
 
-extern "C" yk_return_t yk_doc_list_packed(yk_database_handle_t dbh,
-                                          const char* collection,
-                                          int32_t mode,
-                                          yk_id_t start_id,
-                                          const void* filter,
-                                          size_t filter_size,
-                                          size_t count,
-                                          yk_id_t* ids,
-                                          size_t bufsize,
-                                          void* docs,
-                                          size_t* doc_sizes)
+extern "C" yk_return_t yk_doc_list_packed_budgeted(yk_database_handle_t dbh,
+                                                   const char* collection,
+                                                   int32_t mode,
+                                                   yk_id_t start_id,
+                                                   const void* filter,
+                                                   size_t filter_size,
+                                                   size_t count,
+                                                   yk_id_t* ids,
+                                                   size_t bufsize,
+                                                   void* docs,
+                                                   size_t* doc_sizes,
+                                                   const yk_scan_budget_t* budget,
+                                                   yk_resume_token_t* token)
 {
+    if(budget && (mode & YOKAN_MODE_NO_RDMA))
+        return YOKAN_ERR_OP_UNSUPPORTED;
+    if(token && token->data == nullptr && token->capacity > 0)
+        return YOKAN_ERR_INVALID_ARGS;
+
     if(mode & YOKAN_MODE_NO_RDMA)
         return yk_doc_list_direct(dbh, collection, mode,
                 start_id, filter, filter_size, count, ids,
@@ -226,6 +267,13 @@ extern "C" yk_return_t yk_doc_list_packed(yk_database_handle_t dbh,
     if(ids == nullptr || (docs == nullptr && bufsize != 0) || doc_sizes == nullptr)
         return YOKAN_ERR_INVALID_ARGS;
 
+    // a non-empty token replaces the start id
+    if(token && token->size) {
+        if(token->size != sizeof(start_id))
+            return YOKAN_ERR_INVALID_ARGS;
+        std::memcpy(&start_id, token->data, sizeof(start_id));
+    }
+
     hg_bulk_t bulk   = HG_BULK_NULL;
     hg_return_t hret = HG_SUCCESS;
     std::array<void*,4> ptrs;
@@ -255,7 +303,24 @@ extern "C" yk_return_t yk_doc_list_packed(yk_database_handle_t dbh,
     CHECK_HRET(hret, margo_bulk_create);
     DEFER(margo_bulk_free(bulk));
 
-    return yk_doc_list_bulk(dbh, collection, mode, start_id, filter_size,
-                            nullptr, bulk, 0, bufsize,
-                            true, count);
+    return yk_doc_list_bulk_budgeted(dbh, collection, mode, start_id, filter_size,
+                                     nullptr, bulk, 0, bufsize,
+                                     true, count, budget, token);
+}
+
+extern "C" yk_return_t yk_doc_list_packed(yk_database_handle_t dbh,
+                                          const char* collection,
+                                          int32_t mode,
+                                          yk_id_t start_id,
+                                          const void* filter,
+                                          size_t filter_size,
+                                          size_t count,
+                                          yk_id_t* ids,
+                                          size_t bufsize,
+                                          void* docs,
+                                          size_t* doc_sizes)
+{
+    return yk_doc_list_packed_budgeted(dbh, collection, mode, start_id,
+            filter, filter_size, count, ids, bufsize, docs, doc_sizes,
+            nullptr, nullptr);
 }
@@ -18,6 +18,8 @@ static yk_return_t yk_doc_load_direct(yk_database_handle_t dbh,
                                       int32_t mode,
                                       size_t count,
                                       const yk_id_t* ids,
+                                      const void* filter,
+                                      size_t filter_size,
                                       size_t rbufsize,
                                       void* records,
                                       size_t* rsizes) {
@@ -39,6 +41,8 @@ static yk_return_t yk_doc_load_direct(yk_database_handle_t dbh,
     in.coll_name = (char*)collection;
     in.ids.count = count;
     in.ids.ids   = (yk_id_t*)ids;
+    in.filter.data = (char*)filter;
+    in.filter.size = filter_size;
     in.bufsize   = rbufsize;
 
     out.sizes.sizes = rsizes;
@@ -50,18 +54,20 @@ static yk_return_t yk_doc_load_direct(yk_database_handle_t dbh,
     CHECK_HRET(hret, margo_create);
     DEFER(margo_destroy(handle));
 
-    hret = margo_provider_forward(dbh->provider_id, handle, &in);
-    CHECK_HRET(hret, margo_provider_forward);
+    // the output's buffers belong to the caller and must not be freed
+    auto detach = [](doc_load_direct_out_t* out) {
+        out->sizes.sizes = nullptr;
+        out->sizes.count = 0;
+        out->docs.data   = nullptr;
+        out->docs.size   = 0;
+    };
 
-    hret = margo_get_output(handle, &out);
-    CHECK_HRET(hret, margo_get_output);
+    hret = yk_client_forward(dbh, handle, &in, &out, detach);
+    CHECK_HRET(hret, yk_client_forward);
 
     ret = static_cast<yk_return_t>(out.ret);
 
-    out.sizes.sizes = nullptr;
-    out.sizes.count = 0;
-    out.docs.data   = nullptr;
-    out.docs.size   = 0;
+    detach(&out);
 
     hret = margo_free_output(handle, &out);
     CHECK_HRET(hret, margo_free_output);
@@ -70,16 +76,18 @@ static yk_return_t yk_doc_load_direct(yk_database_handle_t dbh,
 }
 
 
-extern "C" yk_return_t yk_doc_load_bulk(yk_database_handle_t dbh,
-                                        const char* name,
-                                        int32_t mode,
-                                        size_t count,
-                                        const yk_id_t* ids,
-                                        const char* origin,
-                                        hg_bulk_t data,
-                                        size_t offset,
-                                        size_t size,
-                                        bool packed) {
+static yk_return_t yk_doc_load_bulk_filtered(yk_database_handle_t dbh,
+                                             const char* name,
+                                             int32_t mode,
+                                             size_t count,
+                                             const yk_id_t* ids,
+                                             const void* filter,
+                                             size_t filter_size,
+                                             const char* origin,
+                                             hg_bulk_t data,
+                                             size_t offset,
+                                             size_t size,
+                                             bool packed) {
     CHECK_MODE_VALID(mode);
 
     margo_instance_id mid = dbh->client->mid;
@@ -93,6 +101,8 @@ extern "C" yk_return_t yk_doc_load_bulk(yk_database_handle_t dbh,
     in.coll_name = (char*)name;
     in.ids.count = count;
     in.ids.ids   = (yk_id_t*)ids;
+    in.filter.data = (char*)filter;
+    in.filter.size = filter_size;
     in.origin    = (char*)origin;
     in.bulk      = data;
     in.offset    = offset;
@@ -103,11 +113,8 @@ extern "C" yk_return_t yk_doc_load_bulk(yk_database_handle_t dbh,
     CHECK_HRET(hret, margo_create);
     DEFER(margo_destroy(handle));
 
-    hret = margo_provider_forward(dbh->provider_id, handle, &in);
-    CHECK_HRET(hret, margo_provider_forward);
-
-    hret = margo_get_output(handle, &out);
-    CHECK_HRET(hret, margo_get_output);
+    hret = yk_client_forward(dbh, handle, &in, &out);
+    CHECK_HRET(hret, yk_client_forward);
 
     ret = static_cast<yk_return_t>(out.ret);
 
@@ -117,18 +124,36 @@ extern "C" yk_return_t yk_doc_load_bulk(yk_database_handle_t dbh,
     return ret;
 }
 
-extern "C" yk_return_t yk_doc_load_packed(yk_database_handle_t dbh,
-                                          const char* collection,
-                                          int32_t mode,
-                                          size_t count,
-                                          const yk_id_t* ids,
-                                          size_t rbufsize,
-                                          void* records,
-                                          size_t* rsizes) {
+extern "C" yk_return_t yk_doc_load_bulk(yk_database_handle_t dbh,
+                                        const char* name,
+                                        int32_t mode,
+                                        size_t count,
+                                        const yk_id_t* ids,
+                                        const char* origin,
+                                        hg_bulk_t data,
+                                        size_t offset,
+                                        size_t size,
+                                        bool packed) {
+    return yk_doc_load_bulk_filtered(dbh, name, mode, count, ids, nullptr, 0,
+                                     origin, data, offset, size, packed);
+}
 
+extern "C" yk_return_t yk_doc_load_packed_filtered(yk_database_handle_t dbh,
+                                                   const char* collection,
+                                                   int32_t mode,
+                                                   size_t count,
+                                                   const yk_id_t* ids,
+                                                   const void* filter,
+                                                   size_t filter_size,
+                                                   size_t rbufsize,
+                                                   void* records,
+                                                   size_t* rsizes) {
+
+    if(filter_size && !filter)
+        return YOKAN_ERR_INVALID_ARGS;
     if(mode & YOKAN_MODE_NO_RDMA) {
         return yk_doc_load_direct(dbh, collection, mode, count, ids,
-                                  rbufsize, records, rsizes);
+                                  filter, filter_size, rbufsize, records, rsizes);
     }
     if(count == 0)
         return YOKAN_SUCCESS;
@@ -152,7 +177,20 @@ extern "C" yk_return_t yk_doc_load_packed(yk_database_handle_t dbh,
     CHECK_HRET(hret, margo_bulk_create);
     DEFER(margo_bulk_free(bulk));
 
-    return yk_doc_load_bulk(dbh, collection, mode, count, ids, nullptr, bulk, 0, total_size, true);
+    return yk_doc_load_bulk_filtered(dbh, collection, mode, count, ids, filter, filter_size,
+                                     nullptr, bulk, 0, total_size, true);
+}
+
+extern "C" yk_return_t yk_doc_load_packed(yk_database_handle_t dbh,
+                                          const char* collection,
+                                          int32_t mode,
+                                          size_t count,
+                                          const yk_id_t* ids,
+                                          size_t rbufsize,
+                                          void* records,
+                                          size_t* rsizes) {
+    return yk_doc_load_packed_filtered(dbh, collection, mode, count, ids, nullptr, 0,
+                                       rbufsize, records, rsizes);
 }
 
 extern "C" yk_return_t yk_doc_load_multi(yk_database_handle_t dbh,
@@ -196,14 +234,17 @@ extern "C" yk_return_t yk_doc_load_multi(yk_database_handle_t dbh,
     return yk_doc_load_bulk(dbh, collection, mode, count, ids, nullptr, bulk, 0, total_size, false);
 }
 
-extern "C" yk_return_t yk_doc_load(yk_database_handle_t dbh,
-                                   const char* collection,
-                                   int32_t mode,
-                                   yk_id_t id,
-                                   void* record,
-                                   size_t* size) {
+extern "C" yk_return_t yk_doc_load_filtered(yk_database_handle_t dbh,
+                                            const char* collection,
+                                            int32_t mode,
+                                            yk_id_t id,
+                                            const void* filter,
+                                            size_t filter_size,
+                                            void* record,
+                                            size_t* size) {
     if(!size) return YOKAN_ERR_INVALID_ARGS;
-    auto ret = yk_doc_load_packed(dbh, collection, mode, 1, &id, *size, record, size);
+    auto ret = yk_doc_load_packed_filtered(dbh, collection, mode, 1, &id,
+                                           filter, filter_size, *size, record, size);
     if(ret != YOKAN_SUCCESS) return ret;
     else if(*size == YOKAN_SIZE_TOO_SMALL)
         return YOKAN_ERR_BUFFER_SIZE;
@@ -211,3 +252,12 @@ extern "C" yk_return_t yk_doc_load(yk_database_handle_t dbh,
         return YOKAN_ERR_KEY_NOT_FOUND;
     return YOKAN_SUCCESS;
 }
+
+extern "C" yk_return_t yk_doc_load(yk_database_handle_t dbh,
+                                   const char* collection,
+                                   int32_t mode,
+                                   yk_id_t id,
+                                   void* record,
+                                   size_t* size) {
+    return yk_doc_load_filtered(dbh, collection, mode, id, nullptr, 0, record, size);
+}
@@ -0,0 +1,146 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#include "client.hpp"
+#include "../common/defer.hpp"
+#include "../common/types.h"
+#include "../common/logging.h"
+#include "../common/checks.h"
+#include <cstring>
+
+static yk_return_t yk_doc_query_impl(yk_database_handle_t dbh,
+                                     const char* collection,
+                                     int32_t mode,
+                                     const char* index,
+                                     const void* lower,
+                                     size_t lower_size,
+                                     const void* upper,
+                                     size_t upper_size,
+                                     yk_query_position_t* position,
+                                     size_t count,
+                                     yk_id_t* ids,
+                                     bool load_docs,
+                                     size_t bufsize,
+                                     void* docs,
+                                     size_t* doc_sizes)
+{
+    if(collection == nullptr || index == nullptr)
+        return YOKAN_ERR_INVALID_ARGS;
+    if((lower == nullptr && lower_size > 0) || (upper == nullptr && upper_size > 0))
+        return YOKAN_ERR_INVALID_ARGS;
+    if(count == 0)
+        return YOKAN_SUCCESS;
+    if(ids == nullptr)
+        return YOKAN_ERR_INVALID_ARGS;
+    if(load_docs && ((docs == nullptr && bufsize != 0) || doc_sizes == nullptr))
+        return YOKAN_ERR_INVALID_ARGS;
+    if(position && ((position->data == nullptr && position->capacity != 0)
+                 || position->size > position->capacity))
+        return YOKAN_ERR_INVALID_ARGS;
+
+    CHECK_MODE_VALID(mode);
+
+    margo_instance_id mid = dbh->client->mid;
+    yk_return_t ret = YOKAN_SUCCESS;
+    hg_return_t hret = HG_SUCCESS;
+    doc_query_in_t in;
+    doc_query_out_t out;
+    hg_handle_t handle = HG_HANDLE_NULL;
+
+    in.mode          = mode;
+    in.coll_name     = (char*)collection;
+    in.index_name    = (char*)index;
+    in.lower.data    = (char*)lower;
+    in.lower.size    = lower ? lower_size : 0;
+    in.upper.data    = (char*)upper;
+    in.upper.size    = upper ? upper_size : 0;
+    in.position.data = position ? (char*)position->data : nullptr;
+    in.position.size = position ? position->size : 0;
+    in.count         = count;
+    in.load_docs     = load_docs;
+    in.bufsize       = bufsize;
+
+    out.ids.ids       = ids;
+    out.ids.count     = count;
+    out.sizes.sizes   = doc_sizes;
+    out.sizes.count   = load_docs ? count : 0;
+    out.docs.data     = (char*)docs;
+    out.docs.size     = load_docs ? bufsize : 0;
+    out.position.data = nullptr; // allocated by margo
+    out.position.size = 0;
+
+    hret = margo_create(mid, dbh->addr, dbh->client->doc_query_id, &handle);
+    CHECK_HRET(hret, margo_create);
+    DEFER(margo_destroy(handle));
+
+    // the output's buffers belong to the caller and must not be freed
+    // (without documents, the empty sizes and docs are allocated by margo)
+    auto detach = [load_docs](doc_query_out_t* out) {
+        out->ids.ids     = nullptr;
+        out->ids.count   = 0;
+        if(!load_docs) return;
+        out->sizes.sizes = nullptr;
+        out->sizes.count = 0;
+        out->docs.data   = nullptr;
+        out->docs.size   = 0;
+    };
+
+    hret = yk_client_forward(dbh, handle, &in, &out, detach);
+    CHECK_HRET(hret, yk_client_forward);
+
+    ret = static_cast<yk_return_t>(out.ret);
+    detach(&out);
+
+    if(ret == YOKAN_SUCCESS && position && out.position.size) {
+        if(out.position.size > position->capacity) {
+            ret = YOKAN_ERR_BUFFER_SIZE;
+        } else {
+            std::memcpy(position->data, out.position.data, out.position.size);
+            position->size = out.position.size;
+        }
+    }
+
+    hret = margo_free_output(handle, &out);
+    CHECK_HRET(hret, margo_free_output);
+
+    return ret;
+}
+
+extern "C" yk_return_t yk_doc_query(yk_database_handle_t dbh,
+                                    const char* collection,
+                                    int32_t mode,
+                                    const char* index,
+                                    const void* lower,
+                                    size_t lower_size,
+                                    const void* upper,
+                                    size_t upper_size,
+                                    yk_query_position_t* position,
+                                    size_t max,
+                                    yk_id_t* ids)
+{
+    return yk_doc_query_impl(dbh, collection, mode, index,
+            lower, lower_size, upper, upper_size, position, max, ids,
+            false, 0, nullptr, nullptr);
+}
+
+extern "C" yk_return_t yk_doc_query_packed(yk_database_handle_t dbh,
+                                           const char* collection,
+                                           int32_t mode,
+                                           const char* index,
+                                           const void* lower,
+                                           size_t lower_size,
+                                           const void* upper,
+                                           size_t upper_size,
+                                           yk_query_position_t* position,
+                                           size_t max,
+                                           yk_id_t* ids,
+                                           size_t bufsize,
+                                           void* docs,
+                                           size_t* doc_sizes)
+{
+    return yk_doc_query_impl(dbh, collection, mode, index,
+            lower, lower_size, upper, upper_size, position, max, ids,
+            true, bufsize, docs, doc_sizes);
+}
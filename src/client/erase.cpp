@@ -43,11 +43,8 @@ static yk_return_t yk_erase_direct(yk_database_handle_t dbh,
     CHECK_HRET(hret, margo_create);
     DEFER(margo_destroy(handle));
 
-    hret = margo_provider_forward(dbh->provider_id, handle, &in);
-    CHECK_HRET(hret, margo_provider_forward);
-
-    hret = margo_get_output(handle, &out);
-    CHECK_HRET(hret, margo_get_output);
+    hret = yk_client_forward(dbh, handle, &in, &out);
+    CHECK_HRET(hret, yk_client_forward);
 
     ret = static_cast<yk_return_t>(out.ret);
     hret = margo_free_output(handle, &out);
@@ -98,11 +95,8 @@ extern "C" yk_return_t yk_erase_bulk(yk_database_handle_t dbh,
     CHECK_HRET(hret, margo_create);
     DEFER(margo_destroy(handle));
 
-    hret = margo_provider_forward(dbh->provider_id, handle, &in);
-    CHECK_HRET(hret, margo_provider_forward);
-
-    hret = margo_get_output(handle, &out);
-    CHECK_HRET(hret, margo_get_output);
+    hret = yk_client_forward(dbh, handle, &in, &out);
+    CHECK_HRET(hret, yk_client_forward);
 
     ret = static_cast<yk_return_t>(out.ret);
     hret = margo_free_output(handle, &out);
@@ -132,11 +126,14 @@ extern "C" yk_return_t yk_erase_multi(yk_database_handle_t dbh,
     else if(!keys || !ksizes)
         return YOKAN_ERR_INVALID_ARGS;
 
-    if(mode & YOKAN_MODE_NO_RDMA) {
+    size_t total_ksize = std::accumulate(ksizes, ksizes+count, (size_t)0);
+    size_t payload_size = count*sizeof(size_t) + total_ksize;
+
+    if(yk_use_eager_protocol(dbh, mode, payload_size)) {
         if(count == 1) {
             return yk_erase_direct(dbh, mode, 1, keys[0], ksizes);
         }
-        std::vector<char> packed_keys(std::accumulate(ksizes, ksizes+count, (size_t)0));
+        std::vector<char> packed_keys(total_ksize);
         size_t offset = 0;
         for(size_t i = 0; i < count; i++) {
             std::memcpy(packed_keys.data()+offset, keys[i], ksizes[i]);
@@ -166,10 +163,11 @@ extern "C" yk_return_t yk_erase_multi(yk_database_handle_t dbh,
 
     size_t total_size = std::accumulate(sizes.begin(), sizes.end(), (size_t)0);
 
-    hret = margo_bulk_create(mid, ptrs.size(), ptrs.data(), sizes.data(),
-                             HG_BULK_READ_ONLY, &bulk);
-    CHECK_HRET(hret, margo_bulk_create);
-    DEFER(margo_bulk_free(bulk));
+    hret = yk_client_bulk_create(dbh->client, ptrs.size(), ptrs.data(), sizes.data(),
+                                 HG_BULK_READ_ONLY,
+                                 {{0, false}}, &bulk);
+    CHECK_HRET(hret, yk_client_bulk_create);
+    DEFER(yk_client_bulk_free(dbh->client, bulk));
 
     return yk_erase_bulk(dbh, mode, count, nullptr, bulk, 0, total_size);
 }
@@ -180,8 +178,10 @@ extern "C" yk_return_t yk_erase_packed(yk_database_handle_t dbh,
                                        const void* keys,
                                        const size_t* ksizes)
 {
-    if(mode & YOKAN_MODE_NO_RDMA)
+    if(mode & YOKAN_MODE_NO_RDMA) {
+        dbh->num_eager.fetch_add(1, std::memory_order_relaxed);
         return yk_erase_direct(dbh, mode, count, keys, ksizes);
+    }
 
     if(count == 0)
         return YOKAN_SUCCESS;
@@ -201,11 +201,15 @@ extern "C" yk_return_t yk_erase_packed(yk_database_handle_t dbh,
     if(sizes[1] == 0)
         return YOKAN_ERR_INVALID_ARGS;
 
-    hret = margo_bulk_create(mid, 2, ptrs.data(), sizes.data(),
-                             HG_BULK_READ_ONLY, &bulk);
+    if(yk_use_eager_protocol(dbh, mode, total_size))
+        return yk_erase_direct(dbh, mode, count, keys, ksizes);
+
+    hret = yk_client_bulk_create(dbh->client, 2, ptrs.data(), sizes.data(),
+                                 HG_BULK_READ_ONLY,
+                                 {{0, false}}, &bulk);
 
-    CHECK_HRET(hret, margo_bulk_create);
-    DEFER(margo_bulk_free(bulk));
+    CHECK_HRET(hret, yk_client_bulk_create);
+    DEFER(yk_client_bulk_free(dbh->client, bulk));
 
     return yk_erase_bulk(dbh, mode, count, nullptr, bulk, 0, total_size);
 }
@@ -48,16 +48,18 @@ static yk_return_t yk_exists_direct(yk_database_handle_t dbh,
     CHECK_HRET(hret, margo_create);
     DEFER(margo_destroy(handle));
 
-    hret = margo_provider_forward(dbh->provider_id, handle, &in);
-    CHECK_HRET(hret, margo_provider_forward);
+    // the output's buffers belong to the caller and must not be freed
+    auto detach = [](exists_direct_out_t* out) {
+        out->flags.data = nullptr;
+        out->flags.size = 0;
+    };
 
-    hret = margo_get_output(handle, &out);
-    CHECK_HRET(hret, margo_get_output);
+    hret = yk_client_forward(dbh, handle, &in, &out, detach);
+    CHECK_HRET(hret, yk_client_forward);
 
     ret = static_cast<yk_return_t>(out.ret);
 
-    out.flags.data = nullptr;
-    out.flags.size = 0;
+    detach(&out);
 
     hret = margo_free_output(handle, &out);
     CHECK_HRET(hret, margo_free_output);
@@ -74,19 +76,22 @@ static yk_return_t yk_exists_direct(yk_database_handle_t dbh,
  *   storing whether each key exists in the database.
  * The server will pull the key sizes, compute N, then pull the keys,
  * get whether each key exists, then push the result back to the sender.
+ * If N is known by the sender (multi and packed variants), it is sent
+ * along with the RPC so the server can pull the sizes and keys at once.
  *
  * Note: the bitfield uses bytes from left to right, but bits from the
  * least significant to the most signficant. For instance considering 16 keys:
  * [00001001][10000000] indicates that that keys 0, 3 and 15 exist.
  */
 
-extern "C" yk_return_t yk_exists_bulk(yk_database_handle_t dbh,
+static yk_return_t yk_exists_bulk_sized(yk_database_handle_t dbh,
                                         int32_t mode,
                                         size_t count,
                                         const char* origin,
                                         hg_bulk_t data,
                                         size_t offset,
-                                        size_t size)
+                                        size_t size,
+                                        size_t total_ksize)
 {
     if(count != 0 && size == 0)
         return YOKAN_ERR_INVALID_ARGS;
@@ -106,16 +111,14 @@ extern "C" yk_return_t yk_exists_bulk(yk_database_handle_t dbh,
     in.offset = offset;
     in.size   = size;
     in.origin = const_cast<char*>(origin);
+    in.total_ksize = total_ksize;
 
     hret = margo_create(mid, dbh->addr, dbh->client->exists_id, &handle);
     CHECK_HRET(hret, margo_create);
     DEFER(margo_destroy(handle));
 
-    hret = margo_provider_forward(dbh->provider_id, handle, &in);
-    CHECK_HRET(hret, margo_provider_forward);
-
-    hret = margo_get_output(handle, &out);
-    CHECK_HRET(hret, margo_get_output);
+    hret = yk_client_forward(dbh, handle, &in, &out);
+    CHECK_HRET(hret, yk_client_forward);
 
     ret = static_cast<yk_return_t>(out.ret);
     hret = margo_free_output(handle, &out);
@@ -124,6 +127,17 @@ extern "C" yk_return_t yk_exists_bulk(yk_database_handle_t dbh,
     return ret;
 }
 
+extern "C" yk_return_t yk_exists_bulk(yk_database_handle_t dbh,
+                                        int32_t mode,
+                                        size_t count,
+                                        const char* origin,
+                                        hg_bulk_t data,
+                                        size_t offset,
+                                        size_t size)
+{
+    return yk_exists_bulk_sized(dbh, mode, count, origin, data, offset, size, 0);
+}
+
 extern "C" yk_return_t yk_exists(yk_database_handle_t dbh,
                                    int32_t mode,
                                    const void* key,
@@ -147,12 +161,14 @@ extern "C" yk_return_t yk_exists_multi(yk_database_handle_t dbh,
     else if(!keys || !ksizes || !flags)
         return YOKAN_ERR_INVALID_ARGS;
 
-    if(mode & YOKAN_MODE_NO_RDMA) {
+    size_t total_ksize = std::accumulate(ksizes, ksizes+count, (size_t)0);
+    size_t payload_size = count*sizeof(size_t) + total_ksize + (count+7)/8;
+
+    if(yk_use_eager_protocol(dbh, mode, payload_size)) {
         if(count == 1) {
             return yk_exists_direct(dbh, mode, count, keys[0], ksizes, flags);
         }
-        auto total_ksizes = std::accumulate(ksizes, ksizes+count, (size_t)0);
-        std::vector<char> packed_keys(total_ksizes);
+        std::vector<char> packed_keys(total_ksize);
         size_t offset = 0;
         for(size_t i=0; i < count; i++) {
             std::memcpy(packed_keys.data()+offset, keys[i], ksizes[i]);
@@ -184,12 +200,13 @@ extern "C" yk_return_t yk_exists_multi(yk_database_handle_t dbh,
 
     size_t total_size = std::accumulate(sizes.begin(), sizes.end(), (size_t)0);
 
-    hret = margo_bulk_create(mid, ptrs.size(), ptrs.data(), sizes.data(),
-                             HG_BULK_READWRITE, &bulk);
-    CHECK_HRET(hret, margo_bulk_create);
-    DEFER(margo_bulk_free(bulk));
+    hret = yk_client_bulk_create(dbh->client, ptrs.size(), ptrs.data(), sizes.data(),
+                                 HG_BULK_READWRITE,
+                                 {{0, false}, {ptrs.size()-1, true}}, &bulk);
+    CHECK_HRET(hret, yk_client_bulk_create);
+    DEFER(yk_client_bulk_free(dbh->client, bulk));
 
-    return yk_exists_bulk(dbh, mode, count, nullptr, bulk, 0, total_size);
+    return yk_exists_bulk_sized(dbh, mode, count, nullptr, bulk, 0, total_size, total_ksize);
 }
 
 extern "C" yk_return_t yk_exists_packed(yk_database_handle_t dbh,
@@ -199,8 +216,10 @@ extern "C" yk_return_t yk_exists_packed(yk_database_handle_t dbh,
                                          const size_t* ksizes,
                                          uint8_t* flags)
 {
-    if(mode & YOKAN_MODE_NO_RDMA)
+    if(mode & YOKAN_MODE_NO_RDMA) {
+        dbh->num_eager.fetch_add(1, std::memory_order_relaxed);
         return yk_exists_direct(dbh, mode, count, keys, ksizes, flags);
+    }
 
     if(count == 0)
         return YOKAN_SUCCESS;
@@ -222,11 +241,15 @@ extern "C" yk_return_t yk_exists_packed(yk_database_handle_t dbh,
     if(sizes[1] == 0)
         return YOKAN_ERR_INVALID_ARGS;
 
-    hret = margo_bulk_create(mid, 3, ptrs.data(), sizes.data(),
-                             HG_BULK_READWRITE, &bulk);
+    if(yk_use_eager_protocol(dbh, mode, total_size))
+        return yk_exists_direct(dbh, mode, count, keys, ksizes, flags);
+
+    hret = yk_client_bulk_create(dbh->client, 3, ptrs.data(), sizes.data(),
+                                 HG_BULK_READWRITE,
+                                 {{0, false}, {2, true}}, &bulk);
 
-    CHECK_HRET(hret, margo_bulk_create);
-    DEFER(margo_bulk_free(bulk));
+    CHECK_HRET(hret, yk_client_bulk_create);
+    DEFER(yk_client_bulk_free(dbh->client, bulk));
 
-    return yk_exists_bulk(dbh, mode, count, nullptr, bulk, 0, total_size);
+    return yk_exists_bulk_sized(dbh, mode, count, nullptr, bulk, 0, total_size, sizes[1]);
 }
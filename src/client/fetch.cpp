@@ -72,11 +72,8 @@ static yk_return_t yk_fetch_direct(yk_database_handle_t dbh,
     CHECK_HRET(hret, margo_create);
     DEFER(margo_destroy(handle));
 
-    hret = margo_provider_forward(dbh->provider_id, handle, &in);
-    CHECK_HRET(hret, margo_provider_forward);
-
-    hret = margo_get_output(handle, &out);
-    CHECK_HRET(hret, margo_get_output);
+    hret = yk_client_forward(dbh, handle, &in, &out);
+    CHECK_HRET(hret, yk_client_forward);
 
     ret = static_cast<yk_return_t>(out.ret);
     hret = margo_free_output(handle, &out);
@@ -195,11 +192,8 @@ extern "C" yk_return_t yk_fetch_bulk(yk_database_handle_t dbh,
     CHECK_HRET(hret, margo_create);
     DEFER(margo_destroy(handle));
 
-    hret = margo_provider_forward(dbh->provider_id, handle, &in);
-    CHECK_HRET(hret, margo_provider_forward);
-
-    hret = margo_get_output(handle, &out);
-    CHECK_HRET(hret, margo_get_output);
+    hret = yk_client_forward(dbh, handle, &in, &out);
+    CHECK_HRET(hret, yk_client_forward);
 
     ret = static_cast<yk_return_t>(out.ret);
     hret = margo_free_output(handle, &out);
@@ -333,7 +327,7 @@ void yk_fetch_back_ult(hg_handle_t h)
 
     fetch_context* context = reinterpret_cast<fetch_context*>(in.op_ref);
 
-    if(context->keys.size() < in.count) {
+    if(context->keys.size() < in.start + in.count) {
         out.ret = YOKAN_ERR_OTHER; // should not be happening
         return;
     }
@@ -386,8 +380,8 @@ void yk_fetch_back_ult(hg_handle_t h)
         args[i].cb    = context->cb;
         args[i].uargs = context->uargs;
         args[i].index = in.start + i;
-        args[i].key   = context->keys[i].first;
-        args[i].ksize = context->keys[i].second;
+        args[i].key   = context->keys[in.start + i].first;
+        args[i].ksize = context->keys[in.start + i].second;
         args[i].val   = values.data() + val_offset;
         args[i].vsize = vsizes[i];
         if(pool == ABT_POOL_NULL) {
@@ -405,6 +399,12 @@ void yk_fetch_back_ult(hg_handle_t h)
     if(pool != ABT_POOL_NULL) {
         ABT_thread_join_many(ults.size(), ults.data());
         ABT_thread_free_many(ults.size(), ults.data());
+        for(auto& arg : args) {
+            if(arg.ret != YOKAN_SUCCESS) {
+                out.ret = arg.ret;
+                break;
+            }
+        }
     }
 }
 DEFINE_MARGO_RPC_HANDLER(yk_fetch_back_ult)
@@ -432,7 +432,7 @@ void yk_fetch_direct_back_ult(hg_handle_t h)
 
     fetch_context* context = reinterpret_cast<fetch_context*>(in.op_ref);
 
-    if(context->keys.size() < in.vsizes.count) {
+    if(context->keys.size() < in.start + in.vsizes.count) {
         out.ret = YOKAN_ERR_OTHER; // should not be happening
         return;
     }
@@ -471,8 +471,8 @@ void yk_fetch_direct_back_ult(hg_handle_t h)
         args[i].cb    = context->cb;
         args[i].uargs = context->uargs;
         args[i].index = in.start + i;
-        args[i].key   = context->keys[i].first;
-        args[i].ksize = context->keys[i].second;
+        args[i].key   = context->keys[in.start + i].first;
+        args[i].ksize = context->keys[in.start + i].second;
         args[i].val   = ((const char*)in.vals.data) + val_offset;
         args[i].vsize = in.vsizes.sizes[i];
         if(pool == ABT_POOL_NULL) {
@@ -490,6 +490,12 @@ void yk_fetch_direct_back_ult(hg_handle_t h)
     if(pool != ABT_POOL_NULL) {
         ABT_thread_join_many(ults.size(), ults.data());
         ABT_thread_free_many(ults.size(), ults.data());
+        for(auto& arg : args) {
+            if(arg.ret != YOKAN_SUCCESS) {
+                out.ret = arg.ret;
+                break;
+            }
+        }
     }
 }
 DEFINE_MARGO_RPC_HANDLER(yk_fetch_direct_back_ult)
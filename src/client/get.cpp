@@ -52,16 +52,18 @@ static yk_return_t yk_get_direct(yk_database_handle_t dbh,
     CHECK_HRET(hret, margo_create);
     DEFER(margo_destroy(handle));
 
-    hret = margo_provider_forward(dbh->provider_id, handle, &in);
-    CHECK_HRET(hret, margo_provider_forward);
+    // the output's buffers belong to the caller and must not be freed
+    auto detach = [](get_direct_out_t* out) {
+        out->vsizes.sizes = nullptr;
+        out->vsizes.count = 0;
+        out->vals.data    = nullptr;
+        out->vals.size    = 0;
+    };
 
-    hret = margo_get_output(handle, &out);
-    CHECK_HRET(hret, margo_get_output);
+    hret = yk_client_forward(dbh, handle, &in, &out, detach);
+    CHECK_HRET(hret, yk_client_forward);
 
-    out.vsizes.sizes = nullptr;
-    out.vsizes.count = 0;
-    out.vals.data    = nullptr;
-    out.vals.size    = 0;
+    detach(&out);
 
     ret = static_cast<yk_return_t>(out.ret);
     hret = margo_free_output(handle, &out);
@@ -80,16 +82,19 @@ static yk_return_t yk_get_direct(yk_database_handle_t dbh,
  * A "packed" flag is used to indicate whether the server can copy values
  * back to back in the remaining M bytes, or if it should follow the value
  * sizes specified by the sender.
+ * If N is known by the sender (multi and packed variants), it is sent
+ * along with the RPC so the server can pull the sizes and keys at once.
  */
 
-extern "C" yk_return_t yk_get_bulk(yk_database_handle_t dbh,
-                                   int32_t mode,
-                                   size_t count,
-                                   const char* origin,
-                                   hg_bulk_t data,
-                                   size_t offset,
-                                   size_t size,
-                                   bool packed)
+static yk_return_t yk_get_bulk_sized(yk_database_handle_t dbh,
+                                     int32_t mode,
+                                     size_t count,
+                                     const char* origin,
+                                     hg_bulk_t data,
+                                     size_t offset,
+                                     size_t size,
+                                     bool packed,
+                                     size_t total_ksize)
 {
     if(count != 0 && size == 0)
         return YOKAN_ERR_INVALID_ARGS;
@@ -109,17 +114,15 @@ extern "C" yk_return_t yk_get_bulk(yk_database_handle_t dbh,
     in.offset = offset;
     in.size   = size;
     in.origin = const_cast<char*>(origin);
+    in.total_ksize = total_ksize;
     in.packed = packed;
 
     hret = margo_create(mid, dbh->addr, dbh->client->get_id, &handle);
     CHECK_HRET(hret, margo_create);
     DEFER(margo_destroy(handle));
 
-    hret = margo_provider_forward(dbh->provider_id, handle, &in);
-    CHECK_HRET(hret, margo_provider_forward);
-
-    hret = margo_get_output(handle, &out);
-    CHECK_HRET(hret, margo_get_output);
+    hret = yk_client_forward(dbh, handle, &in, &out);
+    CHECK_HRET(hret, yk_client_forward);
 
     ret = static_cast<yk_return_t>(out.ret);
     hret = margo_free_output(handle, &out);
@@ -128,6 +131,18 @@ extern "C" yk_return_t yk_get_bulk(yk_database_handle_t dbh,
     return ret;
 }
 
+extern "C" yk_return_t yk_get_bulk(yk_database_handle_t dbh,
+                                   int32_t mode,
+                                   size_t count,
+                                   const char* origin,
+                                   hg_bulk_t data,
+                                   size_t offset,
+                                   size_t size,
+                                   bool packed)
+{
+    return yk_get_bulk_sized(dbh, mode, count, origin, data, offset, size, packed, 0);
+}
+
 extern "C" yk_return_t yk_get(yk_database_handle_t dbh,
                               int32_t mode,
                               const void* key,
@@ -188,12 +203,15 @@ extern "C" yk_return_t yk_get_multi(yk_database_handle_t dbh,
 
     size_t total_size = std::accumulate(sizes.begin(), sizes.end(), (size_t)0);
 
-    hret = margo_bulk_create(mid, ptrs.size(), ptrs.data(), sizes.data(),
-                             HG_BULK_READWRITE, &bulk);
-    CHECK_HRET(hret, margo_bulk_create);
-    DEFER(margo_bulk_free(bulk));
+    hret = yk_client_bulk_create(dbh->client, ptrs.size(), ptrs.data(), sizes.data(),
+                                 HG_BULK_READWRITE,
+                                 {{0, false}, {1, true}}, &bulk);
+    CHECK_HRET(hret, yk_client_bulk_create);
+    DEFER(yk_client_bulk_free(dbh->client, bulk));
 
-    return yk_get_bulk(dbh, mode, count, nullptr, bulk, 0, total_size, false);
+    size_t total_ksize = std::accumulate(ksizes, ksizes+count, (size_t)0);
+
+    return yk_get_bulk_sized(dbh, mode, count, nullptr, bulk, 0, total_size, false, total_ksize);
 }
 
 extern "C" yk_return_t yk_get_packed(yk_database_handle_t dbh,
@@ -206,6 +224,7 @@ extern "C" yk_return_t yk_get_packed(yk_database_handle_t dbh,
                                      size_t* vsizes)
 {
     if(mode & YOKAN_MODE_NO_RDMA) {
+        dbh->num_eager.fetch_add(1, std::memory_order_relaxed);
         return yk_get_direct(dbh, mode, count, keys, ksizes, vbufsize, values, vsizes);
     }
 
@@ -231,12 +250,16 @@ extern "C" yk_return_t yk_get_packed(yk_database_handle_t dbh,
     if(sizes[2] == 0)
         return YOKAN_ERR_INVALID_ARGS;
 
+    if(yk_use_eager_protocol(dbh, mode, total_size))
+        return yk_get_direct(dbh, mode, count, keys, ksizes, vbufsize, values, vsizes);
+
     int seg_count = sizes[3] != 0 ? 4 : 3;
-    hret = margo_bulk_create(mid, seg_count, ptrs.data(), sizes.data(),
-                             HG_BULK_READWRITE, &bulk);
+    hret = yk_client_bulk_create(dbh->client, seg_count, ptrs.data(), sizes.data(),
+                                 HG_BULK_READWRITE,
+                                 {{0, false}, {1, true}}, &bulk);
 
-    CHECK_HRET(hret, margo_bulk_create);
-    DEFER(margo_bulk_free(bulk));
+    CHECK_HRET(hret, yk_client_bulk_create);
+    DEFER(yk_client_bulk_free(dbh->client, bulk));
 
-    return yk_get_bulk(dbh, mode, count, nullptr, bulk, 0, total_size, true);
+    return yk_get_bulk_sized(dbh, mode, count, nullptr, bulk, 0, total_size, true, sizes[2]);
 }
@@ -0,0 +1,39 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#include <cstring>
+#include "client.hpp"
+#include "../common/defer.hpp"
+#include "../common/types.h"
+#include "../common/logging.h"
+#include "../common/checks.h"
+
+extern "C" yk_return_t yk_get_stats(yk_database_handle_t dbh,
+                                    char** stats) {
+    if(!stats) return YOKAN_ERR_INVALID_ARGS;
+
+    margo_instance_id mid = dbh->client->mid;
+    yk_return_t ret = YOKAN_SUCCESS;
+    hg_return_t hret = HG_SUCCESS;
+    get_stats_out_t out;
+    hg_handle_t handle = HG_HANDLE_NULL;
+
+    out.stats = nullptr;
+
+    hret = margo_create(mid, dbh->addr, dbh->client->get_stats_id, &handle);
+    CHECK_HRET(hret, margo_create);
+    DEFER(margo_destroy(handle));
+
+    hret = yk_client_forward(dbh, handle, static_cast<void*>(nullptr), &out);
+    CHECK_HRET(hret, yk_client_forward);
+
+    ret = static_cast<yk_return_t>(out.ret);
+    if(ret == YOKAN_SUCCESS)
+        *stats = strdup(out.stats ? out.stats : "{}");
+    hret = margo_free_output(handle, &out);
+    CHECK_HRET(hret, margo_free_output);
+
+    return ret;
+}
@@ -75,11 +75,8 @@ yk_return_t yk_iter(yk_database_handle_t dbh,
     CHECK_HRET(hret, margo_create);
     DEFER(margo_destroy(handle));
 
-    hret = margo_provider_forward(dbh->provider_id, handle, &in);
-    CHECK_HRET(hret, margo_provider_forward);
-
-    hret = margo_get_output(handle, &out);
-    CHECK_HRET(hret, margo_get_output);
+    hret = yk_client_forward(dbh, handle, &in, &out);
+    CHECK_HRET(hret, yk_client_forward);
 
     ret = static_cast<yk_return_t>(out.ret);
     hret = margo_free_output(handle, &out);
@@ -183,6 +180,12 @@ void yk_iter_back_ult(hg_handle_t h)
     if(pool != ABT_POOL_NULL) {
         ABT_thread_join_many(ults.size(), ults.data());
         ABT_thread_free_many(ults.size(), ults.data());
+        for(auto& arg : args) {
+            if(arg.ret != YOKAN_SUCCESS) {
+                out.ret = arg.ret;
+                break;
+            }
+        }
     }
 }
 DEFINE_MARGO_RPC_HANDLER(yk_iter_back_ult)
@@ -262,6 +265,12 @@ void yk_iter_direct_back_ult(hg_handle_t h)
     if(pool != ABT_POOL_NULL) {
         ABT_thread_join_many(ults.size(), ults.data());
         ABT_thread_free_many(ults.size(), ults.data());
+        for(auto& arg : args) {
+            if(arg.ret != YOKAN_SUCCESS) {
+                out.ret = arg.ret;
+                break;
+            }
+        }
     }
 }
 DEFINE_MARGO_RPC_HANDLER(yk_iter_direct_back_ult)
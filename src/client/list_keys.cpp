@@ -5,6 +5,7 @@
  */
 #include <vector>
 #include <array>
+#include <cstring>
 #include <numeric>
 #include <iostream>
 #include "client.hpp"
@@ -56,16 +57,18 @@ static yk_return_t yk_list_keys_direct(yk_database_handle_t dbh,
     CHECK_HRET(hret, margo_create);
     DEFER(margo_destroy(handle));
 
-    hret = margo_provider_forward(dbh->provider_id, handle, &in);
-    CHECK_HRET(hret, margo_provider_forward);
+    // the output's buffers belong to the caller and must not be freed
+    auto detach = [](list_keys_direct_out_t* out) {
+        out->ksizes.sizes = nullptr;
+        out->ksizes.count = 0;
+        out->keys.data    = nullptr;
+        out->keys.size    = 0;
+    };
 
-    hret = margo_get_output(handle, &out);
-    CHECK_HRET(hret, margo_get_output);
+    hret = yk_client_forward(dbh, handle, &in, &out, detach);
+    CHECK_HRET(hret, yk_client_forward);
 
-    out.ksizes.sizes = nullptr;
-    out.ksizes.count = 0;
-    out.keys.data    = nullptr;
-    out.keys.size    = 0;
+    detach(&out);
 
     ret = static_cast<yk_return_t>(out.ret);
     hret = margo_free_output(handle, &out);
@@ -86,16 +89,18 @@ static yk_return_t yk_list_keys_direct(yk_database_handle_t dbh,
  * sizes specified by the sender.
  */
 
-extern "C" yk_return_t yk_list_keys_bulk(yk_database_handle_t dbh,
-                                           int32_t mode,
-                                           size_t from_ksize,
-                                           size_t filter_size,
-                                           const char* origin,
-                                           hg_bulk_t data,
-                                           size_t offset,
-                                           size_t keys_buf_size,
-                                           bool packed,
-                                           size_t count)
+static yk_return_t yk_list_keys_bulk_budgeted(yk_database_handle_t dbh,
+                                              int32_t mode,
+                                              size_t from_ksize,
+                                              size_t filter_size,
+                                              const char* origin,
+                                              hg_bulk_t data,
+                                              size_t offset,
+                                              size_t keys_buf_size,
+                                              bool packed,
+                                              size_t count,
+                                              const yk_scan_budget_t* budget,
+                                              yk_resume_token_t* token)
 {
     if(count == 0)
         return YOKAN_SUCCESS;
@@ -116,26 +121,54 @@ extern "C" yk_return_t yk_list_keys_bulk(yk_database_handle_t dbh,
     in.filter_size   = filter_size;
     in.offset        = offset;
     in.keys_buf_size = keys_buf_size;
+    in.max_examined  = budget ? budget->max_examined : 0;
+    in.max_time_us   = budget ? budget->max_time_us : 0;
     in.origin        = const_cast<char*>(origin);
     in.bulk          = data;
 
+    out.token.size = 0;
+    out.token.data = nullptr;
+
     hret = margo_create(mid, dbh->addr, dbh->client->list_keys_id, &handle);
     CHECK_HRET(hret, margo_create);
     DEFER(margo_destroy(handle));
 
-    hret = margo_provider_forward(dbh->provider_id, handle, &in);
-    CHECK_HRET(hret, margo_provider_forward);
-
-    hret = margo_get_output(handle, &out);
-    CHECK_HRET(hret, margo_get_output);
+    hret = yk_client_forward(dbh, handle, &in, &out);
+    CHECK_HRET(hret, yk_client_forward);
 
     ret = static_cast<yk_return_t>(out.ret);
+    if(token && ret == YOKAN_SUCCESS) {
+        token->size = 0;
+    } else if(token && ret == YOKAN_ERR_INCOMPLETE) {
+        if(out.token.size > token->capacity) {
+            ret = YOKAN_ERR_BUFFER_SIZE;
+        } else {
+            if(out.token.size) std::memcpy(token->data, out.token.data, out.token.size);
+            token->size = out.token.size;
+        }
+    }
     hret = margo_free_output(handle, &out);
     CHECK_HRET(hret, margo_free_output);
 
     return ret;
 }
 
+extern "C" yk_return_t yk_list_keys_bulk(yk_database_handle_t dbh,
+                                         int32_t mode,
+                                         size_t from_ksize,
+                                         size_t filter_size,
+                                         const char* origin,
+                                         hg_bulk_t data,
+                                         size_t offset,
+                                         size_t keys_buf_size,
+                                         bool packed,
+                                         size_t count)
+{
+    return yk_list_keys_bulk_budgeted(dbh, mode, from_ksize, filter_size, origin,
+            data, offset, keys_buf_size, packed, count,
+            nullptr, nullptr);
+}
+
 extern "C" yk_return_t yk_list_keys(yk_database_handle_t dbh,
                                       int32_t mode,
                                       const void* from_key,
@@ -193,17 +226,24 @@ extern "C" yk_return_t yk_list_keys(yk_database_handle_t dbh,
                               false, count);
 }
 
-extern "C" yk_return_t yk_list_keys_packed(yk_database_handle_t dbh,
-                                             int32_t mode,
-                                             const void* from_key,
-                                             size_t from_ksize,
-                                             const void* filter,
-                                             size_t filter_size,
-                                             size_t count,
-                                             void* keys,
-                                             size_t keys_buf_size,
-                                             size_t* ksizes)
+extern "C" yk_return_t yk_list_keys_packed_budgeted(yk_database_handle_t dbh,
+                                                    int32_t mode,
+                                                    const void* from_key,
+                                                    size_t from_ksize,
+                                                    const void* filter,
+                                                    size_t filter_size,
+                                                    size_t count,
+                                                    void* keys,
+                                                    size_t keys_buf_size,
+                                                    size_t* ksizes,
+                                                    const yk_scan_budget_t* budget,
+                                                    yk_resume_token_t* token)
 {
+    if(budget && (mode & YOKAN_MODE_NO_RDMA))
+        return YOKAN_ERR_OP_UNSUPPORTED;
+    if(token && token->data == nullptr && token->capacity > 0)
+        return YOKAN_ERR_INVALID_ARGS;
+
     if(mode & YOKAN_MODE_NO_RDMA)
         return yk_list_keys_direct(dbh, mode, from_key,
                 from_ksize, filter, filter_size, count,
@@ -215,6 +255,13 @@ extern "C" yk_return_t yk_list_keys_packed(yk_database_handle_t dbh,
     if(filter == nullptr && filter_size > 0)
         return YOKAN_ERR_INVALID_ARGS;
 
+    // a non-empty token replaces the start key
+    if(token && token->size) {
+        from_key   = token->data;
+        from_ksize = token->size;
+        mode      |= YOKAN_MODE_INCLUSIVE;
+    }
+
     hg_bulk_t bulk   = HG_BULK_NULL;
     hg_return_t hret = HG_SUCCESS;
     std::array<void*,4> ptrs;
@@ -246,7 +293,23 @@ extern "C" yk_return_t yk_list_keys_packed(yk_database_handle_t dbh,
     CHECK_HRET(hret, margo_bulk_create);
     DEFER(margo_bulk_free(bulk));
 
-    return yk_list_keys_bulk(dbh, mode, from_ksize, filter_size,
-                              nullptr, bulk, 0, keys_buf_size,
-                              true, count);
+    return yk_list_keys_bulk_budgeted(dbh, mode, from_ksize, filter_size,
+                                      nullptr, bulk, 0, keys_buf_size,
+                                      true, count, budget, token);
+}
+
+extern "C" yk_return_t yk_list_keys_packed(yk_database_handle_t dbh,
+                                           int32_t mode,
+                                           const void* from_key,
+                                           size_t from_ksize,
+                                           const void* filter,
+                                           size_t filter_size,
+                                           size_t count,
+                                           void* keys,
+                                           size_t keys_buf_size,
+                                           size_t* ksizes)
+{
+    return yk_list_keys_packed_budgeted(dbh, mode, from_key, from_ksize,
+            filter, filter_size, count, keys, keys_buf_size, ksizes,
+            nullptr, nullptr);
 }
@@ -52,11 +52,8 @@ static yk_return_t yk_put_direct(yk_database_handle_t dbh,
     CHECK_HRET(hret, margo_create);
     DEFER(margo_destroy(handle));
 
-    hret = margo_provider_forward(dbh->provider_id, handle, &in);
-    CHECK_HRET(hret, margo_provider_forward);
-
-    hret = margo_get_output(handle, &out);
-    CHECK_HRET(hret, margo_get_output);
+    hret = yk_client_forward(dbh, handle, &in, &out);
+    CHECK_HRET(hret, yk_client_forward);
 
     ret = static_cast<yk_return_t>(out.ret);
     hret = margo_free_output(handle, &out);
@@ -96,11 +93,8 @@ extern "C" yk_return_t yk_put_bulk(yk_database_handle_t dbh,
     CHECK_HRET(hret, margo_create);
     DEFER(margo_destroy(handle));
 
-    hret = margo_provider_forward(dbh->provider_id, handle, &in);
-    CHECK_HRET(hret, margo_provider_forward);
-
-    hret = margo_get_output(handle, &out);
-    CHECK_HRET(hret, margo_get_output);
+    hret = yk_client_forward(dbh, handle, &in, &out);
+    CHECK_HRET(hret, yk_client_forward);
 
     ret = static_cast<yk_return_t>(out.ret);
     hret = margo_free_output(handle, &out);
@@ -134,12 +128,16 @@ extern "C" yk_return_t yk_put_multi(yk_database_handle_t dbh,
     else if(!keys || !ksizes || !values || !vsizes)
         return YOKAN_ERR_INVALID_ARGS;
 
-    if(mode & YOKAN_MODE_NO_RDMA) {
+    size_t total_ksize = std::accumulate(ksizes, ksizes+count, (size_t)0);
+    size_t total_vsize = std::accumulate(vsizes, vsizes+count, (size_t)0);
+    size_t payload_size = 2*count*sizeof(size_t) + total_ksize + total_vsize;
+
+    if(yk_use_eager_protocol(dbh, mode, payload_size)) {
         if(count == 1) {
             return yk_put_direct(dbh, mode, count, keys[0], ksizes, values[0], vsizes);
         }
-        std::vector<char> packed_keys(std::accumulate(ksizes, ksizes+count, (size_t)0));
-        std::vector<char> packed_vals(std::accumulate(vsizes, vsizes+count, (size_t)0));
+        std::vector<char> packed_keys(total_ksize);
+        std::vector<char> packed_vals(total_vsize);
         size_t koffset = 0, voffset = 0;
         for(size_t i = 0; i < count; i++) {
             std::memcpy(packed_keys.data()+koffset, keys[i], ksizes[i]);
@@ -180,10 +178,11 @@ extern "C" yk_return_t yk_put_multi(yk_database_handle_t dbh,
 
     size_t total_size = std::accumulate(sizes.begin(), sizes.end(), (size_t)0);
 
-    hret = margo_bulk_create(mid, ptrs.size(), ptrs.data(), sizes.data(),
-                             HG_BULK_READ_ONLY, &bulk);
-    CHECK_HRET(hret, margo_bulk_create);
-    DEFER(margo_bulk_free(bulk));
+    hret = yk_client_bulk_create(dbh->client, ptrs.size(), ptrs.data(), sizes.data(),
+                                 HG_BULK_READ_ONLY,
+                                 {{0, false}, {1, false}}, &bulk);
+    CHECK_HRET(hret, yk_client_bulk_create);
+    DEFER(yk_client_bulk_free(dbh->client, bulk));
 
     return yk_put_bulk(dbh, mode, count, nullptr, bulk, 0, total_size);
 }
@@ -197,6 +196,7 @@ extern "C" yk_return_t yk_put_packed(yk_database_handle_t dbh,
                                        const size_t* vsizes)
 {
     if(mode & YOKAN_MODE_NO_RDMA) {
+        dbh->num_eager.fetch_add(1, std::memory_order_relaxed);
         return yk_put_direct(dbh, mode, count, keys, ksizes, values, vsizes);
     }
 
@@ -225,15 +225,20 @@ extern "C" yk_return_t yk_put_packed(yk_database_handle_t dbh,
     if(sizes[3] != 0 && values == nullptr)
         return YOKAN_ERR_INVALID_ARGS;
 
+    if(yk_use_eager_protocol(dbh, mode, total_size))
+        return yk_put_direct(dbh, mode, count, keys, ksizes, values, vsizes);
+
     if(sizes[3] != 0)
-        hret = margo_bulk_create(mid, 4, ptrs.data(), sizes.data(),
-                                 HG_BULK_READ_ONLY, &bulk);
+        hret = yk_client_bulk_create(dbh->client, 4, ptrs.data(), sizes.data(),
+                                     HG_BULK_READ_ONLY,
+                                     {{0, false}, {1, false}}, &bulk);
     else
-        hret = margo_bulk_create(mid, 3, ptrs.data(), sizes.data(),
-                                 HG_BULK_READ_ONLY, &bulk);
+        hret = yk_client_bulk_create(dbh->client, 3, ptrs.data(), sizes.data(),
+                                     HG_BULK_READ_ONLY,
+                                     {{0, false}, {1, false}}, &bulk);
 
-    CHECK_HRET(hret, margo_bulk_create);
-    DEFER(margo_bulk_free(bulk));
+    CHECK_HRET(hret, yk_client_bulk_create);
+    DEFER(yk_client_bulk_free(dbh->client, bulk));
 
     return yk_put_bulk(dbh, mode, count, nullptr, bulk, 0, total_size);
 }
@@ -0,0 +1,172 @@
+/*
+ * (C) The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#include "registration_cache.hpp"
+#include "../common/logging.h"
+#include <cstring>
+
+namespace yokan {
+
+RegistrationCache::RegistrationCache(margo_instance_id mid, size_t capacity)
+: m_mid(mid)
+, m_capacity(capacity) {
+    ABT_mutex_create(&m_mutex);
+}
+
+RegistrationCache::~RegistrationCache() {
+    clear();
+    ABT_mutex_free(&m_mutex);
+}
+
+hg_return_t RegistrationCache::create(uint32_t count, void** ptrs, const hg_size_t* sizes,
+                                      hg_uint8_t flags, const std::vector<Staged>& staged,
+                                      hg_bulk_t* bulk) {
+    Key key;
+    key.flags = flags;
+    key.segments.reserve(count);
+    for(uint32_t i = 0; i < count; i++)
+        key.segments.emplace_back(reinterpret_cast<uintptr_t>(ptrs[i]), sizes[i]);
+    for(auto& s : staged)
+        key.segments[s.index].first = 0;
+
+    ABT_mutex_spinlock(m_mutex);
+    bool enabled = m_capacity != 0;
+    auto it = m_entries.find(key);
+    bool found = it != m_entries.end();
+    if(found && !it->second.staging->in_use) {
+        // the cache keeps its own reference, the caller gets a new one
+        hg_return_t hret = HG_Bulk_ref_incr(it->second.bulk);
+        if(hret == HG_SUCCESS) {
+            m_lru.splice(m_lru.begin(), m_lru, it->second.lru_it);
+            _stage(*it->second.staging, ptrs, sizes, flags, staged);
+            *bulk = it->second.bulk;
+            m_in_use.emplace(*bulk, it->second.staging);
+        }
+        ABT_mutex_unlock(m_mutex);
+        return hret;
+    }
+    ABT_mutex_unlock(m_mutex);
+
+    // disabled, or the entry's staging buffer is used by another operation
+    if(!enabled || found)
+        return margo_bulk_create(m_mid, count, ptrs, sizes, flags, bulk);
+
+    auto staging = std::make_shared<Staging>();
+    size_t staged_size = 0;
+    for(auto& s : staged) {
+        staging->offsets.push_back(staged_size);
+        staged_size += sizes[s.index];
+    }
+    staging->buffer.resize(staged_size);
+    std::vector<void*> reg_ptrs(ptrs, ptrs + count);
+    for(size_t j = 0; j < staged.size(); j++)
+        reg_ptrs[staged[j].index] = staging->buffer.data() + staging->offsets[j];
+    _stage(*staging, ptrs, sizes, flags, staged);
+
+    hg_return_t hret = margo_bulk_create(m_mid, count, reg_ptrs.data(), sizes, flags, bulk);
+    if(hret != HG_SUCCESS)
+        return hret;
+
+    ABT_mutex_spinlock(m_mutex);
+    m_in_use.emplace(*bulk, staging);
+    if(m_capacity == 0 || m_entries.count(key)) {
+        // disabled in the meantime, or another ULT registered the same
+        // segments: the bulk handle is only used by this operation
+        ABT_mutex_unlock(m_mutex);
+        return HG_SUCCESS;
+    }
+    hret = HG_Bulk_ref_incr(*bulk);
+    if(hret != HG_SUCCESS) {
+        // not fatal, the caller can still use the bulk handle
+        ABT_mutex_unlock(m_mutex);
+        YOKAN_LOG_WARNING(m_mid, "HG_Bulk_ref_incr returned %d", hret);
+        return HG_SUCCESS;
+    }
+    auto p = m_entries.emplace(key, Entry{*bulk, m_lru.end(), staging});
+    m_lru.push_front(std::move(key));
+    p.first->second.lru_it = m_lru.begin();
+    while(m_entries.size() > m_capacity)
+        _erase(m_entries.find(m_lru.back()));
+    ABT_mutex_unlock(m_mutex);
+
+    return HG_SUCCESS;
+}
+
+void RegistrationCache::release(hg_bulk_t bulk) {
+    std::shared_ptr<Staging> staging;
+    ABT_mutex_spinlock(m_mutex);
+    auto it = m_in_use.find(bulk);
+    if(it != m_in_use.end()) {
+        staging = std::move(it->second);
+        m_in_use.erase(it);
+        for(auto& out : staging->outputs)
+            std::memcpy(out.ptr, staging->buffer.data() + out.offset, out.size);
+        staging->outputs.clear();
+        staging->in_use = false;
+    }
+    ABT_mutex_unlock(m_mutex);
+    // the staging buffer, if no longer cached, is only
+    // freed after the memory has been deregistered
+    margo_bulk_free(bulk);
+}
+
+void RegistrationCache::invalidate(const void* ptr, size_t size) {
+    auto start = reinterpret_cast<uintptr_t>(ptr);
+    auto end   = start + size;
+    ABT_mutex_spinlock(m_mutex);
+    for(auto it = m_entries.begin(); it != m_entries.end();) {
+        bool overlaps = false;
+        for(auto& seg : it->first.segments) {
+            if(seg.first == 0) continue; // staged
+            if(seg.first < end && start < seg.first + seg.second) {
+                overlaps = true;
+                break;
+            }
+        }
+        auto next = std::next(it);
+        if(overlaps) _erase(it);
+        it = next;
+    }
+    ABT_mutex_unlock(m_mutex);
+}
+
+void RegistrationCache::clear() {
+    ABT_mutex_spinlock(m_mutex);
+    while(!m_entries.empty())
+        _erase(m_entries.begin());
+    ABT_mutex_unlock(m_mutex);
+}
+
+void RegistrationCache::setCapacity(size_t capacity) {
+    ABT_mutex_spinlock(m_mutex);
+    m_capacity = capacity;
+    while(m_entries.size() > m_capacity)
+        _erase(m_entries.find(m_lru.back()));
+    ABT_mutex_unlock(m_mutex);
+}
+
+void RegistrationCache::_erase(map_t::iterator it) {
+    // bulk handles still used by an in-flight operation will only be
+    // freed when that operation releases them, and their staging
+    // buffer is kept alive by m_in_use until then
+    margo_bulk_free(it->second.bulk);
+    m_lru.erase(it->second.lru_it);
+    m_entries.erase(it);
+}
+
+void RegistrationCache::_stage(Staging& staging, void** ptrs, const hg_size_t* sizes,
+                               hg_uint8_t flags, const std::vector<Staged>& staged) {
+    staging.in_use = true;
+    staging.outputs.clear();
+    for(size_t j = 0; j < staged.size(); j++) {
+        auto& s = staged[j];
+        if(flags != HG_BULK_WRITE_ONLY)
+            std::memcpy(staging.buffer.data() + staging.offsets[j], ptrs[s.index], sizes[s.index]);
+        if(s.output)
+            staging.outputs.push_back(Output{ptrs[s.index], sizes[s.index], staging.offsets[j]});
+    }
+}
+
+}
@@ -0,0 +1,133 @@
+/*
+ * (C) The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#ifndef __YOKAN_REGISTRATION_CACHE_H
+#define __YOKAN_REGISTRATION_CACHE_H
+
+#include <margo.h>
+#include <cstdint>
+#include <vector>
+#include <utility>
+#include <map>
+#include <list>
+#include <memory>
+
+namespace yokan {
+
+/**
+ * @brief The RegistrationCache keeps the bulk handles created on
+ * user memory alive after the operation that created them completes,
+ * so that subsequent operations exposing exactly the same segments
+ * (same addresses, sizes, and access mode) can reuse them instead of
+ * registering the memory again. Entries are evicted in LRU order
+ * once the cache exceeds its capacity (in number of entries).
+ *
+ * Only the caller's data segments (keys, values) are cached. The
+ * per-call arrays of a bulk (key/value sizes, flags) are often
+ * temporaries or live on the stack, so they are never registered in
+ * place: each entry owns a staging buffer for them, registered along
+ * with the data segments, into which they are copied before the
+ * operation and from which outputs are copied back on release.
+ *
+ * Since the cache cannot know when the application frees its memory,
+ * the application is responsible for invalidating address ranges
+ * before releasing them (see yk_client_invalidate_registrations).
+ */
+class RegistrationCache {
+
+    public:
+
+    /**
+     * @brief Per-call segment of a bulk handle, to be staged.
+     */
+    struct Staged {
+        size_t index;  // index of the segment in the bulk handle
+        bool   output; // whether the server writes into the segment
+    };
+
+    RegistrationCache(margo_instance_id mid, size_t capacity);
+
+    ~RegistrationCache();
+
+    /**
+     * @brief Same semantics as margo_bulk_create, with the segments
+     * listed in staged being per-call arrays. The returned bulk handle
+     * must be released by the caller using release().
+     */
+    hg_return_t create(uint32_t count, void** ptrs, const hg_size_t* sizes,
+                       hg_uint8_t flags, const std::vector<Staged>& staged,
+                       hg_bulk_t* bulk);
+
+    /**
+     * @brief Copies the staged outputs of the bulk handle back into
+     * the caller's arrays, and frees the caller's reference to it.
+     */
+    void release(hg_bulk_t bulk);
+
+    /**
+     * @brief Remove all the entries that have at least one segment
+     * overlapping the [ptr, ptr+size) address range.
+     */
+    void invalidate(const void* ptr, size_t size);
+
+    /**
+     * @brief Remove all the entries.
+     */
+    void clear();
+
+    void setCapacity(size_t capacity);
+
+    private:
+
+    struct Key {
+        hg_uint8_t                               flags;
+        std::vector<std::pair<uintptr_t,size_t>> segments; // staged ones have address 0
+
+        bool operator<(const Key& other) const {
+            if(flags != other.flags) return flags < other.flags;
+            return segments < other.segments;
+        }
+    };
+
+    struct Output {
+        void*  ptr;    // caller's array
+        size_t size;
+        size_t offset; // offset of its copy in the staging buffer
+    };
+
+    struct Staging {
+        std::vector<char>   buffer;
+        std::vector<size_t> offsets; // offset of each staged segment in buffer
+        bool                in_use = false;
+        std::vector<Output> outputs; // set by the operation using the entry
+    };
+
+    using lru_t = std::list<Key>; // most recently used first
+
+    struct Entry {
+        hg_bulk_t                bulk;
+        lru_t::iterator          lru_it;
+        std::shared_ptr<Staging> staging;
+    };
+
+    using map_t = std::map<Key, Entry>;
+
+    void _erase(map_t::iterator it);
+
+    static void _stage(Staging& staging, void** ptrs, const hg_size_t* sizes,
+                       hg_uint8_t flags, const std::vector<Staged>& staged);
+
+    margo_instance_id m_mid;
+    size_t            m_capacity;
+    ABT_mutex         m_mutex;
+    map_t             m_entries;
+    lru_t             m_lru;
+    // staging buffers of the bulk handles currently used by an operation
+    std::map<hg_bulk_t, std::shared_ptr<Staging>> m_in_use;
+};
+
+}
+
+#endif
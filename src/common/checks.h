@@ -105,6 +105,9 @@ static constexpr int32_t incompatible_modes[][2] = {
     { YOKAN_MODE_SUFFIX, YOKAN_MODE_LUA_FILTER },
     { YOKAN_MODE_LIB_FILTER, YOKAN_MODE_SUFFIX },
     { YOKAN_MODE_LUA_FILTER, YOKAN_MODE_LIB_FILTER },
+    { YOKAN_MODE_JSON_FILTER, YOKAN_MODE_SUFFIX },
+    { YOKAN_MODE_JSON_FILTER, YOKAN_MODE_LUA_FILTER },
+    { YOKAN_MODE_JSON_FILTER, YOKAN_MODE_LIB_FILTER },
     { 0, 0 }};
 
 #define CHECK_MODE_VALID(__mode__) \
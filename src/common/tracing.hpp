@@ -0,0 +1,234 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#ifndef __YOKAN_TRACING_HPP
+#define __YOKAN_TRACING_HPP
+
+#include "yokan/common.h"
+#include <abt.h>
+#include <atomic>
+#include <array>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include <unistd.h>
+
+namespace yokan {
+
+/**
+ * @brief The Tracer collects the stages of sampled requests and writes them
+ * in the Chrome trace event format (chrome://tracing, ui.perfetto.dev).
+ * Each request is an async event named after its RPC, identified by its
+ * request ID, and containing one nested event per stage.
+ *
+ * Requests are identified by a 64-bit ID that the client sends in the
+ * RPC's input (0 when the client did not sample the request), so that
+ * the client's and the server's traces of a request can be matched.
+ * When disabled, tracing costs one relaxed atomic load per request.
+ */
+class Tracer {
+
+    public:
+
+    struct Span {
+        const char* name;
+        double      start; // us since epoch
+        double      duration; // us
+    };
+
+    static constexpr size_t MaxSpans = 16;
+
+    struct Request {
+        uint64_t                     id;
+        const char*                  category;
+        const char*                  name;
+        int                          tid;
+        size_t                       num_spans;
+        std::array<Span, MaxSpans>   spans;
+    };
+
+    Tracer() {
+        ABT_mutex_create(&m_mutex);
+    }
+
+    ~Tracer() {
+        ABT_mutex_free(&m_mutex);
+    }
+
+    Tracer(const Tracer&) = delete;
+    Tracer& operator=(const Tracer&) = delete;
+
+    /**
+     * @brief Enables (or disables) tracing. Requests sampled by the other
+     * side of the RPC are always traced when enabled; others are sampled
+     * with the given rate. At most max_requests requests are kept.
+     */
+    void configure(bool enabled, double sample_rate, size_t max_requests) {
+        ABT_mutex_lock(m_mutex);
+        m_max_requests = max_requests;
+        ABT_mutex_unlock(m_mutex);
+        m_sample_rate.store(sample_rate, std::memory_order_relaxed);
+        m_enabled.store(enabled, std::memory_order_relaxed);
+    }
+
+    bool enabled() const {
+        return m_enabled.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Returns a new request ID if the request should be sampled, 0 otherwise.
+     */
+    uint64_t sample() const {
+        double rate = m_sample_rate.load(std::memory_order_relaxed);
+        if(!enabled() || rate <= 0.0) return 0;
+        static thread_local std::mt19937_64 rng{std::random_device{}()};
+        if(rate < 1.0) {
+            std::uniform_real_distribution<double> dist(0.0, 1.0);
+            if(dist(rng) >= rate) return 0;
+        }
+        uint64_t id = 0;
+        while(id == 0) id = rng();
+        return id;
+    }
+
+    static double now() {
+        return std::chrono::duration<double, std::micro>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    void record(const Request& request) {
+        ABT_mutex_lock(m_mutex);
+        if(m_requests.size() < m_max_requests)
+            m_requests.push_back(request);
+        else
+            m_dropped += 1;
+        ABT_mutex_unlock(m_mutex);
+    }
+
+    /**
+     * @brief Writes the recorded requests to the given file
+     * and clears them. Returns false if the file cannot be written.
+     */
+    bool dump(const char* filename) {
+        FILE* file = fopen(filename, "w");
+        if(!file) return false;
+        std::vector<Request> requests;
+        size_t dropped;
+        ABT_mutex_lock(m_mutex);
+        requests.swap(m_requests);
+        dropped   = m_dropped;
+        m_dropped = 0;
+        ABT_mutex_unlock(m_mutex);
+
+        const int pid = (int)getpid();
+        fprintf(file, "{\"traceEvents\":[");
+        const char* sep = "\n";
+        auto event = [&](const Request& r, const char* name, char phase, double ts) {
+            fprintf(file, "%s{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"%c\","
+                          "\"id\":\"0x%016" PRIx64 "\",\"ts\":%.3f,\"pid\":%d,\"tid\":%d}",
+                    sep, name, r.category, phase, r.id, ts, pid, r.tid);
+            sep = ",\n";
+        };
+        for(auto& r : requests) {
+            if(r.num_spans == 0) continue;
+            auto& first = r.spans[0];
+            auto& last  = r.spans[r.num_spans-1];
+            event(r, r.name, 'b', first.start);
+            for(size_t i = 0; i < r.num_spans; i++) {
+                event(r, r.spans[i].name, 'b', r.spans[i].start);
+                event(r, r.spans[i].name, 'e', r.spans[i].start + r.spans[i].duration);
+            }
+            event(r, r.name, 'e', last.start + last.duration);
+        }
+        fprintf(file, "\n],\"displayTimeUnit\":\"ns\",\"otherData\":{\"dropped_requests\":%zu}}\n",
+                dropped);
+        return fclose(file) == 0;
+    }
+
+    private:
+
+    std::atomic<bool>    m_enabled{false};
+    std::atomic<double>  m_sample_rate{0.0};
+    size_t               m_max_requests = 0;
+    size_t               m_dropped      = 0;
+    std::vector<Request> m_requests;
+    ABT_mutex            m_mutex = ABT_MUTEX_NULL;
+};
+
+/**
+ * @brief Stages of a single request. begin() records the request's start
+ * if the tracer is enabled, sample() decides whether the request is kept,
+ * and each call to stage() closes the stage that started with the previous
+ * call. The request is recorded when the RequestTrace is destroyed, after
+ * a last stage named "respond" (the RequestTrace should therefore be
+ * declared before the handler's DEFER(margo_respond(...))).
+ * All of these calls are no-ops on requests that are not traced.
+ */
+class RequestTrace {
+
+    public:
+
+    RequestTrace() = default;
+
+    ~RequestTrace() {
+        if(!m_tracer) return;
+        if(m_final_stage) stage(m_final_stage);
+        m_tracer->record(m_request);
+    }
+
+    RequestTrace(const RequestTrace&) = delete;
+    RequestTrace& operator=(const RequestTrace&) = delete;
+
+    void begin(Tracer& tracer, const char* category, const char* name,
+               const char* final_stage = "respond") {
+        if(!tracer.enabled()) return;
+        m_tracer = &tracer;
+        m_request.category  = category;
+        m_request.name      = name;
+        m_request.num_spans = 0;
+        m_request.id        = 0;
+        m_request.tid       = 0;
+        ABT_self_get_xstream_rank(&m_request.tid);
+        m_final_stage       = final_stage;
+        m_last              = Tracer::now();
+    }
+
+    /**
+     * @brief Keeps the request if id is not 0 (the other side sampled
+     * it) or if the tracer samples it, otherwise stops tracing it.
+     * Returns the request's ID (0 if not traced).
+     */
+    uint64_t sample(uint64_t id) {
+        if(!m_tracer) return 0;
+        if(id == 0) id = m_tracer->sample();
+        if(id == 0) {
+            m_tracer = nullptr;
+            return 0;
+        }
+        m_request.id = id;
+        return id;
+    }
+
+    void stage(const char* name) {
+        if(!m_tracer) return;
+        double now = Tracer::now();
+        if(m_request.num_spans < Tracer::MaxSpans)
+            m_request.spans[m_request.num_spans++] = Tracer::Span{name, m_last, now - m_last};
+        m_last = now;
+    }
+
+    private:
+
+    Tracer*         m_tracer      = nullptr;
+    const char*     m_final_stage = nullptr;
+    double          m_last        = 0.0;
+    Tracer::Request m_request;
+};
+
+}
+
+#endif
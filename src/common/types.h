@@ -12,6 +12,15 @@
 #include <mercury_proc_string.h>
 #include "yokan/common.h"
 #include <stdlib.h>
+#include <string.h>
+
+// Statuses a provider responds with when its admission control refused
+// an RPC, which was therefore not executed. They are distinct from the
+// YOKAN_ERR_BUSY and YOKAN_ERR_TRY_AGAIN that operations may return after
+// doing some work, so that the client only forwards refused RPCs again.
+// The client reports them as YOKAN_ERR_BUSY and YOKAN_ERR_TRY_AGAIN.
+#define YOKAN_REFUSED_BUSY      (-1)
+#define YOKAN_REFUSED_TRY_AGAIN (-2)
 
 // LCOV_EXCL_START
 
@@ -44,7 +53,11 @@ typedef struct uint64_list {
     };
 } uint64_list;
 
+// yk_float64_t is used to send doubles, as their bit pattern.
+typedef double yk_float64_t;
+
 static inline hg_return_t hg_proc_yk_id_t(hg_proc_t proc, yk_id_t *id);
+static inline hg_return_t hg_proc_yk_float64_t(hg_proc_t proc, yk_float64_t* x);
 static inline hg_return_t hg_proc_uint64_list(hg_proc_t proc, uint64_list* list);
 static inline hg_return_t hg_proc_raw_data(hg_proc_t proc, raw_data* raw);
 
@@ -52,7 +65,8 @@ static inline hg_return_t hg_proc_raw_data(hg_proc_t proc, raw_data* raw);
 
 /* count */
 MERCURY_GEN_PROC(count_in_t,
-        ((int32_t)(mode)))
+        ((int32_t)(mode))\
+        ((uint64_t)(trace_id)))
 MERCURY_GEN_PROC(count_out_t,
         ((int32_t)(ret))\
         ((uint64_t)(count)))
@@ -63,8 +77,10 @@ MERCURY_GEN_PROC(exists_in_t,
         ((uint64_t)(count))\
         ((uint64_t)(offset))\
         ((uint64_t)(size))\
+        ((uint64_t)(total_ksize))\
         ((hg_string_t)(origin))\
-        ((hg_bulk_t)(bulk)))
+        ((hg_bulk_t)(bulk))\
+        ((uint64_t)(trace_id)))
 MERCURY_GEN_PROC(exists_out_t,
         ((int32_t)(ret)))
 
@@ -72,7 +88,8 @@ MERCURY_GEN_PROC(exists_out_t,
 MERCURY_GEN_PROC(exists_direct_in_t,
         ((int32_t)(mode))\
         ((raw_data)(keys))\
-        ((uint64_list)(sizes)))
+        ((uint64_list)(sizes))\
+        ((uint64_t)(trace_id)))
 MERCURY_GEN_PROC(exists_direct_out_t,
         ((raw_data)(flags))\
         ((int32_t)(ret)))
@@ -83,8 +100,10 @@ MERCURY_GEN_PROC(length_in_t,
         ((uint64_t)(count))\
         ((uint64_t)(offset))\
         ((uint64_t)(size))\
+        ((uint64_t)(total_ksize))\
         ((hg_string_t)(origin))\
-        ((hg_bulk_t)(bulk)))
+        ((hg_bulk_t)(bulk))\
+        ((uint64_t)(trace_id)))
 MERCURY_GEN_PROC(length_out_t,
         ((int32_t)(ret)))
 
@@ -92,7 +111,8 @@ MERCURY_GEN_PROC(length_out_t,
 MERCURY_GEN_PROC(length_direct_in_t,
         ((int32_t)(mode))\
         ((raw_data)(keys))\
-        ((uint64_list)(sizes)))
+        ((uint64_list)(sizes))\
+        ((uint64_t)(trace_id)))
 MERCURY_GEN_PROC(length_direct_out_t,
         ((uint64_list)(sizes))\
         ((int32_t)(ret)))
@@ -104,7 +124,8 @@ MERCURY_GEN_PROC(put_in_t,
         ((uint64_t)(offset))\
         ((uint64_t)(size))\
         ((hg_string_t)(origin))\
-        ((hg_bulk_t)(bulk)))
+        ((hg_bulk_t)(bulk))\
+        ((uint64_t)(trace_id)))
 MERCURY_GEN_PROC(put_out_t,
         ((int32_t)(ret)))
 
@@ -114,7 +135,8 @@ MERCURY_GEN_PROC(put_direct_in_t,
         ((uint64_list)(ksizes))\
         ((uint64_list)(vsizes))\
         ((raw_data)(keys))\
-        ((raw_data)(vals)))
+        ((raw_data)(vals))\
+        ((uint64_t)(trace_id)))
 MERCURY_GEN_PROC(put_direct_out_t,
         ((int32_t)(ret)))
 
@@ -124,9 +146,11 @@ MERCURY_GEN_PROC(get_in_t,
         ((uint64_t)(count))\
         ((uint64_t)(offset))\
         ((uint64_t)(size))\
+        ((uint64_t)(total_ksize))\
         ((hg_string_t)(origin))\
         ((hg_bool_t)(packed))\
-        ((hg_bulk_t)(bulk)))
+        ((hg_bulk_t)(bulk))\
+        ((uint64_t)(trace_id)))
 MERCURY_GEN_PROC(get_out_t,
         ((int32_t)(ret)))
 
@@ -135,7 +159,8 @@ MERCURY_GEN_PROC(get_direct_in_t,
         ((int32_t)(mode))\
         ((hg_size_t)(vbufsize))\
         ((uint64_list)(ksizes))\
-        ((raw_data)(keys)))
+        ((raw_data)(keys))\
+        ((uint64_t)(trace_id)))
 MERCURY_GEN_PROC(get_direct_out_t,
         ((uint64_list)(vsizes))\
         ((raw_data)(vals))\
@@ -150,7 +175,8 @@ MERCURY_GEN_PROC(fetch_in_t,
         ((uint64_t)(size))\
         ((hg_string_t)(origin))\
         ((hg_bulk_t)(bulk))\
-        ((uint64_t)(op_ref)))
+        ((uint64_t)(op_ref))\
+        ((uint64_t)(trace_id)))
 MERCURY_GEN_PROC(fetch_out_t,
         ((int32_t)(ret)))
 
@@ -160,7 +186,8 @@ MERCURY_GEN_PROC(fetch_direct_in_t,
         ((uint32_t)(batch_size))\
         ((uint64_list)(ksizes))\
         ((raw_data)(keys))\
-        ((uint64_t)(op_ref)))
+        ((uint64_t)(op_ref))\
+        ((uint64_t)(trace_id)))
 MERCURY_GEN_PROC(fetch_direct_out_t,
         ((int32_t)(ret)))
 
@@ -190,7 +217,8 @@ MERCURY_GEN_PROC(erase_in_t,
         ((uint64_t)(offset))\
         ((uint64_t)(size))\
         ((hg_string_t)(origin))\
-        ((hg_bulk_t)(bulk)))
+        ((hg_bulk_t)(bulk))\
+        ((uint64_t)(trace_id)))
 MERCURY_GEN_PROC(erase_out_t,
         ((int32_t)(ret)))
 
@@ -198,7 +226,8 @@ MERCURY_GEN_PROC(erase_out_t,
 MERCURY_GEN_PROC(erase_direct_in_t,
         ((int32_t)(mode))\
         ((uint64_list)(ksizes))\
-        ((raw_data)(keys)))
+        ((raw_data)(keys))\
+        ((uint64_t)(trace_id)))
 MERCURY_GEN_PROC(erase_direct_out_t,
         ((int32_t)(ret)))
 
@@ -211,10 +240,14 @@ MERCURY_GEN_PROC(list_keys_in_t,
         ((uint64_t)(filter_size))\
         ((uint64_t)(offset))\
         ((uint64_t)(keys_buf_size))\
+        ((uint64_t)(max_examined))\
+        ((uint64_t)(max_time_us))\
         ((hg_string_t)(origin))\
-        ((hg_bulk_t)(bulk)))
+        ((hg_bulk_t)(bulk))\
+        ((uint64_t)(trace_id)))
 MERCURY_GEN_PROC(list_keys_out_t,
-        ((int32_t)(ret)))
+        ((int32_t)(ret))\
+        ((raw_data)(token)))
 
 /* list_keys (direct) */
 MERCURY_GEN_PROC(list_keys_direct_in_t,
@@ -222,7 +255,8 @@ MERCURY_GEN_PROC(list_keys_direct_in_t,
         ((uint64_t)(count))\
         ((raw_data)(from_key))\
         ((raw_data)(filter))\
-        ((uint64_t)(keys_buf_size)))
+        ((uint64_t)(keys_buf_size))\
+        ((uint64_t)(trace_id)))
 MERCURY_GEN_PROC(list_keys_direct_out_t,
         ((int32_t)(ret))\
         ((uint64_list)(ksizes))\
@@ -238,10 +272,14 @@ MERCURY_GEN_PROC(list_keyvals_in_t,
         ((uint64_t)(offset))\
         ((uint64_t)(keys_buf_size))\
         ((uint64_t)(vals_buf_size))\
+        ((uint64_t)(max_examined))\
+        ((uint64_t)(max_time_us))\
         ((hg_string_t)(origin))\
-        ((hg_bulk_t)(bulk)))
+        ((hg_bulk_t)(bulk))\
+        ((uint64_t)(trace_id)))
 MERCURY_GEN_PROC(list_keyvals_out_t,
-        ((int32_t)(ret)))
+        ((int32_t)(ret))\
+        ((raw_data)(token)))
 
 /* list_keyvals (direct) */
 MERCURY_GEN_PROC(list_keyvals_direct_in_t,
@@ -250,7 +288,8 @@ MERCURY_GEN_PROC(list_keyvals_direct_in_t,
         ((raw_data)(from_key))\
         ((raw_data)(filter))\
         ((uint64_t)(keys_buf_size))\
-        ((uint64_t)(vals_buf_size)))
+        ((uint64_t)(vals_buf_size))\
+        ((uint64_t)(trace_id)))
 MERCURY_GEN_PROC(list_keyvals_direct_out_t,
         ((int32_t)(ret))\
         ((uint64_list)(ksizes))\
@@ -266,7 +305,8 @@ MERCURY_GEN_PROC(iter_in_t,
         ((uint64_t)(count))\
         ((raw_data)(from_key))\
         ((raw_data)(filter))\
-        ((uint64_t)(op_ref)))
+        ((uint64_t)(op_ref))\
+        ((uint64_t)(trace_id)))
 MERCURY_GEN_PROC(iter_out_t,
         ((int32_t)(ret)))
 
@@ -290,25 +330,82 @@ MERCURY_GEN_PROC(iter_direct_back_in_t,
 MERCURY_GEN_PROC(iter_direct_back_out_t,
         ((int32_t)(ret)))
 
+/* cursor_open */
+MERCURY_GEN_PROC(cursor_open_in_t,
+        ((int32_t)(mode))\
+        ((raw_data)(from_key))\
+        ((raw_data)(filter))\
+        ((uint64_t)(trace_id)))
+MERCURY_GEN_PROC(cursor_open_out_t,
+        ((int32_t)(ret))\
+        ((uint64_t)(cursor_id)))
+
+/* cursor_next */
+MERCURY_GEN_PROC(cursor_next_in_t,
+        ((uint64_t)(cursor_id))\
+        ((uint64_t)(count))\
+        ((hg_bool_t)(no_values))\
+        ((uint64_t)(offset))\
+        ((uint64_t)(keys_buf_size))\
+        ((uint64_t)(vals_buf_size))\
+        ((hg_string_t)(origin))\
+        ((hg_bulk_t)(bulk))\
+        ((uint64_t)(trace_id)))
+MERCURY_GEN_PROC(cursor_next_out_t,
+        ((int32_t)(ret))\
+        ((hg_bool_t)(done)))
+
+/* cursor_close */
+MERCURY_GEN_PROC(cursor_close_in_t,
+        ((uint64_t)(cursor_id))\
+        ((uint64_t)(trace_id)))
+MERCURY_GEN_PROC(cursor_close_out_t,
+        ((int32_t)(ret)))
+
+/* aggregate */
+MERCURY_GEN_PROC(aggregate_in_t,
+        ((int32_t)(mode))\
+        ((raw_data)(from_key))\
+        ((raw_data)(filter))\
+        ((int32_t)(field_type))\
+        ((hg_string_t)(field))\
+        ((uint64_t)(field_offset))\
+        ((yk_float64_t)(hist_min))\
+        ((yk_float64_t)(hist_max))\
+        ((uint64_t)(hist_bins))\
+        ((uint64_t)(trace_id)))
+MERCURY_GEN_PROC(aggregate_out_t,
+        ((int32_t)(ret))\
+        ((uint64_t)(count))\
+        ((uint64_t)(num_values))\
+        ((yk_float64_t)(sum))\
+        ((yk_float64_t)(min))\
+        ((yk_float64_t)(max))\
+        ((uint64_t)(hist_underflow))\
+        ((uint64_t)(hist_overflow))\
+        ((uint64_list)(hist)))
 
 /* coll_create */
 MERCURY_GEN_PROC(coll_create_in_t,
         ((int32_t)(mode))\
-        ((hg_string_t)(coll_name)))
+        ((hg_string_t)(coll_name))\
+        ((uint64_t)(trace_id)))
 MERCURY_GEN_PROC(coll_create_out_t,
         ((int32_t)(ret)))
 
 /* coll_drop */
 MERCURY_GEN_PROC(coll_drop_in_t,
         ((int32_t)(mode))\
-        ((hg_string_t)(coll_name)))
+        ((hg_string_t)(coll_name))\
+        ((uint64_t)(trace_id)))
 MERCURY_GEN_PROC(coll_drop_out_t,
         ((int32_t)(ret)))
 
 /* coll_exists */
 MERCURY_GEN_PROC(coll_exists_in_t,
         ((int32_t)(mode))\
-        ((hg_string_t)(coll_name)))
+        ((hg_string_t)(coll_name))\
+        ((uint64_t)(trace_id)))
 MERCURY_GEN_PROC(coll_exists_out_t,
         ((int32_t)(ret))\
         ((uint8_t)(exists)))
@@ -316,7 +413,8 @@ MERCURY_GEN_PROC(coll_exists_out_t,
 /* coll_last_id */
 MERCURY_GEN_PROC(coll_last_id_in_t,
         ((int32_t)(mode))\
-        ((hg_string_t)(coll_name)))
+        ((hg_string_t)(coll_name))\
+        ((uint64_t)(trace_id)))
 MERCURY_GEN_PROC(coll_last_id_out_t,
         ((int32_t)(ret))\
         ((yk_id_t)(last_id)))
@@ -324,7 +422,8 @@ MERCURY_GEN_PROC(coll_last_id_out_t,
 /* coll_size */
 MERCURY_GEN_PROC(coll_size_in_t,
         ((int32_t)(mode))\
-        ((hg_string_t)(coll_name)))
+        ((hg_string_t)(coll_name))\
+        ((uint64_t)(trace_id)))
 MERCURY_GEN_PROC(coll_size_out_t,
         ((int32_t)(ret))\
         ((uint64_t)(size)))
@@ -333,7 +432,8 @@ MERCURY_GEN_PROC(coll_size_out_t,
 MERCURY_GEN_PROC(doc_erase_in_t,
         ((int32_t)(mode))\
         ((hg_string_t)(coll_name))\
-        ((uint64_list)(ids)))
+        ((uint64_list)(ids))\
+        ((uint64_t)(trace_id)))
 MERCURY_GEN_PROC(doc_erase_out_t,
         ((int32_t)(ret)))
 
@@ -345,7 +445,8 @@ MERCURY_GEN_PROC(doc_store_in_t,
         ((uint64_t)(offset))\
         ((uint64_t)(size))\
         ((hg_string_t)(origin))\
-        ((hg_bulk_t)(bulk)))
+        ((hg_bulk_t)(bulk))\
+        ((uint64_t)(trace_id)))
 MERCURY_GEN_PROC(doc_store_out_t,
         ((int32_t)(ret))\
         ((uint64_list)(ids)))
@@ -355,7 +456,8 @@ MERCURY_GEN_PROC(doc_store_direct_in_t,
         ((int32_t)(mode))\
         ((hg_string_t)(coll_name))\
         ((uint64_list)(sizes))\
-        ((raw_data)(docs)))
+        ((raw_data)(docs))\
+        ((uint64_t)(trace_id)))
 MERCURY_GEN_PROC(doc_store_direct_out_t,
         ((int32_t)(ret))\
         ((uint64_list)(ids)))
@@ -368,7 +470,8 @@ MERCURY_GEN_PROC(doc_update_in_t,
         ((uint64_t)(offset))\
         ((uint64_t)(size))\
         ((hg_string_t)(origin))\
-        ((hg_bulk_t)(bulk)))
+        ((hg_bulk_t)(bulk))\
+        ((uint64_t)(trace_id)))
 MERCURY_GEN_PROC(doc_update_out_t,
         ((int32_t)(ret)))
 
@@ -378,7 +481,8 @@ MERCURY_GEN_PROC(doc_update_direct_in_t,
         ((hg_string_t)(coll_name))\
         ((uint64_list)(ids))\
         ((uint64_list)(sizes))\
-        ((raw_data)(docs)))
+        ((raw_data)(docs))\
+        ((uint64_t)(trace_id)))
 MERCURY_GEN_PROC(doc_update_direct_out_t,
         ((int32_t)(ret)))
 
@@ -387,11 +491,13 @@ MERCURY_GEN_PROC(doc_load_in_t,
         ((int32_t)(mode))\
         ((hg_string_t)(coll_name))\
         ((uint64_list)(ids))\
+        ((raw_data)(filter))\
         ((uint64_t)(offset))\
         ((uint64_t)(size))\
         ((hg_string_t)(origin))\
         ((hg_bulk_t)(bulk))\
-        ((hg_bool_t)(packed)))
+        ((hg_bool_t)(packed))\
+        ((uint64_t)(trace_id)))
 MERCURY_GEN_PROC(doc_load_out_t,
         ((int32_t)(ret)))
 
@@ -400,7 +506,9 @@ MERCURY_GEN_PROC(doc_load_direct_in_t,
         ((int32_t)(mode))\
         ((hg_string_t)(coll_name))\
         ((uint64_list)(ids))\
-        ((hg_size_t)(bufsize)))
+        ((raw_data)(filter))\
+        ((hg_size_t)(bufsize))\
+        ((uint64_t)(trace_id)))
 MERCURY_GEN_PROC(doc_load_direct_out_t,
         ((uint64_list)(sizes))\
         ((raw_data)(docs))\
@@ -412,7 +520,9 @@ MERCURY_GEN_PROC(doc_fetch_in_t,
         ((uint32_t)(batch_size))\
         ((hg_string_t)(coll_name))\
         ((uint64_list)(ids))\
-        ((uint64_t)(op_ref)))
+        ((raw_data)(filter))\
+        ((uint64_t)(op_ref))\
+        ((uint64_t)(trace_id)))
 MERCURY_GEN_PROC(doc_fetch_out_t,
         ((int32_t)(ret)))
 
@@ -437,7 +547,8 @@ MERCURY_GEN_PROC(doc_fetch_direct_back_in_t,
 MERCURY_GEN_PROC(doc_length_in_t,
         ((int32_t)(mode))\
         ((hg_string_t)(coll_name))\
-        ((uint64_list)(ids)))
+        ((uint64_list)(ids))\
+        ((uint64_t)(trace_id)))
 MERCURY_GEN_PROC(doc_length_out_t,
         ((uint64_list)(sizes))\
         ((int32_t)(ret)))
@@ -452,10 +563,14 @@ MERCURY_GEN_PROC(doc_list_in_t,
         ((uint64_t)(filter_size))\
         ((uint64_t)(offset))\
         ((uint64_t)(docs_buf_size))\
+        ((uint64_t)(max_examined))\
+        ((uint64_t)(max_time_us))\
         ((hg_string_t)(origin))\
-        ((hg_bulk_t)(bulk)))
+        ((hg_bulk_t)(bulk))\
+        ((uint64_t)(trace_id)))
 MERCURY_GEN_PROC(doc_list_out_t,
-        ((int32_t)(ret)))
+        ((int32_t)(ret))\
+        ((raw_data)(token)))
 
 /* doc_list (direct) */
 MERCURY_GEN_PROC(doc_list_direct_in_t,
@@ -464,7 +579,8 @@ MERCURY_GEN_PROC(doc_list_direct_in_t,
         ((yk_id_t)(from_id))\
         ((hg_string_t)(coll_name))\
         ((raw_data)(filter))\
-        ((hg_size_t)(bufsize)))
+        ((hg_size_t)(bufsize))\
+        ((uint64_t)(trace_id)))
 MERCURY_GEN_PROC(doc_list_direct_out_t,
         ((uint64_list)(ids))\
         ((uint64_list)(sizes))\
@@ -479,7 +595,8 @@ MERCURY_GEN_PROC(doc_iter_in_t,
         ((uint64_t)(count))\
         ((yk_id_t)(from_id))\
         ((raw_data)(filter))\
-        ((uint64_t)(op_ref)))
+        ((uint64_t)(op_ref))\
+        ((uint64_t)(trace_id)))
 MERCURY_GEN_PROC(doc_iter_out_t,
         ((int32_t)(ret)))
 
@@ -503,11 +620,91 @@ MERCURY_GEN_PROC(doc_iter_direct_back_in_t,
 MERCURY_GEN_PROC(doc_iter_direct_back_out_t,
         ((int32_t)(ret)))
 
+/* doc_aggregate */
+MERCURY_GEN_PROC(doc_aggregate_in_t,
+        ((int32_t)(mode))\
+        ((hg_string_t)(coll_name))\
+        ((yk_id_t)(from_id))\
+        ((raw_data)(filter))\
+        ((int32_t)(field_type))\
+        ((hg_string_t)(field))\
+        ((uint64_t)(field_offset))\
+        ((yk_float64_t)(hist_min))\
+        ((yk_float64_t)(hist_max))\
+        ((uint64_t)(hist_bins))\
+        ((uint64_t)(trace_id)))
+MERCURY_GEN_PROC(doc_aggregate_out_t,
+        ((int32_t)(ret))\
+        ((uint64_t)(count))\
+        ((uint64_t)(num_values))\
+        ((yk_float64_t)(sum))\
+        ((yk_float64_t)(min))\
+        ((yk_float64_t)(max))\
+        ((uint64_t)(hist_underflow))\
+        ((uint64_t)(hist_overflow))\
+        ((uint64_list)(hist)))
+
+/* coll_create_index */
+MERCURY_GEN_PROC(coll_create_index_in_t,
+        ((int32_t)(mode))\
+        ((hg_string_t)(coll_name))\
+        ((hg_string_t)(index_name))\
+        ((int32_t)(field_type))\
+        ((hg_string_t)(field))\
+        ((uint64_t)(field_offset))\
+        ((hg_string_t)(extractor))\
+        ((uint64_t)(trace_id)))
+MERCURY_GEN_PROC(coll_create_index_out_t,
+        ((int32_t)(ret)))
+
+/* coll_drop_index */
+MERCURY_GEN_PROC(coll_drop_index_in_t,
+        ((int32_t)(mode))\
+        ((hg_string_t)(coll_name))\
+        ((hg_string_t)(index_name))\
+        ((uint64_t)(trace_id)))
+MERCURY_GEN_PROC(coll_drop_index_out_t,
+        ((int32_t)(ret)))
+
+/* doc_query */
+MERCURY_GEN_PROC(doc_query_in_t,
+        ((int32_t)(mode))\
+        ((hg_string_t)(coll_name))\
+        ((hg_string_t)(index_name))\
+        ((raw_data)(lower))\
+        ((raw_data)(upper))\
+        ((raw_data)(position))\
+        ((uint64_t)(count))\
+        ((hg_bool_t)(load_docs))\
+        ((hg_size_t)(bufsize))\
+        ((uint64_t)(trace_id)))
+MERCURY_GEN_PROC(doc_query_out_t,
+        ((uint64_list)(ids))\
+        ((uint64_list)(sizes))\
+        ((raw_data)(docs))\
+        ((raw_data)(position))\
+        ((int32_t)(ret)))
+
+/* coll_reserve_ids */
+MERCURY_GEN_PROC(coll_reserve_ids_in_t,
+        ((int32_t)(mode))\
+        ((hg_string_t)(coll_name))\
+        ((uint64_t)(count))\
+        ((uint64_t)(trace_id)))
+MERCURY_GEN_PROC(coll_reserve_ids_out_t,
+        ((int32_t)(ret))\
+        ((yk_id_t)(first_id)))
+
 /* get_remi_provider_id */
 MERCURY_GEN_PROC(get_remi_provider_id_out_t,
         ((int32_t)(ret))\
         ((uint16_t)(provider_id)))
 
+/* get_stats */
+MERCURY_GEN_PROC(get_stats_out_t,
+        ((int32_t)(ret))\
+        ((hg_string_t)(stats)))
+
 /* Extra hand-coded serialization functions */
 
 static inline hg_return_t hg_proc_yk_id_t(
@@ -516,6 +713,18 @@ static inline hg_return_t hg_proc_yk_id_t(
     return hg_proc_uint64_t(proc, id);
 }
 
+static inline hg_return_t hg_proc_yk_float64_t(
+        hg_proc_t proc, yk_float64_t* x)
+{
+    hg_return_t ret;
+    uint64_t bits;
+    memcpy(&bits, x, sizeof(bits));
+    ret = hg_proc_uint64_t(proc, &bits);
+    if(ret == HG_SUCCESS && hg_proc_get_op(proc) == HG_DECODE)
+        memcpy(x, &bits, sizeof(bits));
+    return ret;
+}
+
 static inline hg_return_t hg_proc_uint64_list(hg_proc_t proc, uint64_list* in)
 {
     hg_return_t ret;
@@ -19,6 +19,7 @@ void yk_coll_create_ult(hg_handle_t h)
 
     out.ret = YOKAN_SUCCESS;
 
+    yokan::RequestTrace trace;
     DEFER(margo_destroy(h));
     DEFER(margo_respond(h, &out));
 
@@ -28,10 +29,14 @@ void yk_coll_create_ult(hg_handle_t h)
     const struct hg_info* info = margo_get_info(h);
     yk_provider_t provider = (yk_provider_t)margo_registered_data(mid, info->id);
     CHECK_PROVIDER(provider);
+    TRACK_RPC(provider, coll_create);
+    trace.begin(provider->tracer, "server", "coll_create");
 
     hret = margo_get_input(h, &in);
     CHECK_HRET_OUT(hret, margo_get_input);
     DEFER(margo_free_input(h, &in));
+    trace.sample(in.trace_id);
+    trace.stage("get_input");
 
     yk_database* database = provider->db;
     CHECK_DATABASE(database);
@@ -39,5 +44,6 @@ void yk_coll_create_ult(hg_handle_t h)
 
     out.ret = static_cast<yk_return_t>(
         database->collCreate(in.mode, in.coll_name));
+    trace.stage("backend");
 }
 DEFINE_MARGO_RPC_HANDLER(yk_coll_create_ult)
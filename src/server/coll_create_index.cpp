@@ -0,0 +1,55 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#include "yokan/server.h"
+#include "provider.hpp"
+#include "../common/types.h"
+#include "../common/defer.hpp"
+#include "../common/logging.h"
+#include "../common/checks.h"
+
+void yk_coll_create_index_ult(hg_handle_t h)
+{
+    hg_return_t hret;
+    coll_create_index_in_t in;
+    coll_create_index_out_t out;
+
+    out.ret = YOKAN_SUCCESS;
+
+    yokan::RequestTrace trace;
+    DEFER(margo_destroy(h));
+    DEFER(margo_respond(h, &out));
+
+    margo_instance_id mid = margo_hg_handle_get_instance(h);
+    CHECK_MID(mid, margo_hg_handle_get_instance);
+
+    const struct hg_info* info = margo_get_info(h);
+    yk_provider_t provider = (yk_provider_t)margo_registered_data(mid, info->id);
+    CHECK_PROVIDER(provider);
+    TRACK_RPC(provider, coll_create_index);
+    trace.begin(provider->tracer, "server", "coll_create_index");
+
+    hret = margo_get_input(h, &in);
+    CHECK_HRET_OUT(hret, margo_get_input);
+    DEFER(margo_free_input(h, &in));
+    trace.sample(in.trace_id);
+    trace.stage("get_input");
+
+    yk_database* database = provider->db;
+    CHECK_DATABASE(database);
+    CHECK_MODE_SUPPORTED(database, in.mode);
+
+    yokan::DocIndexSpec spec;
+    spec.name      = in.index_name ? in.index_name : "";
+    spec.type      = in.field_type;
+    spec.field     = in.field ? in.field : "";
+    spec.offset    = in.field_offset;
+    spec.extractor = in.extractor ? in.extractor : "";
+
+    out.ret = static_cast<yk_return_t>(
+        database->collCreateIndex(in.mode, in.coll_name, spec));
+    trace.stage("backend");
+}
+DEFINE_MARGO_RPC_HANDLER(yk_coll_create_index_ult)
@@ -0,0 +1,48 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#include "yokan/server.h"
+#include "provider.hpp"
+#include "../common/types.h"
+#include "../common/defer.hpp"
+#include "../common/logging.h"
+#include "../common/checks.h"
+
+void yk_coll_drop_index_ult(hg_handle_t h)
+{
+    hg_return_t hret;
+    coll_drop_index_in_t in;
+    coll_drop_index_out_t out;
+
+    out.ret = YOKAN_SUCCESS;
+
+    yokan::RequestTrace trace;
+    DEFER(margo_destroy(h));
+    DEFER(margo_respond(h, &out));
+
+    margo_instance_id mid = margo_hg_handle_get_instance(h);
+    CHECK_MID(mid, margo_hg_handle_get_instance);
+
+    const struct hg_info* info = margo_get_info(h);
+    yk_provider_t provider = (yk_provider_t)margo_registered_data(mid, info->id);
+    CHECK_PROVIDER(provider);
+    TRACK_RPC(provider, coll_drop_index);
+    trace.begin(provider->tracer, "server", "coll_drop_index");
+
+    hret = margo_get_input(h, &in);
+    CHECK_HRET_OUT(hret, margo_get_input);
+    DEFER(margo_free_input(h, &in));
+    trace.sample(in.trace_id);
+    trace.stage("get_input");
+
+    yk_database* database = provider->db;
+    CHECK_DATABASE(database);
+    CHECK_MODE_SUPPORTED(database, in.mode);
+
+    out.ret = static_cast<yk_return_t>(
+        database->collDropIndex(in.mode, in.coll_name, in.index_name));
+    trace.stage("backend");
+}
+DEFINE_MARGO_RPC_HANDLER(yk_coll_drop_index_ult)
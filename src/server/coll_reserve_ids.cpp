@@ -0,0 +1,56 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#include "yokan/server.h"
+#include "provider.hpp"
+#include "../common/types.h"
+#include "../common/defer.hpp"
+#include "../common/logging.h"
+#include "../common/checks.h"
+#include <numeric>
+
+void yk_coll_reserve_ids_ult(hg_handle_t h)
+{
+    hg_return_t hret;
+    coll_reserve_ids_in_t in;
+    coll_reserve_ids_out_t out;
+
+    out.ret = YOKAN_SUCCESS;
+
+    yokan::RequestTrace trace;
+    DEFER(margo_destroy(h));
+    DEFER(margo_respond(h, &out));
+
+    margo_instance_id mid = margo_hg_handle_get_instance(h);
+    CHECK_MID(mid, margo_hg_handle_get_instance);
+
+    const struct hg_info* info = margo_get_info(h);
+    yk_provider_t provider = (yk_provider_t)margo_registered_data(mid, info->id);
+    CHECK_PROVIDER(provider);
+    TRACK_RPC(provider, coll_reserve_ids);
+    trace.begin(provider->tracer, "server", "coll_reserve_ids");
+
+    hret = margo_get_input(h, &in);
+    CHECK_HRET_OUT(hret, margo_get_input);
+    DEFER(margo_free_input(h, &in));
+    trace.sample(in.trace_id);
+    trace.stage("get_input");
+
+    yk_database* database = provider->db;
+    CHECK_DATABASE(database);
+    CHECK_MODE_SUPPORTED(database, in.mode);
+
+    if(in.count == 0 || in.count > provider->max_reserved_ids) {
+        out.ret = YOKAN_ERR_INVALID_ARGS;
+        return;
+    }
+
+    yk_id_t first_id = 0;
+    out.ret = static_cast<yk_return_t>(
+        database->collReserveIDs(in.mode, in.coll_name, in.count, &first_id));
+    trace.stage("backend");
+    out.first_id = first_id;
+}
+DEFINE_MARGO_RPC_HANDLER(yk_coll_reserve_ids_ult)
@@ -0,0 +1,304 @@
+/*
+ * (C) 2021 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#include "yokan/server.h"
+#include "provider.hpp"
+#include "../common/types.h"
+#include "../common/defer.hpp"
+#include "../common/logging.h"
+#include "../common/checks.h"
+#include "../backends/util/key-copy.hpp"
+
+/**
+ * Remove the cursors whose lease has expired.
+ * Must be called with provider->cursors.mutex locked.
+ */
+static void remove_expired_cursors(yk_provider_t provider, double now)
+{
+    auto& table = provider->cursors.table;
+    for(auto it = table.begin(); it != table.end();) {
+        if(now - it->second->last_used > provider->cursors.lease_timeout) {
+            YOKAN_LOG_TRACE(provider->mid, "cursor %lu expired", it->first);
+            it = table.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+/**
+ * Find a cursor by id and renew its lease.
+ * Returns nullptr if the cursor does not exist or has expired.
+ */
+static std::shared_ptr<yk_cursor> find_cursor(yk_provider_t provider, uint64_t id)
+{
+    std::shared_ptr<yk_cursor> result;
+    double now = ABT_get_wtime();
+    ABT_mutex_spinlock(provider->cursors.mutex);
+    remove_expired_cursors(provider, now);
+    auto it = provider->cursors.table.find(id);
+    if(it != provider->cursors.table.end()) {
+        result = it->second;
+        result->last_used = now;
+    }
+    ABT_mutex_unlock(provider->cursors.mutex);
+    return result;
+}
+
+void yk_provider_clear_cursors(yk_provider_t provider)
+{
+    std::unordered_map<uint64_t, std::shared_ptr<yk_cursor>> table;
+    ABT_mutex_spinlock(provider->cursors.mutex);
+    table.swap(provider->cursors.table);
+    ABT_mutex_unlock(provider->cursors.mutex);
+    // in-flight cursor_next calls hold the cursor's mutex and may still
+    // hold a reference to it, so wait for them and destroy the backend
+    // cursor now rather than when the last reference goes away, which
+    // could be after the database is destroyed
+    for(auto& p : table) {
+        auto& cursor = p.second;
+        ABT_mutex_lock(cursor->mutex);
+        cursor->cursor.reset();
+        ABT_mutex_unlock(cursor->mutex);
+    }
+}
+
+void yk_cursor_open_ult(hg_handle_t h)
+{
+    hg_return_t hret;
+    cursor_open_in_t in;
+    cursor_open_out_t out;
+
+    std::memset(&in, 0, sizeof(in));
+    std::memset(&out, 0, sizeof(out));
+
+    yokan::RequestTrace trace;
+    DEFER(margo_destroy(h));
+    DEFER(margo_respond(h, &out));
+
+    margo_instance_id mid = margo_hg_handle_get_instance(h);
+    CHECK_MID(mid, margo_hg_handle_get_instance);
+
+    const struct hg_info* info = margo_get_info(h);
+    yk_provider_t provider = (yk_provider_t)margo_registered_data(mid, info->id);
+    CHECK_PROVIDER(provider);
+    TRACK_RPC(provider, cursor_open);
+    trace.begin(provider->tracer, "server", "cursor_open");
+
+    hret = margo_get_input(h, &in);
+    CHECK_HRET_OUT(hret, margo_get_input);
+    DEFER(margo_free_input(h, &in));
+    trace.sample(in.trace_id);
+    trace.stage("get_input");
+
+    yk_database* database = provider->db;
+    CHECK_DATABASE(database);
+    CHECK_MODE_SUPPORTED(database, in.mode);
+
+    // the filter may keep pointers to its data, so the cursor owns a copy
+    auto cursor = std::make_shared<yk_cursor>();
+    cursor->mode = in.mode;
+    cursor->filter_data.assign(in.filter.data, in.filter.size);
+
+    auto from_key    = yokan::UserMem{ in.from_key.data, in.from_key.size };
+    auto filter_umem = yokan::UserMem{ &cursor->filter_data[0], cursor->filter_data.size() };
+    cursor->filter   = yokan::FilterFactory::makeKeyValueFilter(mid, in.mode, filter_umem);
+
+    if(!cursor->filter) {
+        out.ret = YOKAN_ERR_INVALID_FILTER;
+        return;
+    }
+
+    out.ret = static_cast<yk_return_t>(
+            database->openCursor(in.mode, from_key, cursor->filter, cursor->cursor));
+    trace.stage("backend");
+    if(out.ret != YOKAN_SUCCESS)
+        return;
+
+    double now = ABT_get_wtime();
+    cursor->last_used = now;
+
+    ABT_mutex_spinlock(provider->cursors.mutex);
+    remove_expired_cursors(provider, now);
+    if(provider->cursors.table.size() >= provider->cursors.max_cursors) {
+        ABT_mutex_unlock(provider->cursors.mutex);
+        out.ret = YOKAN_ERR_BUSY;
+        return;
+    }
+    out.cursor_id = provider->cursors.next_id++;
+    provider->cursors.table.emplace(out.cursor_id, std::move(cursor));
+    ABT_mutex_unlock(provider->cursors.mutex);
+}
+DEFINE_MARGO_RPC_HANDLER(yk_cursor_open_ult)
+
+void yk_cursor_next_ult(hg_handle_t h)
+{
+    hg_return_t hret;
+    cursor_next_in_t in;
+    cursor_next_out_t out;
+    hg_addr_t origin_addr = HG_ADDR_NULL;
+
+    out.ret  = YOKAN_SUCCESS;
+    out.done = HG_FALSE;
+
+    yokan::RequestTrace trace;
+    DEFER(margo_destroy(h));
+    DEFER(margo_respond(h, &out));
+
+    margo_instance_id mid = margo_hg_handle_get_instance(h);
+    CHECK_MID(mid, margo_hg_handle_get_instance);
+
+    const struct hg_info* info = margo_get_info(h);
+    yk_provider_t provider = (yk_provider_t)margo_registered_data(mid, info->id);
+    CHECK_PROVIDER(provider);
+    TRACK_RPC(provider, cursor_next);
+    trace.begin(provider->tracer, "server", "cursor_next");
+
+    hret = margo_get_input(h, &in);
+    CHECK_HRET_OUT(hret, margo_get_input);
+    DEFER(margo_free_input(h, &in));
+    trace.sample(in.trace_id);
+    trace.stage("get_input");
+
+    if(in.origin) {
+        hret = margo_addr_lookup(mid, in.origin, &origin_addr);
+        CHECK_HRET_OUT(hret, margo_addr_lookup);
+    } else {
+        hret = margo_addr_dup(mid, info->addr, &origin_addr);
+        CHECK_HRET_OUT(hret, margo_addr_dup);
+    }
+    DEFER(margo_addr_free(mid, origin_addr));
+
+    yk_database* database = provider->db;
+    CHECK_DATABASE(database);
+    CHECK_ADMISSION(provider, in.keys_buf_size + in.vals_buf_size + 2*in.count*sizeof(size_t));
+
+    auto cursor = find_cursor(provider, in.cursor_id);
+    if(!cursor) {
+        out.ret = YOKAN_ERR_EXPIRED;
+        return;
+    }
+    ABT_mutex_lock(cursor->mutex);
+    DEFER(ABT_mutex_unlock(cursor->mutex));
+
+    // the cursor was discarded by yk_provider_clear_cursors while we waited
+    if(!cursor->cursor) {
+        out.ret = YOKAN_ERR_EXPIRED;
+        return;
+    }
+
+    if(in.count == 0)
+        return;
+
+    // layout: ksizes, vsizes (unless no_values), keys, vals (unless no_values)
+    const size_t sizes_size   = (in.no_values ? 1 : 2)*in.count*sizeof(size_t);
+    const size_t vals_size    = in.no_values ? 0 : in.vals_buf_size;
+    const size_t keys_offset  = sizes_size;
+    const size_t vals_offset  = keys_offset + in.keys_buf_size;
+    const size_t buffer_size  = vals_offset + vals_size;
+
+    yk_buffer_t buffer = provider->bulk_cache.get(
+        provider->bulk_cache_data, buffer_size, HG_BULK_READWRITE);
+    CHECK_BUFFER(buffer);
+    DEFER(provider->bulk_cache.release(provider->bulk_cache_data, buffer));
+
+    auto ptr    = buffer->data;
+    auto ksizes = reinterpret_cast<size_t*>(ptr);
+    auto vsizes = in.no_values ? nullptr : ksizes + in.count;
+    auto keys   = ptr + keys_offset;
+    auto vals   = ptr + vals_offset;
+
+    const auto& filter = cursor->filter;
+    size_t i          = 0;
+    size_t key_offset = 0;
+    size_t val_offset = 0;
+    bool   done       = false;
+
+    auto status = cursor->cursor->next(in.count, in.no_values,
+        [&](const yokan::UserMem& key, const yokan::UserMem& val) {
+            auto ksize = yokan::keyCopy(cursor->mode, i == in.count-1, filter,
+                                        keys + key_offset, in.keys_buf_size - key_offset,
+                                        key.data, key.size);
+            if(ksize == YOKAN_SIZE_TOO_SMALL)
+                return yokan::Status::SizeError;
+            size_t vsize = 0;
+            if(!in.no_values) {
+                vsize = filter->valCopy(vals + val_offset, vals_size - val_offset,
+                                        val.data, val.size);
+                if(vsize == YOKAN_SIZE_TOO_SMALL)
+                    return yokan::Status::SizeError;
+                vsizes[i] = vsize;
+            }
+            ksizes[i]   = ksize;
+            key_offset += ksize;
+            val_offset += vsize;
+            i += 1;
+            return yokan::Status::OK;
+        }, done);
+    trace.stage("backend");
+
+    // entries that did not fit will be returned by the next call
+    size_t marker = YOKAN_NO_MORE_KEYS;
+    if(status == yokan::Status::SizeError) {
+        marker = YOKAN_SIZE_TOO_SMALL;
+    } else if(status != yokan::Status::OK) {
+        out.ret = static_cast<yk_return_t>(status);
+        return;
+    }
+    for(; i < in.count; i++) {
+        ksizes[i] = marker;
+        if(vsizes) vsizes[i] = marker;
+    }
+    out.done = done;
+
+    hret = margo_bulk_transfer(mid, HG_BULK_PUSH, origin_addr,
+            in.bulk, in.offset, buffer->bulk, 0, sizes_size + key_offset);
+    CHECK_HRET_OUT(hret, margo_bulk_transfer);
+    trace.stage("bulk_push");
+
+    if(val_offset > 0) {
+        hret = margo_bulk_transfer(mid, HG_BULK_PUSH, origin_addr,
+                in.bulk, in.offset + vals_offset, buffer->bulk, vals_offset, val_offset);
+        CHECK_HRET_OUT(hret, margo_bulk_transfer);
+        trace.stage("bulk_push");
+    }
+}
+DEFINE_MARGO_RPC_HANDLER(yk_cursor_next_ult)
+
+void yk_cursor_close_ult(hg_handle_t h)
+{
+    hg_return_t hret;
+    cursor_close_in_t in;
+    cursor_close_out_t out;
+
+    out.ret = YOKAN_SUCCESS;
+
+    yokan::RequestTrace trace;
+    DEFER(margo_destroy(h));
+    DEFER(margo_respond(h, &out));
+
+    margo_instance_id mid = margo_hg_handle_get_instance(h);
+    CHECK_MID(mid, margo_hg_handle_get_instance);
+
+    const struct hg_info* info = margo_get_info(h);
+    yk_provider_t provider = (yk_provider_t)margo_registered_data(mid, info->id);
+    CHECK_PROVIDER(provider);
+    TRACK_RPC(provider, cursor_close);
+    trace.begin(provider->tracer, "server", "cursor_close");
+
+    hret = margo_get_input(h, &in);
+    CHECK_HRET_OUT(hret, margo_get_input);
+    DEFER(margo_free_input(h, &in));
+    trace.sample(in.trace_id);
+    trace.stage("get_input");
+
+    ABT_mutex_spinlock(provider->cursors.mutex);
+    auto erased = provider->cursors.table.erase(in.cursor_id);
+    ABT_mutex_unlock(provider->cursors.mutex);
+
+    if(erased == 0)
+        out.ret = YOKAN_ERR_EXPIRED;
+}
+DEFINE_MARGO_RPC_HANDLER(yk_cursor_close_ult)
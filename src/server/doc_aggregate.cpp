@@ -0,0 +1,83 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#include "yokan/server.h"
+#include "provider.hpp"
+#include "../common/types.h"
+#include "../common/defer.hpp"
+#include "../common/logging.h"
+#include "../common/checks.h"
+#include "util/aggregator.hpp"
+#include <memory>
+#include <stdexcept>
+
+void yk_doc_aggregate_ult(hg_handle_t h)
+{
+    hg_return_t hret;
+    doc_aggregate_in_t in;
+    doc_aggregate_out_t out;
+    // declared before the response is deferred, since out.hist points into it
+    std::unique_ptr<yokan::Aggregator> aggregator;
+
+    std::memset(&in, 0, sizeof(in));
+    std::memset(&out, 0, sizeof(out));
+    out.ret = YOKAN_SUCCESS;
+
+    yokan::RequestTrace trace;
+    DEFER(margo_destroy(h));
+    DEFER(margo_respond(h, &out));
+
+    margo_instance_id mid = margo_hg_handle_get_instance(h);
+    CHECK_MID(mid, margo_hg_handle_get_instance);
+
+    const struct hg_info* info = margo_get_info(h);
+    yk_provider_t provider = (yk_provider_t)margo_registered_data(mid, info->id);
+    CHECK_PROVIDER(provider);
+    TRACK_RPC(provider, doc_aggregate);
+    trace.begin(provider->tracer, "server", "doc_aggregate");
+
+    hret = margo_get_input(h, &in);
+    CHECK_HRET_OUT(hret, margo_get_input);
+    DEFER(margo_free_input(h, &in));
+    trace.sample(in.trace_id);
+    trace.stage("get_input");
+
+    yk_database* database = provider->db;
+    CHECK_DATABASE(database);
+    CHECK_MODE_SUPPORTED(database, in.mode);
+    CHECK_ADMISSION(provider, 0);
+
+    try {
+        aggregator = std::make_unique<yokan::Aggregator>(
+            in.field_type, in.field, in.field_offset,
+            in.hist_min, in.hist_max, in.hist_bins);
+    } catch(const std::invalid_argument& ex) {
+        YOKAN_LOG_ERROR(mid, "Invalid aggregation: %s", ex.what());
+        out.ret = YOKAN_ERR_INVALID_ARGS;
+        return;
+    }
+
+    auto filter_umem = yokan::UserMem{in.filter.data, in.filter.size };
+    auto filter      = yokan::FilterFactory::makeDocFilter(mid, in.mode, filter_umem);
+
+    if(!filter) {
+        out.ret = YOKAN_ERR_INVALID_FILTER;
+        return;
+    }
+
+    auto doc_iter_func = [&](yk_id_t id, const yokan::UserMem& doc) -> yokan::Status {
+        (void)id;
+        aggregator->add(doc.data, doc.size);
+        return yokan::Status::OK;
+    };
+
+    out.ret = static_cast<yk_return_t>(
+            database->docIter(in.coll_name, in.mode, 0, in.from_id, filter, doc_iter_func));
+    trace.stage("backend");
+
+    if(out.ret == YOKAN_SUCCESS)
+        aggregator->toOutput(out);
+}
+DEFINE_MARGO_RPC_HANDLER(yk_doc_aggregate_ult)
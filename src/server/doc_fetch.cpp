@@ -21,6 +21,7 @@ void yk_doc_fetch_ult(hg_handle_t h)
     std::memset(&in, 0, sizeof(in));
     out.ret = YOKAN_SUCCESS;
 
+    yokan::RequestTrace trace;
     DEFER(margo_destroy(h));
     DEFER(margo_respond(h, &out));
 
@@ -30,10 +31,14 @@ void yk_doc_fetch_ult(hg_handle_t h)
     const struct hg_info* info = margo_get_info(h);
     yk_provider_t provider = (yk_provider_t)margo_registered_data(mid, info->id);
     CHECK_PROVIDER(provider);
+    TRACK_RPC(provider, doc_fetch);
+    trace.begin(provider->tracer, "server", "doc_fetch");
 
     hret = margo_get_input(h, &in);
     CHECK_HRET_OUT(hret, margo_get_input);
     DEFER(margo_free_input(h, &in));
+    trace.sample(in.trace_id);
+    trace.stage("get_input");
 
     if(in.batch_size == 0)
         in.batch_size = in.ids.count;
@@ -43,6 +48,17 @@ void yk_doc_fetch_ult(hg_handle_t h)
     yk_database* database = provider->db;
     CHECK_DATABASE(database);
     CHECK_MODE_SUPPORTED(database, in.mode);
+    CHECK_ADMISSION(provider, in.ids.count*sizeof(yk_id_t));
+
+    std::shared_ptr<yokan::DocFilter> filter;
+    if(in.filter.size) {
+        auto filter_umem = yokan::UserMem{ in.filter.data, in.filter.size };
+        filter = yokan::FilterFactory::makeDocFilter(mid, in.mode, filter_umem);
+        if(!filter) {
+            out.ret = YOKAN_ERR_INVALID_FILTER;
+            return;
+        }
+    }
 
     bool direct = in.mode & YOKAN_MODE_NO_RDMA;
 
@@ -83,21 +99,32 @@ void yk_doc_fetch_ult(hg_handle_t h)
         std::vector<size_t> doc_sizes;
         doc_sizes.reserve(in.batch_size);
 
-        auto fetcher = [&docs, &doc_sizes](yk_id_t id, const yokan::UserMem& doc) -> yokan::Status {
-            (void)id;
-            doc_sizes.push_back(doc.size);
-            if(doc.size != YOKAN_KEY_NOT_FOUND) {
-                size_t current_size = docs.size();
-                if(docs.capacity() < current_size + doc.size)
-                    docs.reserve(docs.capacity()*2);
-                docs.resize(current_size + doc.size);
-                std::memcpy(docs.data() + current_size, doc.data, doc.size);
+        auto fetcher = [&docs, &doc_sizes, &filter, &in](yk_id_t id, const yokan::UserMem& doc) -> yokan::Status {
+            if(doc.size == YOKAN_KEY_NOT_FOUND
+            || (filter && !filter->check(in.coll_name, id, doc.data, doc.size))) {
+                doc_sizes.push_back(YOKAN_KEY_NOT_FOUND);
+                return yokan::Status::OK;
             }
+            // with a filter, doc_size is an upper bound of the filtered size
+            size_t doc_size = filter ?
+                filter->docSizeFrom(in.coll_name, doc.data, doc.size) : doc.size;
+            size_t current_size = docs.size();
+            if(docs.capacity() < current_size + doc_size)
+                docs.reserve(std::max(docs.capacity()*2, current_size + doc_size));
+            docs.resize(current_size + doc_size);
+            if(filter)
+                doc_size = filter->docCopy(in.coll_name, docs.data() + current_size,
+                                           doc_size, doc.data, doc.size);
+            else
+                std::memcpy(docs.data() + current_size, doc.data, doc_size);
+            doc_sizes.push_back(doc_size);
+            docs.resize(current_size + doc_size);
             return yokan::Status::OK;
         };
 
         out.ret = static_cast<yk_return_t>(
                 database->docFetch(in.coll_name, in.mode, ids, fetcher));
+        trace.stage("backend");
         if(out.ret != YOKAN_SUCCESS)
             break;
 
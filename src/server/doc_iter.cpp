@@ -21,6 +21,7 @@ void yk_doc_iter_ult(hg_handle_t h)
     std::memset(&in, 0, sizeof(in));
     out.ret = YOKAN_SUCCESS;
 
+    yokan::RequestTrace trace;
     DEFER(margo_destroy(h));
     DEFER(margo_respond(h, &out));
 
@@ -30,10 +31,14 @@ void yk_doc_iter_ult(hg_handle_t h)
     const struct hg_info* info = margo_get_info(h);
     yk_provider_t provider = (yk_provider_t)margo_registered_data(mid, info->id);
     CHECK_PROVIDER(provider);
+    TRACK_RPC(provider, doc_iter);
+    trace.begin(provider->tracer, "server", "doc_iter");
 
     hret = margo_get_input(h, &in);
     CHECK_HRET_OUT(hret, margo_get_input);
     DEFER(margo_free_input(h, &in));
+    trace.sample(in.trace_id);
+    trace.stage("get_input");
 
     if(in.batch_size == 0)
         in.batch_size = in.count;
@@ -41,6 +46,7 @@ void yk_doc_iter_ult(hg_handle_t h)
     yk_database* database = provider->db;
     CHECK_DATABASE(database);
     CHECK_MODE_SUPPORTED(database, in.mode);
+    CHECK_ADMISSION(provider, 0);
 
     struct previous_op {
         std::vector<yk_id_t> ids;
@@ -148,6 +154,7 @@ void yk_doc_iter_ult(hg_handle_t h)
 
     out.ret = static_cast<yk_return_t>(
         database->docIter(in.coll_name, in.mode, in.count, in.from_id, filter, doc_iter_func));
+    trace.stage("backend");
 
     if(out.ret == YOKAN_STOP_ITERATION)
         out.ret = YOKAN_SUCCESS;
@@ -168,6 +175,7 @@ void yk_doc_iter_direct_ult(hg_handle_t h)
     std::memset(&in, 0, sizeof(in));
     out.ret = YOKAN_SUCCESS;
 
+    yokan::RequestTrace trace;
     DEFER(margo_destroy(h));
     DEFER(margo_respond(h, &out));
 
@@ -177,10 +185,14 @@ void yk_doc_iter_direct_ult(hg_handle_t h)
     const struct hg_info* info = margo_get_info(h);
     yk_provider_t provider = (yk_provider_t)margo_registered_data(mid, info->id);
     CHECK_PROVIDER(provider);
+    TRACK_RPC(provider, doc_iter_direct);
+    trace.begin(provider->tracer, "server", "doc_iter_direct");
 
     hret = margo_get_input(h, &in);
     CHECK_HRET_OUT(hret, margo_get_input);
     DEFER(margo_free_input(h, &in));
+    trace.sample(in.trace_id);
+    trace.stage("get_input");
 
     if(in.batch_size == 0)
         in.batch_size = in.count;
@@ -188,6 +200,7 @@ void yk_doc_iter_direct_ult(hg_handle_t h)
     yk_database* database = provider->db;
     CHECK_DATABASE(database);
     CHECK_MODE_SUPPORTED(database, in.mode);
+    CHECK_ADMISSION(provider, 0);
 
     struct previous_op {
         hg_handle_t   handle = HG_HANDLE_NULL;
@@ -282,6 +295,7 @@ void yk_doc_iter_direct_ult(hg_handle_t h)
 
     out.ret = static_cast<yk_return_t>(
         database->docIter(in.coll_name, in.mode, in.count, in.from_id, filter, doc_iter_func));
+    trace.stage("backend");
 
     if(out.ret == YOKAN_STOP_ITERATION)
         out.ret = YOKAN_SUCCESS;
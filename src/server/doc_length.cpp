@@ -25,6 +25,7 @@ void yk_doc_length_ult(hg_handle_t h)
     out.sizes.sizes = NULL;
     out.sizes.count = 0;
 
+    yokan::RequestTrace trace;
     DEFER(margo_destroy(h));
     DEFER(margo_respond(h, &out));
 
@@ -34,20 +35,26 @@ void yk_doc_length_ult(hg_handle_t h)
     const struct hg_info* info = margo_get_info(h);
     yk_provider_t provider = (yk_provider_t)margo_registered_data(mid, info->id);
     CHECK_PROVIDER(provider);
+    TRACK_RPC(provider, doc_length);
+    trace.begin(provider->tracer, "server", "doc_length");
 
     hret = margo_get_input(h, &in);
     CHECK_HRET_OUT(hret, margo_get_input);
     DEFER(margo_free_input(h, &in));
+    trace.sample(in.trace_id);
+    trace.stage("get_input");
 
     yk_database* database = provider->db;
     CHECK_DATABASE(database);
     CHECK_MODE_SUPPORTED(database, in.mode);
+    CHECK_ADMISSION(provider, in.ids.count*sizeof(yk_id_t));
 
     yokan::BasicUserMem<yk_id_t> ids{ in.ids.ids, in.ids.count };
     sizes.resize(in.ids.count);
     yokan::BasicUserMem<size_t> sizes_umem{sizes};
     out.ret = static_cast<yk_return_t>(
         database->docSize(in.coll_name, in.mode, ids, sizes_umem));
+    trace.stage("backend");
     if(out.ret == YOKAN_SUCCESS) {
         out.sizes.sizes = sizes.data();
         out.sizes.count = sizes.size();
@@ -9,6 +9,7 @@
 #include "../common/defer.hpp"
 #include "../common/logging.h"
 #include "../common/checks.h"
+#include "util/scan_budget.hpp"
 #include <numeric>
 #include <iostream>
 
@@ -18,9 +19,13 @@ void yk_doc_list_ult(hg_handle_t h)
     doc_list_in_t in;
     doc_list_out_t out;
     hg_addr_t origin_addr = HG_ADDR_NULL;
+    yk_id_t resume_id = 0;
 
     out.ret = YOKAN_SUCCESS;
+    out.token.size = 0;
+    out.token.data = nullptr;
 
+    yokan::RequestTrace trace;
     DEFER(margo_destroy(h));
     DEFER(margo_respond(h, &out));
 
@@ -30,10 +35,14 @@ void yk_doc_list_ult(hg_handle_t h)
     const struct hg_info* info = margo_get_info(h);
     yk_provider_t provider = (yk_provider_t)margo_registered_data(mid, info->id);
     CHECK_PROVIDER(provider);
+    TRACK_RPC(provider, doc_list);
+    trace.begin(provider->tracer, "server", "doc_list");
 
     hret = margo_get_input(h, &in);
     CHECK_HRET_OUT(hret, margo_get_input);
     DEFER(margo_free_input(h, &in));
+    trace.sample(in.trace_id);
+    trace.stage("get_input");
 
     if(in.origin) {
         hret = margo_addr_lookup(mid, in.origin, &origin_addr);
@@ -47,6 +56,7 @@ void yk_doc_list_ult(hg_handle_t h)
     yk_database* database = provider->db;
     CHECK_DATABASE(database);
     CHECK_MODE_SUPPORTED(database, in.mode);
+    CHECK_ADMISSION(provider, in.filter_size + in.docs_buf_size + 2*in.count*sizeof(size_t));
 
     size_t buffer_size = in.filter_size
                        + in.count*sizeof(size_t)
@@ -70,6 +80,7 @@ void yk_doc_list_ult(hg_handle_t h)
         hret = margo_bulk_transfer(mid, HG_BULK_PULL, origin_addr,
                 in.bulk, in.offset, buffer->bulk, 0, size_to_transfer);
         CHECK_HRET_OUT(hret, margo_bulk_transfer);
+        trace.stage("bulk_pull");
     }
 
     // build buffer wrappers
@@ -91,14 +102,31 @@ void yk_doc_list_ult(hg_handle_t h)
         return;
     }
 
+    // documents are listed in id order in every backend,
+    // so the id of the first unexamined document is a valid resume point
+    yokan::ScanBudget budget{in.max_examined, in.max_time_us};
+    std::shared_ptr<yokan::BudgetedDocFilter> budgeted;
+    if(budget.enabled()) {
+        budgeted = std::make_shared<yokan::BudgetedDocFilter>(filter, budget);
+        filter = budgeted;
+    }
+
     out.ret = static_cast<yk_return_t>(
             database->docList(
                 in.coll_name,
                 in.mode, in.packed,
                 in.from_id, filter,
                 ids, docs, doc_sizes));
+    trace.stage("backend");
 
-    if(out.ret == YOKAN_SUCCESS) {
+    if(out.ret == YOKAN_SUCCESS && budgeted && budgeted->incomplete()) {
+        resume_id      = budgeted->resumeId();
+        out.token.data = reinterpret_cast<char*>(&resume_id);
+        out.token.size = sizeof(resume_id);
+        out.ret        = YOKAN_ERR_INCOMPLETE;
+    }
+
+    if(out.ret == YOKAN_SUCCESS || out.ret == YOKAN_ERR_INCOMPLETE) {
         size_to_transfer = in.count*sizeof(size_t)
                          + in.count*sizeof(yk_id_t)
                          + in.docs_buf_size;
@@ -106,6 +134,7 @@ void yk_doc_list_ult(hg_handle_t h)
                 in.bulk, in.offset + doc_sizes_offset,
                 buffer->bulk, doc_sizes_offset, size_to_transfer);
         CHECK_HRET_OUT(hret, margo_bulk_transfer);
+        trace.stage("bulk_push");
     }
 }
 DEFINE_MARGO_RPC_HANDLER(yk_doc_list_ult)
@@ -123,6 +152,7 @@ void yk_doc_list_direct_ult(hg_handle_t h)
     std::memset(&in, 0, sizeof(in));
     std::memset(&out, 0, sizeof(out));
 
+    yokan::RequestTrace trace;
     DEFER(margo_destroy(h));
     DEFER(margo_respond(h, &out));
 
@@ -132,14 +162,19 @@ void yk_doc_list_direct_ult(hg_handle_t h)
     const struct hg_info* info = margo_get_info(h);
     yk_provider_t provider = (yk_provider_t)margo_registered_data(mid, info->id);
     CHECK_PROVIDER(provider);
+    TRACK_RPC(provider, doc_list_direct);
+    trace.begin(provider->tracer, "server", "doc_list_direct");
 
     hret = margo_get_input(h, &in);
     CHECK_HRET_OUT(hret, margo_get_input);
     DEFER(margo_free_input(h, &in));
+    trace.sample(in.trace_id);
+    trace.stage("get_input");
 
     yk_database* database = provider->db;
     CHECK_DATABASE(database);
     CHECK_MODE_SUPPORTED(database, in.mode);
+    CHECK_ADMISSION(provider, in.bufsize);
 
     doc_sizes.resize(in.count);
     ids.resize(in.count);
@@ -162,6 +197,7 @@ void yk_doc_list_direct_ult(hg_handle_t h)
                 in.mode, true,
                 in.from_id, filter,
                 ids_umem, docs_umem, doc_sizes_umem));
+    trace.stage("backend");
 
     if(out.ret == YOKAN_SUCCESS) {
         out.ids.ids = ids.data();
@@ -11,6 +11,51 @@
 #include "../common/checks.h"
 #include <numeric>
 
+/* Loads documents like docLoad, but through docFetch so that the filter
+ * can be applied to each document: documents that do not pass its check
+ * are reported as not found, and the others are copied with its docCopy
+ * (e.g. a projection onto some of their fields). When not packed, sizes
+ * initially holds the space available for each document. */
+static yokan::Status doc_load_filtered(yk_database* database,
+                                       const char* collection,
+                                       int32_t mode, bool packed,
+                                       const yokan::BasicUserMem<yk_id_t>& ids,
+                                       const yokan::DocFilter& filter,
+                                       yokan::UserMem& docs,
+                                       yokan::BasicUserMem<size_t>& sizes)
+{
+    bool exists = false;
+    auto status = database->collExists(mode, collection, &exists);
+    if(status != yokan::Status::OK) return status;
+    if(!exists) return yokan::Status::NotFound;
+
+    size_t i = 0, offset = 0;
+    bool buf_too_small = false;
+    status = database->docFetch(collection, mode, ids,
+        [&](yk_id_t id, const yokan::UserMem& doc) -> yokan::Status {
+            size_t available = packed ? docs.size - offset : sizes[i];
+            size_t next      = packed ? offset : offset + sizes[i];
+            if(doc.size == YOKAN_KEY_NOT_FOUND
+            || !filter.check(collection, id, doc.data, doc.size)) {
+                sizes[i] = YOKAN_KEY_NOT_FOUND;
+            } else if(buf_too_small) {
+                sizes[i] = YOKAN_SIZE_TOO_SMALL;
+            } else {
+                sizes[i] = filter.docCopy(collection, docs.data + offset,
+                                          available, doc.data, doc.size);
+                if(sizes[i] == YOKAN_SIZE_TOO_SMALL)
+                    buf_too_small = packed;
+                else if(packed)
+                    next = offset + sizes[i];
+            }
+            offset = next;
+            i += 1;
+            return yokan::Status::OK;
+        });
+    if(packed) docs.size = offset;
+    return status;
+}
+
 void yk_doc_load_ult(hg_handle_t h)
 {
     hg_return_t hret;
@@ -20,9 +65,12 @@ void yk_doc_load_ult(hg_handle_t h)
 
     in.ids.ids = nullptr;
     in.ids.count = 0;
+    in.filter.data = nullptr;
+    in.filter.size = 0;
 
     out.ret = YOKAN_SUCCESS;
 
+    yokan::RequestTrace trace;
     DEFER(margo_destroy(h));
     DEFER(margo_respond(h, &out));
 
@@ -32,10 +80,14 @@ void yk_doc_load_ult(hg_handle_t h)
     const struct hg_info* info = margo_get_info(h);
     yk_provider_t provider = (yk_provider_t)margo_registered_data(mid, info->id);
     CHECK_PROVIDER(provider);
+    TRACK_RPC(provider, doc_load);
+    trace.begin(provider->tracer, "server", "doc_load");
 
     hret = margo_get_input(h, &in);
     CHECK_HRET_OUT(hret, margo_get_input);
     DEFER(margo_free_input(h, &in));
+    trace.sample(in.trace_id);
+    trace.stage("get_input");
 
     if(in.origin) {
         hret = margo_addr_lookup(mid, in.origin, &origin_addr);
@@ -49,6 +101,17 @@ void yk_doc_load_ult(hg_handle_t h)
     yk_database* database = provider->db;
     CHECK_DATABASE(database);
     CHECK_MODE_SUPPORTED(database, in.mode);
+    CHECK_ADMISSION(provider, in.size);
+
+    std::shared_ptr<yokan::DocFilter> filter;
+    if(in.filter.size) {
+        auto filter_umem = yokan::UserMem{ in.filter.data, in.filter.size };
+        filter = yokan::FilterFactory::makeDocFilter(mid, in.mode, filter_umem);
+        if(!filter) {
+            out.ret = YOKAN_ERR_INVALID_FILTER;
+            return;
+        }
+    }
 
     yk_buffer_t buffer = provider->bulk_cache.get(
         provider->bulk_cache_data, in.size, HG_BULK_READWRITE);
@@ -63,6 +126,7 @@ void yk_doc_load_ult(hg_handle_t h)
         hret = margo_bulk_transfer(mid, HG_BULK_PULL, origin_addr,
             in.bulk, in.offset, buffer->bulk, 0, docs_offset);
         CHECK_HRET_OUT(hret, margo_bulk_transfer);
+        trace.stage("bulk_pull");
     }
 
     yokan::BasicUserMem<yk_id_t> ids{ in.ids.ids, in.ids.count };
@@ -75,8 +139,14 @@ void yk_doc_load_ult(hg_handle_t h)
         in.size - docs_offset
     };
 
-    out.ret = static_cast<yk_return_t>(
-        database->docLoad(in.coll_name, in.mode, in.packed, ids, docs_umem, sizes_umem));
+    if(filter)
+        out.ret = static_cast<yk_return_t>(
+            doc_load_filtered(database, in.coll_name, in.mode, in.packed,
+                              ids, *filter, docs_umem, sizes_umem));
+    else
+        out.ret = static_cast<yk_return_t>(
+            database->docLoad(in.coll_name, in.mode, in.packed, ids, docs_umem, sizes_umem));
+    trace.stage("backend");
 
     if(out.ret == YOKAN_SUCCESS) {
         margo_request req = MARGO_REQUEST_NULL;
@@ -92,10 +162,12 @@ void yk_doc_load_ult(hg_handle_t h)
                 in.bulk, in.offset,
                 buffer->bulk, 0, count*sizeof(size_t));
         CHECK_HRET_OUT(hret, margo_bulk_transfer);
+        trace.stage("bulk_push");
 
         if(req != MARGO_REQUEST_NULL) {
             hret = margo_wait(req);
             CHECK_HRET_OUT(hret, margo_wait);
+            trace.stage("bulk_push");
         }
     }
 }
@@ -109,6 +181,8 @@ void yk_doc_load_direct_ult(hg_handle_t h)
 
     in.ids.ids = nullptr;
     in.ids.count = 0;
+    in.filter.data = nullptr;
+    in.filter.size = 0;
 
     out.ret = YOKAN_SUCCESS;
     out.sizes.sizes = nullptr;
@@ -119,6 +193,7 @@ void yk_doc_load_direct_ult(hg_handle_t h)
     std::vector<size_t> doc_sizes;
     std::vector<char> doc_data;
 
+    yokan::RequestTrace trace;
     DEFER(margo_destroy(h));
     DEFER(margo_respond(h, &out));
 
@@ -128,14 +203,29 @@ void yk_doc_load_direct_ult(hg_handle_t h)
     const struct hg_info* info = margo_get_info(h);
     yk_provider_t provider = (yk_provider_t)margo_registered_data(mid, info->id);
     CHECK_PROVIDER(provider);
+    TRACK_RPC(provider, doc_load_direct);
+    trace.begin(provider->tracer, "server", "doc_load_direct");
 
     hret = margo_get_input(h, &in);
     CHECK_HRET_OUT(hret, margo_get_input);
     DEFER(margo_free_input(h, &in));
+    trace.sample(in.trace_id);
+    trace.stage("get_input");
 
     yk_database* database = provider->db;
     CHECK_DATABASE(database);
     CHECK_MODE_SUPPORTED(database, in.mode);
+    CHECK_ADMISSION(provider, in.bufsize);
+
+    std::shared_ptr<yokan::DocFilter> filter;
+    if(in.filter.size) {
+        auto filter_umem = yokan::UserMem{ in.filter.data, in.filter.size };
+        filter = yokan::FilterFactory::makeDocFilter(mid, in.mode, filter_umem);
+        if(!filter) {
+            out.ret = YOKAN_ERR_INVALID_FILTER;
+            return;
+        }
+    }
 
     size_t count = in.ids.count;
     doc_sizes.resize(count);
@@ -148,8 +238,14 @@ void yk_doc_load_direct_ult(hg_handle_t h)
         doc_data.data(), doc_data.size()
     };
 
-    out.ret = static_cast<yk_return_t>(
-        database->docLoad(in.coll_name, in.mode, true, ids, docs_umem, sizes_umem));
+    if(filter)
+        out.ret = static_cast<yk_return_t>(
+            doc_load_filtered(database, in.coll_name, in.mode, true,
+                              ids, *filter, docs_umem, sizes_umem));
+    else
+        out.ret = static_cast<yk_return_t>(
+            database->docLoad(in.coll_name, in.mode, true, ids, docs_umem, sizes_umem));
+    trace.stage("backend");
 
     if(out.ret == YOKAN_SUCCESS) {
         out.sizes.sizes = doc_sizes.data();
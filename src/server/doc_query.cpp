@@ -0,0 +1,100 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#include "yokan/server.h"
+#include "provider.hpp"
+#include "../common/types.h"
+#include "../common/defer.hpp"
+#include "../common/logging.h"
+#include "../common/checks.h"
+#include <algorithm>
+#include <string>
+#include <vector>
+
+void yk_doc_query_ult(hg_handle_t h)
+{
+    hg_return_t hret;
+    doc_query_in_t in;
+    doc_query_out_t out;
+
+    std::vector<yk_id_t> ids;
+    std::vector<size_t>  doc_sizes;
+    std::vector<char>    docs;
+    std::string          position;
+
+    std::memset(&in, 0, sizeof(in));
+    std::memset(&out, 0, sizeof(out));
+
+    yokan::RequestTrace trace;
+    DEFER(margo_destroy(h));
+    DEFER(margo_respond(h, &out));
+
+    margo_instance_id mid = margo_hg_handle_get_instance(h);
+    CHECK_MID(mid, margo_hg_handle_get_instance);
+
+    const struct hg_info* info = margo_get_info(h);
+    yk_provider_t provider = (yk_provider_t)margo_registered_data(mid, info->id);
+    CHECK_PROVIDER(provider);
+    TRACK_RPC(provider, doc_query);
+    trace.begin(provider->tracer, "server", "doc_query");
+
+    hret = margo_get_input(h, &in);
+    CHECK_HRET_OUT(hret, margo_get_input);
+    DEFER(margo_free_input(h, &in));
+    trace.sample(in.trace_id);
+    trace.stage("get_input");
+
+    yk_database* database = provider->db;
+    CHECK_DATABASE(database);
+    CHECK_MODE_SUPPORTED(database, in.mode);
+    CHECK_ADMISSION(provider, in.load_docs ? in.bufsize : 0);
+
+    ids.resize(in.count);
+
+    // an empty bound means no bound
+    auto lower = yokan::UserMem{ in.lower.data, in.lower.size };
+    auto upper = yokan::UserMem{ in.upper.data, in.upper.size };
+    auto after = yokan::UserMem{ in.position.data, in.position.size };
+    auto ids_umem = yokan::BasicUserMem<yk_id_t>{ids};
+
+    out.ret = static_cast<yk_return_t>(
+            database->docQuery(
+                in.coll_name, in.mode, in.index_name,
+                lower.size ? &lower : nullptr,
+                upper.size ? &upper : nullptr,
+                after, ids_umem, position));
+    if(out.ret != YOKAN_SUCCESS) return;
+
+    out.ids.ids       = ids.data();
+    out.ids.count     = ids.size();
+    out.position.data = const_cast<char*>(position.data());
+    out.position.size = position.size();
+    if(!in.load_docs) {
+        trace.stage("backend");
+        return;
+    }
+
+    // the documents of the ids found are loaded back to back
+    auto found = static_cast<size_t>(
+        std::find(ids.begin(), ids.end(), YOKAN_NO_MORE_DOCS) - ids.begin());
+    doc_sizes.resize(in.count, YOKAN_NO_MORE_DOCS);
+    docs.resize(in.bufsize);
+    auto found_umem = yokan::BasicUserMem<yk_id_t>{ids.data(), found};
+    auto docs_umem  = yokan::UserMem{docs};
+    auto sizes_umem = yokan::BasicUserMem<size_t>{doc_sizes.data(), found};
+
+    out.ret = static_cast<yk_return_t>(
+            database->docLoad(in.coll_name, in.mode, true,
+                              found_umem, docs_umem, sizes_umem));
+    trace.stage("backend");
+
+    if(out.ret == YOKAN_SUCCESS) {
+        out.sizes.sizes = doc_sizes.data();
+        out.sizes.count = doc_sizes.size();
+        out.docs.data   = docs.data();
+        out.docs.size   = docs_umem.size;
+    }
+}
+DEFINE_MARGO_RPC_HANDLER(yk_doc_query_ult)
@@ -24,6 +24,7 @@ void yk_doc_store_ult(hg_handle_t h)
     out.ids.ids = nullptr;
     out.ids.count = 0;
 
+    yokan::RequestTrace trace;
     DEFER(margo_destroy(h));
     DEFER(margo_respond(h, &out));
 
@@ -33,10 +34,14 @@ void yk_doc_store_ult(hg_handle_t h)
     const struct hg_info* info = margo_get_info(h);
     yk_provider_t provider = (yk_provider_t)margo_registered_data(mid, info->id);
     CHECK_PROVIDER(provider);
+    TRACK_RPC(provider, doc_store);
+    trace.begin(provider->tracer, "server", "doc_store");
 
     hret = margo_get_input(h, &in);
     CHECK_HRET_OUT(hret, margo_get_input);
     DEFER(margo_free_input(h, &in));
+    trace.sample(in.trace_id);
+    trace.stage("get_input");
 
     if(in.origin) {
         hret = margo_addr_lookup(mid, in.origin, &origin_addr);
@@ -50,6 +55,7 @@ void yk_doc_store_ult(hg_handle_t h)
     yk_database* database = provider->db;
     CHECK_DATABASE(database);
     CHECK_MODE_SUPPORTED(database, in.mode);
+    CHECK_ADMISSION(provider, in.size);
 
     yk_buffer_t buffer = provider->bulk_cache.get(
         provider->bulk_cache_data, in.size, HG_BULK_READWRITE);
@@ -59,6 +65,7 @@ void yk_doc_store_ult(hg_handle_t h)
     hret = margo_bulk_transfer(mid, HG_BULK_PULL, origin_addr,
                                in.bulk, in.offset, buffer->bulk, 0, in.size);
     CHECK_HRET_OUT(hret, margo_bulk_transfer);
+    trace.stage("bulk_pull");
 
     auto ptr = buffer->data;
     auto sizes_umem = yokan::BasicUserMem<size_t>{
@@ -81,6 +88,7 @@ void yk_doc_store_ult(hg_handle_t h)
 
     out.ret = static_cast<yk_return_t>(
         database->docStore(in.coll_name, in.mode, docs_umem, sizes_umem, ids_umem));
+    trace.stage("backend");
 
     if(out.ret == YOKAN_SUCCESS) {
         out.ids.count = in.count;
@@ -105,6 +113,7 @@ void yk_doc_store_direct_ult(hg_handle_t h)
     out.ids.ids = nullptr;
     out.ids.count = 0;
 
+    yokan::RequestTrace trace;
     DEFER(margo_destroy(h));
     DEFER(margo_respond(h, &out));
 
@@ -114,16 +123,21 @@ void yk_doc_store_direct_ult(hg_handle_t h)
     const struct hg_info* info = margo_get_info(h);
     yk_provider_t provider = (yk_provider_t)margo_registered_data(mid, info->id);
     CHECK_PROVIDER(provider);
+    TRACK_RPC(provider, doc_store_direct);
+    trace.begin(provider->tracer, "server", "doc_store_direct");
 
     hret = margo_get_input(h, &in);
     CHECK_HRET_OUT(hret, margo_get_input);
     DEFER(margo_free_input(h, &in));
+    trace.sample(in.trace_id);
+    trace.stage("get_input");
 
     auto count = in.sizes.count;
 
     yk_database* database = provider->db;
     CHECK_DATABASE(database);
     CHECK_MODE_SUPPORTED(database, in.mode);
+    CHECK_ADMISSION(provider, in.docs.size);
 
     auto sizes_umem = yokan::BasicUserMem<size_t>{
         reinterpret_cast<size_t*>(in.sizes.sizes),
@@ -139,6 +153,7 @@ void yk_doc_store_direct_ult(hg_handle_t h)
 
     out.ret = static_cast<yk_return_t>(
         database->docStore(in.coll_name, in.mode, docs_umem, sizes_umem, ids_umem));
+    trace.stage("backend");
 
     if(out.ret == YOKAN_SUCCESS) {
         out.ids.count = count;
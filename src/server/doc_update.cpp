@@ -23,6 +23,7 @@ void yk_doc_update_ult(hg_handle_t h)
 
     out.ret = YOKAN_SUCCESS;
 
+    yokan::RequestTrace trace;
     DEFER(margo_destroy(h));
     DEFER(margo_respond(h, &out));
 
@@ -32,10 +33,14 @@ void yk_doc_update_ult(hg_handle_t h)
     const struct hg_info* info = margo_get_info(h);
     yk_provider_t provider = (yk_provider_t)margo_registered_data(mid, info->id);
     CHECK_PROVIDER(provider);
+    TRACK_RPC(provider, doc_update);
+    trace.begin(provider->tracer, "server", "doc_update");
 
     hret = margo_get_input(h, &in);
     CHECK_HRET_OUT(hret, margo_get_input);
     DEFER(margo_free_input(h, &in));
+    trace.sample(in.trace_id);
+    trace.stage("get_input");
 
     if(in.origin) {
         hret = margo_addr_lookup(mid, in.origin, &origin_addr);
@@ -54,10 +59,12 @@ void yk_doc_update_ult(hg_handle_t h)
     hret = margo_bulk_transfer(mid, HG_BULK_PULL, origin_addr,
                                in.bulk, in.offset, buffer->bulk, 0, in.size);
     CHECK_HRET_OUT(hret, margo_bulk_transfer);
+    trace.stage("bulk_pull");
 
     yk_database* database = provider->db;
     CHECK_DATABASE(database);
     CHECK_MODE_SUPPORTED(database, in.mode);
+    CHECK_ADMISSION(provider, in.size);
 
     auto ptr = buffer->data;
     auto sizes_umem = yokan::BasicUserMem<size_t>{
@@ -81,6 +88,7 @@ void yk_doc_update_ult(hg_handle_t h)
 
     out.ret = static_cast<yk_return_t>(
         database->docUpdate(in.coll_name, in.mode, ids_umem, docs_umem, sizes_umem));
+    trace.stage("backend");
 }
 DEFINE_MARGO_RPC_HANDLER(yk_doc_update_ult)
 
@@ -99,6 +107,7 @@ void yk_doc_update_direct_ult(hg_handle_t h)
 
     out.ret = YOKAN_SUCCESS;
 
+    yokan::RequestTrace trace;
     DEFER(margo_destroy(h));
     DEFER(margo_respond(h, &out));
 
@@ -108,14 +117,19 @@ void yk_doc_update_direct_ult(hg_handle_t h)
     const struct hg_info* info = margo_get_info(h);
     yk_provider_t provider = (yk_provider_t)margo_registered_data(mid, info->id);
     CHECK_PROVIDER(provider);
+    TRACK_RPC(provider, doc_update_direct);
+    trace.begin(provider->tracer, "server", "doc_update_direct");
 
     hret = margo_get_input(h, &in);
     CHECK_HRET_OUT(hret, margo_get_input);
     DEFER(margo_free_input(h, &in));
+    trace.sample(in.trace_id);
+    trace.stage("get_input");
 
     yk_database* database = provider->db;
     CHECK_DATABASE(database);
     CHECK_MODE_SUPPORTED(database, in.mode);
+    CHECK_ADMISSION(provider, in.docs.size);
 
     auto sizes_umem = yokan::BasicUserMem<size_t>{
         in.sizes.sizes,
@@ -132,5 +146,6 @@ void yk_doc_update_direct_ult(hg_handle_t h)
 
     out.ret = static_cast<yk_return_t>(
         database->docUpdate(in.coll_name, in.mode, ids_umem, docs_umem, sizes_umem));
+    trace.stage("backend");
 }
 DEFINE_MARGO_RPC_HANDLER(yk_doc_update_direct_ult)
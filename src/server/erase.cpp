@@ -20,6 +20,7 @@ void yk_erase_ult(hg_handle_t h)
 
     out.ret = YOKAN_SUCCESS;
 
+    yokan::RequestTrace trace;
     DEFER(margo_destroy(h));
     DEFER(margo_respond(h, &out));
 
@@ -29,10 +30,14 @@ void yk_erase_ult(hg_handle_t h)
     const struct hg_info* info = margo_get_info(h);
     yk_provider_t provider = (yk_provider_t)margo_registered_data(mid, info->id);
     CHECK_PROVIDER(provider);
+    TRACK_RPC(provider, erase);
+    trace.begin(provider->tracer, "server", "erase");
 
     hret = margo_get_input(h, &in);
     CHECK_HRET_OUT(hret, margo_get_input);
     DEFER(margo_free_input(h, &in));
+    trace.sample(in.trace_id);
+    trace.stage("get_input");
 
     if(in.origin) {
         hret = margo_addr_lookup(mid, in.origin, &origin_addr);
@@ -46,6 +51,7 @@ void yk_erase_ult(hg_handle_t h)
     yk_database* database = provider->db;
     CHECK_DATABASE(database);
     CHECK_MODE_SUPPORTED(database, in.mode);
+    CHECK_ADMISSION(provider, in.size);
 
     yk_buffer_t buffer = provider->bulk_cache.get(
             provider->bulk_cache_data, in.size, HG_BULK_WRITE_ONLY);
@@ -56,6 +62,7 @@ void yk_erase_ult(hg_handle_t h)
     hret = margo_bulk_transfer(mid, HG_BULK_PULL, origin_addr,
                                in.bulk, in.offset, buffer->bulk, 0, in.size);
     CHECK_HRET_OUT(hret, margo_bulk_transfer);
+    trace.stage("bulk_pull");
 
     auto ptr = buffer->data;
     auto ksizes = yokan::BasicUserMem<size_t>{
@@ -84,6 +91,7 @@ void yk_erase_ult(hg_handle_t h)
 
     out.ret = static_cast<yk_return_t>(
             database->erase(in.mode, keys, ksizes));
+    trace.stage("backend");
 }
 DEFINE_MARGO_RPC_HANDLER(yk_erase_ult)
 
@@ -99,6 +107,7 @@ void yk_erase_direct_ult(hg_handle_t h)
     in.keys.size = 0;
     out.ret = YOKAN_SUCCESS;
 
+    yokan::RequestTrace trace;
     DEFER(margo_destroy(h));
     DEFER(margo_respond(h, &out));
 
@@ -108,14 +117,19 @@ void yk_erase_direct_ult(hg_handle_t h)
     const struct hg_info* info = margo_get_info(h);
     yk_provider_t provider = (yk_provider_t)margo_registered_data(mid, info->id);
     CHECK_PROVIDER(provider);
+    TRACK_RPC(provider, erase_direct);
+    trace.begin(provider->tracer, "server", "erase_direct");
 
     hret = margo_get_input(h, &in);
     CHECK_HRET_OUT(hret, margo_get_input);
     DEFER(margo_free_input(h, &in));
+    trace.sample(in.trace_id);
+    trace.stage("get_input");
 
     yk_database* database = provider->db;
     CHECK_DATABASE(database);
     CHECK_MODE_SUPPORTED(database, in.mode);
+    CHECK_ADMISSION(provider, in.keys.size);
 
     auto ksizes = yokan::BasicUserMem<size_t>{
         in.ksizes.sizes,
@@ -136,5 +150,6 @@ void yk_erase_direct_ult(hg_handle_t h)
 
     out.ret = static_cast<yk_return_t>(
             database->erase(in.mode, keys, ksizes));
+    trace.stage("backend");
 }
 DEFINE_MARGO_RPC_HANDLER(yk_erase_direct_ult)
@@ -21,6 +21,7 @@ void yk_exists_ult(hg_handle_t h)
 
     out.ret = YOKAN_SUCCESS;
 
+    yokan::RequestTrace trace;
     DEFER(margo_destroy(h));
     DEFER(margo_respond(h, &out));
 
@@ -30,10 +31,14 @@ void yk_exists_ult(hg_handle_t h)
     const struct hg_info* info = margo_get_info(h);
     yk_provider_t provider = (yk_provider_t)margo_registered_data(mid, info->id);
     CHECK_PROVIDER(provider);
+    TRACK_RPC(provider, exists);
+    trace.begin(provider->tracer, "server", "exists");
 
     hret = margo_get_input(h, &in);
     CHECK_HRET_OUT(hret, margo_get_input);
     DEFER(margo_free_input(h, &in));
+    trace.sample(in.trace_id);
+    trace.stage("get_input");
 
     if(in.origin) {
         hret = margo_addr_lookup(mid, in.origin, &origin_addr);
@@ -47,6 +52,7 @@ void yk_exists_ult(hg_handle_t h)
     yk_database* database = provider->db;
     CHECK_DATABASE(database);
     CHECK_MODE_SUPPORTED(database, in.mode);
+    CHECK_ADMISSION(provider, in.size);
 
     yk_buffer_t buffer = provider->bulk_cache.get(
             provider->bulk_cache_data, in.size, HG_BULK_READWRITE);
@@ -60,9 +66,21 @@ void yk_exists_ult(hg_handle_t h)
     // transfer ksizes
     size_t sizes_to_transfer = in.count*sizeof(size_t);
 
+    // if the client told us the total key size, pull the sizes
+    // and the keys in a single transfer instead of two
+    const bool single_pull = in.total_ksize != 0;
+    if(single_pull) {
+        if(in.size < keys_offset + in.total_ksize) {
+            out.ret = YOKAN_ERR_INVALID_ARGS;
+            return;
+        }
+        sizes_to_transfer = keys_offset + in.total_ksize;
+    }
+
     hret = margo_bulk_transfer(mid, HG_BULK_PULL, origin_addr,
             in.bulk, in.offset, buffer->bulk, 0, sizes_to_transfer);
     CHECK_HRET_OUT(hret, margo_bulk_transfer);
+    trace.stage("bulk_pull");
 
     // build buffer wrappers for key sizes
     auto ptr = buffer->data;
@@ -92,11 +110,20 @@ void yk_exists_ult(hg_handle_t h)
         return;
     }
 
+    // check that the keys are consistent with the total provided by the client
+    if(single_pull && total_ksize != in.total_ksize) {
+        out.ret = YOKAN_ERR_INVALID_ARGS;
+        return;
+    }
+
     // transfer the actual keys from the client
-    hret = margo_bulk_transfer(mid, HG_BULK_PULL, origin_addr,
-            in.bulk, in.offset + keys_offset,
-            buffer->bulk, keys_offset, total_ksize);
-    CHECK_HRET_OUT(hret, margo_bulk_transfer);
+    if(!single_pull) {
+        hret = margo_bulk_transfer(mid, HG_BULK_PULL, origin_addr,
+                in.bulk, in.offset + keys_offset,
+                buffer->bulk, keys_offset, total_ksize);
+        CHECK_HRET_OUT(hret, margo_bulk_transfer);
+        trace.stage("bulk_pull");
+    }
 
     // create memory wrapper for keys
     auto keys = yokan::UserMem{ ptr + keys_offset, total_ksize };
@@ -110,6 +137,7 @@ void yk_exists_ult(hg_handle_t h)
 
     out.ret = static_cast<yk_return_t>(
             database->exists(in.mode, keys, ksizes, flags));
+    trace.stage("backend");
 
     if(out.ret == YOKAN_SUCCESS) {
         // transfer the bit field back the client
@@ -117,6 +145,7 @@ void yk_exists_ult(hg_handle_t h)
                 in.bulk, in.offset + flags_offset,
                 buffer->bulk, flags_offset, flags_size);
         CHECK_HRET_OUT(hret, margo_bulk_transfer);
+        trace.stage("bulk_push");
     }
 }
 DEFINE_MARGO_RPC_HANDLER(yk_exists_ult)
@@ -138,6 +167,7 @@ void yk_exists_direct_ult(hg_handle_t h)
     out.flags.data = nullptr;
     out.flags.size = 0;
 
+    yokan::RequestTrace trace;
     DEFER(margo_destroy(h));
     DEFER(margo_respond(h, &out));
 
@@ -147,14 +177,19 @@ void yk_exists_direct_ult(hg_handle_t h)
     const struct hg_info* info = margo_get_info(h);
     yk_provider_t provider = (yk_provider_t)margo_registered_data(mid, info->id);
     CHECK_PROVIDER(provider);
+    TRACK_RPC(provider, exists_direct);
+    trace.begin(provider->tracer, "server", "exists_direct");
 
     hret = margo_get_input(h, &in);
     CHECK_HRET_OUT(hret, margo_get_input);
     DEFER(margo_free_input(h, &in));
+    trace.sample(in.trace_id);
+    trace.stage("get_input");
 
     yk_database* database = provider->db;
     CHECK_DATABASE(database);
     CHECK_MODE_SUPPORTED(database, in.mode);
+    CHECK_ADMISSION(provider, in.keys.size);
 
     auto count = in.sizes.count;
     auto ksizes = yokan::BasicUserMem<size_t>{ in.sizes.sizes, count };
@@ -184,5 +219,6 @@ void yk_exists_direct_ult(hg_handle_t h)
 
     out.ret = static_cast<yk_return_t>(
             database->exists(in.mode, keys, ksizes, flags));
+    trace.stage("backend");
 }
 DEFINE_MARGO_RPC_HANDLER(yk_exists_direct_ult)
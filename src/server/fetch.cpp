@@ -9,6 +9,7 @@
 #include "../common/defer.hpp"
 #include "../common/logging.h"
 #include "../common/checks.h"
+#include "util/back_rpc_window.hpp"
 #include <numeric>
 #include <iostream>
 
@@ -22,6 +23,7 @@ void yk_fetch_ult(hg_handle_t h)
 
     out.ret = YOKAN_SUCCESS;
 
+    yokan::RequestTrace trace;
     DEFER(margo_destroy(h));
     DEFER(margo_respond(h, &out));
 
@@ -31,10 +33,14 @@ void yk_fetch_ult(hg_handle_t h)
     const struct hg_info* info = margo_get_info(h);
     yk_provider_t provider = (yk_provider_t)margo_registered_data(mid, info->id);
     CHECK_PROVIDER(provider);
+    TRACK_RPC(provider, fetch);
+    trace.begin(provider->tracer, "server", "fetch");
 
     hret = margo_get_input(h, &in);
     CHECK_HRET_OUT(hret, margo_get_input);
     DEFER(margo_free_input(h, &in));
+    trace.sample(in.trace_id);
+    trace.stage("get_input");
 
     if(in.batch_size == 0)
         in.batch_size = in.count;
@@ -53,6 +59,7 @@ void yk_fetch_ult(hg_handle_t h)
     yk_database* database = provider->db;
     CHECK_DATABASE(database);
     CHECK_MODE_SUPPORTED(database, in.mode);
+    CHECK_ADMISSION(provider, in.size);
 
     yk_buffer_t keys_buffer = provider->bulk_cache.get(
         provider->bulk_cache_data, in.size, HG_BULK_WRITE_ONLY);
@@ -67,6 +74,7 @@ void yk_fetch_ult(hg_handle_t h)
     hret = margo_bulk_transfer(mid, HG_BULK_PULL, origin_addr,
             in.bulk, in.offset, keys_buffer->bulk, 0, sizes_to_transfer);
     CHECK_HRET_OUT(hret, margo_bulk_transfer);
+    trace.stage("bulk_pull");
 
     // build buffer wrappers for key sizes
     auto ksizes_ptr  = reinterpret_cast<size_t*>(keys_buffer->data);
@@ -94,30 +102,12 @@ void yk_fetch_ult(hg_handle_t h)
             in.bulk, in.offset + keys_offset,
             keys_buffer->bulk, keys_offset, total_ksize);
     CHECK_HRET_OUT(hret, margo_bulk_transfer);
+    trace.stage("bulk_pull");
 
-    struct previous_op {
-        std::vector<char>   values;
-        std::vector<size_t> vsizes;
-        hg_handle_t         handle = HG_HANDLE_NULL;
-        hg_bulk_t           bulk   = HG_BULK_NULL;
-        margo_request       req    = MARGO_REQUEST_NULL;
-    };
-
-    previous_op previous;
-
-    auto wait_for_previous_rpc = [&previous, &mid]() -> yk_return_t {
-        hg_return_t hret = HG_SUCCESS;
-        DEFER(margo_destroy(previous.handle); previous.handle = HG_HANDLE_NULL;);
-        DEFER(margo_bulk_free(previous.bulk); previous.bulk = HG_BULK_NULL;);
-        if(previous.handle == HG_HANDLE_NULL) return YOKAN_SUCCESS;
-        hret = margo_wait(previous.req);
-        CHECK_HRET(hret, margo_wait);
-        fetch_back_out_t back_out;
-        hret = margo_get_output(previous.handle, &back_out);
-        CHECK_HRET(hret, margo_get_output);
-        DEFER(margo_free_output(previous.handle, &back_out));
-        return (yk_return_t)back_out.ret;
-    };
+    // values of in-flight batches, kept alive until the client pulled them
+    using batch_values = std::pair<std::vector<char>, std::vector<size_t>>;
+
+    yokan::BackRPCWindow<fetch_back_out_t> window{mid, provider->back_rpc_window};
 
     for(unsigned batch_index = 0; batch_index < num_batches; ++batch_index) {
 
@@ -152,6 +142,7 @@ void yk_fetch_ult(hg_handle_t h)
 
         out.ret = static_cast<yk_return_t>(
                 database->fetch(in.mode, keys, ksizes, fetcher));
+        trace.stage("backend");
         if(out.ret != YOKAN_SUCCESS)
             break;
 
@@ -172,7 +163,7 @@ void yk_fetch_ult(hg_handle_t h)
         back_in.size   = std::accumulate(values_sizes.begin(), values_sizes.end(), (size_t)0);
         back_in.bulk   = values_bulk;
 
-        out.ret = wait_for_previous_rpc();
+        out.ret = window.acquire();
         if(out.ret != YOKAN_SUCCESS)
             break;
 
@@ -188,13 +179,8 @@ void yk_fetch_ult(hg_handle_t h)
         hret = margo_iforward(back_handle, &back_in, &req);
         CHECK_HRET_OUT_GOTO(hret, margo_iforward, finish);
 
-        previous.values = std::move(values);
-        previous.vsizes = std::move(vsizes);
-        margo_ref_incr(back_handle);
-        previous.handle = back_handle;
-        margo_bulk_ref_incr(values_bulk);
-        previous.bulk   = values_bulk;
-        previous.req    = req;
+        window.push(back_handle, values_bulk, req,
+            std::make_shared<batch_values>(std::move(values), std::move(vsizes)));
 
         keys_offset += total_batch_ksize;
     }
@@ -203,7 +189,7 @@ void yk_fetch_ult(hg_handle_t h)
         out.ret = YOKAN_SUCCESS;
 
 finish:
-    auto ret = wait_for_previous_rpc();
+    auto ret = window.waitAll();
     if(out.ret == YOKAN_SUCCESS) out.ret = ret;
     return;
 }
@@ -220,6 +206,7 @@ void yk_fetch_direct_ult(hg_handle_t h)
 
     out.ret = YOKAN_SUCCESS;
 
+    yokan::RequestTrace trace;
     DEFER(margo_destroy(h));
     DEFER(margo_respond(h, &out));
 
@@ -229,10 +216,14 @@ void yk_fetch_direct_ult(hg_handle_t h)
     const struct hg_info* info = margo_get_info(h);
     yk_provider_t provider = (yk_provider_t)margo_registered_data(mid, info->id);
     CHECK_PROVIDER(provider);
+    TRACK_RPC(provider, fetch_direct);
+    trace.begin(provider->tracer, "server", "fetch_direct");
 
     hret = margo_get_input(h, &in);
     CHECK_HRET_OUT(hret, margo_get_input);
     DEFER(margo_free_input(h, &in));
+    trace.sample(in.trace_id);
+    trace.stage("get_input");
 
     if(in.batch_size == 0)
         in.batch_size = in.ksizes.count;
@@ -242,6 +233,7 @@ void yk_fetch_direct_ult(hg_handle_t h)
     yk_database* database = provider->db;
     CHECK_DATABASE(database);
     CHECK_MODE_SUPPORTED(database, in.mode);
+    CHECK_ADMISSION(provider, in.keys.size);
 
     auto count = in.ksizes.count;
 
@@ -256,25 +248,8 @@ void yk_fetch_direct_ult(hg_handle_t h)
         return;
     }
 
-    struct previous_op {
-        hg_handle_t   handle = HG_HANDLE_NULL;
-        margo_request req    = MARGO_REQUEST_NULL;
-    };
-
-    previous_op previous;
-
-    auto wait_for_previous_rpc = [&previous, &mid]() -> yk_return_t {
-        hg_return_t hret = HG_SUCCESS;
-        DEFER(margo_destroy(previous.handle); previous.handle = HG_HANDLE_NULL;);
-        if(previous.handle == HG_HANDLE_NULL) return YOKAN_SUCCESS;
-        hret = margo_wait(previous.req);
-        CHECK_HRET(hret, margo_wait);
-        fetch_direct_back_out_t back_out;
-        hret = margo_get_output(previous.handle, &back_out);
-        CHECK_HRET(hret, margo_get_output);
-        DEFER(margo_free_output(previous.handle, &back_out));
-        return (yk_return_t)back_out.ret;
-    };
+    // the values are serialized into the RPC, no need to keep them around
+    yokan::BackRPCWindow<fetch_direct_back_out_t> window{mid, provider->back_rpc_window};
 
     size_t keys_offset = 0;
 
@@ -311,6 +286,7 @@ void yk_fetch_direct_ult(hg_handle_t h)
 
         out.ret = static_cast<yk_return_t>(
                 database->fetch(in.mode, keys, ksizes, fetcher));
+        trace.stage("backend");
         if(out.ret != YOKAN_SUCCESS)
             break;
 
@@ -322,7 +298,7 @@ void yk_fetch_direct_ult(hg_handle_t h)
         back_in.vals.size    = values.size();
         back_in.vals.data    = values.data();
 
-        out.ret = wait_for_previous_rpc();
+        out.ret = window.acquire();
         if(out.ret != YOKAN_SUCCESS)
             break;
 
@@ -338,9 +314,7 @@ void yk_fetch_direct_ult(hg_handle_t h)
         hret = margo_iforward(back_handle, &back_in, &req);
         CHECK_HRET_OUT_GOTO(hret, margo_iforward, finish);
 
-        margo_ref_incr(back_handle);
-        previous.handle = back_handle;
-        previous.req    = req;
+        window.push(back_handle, HG_BULK_NULL, req);
 
         keys_offset += total_batch_ksize;
     }
@@ -349,7 +323,7 @@ void yk_fetch_direct_ult(hg_handle_t h)
         out.ret = YOKAN_SUCCESS;
 
 finish:
-    auto ret = wait_for_previous_rpc();
+    auto ret = window.waitAll();
     if(out.ret == YOKAN_SUCCESS) out.ret = ret;
     return;
 }
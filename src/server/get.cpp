@@ -9,8 +9,202 @@
 #include "../common/defer.hpp"
 #include "../common/logging.h"
 #include "../common/checks.h"
+#include "util/batch_split.hpp"
+#include <atomic>
 #include <numeric>
 
+/**
+ * Pushes the values and value sizes of segment [begin, end) of a split
+ * get batch back to the client. The values are the vals_size bytes at
+ * vals_offset in the buffer.
+ */
+static yk_return_t push_segment(margo_instance_id mid,
+                                const get_in_t& in,
+                                hg_addr_t origin_addr,
+                                yk_buffer_t buffer,
+                                size_t begin, size_t end,
+                                size_t vals_offset, size_t vals_size)
+{
+    hg_return_t hret;
+    const size_t vsizes_offset = in.count*sizeof(size_t);
+
+    margo_request req = MARGO_REQUEST_NULL;
+    if(vals_size != 0) {
+        hret = margo_bulk_itransfer(mid, HG_BULK_PUSH, origin_addr,
+                in.bulk, in.offset + vals_offset,
+                buffer->bulk, vals_offset, vals_size, &req);
+        CHECK_HRET(hret, margo_bulk_itransfer);
+    }
+
+    hret = margo_bulk_transfer(mid, HG_BULK_PUSH, origin_addr,
+            in.bulk, in.offset + vsizes_offset + begin*sizeof(size_t),
+            buffer->bulk, vsizes_offset + begin*sizeof(size_t),
+            (end - begin)*sizeof(size_t));
+    if(req != MARGO_REQUEST_NULL) margo_wait(req);
+    CHECK_HRET(hret, margo_bulk_transfer);
+    return YOKAN_SUCCESS;
+}
+
+/**
+ * Executes a non-packed get whose batch has been split into segments.
+ * Each segment pulls its keys, reads its values from the database, and
+ * pushes them back in its own ULT, so transfers of some segments overlap
+ * with the database accesses of others.
+ */
+static yk_return_t get_segments(margo_instance_id mid,
+                                yk_provider_t provider,
+                                const get_in_t& in,
+                                hg_addr_t origin_addr,
+                                yk_buffer_t buffer,
+                                const std::vector<size_t>& segments,
+                                bool pull_keys)
+{
+    const size_t vsizes_offset = in.count*sizeof(size_t);
+    const size_t keys_offset   = vsizes_offset * 2;
+    auto ksizes = reinterpret_cast<size_t*>(buffer->data);
+    auto vsizes = reinterpret_cast<size_t*>(buffer->data + vsizes_offset);
+    auto num_segments = segments.size() - 1;
+
+    // offsets of the keys and values of each segment in the buffer
+    std::vector<size_t> key_offsets(num_segments + 1);
+    std::vector<size_t> val_offsets(num_segments + 1);
+    key_offsets[0] = keys_offset;
+    val_offsets[0] = 0;
+    for(size_t s = 0; s < num_segments; s++) {
+        key_offsets[s+1] = std::accumulate(ksizes + segments[s], ksizes + segments[s+1],
+                                           key_offsets[s]);
+        val_offsets[s+1] = std::accumulate(vsizes + segments[s], vsizes + segments[s+1],
+                                           val_offsets[s]);
+    }
+    for(auto& offset : val_offsets) offset += key_offsets[num_segments];
+
+    return yokan::runSegments(provider->pools.read, num_segments,
+        [&](size_t s) -> yk_return_t {
+            const auto count    = segments[s+1] - segments[s];
+            const auto key_size = key_offsets[s+1] - key_offsets[s];
+            const auto val_size = val_offsets[s+1] - val_offsets[s];
+
+            if(pull_keys) {
+                hg_return_t hret = margo_bulk_transfer(mid, HG_BULK_PULL, origin_addr,
+                        in.bulk, in.offset + key_offsets[s],
+                        buffer->bulk, key_offsets[s], key_size);
+                CHECK_HRET(hret, margo_bulk_transfer);
+            }
+
+            auto keys = yokan::UserMem{ buffer->data + key_offsets[s], key_size };
+            auto vals = yokan::UserMem{ buffer->data + val_offsets[s], val_size };
+            auto seg_ksizes = yokan::BasicUserMem<size_t>{ ksizes + segments[s], count };
+            auto seg_vsizes = yokan::BasicUserMem<size_t>{ vsizes + segments[s], count };
+
+            auto ret = static_cast<yk_return_t>(
+                provider->db->get(in.mode, false, keys, seg_ksizes, vals, seg_vsizes));
+            if(ret != YOKAN_SUCCESS) return ret;
+
+            return push_segment(mid, in, origin_addr, buffer,
+                                segments[s], segments[s+1], val_offsets[s], val_size);
+        });
+}
+
+/**
+ * Executes a packed get whose batch has been split into segments. The
+ * keys must already have been pulled. The length of each value is first
+ * looked up in parallel, then values are laid out exactly as a serial
+ * packed get would do (back to back, and once a value does not fit, any
+ * subsequent present key is reported as too small), and finally each
+ * segment reads its values into place and pushes them in parallel.
+ *
+ * Returns false if this could not be done, either because the backend
+ * does not support length() or because a value changed size between the
+ * two steps, in which case the caller should fall back to a serial get.
+ */
+static bool get_segments_packed(margo_instance_id mid,
+                                yk_provider_t provider,
+                                const get_in_t& in,
+                                hg_addr_t origin_addr,
+                                yk_buffer_t buffer,
+                                const std::vector<size_t>& segments,
+                                size_t vals_offset,
+                                size_t vals_size,
+                                yk_return_t& ret)
+{
+    const size_t vsizes_offset = in.count*sizeof(size_t);
+    const size_t keys_offset   = vsizes_offset * 2;
+    auto ksizes = reinterpret_cast<size_t*>(buffer->data);
+    auto vsizes = reinterpret_cast<size_t*>(buffer->data + vsizes_offset);
+    auto num_segments = segments.size() - 1;
+    auto database = provider->db;
+
+    std::vector<size_t> key_offsets(num_segments + 1);
+    key_offsets[0] = keys_offset;
+    for(size_t s = 0; s < num_segments; s++)
+        key_offsets[s+1] = std::accumulate(ksizes + segments[s], ksizes + segments[s+1],
+                                           key_offsets[s]);
+
+    auto segment_keys = [&](size_t s) {
+        return yokan::UserMem{ buffer->data + key_offsets[s], key_offsets[s+1] - key_offsets[s] };
+    };
+    auto segment_ksizes = [&](size_t s) {
+        return yokan::BasicUserMem<size_t>{ ksizes + segments[s], segments[s+1] - segments[s] };
+    };
+
+    std::vector<size_t> lengths(in.count);
+    ret = yokan::runSegments(provider->pools.read, num_segments,
+        [&](size_t s) -> yk_return_t {
+            auto seg_lengths = yokan::BasicUserMem<size_t>{
+                lengths.data() + segments[s], segments[s+1] - segments[s] };
+            return static_cast<yk_return_t>(
+                database->length(in.mode, segment_keys(s), segment_ksizes(s), seg_lengths));
+        });
+    if(ret != YOKAN_SUCCESS) return false;
+
+    std::vector<size_t> val_offsets(num_segments + 1);
+    size_t used = 0;
+    bool   full = false;
+    for(size_t s = 0; s < num_segments; s++) {
+        val_offsets[s] = vals_offset + used;
+        for(size_t i = segments[s]; i < segments[s+1]; i++) {
+            if(lengths[i] != YOKAN_KEY_NOT_FOUND
+            && (full || lengths[i] > vals_size - used)) {
+                full = true;
+                lengths[i] = YOKAN_SIZE_TOO_SMALL;
+            }
+            if(lengths[i] == YOKAN_KEY_NOT_FOUND || lengths[i] == YOKAN_SIZE_TOO_SMALL) {
+                vsizes[i] = 0;
+            } else {
+                vsizes[i] = lengths[i];
+                used += lengths[i];
+            }
+        }
+    }
+    val_offsets[num_segments] = vals_offset + used;
+
+    std::atomic<bool> changed{false};
+    ret = yokan::runSegments(provider->pools.read, num_segments,
+        [&](size_t s) -> yk_return_t {
+            auto seg_ksizes = segment_ksizes(s);
+            auto seg_vsizes = yokan::BasicUserMem<size_t>{ vsizes + segments[s], seg_ksizes.size };
+            auto vals = yokan::UserMem{ buffer->data + val_offsets[s],
+                                        val_offsets[s+1] - val_offsets[s] };
+
+            auto ret = static_cast<yk_return_t>(
+                database->get(in.mode, false, segment_keys(s), seg_ksizes, vals, seg_vsizes));
+            if(ret != YOKAN_SUCCESS) return ret;
+
+            for(size_t i = segments[s]; i < segments[s+1]; i++) {
+                if(lengths[i] == YOKAN_SIZE_TOO_SMALL && vsizes[i] != YOKAN_KEY_NOT_FOUND) {
+                    vsizes[i] = YOKAN_SIZE_TOO_SMALL;
+                } else if(vsizes[i] != lengths[i]) {
+                    changed = true;
+                    return YOKAN_SUCCESS;
+                }
+            }
+
+            return push_segment(mid, in, origin_addr, buffer,
+                                segments[s], segments[s+1], vals.data - buffer->data, vals.size);
+        });
+    return ret != YOKAN_SUCCESS || !changed;
+}
+
 void yk_get_ult(hg_handle_t h)
 {
     hg_return_t hret;
@@ -20,6 +214,7 @@ void yk_get_ult(hg_handle_t h)
 
     out.ret = YOKAN_SUCCESS;
 
+    yokan::RequestTrace trace;
     DEFER(margo_destroy(h));
     DEFER(margo_respond(h, &out));
 
@@ -29,10 +224,14 @@ void yk_get_ult(hg_handle_t h)
     const struct hg_info* info = margo_get_info(h);
     yk_provider_t provider = (yk_provider_t)margo_registered_data(mid, info->id);
     CHECK_PROVIDER(provider);
+    TRACK_RPC(provider, get);
+    trace.begin(provider->tracer, "server", "get");
 
     hret = margo_get_input(h, &in);
     CHECK_HRET_OUT(hret, margo_get_input);
     DEFER(margo_free_input(h, &in));
+    trace.sample(in.trace_id);
+    trace.stage("get_input");
 
     if(in.origin) {
         hret = margo_addr_lookup(mid, in.origin, &origin_addr);
@@ -46,6 +245,7 @@ void yk_get_ult(hg_handle_t h)
     yk_database* database = provider->db;
     CHECK_DATABASE(database);
     CHECK_MODE_SUPPORTED(database, in.mode);
+    CHECK_ADMISSION(provider, in.size);
 
     yk_buffer_t buffer = provider->bulk_cache.get(
         provider->bulk_cache_data, in.size, HG_BULK_READWRITE);
@@ -61,9 +261,21 @@ void yk_get_ult(hg_handle_t h)
     size_t sizes_to_transfer = in.count*sizeof(size_t);
     if(!in.packed) sizes_to_transfer *= 2;
 
+    // if the client told us the total key size, pull the sizes
+    // and the keys in a single transfer instead of two
+    const bool single_pull = in.total_ksize != 0;
+    if(single_pull) {
+        if(in.size < keys_offset + in.total_ksize) {
+            out.ret = YOKAN_ERR_INVALID_ARGS;
+            return;
+        }
+        sizes_to_transfer = keys_offset + in.total_ksize;
+    }
+
     hret = margo_bulk_transfer(mid, HG_BULK_PULL, origin_addr,
             in.bulk, in.offset, buffer->bulk, 0, sizes_to_transfer);
     CHECK_HRET_OUT(hret, margo_bulk_transfer);
+    trace.stage("bulk_pull");
 
     // build buffer wrappers for key sizes
     auto ptr = buffer->data;
@@ -91,7 +303,8 @@ void yk_get_ult(hg_handle_t h)
     }
 
     // check that the total_ksize found is consistent with in.size
-    if(in.size < vals_offset) {
+    // and with the total key size provided by the client, if any
+    if(in.size < vals_offset || (single_pull && total_ksize != in.total_ksize)) {
         out.ret = YOKAN_ERR_INVALID_ARGS;
         return;
     }
@@ -106,11 +319,31 @@ void yk_get_ult(hg_handle_t h)
         }
     }
 
+    // large batches are split into segments processed by concurrent ULTs,
+    // except with YOKAN_MODE_CONSUME (the same key may appear in several
+    // segments) and with a packed YOKAN_MODE_WAIT (values can't be sized
+    // before they exist)
+    auto segments = yokan::splitBatch(in.count,
+            provider->batch_split.threshold, provider->batch_split.max_segments);
+    const bool split = segments.size() > 2
+                    && !(in.mode & YOKAN_MODE_CONSUME)
+                    && !(in.packed && (in.mode & YOKAN_MODE_WAIT));
+
+    if(split && !in.packed) {
+        out.ret = get_segments(mid, provider, in, origin_addr, buffer,
+                               segments, !single_pull);
+        trace.stage("segments");
+        return;
+    }
+
     // transfer the actual keys from the client
-    hret = margo_bulk_transfer(mid, HG_BULK_PULL, origin_addr,
-            in.bulk, in.offset + keys_offset,
-            buffer->bulk, keys_offset, total_ksize);
-    CHECK_HRET_OUT(hret, margo_bulk_transfer);
+    if(!single_pull) {
+        hret = margo_bulk_transfer(mid, HG_BULK_PULL, origin_addr,
+                in.bulk, in.offset + keys_offset,
+                buffer->bulk, keys_offset, total_ksize);
+        CHECK_HRET_OUT(hret, margo_bulk_transfer);
+        trace.stage("bulk_pull");
+    }
 
     // create UserMem wrapper for keys
     auto keys = yokan::UserMem{ ptr + keys_offset, total_ksize };
@@ -119,8 +352,18 @@ void yk_get_ult(hg_handle_t h)
     size_t remaining_vsize = in.size - vals_offset;
     auto vals = yokan::UserMem{ ptr + vals_offset, remaining_vsize };
 
+    if(split) {
+        yk_return_t ret = YOKAN_SUCCESS;
+        if(get_segments_packed(mid, provider, in, origin_addr, buffer,
+                               segments, vals_offset, remaining_vsize, ret)) {
+            out.ret = ret;
+            return;
+        }
+    }
+
     out.ret = static_cast<yk_return_t>(
             database->get(in.mode, in.packed, keys, ksizes, vals, vsizes));
+    trace.stage("backend");
 
     if(out.ret == YOKAN_SUCCESS) {
         // transfer the vsizes and values back the client
@@ -139,10 +382,12 @@ void yk_get_ult(hg_handle_t h)
                 in.bulk, in.offset + vsizes_offset,
                 buffer->bulk, vsizes_offset, in.count*sizeof(size_t));
         CHECK_HRET_OUT(hret, margo_bulk_transfer);
+        trace.stage("bulk_push");
 
         if(req != MARGO_REQUEST_NULL) {
             hret = margo_wait(req);
             CHECK_HRET_OUT(hret, margo_wait);
+            trace.stage("bulk_push");
         }
     }
 }
@@ -162,6 +407,7 @@ void yk_get_direct_ult(hg_handle_t h)
 
     out.ret = YOKAN_SUCCESS;
 
+    yokan::RequestTrace trace;
     DEFER(margo_destroy(h));
     DEFER(margo_respond(h, &out));
 
@@ -171,14 +417,19 @@ void yk_get_direct_ult(hg_handle_t h)
     const struct hg_info* info = margo_get_info(h);
     yk_provider_t provider = (yk_provider_t)margo_registered_data(mid, info->id);
     CHECK_PROVIDER(provider);
+    TRACK_RPC(provider, get_direct);
+    trace.begin(provider->tracer, "server", "get_direct");
 
     hret = margo_get_input(h, &in);
     CHECK_HRET_OUT(hret, margo_get_input);
     DEFER(margo_free_input(h, &in));
+    trace.sample(in.trace_id);
+    trace.stage("get_input");
 
     yk_database* database = provider->db;
     CHECK_DATABASE(database);
     CHECK_MODE_SUPPORTED(database, in.mode);
+    CHECK_ADMISSION(provider, in.keys.size + in.vbufsize);
 
     auto count = in.ksizes.count;
     auto ksizes_umem = yokan::BasicUserMem<size_t>{
@@ -208,6 +459,7 @@ void yk_get_direct_ult(hg_handle_t h)
     out.ret = static_cast<yk_return_t>(
             database->get(in.mode, true, keys_umem,
                           ksizes_umem, values_umem, vsizes_umem));
+    trace.stage("backend");
 
     if(out.ret == YOKAN_SUCCESS) {
         out.vsizes.sizes = vsizes.data();
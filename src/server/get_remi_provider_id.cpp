@@ -27,6 +27,7 @@ void yk_get_remi_provider_id_ult(hg_handle_t h)
     const struct hg_info* info = margo_get_info(h);
     yk_provider_t provider = (yk_provider_t)margo_registered_data(mid, info->id);
     CHECK_PROVIDER(provider);
+    TRACK_RPC(provider, get_remi_provider_id);
 
 #ifdef YOKAN_HAS_REMI
     if(provider->remi.provider) {
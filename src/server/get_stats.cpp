@@ -0,0 +1,36 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#include "yokan/server.h"
+#include "provider.hpp"
+#include "../common/types.h"
+#include "../common/defer.hpp"
+#include "../common/logging.h"
+#include "../common/checks.h"
+#include <cstdlib>
+
+void yk_get_stats_ult(hg_handle_t h)
+{
+    get_stats_out_t out;
+
+    out.ret   = YOKAN_SUCCESS;
+    out.stats = nullptr;
+
+    DEFER(margo_destroy(h));
+    DEFER(free(out.stats));
+    DEFER(margo_respond(h, &out));
+
+    margo_instance_id mid = margo_hg_handle_get_instance(h);
+    CHECK_MID(mid, margo_hg_handle_get_instance);
+
+    const struct hg_info* info = margo_get_info(h);
+    yk_provider_t provider = (yk_provider_t)margo_registered_data(mid, info->id);
+    CHECK_PROVIDER(provider);
+    TRACK_RPC(provider, get_stats);
+
+    out.stats = yk_provider_get_stats(provider);
+    if(!out.stats) out.ret = YOKAN_ERR_ALLOCATION;
+}
+DEFINE_MARGO_RPC_HANDLER(yk_get_stats_ult)
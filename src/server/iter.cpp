@@ -9,6 +9,7 @@
 #include "../common/defer.hpp"
 #include "../common/logging.h"
 #include "../common/checks.h"
+#include "util/back_rpc_window.hpp"
 #include <numeric>
 #include <iostream>
 
@@ -21,6 +22,7 @@ void yk_iter_ult(hg_handle_t h)
     std::memset(&in, 0, sizeof(in));
     out.ret = YOKAN_SUCCESS;
 
+    yokan::RequestTrace trace;
     DEFER(margo_destroy(h));
     DEFER(margo_respond(h, &out));
 
@@ -30,10 +32,14 @@ void yk_iter_ult(hg_handle_t h)
     const struct hg_info* info = margo_get_info(h);
     yk_provider_t provider = (yk_provider_t)margo_registered_data(mid, info->id);
     CHECK_PROVIDER(provider);
+    TRACK_RPC(provider, iter);
+    trace.begin(provider->tracer, "server", "iter");
 
     hret = margo_get_input(h, &in);
     CHECK_HRET_OUT(hret, margo_get_input);
     DEFER(margo_free_input(h, &in));
+    trace.sample(in.trace_id);
+    trace.stage("get_input");
 
     if(in.batch_size == 0)
         in.batch_size = in.count;
@@ -41,37 +47,22 @@ void yk_iter_ult(hg_handle_t h)
     yk_database* database = provider->db;
     CHECK_DATABASE(database);
     CHECK_MODE_SUPPORTED(database, in.mode);
+    CHECK_ADMISSION(provider, 0);
 
-    struct previous_op {
+    // batches in flight, kept alive until the client pulled them
+    struct batch_data {
         std::vector<size_t> ksizes;
         std::vector<size_t> vsizes;
         std::vector<char>   keyvals;
-        hg_handle_t         handle = HG_HANDLE_NULL;
-        hg_bulk_t           bulk   = HG_BULK_NULL;
-        margo_request       req    = MARGO_REQUEST_NULL;
     };
 
-    previous_op previous;
+    yokan::BackRPCWindow<iter_back_out_t> window{mid, provider->back_rpc_window};
 
     uint64_t            num_keyvals_sent = 0;
     std::vector<size_t> ksizes; ksizes.reserve(in.batch_size);
     std::vector<size_t> vsizes; vsizes.reserve(in.batch_size);
     std::vector<char>   keyvals;
 
-    auto wait_for_previous_rpc = [&]() -> yk_return_t {
-        hg_return_t hret = HG_SUCCESS;
-        DEFER(margo_destroy(previous.handle); previous.handle = HG_HANDLE_NULL;);
-        DEFER(margo_bulk_free(previous.bulk); previous.bulk = HG_BULK_NULL;);
-        if(previous.handle == HG_HANDLE_NULL) return YOKAN_SUCCESS;
-        hret = margo_wait(previous.req);
-        CHECK_HRET(hret, margo_wait);
-        iter_back_out_t back_out;
-        hret = margo_get_output(previous.handle, &back_out);
-        CHECK_HRET(hret, margo_get_output);
-        DEFER(margo_free_output(previous.handle, &back_out));
-        return (yk_return_t)back_out.ret;
-    };
-
     auto send_batch = [&]() -> yk_return_t {
 
         if(ksizes.size() == 0)
@@ -91,7 +82,7 @@ void yk_iter_ult(hg_handle_t h)
         back_in.size   = std::accumulate(buffer_sizes.begin(), buffer_sizes.end(), (size_t)0);
         back_in.bulk   = local_bulk;
 
-        auto ret       = wait_for_previous_rpc();
+        auto ret       = window.acquire();
         if(ret != YOKAN_SUCCESS)
             return ret;
 
@@ -108,14 +99,15 @@ void yk_iter_ult(hg_handle_t h)
 
         num_keyvals_sent += ksizes.size();
 
-        previous.keyvals = std::move(keyvals);
-        previous.ksizes  = std::move(ksizes);
-        previous.vsizes  = std::move(vsizes);
-        margo_ref_incr(back_handle);
-        previous.handle = back_handle;
-        margo_bulk_ref_incr(local_bulk);
-        previous.bulk   = local_bulk;
-        previous.req    = req;
+        auto batch = std::make_shared<batch_data>();
+        batch->ksizes  = std::move(ksizes);
+        batch->vsizes  = std::move(vsizes);
+        batch->keyvals = std::move(keyvals);
+        window.push(back_handle, local_bulk, req, std::move(batch));
+
+        ksizes.clear();  ksizes.reserve(in.batch_size);
+        vsizes.clear();  vsizes.reserve(in.batch_size);
+        keyvals.clear();
 
         return YOKAN_SUCCESS;
     };
@@ -152,13 +144,14 @@ void yk_iter_ult(hg_handle_t h)
 
     out.ret = static_cast<yk_return_t>(
             database->iter(in.mode, in.count, from_key, filter, in.no_values, iter_func));
+    trace.stage("backend");
 
     if(out.ret == YOKAN_STOP_ITERATION)
         out.ret = YOKAN_SUCCESS;
 
     auto ret = send_batch();
     if(out.ret == YOKAN_SUCCESS) out.ret = ret;
-    ret = wait_for_previous_rpc();
+    ret = window.waitAll();
     if(out.ret == YOKAN_SUCCESS) out.ret = ret;
 }
 DEFINE_MARGO_RPC_HANDLER(yk_iter_ult)
@@ -172,6 +165,7 @@ void yk_iter_direct_ult(hg_handle_t h)
     std::memset(&in, 0, sizeof(in));
     out.ret = YOKAN_SUCCESS;
 
+    yokan::RequestTrace trace;
     DEFER(margo_destroy(h));
     DEFER(margo_respond(h, &out));
 
@@ -181,10 +175,14 @@ void yk_iter_direct_ult(hg_handle_t h)
     const struct hg_info* info = margo_get_info(h);
     yk_provider_t provider = (yk_provider_t)margo_registered_data(mid, info->id);
     CHECK_PROVIDER(provider);
+    TRACK_RPC(provider, iter_direct);
+    trace.begin(provider->tracer, "server", "iter_direct");
 
     hret = margo_get_input(h, &in);
     CHECK_HRET_OUT(hret, margo_get_input);
     DEFER(margo_free_input(h, &in));
+    trace.sample(in.trace_id);
+    trace.stage("get_input");
 
     if(in.batch_size == 0)
         in.batch_size = in.count;
@@ -192,32 +190,15 @@ void yk_iter_direct_ult(hg_handle_t h)
     yk_database* database = provider->db;
     CHECK_DATABASE(database);
     CHECK_MODE_SUPPORTED(database, in.mode);
+    CHECK_ADMISSION(provider, 0);
 
-    struct previous_op {
-        hg_handle_t   handle = HG_HANDLE_NULL;
-        margo_request req    = MARGO_REQUEST_NULL;
-    };
-
-    previous_op previous;
+    yokan::BackRPCWindow<iter_direct_back_out_t> window{mid, provider->back_rpc_window};
 
     uint64_t            num_keyvals_sent = 0;
     std::vector<size_t> ksizes; ksizes.reserve(in.batch_size);
     std::vector<size_t> vsizes; vsizes.reserve(in.batch_size);
     std::vector<char>   keyvals;
 
-    auto wait_for_previous_rpc = [&]() -> yk_return_t {
-        hg_return_t hret = HG_SUCCESS;
-        DEFER(margo_destroy(previous.handle); previous.handle = HG_HANDLE_NULL;);
-        if(previous.handle == HG_HANDLE_NULL) return YOKAN_SUCCESS;
-        hret = margo_wait(previous.req);
-        CHECK_HRET(hret, margo_wait);
-        iter_direct_back_out_t back_out;
-        hret = margo_get_output(previous.handle, &back_out);
-        CHECK_HRET(hret, margo_get_output);
-        DEFER(margo_free_output(previous.handle, &back_out));
-        return (yk_return_t)back_out.ret;
-    };
-
     auto send_batch = [&]() -> yk_return_t {
 
         if(ksizes.size() == 0)
@@ -233,7 +214,7 @@ void yk_iter_direct_ult(hg_handle_t h)
         back_in.keyvals.data = keyvals.data();
         back_in.keyvals.size = keyvals.size();
 
-        auto ret = wait_for_previous_rpc();
+        auto ret = window.acquire();
         if(ret != YOKAN_SUCCESS)
             return ret;
 
@@ -254,9 +235,7 @@ void yk_iter_direct_ult(hg_handle_t h)
         vsizes.clear();
         keyvals.clear();
 
-        margo_ref_incr(back_handle);
-        previous.handle = back_handle;
-        previous.req    = req;
+        window.push(back_handle, HG_BULK_NULL, req);
 
         return YOKAN_SUCCESS;
     };
@@ -293,13 +272,14 @@ void yk_iter_direct_ult(hg_handle_t h)
 
     out.ret = static_cast<yk_return_t>(
             database->iter(in.mode, in.count, from_key, filter, in.no_values, iter_func));
+    trace.stage("backend");
 
     if(out.ret == YOKAN_STOP_ITERATION)
         out.ret = YOKAN_SUCCESS;
 
     auto ret = send_batch();
     if(out.ret == YOKAN_SUCCESS) out.ret = ret;
-    ret = wait_for_previous_rpc();
+    ret = window.waitAll();
     if(out.ret == YOKAN_SUCCESS) out.ret = ret;
 }
 DEFINE_MARGO_RPC_HANDLER(yk_iter_direct_ult)
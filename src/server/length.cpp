@@ -20,6 +20,7 @@ void yk_length_ult(hg_handle_t h)
 
     out.ret = YOKAN_SUCCESS;
 
+    yokan::RequestTrace trace;
     DEFER(margo_destroy(h));
     DEFER(margo_respond(h, &out));
 
@@ -29,10 +30,14 @@ void yk_length_ult(hg_handle_t h)
     const struct hg_info* info = margo_get_info(h);
     yk_provider_t provider = (yk_provider_t)margo_registered_data(mid, info->id);
     CHECK_PROVIDER(provider);
+    TRACK_RPC(provider, length);
+    trace.begin(provider->tracer, "server", "length");
 
     hret = margo_get_input(h, &in);
     CHECK_HRET_OUT(hret, margo_get_input);
     DEFER(margo_free_input(h, &in));
+    trace.sample(in.trace_id);
+    trace.stage("get_input");
 
     if(in.origin) {
         hret = margo_addr_lookup(mid, in.origin, &origin_addr);
@@ -46,6 +51,7 @@ void yk_length_ult(hg_handle_t h)
     yk_database* database = provider->db;
     CHECK_DATABASE(database);
     CHECK_MODE_SUPPORTED(database, in.mode);
+    CHECK_ADMISSION(provider, in.size);
 
     yk_buffer_t buffer = provider->bulk_cache.get(
         provider->bulk_cache_data, in.size, HG_BULK_READWRITE);
@@ -58,9 +64,21 @@ void yk_length_ult(hg_handle_t h)
     // transfer ksizes
     size_t sizes_to_transfer = in.count*sizeof(size_t);
 
+    // if the client told us the total key size, pull the sizes
+    // and the keys in a single transfer instead of two
+    const bool single_pull = in.total_ksize != 0;
+    if(single_pull) {
+        if(in.size < keys_offset + in.total_ksize) {
+            out.ret = YOKAN_ERR_INVALID_ARGS;
+            return;
+        }
+        sizes_to_transfer = keys_offset + in.total_ksize;
+    }
+
     hret = margo_bulk_transfer(mid, HG_BULK_PULL, origin_addr,
             in.bulk, in.offset, buffer->bulk, 0, sizes_to_transfer);
     CHECK_HRET_OUT(hret, margo_bulk_transfer);
+    trace.stage("bulk_pull");
 
     // build buffer wrappers for key sizes
     auto ptr = buffer->data;
@@ -89,11 +107,20 @@ void yk_length_ult(hg_handle_t h)
         return;
     }
 
+    // check that the keys are consistent with the total provided by the client
+    if(single_pull && total_ksize != in.total_ksize) {
+        out.ret = YOKAN_ERR_INVALID_ARGS;
+        return;
+    }
+
     // transfer the actual keys from the client
-    hret = margo_bulk_transfer(mid, HG_BULK_PULL, origin_addr,
-            in.bulk, in.offset + keys_offset,
-            buffer->bulk, keys_offset, total_ksize);
-    CHECK_HRET_OUT(hret, margo_bulk_transfer);
+    if(!single_pull) {
+        hret = margo_bulk_transfer(mid, HG_BULK_PULL, origin_addr,
+                in.bulk, in.offset + keys_offset,
+                buffer->bulk, keys_offset, total_ksize);
+        CHECK_HRET_OUT(hret, margo_bulk_transfer);
+        trace.stage("bulk_pull");
+    }
 
     // create memory wrapper for keys
     auto keys = yokan::UserMem{ ptr + keys_offset, total_ksize };
@@ -106,6 +133,7 @@ void yk_length_ult(hg_handle_t h)
 
     out.ret = static_cast<yk_return_t>(
             database->length(in.mode, keys, ksizes, vsizes));
+    trace.stage("backend");
 
     if(out.ret == YOKAN_SUCCESS) {
         // transfer the vsizes back the client
@@ -113,6 +141,7 @@ void yk_length_ult(hg_handle_t h)
                 in.bulk, in.offset + vsizes_offset,
                 buffer->bulk, vsizes_offset, in.count*sizeof(size_t));
         CHECK_HRET_OUT(hret, margo_bulk_transfer);
+        trace.stage("bulk_push");
     }
 }
 DEFINE_MARGO_RPC_HANDLER(yk_length_ult)
@@ -134,6 +163,7 @@ void yk_length_direct_ult(hg_handle_t h)
     out.sizes.count = 0;
     out.ret = YOKAN_SUCCESS;
 
+    yokan::RequestTrace trace;
     DEFER(margo_destroy(h));
     DEFER(margo_respond(h, &out));
 
@@ -143,10 +173,14 @@ void yk_length_direct_ult(hg_handle_t h)
     const struct hg_info* info = margo_get_info(h);
     yk_provider_t provider = (yk_provider_t)margo_registered_data(mid, info->id);
     CHECK_PROVIDER(provider);
+    TRACK_RPC(provider, length_direct);
+    trace.begin(provider->tracer, "server", "length_direct");
 
     hret = margo_get_input(h, &in);
     CHECK_HRET_OUT(hret, margo_get_input);
     DEFER(margo_free_input(h, &in));
+    trace.sample(in.trace_id);
+    trace.stage("get_input");
 
     auto count = in.sizes.count;
     vsizes_vec.resize(count);
@@ -155,6 +189,7 @@ void yk_length_direct_ult(hg_handle_t h)
 
     yk_database* database = provider->db;
     CHECK_MODE_SUPPORTED(database, in.mode);
+    CHECK_ADMISSION(provider, in.keys.size);
 
     auto ksizes = yokan::BasicUserMem<size_t>{ in.sizes.sizes, count };
 
@@ -177,5 +212,6 @@ void yk_length_direct_ult(hg_handle_t h)
 
     out.ret = static_cast<yk_return_t>(
             database->length(in.mode, keys, ksizes, vsizes));
+    trace.stage("backend");
 }
 DEFINE_MARGO_RPC_HANDLER(yk_length_direct_ult)
@@ -9,6 +9,7 @@
 #include "../common/defer.hpp"
 #include "../common/logging.h"
 #include "../common/checks.h"
+#include "util/scan_budget.hpp"
 #include <iostream>
 #include <numeric>
 
@@ -18,9 +19,13 @@ void yk_list_keys_ult(hg_handle_t h)
     list_keys_in_t in;
     list_keys_out_t out;
     hg_addr_t origin_addr = HG_ADDR_NULL;
+    std::string resume_key;
 
     out.ret = YOKAN_SUCCESS;
+    out.token.size = 0;
+    out.token.data = nullptr;
 
+    yokan::RequestTrace trace;
     DEFER(margo_destroy(h));
     DEFER(margo_respond(h, &out));
 
@@ -30,10 +35,14 @@ void yk_list_keys_ult(hg_handle_t h)
     const struct hg_info* info = margo_get_info(h);
     yk_provider_t provider = (yk_provider_t)margo_registered_data(mid, info->id);
     CHECK_PROVIDER(provider);
+    TRACK_RPC(provider, list_keys);
+    trace.begin(provider->tracer, "server", "list_keys");
 
     hret = margo_get_input(h, &in);
     CHECK_HRET_OUT(hret, margo_get_input);
     DEFER(margo_free_input(h, &in));
+    trace.sample(in.trace_id);
+    trace.stage("get_input");
 
     if(in.origin) {
         hret = margo_addr_lookup(mid, in.origin, &origin_addr);
@@ -47,6 +56,14 @@ void yk_list_keys_ult(hg_handle_t h)
     yk_database* database = provider->db;
     CHECK_DATABASE(database);
     CHECK_MODE_SUPPORTED(database, in.mode);
+    CHECK_ADMISSION(provider, in.from_ksize + in.filter_size + in.keys_buf_size + in.count*sizeof(size_t));
+
+    // resuming from a key only makes sense if keys are ordered
+    yokan::ScanBudget budget{in.max_examined, in.max_time_us};
+    if(budget.enabled() && !database->isSorted()) {
+        out.ret = YOKAN_ERR_OP_UNSUPPORTED;
+        return;
+    }
 
     size_t buffer_size = in.from_ksize + in.filter_size
                        + in.count*sizeof(size_t)
@@ -68,6 +85,7 @@ void yk_list_keys_ult(hg_handle_t h)
         hret = margo_bulk_transfer(mid, HG_BULK_PULL, origin_addr,
                 in.bulk, in.offset, buffer->bulk, 0, size_to_transfer);
         CHECK_HRET_OUT(hret, margo_bulk_transfer);
+        trace.stage("bulk_pull");
     }
 
     // build buffer wrappers
@@ -86,16 +104,31 @@ void yk_list_keys_ult(hg_handle_t h)
         return;
     }
 
+    std::shared_ptr<yokan::BudgetedKeyValueFilter> budgeted;
+    if(budget.enabled()) {
+        budgeted = std::make_shared<yokan::BudgetedKeyValueFilter>(filter, budget);
+        filter = budgeted;
+    }
+
     out.ret = static_cast<yk_return_t>(
             database->listKeys(in.mode, in.packed, from_key, filter, keys, ksizes));
+    trace.stage("backend");
 
-    if(out.ret == YOKAN_SUCCESS) {
+    if(out.ret == YOKAN_SUCCESS && budgeted && budgeted->incomplete()) {
+        resume_key     = budgeted->resumeKey();
+        out.token.data = const_cast<char*>(resume_key.data());
+        out.token.size = resume_key.size();
+        out.ret        = YOKAN_ERR_INCOMPLETE;
+    }
+
+    if(out.ret == YOKAN_SUCCESS || out.ret == YOKAN_ERR_INCOMPLETE) {
         size_to_transfer = in.count*sizeof(size_t)
                          + keys.size;
         hret = margo_bulk_transfer(mid, HG_BULK_PUSH, origin_addr,
                 in.bulk, in.offset + ksizes_offset,
                 buffer->bulk, ksizes_offset, size_to_transfer);
         CHECK_HRET_OUT(hret, margo_bulk_transfer);
+        trace.stage("bulk_push");
     }
 }
 DEFINE_MARGO_RPC_HANDLER(yk_list_keys_ult)
@@ -112,6 +145,7 @@ void yk_list_keys_direct_ult(hg_handle_t h)
     std::memset(&in, 0, sizeof(in));
     std::memset(&out, 0, sizeof(out));
 
+    yokan::RequestTrace trace;
     DEFER(margo_destroy(h));
     DEFER(margo_respond(h, &out));
 
@@ -121,14 +155,19 @@ void yk_list_keys_direct_ult(hg_handle_t h)
     const struct hg_info* info = margo_get_info(h);
     yk_provider_t provider = (yk_provider_t)margo_registered_data(mid, info->id);
     CHECK_PROVIDER(provider);
+    TRACK_RPC(provider, list_keys_direct);
+    trace.begin(provider->tracer, "server", "list_keys_direct");
 
     hret = margo_get_input(h, &in);
     CHECK_HRET_OUT(hret, margo_get_input);
     DEFER(margo_free_input(h, &in));
+    trace.sample(in.trace_id);
+    trace.stage("get_input");
 
     yk_database* database = provider->db;
     CHECK_DATABASE(database);
     CHECK_MODE_SUPPORTED(database, in.mode);
+    CHECK_ADMISSION(provider, in.keys_buf_size + in.count*sizeof(size_t));
 
     ksizes.resize(in.count);
     keys.resize(in.keys_buf_size);
@@ -147,6 +186,7 @@ void yk_list_keys_direct_ult(hg_handle_t h)
 
     out.ret = static_cast<yk_return_t>(
             database->listKeys(in.mode, true, from_key, filter, keys_umem, ksizes_umem));
+    trace.stage("backend");
 
     if(out.ret == YOKAN_SUCCESS) {
         out.ksizes.sizes = ksizes.data();
@@ -98,7 +98,7 @@ static inline int32_t after_migration_cb(remi_fileset_t fileset, void* uargs)
         return (int32_t)status;
     }
 
-    provider->db = database;
+    provider->db = new yokan::InstrumentedDatabase(provider->metrics, provider->hot_keys, database);
     provider->config["database"] = json::object();
     provider->config["database"]["type"] = type;
     provider->config["database"]["config"] = json::parse(database->config());
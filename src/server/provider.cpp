@@ -15,6 +15,7 @@
 #include "../buffer/default_bulk_cache.hpp"
 #include "../buffer/keep_all_bulk_cache.hpp"
 #include "../buffer/lru_bulk_cache.hpp"
+#include "../buffer/slab_bulk_cache.hpp"
 #include <string>
 #ifdef YOKAN_HAS_REMI
 #include <remi/remi-client.h>
@@ -75,6 +76,173 @@ yk_return_t yk_provider_register(
             return YOKAN_ERR_INVALID_CONFIG;
         }
     }
+    // checking pools field
+    if(config.contains("pools")) {
+        if(not config["pools"].is_object()) {
+            YOKAN_LOG_ERROR(mid, "\"pools\" field in configuration is not an object");
+            return YOKAN_ERR_INVALID_CONFIG;
+        }
+        for(auto& item : config["pools"].items()) {
+            if(item.key() != "read" && item.key() != "write" && item.key() != "scan"
+            && item.key() != "doc" && item.key() != "admin") {
+                YOKAN_LOG_ERROR(mid, "Invalid operation class \"%s\" in \"pools\" field"
+                    " (expected \"read\", \"write\", \"scan\", \"doc\", or \"admin\")",
+                    item.key().c_str());
+                return YOKAN_ERR_INVALID_CONFIG;
+            }
+            if(not item.value().is_string()) {
+                YOKAN_LOG_ERROR(mid, "\"%s\" entry in \"pools\" should be a pool name",
+                    item.key().c_str());
+                return YOKAN_ERR_INVALID_CONFIG;
+            }
+        }
+    }
+    // checking cursors field
+    if(not config.contains("cursors"))
+        config["cursors"] = json::object();
+    if(not config["cursors"].is_object()) {
+        YOKAN_LOG_ERROR(mid, "\"cursors\" field in configuration is not an object");
+        return YOKAN_ERR_INVALID_CONFIG;
+    }
+    if(not config["cursors"].contains("lease_timeout"))
+        config["cursors"]["lease_timeout"] = 60.0;
+    if(not config["cursors"]["lease_timeout"].is_number()
+    || config["cursors"]["lease_timeout"].get<double>() <= 0.0) {
+        YOKAN_LOG_ERROR(mid, "\"lease_timeout\" in \"cursors\" should be a positive number");
+        return YOKAN_ERR_INVALID_CONFIG;
+    }
+    if(not config["cursors"].contains("max_cursors"))
+        config["cursors"]["max_cursors"] = 1024;
+    if(not config["cursors"]["max_cursors"].is_number_unsigned()) {
+        YOKAN_LOG_ERROR(mid, "\"max_cursors\" in \"cursors\" should be an unsigned integer");
+        return YOKAN_ERR_INVALID_CONFIG;
+    }
+    // checking back_rpc_window field
+    if(not config.contains("back_rpc_window"))
+        config["back_rpc_window"] = 1;
+    if(not config["back_rpc_window"].is_number_unsigned()
+    || config["back_rpc_window"].get<size_t>() == 0) {
+        YOKAN_LOG_ERROR(mid, "\"back_rpc_window\" should be a strictly positive integer");
+        return YOKAN_ERR_INVALID_CONFIG;
+    }
+    // checking max_reserved_ids field
+    if(not config.contains("max_reserved_ids"))
+        config["max_reserved_ids"] = 1048576;
+    if(not config["max_reserved_ids"].is_number_unsigned()
+    || config["max_reserved_ids"].get<size_t>() == 0) {
+        YOKAN_LOG_ERROR(mid, "\"max_reserved_ids\" should be a strictly positive integer");
+        return YOKAN_ERR_INVALID_CONFIG;
+    }
+    // checking batch_split field (splitting is opt-in: a split put is
+    // written by independent backend calls, so it is no longer atomic on
+    // backends that write a batch atomically, and if one segment fails the
+    // others may already have been written)
+    if(not config.contains("batch_split"))
+        config["batch_split"] = json::object();
+    if(not config["batch_split"].is_object()) {
+        YOKAN_LOG_ERROR(mid, "\"batch_split\" field in configuration is not an object");
+        return YOKAN_ERR_INVALID_CONFIG;
+    }
+    if(not config["batch_split"].contains("threshold"))
+        config["batch_split"]["threshold"] = 0;
+    if(not config["batch_split"]["threshold"].is_number_unsigned()) {
+        YOKAN_LOG_ERROR(mid, "\"threshold\" in \"batch_split\" should be an unsigned integer");
+        return YOKAN_ERR_INVALID_CONFIG;
+    }
+    if(not config["batch_split"].contains("max_segments"))
+        config["batch_split"]["max_segments"] = 8;
+    if(not config["batch_split"]["max_segments"].is_number_unsigned()
+    || config["batch_split"]["max_segments"].get<size_t>() == 0) {
+        YOKAN_LOG_ERROR(mid, "\"max_segments\" in \"batch_split\" should be a strictly positive integer");
+        return YOKAN_ERR_INVALID_CONFIG;
+    }
+    // checking admission field
+    if(not config.contains("admission"))
+        config["admission"] = json::object();
+    if(not config["admission"].is_object()) {
+        YOKAN_LOG_ERROR(mid, "\"admission\" field in configuration is not an object");
+        return YOKAN_ERR_INVALID_CONFIG;
+    }
+    if(not config["admission"].contains("max_ops"))
+        config["admission"]["max_ops"] = 0;
+    if(not config["admission"]["max_ops"].is_number_unsigned()) {
+        YOKAN_LOG_ERROR(mid, "\"max_ops\" in \"admission\" should be an unsigned integer");
+        return YOKAN_ERR_INVALID_CONFIG;
+    }
+    if(not config["admission"].contains("max_bytes"))
+        config["admission"]["max_bytes"] = 0;
+    if(not config["admission"]["max_bytes"].is_number_unsigned()) {
+        YOKAN_LOG_ERROR(mid, "\"max_bytes\" in \"admission\" should be an unsigned integer");
+        return YOKAN_ERR_INVALID_CONFIG;
+    }
+    if(not config["admission"].contains("queue_timeout"))
+        config["admission"]["queue_timeout"] = 0.0;
+    if(not config["admission"]["queue_timeout"].is_number()
+    || config["admission"]["queue_timeout"].get<double>() < 0.0) {
+        YOKAN_LOG_ERROR(mid, "\"queue_timeout\" in \"admission\" should be a non-negative number");
+        return YOKAN_ERR_INVALID_CONFIG;
+    }
+    // checking tracing field
+    if(not config.contains("tracing"))
+        config["tracing"] = json::object();
+    if(not config["tracing"].is_object()) {
+        YOKAN_LOG_ERROR(mid, "\"tracing\" field in configuration is not an object");
+        return YOKAN_ERR_INVALID_CONFIG;
+    }
+    if(not config["tracing"].contains("enabled"))
+        config["tracing"]["enabled"] = false;
+    if(not config["tracing"]["enabled"].is_boolean()) {
+        YOKAN_LOG_ERROR(mid, "\"enabled\" in \"tracing\" should be a boolean");
+        return YOKAN_ERR_INVALID_CONFIG;
+    }
+    if(not config["tracing"].contains("sample_rate"))
+        config["tracing"]["sample_rate"] = 0.0;
+    if(not config["tracing"]["sample_rate"].is_number()
+    || config["tracing"]["sample_rate"].get<double>() < 0.0
+    || config["tracing"]["sample_rate"].get<double>() > 1.0) {
+        YOKAN_LOG_ERROR(mid, "\"sample_rate\" in \"tracing\" should be a number between 0 and 1");
+        return YOKAN_ERR_INVALID_CONFIG;
+    }
+    if(not config["tracing"].contains("max_requests"))
+        config["tracing"]["max_requests"] = 100000;
+    if(not config["tracing"]["max_requests"].is_number_unsigned()) {
+        YOKAN_LOG_ERROR(mid, "\"max_requests\" in \"tracing\" should be an unsigned integer");
+        return YOKAN_ERR_INVALID_CONFIG;
+    }
+    if(not config["tracing"].contains("output"))
+        config["tracing"]["output"] = "";
+    if(not config["tracing"]["output"].is_string()) {
+        YOKAN_LOG_ERROR(mid, "\"output\" in \"tracing\" should be a string");
+        return YOKAN_ERR_INVALID_CONFIG;
+    }
+    // checking hot_keys field
+    if(not config.contains("hot_keys"))
+        config["hot_keys"] = json::object();
+    if(not config["hot_keys"].is_object()) {
+        YOKAN_LOG_ERROR(mid, "\"hot_keys\" field in configuration is not an object");
+        return YOKAN_ERR_INVALID_CONFIG;
+    }
+    if(not config["hot_keys"].contains("enabled"))
+        config["hot_keys"]["enabled"] = false;
+    if(not config["hot_keys"]["enabled"].is_boolean()) {
+        YOKAN_LOG_ERROR(mid, "\"enabled\" in \"hot_keys\" should be a boolean");
+        return YOKAN_ERR_INVALID_CONFIG;
+    }
+    if(not config["hot_keys"].contains("capacity"))
+        config["hot_keys"]["capacity"] = 32;
+    if(not config["hot_keys"]["capacity"].is_number_unsigned()
+    || config["hot_keys"]["capacity"].get<size_t>() == 0) {
+        YOKAN_LOG_ERROR(mid, "\"capacity\" in \"hot_keys\" should be a strictly positive integer");
+        return YOKAN_ERR_INVALID_CONFIG;
+    }
+    if(not config["hot_keys"].contains("sample_rate"))
+        config["hot_keys"]["sample_rate"] = 0.01;
+    if(not config["hot_keys"]["sample_rate"].is_number()
+    || config["hot_keys"]["sample_rate"].get<double>() <= 0.0
+    || config["hot_keys"]["sample_rate"].get<double>() > 1.0) {
+        YOKAN_LOG_ERROR(mid, "\"sample_rate\" in \"hot_keys\" should be a number in (0, 1]");
+        return YOKAN_ERR_INVALID_CONFIG;
+    }
     // checking buffer_cache field
     if(not config.contains("buffer_cache")) {
         config["buffer_cache"] = json::object();
@@ -116,6 +284,38 @@ yk_return_t yk_provider_register(
     p->pool = a.pool;
     p->config = config;
 
+    /* Per-class pools */
+    struct {
+        const char* name;
+        ABT_pool    arg;
+        ABT_pool*   pool;
+    } pool_classes[] = {
+        { "read",  a.pools.read,  &p->pools.read  },
+        { "write", a.pools.write, &p->pools.write },
+        { "scan",  a.pools.scan,  &p->pools.scan  },
+        { "doc",   a.pools.doc,   &p->pools.doc   },
+        { "admin", a.pools.admin, &p->pools.admin }
+    };
+    for(auto& pool_class : pool_classes) {
+        *pool_class.pool = p->pool;
+        if(pool_class.arg != ABT_POOL_NULL) {
+            *pool_class.pool = pool_class.arg;
+            continue;
+        }
+        if(!config.contains("pools") || !config["pools"].contains(pool_class.name))
+            continue;
+        auto& pool_name = config["pools"][pool_class.name].get_ref<const std::string&>();
+        struct margo_pool_info pool_info;
+        hg_return_t hret = margo_find_pool_by_name(mid, pool_name.c_str(), &pool_info);
+        if(hret != HG_SUCCESS) {
+            YOKAN_LOG_ERROR(mid, "Could not find pool \"%s\" for %s operations",
+                pool_name.c_str(), pool_class.name);
+            delete p;
+            return YOKAN_ERR_INVALID_CONFIG;
+        }
+        *pool_class.pool = pool_info.pool;
+    }
+
     /* REMI client and provider */
 #ifdef YOKAN_HAS_REMI
     if(a.remi.client && !a.remi.provider) {
@@ -151,16 +351,23 @@ yk_return_t yk_provider_register(
 #endif
     /* Bulk cache */
     // TODO find a cache implementation in the configuration
+    p->bulk_cache_stats = nullptr;
     if(a.cache) {
         p->bulk_cache = *a.cache;
     } else {
         auto& buffer_cache_type = config["buffer_cache"]["type"].get_ref<const std::string&>();
         if(buffer_cache_type == "default") {
             p->bulk_cache = yk_default_bulk_cache;
+            p->bulk_cache_stats = yk_default_bulk_cache_stats;
         } else if(buffer_cache_type == "keep_all") {
             p->bulk_cache = yk_keep_all_bulk_cache;
+            p->bulk_cache_stats = yk_keep_all_bulk_cache_stats;
         } else if(buffer_cache_type == "lru") {
             p->bulk_cache = yk_lru_bulk_cache;
+            p->bulk_cache_stats = yk_lru_bulk_cache_stats;
+        } else if(buffer_cache_type == "slab") {
+            p->bulk_cache = yk_slab_bulk_cache;
+            p->bulk_cache_stats = yk_slab_bulk_cache_stats;
         } else {
             YOKAN_LOG_ERROR(mid, "Invalid buffer_cache type \"%s\"", buffer_cache_type.c_str());
             delete p;
@@ -182,59 +389,93 @@ yk_return_t yk_provider_register(
         return YOKAN_ERR_INVALID_CONFIG;
     }
 
+    /* Scan cursors */
+    ABT_mutex_create(&p->cursors.mutex);
+    p->cursors.next_id       = 1;
+    p->cursors.lease_timeout = config["cursors"]["lease_timeout"].get<double>();
+    p->cursors.max_cursors   = config["cursors"]["max_cursors"].get<size_t>();
+
+    /* Back-RPC streaming (fetch, iter) */
+    p->back_rpc_window = config["back_rpc_window"].get<size_t>();
+
+    /* Reservation of document ids */
+    p->max_reserved_ids = config["max_reserved_ids"].get<size_t>();
+
+    /* Splitting of large get/put batches */
+    p->batch_split.threshold    = config["batch_split"]["threshold"].get<size_t>();
+    p->batch_split.max_segments = config["batch_split"]["max_segments"].get<size_t>();
+
+    /* Admission control */
+    p->admission.configure(
+        config["admission"]["max_ops"].get<size_t>(),
+        config["admission"]["max_bytes"].get<size_t>(),
+        config["admission"]["queue_timeout"].get<double>());
+
+    /* Request tracing */
+    p->tracer.configure(
+        config["tracing"]["enabled"].get<bool>(),
+        config["tracing"]["sample_rate"].get<double>(),
+        config["tracing"]["max_requests"].get<size_t>());
+
+    /* Hot key detection */
+    p->hot_keys.configure(
+        config["hot_keys"]["enabled"].get<bool>(),
+        config["hot_keys"]["capacity"].get<size_t>(),
+        config["hot_keys"]["sample_rate"].get<double>());
+
     /* Client RPCs */
 
     id = MARGO_REGISTER_PROVIDER(mid, "yk_count",
             count_in_t, count_out_t,
-            yk_count_ult, provider_id, p->pool);
+            yk_count_ult, provider_id, p->pools.read);
     margo_register_data(mid, id, (void*)p, NULL);
     p->count_id = id;
 
     id = MARGO_REGISTER_PROVIDER(mid, "yk_put",
             put_in_t, put_out_t,
-            yk_put_ult, provider_id, p->pool);
+            yk_put_ult, provider_id, p->pools.write);
     margo_register_data(mid, id, (void*)p, NULL);
     p->put_id = id;
 
     id = MARGO_REGISTER_PROVIDER(mid, "yk_put_direct",
             put_direct_in_t, put_direct_out_t,
-            yk_put_direct_ult, provider_id, p->pool);
+            yk_put_direct_ult, provider_id, p->pools.write);
     margo_register_data(mid, id, (void*)p, NULL);
     p->put_direct_id = id;
 
     id = MARGO_REGISTER_PROVIDER(mid, "yk_erase",
             erase_in_t, erase_out_t,
-            yk_erase_ult, provider_id, p->pool);
+            yk_erase_ult, provider_id, p->pools.write);
     margo_register_data(mid, id, (void*)p, NULL);
     p->erase_id = id;
 
     id = MARGO_REGISTER_PROVIDER(mid, "yk_erase_direct",
             erase_direct_in_t, erase_direct_out_t,
-            yk_erase_direct_ult, provider_id, p->pool);
+            yk_erase_direct_ult, provider_id, p->pools.write);
     margo_register_data(mid, id, (void*)p, NULL);
     p->erase_direct_id = id;
 
     id = MARGO_REGISTER_PROVIDER(mid, "yk_get",
             get_in_t, get_out_t,
-            yk_get_ult, provider_id, p->pool);
+            yk_get_ult, provider_id, p->pools.read);
     margo_register_data(mid, id, (void*)p, NULL);
     p->get_id = id;
 
     id = MARGO_REGISTER_PROVIDER(mid, "yk_get_direct",
             get_direct_in_t, get_direct_out_t,
-            yk_get_direct_ult, provider_id, p->pool);
+            yk_get_direct_ult, provider_id, p->pools.read);
     margo_register_data(mid, id, (void*)p, NULL);
     p->get_direct_id = id;
 
     id = MARGO_REGISTER_PROVIDER(mid, "yk_fetch",
             fetch_in_t, fetch_out_t,
-            yk_fetch_ult, provider_id, p->pool);
+            yk_fetch_ult, provider_id, p->pools.read);
     margo_register_data(mid, id, (void*)p, NULL);
     p->fetch_id = id;
 
     id = MARGO_REGISTER_PROVIDER(mid, "yk_fetch_direct",
             fetch_direct_in_t, fetch_direct_out_t,
-            yk_fetch_direct_ult, provider_id, p->pool);
+            yk_fetch_direct_ult, provider_id, p->pools.read);
     margo_register_data(mid, id, (void*)p, NULL);
     p->fetch_direct_id = id;
 
@@ -250,61 +491,61 @@ yk_return_t yk_provider_register(
 
     id = MARGO_REGISTER_PROVIDER(mid, "yk_length",
             length_in_t, length_out_t,
-            yk_length_ult, provider_id, p->pool);
+            yk_length_ult, provider_id, p->pools.read);
     margo_register_data(mid, id, (void*)p, NULL);
     p->length_id = id;
 
     id = MARGO_REGISTER_PROVIDER(mid, "yk_length_direct",
             length_direct_in_t, length_direct_out_t,
-            yk_length_direct_ult, provider_id, p->pool);
+            yk_length_direct_ult, provider_id, p->pools.read);
     margo_register_data(mid, id, (void*)p, NULL);
     p->length_direct_id = id;
 
     id = MARGO_REGISTER_PROVIDER(mid, "yk_exists",
             exists_in_t, exists_out_t,
-            yk_exists_ult, provider_id, p->pool);
+            yk_exists_ult, provider_id, p->pools.read);
     margo_register_data(mid, id, (void*)p, NULL);
     p->exists_id = id;
 
     id = MARGO_REGISTER_PROVIDER(mid, "yk_exists_direct",
             exists_direct_in_t, exists_direct_out_t,
-            yk_exists_direct_ult, provider_id, p->pool);
+            yk_exists_direct_ult, provider_id, p->pools.read);
     margo_register_data(mid, id, (void*)p, NULL);
     p->exists_direct_id = id;
 
     id = MARGO_REGISTER_PROVIDER(mid, "yk_list_keys",
             list_keys_in_t, list_keys_out_t,
-            yk_list_keys_ult, provider_id, p->pool);
+            yk_list_keys_ult, provider_id, p->pools.scan);
     margo_register_data(mid, id, (void*)p, NULL);
     p->list_keys_id = id;
 
     id = MARGO_REGISTER_PROVIDER(mid, "yk_list_keys_direct",
             list_keys_direct_in_t, list_keys_direct_out_t,
-            yk_list_keys_direct_ult, provider_id, p->pool);
+            yk_list_keys_direct_ult, provider_id, p->pools.scan);
     margo_register_data(mid, id, (void*)p, NULL);
     p->list_keys_direct_id = id;
 
     id = MARGO_REGISTER_PROVIDER(mid, "yk_list_keyvals",
             list_keyvals_in_t, list_keyvals_out_t,
-            yk_list_keyvals_ult, provider_id, p->pool);
+            yk_list_keyvals_ult, provider_id, p->pools.scan);
     margo_register_data(mid, id, (void*)p, NULL);
     p->list_keyvals_id = id;
 
     id = MARGO_REGISTER_PROVIDER(mid, "yk_list_keyvals_direct",
             list_keyvals_direct_in_t, list_keyvals_direct_out_t,
-            yk_list_keyvals_direct_ult, provider_id, p->pool);
+            yk_list_keyvals_direct_ult, provider_id, p->pools.scan);
     margo_register_data(mid, id, (void*)p, NULL);
     p->list_keyvals_direct_id = id;
 
     id = MARGO_REGISTER_PROVIDER(mid, "yk_iter",
             iter_in_t, iter_out_t,
-            yk_iter_ult, provider_id, p->pool);
+            yk_iter_ult, provider_id, p->pools.scan);
     margo_register_data(mid, id, (void*)p, NULL);
     p->iter_id = id;
 
     id = MARGO_REGISTER_PROVIDER(mid, "yk_iter_direct",
             iter_in_t, iter_out_t,
-            yk_iter_direct_ult, provider_id, p->pool);
+            yk_iter_direct_ult, provider_id, p->pools.scan);
     margo_register_data(mid, id, (void*)p, NULL);
     p->iter_direct_id = id;
 
@@ -318,57 +559,81 @@ yk_return_t yk_provider_register(
     else p->iter_direct_back_id = MARGO_REGISTER(
         mid, "yk_iter_direct_back", iter_direct_back_in_t, iter_direct_back_out_t, NULL);
 
+    id = MARGO_REGISTER_PROVIDER(mid, "yk_cursor_open",
+            cursor_open_in_t, cursor_open_out_t,
+            yk_cursor_open_ult, provider_id, p->pools.scan);
+    margo_register_data(mid, id, (void*)p, NULL);
+    p->cursor_open_id = id;
+
+    id = MARGO_REGISTER_PROVIDER(mid, "yk_cursor_next",
+            cursor_next_in_t, cursor_next_out_t,
+            yk_cursor_next_ult, provider_id, p->pools.scan);
+    margo_register_data(mid, id, (void*)p, NULL);
+    p->cursor_next_id = id;
+
+    id = MARGO_REGISTER_PROVIDER(mid, "yk_cursor_close",
+            cursor_close_in_t, cursor_close_out_t,
+            yk_cursor_close_ult, provider_id, p->pools.scan);
+    margo_register_data(mid, id, (void*)p, NULL);
+    p->cursor_close_id = id;
+
+    id = MARGO_REGISTER_PROVIDER(mid, "yk_aggregate",
+            aggregate_in_t, aggregate_out_t,
+            yk_aggregate_ult, provider_id, p->pools.scan);
+    margo_register_data(mid, id, (void*)p, NULL);
+    p->aggregate_id = id;
+
     id = MARGO_REGISTER_PROVIDER(mid, "yk_coll_create",
             coll_create_in_t, coll_create_out_t,
-            yk_coll_create_ult, provider_id, p->pool);
+            yk_coll_create_ult, provider_id, p->pools.doc);
     margo_register_data(mid, id, (void*)p, NULL);
     p->coll_create_id = id;
 
     id = MARGO_REGISTER_PROVIDER(mid, "yk_coll_drop",
             coll_drop_in_t, coll_drop_out_t,
-            yk_coll_drop_ult, provider_id, p->pool);
+            yk_coll_drop_ult, provider_id, p->pools.doc);
     margo_register_data(mid, id, (void*)p, NULL);
     p->coll_drop_id = id;
 
     id = MARGO_REGISTER_PROVIDER(mid, "yk_coll_exists",
             coll_exists_in_t, coll_exists_out_t,
-            yk_coll_exists_ult, provider_id, p->pool);
+            yk_coll_exists_ult, provider_id, p->pools.doc);
     margo_register_data(mid, id, (void*)p, NULL);
     p->coll_exists_id = id;
 
     id = MARGO_REGISTER_PROVIDER(mid, "yk_coll_last_id",
             coll_last_id_in_t, coll_last_id_out_t,
-            yk_coll_last_id_ult, provider_id, p->pool);
+            yk_coll_last_id_ult, provider_id, p->pools.doc);
     margo_register_data(mid, id, (void*)p, NULL);
     p->coll_last_id_id = id;
 
     id = MARGO_REGISTER_PROVIDER(mid, "yk_coll_size",
             coll_size_in_t, coll_size_out_t,
-            yk_coll_size_ult, provider_id, p->pool);
+            yk_coll_size_ult, provider_id, p->pools.doc);
     margo_register_data(mid, id, (void*)p, NULL);
     p->coll_size_id = id;
 
     id = MARGO_REGISTER_PROVIDER(mid, "yk_doc_erase",
             doc_erase_in_t, doc_erase_out_t,
-            yk_doc_erase_ult, provider_id, p->pool);
+            yk_doc_erase_ult, provider_id, p->pools.doc);
     margo_register_data(mid, id, (void*)p, NULL);
     p->doc_erase_id = id;
 
     id = MARGO_REGISTER_PROVIDER(mid, "yk_doc_load",
             doc_load_in_t, doc_load_out_t,
-            yk_doc_load_ult, provider_id, p->pool);
+            yk_doc_load_ult, provider_id, p->pools.doc);
     margo_register_data(mid, id, (void*)p, NULL);
     p->doc_load_id = id;
 
     id = MARGO_REGISTER_PROVIDER(mid, "yk_doc_load_direct",
             doc_load_direct_in_t, doc_load_direct_out_t,
-            yk_doc_load_direct_ult, provider_id, p->pool);
+            yk_doc_load_direct_ult, provider_id, p->pools.doc);
     margo_register_data(mid, id, (void*)p, NULL);
     p->doc_load_direct_id = id;
 
     id = MARGO_REGISTER_PROVIDER(mid, "yk_doc_fetch",
             doc_fetch_in_t, doc_fetch_out_t,
-            yk_doc_fetch_ult, provider_id, p->pool);
+            yk_doc_fetch_ult, provider_id, p->pools.doc);
     margo_register_data(mid, id, (void*)p, NULL);
     p->doc_fetch_id = id;
 
@@ -384,58 +649,88 @@ yk_return_t yk_provider_register(
 
     id = MARGO_REGISTER_PROVIDER(mid, "yk_doc_store",
             doc_store_in_t, doc_store_out_t,
-            yk_doc_store_ult, provider_id, p->pool);
+            yk_doc_store_ult, provider_id, p->pools.doc);
     margo_register_data(mid, id, (void*)p, NULL);
     p->doc_store_id = id;
 
     id = MARGO_REGISTER_PROVIDER(mid, "yk_doc_store_direct",
             doc_store_direct_in_t, doc_store_direct_out_t,
-            yk_doc_store_direct_ult, provider_id, p->pool);
+            yk_doc_store_direct_ult, provider_id, p->pools.doc);
     margo_register_data(mid, id, (void*)p, NULL);
     p->doc_store_direct_id = id;
 
     id = MARGO_REGISTER_PROVIDER(mid, "yk_doc_update",
             doc_update_in_t, doc_update_out_t,
-            yk_doc_update_ult, provider_id, p->pool);
+            yk_doc_update_ult, provider_id, p->pools.doc);
     margo_register_data(mid, id, (void*)p, NULL);
     p->doc_update_id = id;
 
     id = MARGO_REGISTER_PROVIDER(mid, "yk_doc_update_direct",
             doc_update_direct_in_t, doc_update_direct_out_t,
-            yk_doc_update_direct_ult, provider_id, p->pool);
+            yk_doc_update_direct_ult, provider_id, p->pools.doc);
     margo_register_data(mid, id, (void*)p, NULL);
     p->doc_update_direct_id = id;
 
     id = MARGO_REGISTER_PROVIDER(mid, "yk_doc_length",
             doc_length_in_t, doc_length_out_t,
-            yk_doc_length_ult, provider_id, p->pool);
+            yk_doc_length_ult, provider_id, p->pools.doc);
     margo_register_data(mid, id, (void*)p, NULL);
     p->doc_length_id = id;
 
     id = MARGO_REGISTER_PROVIDER(mid, "yk_doc_list",
             doc_list_in_t, doc_list_out_t,
-            yk_doc_list_ult, provider_id, p->pool);
+            yk_doc_list_ult, provider_id, p->pools.scan);
     margo_register_data(mid, id, (void*)p, NULL);
     p->doc_list_id = id;
 
     id = MARGO_REGISTER_PROVIDER(mid, "yk_doc_list_direct",
             doc_list_direct_in_t, doc_list_direct_out_t,
-            yk_doc_list_direct_ult, provider_id, p->pool);
+            yk_doc_list_direct_ult, provider_id, p->pools.scan);
     margo_register_data(mid, id, (void*)p, NULL);
     p->doc_list_direct_id = id;
 
     id = MARGO_REGISTER_PROVIDER(mid, "yk_doc_iter",
             doc_iter_in_t, doc_iter_out_t,
-            yk_doc_iter_ult, provider_id, p->pool);
+            yk_doc_iter_ult, provider_id, p->pools.scan);
     margo_register_data(mid, id, (void*)p, NULL);
     p->doc_iter_id = id;
 
     id = MARGO_REGISTER_PROVIDER(mid, "yk_doc_iter_direct",
             doc_iter_in_t, doc_iter_out_t,
-            yk_doc_iter_direct_ult, provider_id, p->pool);
+            yk_doc_iter_direct_ult, provider_id, p->pools.scan);
     margo_register_data(mid, id, (void*)p, NULL);
     p->doc_iter_direct_id = id;
 
+    id = MARGO_REGISTER_PROVIDER(mid, "yk_doc_aggregate",
+            doc_aggregate_in_t, doc_aggregate_out_t,
+            yk_doc_aggregate_ult, provider_id, p->pools.scan);
+    margo_register_data(mid, id, (void*)p, NULL);
+    p->doc_aggregate_id = id;
+
+    id = MARGO_REGISTER_PROVIDER(mid, "yk_coll_create_index",
+            coll_create_index_in_t, coll_create_index_out_t,
+            yk_coll_create_index_ult, provider_id, p->pools.doc);
+    margo_register_data(mid, id, (void*)p, NULL);
+    p->coll_create_index_id = id;
+
+    id = MARGO_REGISTER_PROVIDER(mid, "yk_coll_drop_index",
+            coll_drop_index_in_t, coll_drop_index_out_t,
+            yk_coll_drop_index_ult, provider_id, p->pools.doc);
+    margo_register_data(mid, id, (void*)p, NULL);
+    p->coll_drop_index_id = id;
+
+    id = MARGO_REGISTER_PROVIDER(mid, "yk_doc_query",
+            doc_query_in_t, doc_query_out_t,
+            yk_doc_query_ult, provider_id, p->pools.scan);
+    margo_register_data(mid, id, (void*)p, NULL);
+    p->doc_query_id = id;
+
+    id = MARGO_REGISTER_PROVIDER(mid, "yk_coll_reserve_ids",
+            coll_reserve_ids_in_t, coll_reserve_ids_out_t,
+            yk_coll_reserve_ids_ult, provider_id, p->pools.doc);
+    margo_register_data(mid, id, (void*)p, NULL);
+    p->coll_reserve_ids_id = id;
+
     margo_registered_name(mid, "yk_doc_iter_back", &id, &flag);
     if(flag) p->doc_iter_back_id = id;
     else p->doc_iter_back_id = MARGO_REGISTER(
@@ -448,10 +743,16 @@ yk_return_t yk_provider_register(
 
     id = MARGO_REGISTER_PROVIDER(mid, "yk_get_remi_provider_id",
             void, get_remi_provider_id_out_t,
-            yk_get_remi_provider_id_ult, provider_id, p->pool);
+            yk_get_remi_provider_id_ult, provider_id, p->pools.admin);
     margo_register_data(mid, id, (void*)p, NULL);
     p->get_remi_provider_id = id;
 
+    id = MARGO_REGISTER_PROVIDER(mid, "yk_get_stats",
+            void, get_stats_out_t,
+            yk_get_stats_ult, provider_id, p->pools.admin);
+    margo_register_data(mid, id, (void*)p, NULL);
+    p->get_stats_id = id;
+
     margo_provider_push_finalize_callback(mid, p, &yk_finalize_provider, p);
 
     margo_provider_register_identity(mid, provider_id, "yokan");
@@ -471,6 +772,11 @@ static void yk_finalize_provider(void* p)
         remi_provider_deregister_provider_migration_class(
             provider->remi.provider, "yokan", provider->provider_id);
 #endif
+    yk_provider_clear_cursors(provider);
+    ABT_mutex_free(&provider->cursors.mutex);
+    auto& trace_output = provider->config["tracing"]["output"].get_ref<const std::string&>();
+    if(!trace_output.empty() && !provider->tracer.dump(trace_output.c_str()))
+        YOKAN_LOG_ERROR(mid, "Could not write trace to %s", trace_output.c_str());
     if(provider->db) {
         provider->db->destroy();
         delete provider->db;
@@ -495,6 +801,10 @@ static void yk_finalize_provider(void* p)
     margo_deregister(mid, provider->list_keyvals_id);
     margo_deregister(mid, provider->iter_id);
     margo_deregister(mid, provider->iter_direct_id);
+    margo_deregister(mid, provider->cursor_open_id);
+    margo_deregister(mid, provider->cursor_next_id);
+    margo_deregister(mid, provider->cursor_close_id);
+    margo_deregister(mid, provider->aggregate_id);
     margo_deregister(mid, provider->coll_create_id);
     margo_deregister(mid, provider->coll_drop_id);
     margo_deregister(mid, provider->coll_exists_id);
@@ -512,6 +822,12 @@ static void yk_finalize_provider(void* p)
     margo_deregister(mid, provider->doc_list_id);
     margo_deregister(mid, provider->doc_list_direct_id);
     margo_deregister(mid, provider->doc_iter_id);
+    margo_deregister(mid, provider->doc_aggregate_id);
+    margo_deregister(mid, provider->coll_create_index_id);
+    margo_deregister(mid, provider->coll_drop_index_id);
+    margo_deregister(mid, provider->doc_query_id);
+    margo_deregister(mid, provider->coll_reserve_ids_id);
+    margo_deregister(mid, provider->get_stats_id);
     provider->bulk_cache.finalize(provider->bulk_cache_data);
     delete provider;
     YOKAN_LOG_TRACE(mid, "YOKAN provider successfuly finalized");
@@ -535,6 +851,52 @@ char* yk_provider_get_config(yk_provider_t provider)
     return strdup(provider->config.dump().c_str());
 }
 
+yk_return_t yk_provider_dump_trace(yk_provider_t provider, const char* filename)
+{
+    if(!provider || !filename)
+        return YOKAN_ERR_INVALID_ARGS;
+    if(!provider->tracer.dump(filename))
+        return YOKAN_ERR_IO;
+    return YOKAN_SUCCESS;
+}
+
+char* yk_provider_get_stats(yk_provider_t provider)
+{
+    auto stats = provider->metrics.toJson();
+
+    auto& cache = stats["bulk_cache"] = json::object();
+    if(provider->bulk_cache_stats) {
+        uint64_t hits = 0, misses = 0;
+        provider->bulk_cache_stats(provider->bulk_cache_data, &hits, &misses);
+        cache["hits"]      = hits;
+        cache["misses"]    = misses;
+        cache["hit_ratio"] = (hits + misses) ? (double)hits / (hits + misses) : 0.0;
+    }
+
+    if(provider->hot_keys.enabled())
+        stats["hot_keys"] = provider->hot_keys.toJson();
+
+    auto& pools = stats["pools"] = json::object();
+    std::pair<const char*, ABT_pool> pool_classes[] = {
+        { "read",  provider->pools.read  },
+        { "write", provider->pools.write },
+        { "scan",  provider->pools.scan  },
+        { "doc",   provider->pools.doc   },
+        { "admin", provider->pools.admin }
+    };
+    for(auto& pool_class : pool_classes) {
+        size_t size = 0, total_size = 0;
+        ABT_pool_get_size(pool_class.second, &size);
+        ABT_pool_get_total_size(pool_class.second, &total_size);
+        pools[pool_class.first] = {
+            { "size",       size },       // ULTs waiting to run
+            { "total_size", total_size }  // including blocked ULTs
+        };
+    }
+
+    return strdup(stats.dump().c_str());
+}
+
 static inline yk_return_t get_remi_provider_id_from_remote(
         yk_provider_t provider,
         hg_addr_t dest_address,
@@ -685,6 +1047,7 @@ yk_return_t yk_provider_migrate_database(
     mh.reset();
 
     // clear database locally
+    yk_provider_clear_cursors(provider);
     database->destroy();
     delete provider->db;
     provider->db = nullptr;
@@ -756,7 +1119,7 @@ static inline bool open_database_from_config(yk_provider_t provider)
                 final_db_config[config_entry.key()] = config_entry.value();
         }
         db["config"] = std::move(final_db_config);
-        provider->db = database;
+        provider->db = new yokan::InstrumentedDatabase(provider->metrics, provider->hot_keys, database);
     }
     return true;
 }
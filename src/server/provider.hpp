@@ -10,26 +10,76 @@
 #include "yokan/server.h"
 #include "yokan/backend.hpp"
 #include "yokan/bulk-cache.h"
+#include "util/admission.hpp"
+#include "util/metrics.hpp"
+#include "util/hot_keys.hpp"
+#include "util/instrumented_database.hpp"
+#include "../common/tracing.hpp"
 #include <nlohmann/json.hpp>
 #include <margo.h>
 #include <unordered_map>
+#include <memory>
 #include <string>
 #include <cstring>
 
 using json = nlohmann::json;
 
+/**
+ * @brief Scan cursor kept alive by the provider between cursor_next
+ * RPCs. The cursor is leased: it is discarded if it has not been used
+ * for the provider's lease timeout.
+ */
+struct yk_cursor {
+    ABT_mutex                              mutex;       // serializes cursor_next calls
+    double                                 last_used;   // ABT_get_wtime() of last use
+    int32_t                                mode;        // mode the cursor was opened with
+    std::string                            filter_data; // memory backing the filter
+    std::shared_ptr<yokan::KeyValueFilter> filter;
+    std::unique_ptr<yokan::ScanCursor>     cursor;      // null once cleared
+
+    yk_cursor() { ABT_mutex_create(&mutex); }
+    ~yk_cursor() { ABT_mutex_free(&mutex); }
+};
+
 typedef struct yk_provider {
     /* Margo/Argobots/Mercury environment */
     margo_instance_id  mid;                 // Margo instance
     uint16_t           provider_id;         // Provider id
     ABT_pool           pool;                // Pool on which to post RPC requests
+    struct {
+        ABT_pool read;
+        ABT_pool write;
+        ABT_pool scan;
+        ABT_pool doc;
+        ABT_pool admin;
+    } pools;                                // Per-class pools (default to pool)
     json               config;              // JSON configuration
     yk_bulk_cache      bulk_cache;          // Bulk cache functions
     void*              bulk_cache_data;     // Bulk cache data
+    void (*bulk_cache_stats)(void*, uint64_t*, uint64_t*); // Hits/misses (built-in caches only)
+    size_t             back_rpc_window;     // Max in-flight back-RPCs per fetch/iter
+    size_t             max_reserved_ids;    // Max ids per coll_reserve_ids call
+    struct {
+        size_t threshold;                   // Min keys per segment (0, the default, disables)
+        size_t max_segments;                // Max concurrent segments per batch
+    } batch_split;                          // Splitting of large get/put batches
+    yokan::AdmissionControl admission;      // Limits on in-flight operations
+    yokan::Metrics          metrics;        // RPC and backend counters
+    yokan::Tracer           tracer;         // Sampled request traces
+    yokan::HotKeys          hot_keys;       // Most accessed keys and collections
 
     /* Database */
     yk_database_t db;
 
+    /* Scan cursors */
+    struct {
+        ABT_mutex mutex;
+        uint64_t  next_id;
+        double    lease_timeout;                // seconds
+        size_t    max_cursors;
+        std::unordered_map<uint64_t, std::shared_ptr<yk_cursor>> table;
+    } cursors;
+
     /* RPC identifiers for clients */
     hg_id_t count_id;
     hg_id_t exists_id;
@@ -54,6 +104,10 @@ typedef struct yk_provider {
     hg_id_t iter_direct_id;
     hg_id_t iter_back_id;
     hg_id_t iter_direct_back_id;
+    hg_id_t cursor_open_id;
+    hg_id_t cursor_next_id;
+    hg_id_t cursor_close_id;
+    hg_id_t aggregate_id;
     hg_id_t coll_create_id;
     hg_id_t coll_drop_id;
     hg_id_t coll_exists_id;
@@ -74,9 +128,15 @@ typedef struct yk_provider {
     hg_id_t doc_list_direct_id;
     hg_id_t doc_iter_id;
     hg_id_t doc_iter_direct_id;
+    hg_id_t doc_aggregate_id;
+    hg_id_t coll_create_index_id;
+    hg_id_t coll_drop_index_id;
+    hg_id_t doc_query_id;
+    hg_id_t coll_reserve_ids_id;
     hg_id_t doc_iter_back_id;
     hg_id_t doc_iter_direct_back_id;
     hg_id_t get_remi_provider_id;
+    hg_id_t get_stats_id;
 
     // REMI information
     struct {
@@ -126,6 +186,14 @@ void yk_iter_ult(hg_handle_t h);
 DECLARE_MARGO_RPC_HANDLER(yk_iter_direct_ult)
 void yk_iter_direct_ult(hg_handle_t h);
 DECLARE_MARGO_RPC_HANDLER(yk_iter_ult)
+DECLARE_MARGO_RPC_HANDLER(yk_cursor_open_ult)
+void yk_cursor_open_ult(hg_handle_t h);
+DECLARE_MARGO_RPC_HANDLER(yk_cursor_next_ult)
+void yk_cursor_next_ult(hg_handle_t h);
+DECLARE_MARGO_RPC_HANDLER(yk_cursor_close_ult)
+void yk_cursor_close_ult(hg_handle_t h);
+DECLARE_MARGO_RPC_HANDLER(yk_aggregate_ult)
+void yk_aggregate_ult(hg_handle_t h);
 
 DECLARE_MARGO_RPC_HANDLER(yk_coll_create_ult)
 void yk_coll_create_ult(hg_handle_t h);
@@ -163,7 +231,26 @@ DECLARE_MARGO_RPC_HANDLER(yk_doc_iter_ult)
 void yk_doc_iter_ult(hg_handle_t h);
 DECLARE_MARGO_RPC_HANDLER(yk_doc_iter_direct_ult)
 void yk_doc_iter_direct_ult(hg_handle_t h);
+DECLARE_MARGO_RPC_HANDLER(yk_doc_aggregate_ult)
+void yk_doc_aggregate_ult(hg_handle_t h);
+DECLARE_MARGO_RPC_HANDLER(yk_coll_create_index_ult)
+void yk_coll_create_index_ult(hg_handle_t h);
+DECLARE_MARGO_RPC_HANDLER(yk_coll_drop_index_ult)
+void yk_coll_drop_index_ult(hg_handle_t h);
+DECLARE_MARGO_RPC_HANDLER(yk_doc_query_ult)
+void yk_doc_query_ult(hg_handle_t h);
+DECLARE_MARGO_RPC_HANDLER(yk_coll_reserve_ids_ult)
+void yk_coll_reserve_ids_ult(hg_handle_t h);
 
 DECLARE_MARGO_RPC_HANDLER(yk_get_remi_provider_id_ult)
 void yk_get_remi_provider_id_ult(hg_handle_t h);
+DECLARE_MARGO_RPC_HANDLER(yk_get_stats_ult)
+void yk_get_stats_ult(hg_handle_t h);
+
+/**
+ * @brief Discard all the cursors opened on the provider's database
+ * (used when the database is about to be destroyed). Waits for in-flight
+ * cursor_next calls, which then fail with YOKAN_ERR_EXPIRED.
+ */
+void yk_provider_clear_cursors(yk_provider_t provider);
 #endif
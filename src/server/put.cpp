@@ -9,9 +9,68 @@
 #include "../common/defer.hpp"
 #include "../common/logging.h"
 #include "../common/checks.h"
+#include "util/batch_split.hpp"
 #include <numeric>
 #include <iostream>
 
+/**
+ * Executes a put whose batch has been split into segments. The sizes and
+ * keys must already have been pulled. Each segment pulls its values and
+ * writes them to the database in its own ULT, so value transfers of some
+ * segments overlap with the database accesses of others. The put is
+ * therefore not atomic: if a segment fails (e.g. with YOKAN_MODE_NEW_ONLY
+ * on an existing key, or on a transfer error), the other segments may
+ * already have been written.
+ */
+static yk_return_t put_segments(margo_instance_id mid,
+                                yk_provider_t provider,
+                                const put_in_t& in,
+                                hg_addr_t origin_addr,
+                                yk_buffer_t buffer,
+                                const std::vector<size_t>& segments)
+{
+    const size_t vsizes_offset = in.count*sizeof(size_t);
+    const size_t keys_offset   = vsizes_offset * 2;
+    auto ksizes = reinterpret_cast<size_t*>(buffer->data);
+    auto vsizes = reinterpret_cast<size_t*>(buffer->data + vsizes_offset);
+    auto num_segments = segments.size() - 1;
+
+    // offsets of the keys and values of each segment in the buffer
+    std::vector<size_t> key_offsets(num_segments + 1);
+    std::vector<size_t> val_offsets(num_segments + 1);
+    key_offsets[0] = keys_offset;
+    val_offsets[0] = 0;
+    for(size_t s = 0; s < num_segments; s++) {
+        key_offsets[s+1] = std::accumulate(ksizes + segments[s], ksizes + segments[s+1],
+                                           key_offsets[s]);
+        val_offsets[s+1] = std::accumulate(vsizes + segments[s], vsizes + segments[s+1],
+                                           val_offsets[s]);
+    }
+    for(auto& offset : val_offsets) offset += key_offsets[num_segments];
+
+    return yokan::runSegments(provider->pools.write, num_segments,
+        [&](size_t s) -> yk_return_t {
+            const auto count    = segments[s+1] - segments[s];
+            const auto key_size = key_offsets[s+1] - key_offsets[s];
+            const auto val_size = val_offsets[s+1] - val_offsets[s];
+
+            if(val_size != 0) {
+                hg_return_t hret = margo_bulk_transfer(mid, HG_BULK_PULL, origin_addr,
+                        in.bulk, in.offset + val_offsets[s],
+                        buffer->bulk, val_offsets[s], val_size);
+                CHECK_HRET(hret, margo_bulk_transfer);
+            }
+
+            auto keys = yokan::UserMem{ buffer->data + key_offsets[s], key_size };
+            auto vals = yokan::UserMem{ buffer->data + val_offsets[s], val_size };
+            auto seg_ksizes = yokan::BasicUserMem<size_t>{ ksizes + segments[s], count };
+            auto seg_vsizes = yokan::BasicUserMem<size_t>{ vsizes + segments[s], count };
+
+            return static_cast<yk_return_t>(
+                provider->db->put(in.mode, keys, seg_ksizes, vals, seg_vsizes));
+        });
+}
+
 void yk_put_ult(hg_handle_t h)
 {
     hg_return_t hret;
@@ -21,6 +80,7 @@ void yk_put_ult(hg_handle_t h)
 
     out.ret = YOKAN_SUCCESS;
 
+    yokan::RequestTrace trace;
     DEFER(margo_destroy(h));
     DEFER(margo_respond(h, &out));
 
@@ -30,10 +90,14 @@ void yk_put_ult(hg_handle_t h)
     const struct hg_info* info = margo_get_info(h);
     yk_provider_t provider = (yk_provider_t)margo_registered_data(mid, info->id);
     CHECK_PROVIDER(provider);
+    TRACK_RPC(provider, put);
+    trace.begin(provider->tracer, "server", "put");
 
     hret = margo_get_input(h, &in);
     CHECK_HRET_OUT(hret, margo_get_input);
     DEFER(margo_free_input(h, &in));
+    trace.sample(in.trace_id);
+    trace.stage("get_input");
 
     if(in.origin) {
         hret = margo_addr_lookup(mid, in.origin, &origin_addr);
@@ -47,15 +111,26 @@ void yk_put_ult(hg_handle_t h)
     yk_database* database = provider->db;
     CHECK_DATABASE(database);
     CHECK_MODE_SUPPORTED(database, in.mode);
+    CHECK_ADMISSION(provider, in.size);
 
     yk_buffer_t buffer = provider->bulk_cache.get(
         provider->bulk_cache_data, in.size, HG_BULK_READWRITE);
     CHECK_BUFFER(buffer);
     DEFER(provider->bulk_cache.release(provider->bulk_cache_data, buffer));
 
+    // a batch large enough to be split into segments processed by
+    // concurrent ULTs is pulled in steps (sizes, keys, then the values
+    // of each segment) rather than in a single transfer
+    auto segments = yokan::splitBatch(in.count,
+            provider->batch_split.threshold, provider->batch_split.max_segments);
+    const size_t sizes_size = 2*in.count*sizeof(size_t);
+    const bool may_split = segments.size() > 2 && in.size >= sizes_size;
+
     hret = margo_bulk_transfer(mid, HG_BULK_PULL, origin_addr,
-                               in.bulk, in.offset, buffer->bulk, 0, in.size);
+                               in.bulk, in.offset, buffer->bulk, 0,
+                               may_split ? sizes_size : in.size);
     CHECK_HRET_OUT(hret, margo_bulk_transfer);
+    trace.stage("bulk_pull");
 
     auto ptr = buffer->data;
     auto ksizes = yokan::BasicUserMem<size_t>{
@@ -92,8 +167,33 @@ void yk_put_ult(hg_handle_t h)
 
     auto vals = yokan::UserMem{ ptr, total_vsize };
 
+    if(may_split) {
+        hret = margo_bulk_transfer(mid, HG_BULK_PULL, origin_addr,
+                                   in.bulk, in.offset + sizes_size,
+                                   buffer->bulk, sizes_size, total_ksize);
+        CHECK_HRET_OUT(hret, margo_bulk_transfer);
+        trace.stage("bulk_pull");
+
+        // the segments are executed in no particular order, so a batch
+        // that writes the same key twice is executed serially
+        if(!yokan::hasDuplicateKeys(keys.data, ksizes.data, in.count)) {
+            out.ret = put_segments(mid, provider, in, origin_addr, buffer, segments);
+            trace.stage("segments");
+            return;
+        }
+
+        if(total_vsize != 0) {
+            hret = margo_bulk_transfer(mid, HG_BULK_PULL, origin_addr,
+                                       in.bulk, in.offset + sizes_size + total_ksize,
+                                       buffer->bulk, sizes_size + total_ksize, total_vsize);
+            CHECK_HRET_OUT(hret, margo_bulk_transfer);
+            trace.stage("bulk_pull");
+        }
+    }
+
     out.ret = static_cast<yk_return_t>(
             database->put(in.mode, keys, ksizes, vals, vsizes));
+    trace.stage("backend");
 }
 DEFINE_MARGO_RPC_HANDLER(yk_put_ult)
 
@@ -113,6 +213,7 @@ void yk_put_direct_ult(hg_handle_t h)
     in.vals.size = 0;
     out.ret = YOKAN_SUCCESS;
 
+    yokan::RequestTrace trace;
     DEFER(margo_destroy(h));
     DEFER(margo_respond(h, &out));
 
@@ -122,14 +223,19 @@ void yk_put_direct_ult(hg_handle_t h)
     const struct hg_info* info = margo_get_info(h);
     yk_provider_t provider = (yk_provider_t)margo_registered_data(mid, info->id);
     CHECK_PROVIDER(provider);
+    TRACK_RPC(provider, put_direct);
+    trace.begin(provider->tracer, "server", "put_direct");
 
     hret = margo_get_input(h, &in);
     CHECK_HRET_OUT(hret, margo_get_input);
     DEFER(margo_free_input(h, &in));
+    trace.sample(in.trace_id);
+    trace.stage("get_input");
 
     yk_database* database = provider->db;
     CHECK_DATABASE(database);
     CHECK_MODE_SUPPORTED(database, in.mode);
+    CHECK_ADMISSION(provider, in.keys.size + in.vals.size);
 
     auto ksizes = yokan::BasicUserMem<size_t>{
         in.ksizes.sizes, in.ksizes.count
@@ -154,5 +260,6 @@ void yk_put_direct_ult(hg_handle_t h)
 
     out.ret = static_cast<yk_return_t>(
             database->put(in.mode, keys, ksizes, vals, vsizes));
+    trace.stage("backend");
 }
 DEFINE_MARGO_RPC_HANDLER(yk_put_direct_ult)
@@ -0,0 +1,170 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#ifndef __YOKAN_ADMISSION_HPP
+#define __YOKAN_ADMISSION_HPP
+
+#include "yokan/common.h"
+#include "../../common/types.h"
+#include <abt.h>
+#include <cmath>
+#include <ctime>
+
+namespace yokan {
+
+/**
+ * @brief The AdmissionControl bounds the number of operations a provider
+ * executes concurrently and the number of bytes these operations buffer.
+ * An operation that would exceed either limit waits for others to complete
+ * for at most queue_timeout seconds, after which it is refused with
+ * YOKAN_ERR_TRY_AGAIN. With a queue_timeout of 0, it is refused right away
+ * with YOKAN_ERR_BUSY. A limit of 0 means no limit. An operation larger
+ * than max_bytes on its own is admitted when no other operation is in flight.
+ */
+class AdmissionControl {
+
+    public:
+
+    AdmissionControl() {
+        ABT_mutex_create(&m_mutex);
+        ABT_cond_create(&m_cond);
+    }
+
+    ~AdmissionControl() {
+        ABT_cond_free(&m_cond);
+        ABT_mutex_free(&m_mutex);
+    }
+
+    AdmissionControl(const AdmissionControl&) = delete;
+    AdmissionControl& operator=(const AdmissionControl&) = delete;
+
+    void configure(size_t max_ops, size_t max_bytes, double queue_timeout) {
+        m_max_ops       = max_ops;
+        m_max_bytes     = max_bytes;
+        m_queue_timeout = queue_timeout;
+    }
+
+    bool enabled() const {
+        return m_max_ops != 0 || m_max_bytes != 0;
+    }
+
+    /**
+     * @brief Admits an operation buffering the given number of bytes,
+     * waiting if allowed. On success, release must later be called
+     * with the same number of bytes.
+     */
+    yk_return_t admit(size_t bytes) {
+        if(!enabled()) return YOKAN_SUCCESS;
+        ABT_mutex_lock(m_mutex);
+        if(!fits(bytes) && m_queue_timeout <= 0.0) {
+            ABT_mutex_unlock(m_mutex);
+            return YOKAN_ERR_BUSY;
+        }
+        if(!fits(bytes)) {
+            const double deadline = ABT_get_wtime() + m_queue_timeout;
+            struct timespec ts;
+            clock_gettime(CLOCK_REALTIME, &ts);
+            double whole;
+            double frac = std::modf(m_queue_timeout, &whole);
+            ts.tv_sec  += (time_t)whole;
+            ts.tv_nsec += (long)(frac*1e9);
+            if(ts.tv_nsec >= 1000000000L) {
+                ts.tv_sec  += 1;
+                ts.tv_nsec -= 1000000000L;
+            }
+            while(!fits(bytes)) {
+                if(ABT_get_wtime() >= deadline) {
+                    ABT_mutex_unlock(m_mutex);
+                    return YOKAN_ERR_TRY_AGAIN;
+                }
+                ABT_cond_timedwait(m_cond, m_mutex, &ts);
+            }
+        }
+        m_ops   += 1;
+        m_bytes += bytes;
+        ABT_mutex_unlock(m_mutex);
+        return YOKAN_SUCCESS;
+    }
+
+    void release(size_t bytes) {
+        if(!enabled()) return;
+        ABT_mutex_lock(m_mutex);
+        m_ops   -= 1;
+        m_bytes -= bytes;
+        ABT_cond_broadcast(m_cond);
+        ABT_mutex_unlock(m_mutex);
+    }
+
+    private:
+
+    bool fits(size_t bytes) const {
+        if(m_max_ops && m_ops >= m_max_ops)
+            return false;
+        if(m_max_bytes && m_ops != 0 && m_bytes + bytes > m_max_bytes)
+            return false;
+        return true;
+    }
+
+    ABT_mutex m_mutex         = ABT_MUTEX_NULL;
+    ABT_cond  m_cond          = ABT_COND_NULL;
+    size_t    m_max_ops       = 0;
+    size_t    m_max_bytes     = 0;
+    double    m_queue_timeout = 0.0;
+    size_t    m_ops           = 0;
+    size_t    m_bytes         = 0;
+};
+
+/**
+ * @brief RAII object holding an operation's admission
+ * for the duration of an RPC handler.
+ */
+class AdmissionTicket {
+
+    public:
+
+    AdmissionTicket(AdmissionControl& control, size_t bytes)
+    : m_control(control)
+    , m_bytes(bytes)
+    , m_ret(control.admit(bytes)) {}
+
+    ~AdmissionTicket() {
+        if(m_ret == YOKAN_SUCCESS) m_control.release(m_bytes);
+    }
+
+    AdmissionTicket(const AdmissionTicket&) = delete;
+    AdmissionTicket& operator=(const AdmissionTicket&) = delete;
+
+    yk_return_t ret() const {
+        return m_ret;
+    }
+
+    private:
+
+    AdmissionControl& m_control;
+    size_t            m_bytes;
+    yk_return_t       m_ret;
+};
+
+}
+
+/**
+ * @brief Admits the current RPC into the provider, or responds with
+ * YOKAN_REFUSED_BUSY or YOKAN_REFUSED_TRY_AGAIN (see types.h), which
+ * tell the client that the RPC was not executed and may be forwarded
+ * again. The admission is held until the handler returns.
+ * The bytes are also reported to the handler's TRACK_RPC metrics.
+ */
+#define CHECK_ADMISSION(__pr__, __bytes__) \
+    yokan::AdmissionTicket __admission__{(__pr__)->admission, (size_t)(__bytes__)}; \
+    do { \
+        __rpc_tracker__.setBytes(__bytes__); \
+        if(__admission__.ret() != YOKAN_SUCCESS) { \
+            out.ret = __admission__.ret() == YOKAN_ERR_BUSY ? \
+                YOKAN_REFUSED_BUSY : YOKAN_REFUSED_TRY_AGAIN; \
+            return; \
+        } \
+    } while(0)
+
+#endif
@@ -0,0 +1,93 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#include "aggregator.hpp"
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace yokan {
+
+Aggregator::Aggregator(int32_t type, const char* field, size_t offset,
+                       double hist_min, double hist_max, size_t hist_bins)
+: m_type(static_cast<yk_field_type_t>(type))
+, m_offset(offset)
+, m_hist_min(hist_min)
+, m_hist_max(hist_max) {
+    if(type < YOKAN_FIELD_JSON || type > YOKAN_FIELD_DOUBLE)
+        throw std::invalid_argument("unknown field type");
+    if(hist_bins > YOKAN_AGGREGATE_MAX_BINS)
+        throw std::invalid_argument("too many histogram bins");
+    if(hist_bins && !(hist_min < hist_max))
+        throw std::invalid_argument("empty histogram range");
+    if(m_type == YOKAN_FIELD_JSON)
+        m_paths.add(field ? field : "");
+    if(hist_bins)
+        m_hist_width = (hist_max - hist_min)/hist_bins;
+    std::memset(&m_result, 0, sizeof(m_result));
+    m_result.min       = std::numeric_limits<double>::infinity();
+    m_result.max       = -std::numeric_limits<double>::infinity();
+    m_result.hist_bins = hist_bins;
+}
+
+template<typename T>
+static bool readBinary(const char* data, size_t size, size_t offset, double& x) {
+    if(offset > size || size - offset < sizeof(T)) return false;
+    T value;
+    std::memcpy(&value, data + offset, sizeof(T));
+    x = static_cast<double>(value);
+    return true;
+}
+
+bool Aggregator::extract(const char* data, size_t size, double& x) const {
+    switch(m_type) {
+    case YOKAN_FIELD_INT32:  return readBinary<int32_t>(data, size, m_offset, x);
+    case YOKAN_FIELD_INT64:  return readBinary<int64_t>(data, size, m_offset, x);
+    case YOKAN_FIELD_UINT32: return readBinary<uint32_t>(data, size, m_offset, x);
+    case YOKAN_FIELD_UINT64: return readBinary<uint64_t>(data, size, m_offset, x);
+    case YOKAN_FIELD_FLOAT:  return readBinary<float>(data, size, m_offset, x);
+    case YOKAN_FIELD_DOUBLE: return readBinary<double>(data, size, m_offset, x);
+    case YOKAN_FIELD_JSON:
+        break;
+    }
+    JsonSlice slice;
+    if(!m_paths.extract(data, size, &slice) || !slice.found() || slice.size == 0)
+        return false;
+    if(slice.data[0] != '-' && (slice.data[0] < '0' || slice.data[0] > '9'))
+        return false;
+    // the slice is not null-terminated, and numbers are short
+    char buffer[64];
+    if(slice.size >= sizeof(buffer)) return false;
+    std::memcpy(buffer, slice.data, slice.size);
+    buffer[slice.size] = '\0';
+    char* end = nullptr;
+    x = std::strtod(buffer, &end);
+    return end == buffer + slice.size;
+}
+
+void Aggregator::add(const void* data, size_t size) {
+    m_result.count += 1;
+    double x;
+    if(!data || !extract(static_cast<const char*>(data), size, x) || std::isnan(x))
+        return;
+    m_result.num_values += 1;
+    m_result.sum += x;
+    if(x < m_result.min) m_result.min = x;
+    if(x > m_result.max) m_result.max = x;
+    if(m_result.hist_bins == 0) return;
+    if(x < m_hist_min) {
+        m_result.hist_underflow += 1;
+    } else if(x >= m_hist_max) {
+        m_result.hist_overflow += 1;
+    } else {
+        auto bin = static_cast<size_t>((x - m_hist_min)/m_hist_width);
+        if(bin >= m_result.hist_bins) bin = m_result.hist_bins - 1; // rounding
+        m_result.hist[bin] += 1;
+    }
+}
+
+}
@@ -0,0 +1,75 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#ifndef __YOKAN_AGGREGATOR_HPP
+#define __YOKAN_AGGREGATOR_HPP
+
+#include "yokan/common.h"
+#include "yokan/aggregate.h"
+#include "json_predicate.hpp"
+#include <cstddef>
+#include <string>
+
+namespace yokan {
+
+/**
+ * @brief Computes the count, sum, min, max, and histogram of a numeric
+ * field of the values (or documents) it is fed with, as described by a
+ * yk_aggregate_spec_t. JSON fields are extracted with a JsonPathSet, so
+ * only the part of each value leading to the field is scanned.
+ *
+ * The constructor throws std::invalid_argument if the specification is
+ * invalid (unknown type, too many bins, or empty histogram range).
+ */
+class Aggregator {
+
+    public:
+
+    Aggregator(int32_t type, const char* field, size_t offset,
+               double hist_min, double hist_max, size_t hist_bins);
+
+    /**
+     * @brief Accounts for a value that passed the filter.
+     */
+    void add(const void* data, size_t size);
+
+    const yk_aggregate_t& result() const {
+        return m_result;
+    }
+
+    /**
+     * @brief Fills the output of an aggregate or doc_aggregate RPC.
+     * The histogram is not copied, so the Aggregator must outlive
+     * the response.
+     */
+    template<typename Output>
+    void toOutput(Output& out) {
+        out.count          = m_result.count;
+        out.num_values     = m_result.num_values;
+        out.sum            = m_result.sum;
+        out.min            = m_result.min;
+        out.max            = m_result.max;
+        out.hist_underflow = m_result.hist_underflow;
+        out.hist_overflow  = m_result.hist_overflow;
+        out.hist.count     = m_result.hist_bins;
+        out.hist.sizes     = m_result.hist;
+    }
+
+    private:
+
+    bool extract(const char* data, size_t size, double& x) const;
+
+    yk_field_type_t m_type;
+    JsonPathSet     m_paths;
+    size_t          m_offset;
+    double          m_hist_min;
+    double          m_hist_max;
+    double          m_hist_width = 0.0;
+    yk_aggregate_t  m_result;
+};
+
+}
+
+#endif
@@ -0,0 +1,113 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#ifndef __YOKAN_BACK_RPC_WINDOW_HPP
+#define __YOKAN_BACK_RPC_WINDOW_HPP
+
+#include "yokan/common.h"
+#include "../../common/defer.hpp"
+#include "../../common/logging.h"
+#include "../../common/checks.h"
+#include <margo.h>
+#include <deque>
+#include <memory>
+
+namespace yokan {
+
+/**
+ * @brief The BackRPCWindow keeps track of the back-RPCs (fetch_back,
+ * iter_back, etc.) that a provider has issued to a client and that
+ * have not completed yet. Each back-RPC consumes one credit and gives
+ * it back when the client responds, i.e. once its callbacks for the
+ * batch have completed. With a window of 1, a batch is produced only
+ * while the previous one is in flight.
+ *
+ * BackOutType is the output type of the back-RPC, used to retrieve
+ * the client's return value.
+ */
+template<typename BackOutType>
+class BackRPCWindow {
+
+    public:
+
+    BackRPCWindow(margo_instance_id mid, size_t size)
+    : mid(mid)
+    , m_size(size ? size : 1) {}
+
+    ~BackRPCWindow() {
+        waitAll();
+    }
+
+    /**
+     * @brief Wait until a credit is available. Returns the first
+     * error reported by the back-RPCs that completed meanwhile.
+     */
+    yk_return_t acquire() {
+        yk_return_t ret = YOKAN_SUCCESS;
+        while(m_ops.size() >= m_size) {
+            auto r = waitOldest();
+            if(ret == YOKAN_SUCCESS) ret = r;
+        }
+        return ret;
+    }
+
+    /**
+     * @brief Register a back-RPC that was just forwarded with
+     * margo_iforward. The window takes a reference on the handle
+     * and on the bulk handle (which may be HG_BULK_NULL), and keeps
+     * the payload (memory exposed by the bulk) alive until completion.
+     */
+    void push(hg_handle_t handle, hg_bulk_t bulk, margo_request req,
+              std::shared_ptr<void> payload = nullptr) {
+        margo_ref_incr(handle);
+        if(bulk != HG_BULK_NULL) margo_bulk_ref_incr(bulk);
+        m_ops.push_back(Op{handle, bulk, req, std::move(payload)});
+    }
+
+    /**
+     * @brief Wait for all the in-flight back-RPCs, returning
+     * the first error they reported.
+     */
+    yk_return_t waitAll() {
+        yk_return_t ret = YOKAN_SUCCESS;
+        while(!m_ops.empty()) {
+            auto r = waitOldest();
+            if(ret == YOKAN_SUCCESS) ret = r;
+        }
+        return ret;
+    }
+
+    private:
+
+    struct Op {
+        hg_handle_t           handle;
+        hg_bulk_t             bulk;
+        margo_request         req;
+        std::shared_ptr<void> payload;
+    };
+
+    yk_return_t waitOldest() {
+        auto op = std::move(m_ops.front());
+        m_ops.pop_front();
+        hg_return_t hret = HG_SUCCESS;
+        DEFER(margo_destroy(op.handle));
+        DEFER(if(op.bulk != HG_BULK_NULL) margo_bulk_free(op.bulk));
+        hret = margo_wait(op.req);
+        CHECK_HRET(hret, margo_wait);
+        BackOutType back_out;
+        hret = margo_get_output(op.handle, &back_out);
+        CHECK_HRET(hret, margo_get_output);
+        DEFER(margo_free_output(op.handle, &back_out));
+        return (yk_return_t)back_out.ret;
+    }
+
+    margo_instance_id mid; // named so for CHECK_HRET
+    size_t            m_size;
+    std::deque<Op>    m_ops;
+};
+
+}
+
+#endif
@@ -0,0 +1,99 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#ifndef __YOKAN_BATCH_SPLIT_HPP
+#define __YOKAN_BATCH_SPLIT_HPP
+
+#include "yokan/common.h"
+#include <abt.h>
+#include <algorithm>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+namespace yokan {
+
+/**
+ * @brief Splits a batch of count items into contiguous segments of at
+ * least threshold items each, and at most max_segments segments.
+ * Returns the index at which each segment starts, followed by count,
+ * so a batch that is not split yields { 0, count }. A threshold of 0
+ * disables splitting.
+ */
+inline std::vector<size_t> splitBatch(size_t count, size_t threshold,
+                                      size_t max_segments) {
+    size_t num_segments = 1;
+    if(threshold != 0) num_segments = std::min(count / threshold, max_segments);
+    if(num_segments == 0) num_segments = 1;
+    std::vector<size_t> bounds(num_segments + 1);
+    for(size_t i = 0; i <= num_segments; i++)
+        bounds[i] = (count * i) / num_segments;
+    return bounds;
+}
+
+/**
+ * @brief Returns whether the batch of keys contains the same key twice.
+ * The order in which the segments of a split batch are executed is not
+ * defined, so such batches are executed serially.
+ */
+inline bool hasDuplicateKeys(const char* keys, const size_t* ksizes, size_t count) {
+    std::unordered_set<std::string_view> seen;
+    seen.reserve(count);
+    size_t offset = 0;
+    for(size_t i = 0; i < count; i++) {
+        if(!seen.emplace(keys + offset, ksizes[i]).second)
+            return true;
+        offset += ksizes[i];
+    }
+    return false;
+}
+
+/**
+ * @brief Calls func(i) for each segment i in [0, num_segments), each in
+ * its own ULT posted to the given pool, and waits for all of them.
+ * Returns the first error reported, in segment order. If a ULT cannot be
+ * created, its segment runs in the calling ULT instead.
+ */
+template<typename Func>
+yk_return_t runSegments(ABT_pool pool, size_t num_segments, Func&& func) {
+    if(num_segments == 1) return func(0);
+
+    struct Segment {
+        Func*       func;
+        size_t      index;
+        yk_return_t ret;
+        ABT_thread  ult;
+    };
+    std::vector<Segment> segments(num_segments);
+
+    auto run = [](void* arg) {
+        auto segment = static_cast<Segment*>(arg);
+        segment->ret = (*segment->func)(segment->index);
+    };
+
+    for(size_t i = 0; i < num_segments; i++) {
+        segments[i] = Segment{ &func, i, YOKAN_SUCCESS, ABT_THREAD_NULL };
+        int rret = ABT_thread_create(pool, run, &segments[i],
+                                     ABT_THREAD_ATTR_NULL, &segments[i].ult);
+        if(rret != ABT_SUCCESS) {
+            segments[i].ult = ABT_THREAD_NULL;
+            run(&segments[i]);
+        }
+    }
+
+    yk_return_t ret = YOKAN_SUCCESS;
+    for(auto& segment : segments) {
+        if(segment.ult != ABT_THREAD_NULL) {
+            ABT_thread_join(segment.ult);
+            ABT_thread_free(&segment.ult);
+        }
+        if(ret == YOKAN_SUCCESS) ret = segment.ret;
+    }
+    return ret;
+}
+
+}
+
+#endif
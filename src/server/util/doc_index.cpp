@@ -0,0 +1,263 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#include "yokan/doc-index.hpp"
+#include "json_predicate.hpp"
+#include "../../common/linker.hpp"
+#include "../../common/logging.h"
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+namespace yokan {
+
+/* Numbers are encoded big-endian, with the sign bit of signed integers
+ * flipped and the bits of negative floating-point numbers inverted, so
+ * that their keys sort like the numbers. */
+
+static void appendBigEndian(std::string& key, uint64_t x, size_t size) {
+    for(size_t i = size; i > 0; i--)
+        key.push_back(static_cast<char>(x >> (8*(i-1))));
+}
+
+static bool appendDouble(std::string& key, double x) {
+    if(std::isnan(x)) return false;
+    if(x == 0.0) x = 0.0; // -0.0 and 0.0 must have the same key
+    uint64_t bits;
+    std::memcpy(&bits, &x, sizeof(bits));
+    bits = (bits >> 63) ? ~bits : (bits | (uint64_t(1) << 63));
+    appendBigEndian(key, bits, sizeof(bits));
+    return true;
+}
+
+template<typename T>
+static T readField(const void* data) {
+    T value;
+    std::memcpy(&value, data, sizeof(T));
+    return value;
+}
+
+class BinaryDocIndexer : public DocIndexer {
+
+    yk_field_type_t m_type;
+    size_t          m_offset;
+
+    size_t fieldSize() const {
+        switch(m_type) {
+        case YOKAN_FIELD_INT32:
+        case YOKAN_FIELD_UINT32:
+        case YOKAN_FIELD_FLOAT:
+            return 4;
+        default:
+            return 8;
+        }
+    }
+
+    bool encode(const void* data, std::string& key) const {
+        key.clear();
+        switch(m_type) {
+        case YOKAN_FIELD_INT32:
+            appendBigEndian(key, readField<uint32_t>(data) ^ 0x80000000u, 4);
+            return true;
+        case YOKAN_FIELD_INT64:
+            appendBigEndian(key, readField<uint64_t>(data) ^ (uint64_t(1) << 63), 8);
+            return true;
+        case YOKAN_FIELD_UINT32:
+            appendBigEndian(key, readField<uint32_t>(data), 4);
+            return true;
+        case YOKAN_FIELD_UINT64:
+            appendBigEndian(key, readField<uint64_t>(data), 8);
+            return true;
+        case YOKAN_FIELD_FLOAT:
+            return appendDouble(key, readField<float>(data));
+        default:
+            return appendDouble(key, readField<double>(data));
+        }
+    }
+
+    public:
+
+    BinaryDocIndexer(yk_field_type_t type, size_t offset)
+    : m_type(type)
+    , m_offset(offset) {}
+
+    bool indexKey(const void* doc, size_t docsize, std::string& key) const override {
+        if(m_offset > docsize || docsize - m_offset < fieldSize())
+            return false;
+        return encode(static_cast<const char*>(doc) + m_offset, key);
+    }
+
+    bool boundKey(const void* value, size_t size, std::string& key) const override {
+        if(size != fieldSize()) return false;
+        return encode(value, key);
+    }
+};
+
+/* JSON numbers sort before JSON strings, which are compared by their raw
+ * text (escape sequences are not decoded). Other values are not indexed. */
+class JsonDocIndexer : public DocIndexer {
+
+    static constexpr char NumberTag = '\x01';
+    static constexpr char StringTag = '\x02';
+
+    JsonPathSet m_paths;
+
+    static bool encode(const char* data, size_t size, std::string& key) {
+        key.clear();
+        if(size == 0) return false;
+        if(data[0] == '"') {
+            if(size < 2 || data[size-1] != '"') return false;
+            key.push_back(StringTag);
+            key.append(data + 1, size - 2);
+            return true;
+        }
+        if(data[0] != '-' && (data[0] < '0' || data[0] > '9'))
+            return false;
+        // the data is not null-terminated, and numbers are short
+        char buffer[64];
+        if(size >= sizeof(buffer)) return false;
+        std::memcpy(buffer, data, size);
+        buffer[size] = '\0';
+        char* end = nullptr;
+        double x = std::strtod(buffer, &end);
+        if(end != buffer + size) return false;
+        key.push_back(NumberTag);
+        return appendDouble(key, x);
+    }
+
+    public:
+
+    JsonDocIndexer(const std::string& field) {
+        m_paths.add(field);
+    }
+
+    bool indexKey(const void* doc, size_t docsize, std::string& key) const override {
+        JsonSlice slice;
+        if(!m_paths.extract(static_cast<const char*>(doc), docsize, &slice) || !slice.found())
+            return false;
+        return encode(slice.data, slice.size, key);
+    }
+
+    bool boundKey(const void* value, size_t size, std::string& key) const override {
+        auto data = static_cast<const char*>(value);
+        while(size && std::isspace(static_cast<unsigned char>(data[0]))) {
+            data += 1;
+            size -= 1;
+        }
+        while(size && std::isspace(static_cast<unsigned char>(data[size-1])))
+            size -= 1;
+        return encode(data, size, key);
+    }
+};
+
+/* Keys computed by a user-provided function. Bounds are given as keys. */
+class LibraryDocIndexer : public DocIndexer {
+
+    static constexpr size_t InitialKeySize = 256;
+
+    yk_index_extractor_fn m_function;
+
+    public:
+
+    LibraryDocIndexer(yk_index_extractor_fn function)
+    : m_function(function) {}
+
+    bool indexKey(const void* doc, size_t docsize, std::string& key) const override {
+        key.resize(InitialKeySize);
+        auto ksize = m_function(doc, docsize, &key[0], key.size());
+        if(ksize > key.size()) {
+            key.resize(ksize);
+            ksize = m_function(doc, docsize, &key[0], key.size());
+            if(ksize > key.size()) return false;
+        }
+        key.resize(ksize);
+        return ksize != 0;
+    }
+
+    bool boundKey(const void* value, size_t size, std::string& key) const override {
+        key.assign(static_cast<const char*>(value), size);
+        return size != 0;
+    }
+};
+
+std::shared_ptr<DocIndexer> DocIndexerFactory::makeDocIndexer(const DocIndexSpec& spec) {
+    if(!spec.extractor.empty()) {
+        auto function = Linker::load<yk_index_extractor_fn>(spec.extractor);
+        if(!function) {
+            YOKAN_LOG_ERROR(0, "Could not load index extractor %s", spec.extractor.c_str());
+            return nullptr;
+        }
+        return std::make_shared<LibraryDocIndexer>(function);
+    }
+    if(spec.type == YOKAN_FIELD_JSON)
+        return std::make_shared<JsonDocIndexer>(spec.field);
+    if(spec.type < YOKAN_FIELD_INT32 || spec.type > YOKAN_FIELD_DOUBLE) {
+        YOKAN_LOG_ERROR(0, "Unknown index field type %d", spec.type);
+        return nullptr;
+    }
+    return std::make_shared<BinaryDocIndexer>(
+        static_cast<yk_field_type_t>(spec.type), spec.offset);
+}
+
+/* Definitions are stored as, for each index, the name, field, and
+ * extractor preceded by their size, followed by the type and offset. */
+
+template<typename T>
+static void packValue(std::string& data, const T& value) {
+    data.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+static void packString(std::string& data, const std::string& str) {
+    packValue<uint32_t>(data, str.size());
+    data.append(str);
+}
+
+template<typename T>
+static bool unpackValue(const char*& data, const char* end, T& value) {
+    if(static_cast<size_t>(end - data) < sizeof(value)) return false;
+    std::memcpy(&value, data, sizeof(value));
+    data += sizeof(value);
+    return true;
+}
+
+static bool unpackString(const char*& data, const char* end, std::string& str) {
+    uint32_t size;
+    if(!unpackValue(data, end, size) || static_cast<size_t>(end - data) < size)
+        return false;
+    str.assign(data, size);
+    data += size;
+    return true;
+}
+
+std::string DocIndexSpec::pack(const std::vector<DocIndexSpec>& specs) {
+    std::string data;
+    for(auto& spec : specs) {
+        packString(data, spec.name);
+        packString(data, spec.field);
+        packString(data, spec.extractor);
+        packValue(data, spec.type);
+        packValue(data, spec.offset);
+    }
+    return data;
+}
+
+bool DocIndexSpec::unpack(const char* data, size_t size, std::vector<DocIndexSpec>& specs) {
+    const char* end = data + size;
+    specs.clear();
+    while(data != end) {
+        DocIndexSpec spec;
+        if(!unpackString(data, end, spec.name)
+        || !unpackString(data, end, spec.field)
+        || !unpackString(data, end, spec.extractor)
+        || !unpackValue(data, end, spec.type)
+        || !unpackValue(data, end, spec.offset))
+            return false;
+        specs.push_back(std::move(spec));
+    }
+    return true;
+}
+
+}
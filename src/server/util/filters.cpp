@@ -11,24 +11,56 @@
 #include "../../common/linker.hpp"
 #include "../../common/logging.h"
 #include "config.h"
+#include "json_predicate.hpp"
 #include <algorithm>
 #include <memory>
 #include <cstring>
 #include <iostream>
 #ifdef YOKAN_HAS_LUA
+#include <abt.h>
+#include <array>
+#include <atomic>
+#include <string_view>
 #include <sol/sol.hpp>
 #include "lua-cjson/lua_cjson.h"
 #endif
 
 namespace yokan {
 
+/**
+ * @brief Prefix or suffix of at most 8 bytes, stored as a word and a mask
+ * so that batch checks can compare it against the first or last 8 bytes
+ * of a key with a single masked comparison instead of a memcmp call.
+ */
+struct WordPattern {
+
+    uint64_t m_value = 0;
+    uint64_t m_mask  = 0;
+    bool     m_valid = false;
+
+    WordPattern(const UserMem& pattern, bool at_end) {
+        if(pattern.size > sizeof(uint64_t)) return;
+        auto shift = at_end ? sizeof(uint64_t) - pattern.size : 0;
+        std::memcpy(reinterpret_cast<char*>(&m_value) + shift, pattern.data, pattern.size);
+        std::memset(reinterpret_cast<char*>(&m_mask) + shift, 0xff, pattern.size);
+        m_valid = true;
+    }
+
+    bool matches(const void* word) const {
+        uint64_t x;
+        std::memcpy(&x, word, sizeof(x));
+        return (x & m_mask) == m_value;
+    }
+};
+
 struct KeyPrefixFilter : public KeyValueFilter {
 
-    int32_t m_mode;
-    UserMem m_prefix;
+    int32_t     m_mode;
+    UserMem     m_prefix;
+    WordPattern m_word;
 
     KeyPrefixFilter(int32_t mode, UserMem prefix)
-    : m_mode(mode), m_prefix(std::move(prefix)) {}
+    : m_mode(mode), m_prefix(std::move(prefix)), m_word(m_prefix, false) {}
 
     bool requiresValue() const override {
         return false;
@@ -42,6 +74,20 @@ struct KeyPrefixFilter : public KeyValueFilter {
         return std::memcmp(key, m_prefix.data, m_prefix.size) == 0;
     }
 
+    void checkBatch(const void* const* keys, const size_t* ksizes,
+                    const void* const* vals, const size_t* vsizes,
+                    uint8_t* results, size_t n) const override {
+        (void)vals;
+        (void)vsizes;
+        for(size_t i = 0; i < n; i++) {
+            if(m_word.m_valid && ksizes[i] >= sizeof(uint64_t))
+                results[i] = m_word.matches(keys[i]);
+            else
+                results[i] = m_prefix.size <= ksizes[i]
+                    && std::memcmp(keys[i], m_prefix.data, m_prefix.size) == 0;
+        }
+    }
+
     size_t keySizeFrom(const void* key, size_t ksize) const override {
         (void)key;
         if(m_mode & YOKAN_MODE_NO_PREFIX)
@@ -89,11 +135,12 @@ struct KeyPrefixFilter : public KeyValueFilter {
 
 struct KeySuffixFilter : public KeyValueFilter {
 
-    int32_t m_mode;
-    UserMem m_suffix;
+    int32_t     m_mode;
+    UserMem     m_suffix;
+    WordPattern m_word;
 
     KeySuffixFilter(int32_t mode, UserMem suffix)
-    : m_mode(mode), m_suffix(std::move(suffix)) {}
+    : m_mode(mode), m_suffix(std::move(suffix)), m_word(m_suffix, true) {}
 
     bool requiresValue() const override {
         return false;
@@ -107,6 +154,21 @@ struct KeySuffixFilter : public KeyValueFilter {
         return std::memcmp(((const char*)key)+ksize-m_suffix.size, m_suffix.data, m_suffix.size) == 0;
     }
 
+    void checkBatch(const void* const* keys, const size_t* ksizes,
+                    const void* const* vals, const size_t* vsizes,
+                    uint8_t* results, size_t n) const override {
+        (void)vals;
+        (void)vsizes;
+        for(size_t i = 0; i < n; i++) {
+            auto end = static_cast<const char*>(keys[i]) + ksizes[i];
+            if(m_word.m_valid && ksizes[i] >= sizeof(uint64_t))
+                results[i] = m_word.matches(end - sizeof(uint64_t));
+            else
+                results[i] = m_suffix.size <= ksizes[i]
+                    && std::memcmp(end - m_suffix.size, m_suffix.data, m_suffix.size) == 0;
+        }
+    }
+
     size_t keySizeFrom(const void* key, size_t ksize) const override {
         (void)key;
         if(m_mode & YOKAN_MODE_NO_PREFIX)
@@ -144,30 +206,211 @@ struct KeySuffixFilter : public KeyValueFilter {
 };
 
 #ifdef YOKAN_HAS_LUA
-struct LuaKeyValueFilter : public KeyValueFilter {
+/**
+ * @brief Lua state shared by the filters running on an execution stream,
+ * along with the chunks it has compiled, keyed by their code. Compiled
+ * chunks are reused by any filter with the same code, so that repeated
+ * queries skip parsing and compilation entirely. Code that does not
+ * compile is remembered as well, so that it is not parsed again.
+ */
+class LuaContext {
 
-    int32_t m_mode;
-    UserMem m_code;
-    mutable sol::state m_lua;
+    public:
 
-    LuaKeyValueFilter(int32_t mode, UserMem code)
-    : m_mode(mode), m_code(std::move(code)) {
+    struct Chunk {
+        sol::protected_function function;
+    };
+
+    static constexpr size_t MaxContexts     = 64;
+    static constexpr size_t MaxCachedChunks = 128;
+
+    LuaContext() {
+        ABT_mutex_create(&m_mutex);
         m_lua.open_libraries(sol::lib::base);
         m_lua.open_libraries(sol::lib::string);
         m_lua.open_libraries(sol::lib::math);
+        m_lua.require("cjson", luaopen_cjson);
+    }
+
+    ~LuaContext() {
+        m_chunks.clear();
+        ABT_mutex_free(&m_mutex);
+    }
+
+    LuaContext(const LuaContext&) = delete;
+    LuaContext& operator=(const LuaContext&) = delete;
+
+    /**
+     * @brief Returns the index-th context, creating it if needed.
+     * Contexts live until the process exits.
+     */
+    static LuaContext& at(size_t index) {
+        auto& slot = s_contexts[index];
+        auto ctx = slot.load(std::memory_order_acquire);
+        if(ctx) return *ctx;
+        auto fresh = new LuaContext;
+        if(slot.compare_exchange_strong(ctx, fresh, std::memory_order_acq_rel))
+            return *fresh;
+        delete fresh;
+        return *ctx;
+    }
+
+    /**
+     * @brief Returns the context of the calling execution stream and
+     * locks it. Lua code does not yield, so the lock is only contended
+     * when more than MaxContexts execution streams run filters.
+     */
+    static LuaContext& acquire(size_t* index) {
+        int rank = 0;
+        if(ABT_self_get_xstream_rank(&rank) != ABT_SUCCESS) rank = 0;
+        *index = rank % MaxContexts;
+        auto& ctx = at(*index);
+        ctx.lock();
+        return ctx;
+    }
+
+    void lock() {
+        ABT_mutex_lock(m_mutex);
+    }
+
+    void release() {
+        ABT_mutex_unlock(m_mutex);
+    }
+
+    /**
+     * @brief Returns the compiled chunk for the given code, compiling it
+     * if needed, or nullptr if the code does not compile.
+     */
+    std::shared_ptr<Chunk> compile(std::string_view code) {
+        std::string key{code};
+        auto it = m_chunks.find(key);
+        if(it != m_chunks.end()) return it->second;
+        if(m_chunks.size() >= MaxCachedChunks) m_chunks.clear();
+        auto loaded = m_lua.load(code);
+        std::shared_ptr<Chunk> chunk;
+        if(loaded.valid()) {
+            chunk = std::make_shared<Chunk>();
+            chunk->function = loaded.get<sol::protected_function>();
+        }
+        m_chunks.emplace(std::move(key), chunk);
+        return chunk;
+    }
+
+    /**
+     * @brief Creates an empty environment falling back to the state's
+     * globals for reading.
+     */
+    sol::environment makeEnvironment() {
+        return sol::environment(m_lua, sol::create, m_lua.globals());
+    }
+
+    private:
+
+    sol::state m_lua;
+    std::unordered_map<std::string, std::shared_ptr<Chunk>> m_chunks;
+    ABT_mutex  m_mutex = ABT_MUTEX_NULL;
+
+    static std::atomic<LuaContext*> s_contexts[MaxContexts];
+};
+
+std::atomic<LuaContext*> LuaContext::s_contexts[LuaContext::MaxContexts];
+
+/**
+ * @brief Base for the Lua filters: runs the filter's code, compiled once
+ * per execution stream's LuaContext, after setting its variables.
+ * The code is compiled when the filter is created, which throws
+ * std::invalid_argument if it does not compile. The chunk obtained from
+ * each context is remembered by the filter, so that checking an item
+ * does not even need to look up the cache. Each filter runs its chunks
+ * in its own environment (falling back to the state's globals), so that
+ * the variables set for (or by) a filter are not seen by other filters,
+ * including later queries with the same code. Chunks and environments
+ * are only touched with their context locked, since running them or
+ * releasing them modifies the context's Lua state.
+ */
+class LuaFilterCode {
+
+    struct Slot {
+        std::shared_ptr<LuaContext::Chunk> chunk;
+        sol::environment                   env;
+    };
+
+    public:
+
+    LuaFilterCode(UserMem code)
+    : m_code(std::move(code)) {
+        size_t index = 0;
+        auto& ctx = LuaContext::acquire(&index);
+        bool compiled = prepare(ctx, m_slots[index]);
+        ctx.release();
+        if(!compiled) throw std::invalid_argument{"Lua code does not compile"};
+    }
+
+    ~LuaFilterCode() {
+        // chunks must be released under the lock of their context
+        for(size_t i = 0; i < m_slots.size(); i++) {
+            if(!m_slots[i].chunk) continue;
+            auto& ctx = LuaContext::at(i);
+            ctx.lock();
+            m_slots[i] = Slot{};
+            ctx.release();
+        }
     }
 
+    LuaFilterCode(const LuaFilterCode&) = delete;
+    LuaFilterCode& operator=(const LuaFilterCode&) = delete;
+
+    template<typename SetVariables>
+    bool run(SetVariables&& set_variables) const {
+        size_t index = 0;
+        auto& ctx = LuaContext::acquire(&index);
+        auto& slot = m_slots[index];
+        bool b = false;
+        if(slot.chunk || prepare(ctx, slot)) {
+            // the chunk may be shared with other filters,
+            // so its environment is set before each call
+            slot.env.set_on(slot.chunk->function);
+            set_variables(slot.env);
+            auto result = slot.chunk->function();
+            b = result.valid() && static_cast<bool>(result);
+        }
+        ctx.release();
+        return b;
+    }
+
+    private:
+
+    bool prepare(LuaContext& ctx, Slot& slot) const {
+        slot.chunk = ctx.compile(std::string_view{ m_code.data, m_code.size });
+        if(!slot.chunk) return false;
+        slot.env = ctx.makeEnvironment();
+        return true;
+    }
+
+    UserMem m_code;
+    mutable std::array<Slot, LuaContext::MaxContexts> m_slots;
+};
+
+struct LuaKeyValueFilter : public KeyValueFilter {
+
+    int32_t       m_mode;
+    LuaFilterCode m_code;
+
+    LuaKeyValueFilter(int32_t mode, UserMem code)
+    : m_mode(mode), m_code(std::move(code)) {}
+
     bool requiresValue() const override {
         return m_mode & YOKAN_MODE_FILTER_VALUE;
     }
 
     bool check(const void* key, size_t ksize, const void* val, size_t vsize) const override {
-        m_lua["__key__"] = std::string_view(static_cast<const char*>(key), ksize);
-        if(m_mode & YOKAN_MODE_FILTER_VALUE)
-            m_lua["__value__"] = std::string_view(static_cast<const char*>(val), vsize);
-        auto result = m_lua.do_string(std::string_view{ m_code.data, m_code.size });
-        if(!result.valid()) return false;
-        return static_cast<bool>(result);
+        return m_code.run([&](sol::environment& env) {
+            env["__key__"] = std::string_view(static_cast<const char*>(key), ksize);
+            if(m_mode & YOKAN_MODE_FILTER_VALUE)
+                env["__value__"] = std::string_view(static_cast<const char*>(val), vsize);
+            else
+                env["__value__"] = sol::lua_nil;
+        });
     }
 
     size_t keySizeFrom(const void* key, size_t ksize) const override {
@@ -196,6 +439,46 @@ struct LuaKeyValueFilter : public KeyValueFilter {
 };
 #endif
 
+struct JsonKeyValueFilter : public KeyValueFilter {
+
+    JsonQuery m_query;
+
+    JsonKeyValueFilter(const UserMem& query)
+    : m_query(query.data, query.size) {}
+
+    bool requiresValue() const override {
+        return true;
+    }
+
+    bool check(const void* key, size_t ksize, const void* val, size_t vsize) const override {
+        (void)key;
+        (void)ksize;
+        return m_query.matches(static_cast<const char*>(val), vsize);
+    }
+
+    size_t keySizeFrom(const void* key, size_t ksize) const override {
+        (void)key;
+        return ksize;
+    }
+
+    size_t valSizeFrom(const void* val, size_t vsize) const override {
+        return m_query.sizeFrom(static_cast<const char*>(val), vsize);
+    }
+
+    size_t keyCopy(void* dst, size_t max_dst_size,
+                   const void* key, size_t ksize) const override {
+        if(max_dst_size < ksize) return YOKAN_SIZE_TOO_SMALL;
+        std::memcpy(dst, key, ksize);
+        return ksize;
+    }
+
+    size_t valCopy(void* dst, size_t max_dst_size,
+                   const void* val, size_t vsize) const override {
+        return m_query.copy(static_cast<char*>(dst), max_dst_size,
+                            static_cast<const char*>(val), vsize);
+    }
+};
+
 struct DefaultDocFilter : public DocFilter {
 
     DefaultDocFilter() = default;
@@ -225,28 +508,49 @@ struct DefaultDocFilter : public DocFilter {
     }
 };
 
+struct JsonDocFilter : public DocFilter {
+
+    JsonQuery m_query;
+
+    JsonDocFilter(const UserMem& query)
+    : m_query(query.data, query.size) {}
+
+    bool check(const char* collection, yk_id_t id, const void* val, size_t vsize) const override {
+        (void)collection;
+        (void)id;
+        return m_query.matches(static_cast<const char*>(val), vsize);
+    }
+
+    size_t docSizeFrom(const char* collection, const void* val, size_t vsize) const override {
+        (void)collection;
+        return m_query.sizeFrom(static_cast<const char*>(val), vsize);
+    }
+
+    size_t docCopy(
+          const char* collection,
+          void* dst, size_t max_dst_size,
+          const void* doc, size_t docsize) const override {
+        (void)collection;
+        return m_query.copy(static_cast<char*>(dst), max_dst_size,
+                            static_cast<const char*>(doc), docsize);
+    }
+};
+
 #ifdef YOKAN_HAS_LUA
 struct LuaDocFilter : public DocFilter {
 
-    int32_t m_mode;
-    UserMem m_code;
-    mutable sol::state m_lua;
+    int32_t       m_mode;
+    LuaFilterCode m_code;
 
     LuaDocFilter(int32_t mode, UserMem code)
-    : m_mode(mode), m_code(std::move(code)) {
-        m_lua.open_libraries(sol::lib::base);
-        m_lua.open_libraries(sol::lib::string);
-        m_lua.open_libraries(sol::lib::math);
-        m_lua.require("cjson", luaopen_cjson);
-    }
+    : m_mode(mode), m_code(std::move(code)) {}
 
     bool check(const char* collection, yk_id_t id, const void* val, size_t vsize) const override {
-        m_lua["__collection__"] = std::string{collection};
-        m_lua["__id__"] = id;
-        m_lua["__doc__"] = std::string_view(static_cast<const char*>(val), vsize);
-        auto result = m_lua.do_string(std::string_view{ m_code.data, m_code.size });
-        if(!result.valid()) return false;
-        return static_cast<bool>(result);
+        return m_code.run([&](sol::environment& env) {
+            env["__collection__"] = std::string_view{collection};
+            env["__id__"] = id;
+            env["__doc__"] = std::string_view(static_cast<const char*>(val), vsize);
+        });
     }
 
     size_t docSizeFrom(const char* collection, const void* val, size_t vsize) const override {
@@ -300,6 +604,37 @@ struct CollectionFilterWrapper : public KeyPrefixFilter  {
         return m_doc_filter->check(m_coll_name.c_str(), id, val, vsize);
     }
 
+    void checkBatch(const void* const* keys, const size_t* ksizes,
+                    const void* const* vals, const size_t* vsizes,
+                    uint8_t* results, size_t n) const override {
+        KeyPrefixFilter::checkBatch(keys, ksizes, vals, vsizes, results, n);
+        for(size_t i = 0; i < n; i++)
+            results[i] = results[i] && ksizes[i] == m_key_offset + sizeof(yk_id_t);
+        if(!m_doc_filter) return;
+        // forward the documents that passed to the document filter, by blocks
+        constexpr size_t block = 64;
+        size_t      index[block];
+        yk_id_t     ids[block];
+        const void* docs[block];
+        size_t      docsizes[block];
+        uint8_t     passed[block];
+        for(size_t i = 0; i < n; ) {
+            size_t m = 0;
+            for(; i < n && m < block; i++) {
+                if(!results[i]) continue;
+                std::memcpy(&ids[m], (const char*)keys[i] + m_key_offset, sizeof(yk_id_t));
+                ids[m]      = _ensureBigEndian(ids[m]);
+                docs[m]     = vals[i];
+                docsizes[m] = vsizes[i];
+                index[m]    = i;
+                m += 1;
+            }
+            m_doc_filter->checkBatch(m_coll_name.c_str(), ids, docs, docsizes, passed, m);
+            for(size_t j = 0; j < m; j++)
+                results[index[j]] = passed[j];
+        }
+    }
+
     size_t valSizeFrom(const void* val, size_t vsize) const override {
         return m_doc_filter->docSizeFrom(m_coll_name.c_str(), val, vsize);
     }
@@ -335,12 +670,23 @@ std::shared_ptr<KeyValueFilter> FilterFactory::makeKeyValueFilter(
         margo_instance_id mid, int32_t mode, const UserMem& filter_data) {
     if(mode & YOKAN_MODE_LUA_FILTER) {
 #ifdef YOKAN_HAS_LUA
-        (void)mid;
-        return std::make_shared<LuaKeyValueFilter>(mode, filter_data);
+        try {
+            return std::make_shared<LuaKeyValueFilter>(mode, filter_data);
+        } catch(const std::invalid_argument& ex) {
+            YOKAN_LOG_ERROR(mid, "Invalid Lua filter: %s", ex.what());
+            return nullptr;
+        }
 #else
         YOKAN_LOG_ERROR(mid, "Yokan wasn't compiled with Lua support!");
         return nullptr;
 #endif
+    } else if(mode & YOKAN_MODE_JSON_FILTER) {
+        try {
+            return std::make_shared<JsonKeyValueFilter>(filter_data);
+        } catch(const std::invalid_argument& ex) {
+            YOKAN_LOG_ERROR(mid, "Invalid JSON filter: %s", ex.what());
+            return nullptr;
+        }
     } else if(mode & YOKAN_MODE_LIB_FILTER) {
         const char* c1 = std::find(filter_data.data, filter_data.data + filter_data.size, ':');
         if(c1 == filter_data.data + filter_data.size) {
@@ -377,12 +723,23 @@ std::shared_ptr<DocFilter> FilterFactory::makeDocFilter(
         margo_instance_id mid, int32_t mode, const UserMem& filter_data) {
     if(mode & YOKAN_MODE_LUA_FILTER) {
 #ifdef YOKAN_HAS_LUA
-        (void)mid;
-        return std::make_shared<LuaDocFilter>(mode, filter_data);
+        try {
+            return std::make_shared<LuaDocFilter>(mode, filter_data);
+        } catch(const std::invalid_argument& ex) {
+            YOKAN_LOG_ERROR(mid, "Invalid Lua filter: %s", ex.what());
+            return nullptr;
+        }
 #else
         YOKAN_LOG_ERROR(mid, "Yokan wasn't compiled with Lua support!");
         return nullptr;
 #endif
+    } else if(mode & YOKAN_MODE_JSON_FILTER) {
+        try {
+            return std::make_shared<JsonDocFilter>(filter_data);
+        } catch(const std::invalid_argument& ex) {
+            YOKAN_LOG_ERROR(mid, "Invalid JSON filter: %s", ex.what());
+            return nullptr;
+        }
     } else if(mode & YOKAN_MODE_LIB_FILTER) {
         const char* c1 = std::find(filter_data.data, filter_data.data + filter_data.size, ':');
         if(c1 == filter_data.data + filter_data.size) {
@@ -406,7 +763,12 @@ std::shared_ptr<DocFilter> FilterFactory::makeDocFilter(
             YOKAN_LOG_ERROR(mid, "Could not find filter with name %s in FilterFactory", filter_name.c_str());
             return nullptr;
         }
-        return (it->second)(mid, mode, filter_args);
+        try {
+            return (it->second)(mid, mode, filter_args);
+        } catch(const std::invalid_argument& ex) {
+            YOKAN_LOG_ERROR(mid, "Invalid %s filter: %s", filter_name.c_str(), ex.what());
+            return nullptr;
+        }
     }
     return std::make_shared<DefaultDocFilter>();
 }
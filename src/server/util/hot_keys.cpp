@@ -0,0 +1,120 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#include "hot_keys.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace yokan {
+
+using json = nlohmann::json;
+
+void SpaceSaving::add(const char* data, size_t size, uint64_t weight) {
+    if(m_capacity == 0) return;
+    std::string key{data, size};
+    auto it = m_index.find(key);
+    if(it != m_index.end()) {
+        size_t i = it->second;
+        m_heap[i].count += weight;
+        siftDown(i);
+        return;
+    }
+    if(m_heap.size() < m_capacity) {
+        m_heap.push_back(Entry{key, weight, 0});
+        m_index.emplace(std::move(key), m_heap.size() - 1);
+        siftUp(m_heap.size() - 1);
+        return;
+    }
+    // replace the item with the smallest count
+    auto& min = m_heap[0];
+    m_index.erase(min.key);
+    min.error  = min.count;
+    min.count += weight;
+    min.key    = key;
+    m_index.emplace(std::move(key), 0);
+    siftDown(0);
+}
+
+std::vector<SpaceSaving::Entry> SpaceSaving::top() const {
+    std::vector<Entry> result = m_heap;
+    std::sort(result.begin(), result.end(),
+              [](const Entry& a, const Entry& b) { return a.count > b.count; });
+    return result;
+}
+
+void SpaceSaving::swapEntries(size_t i, size_t j) {
+    std::swap(m_heap[i], m_heap[j]);
+    m_index[m_heap[i].key] = i;
+    m_index[m_heap[j].key] = j;
+}
+
+void SpaceSaving::siftDown(size_t i) {
+    const size_t n = m_heap.size();
+    while(true) {
+        size_t smallest = i;
+        size_t l = 2*i + 1, r = 2*i + 2;
+        if(l < n && m_heap[l].count < m_heap[smallest].count) smallest = l;
+        if(r < n && m_heap[r].count < m_heap[smallest].count) smallest = r;
+        if(smallest == i) return;
+        swapEntries(i, smallest);
+        i = smallest;
+    }
+}
+
+void SpaceSaving::siftUp(size_t i) {
+    while(i > 0) {
+        size_t parent = (i - 1)/2;
+        if(m_heap[parent].count <= m_heap[i].count) return;
+        swapEntries(i, parent);
+        i = parent;
+    }
+}
+
+static bool printable(const std::string& key) {
+    return std::all_of(key.begin(), key.end(),
+                       [](char c) { return c >= 0x20 && c < 0x7f; });
+}
+
+static std::string hexEncode(const std::string& key) {
+    static const char digits[] = "0123456789abcdef";
+    std::string hex;
+    hex.reserve(2*key.size());
+    for(unsigned char c : key) {
+        hex += digits[c >> 4];
+        hex += digits[c & 0xf];
+    }
+    return hex;
+}
+
+json HotKeys::toJson() const {
+    std::vector<SpaceSaving::Entry> keys, collections;
+    double rate;
+    ABT_mutex_lock(m_mutex);
+    keys        = m_keys.top();
+    collections = m_collections.top();
+    rate        = m_sample_rate.load(std::memory_order_relaxed);
+    ABT_mutex_unlock(m_mutex);
+    auto toArray = [rate](const std::vector<SpaceSaving::Entry>& entries) {
+        auto array = json::array();
+        for(auto& e : entries) {
+            bool text = printable(e.key);
+            array.push_back({
+                { "key",       text ? e.key : hexEncode(e.key) },
+                { "encoding",  text ? "text" : "hex" },
+                { "count",     e.count },
+                { "error",     e.error },
+                { "estimated", rate > 0.0 ? (uint64_t)(e.count / rate) : 0 }
+            });
+        }
+        return array;
+    };
+    return json{
+        { "sample_rate", rate },
+        { "keys",        toArray(keys) },
+        { "collections", toArray(collections) }
+    };
+}
+
+}
@@ -0,0 +1,166 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#ifndef __YOKAN_HOT_KEYS_HPP
+#define __YOKAN_HOT_KEYS_HPP
+
+#include "yokan/common.h"
+#include <nlohmann/json.hpp>
+#include <abt.h>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "yokan/usermem.hpp"
+
+namespace yokan {
+
+/**
+ * @brief Space-Saving sketch of the most frequent items of a stream.
+ * It keeps at most `capacity` counters; an item that is not monitored
+ * replaces the item with the smallest counter, inheriting its count
+ * (which becomes the item's maximum overestimation, its "error").
+ * Any item occurring more than N/capacity times in a stream of N
+ * occurrences is guaranteed to be monitored. Counters are kept in a
+ * binary min-heap so that each update costs O(log capacity).
+ * This class is not thread-safe.
+ */
+class SpaceSaving {
+
+    public:
+
+    struct Entry {
+        std::string key;
+        uint64_t    count;
+        uint64_t    error;
+    };
+
+    explicit SpaceSaving(size_t capacity = 0)
+    : m_capacity(capacity) {}
+
+    void setCapacity(size_t capacity) {
+        m_capacity = capacity;
+        m_heap.clear();
+        m_index.clear();
+    }
+
+    void add(const char* data, size_t size, uint64_t weight = 1);
+
+    /**
+     * @brief Returns the monitored items sorted by decreasing count.
+     */
+    std::vector<Entry> top() const;
+
+    private:
+
+    void siftDown(size_t i);
+    void siftUp(size_t i);
+    void swapEntries(size_t i, size_t j);
+
+    size_t                                  m_capacity;
+    std::vector<Entry>                      m_heap;
+    std::unordered_map<std::string, size_t> m_index; // key -> position in m_heap
+};
+
+/**
+ * @brief Tracks the hottest keys (touched by get, fetch, put, and erase)
+ * and collections (touched by document operations) of a database.
+ * Each key access is sampled with the configured rate, so that only a
+ * fraction of the accesses take the sketch's lock; when disabled, the
+ * cost is one relaxed atomic load per backend call.
+ */
+class HotKeys {
+
+    public:
+
+    HotKeys() {
+        ABT_mutex_create(&m_mutex);
+    }
+
+    ~HotKeys() {
+        ABT_mutex_free(&m_mutex);
+    }
+
+    HotKeys(const HotKeys&) = delete;
+    HotKeys& operator=(const HotKeys&) = delete;
+
+    void configure(bool enabled, size_t capacity, double sample_rate) {
+        ABT_mutex_lock(m_mutex);
+        m_keys.setCapacity(capacity);
+        m_collections.setCapacity(capacity);
+        m_sample_rate.store(sample_rate, std::memory_order_relaxed);
+        ABT_mutex_unlock(m_mutex);
+        m_enabled.store(enabled && capacity > 0 && sample_rate > 0.0,
+                        std::memory_order_relaxed);
+    }
+
+    bool enabled() const {
+        return m_enabled.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Records accesses to the keys packed in the keys buffer.
+     */
+    void touchKeys(const UserMem& keys, const BasicUserMem<size_t>& ksizes) {
+        if(!enabled()) return;
+        size_t offset = 0;
+        for(size_t i = 0; i < ksizes.size; i++) {
+            if(offset + ksizes[i] > keys.size) break;
+            if(sample()) {
+                ABT_mutex_lock(m_mutex);
+                m_keys.add((const char*)keys.data + offset, ksizes[i]);
+                ABT_mutex_unlock(m_mutex);
+            }
+            offset += ksizes[i];
+        }
+    }
+
+    /**
+     * @brief Records an access to num_docs documents of a collection.
+     */
+    void touchCollection(const char* name, size_t num_docs = 1) {
+        if(!enabled() || !name) return;
+        uint64_t weight = 0;
+        for(size_t i = 0; i < num_docs; i++)
+            weight += sample() ? 1 : 0;
+        if(weight == 0) return;
+        ABT_mutex_lock(m_mutex);
+        m_collections.add(name, strlen(name), weight);
+        ABT_mutex_unlock(m_mutex);
+    }
+
+    /**
+     * @brief Returns a JSON object with the sample rate and the "keys"
+     * and "collections" arrays, each entry having the item, its sampled
+     * count, its maximum overestimation, and its estimated number of
+     * accesses. Keys that are not printable ASCII are hex-encoded,
+     * which the "encoding" field of each entry ("text" or "hex") tells.
+     */
+    nlohmann::json toJson() const;
+
+    private:
+
+    bool sample() const {
+        double rate = m_sample_rate.load(std::memory_order_relaxed);
+        if(rate >= 1.0) return true;
+        static thread_local std::minstd_rand rng{std::random_device{}()};
+        std::uniform_real_distribution<double> dist(0.0, 1.0);
+        return dist(rng) < rate;
+    }
+
+    std::atomic<bool>   m_enabled{false};
+    std::atomic<double> m_sample_rate{0.0};
+    SpaceSaving         m_keys;
+    SpaceSaving         m_collections;
+    ABT_mutex           m_mutex = ABT_MUTEX_NULL;
+};
+
+}
+
+#endif
@@ -0,0 +1,328 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#ifndef __YOKAN_INSTRUMENTED_DATABASE_HPP
+#define __YOKAN_INSTRUMENTED_DATABASE_HPP
+
+#include "yokan/backend.hpp"
+#include "metrics.hpp"
+#include "hot_keys.hpp"
+#include <chrono>
+
+namespace yokan {
+
+/**
+ * @brief DatabaseInterface forwarding every call to the database it wraps
+ * (and owns) while recording its duration and outcome in a Metrics object,
+ * and the keys and collections it accesses in a HotKeys object.
+ * The duration of fetch, iter, docFetch, and docIter includes the time
+ * spent in the callbacks, i.e. sending results back to the client.
+ */
+class InstrumentedDatabase : public DatabaseInterface {
+
+    public:
+
+    InstrumentedDatabase(Metrics& metrics, HotKeys& hot_keys, DatabaseInterface* db)
+    : m_metrics(metrics)
+    , m_hot_keys(hot_keys)
+    , m_db(db) {}
+
+    ~InstrumentedDatabase() {
+        delete m_db;
+    }
+
+    InstrumentedDatabase(const InstrumentedDatabase&) = delete;
+    InstrumentedDatabase& operator=(const InstrumentedDatabase&) = delete;
+
+    std::string type() const override {
+        return m_db->type();
+    }
+
+    std::string config() const override {
+        return m_db->config();
+    }
+
+    void destroy() override {
+        m_db->destroy();
+    }
+
+    bool supportsMode(int32_t mode) const override {
+        return m_db->supportsMode(mode);
+    }
+
+    bool isSorted() const override {
+        return m_db->isSorted();
+    }
+
+    Status count(int32_t mode, uint64_t* c) const override {
+        return track(BackendCall::count, [&]() {
+            return m_db->count(mode, c);
+        });
+    }
+
+    Status exists(int32_t mode, const UserMem& keys,
+                  const BasicUserMem<size_t>& ksizes,
+                  BitField& b) const override {
+        return track(BackendCall::exists, [&]() {
+            return m_db->exists(mode, keys, ksizes, b);
+        });
+    }
+
+    Status length(int32_t mode, const UserMem& keys,
+                  const BasicUserMem<size_t>& ksizes,
+                  BasicUserMem<size_t>& vsizes) const override {
+        return track(BackendCall::length, [&]() {
+            return m_db->length(mode, keys, ksizes, vsizes);
+        });
+    }
+
+    Status put(int32_t mode, const UserMem& keys,
+               const BasicUserMem<size_t>& ksizes,
+               const UserMem& vals,
+               const BasicUserMem<size_t>& vsizes) override {
+        m_hot_keys.touchKeys(keys, ksizes);
+        return track(BackendCall::put, [&]() {
+            return m_db->put(mode, keys, ksizes, vals, vsizes);
+        });
+    }
+
+    Status get(int32_t mode, bool packed, const UserMem& keys,
+               const BasicUserMem<size_t>& ksizes,
+               UserMem& vals,
+               BasicUserMem<size_t>& vsizes) override {
+        m_hot_keys.touchKeys(keys, ksizes);
+        return track(BackendCall::get, [&]() {
+            return m_db->get(mode, packed, keys, ksizes, vals, vsizes);
+        });
+    }
+
+    Status fetch(int32_t mode, const UserMem& keys,
+                 const BasicUserMem<size_t>& ksizes,
+                 const FetchCallback& func) override {
+        m_hot_keys.touchKeys(keys, ksizes);
+        return track(BackendCall::fetch, [&]() {
+            return m_db->fetch(mode, keys, ksizes, func);
+        });
+    }
+
+    Status erase(int32_t mode, const UserMem& keys,
+                 const BasicUserMem<size_t>& ksizes) override {
+        m_hot_keys.touchKeys(keys, ksizes);
+        return track(BackendCall::erase, [&]() {
+            return m_db->erase(mode, keys, ksizes);
+        });
+    }
+
+    Status eraseRange(int32_t mode, const UserMem& fromKey,
+                      const UserMem& toKey) override {
+        return track(BackendCall::eraseRange, [&]() {
+            return m_db->eraseRange(mode, fromKey, toKey);
+        });
+    }
+
+    Status listKeys(int32_t mode, bool packed, const UserMem& fromKey,
+                    const std::shared_ptr<KeyValueFilter>& filter,
+                    UserMem& keys, BasicUserMem<size_t>& keySizes) const override {
+        return track(BackendCall::listKeys, [&]() {
+            return m_db->listKeys(mode, packed, fromKey, filter, keys, keySizes);
+        });
+    }
+
+    Status listKeyValues(int32_t mode, bool packed,
+                         const UserMem& fromKey,
+                         const std::shared_ptr<KeyValueFilter>& filter,
+                         UserMem& keys,
+                         BasicUserMem<size_t>& keySizes,
+                         UserMem& vals,
+                         BasicUserMem<size_t>& valSizes) const override {
+        return track(BackendCall::listKeyValues, [&]() {
+            return m_db->listKeyValues(mode, packed, fromKey, filter,
+                                       keys, keySizes, vals, valSizes);
+        });
+    }
+
+    Status iter(int32_t mode, uint64_t max, const UserMem& fromKey,
+                const std::shared_ptr<KeyValueFilter>& filter,
+                bool ignore_values,
+                const IterCallback& func) const override {
+        return track(BackendCall::iter, [&]() {
+            return m_db->iter(mode, max, fromKey, filter, ignore_values, func);
+        });
+    }
+
+    Status openCursor(int32_t mode, const UserMem& fromKey,
+                      const std::shared_ptr<KeyValueFilter>& filter,
+                      std::unique_ptr<ScanCursor>& cursor) const override {
+        return track(BackendCall::openCursor, [&]() {
+            return m_db->openCursor(mode, fromKey, filter, cursor);
+        });
+    }
+
+    Status collCreate(int32_t mode, const char* name) override {
+        return track(BackendCall::collCreate, [&]() {
+            return m_db->collCreate(mode, name);
+        });
+    }
+
+    Status collDrop(int32_t mode, const char* name) override {
+        return track(BackendCall::collDrop, [&]() {
+            return m_db->collDrop(mode, name);
+        });
+    }
+
+    Status collExists(int32_t mode, const char* name, bool* flag) const override {
+        return track(BackendCall::collExists, [&]() {
+            return m_db->collExists(mode, name, flag);
+        });
+    }
+
+    Status collLastID(int32_t mode, const char* name, yk_id_t* id) const override {
+        return track(BackendCall::collLastID, [&]() {
+            return m_db->collLastID(mode, name, id);
+        });
+    }
+
+    Status collSize(int32_t mode, const char* name, size_t* size) const override {
+        return track(BackendCall::collSize, [&]() {
+            return m_db->collSize(mode, name, size);
+        });
+    }
+
+    Status collReserveIDs(int32_t mode, const char* name,
+                          size_t count, yk_id_t* first_id) override {
+        return track(BackendCall::collReserveIDs, [&]() {
+            return m_db->collReserveIDs(mode, name, count, first_id);
+        });
+    }
+
+    Status docSize(const char* collection, int32_t mode,
+                   const BasicUserMem<yk_id_t>& ids,
+                   BasicUserMem<size_t>& sizes) const override {
+        m_hot_keys.touchCollection(collection, ids.size);
+        return track(BackendCall::docSize, [&]() {
+            return m_db->docSize(collection, mode, ids, sizes);
+        });
+    }
+
+    Status docStore(const char* collection, int32_t mode,
+                    const UserMem& documents,
+                    const BasicUserMem<size_t>& sizes,
+                    BasicUserMem<yk_id_t>& ids) override {
+        m_hot_keys.touchCollection(collection, sizes.size);
+        return track(BackendCall::docStore, [&]() {
+            return m_db->docStore(collection, mode, documents, sizes, ids);
+        });
+    }
+
+    Status docUpdate(const char* collection, int32_t mode,
+                     const BasicUserMem<yk_id_t>& ids,
+                     const UserMem& documents,
+                     const BasicUserMem<size_t>& sizes) override {
+        m_hot_keys.touchCollection(collection, ids.size);
+        return track(BackendCall::docUpdate, [&]() {
+            return m_db->docUpdate(collection, mode, ids, documents, sizes);
+        });
+    }
+
+    Status docLoad(const char* collection, int32_t mode, bool packed,
+                   const BasicUserMem<yk_id_t>& ids,
+                   UserMem& documents,
+                   BasicUserMem<size_t>& sizes) override {
+        m_hot_keys.touchCollection(collection, ids.size);
+        return track(BackendCall::docLoad, [&]() {
+            return m_db->docLoad(collection, mode, packed, ids, documents, sizes);
+        });
+    }
+
+    Status docFetch(const char* collection, int32_t mode,
+                    const BasicUserMem<yk_id_t>& ids,
+                    const DocFetchCallback& func) override {
+        m_hot_keys.touchCollection(collection, ids.size);
+        return track(BackendCall::docFetch, [&]() {
+            return m_db->docFetch(collection, mode, ids, func);
+        });
+    }
+
+    Status docErase(const char* collection, int32_t mode,
+                    const BasicUserMem<yk_id_t>& ids) override {
+        m_hot_keys.touchCollection(collection, ids.size);
+        return track(BackendCall::docErase, [&]() {
+            return m_db->docErase(collection, mode, ids);
+        });
+    }
+
+    Status docList(const char* collection, int32_t mode, bool packed,
+                   yk_id_t from_id,
+                   const std::shared_ptr<DocFilter>& filter,
+                   BasicUserMem<yk_id_t>& ids,
+                   UserMem& documents,
+                   BasicUserMem<size_t>& doc_sizes) const override {
+        m_hot_keys.touchCollection(collection);
+        return track(BackendCall::docList, [&]() {
+            return m_db->docList(collection, mode, packed, from_id, filter,
+                                 ids, documents, doc_sizes);
+        });
+    }
+
+    Status docIter(const char* collection, int32_t mode, uint64_t max,
+                   yk_id_t from_id,
+                   const std::shared_ptr<DocFilter>& filter,
+                   const DocIterCallback& func) const override {
+        m_hot_keys.touchCollection(collection);
+        return track(BackendCall::docIter, [&]() {
+            return m_db->docIter(collection, mode, max, from_id, filter, func);
+        });
+    }
+
+    Status collCreateIndex(int32_t mode, const char* collection,
+                           const DocIndexSpec& spec) override {
+        return track(BackendCall::collCreateIndex, [&]() {
+            return m_db->collCreateIndex(mode, collection, spec);
+        });
+    }
+
+    Status collDropIndex(int32_t mode, const char* collection,
+                         const char* index) override {
+        return track(BackendCall::collDropIndex, [&]() {
+            return m_db->collDropIndex(mode, collection, index);
+        });
+    }
+
+    Status docQuery(const char* collection, int32_t mode, const char* index,
+                    const UserMem* lower, const UserMem* upper,
+                    const UserMem& after,
+                    BasicUserMem<yk_id_t>& ids,
+                    std::string& last) const override {
+        m_hot_keys.touchCollection(collection);
+        return track(BackendCall::docQuery, [&]() {
+            return m_db->docQuery(collection, mode, index, lower, upper, after, ids, last);
+        });
+    }
+
+    Status startMigration(std::unique_ptr<MigrationHandle>& mh) override {
+        return m_db->startMigration(mh);
+    }
+
+    private:
+
+    template<typename Func>
+    Status track(BackendCall call, Func&& func) const {
+        auto start  = std::chrono::steady_clock::now();
+        auto status = func();
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count();
+        m_metrics.record(call, ns,
+            status != Status::OK && status != Status::StopIteration);
+        return status;
+    }
+
+    Metrics&           m_metrics;
+    HotKeys&           m_hot_keys;
+    DatabaseInterface* m_db;
+};
+
+}
+
+#endif
@@ -0,0 +1,465 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#include "json_predicate.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string_view>
+
+namespace yokan {
+
+using json = nlohmann::json;
+
+size_t JsonPathSet::add(const std::string& path) {
+    size_t current = 0;
+    size_t pos = 0;
+    while(!path.empty() && pos <= path.size()) {
+        size_t dot = path.find('.', pos);
+        if(dot == std::string::npos) dot = path.size();
+        std::string name = path.substr(pos, dot - pos);
+        pos = dot + 1;
+        size_t next = 0;
+        for(auto child : m_nodes[current].children) {
+            if(m_nodes[child].name == name) {
+                next = child;
+                break;
+            }
+        }
+        if(next == 0) {
+            Node node;
+            node.name = name;
+            if(!name.empty() && name.find_first_not_of("0123456789") == std::string::npos)
+                node.index = std::strtoull(name.c_str(), nullptr, 10);
+            m_nodes.push_back(std::move(node));
+            next = m_nodes.size() - 1;
+            m_nodes[current].children.push_back(next);
+        }
+        current = next;
+    }
+    if(m_nodes[current].slot == NoSlot)
+        m_nodes[current].slot = m_num_paths++;
+    return m_nodes[current].slot;
+}
+
+struct JsonPathSet::Scanner {
+
+    const char* p;
+    const char* end;
+
+    void ws() {
+        while(p < end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')) ++p;
+    }
+
+    bool consume(char c) {
+        ws();
+        if(p < end && *p == c) {
+            ++p;
+            return true;
+        }
+        return false;
+    }
+
+    /* p is on an opening quote; moves past the closing quote
+     * and returns the (still escaped) content of the string. */
+    bool string(std::string_view& content) {
+        const char* start = ++p;
+        while(true) {
+            auto q = static_cast<const char*>(std::memchr(p, '"', end - p));
+            if(!q) return false;
+            const char* b = q;
+            while(b > start && b[-1] == '\\') --b;
+            p = q + 1;
+            if(((q - b) & 1) == 0) {
+                content = std::string_view(start, q - start);
+                return true;
+            }
+        }
+    }
+
+    bool skipContainer() {
+        int depth = 0;
+        std::string_view unused;
+        while(p < end) {
+            char c = *p;
+            if(c == '"') {
+                if(!string(unused)) return false;
+                continue;
+            }
+            ++p;
+            if(c == '{' || c == '[') {
+                depth += 1;
+            } else if(c == '}' || c == ']') {
+                if(--depth == 0) return true;
+            }
+        }
+        return false;
+    }
+
+    bool skip() {
+        ws();
+        if(p >= end) return false;
+        std::string_view unused;
+        switch(*p) {
+        case '"':
+            return string(unused);
+        case '{': case '[':
+            return skipContainer();
+        case ',': case ':': case '}': case ']':
+            return false;
+        default: // number or literal
+            while(p < end && *p != ',' && *p != '}' && *p != ']'
+               && *p != ' ' && *p != '\n' && *p != '\r' && *p != '\t') ++p;
+            return true;
+        }
+    }
+};
+
+static bool keyEquals(std::string_view raw, const std::string& name) {
+    if(std::memchr(raw.data(), '\\', raw.size()) == nullptr)
+        return raw == name;
+    auto key = json::parse("\"" + std::string{raw} + "\"", nullptr, false);
+    return key.is_string() && key.get_ref<const std::string&>() == name;
+}
+
+/* Return values of visit and walk: -1 if the document is invalid,
+ * 1 if all the paths have been found (the scan can stop), 0 otherwise. */
+
+int JsonPathSet::visit(Scanner& s, const Node& node,
+                       JsonSlice* slices, size_t& remaining) const {
+    s.ws();
+    const char* start = s.p;
+    int r = node.children.empty() ? (s.skip() ? 0 : -1)
+                                  : walk(s, node, slices, remaining);
+    if(r != 0) return r;
+    if(node.slot != NoSlot && !slices[node.slot].found()) {
+        slices[node.slot] = JsonSlice{ start, (size_t)(s.p - start) };
+        if(--remaining == 0) return 1;
+    }
+    return 0;
+}
+
+int JsonPathSet::walk(Scanner& s, const Node& node,
+                      JsonSlice* slices, size_t& remaining) const {
+    if(s.p >= s.end) return -1;
+    if(*s.p == '{') {
+        ++s.p;
+        if(s.consume('}')) return 0;
+        while(true) {
+            s.ws();
+            if(s.p >= s.end || *s.p != '"') return -1;
+            std::string_view key;
+            if(!s.string(key)) return -1;
+            if(!s.consume(':')) return -1;
+            const Node* child = nullptr;
+            for(auto c : node.children) {
+                if(keyEquals(key, m_nodes[c].name)) {
+                    child = &m_nodes[c];
+                    break;
+                }
+            }
+            int r = child ? visit(s, *child, slices, remaining) : (s.skip() ? 0 : -1);
+            if(r != 0) return r;
+            if(s.consume(',')) continue;
+            if(s.consume('}')) return 0;
+            return -1;
+        }
+    } else if(*s.p == '[') {
+        ++s.p;
+        if(s.consume(']')) return 0;
+        for(size_t i = 0; ; i++) {
+            const Node* child = nullptr;
+            for(auto c : node.children) {
+                if(m_nodes[c].index == i) {
+                    child = &m_nodes[c];
+                    break;
+                }
+            }
+            int r = child ? visit(s, *child, slices, remaining) : (s.skip() ? 0 : -1);
+            if(r != 0) return r;
+            if(s.consume(',')) continue;
+            if(s.consume(']')) return 0;
+            return -1;
+        }
+    }
+    // scalar: none of the paths below this node exist
+    return s.skip() ? 0 : -1;
+}
+
+bool JsonPathSet::extract(const char* doc, size_t size, JsonSlice* slices) const {
+    if(m_num_paths == 0) return true;
+    Scanner s{ doc, doc + size };
+    size_t remaining = m_num_paths;
+    return visit(s, m_nodes[0], slices, remaining) >= 0;
+}
+
+JsonPredicate::JsonPredicate(const char* data, size_t size) {
+    auto expr = json::parse(data, data + size, nullptr, false);
+    if(expr.is_discarded())
+        throw std::invalid_argument("predicate is not valid JSON");
+    m_root = parse(expr);
+}
+
+JsonPredicate::JsonPredicate(const json& expr) {
+    m_root = parse(expr);
+}
+
+JsonPredicate::Expr JsonPredicate::parse(const json& expr) {
+    if(!expr.is_object() || expr.size() != 1)
+        throw std::invalid_argument("predicate should be an object with a single entry");
+    const auto& op  = expr.begin().key();
+    const auto& arg = expr.begin().value();
+    Expr result;
+    if(op == "and" || op == "or") {
+        if(!arg.is_array() || arg.empty())
+            throw std::invalid_argument("\"" + op + "\" expects a non-empty array of predicates");
+        result.op = op == "and" ? Expr::And : Expr::Or;
+        for(auto& child : arg) result.children.push_back(parse(child));
+        return result;
+    }
+    if(op == "not") {
+        result.op = Expr::Not;
+        result.children.push_back(parse(arg));
+        return result;
+    }
+    if(op == "exists") {
+        if(!arg.is_string())
+            throw std::invalid_argument("\"exists\" expects a path");
+        result.op   = Expr::Exists;
+        result.slot = m_paths.add(arg.get<std::string>());
+        return result;
+    }
+    static const std::pair<const char*, Expr::Op> comparisons[] = {
+        { "eq", Expr::Eq }, { "ne", Expr::Ne }, { "lt", Expr::Lt },
+        { "le", Expr::Le }, { "gt", Expr::Gt }, { "ge", Expr::Ge },
+        { "in", Expr::In }
+    };
+    for(auto& c : comparisons) {
+        if(op != c.first) continue;
+        if(!arg.is_array() || arg.size() != 2 || !arg[0].is_string())
+            throw std::invalid_argument("\"" + op + "\" expects a path and a value");
+        result.op   = c.second;
+        result.slot = m_paths.add(arg[0].get<std::string>());
+        if(c.second == Expr::In) {
+            if(!arg[1].is_array())
+                throw std::invalid_argument("\"in\" expects an array of values");
+            result.values.assign(arg[1].begin(), arg[1].end());
+        } else {
+            result.values.push_back(arg[1]);
+        }
+        return result;
+    }
+    throw std::invalid_argument("unknown predicate operator \"" + op + "\"");
+}
+
+namespace {
+
+enum class Cmp { Less, Equal, Greater, Unequal, Incomparable };
+
+template<typename T>
+Cmp order(const T& a, const T& b) {
+    if(a < b) return Cmp::Less;
+    if(b < a) return Cmp::Greater;
+    return Cmp::Equal;
+}
+
+/* Compares the raw JSON value v with the value ref. */
+Cmp compare(const JsonSlice& v, const json& ref) {
+    switch(v.data[0]) {
+    case '"': {
+        if(!ref.is_string()) return Cmp::Incomparable;
+        std::string_view raw(v.data + 1, v.size - 2);
+        const auto& str = ref.get_ref<const std::string&>();
+        if(std::memchr(raw.data(), '\\', raw.size()) == nullptr)
+            return order(raw, std::string_view{str});
+        auto s = json::parse(v.data, v.data + v.size, nullptr, false);
+        if(!s.is_string()) return Cmp::Incomparable;
+        return order(s.get_ref<const std::string&>(), str);
+    }
+    case 't': case 'f':
+        if(!ref.is_boolean()) return Cmp::Incomparable;
+        return order(v.data[0] == 't', ref.get<bool>());
+    case 'n':
+        return ref.is_null() ? Cmp::Equal : Cmp::Incomparable;
+    case '{': case '[': {
+        if(!ref.is_object() && !ref.is_array()) return Cmp::Incomparable;
+        auto j = json::parse(v.data, v.data + v.size, nullptr, false);
+        if(j.is_discarded()) return Cmp::Incomparable;
+        return j == ref ? Cmp::Equal : Cmp::Unequal;
+    }
+    default: {
+        if(!ref.is_number()) return Cmp::Incomparable;
+        char buffer[64];
+        if(v.size >= sizeof(buffer)) return Cmp::Incomparable;
+        std::memcpy(buffer, v.data, v.size);
+        buffer[v.size] = '\0';
+        char* endptr = nullptr;
+        double x = std::strtod(buffer, &endptr);
+        if(endptr != buffer + v.size) return Cmp::Incomparable;
+        return order(x, ref.get<double>());
+    }
+    }
+}
+
+}
+
+bool JsonPredicate::eval(const Expr& expr, const JsonSlice* slices) const {
+    switch(expr.op) {
+    case Expr::And:
+        for(auto& child : expr.children)
+            if(!eval(child, slices)) return false;
+        return true;
+    case Expr::Or:
+        for(auto& child : expr.children)
+            if(eval(child, slices)) return true;
+        return false;
+    case Expr::Not:
+        return !eval(expr.children[0], slices);
+    case Expr::Exists:
+        return slices[expr.slot].found();
+    default:
+        break;
+    }
+    const auto& v = slices[expr.slot];
+    if(!v.found() || v.size == 0) return false;
+    if(expr.op == Expr::In) {
+        for(auto& value : expr.values)
+            if(compare(v, value) == Cmp::Equal) return true;
+        return false;
+    }
+    auto c = compare(v, expr.values[0]);
+    switch(expr.op) {
+    case Expr::Eq: return c == Cmp::Equal;
+    case Expr::Ne: return c != Cmp::Equal;
+    case Expr::Lt: return c == Cmp::Less;
+    case Expr::Le: return c == Cmp::Less || c == Cmp::Equal;
+    case Expr::Gt: return c == Cmp::Greater;
+    case Expr::Ge: return c == Cmp::Greater || c == Cmp::Equal;
+    default:       return false;
+    }
+}
+
+bool JsonPredicate::matches(const char* doc, size_t size) const {
+    constexpr size_t MaxLocalSlots = 16;
+    JsonSlice local[MaxLocalSlots];
+    std::vector<JsonSlice> allocated;
+    JsonSlice* slices = local;
+    if(m_paths.size() > MaxLocalSlots) {
+        allocated.resize(m_paths.size());
+        slices = allocated.data();
+    }
+    if(!m_paths.extract(doc, size, slices)) return false;
+    return eval(m_root, slices);
+}
+
+void JsonProjection::selectFields(const std::vector<std::string>& paths) {
+    m_kind = Kind::Fields;
+    for(auto& path : paths) {
+        auto slot = m_paths.add(path);
+        if(slot == m_keys.size())
+            m_keys.push_back(json(path).dump());
+    }
+}
+
+template<typename Output>
+void JsonProjection::project(const char* doc, size_t size, Output&& output) const {
+    if(m_kind == Kind::Range) {
+        size_t offset = std::min(m_offset, size);
+        output(doc + offset, std::min(m_length, size - offset));
+        return;
+    }
+    constexpr size_t MaxLocalSlots = 16;
+    JsonSlice local[MaxLocalSlots];
+    std::vector<JsonSlice> allocated;
+    JsonSlice* slices = local;
+    if(m_paths.size() > MaxLocalSlots) {
+        allocated.resize(m_paths.size());
+        slices = allocated.data();
+    }
+    m_paths.extract(doc, size, slices);
+    output("{", 1);
+    bool first = true;
+    for(size_t i = 0; i < m_paths.size(); i++) {
+        if(!slices[i].found()) continue;
+        if(!first) output(",", 1);
+        first = false;
+        output(m_keys[i].data(), m_keys[i].size());
+        output(":", 1);
+        output(slices[i].data, slices[i].size);
+    }
+    output("}", 1);
+}
+
+size_t JsonProjection::sizeFrom(const char* doc, size_t size) const {
+    size_t result = 0;
+    project(doc, size, [&result](const char*, size_t n) { result += n; });
+    return result;
+}
+
+size_t JsonProjection::copy(char* dst, size_t max_dst_size,
+                            const char* doc, size_t size) const {
+    size_t offset = 0;
+    bool too_small = false;
+    project(doc, size, [&](const char* data, size_t n) {
+        if(too_small || offset + n > max_dst_size) {
+            too_small = true;
+            return;
+        }
+        std::memcpy(dst + offset, data, n);
+        offset += n;
+    });
+    return too_small ? YOKAN_SIZE_TOO_SMALL : offset;
+}
+
+JsonQuery::JsonQuery(const char* data, size_t size) {
+    auto query = json::parse(data, data + size, nullptr, false);
+    if(query.is_discarded())
+        throw std::invalid_argument("query is not valid JSON");
+    bool is_query = query.is_object()
+        && (query.contains("where") || query.contains("select") || query.contains("range"));
+    if(!is_query) {
+        m_predicate = std::make_unique<JsonPredicate>(query);
+        return;
+    }
+    for(auto& entry : query.items()) {
+        if(entry.key() != "where" && entry.key() != "select" && entry.key() != "range")
+            throw std::invalid_argument("unknown query entry \"" + entry.key() + "\"");
+    }
+    if(query.contains("where"))
+        m_predicate = std::make_unique<JsonPredicate>(query["where"]);
+    if(query.contains("select") && query.contains("range"))
+        throw std::invalid_argument("\"select\" and \"range\" cannot be used together");
+    if(query.contains("select")) {
+        const auto& select = query["select"];
+        if(!select.is_array())
+            throw std::invalid_argument("\"select\" expects an array of paths");
+        std::vector<std::string> paths;
+        for(auto& path : select) {
+            if(!path.is_string())
+                throw std::invalid_argument("\"select\" expects an array of paths");
+            paths.push_back(path.get<std::string>());
+        }
+        m_projection.selectFields(paths);
+    }
+    if(query.contains("range")) {
+        const auto& range = query["range"];
+        if(!range.is_array() || range.size() != 2
+        || !range[0].is_number_unsigned() || !range[1].is_number_unsigned())
+            throw std::invalid_argument("\"range\" expects an [offset, length] pair");
+        m_projection.selectRange(range[0].get<size_t>(), range[1].get<size_t>());
+    }
+}
+
+size_t JsonQuery::copy(char* dst, size_t max_dst_size,
+                       const char* doc, size_t size) const {
+    if(m_projection.active())
+        return m_projection.copy(dst, max_dst_size, doc, size);
+    if(max_dst_size < size) return YOKAN_SIZE_TOO_SMALL;
+    std::memcpy(dst, doc, size);
+    return size;
+}
+
+}
@@ -0,0 +1,224 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#ifndef __YOKAN_JSON_PREDICATE_HPP
+#define __YOKAN_JSON_PREDICATE_HPP
+
+#include "yokan/common.h"
+#include <nlohmann/json.hpp>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace yokan {
+
+/**
+ * @brief Raw JSON text of a value found in a document.
+ */
+struct JsonSlice {
+    const char* data = nullptr;
+    size_t      size = 0;
+
+    bool found() const {
+        return data != nullptr;
+    }
+};
+
+/**
+ * @brief Set of paths into JSON documents. A path is a list of object
+ * fields and array indices separated by dots (e.g. "a.b.0.c"); the
+ * empty path designates the whole document.
+ *
+ * extract() finds the values at all the paths in a single streaming
+ * pass over the document: it does not build any DOM, only descends into
+ * the objects and arrays that lead to a path, skips everything else
+ * (strings are skipped with memchr, which libc vectorizes), and stops as
+ * soon as all the paths have been found.
+ */
+class JsonPathSet {
+
+    public:
+
+    JsonPathSet() {
+        m_nodes.emplace_back();
+    }
+
+    /**
+     * @brief Adds a path to the set (if not already present)
+     * and returns its index.
+     */
+    size_t add(const std::string& path);
+
+    /**
+     * @brief Number of paths in the set.
+     */
+    size_t size() const {
+        return m_num_paths;
+    }
+
+    /**
+     * @brief Fills slices (an array of size() elements) with the values
+     * found at each path; slices of paths that are not found are left
+     * untouched. Returns false if the scanned part of the document is
+     * not valid JSON.
+     */
+    bool extract(const char* doc, size_t size, JsonSlice* slices) const;
+
+    private:
+
+    static constexpr size_t NotAnIndex = std::numeric_limits<size_t>::max();
+    static constexpr size_t NoSlot     = std::numeric_limits<size_t>::max();
+
+    struct Node {
+        std::string         name;
+        size_t              index = NotAnIndex; // name as an array index
+        size_t              slot  = NoSlot;     // index of the path ending here
+        std::vector<size_t> children;
+    };
+
+    struct Scanner;
+
+    int visit(Scanner& s, const Node& node, JsonSlice* slices, size_t& remaining) const;
+    int walk(Scanner& s, const Node& node, JsonSlice* slices, size_t& remaining) const;
+
+    std::vector<Node> m_nodes; // m_nodes[0] is the root
+    size_t            m_num_paths = 0;
+};
+
+/**
+ * @brief Predicate over the fields of JSON documents, itself expressed
+ * in JSON. A predicate is an object with a single entry among:
+ *
+ * - {"and": [P1, P2, ...]}, {"or": [P1, P2, ...]}, {"not": P}
+ * - {"exists": "path"}
+ * - {"eq": ["path", value]}, and likewise "ne", "lt", "le", "gt", "ge"
+ * - {"in": ["path", [value1, value2, ...]]}
+ *
+ * Paths follow the syntax of JsonPathSet. Comparisons are false when
+ * the field is missing or when its type differs from the value's type
+ * (numbers are compared as numbers, strings lexicographically, and
+ * objects and arrays only for equality), except "ne" which is true for
+ * an existing field of a different type.
+ *
+ * The constructor throws std::invalid_argument if the predicate is invalid.
+ */
+class JsonPredicate {
+
+    public:
+
+    JsonPredicate(const char* data, size_t size);
+
+    explicit JsonPredicate(const nlohmann::json& expr);
+
+    /**
+     * @brief Evaluates the predicate on a document. Documents that are
+     * not valid JSON (in the part that had to be scanned) never match.
+     */
+    bool matches(const char* doc, size_t size) const;
+
+    private:
+
+    struct Expr {
+        enum Op { And, Or, Not, Exists, Eq, Ne, Lt, Le, Gt, Ge, In };
+        Op                          op;
+        size_t                      slot = 0;
+        std::vector<nlohmann::json> values;
+        std::vector<Expr>           children;
+    };
+
+    Expr parse(const nlohmann::json& expr);
+    bool eval(const Expr& expr, const JsonSlice* slices) const;
+
+    JsonPathSet m_paths;
+    Expr        m_root;
+};
+
+/**
+ * @brief Projection of documents, either onto a set of fields of JSON
+ * documents, producing a flat JSON object mapping each selected path to
+ * its value (fields that are not found are omitted), e.g. selecting
+ * "name" and "meta.i" produces {"name":"abc","meta.i":3}; or onto a
+ * byte range of (possibly binary) documents.
+ */
+class JsonProjection {
+
+    public:
+
+    void selectFields(const std::vector<std::string>& paths);
+
+    void selectRange(size_t offset, size_t length) {
+        m_kind   = Kind::Range;
+        m_offset = offset;
+        m_length = length;
+    }
+
+    bool active() const {
+        return m_kind != Kind::None;
+    }
+
+    /**
+     * @brief Size of the projected document.
+     */
+    size_t sizeFrom(const char* doc, size_t size) const;
+
+    /**
+     * @brief Writes the projected document in dst and returns its size,
+     * or YOKAN_SIZE_TOO_SMALL if dst is too small.
+     */
+    size_t copy(char* dst, size_t max_dst_size, const char* doc, size_t size) const;
+
+    private:
+
+    enum class Kind { None, Fields, Range };
+
+    template<typename Output>
+    void project(const char* doc, size_t size, Output&& output) const;
+
+    Kind                     m_kind = Kind::None;
+    JsonPathSet              m_paths;
+    std::vector<std::string> m_keys; // quoted, escaped path of each slot
+    size_t                   m_offset = 0;
+    size_t                   m_length = 0;
+};
+
+/**
+ * @brief Query made of an optional predicate and an optional projection.
+ * The query is either a predicate (see JsonPredicate) or an object with
+ * the following optional entries:
+ *
+ * - "where": a predicate the documents must match;
+ * - "select": an array of paths to project the documents onto;
+ * - "range": an [offset, length] pair of byte offsets to project the
+ *   documents onto (exclusive with "select").
+ *
+ * The constructor throws std::invalid_argument if the query is invalid.
+ */
+class JsonQuery {
+
+    public:
+
+    JsonQuery(const char* data, size_t size);
+
+    bool matches(const char* doc, size_t size) const {
+        return !m_predicate || m_predicate->matches(doc, size);
+    }
+
+    size_t sizeFrom(const char* doc, size_t size) const {
+        return m_projection.active() ? m_projection.sizeFrom(doc, size) : size;
+    }
+
+    size_t copy(char* dst, size_t max_dst_size, const char* doc, size_t size) const;
+
+    private:
+
+    std::unique_ptr<JsonPredicate> m_predicate;
+    JsonProjection                 m_projection;
+};
+
+}
+
+#endif
@@ -0,0 +1,138 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#include "metrics.hpp"
+#include <algorithm>
+#include <vector>
+
+namespace yokan {
+
+using json = nlohmann::json;
+
+static const char* const rpc_names[] = {
+    "count", "put", "put_direct", "erase", "erase_direct", "get", "get_direct",
+    "fetch", "fetch_direct", "length", "length_direct", "exists", "exists_direct",
+    "list_keys", "list_keys_direct", "list_keyvals", "list_keyvals_direct",
+    "iter", "iter_direct", "cursor_open", "cursor_next", "cursor_close", "aggregate",
+    "coll_create", "coll_drop", "coll_exists", "coll_last_id", "coll_size",
+    "doc_erase", "doc_load", "doc_load_direct", "doc_fetch",
+    "doc_store", "doc_store_direct", "doc_update", "doc_update_direct",
+    "doc_length", "doc_list", "doc_list_direct", "doc_iter", "doc_iter_direct",
+    "doc_aggregate", "coll_create_index", "coll_drop_index", "doc_query",
+    "coll_reserve_ids",
+    "get_remi_provider_id", "get_stats"
+};
+static_assert(sizeof(rpc_names)/sizeof(rpc_names[0])
+              == static_cast<size_t>(RPCType::NumTypes),
+              "rpc_names does not match RPCType");
+
+static const char* const backend_names[] = {
+    "count", "exists", "length", "put", "get", "fetch", "erase", "eraseRange",
+    "listKeys", "listKeyValues", "iter", "openCursor",
+    "collCreate", "collDrop", "collExists", "collLastID", "collSize",
+    "docSize", "docStore", "docUpdate", "docLoad", "docFetch", "docErase",
+    "docList", "docIter", "collCreateIndex", "collDropIndex", "docQuery",
+    "collReserveIDs"
+};
+static_assert(sizeof(backend_names)/sizeof(backend_names[0])
+              == static_cast<size_t>(BackendCall::NumCalls),
+              "backend_names does not match BackendCall");
+
+namespace {
+
+/* Sum of the same OpMetrics across all the shards. */
+struct OpSummary {
+
+    uint64_t count    = 0;
+    uint64_t errors   = 0;
+    uint64_t bytes    = 0;
+    uint64_t total_ns = 0;
+    uint64_t max_ns   = 0;
+    std::array<uint64_t, LatencyHistogram::NumBuckets> buckets{};
+
+    void add(const OpMetrics& m) {
+        count    += m.count.load(std::memory_order_relaxed);
+        errors   += m.errors.load(std::memory_order_relaxed);
+        bytes    += m.bytes.load(std::memory_order_relaxed);
+        total_ns += m.total_ns.load(std::memory_order_relaxed);
+        max_ns    = std::max(max_ns, m.max_ns.load(std::memory_order_relaxed));
+        for(size_t b = 0; b < buckets.size(); b++)
+            buckets[b] += m.latency.count(b);
+    }
+
+    /* Upper bound of the bucket containing the q-th quantile, in ns. */
+    uint64_t quantile(double q) const {
+        uint64_t total = 0;
+        for(auto c : buckets) total += c;
+        if(total == 0) return 0;
+        uint64_t rank = (uint64_t)(q * total);
+        if(rank >= total) rank = total - 1;
+        uint64_t seen = 0;
+        for(size_t b = 0; b < buckets.size(); b++) {
+            seen += buckets[b];
+            if(seen > rank) {
+                if(b + 1 == buckets.size()) return max_ns;
+                return std::min(LatencyHistogram::lowerBound(b + 1) - 1, max_ns);
+            }
+        }
+        return max_ns;
+    }
+
+    json toJson(bool with_bytes) const {
+        json j = json::object();
+        j["count"]  = count;
+        j["errors"] = errors;
+        if(with_bytes) j["bytes"] = bytes;
+        auto us = [](double ns) { return ns / 1000.0; };
+        j["latency_us"] = {
+            { "mean", count ? us((double)total_ns / count) : 0.0 },
+            { "max",  us(max_ns) },
+            { "p50",  us(quantile(0.5)) },
+            { "p90",  us(quantile(0.9)) },
+            { "p99",  us(quantile(0.99)) },
+            { "p999", us(quantile(0.999)) }
+        };
+        // non-empty buckets only, as [lower bound in ns, count] pairs
+        auto histogram = json::array();
+        for(size_t b = 0; b < buckets.size(); b++) {
+            if(buckets[b] == 0) continue;
+            histogram.push_back({ LatencyHistogram::lowerBound(b), buckets[b] });
+        }
+        j["histogram"] = std::move(histogram);
+        return j;
+    }
+};
+
+}
+
+json Metrics::toJson() const {
+    constexpr size_t num_rpcs  = static_cast<size_t>(RPCType::NumTypes);
+    constexpr size_t num_calls = static_cast<size_t>(BackendCall::NumCalls);
+    std::vector<OpSummary> rpcs(num_rpcs);
+    std::vector<OpSummary> backend(num_calls);
+    for(auto& slot : m_shards) {
+        auto shard = slot.load(std::memory_order_acquire);
+        if(!shard) continue;
+        for(size_t i = 0; i < num_rpcs; i++)
+            rpcs[i].add(shard->rpcs[i]);
+        for(size_t i = 0; i < num_calls; i++)
+            backend[i].add(shard->backend[i]);
+    }
+    json result = {
+        { "rpcs",    json::object() },
+        { "backend", json::object() }
+    };
+    for(size_t i = 0; i < num_rpcs; i++) {
+        if(rpcs[i].count == 0) continue;
+        result["rpcs"][rpc_names[i]] = rpcs[i].toJson(true);
+    }
+    for(size_t i = 0; i < num_calls; i++) {
+        if(backend[i].count == 0) continue;
+        result["backend"][backend_names[i]] = backend[i].toJson(false);
+    }
+    return result;
+}
+
+}
@@ -0,0 +1,215 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#ifndef __YOKAN_METRICS_HPP
+#define __YOKAN_METRICS_HPP
+
+#include "yokan/common.h"
+#include <nlohmann/json.hpp>
+#include <abt.h>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace yokan {
+
+/**
+ * @brief Log-linear ("HDR-style") histogram of durations in nanoseconds.
+ * Each power of two is split into 2^SubBits linear sub-buckets, so any
+ * recorded value is known within 1/2^SubBits of its actual value.
+ * Values above 2^MaxExp ns (about 18 minutes) go to the last bucket.
+ */
+class LatencyHistogram {
+
+    public:
+
+    static constexpr unsigned SubBits    = 3;
+    static constexpr unsigned MaxExp     = 40;
+    static constexpr size_t   NumBuckets = (MaxExp - SubBits + 2) << SubBits;
+
+    static size_t bucketOf(uint64_t ns) {
+        if(ns < (1u << SubBits)) return ns;
+        unsigned e = 63 - __builtin_clzll(ns);
+        if(e > MaxExp) return NumBuckets - 1;
+        uint64_t sub = (ns >> (e - SubBits)) & ((1u << SubBits) - 1);
+        return ((e - SubBits + 1) << SubBits) + sub;
+    }
+
+    static uint64_t lowerBound(size_t bucket) {
+        if(bucket < (1u << SubBits)) return bucket;
+        unsigned e = (bucket >> SubBits) + SubBits - 1;
+        uint64_t sub = bucket & ((1u << SubBits) - 1);
+        return (1ull << e) | (sub << (e - SubBits));
+    }
+
+    void record(uint64_t ns) {
+        m_counts[bucketOf(ns)].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    uint64_t count(size_t bucket) const {
+        return m_counts[bucket].load(std::memory_order_relaxed);
+    }
+
+    private:
+
+    std::array<std::atomic<uint64_t>, NumBuckets> m_counts{};
+};
+
+/**
+ * @brief Counters for one kind of operation (an RPC or a backend call).
+ */
+struct OpMetrics {
+
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> errors{0};
+    std::atomic<uint64_t> bytes{0};
+    std::atomic<uint64_t> total_ns{0};
+    std::atomic<uint64_t> max_ns{0};
+    LatencyHistogram      latency;
+
+    void record(uint64_t ns, bool error, uint64_t num_bytes) {
+        count.fetch_add(1, std::memory_order_relaxed);
+        if(error) errors.fetch_add(1, std::memory_order_relaxed);
+        if(num_bytes) bytes.fetch_add(num_bytes, std::memory_order_relaxed);
+        total_ns.fetch_add(ns, std::memory_order_relaxed);
+        auto max = max_ns.load(std::memory_order_relaxed);
+        while(ns > max && !max_ns.compare_exchange_weak(max, ns, std::memory_order_relaxed)) {}
+        latency.record(ns);
+    }
+};
+
+enum class RPCType : unsigned {
+    count, put, put_direct, erase, erase_direct, get, get_direct,
+    fetch, fetch_direct, length, length_direct, exists, exists_direct,
+    list_keys, list_keys_direct, list_keyvals, list_keyvals_direct,
+    iter, iter_direct, cursor_open, cursor_next, cursor_close, aggregate,
+    coll_create, coll_drop, coll_exists, coll_last_id, coll_size,
+    doc_erase, doc_load, doc_load_direct, doc_fetch,
+    doc_store, doc_store_direct, doc_update, doc_update_direct,
+    doc_length, doc_list, doc_list_direct, doc_iter, doc_iter_direct,
+    doc_aggregate, coll_create_index, coll_drop_index, doc_query,
+    coll_reserve_ids,
+    get_remi_provider_id, get_stats,
+    NumTypes
+};
+
+enum class BackendCall : unsigned {
+    count, exists, length, put, get, fetch, erase, eraseRange,
+    listKeys, listKeyValues, iter, openCursor,
+    collCreate, collDrop, collExists, collLastID, collSize,
+    docSize, docStore, docUpdate, docLoad, docFetch, docErase,
+    docList, docIter, collCreateIndex, collDropIndex, docQuery,
+    collReserveIDs,
+    NumCalls
+};
+
+/**
+ * @brief The Metrics object collects, for each RPC and each backend call,
+ * counts, errors, bytes, and a latency histogram. Counters are sharded
+ * by execution stream (each shard is allocated the first time a ULT of
+ * that execution stream records something) and updated with relaxed
+ * atomics, so recording takes no lock. Shards are summed on query.
+ */
+class Metrics {
+
+    public:
+
+    Metrics() {
+        for(auto& shard : m_shards) shard.store(nullptr);
+    }
+
+    ~Metrics() {
+        for(auto& shard : m_shards) delete shard.load();
+    }
+
+    Metrics(const Metrics&) = delete;
+    Metrics& operator=(const Metrics&) = delete;
+
+    void record(RPCType rpc, uint64_t ns, bool error, uint64_t bytes) {
+        shard().rpcs[static_cast<unsigned>(rpc)].record(ns, error, bytes);
+    }
+
+    void record(BackendCall call, uint64_t ns, bool error) {
+        shard().backend[static_cast<unsigned>(call)].record(ns, error, 0);
+    }
+
+    /**
+     * @brief Sums the shards into a JSON object with "rpcs" and "backend"
+     * entries, each listing the operations that were called at least once.
+     */
+    nlohmann::json toJson() const;
+
+    private:
+
+    static constexpr size_t MaxShards = 64;
+
+    struct alignas(64) Shard {
+        std::array<OpMetrics, static_cast<size_t>(RPCType::NumTypes)>     rpcs;
+        std::array<OpMetrics, static_cast<size_t>(BackendCall::NumCalls)> backend;
+    };
+
+    Shard& shard() {
+        int rank = 0;
+        if(ABT_self_get_xstream_rank(&rank) != ABT_SUCCESS) rank = 0;
+        auto& slot = m_shards[rank % MaxShards];
+        auto s = slot.load(std::memory_order_acquire);
+        if(s) return *s;
+        auto fresh = new Shard;
+        if(slot.compare_exchange_strong(s, fresh, std::memory_order_acq_rel))
+            return *fresh;
+        delete fresh;
+        return *s;
+    }
+
+    std::array<std::atomic<Shard*>, MaxShards> m_shards;
+};
+
+/**
+ * @brief RAII object recording the duration of an RPC handler, whether
+ * it failed (based on its out.ret), and the bytes it was admitted with.
+ */
+class RPCTracker {
+
+    public:
+
+    RPCTracker(Metrics& metrics, RPCType rpc, const int32_t& ret)
+    : m_metrics(metrics)
+    , m_rpc(rpc)
+    , m_ret(ret)
+    , m_start(std::chrono::steady_clock::now()) {}
+
+    ~RPCTracker() {
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - m_start).count();
+        m_metrics.record(m_rpc, ns, m_ret != YOKAN_SUCCESS, m_bytes);
+    }
+
+    RPCTracker(const RPCTracker&) = delete;
+    RPCTracker& operator=(const RPCTracker&) = delete;
+
+    void setBytes(uint64_t bytes) {
+        m_bytes = bytes;
+    }
+
+    private:
+
+    Metrics&                              m_metrics;
+    RPCType                               m_rpc;
+    const int32_t&                        m_ret;
+    uint64_t                              m_bytes = 0;
+    std::chrono::steady_clock::time_point m_start;
+};
+
+}
+
+/**
+ * @brief Records the metrics of the current RPC handler until it returns.
+ * Must come after the provider has been checked, and before CHECK_ADMISSION.
+ */
+#define TRACK_RPC(__pr__, __rpc__) \
+    yokan::RPCTracker __rpc_tracker__{(__pr__)->metrics, yokan::RPCType::__rpc__, out.ret}
+
+#endif
@@ -0,0 +1,194 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#include "record_filter.hpp"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+#include <string>
+
+namespace yokan {
+
+template<typename T, typename W, typename Compare>
+static void scanFields(const char* fields, size_t n, W value,
+                       uint8_t* selected, Compare compare) {
+    for(size_t i = 0; i < n; i++) {
+        T x;
+        std::memcpy(&x, fields + i*sizeof(T), sizeof(T));
+        selected[i] &= static_cast<uint8_t>(compare(static_cast<W>(x), value));
+    }
+}
+
+template<typename T, typename W>
+static void scanFields(const char* fields, size_t n, RecordDocFilter::Op op,
+                       W value, uint8_t* selected) {
+    using Op = RecordDocFilter::Op;
+    switch(op) {
+    case Op::Eq: scanFields<T>(fields, n, value, selected, std::equal_to<W>());      break;
+    case Op::Ne: scanFields<T>(fields, n, value, selected, std::not_equal_to<W>());  break;
+    case Op::Lt: scanFields<T>(fields, n, value, selected, std::less<W>());          break;
+    case Op::Le: scanFields<T>(fields, n, value, selected, std::less_equal<W>());    break;
+    case Op::Gt: scanFields<T>(fields, n, value, selected, std::greater<W>());       break;
+    case Op::Ge: scanFields<T>(fields, n, value, selected, std::greater_equal<W>()); break;
+    }
+}
+
+size_t RecordDocFilter::Condition::size() const {
+    switch(type) {
+    case YOKAN_FIELD_INT32:
+    case YOKAN_FIELD_UINT32:
+    case YOKAN_FIELD_FLOAT:
+        return 4;
+    default:
+        return 8;
+    }
+}
+
+void RecordDocFilter::Condition::scan(const char* fields, size_t n, uint8_t* selected) const {
+    switch(type) {
+    case YOKAN_FIELD_INT32:  scanFields<int32_t>(fields, n, op, ivalue, selected);  break;
+    case YOKAN_FIELD_INT64:  scanFields<int64_t>(fields, n, op, ivalue, selected);  break;
+    case YOKAN_FIELD_UINT32: scanFields<uint32_t>(fields, n, op, uvalue, selected); break;
+    case YOKAN_FIELD_UINT64: scanFields<uint64_t>(fields, n, op, uvalue, selected); break;
+    case YOKAN_FIELD_FLOAT:  scanFields<float>(fields, n, op, dvalue, selected);    break;
+    default:                 scanFields<double>(fields, n, op, dvalue, selected);   break;
+    }
+}
+
+static RecordDocFilter::Condition parseCondition(const nlohmann::json& cond) {
+    using Op = RecordDocFilter::Op;
+    static const std::pair<const char*, yk_field_type_t> types[] = {
+        { "int32",  YOKAN_FIELD_INT32 },  { "int64",  YOKAN_FIELD_INT64 },
+        { "uint32", YOKAN_FIELD_UINT32 }, { "uint64", YOKAN_FIELD_UINT64 },
+        { "float",  YOKAN_FIELD_FLOAT },  { "double", YOKAN_FIELD_DOUBLE }
+    };
+    static const std::pair<const char*, Op> ops[] = {
+        { "eq", Op::Eq }, { "ne", Op::Ne }, { "lt", Op::Lt },
+        { "le", Op::Le }, { "gt", Op::Gt }, { "ge", Op::Ge }
+    };
+    if(!cond.is_object()
+    || !cond.contains("offset") || !cond["offset"].is_number_unsigned()
+    || !cond.contains("type")   || !cond["type"].is_string()
+    || !cond.contains("op")     || !cond["op"].is_string()
+    || !cond.contains("value")  || !cond["value"].is_number())
+        throw std::invalid_argument(
+            "conditions should be objects with an offset, a type, an op, and a value");
+    RecordDocFilter::Condition result;
+    result.offset = cond["offset"].get<size_t>();
+    auto type = cond["type"].get<std::string>();
+    auto t = std::find_if(std::begin(types), std::end(types),
+                          [&](const auto& p) { return type == p.first; });
+    if(t == std::end(types))
+        throw std::invalid_argument("unknown field type \"" + type + "\"");
+    result.type = t->second;
+    auto op = cond["op"].get<std::string>();
+    auto o = std::find_if(std::begin(ops), std::end(ops),
+                          [&](const auto& p) { return op == p.first; });
+    if(o == std::end(ops))
+        throw std::invalid_argument("unknown comparison \"" + op + "\"");
+    result.op = o->second;
+    auto& value = cond["value"];
+    switch(result.type) {
+    case YOKAN_FIELD_INT32:
+    case YOKAN_FIELD_INT64:
+        if(!value.is_number_integer()
+        || (value.is_number_unsigned() && value.get<uint64_t>() > INT64_MAX))
+            throw std::invalid_argument("signed integer fields should be compared with integers");
+        result.ivalue = value.get<int64_t>();
+        break;
+    case YOKAN_FIELD_UINT32:
+    case YOKAN_FIELD_UINT64:
+        if(!value.is_number_unsigned())
+            throw std::invalid_argument("unsigned integer fields should be compared with unsigned integers");
+        result.uvalue = value.get<uint64_t>();
+        break;
+    default:
+        result.dvalue = value.get<double>();
+        break;
+    }
+    return result;
+}
+
+RecordDocFilter::RecordDocFilter(margo_instance_id mid, int32_t mode, const UserMem& query) {
+    (void)mid;
+    (void)mode;
+    auto json = nlohmann::json::parse(query.data, query.data + query.size, nullptr, false);
+    if(json.is_discarded() || !json.is_object())
+        throw std::invalid_argument("record query should be a JSON object");
+    if(json.contains("where")) {
+        auto& where = json["where"];
+        if(!where.is_array())
+            throw std::invalid_argument("\"where\" should be an array of conditions");
+        for(auto& cond : where)
+            m_conditions.push_back(parseCondition(cond));
+    }
+    if(json.contains("select")) {
+        auto& select = json["select"];
+        if(!select.is_array())
+            throw std::invalid_argument("\"select\" should be an array of ranges");
+        for(auto& range : select) {
+            if(!range.is_array() || range.size() != 2
+            || !range[0].is_number_unsigned() || !range[1].is_number_unsigned())
+                throw std::invalid_argument("ranges should be [offset, length] pairs");
+            m_ranges.emplace_back(range[0].get<size_t>(), range[1].get<size_t>());
+        }
+    }
+}
+
+bool RecordDocFilter::check(const char* collection, yk_id_t id,
+                            const void* doc, size_t docsize) const {
+    (void)collection;
+    (void)id;
+    auto data = static_cast<const char*>(doc);
+    for(auto& cond : m_conditions) {
+        if(cond.offset > docsize || docsize - cond.offset < cond.size())
+            return false;
+        if(!cond.matches(data + cond.offset))
+            return false;
+    }
+    return true;
+}
+
+/* Length of the part of the range that is within a document of the given size. */
+static size_t clip(const RecordDocFilter::Range& range, size_t docsize) {
+    if(range.first >= docsize) return 0;
+    return std::min(range.second, docsize - range.first);
+}
+
+size_t RecordDocFilter::docSizeFrom(const char* collection,
+                                    const void* doc, size_t docsize) const {
+    (void)collection;
+    (void)doc;
+    if(m_ranges.empty()) return docsize;
+    size_t size = 0;
+    for(auto& range : m_ranges)
+        size += clip(range, docsize);
+    return size;
+}
+
+size_t RecordDocFilter::docCopy(const char* collection,
+                                void* dst, size_t max_dst_size,
+                                const void* doc, size_t docsize) const {
+    if(docSizeFrom(collection, doc, docsize) > max_dst_size)
+        return YOKAN_SIZE_TOO_SMALL;
+    if(m_ranges.empty()) {
+        std::memcpy(dst, doc, docsize);
+        return docsize;
+    }
+    auto out = static_cast<char*>(dst);
+    size_t size = 0;
+    for(auto& range : m_ranges) {
+        auto length = clip(range, docsize);
+        std::memcpy(out + size, static_cast<const char*>(doc) + range.first, length);
+        size += length;
+    }
+    return size;
+}
+
+}
+
+YOKAN_REGISTER_DOC_FILTER(record, yokan::RecordDocFilter);
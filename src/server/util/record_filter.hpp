@@ -0,0 +1,111 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#ifndef __YOKAN_RECORD_FILTER_HPP
+#define __YOKAN_RECORD_FILTER_HPP
+
+#include "yokan/common.h"
+#include "yokan/aggregate.h"
+#include "yokan/filters.hpp"
+#include <margo.h>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace yokan {
+
+/**
+ * @brief Filter of fixed-layout binary documents (records), registered
+ * as the "record" filter, i.e. used with YOKAN_MODE_LIB_FILTER and the
+ * filter ":record:<query>", where the query is a JSON object with the
+ * following optional entries:
+ *
+ * - "where": an array of conditions that documents must all satisfy,
+ *   e.g. {"offset":8, "type":"double", "op":"gt", "value":3.5}, which
+ *   compares the number of the given type ("int32", "int64", "uint32",
+ *   "uint64", "float", or "double") found at the given byte offset of
+ *   the documents with the value ("eq", "ne", "lt", "le", "gt", "ge");
+ * - "select": an array of [offset, length] byte ranges to project the
+ *   documents onto, the projected document being their concatenation.
+ *
+ * Documents too short to contain a field never satisfy its condition,
+ * and ranges are truncated to the size of the documents. Backends that
+ * store records by columns recognize this filter and evaluate it on
+ * their columns instead of calling check on each document.
+ *
+ * The constructor throws std::invalid_argument if the query is invalid.
+ */
+class RecordDocFilter : public DocFilter {
+
+    public:
+
+    enum class Op { Eq, Ne, Lt, Le, Gt, Ge };
+
+    /**
+     * @brief Comparison of a field with a value. Signed integers are
+     * compared as int64_t, unsigned integers as uint64_t, and floating
+     * point numbers as double.
+     */
+    struct Condition {
+        yk_field_type_t type;
+        size_t          offset;
+        Op              op;
+        int64_t         ivalue = 0;
+        uint64_t        uvalue = 0;
+        double          dvalue = 0.0;
+
+        size_t size() const;
+
+        /**
+         * @brief Evaluates the condition on n contiguous fields of its
+         * type, clearing selected[i] if the i-th field does not satisfy
+         * it. Each comparison is a branch-free loop over the fields, so
+         * that the compiler can vectorize it.
+         */
+        void scan(const char* fields, size_t n, uint8_t* selected) const;
+
+        bool matches(const char* field) const {
+            uint8_t selected = 1;
+            scan(field, 1, &selected);
+            return selected;
+        }
+    };
+
+    using Range = std::pair<size_t, size_t>;
+
+    RecordDocFilter(margo_instance_id mid, int32_t mode, const UserMem& query);
+
+    const std::vector<Condition>& conditions() const {
+        return m_conditions;
+    }
+
+    /**
+     * @brief Byte ranges ([offset, length] pairs) the documents are
+     * projected onto, or an empty vector if they are not projected.
+     */
+    const std::vector<Range>& ranges() const {
+        return m_ranges;
+    }
+
+    bool check(const char* collection, yk_id_t id,
+               const void* doc, size_t docsize) const override;
+
+    size_t docSizeFrom(const char* collection,
+                       const void* doc, size_t docsize) const override;
+
+    size_t docCopy(const char* collection,
+                   void* dst, size_t max_dst_size,
+                   const void* doc, size_t docsize) const override;
+
+    private:
+
+    std::vector<Condition> m_conditions;
+    std::vector<Range>     m_ranges;
+};
+
+}
+
+#endif
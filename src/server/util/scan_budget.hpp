@@ -0,0 +1,236 @@
+/*
+ * (C) 2021 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#ifndef __YOKAN_SCAN_BUDGET_HPP
+#define __YOKAN_SCAN_BUDGET_HPP
+
+#include "yokan/common.h"
+#include "yokan/filters.hpp"
+#include <abt.h>
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <string>
+
+namespace yokan {
+
+/**
+ * @brief The ScanBudget counts the entries examined by a scan and the time
+ * it has been running, and tells when the scan should stop because either
+ * limit has been reached (a limit of 0 means no limit).
+ */
+class ScanBudget {
+
+    public:
+
+    ScanBudget(uint64_t max_examined, uint64_t max_time_us)
+    : m_max_examined(max_examined)
+    , m_deadline(max_time_us ? ABT_get_wtime() + max_time_us*1e-6 : 0.0) {}
+
+    bool enabled() const {
+        return m_max_examined != 0 || m_deadline != 0.0;
+    }
+
+    /**
+     * @brief Account for an entry about to be examined. Returns false
+     * if the budget does not allow examining it.
+     */
+    bool consume() {
+        if(m_exhausted) return false;
+        if((m_max_examined && m_examined >= m_max_examined)
+        || (m_deadline != 0.0 && ABT_get_wtime() > m_deadline)) {
+            m_exhausted = true;
+            return false;
+        }
+        m_examined += 1;
+        return true;
+    }
+
+    bool exhausted() const {
+        return m_exhausted;
+    }
+
+    private:
+
+    uint64_t m_max_examined;
+    double   m_deadline;
+    uint64_t m_examined  = 0;
+    bool     m_exhausted = false;
+};
+
+/**
+ * @brief KeyValueFilter wrapper that makes the backend stop its scan
+ * (through shouldStop) at the first key the budget refused, and remembers
+ * that key so the scan can be resumed from it. Since checkBatch consumes
+ * the budget for a whole block at once, the scan must not stop at keys
+ * of the block that were rejected by the wrapped filter before that one.
+ */
+class BudgetedKeyValueFilter : public KeyValueFilter {
+
+    public:
+
+    BudgetedKeyValueFilter(std::shared_ptr<KeyValueFilter> filter, ScanBudget& budget)
+    : m_filter(std::move(filter))
+    , m_budget(budget) {}
+
+    bool requiresValue() const override {
+        return m_filter->requiresValue();
+    }
+
+    bool check(const void* key, size_t ksize,
+               const void* val, size_t vsize) const override {
+        if(!m_budget.consume()) {
+            if(!m_resume) m_resume_key.assign(static_cast<const char*>(key), ksize);
+            m_resume = true;
+            return false;
+        }
+        return m_filter->check(key, ksize, val, vsize);
+    }
+
+    void checkBatch(const void* const* keys, const size_t* ksizes,
+                    const void* const* vals, const size_t* vsizes,
+                    uint8_t* results, size_t n) const override {
+        size_t allowed = 0;
+        while(allowed < n && m_budget.consume()) allowed += 1;
+        if(allowed < n) {
+            if(!m_resume) m_resume_key.assign(static_cast<const char*>(keys[allowed]), ksizes[allowed]);
+            m_resume = true;
+            std::fill(results + allowed, results + n, 0);
+        }
+        m_filter->checkBatch(keys, ksizes, vals, vsizes, results, allowed);
+    }
+
+    size_t keySizeFrom(const void* key, size_t ksize) const override {
+        return m_filter->keySizeFrom(key, ksize);
+    }
+
+    size_t valSizeFrom(const void* val, size_t vsize) const override {
+        return m_filter->valSizeFrom(val, vsize);
+    }
+
+    size_t keyCopy(void* dst, size_t max_dst_size,
+                   const void* key, size_t ksize) const override {
+        return m_filter->keyCopy(dst, max_dst_size, key, ksize);
+    }
+
+    size_t valCopy(void* dst, size_t max_dst_size,
+                   const void* val, size_t vsize) const override {
+        return m_filter->valCopy(dst, max_dst_size, val, vsize);
+    }
+
+    bool shouldStop(const void* key, size_t ksize,
+                    const void* val, size_t vsize) const override {
+        if(m_resume && ksize == m_resume_key.size()
+        && std::memcmp(key, m_resume_key.data(), ksize) == 0)
+            return true;
+        return m_filter->shouldStop(key, ksize, val, vsize);
+    }
+
+    /**
+     * @brief Whether the scan was stopped by the budget, in which
+     * case resumeKey() is the key from which to resume (inclusive).
+     */
+    bool incomplete() const {
+        return m_resume;
+    }
+
+    const std::string& resumeKey() const {
+        return m_resume_key;
+    }
+
+    private:
+
+    std::shared_ptr<KeyValueFilter> m_filter;
+    ScanBudget&                     m_budget;
+    mutable bool                    m_resume = false;
+    mutable std::string             m_resume_key;
+};
+
+/**
+ * @brief DocFilter equivalent of BudgetedKeyValueFilter, remembering
+ * the first document id it refused. Since shouldStop does not receive
+ * document ids, the first refused document is recognized by its address,
+ * after the documents of its block that the wrapped filter rejected
+ * (documents of size 0 may share their address with the next one).
+ */
+class BudgetedDocFilter : public DocFilter {
+
+    public:
+
+    BudgetedDocFilter(std::shared_ptr<DocFilter> filter, ScanBudget& budget)
+    : m_filter(std::move(filter))
+    , m_budget(budget) {}
+
+    bool check(const char* collection, yk_id_t id,
+               const void* doc, size_t docsize) const override {
+        if(!m_budget.consume()) {
+            if(!m_resume) {
+                m_resume_id  = id;
+                m_resume_doc = doc;
+            }
+            m_resume = true;
+            return false;
+        }
+        return m_filter->check(collection, id, doc, docsize);
+    }
+
+    void checkBatch(const char* collection,
+                    const yk_id_t* ids, const void* const* docs, const size_t* docsizes,
+                    uint8_t* results, size_t n) const override {
+        size_t allowed = 0;
+        while(allowed < n && m_budget.consume()) allowed += 1;
+        m_filter->checkBatch(collection, ids, docs, docsizes, results, allowed);
+        if(allowed < n) {
+            if(!m_resume) {
+                m_resume_id  = ids[allowed];
+                m_resume_doc = docs[allowed];
+                m_rejected_before = std::count(results, results + allowed, 0);
+            }
+            m_resume = true;
+            std::fill(results + allowed, results + n, 0);
+        }
+    }
+
+    size_t docSizeFrom(const char* collection,
+                       const void* val, size_t vsize) const override {
+        return m_filter->docSizeFrom(collection, val, vsize);
+    }
+
+    size_t docCopy(const char* collection,
+                   void* dst, size_t max_dst_size,
+                   const void* val, size_t vsize) const override {
+        return m_filter->docCopy(collection, dst, max_dst_size, val, vsize);
+    }
+
+    bool shouldStop(const char* collection,
+                    const void* doc, size_t size) const override {
+        if(m_resume) {
+            if(m_rejected_before) m_rejected_before -= 1;
+            else if(doc == m_resume_doc) return true;
+        }
+        return m_filter->shouldStop(collection, doc, size);
+    }
+
+    bool incomplete() const {
+        return m_resume;
+    }
+
+    yk_id_t resumeId() const {
+        return m_resume_id;
+    }
+
+    private:
+
+    std::shared_ptr<DocFilter> m_filter;
+    ScanBudget&                m_budget;
+    mutable bool               m_resume = false;
+    mutable yk_id_t            m_resume_id = 0;
+    mutable const void*        m_resume_doc = nullptr;
+    mutable size_t             m_rejected_before = 0;
+};
+
+}
+
+#endif
@@ -38,7 +38,7 @@ static const char* available_backends[] = {
 
 static const char* backend_configs[] = {
     "{}",
-    "{\"disable_doc_mixin_lock\":true}",
+    "{\"disable_doc_mixin_lock\":true, \"scan_quantum\":3}",
     "{\"disable_doc_mixin_lock\":true}",
     "{\"disable_doc_mixin_lock\":true}",
     "{\"disable_doc_mixin_lock\":true}",
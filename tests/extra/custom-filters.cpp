@@ -29,6 +29,15 @@ struct CustomKeyValueFilter : public yokan::KeyValueFilter {
         return vsize % 2 == ((ksize % 2 == 0) ? 1 : 0);
     }
 
+    void checkBatch(const void* const* keys, const size_t* ksizes,
+                    const void* const* vals, const size_t* vsizes,
+                    uint8_t* results, size_t n) const override {
+        (void)keys;
+        (void)vals;
+        for(size_t i = 0; i < n; i++)
+            results[i] = (vsizes[i] ^ ksizes[i]) & 1;
+    }
+
     size_t keySizeFrom(const void* key, size_t ksize) const override {
         (void)key;
         return ksize;
@@ -76,6 +85,16 @@ struct CustomDocFilter : public yokan::DocFilter {
         return id % 2 == 0;
     }
 
+    void checkBatch(const char* coll, const yk_id_t* ids,
+                    const void* const* docs, const size_t* docsizes,
+                    uint8_t* results, size_t n) const override {
+        (void)coll;
+        (void)docs;
+        (void)docsizes;
+        for(size_t i = 0; i < n; i++)
+            results[i] = (ids[i] & 1) == 0;
+    }
+
     size_t docSizeFrom(const char* coll, const void* val, size_t vsize) const override {
         (void)coll;
         (void)val;
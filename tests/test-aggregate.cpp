@@ -0,0 +1,170 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#include "test-common-setup.hpp"
+#include <vector>
+#include <cstring>
+#include <string>
+
+static void* test_aggregate_context_setup(const MunitParameter params[], void* user_data)
+{
+    auto context = static_cast<kv_test_context*>(
+        kv_test_common_context_setup(params, user_data));
+    if(context->empty_values) return context;
+
+    // 20 binary values (int64) under "bin/", 20 JSON values under "json/",
+    // and some noise under other prefixes
+    for(int64_t i = 0; i < 20; i++) {
+        char key[16];
+        snprintf(key, sizeof(key), "bin/%02ld", (long)i);
+        int64_t val = i*10;
+        yk_put(context->dbh, context->mode, key, strlen(key), &val, sizeof(val));
+        snprintf(key, sizeof(key), "json/%02ld", (long)i);
+        std::string json = "{\"name\":\"x\",\"v\":" + std::to_string(i*10) + "}";
+        if(i == 7) json = "{\"name\":\"no v\"}";
+        yk_put(context->dbh, context->mode, key, strlen(key), json.data(), json.size());
+    }
+    for(auto& p : context->reference)
+        yk_put(context->dbh, context->mode, p.first.data(), p.first.size(),
+               p.second.data(), p.second.size());
+    return context;
+}
+
+static MunitResult test_aggregate_binary(const MunitParameter params[], void* data)
+{
+    (void)params;
+    auto context = static_cast<kv_test_context*>(data);
+    yk_database_handle_t dbh = context->dbh;
+    yk_return_t ret;
+
+    if(context->empty_values) return MUNIT_SKIP;
+
+    yk_aggregate_spec_t spec;
+    spec.type      = YOKAN_FIELD_INT64;
+    spec.field     = nullptr;
+    spec.offset    = 0;
+    spec.hist_min  = 0.0;
+    spec.hist_max  = 100.0;
+    spec.hist_bins = 5;
+
+    yk_aggregate_t result;
+    ret = yk_aggregate(dbh, context->mode, nullptr, 0, "bin/", 4, &spec, &result);
+    SKIP_IF_NOT_IMPLEMENTED(ret);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+
+    munit_assert_long(result.count, ==, 20);
+    munit_assert_long(result.num_values, ==, 20);
+    munit_assert_double(result.sum, ==, 1900.0);
+    munit_assert_double(result.min, ==, 0.0);
+    munit_assert_double(result.max, ==, 190.0);
+    munit_assert_long(result.hist_bins, ==, 5);
+    munit_assert_long(result.hist_underflow, ==, 0);
+    munit_assert_long(result.hist_overflow, ==, 10);
+    for(size_t i = 0; i < 5; i++)
+        munit_assert_long(result.hist[i], ==, 2);
+
+    // partial results can be merged
+    yk_aggregate_t total;
+    yk_aggregate_init(&total, 5);
+    munit_assert_int(yk_aggregate_merge(&total, &result), ==, YOKAN_SUCCESS);
+    munit_assert_int(yk_aggregate_merge(&total, &result), ==, YOKAN_SUCCESS);
+    munit_assert_long(total.count, ==, 40);
+    munit_assert_double(total.sum, ==, 3800.0);
+    munit_assert_double(total.min, ==, 0.0);
+    munit_assert_double(total.max, ==, 190.0);
+    munit_assert_long(total.hist[0], ==, 4);
+    yk_aggregate_init(&total, 4);
+    munit_assert_int(yk_aggregate_merge(&total, &result), ==, YOKAN_ERR_INVALID_ARGS);
+
+    // a field that is out of the values is not aggregated
+    spec.offset = 4;
+    ret = yk_aggregate(dbh, context->mode, nullptr, 0, "bin/", 4, &spec, &result);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+    munit_assert_long(result.count, ==, 20);
+    munit_assert_long(result.num_values, ==, 0);
+
+    // invalid specifications
+    spec.hist_bins = YOKAN_AGGREGATE_MAX_BINS + 1;
+    ret = yk_aggregate(dbh, context->mode, nullptr, 0, "bin/", 4, &spec, &result);
+    munit_assert_int(ret, ==, YOKAN_ERR_INVALID_ARGS);
+    spec.hist_bins = 5;
+    spec.hist_max  = spec.hist_min;
+    ret = yk_aggregate(dbh, context->mode, nullptr, 0, "bin/", 4, &spec, &result);
+    munit_assert_int(ret, ==, YOKAN_ERR_INVALID_ARGS);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_aggregate_json(const MunitParameter params[], void* data)
+{
+    (void)params;
+    auto context = static_cast<kv_test_context*>(data);
+    yk_database_handle_t dbh = context->dbh;
+    yk_return_t ret;
+
+    if(context->empty_values) return MUNIT_SKIP;
+
+    yk_aggregate_spec_t spec;
+    spec.type      = YOKAN_FIELD_JSON;
+    spec.field     = "v";
+    spec.offset    = 0;
+    spec.hist_min  = 0.0;
+    spec.hist_max  = 0.0;
+    spec.hist_bins = 0;
+
+    // start after json/09 (exclusive), so that json/10 to json/19 are aggregated
+    yk_aggregate_t result;
+    ret = yk_aggregate(dbh, context->mode, "json/09", 7, "json/", 5, &spec, &result);
+    SKIP_IF_NOT_IMPLEMENTED(ret);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+    if(context->backend == "unordered_map") return MUNIT_OK; // keys are not sorted
+
+    munit_assert_long(result.count, ==, 10);
+    munit_assert_long(result.num_values, ==, 10);
+    munit_assert_double(result.sum, ==, 1450.0);
+    munit_assert_double(result.min, ==, 100.0);
+    munit_assert_double(result.max, ==, 190.0);
+    munit_assert_long(result.hist_bins, ==, 0);
+
+    // the entry without the field is counted but not aggregated
+    ret = yk_aggregate(dbh, context->mode, nullptr, 0, "json/", 5, &spec, &result);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+    munit_assert_long(result.count, ==, 20);
+    munit_assert_long(result.num_values, ==, 19);
+    munit_assert_double(result.sum, ==, 1830.0);
+
+    return MUNIT_OK;
+}
+
+static char* true_false_params[] = {
+    (char*)"true", (char*)"false", NULL
+};
+
+static MunitParameterEnum test_params[] = {
+  { (char*)"backend", (char**)available_backends },
+  { (char*)"no-rdma", (char**)true_false_params },
+  { (char*)"min-key-size", NULL },
+  { (char*)"max-key-size", NULL },
+  { (char*)"min-val-size", NULL },
+  { (char*)"max-val-size", NULL },
+  { (char*)"num-items", NULL },
+  { NULL, NULL }
+};
+
+static MunitTest test_suite_tests[] = {
+    { (char*) "/aggregate/binary", test_aggregate_binary,
+        test_aggregate_context_setup, kv_test_common_context_tear_down, MUNIT_TEST_OPTION_NONE, test_params },
+    { (char*) "/aggregate/json", test_aggregate_json,
+        test_aggregate_context_setup, kv_test_common_context_tear_down, MUNIT_TEST_OPTION_NONE, test_params },
+    { NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
+};
+
+static const MunitSuite test_suite = {
+    (char*) "/yk/database", test_suite_tests, NULL, 1, MUNIT_SUITE_OPTION_NONE
+};
+
+int main(int argc, char* argv[MUNIT_ARRAY_PARAM(argc + 1)]) {
+    return munit_suite_main(&test_suite, (void*) "yk", argc, argv);
+}
@@ -4,6 +4,11 @@
  * See COPYRIGHT in top-level directory.
  */
 #include <stdio.h>
+#include <string>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <unistd.h>
 #include <margo.h>
 #include <yokan/server.h>
 #include <yokan/client.h>
@@ -129,6 +134,97 @@ static MunitResult test_database(const MunitParameter params[], void* data)
         munit_assert(margo_addr_cmp(context->mid, addr2, context->addr));
         munit_assert_int(provider_id2, ==, provider_id);
     }
+    // test that we can change the eager threshold and get the protocol stats
+    {
+        size_t   threshold = 0;
+        uint64_t num_eager = 0, num_rdma = 0;
+        ret = yk_database_handle_set_eager_threshold(rh, 64);
+        munit_assert_int(ret, ==, YOKAN_SUCCESS);
+        // small put, sent inline
+        ret = yk_put(rh, YOKAN_MODE_DEFAULT, "abc", 3, "def", 3);
+        munit_assert_int(ret, ==, YOKAN_SUCCESS);
+        // large put, sent using RDMA
+        std::string big(128, 'x');
+        ret = yk_put(rh, YOKAN_MODE_DEFAULT, "ghi", 3, big.data(), big.size());
+        munit_assert_int(ret, ==, YOKAN_SUCCESS);
+        ret = yk_database_handle_get_eager_stats(rh, &threshold, &num_eager, &num_rdma);
+        munit_assert_int(ret, ==, YOKAN_SUCCESS);
+        munit_assert_long(threshold, ==, 64);
+        munit_assert_long(num_eager, ==, 1);
+        munit_assert_long(num_rdma, ==, 1);
+        ret = yk_database_handle_get_eager_stats(YOKAN_DATABASE_HANDLE_NULL,
+                                                 NULL, NULL, NULL);
+        munit_assert_int(ret, ==, YOKAN_ERR_INVALID_ARGS);
+        ret = yk_database_handle_set_eager_threshold(YOKAN_DATABASE_HANDLE_NULL, 0);
+        munit_assert_int(ret, ==, YOKAN_ERR_INVALID_ARGS);
+    }
+    // test that operations work with the registration cache enabled
+    {
+        ret = yk_client_set_registration_cache(client, 2);
+        munit_assert_int(ret, ==, YOKAN_SUCCESS);
+        ret = yk_database_handle_set_eager_threshold(rh, 0);
+        munit_assert_int(ret, ==, YOKAN_SUCCESS);
+        std::string key = "abc", val1 = "def", val2 = "ghi";
+        std::string out(3, '\0');
+        size_t vsize = out.size();
+        ret = yk_put(rh, YOKAN_MODE_DEFAULT, key.data(), key.size(), val1.data(), val1.size());
+        munit_assert_int(ret, ==, YOKAN_SUCCESS);
+        ret = yk_get(rh, YOKAN_MODE_DEFAULT, key.data(), key.size(), (void*)out.data(), &vsize);
+        munit_assert_int(ret, ==, YOKAN_SUCCESS);
+        munit_assert_string_equal(out.c_str(), "def");
+        // change the content of the value but keep the same buffer
+        val1 = val2;
+        ret = yk_put(rh, YOKAN_MODE_DEFAULT, key.data(), key.size(), val1.data(), val1.size());
+        munit_assert_int(ret, ==, YOKAN_SUCCESS);
+        vsize = out.size();
+        ret = yk_get(rh, YOKAN_MODE_DEFAULT, key.data(), key.size(), (void*)out.data(), &vsize);
+        munit_assert_int(ret, ==, YOKAN_SUCCESS);
+        munit_assert_string_equal(out.c_str(), "ghi");
+        ret = yk_client_invalidate_registrations(client, out.data(), out.size());
+        munit_assert_int(ret, ==, YOKAN_SUCCESS);
+        ret = yk_client_set_registration_cache(client, 0);
+        munit_assert_int(ret, ==, YOKAN_SUCCESS);
+        ret = yk_client_set_registration_cache(YOKAN_CLIENT_NULL, 0);
+        munit_assert_int(ret, ==, YOKAN_ERR_INVALID_ARGS);
+    }
+    // test that the retry policy can be changed
+    {
+        ret = yk_client_set_retry_policy(client, 0, 0.0, 0.0);
+        munit_assert_int(ret, ==, YOKAN_SUCCESS);
+        ret = yk_put(rh, YOKAN_MODE_DEFAULT, "abc", 3, "def", 3);
+        munit_assert_int(ret, ==, YOKAN_SUCCESS);
+        ret = yk_client_set_retry_policy(client, 10, 1.0, 500.0);
+        munit_assert_int(ret, ==, YOKAN_SUCCESS);
+        ret = yk_client_set_retry_policy(client, 10, 10.0, 1.0);
+        munit_assert_int(ret, ==, YOKAN_ERR_INVALID_ARGS);
+        ret = yk_client_set_retry_policy(YOKAN_CLIENT_NULL, 10, 1.0, 500.0);
+        munit_assert_int(ret, ==, YOKAN_ERR_INVALID_ARGS);
+    }
+    // test that operations can be traced
+    {
+        ret = yk_client_set_tracing(client, 2.0, 100);
+        munit_assert_int(ret, ==, YOKAN_ERR_INVALID_ARGS);
+        ret = yk_client_set_tracing(client, 1.0, 100);
+        munit_assert_int(ret, ==, YOKAN_SUCCESS);
+        ret = yk_put(rh, YOKAN_MODE_DEFAULT, "abc", 3, "def", 3);
+        munit_assert_int(ret, ==, YOKAN_SUCCESS);
+        char trace_file[] = "/tmp/yk-test-trace-XXXXXX";
+        int fd = mkstemp(trace_file);
+        munit_assert_int(fd, >=, 0);
+        close(fd);
+        ret = yk_client_dump_trace(client, trace_file);
+        munit_assert_int(ret, ==, YOKAN_SUCCESS);
+        std::ifstream trace_stream(trace_file);
+        std::string trace((std::istreambuf_iterator<char>(trace_stream)),
+                          std::istreambuf_iterator<char>());
+        remove(trace_file);
+        munit_assert_not_null(strstr(trace.c_str(), "\"traceEvents\""));
+        munit_assert_not_null(strstr(trace.c_str(), "\"put_direct\""));
+        ret = yk_client_set_tracing(client, 0.0, 0);
+        munit_assert_int(ret, ==, YOKAN_SUCCESS);
+        ret = yk_client_dump_trace(client, NULL);
+        munit_assert_int(ret, ==, YOKAN_ERR_INVALID_ARGS);
+    }
     // test that we can destroy the database handle
     ret = yk_database_handle_release(rh);
     munit_assert_int(ret, ==, YOKAN_SUCCESS);
@@ -0,0 +1,119 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#include "test-coll-common-setup.hpp"
+#include <yokan/collection.h>
+#include <vector>
+#include <cstring>
+#include <string>
+
+static void* test_coll_aggregate_context_setup(const MunitParameter params[], void* user_data)
+{
+    auto context = static_cast<doc_test_context*>(
+        doc_test_common_context_setup(params, user_data));
+
+    yk_collection_create(context->dbh, "abcd", 0);
+
+    // documents {"name":"docN","meta":{"i":N}} for N in [0,20),
+    // except document 7 which does not have the "meta.i" field
+    for(int i = 0; i < 20; i++) {
+        std::string doc = "{\"name\":\"doc" + std::to_string(i) + "\",\"meta\":";
+        if(i == 7) doc += "null}";
+        else doc += "{\"i\":" + std::to_string(i) + "}}";
+        yk_id_t id;
+        yk_doc_store(context->dbh, "abcd", context->mode, doc.data(), doc.size(), &id);
+    }
+
+    return context;
+}
+
+static MunitResult test_coll_aggregate(const MunitParameter params[], void* data)
+{
+    (void)params;
+    struct doc_test_context* context = (struct doc_test_context*)data;
+    yk_database_handle_t dbh = context->dbh;
+    yk_return_t ret;
+
+    yk_aggregate_spec_t spec;
+    spec.type      = YOKAN_FIELD_JSON;
+    spec.field     = "meta.i";
+    spec.offset    = 0;
+    spec.hist_min  = 0.0;
+    spec.hist_max  = 10.0;
+    spec.hist_bins = 2;
+
+    yk_aggregate_t result;
+    ret = yk_doc_aggregate(dbh, "abcd", context->mode, 0, nullptr, 0, &spec, &result);
+    SKIP_IF_NOT_IMPLEMENTED(ret);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+
+    munit_assert_long(result.count, ==, 20);
+    munit_assert_long(result.num_values, ==, 19);
+    munit_assert_double(result.sum, ==, 183.0);
+    munit_assert_double(result.min, ==, 0.0);
+    munit_assert_double(result.max, ==, 19.0);
+    munit_assert_long(result.hist_bins, ==, 2);
+    munit_assert_long(result.hist_underflow, ==, 0);
+    munit_assert_long(result.hist_overflow, ==, 10);
+    munit_assert_long(result.hist[0], ==, 5);
+    munit_assert_long(result.hist[1], ==, 4);
+
+    // starting id
+    ret = yk_doc_aggregate(dbh, "abcd", context->mode, 15, nullptr, 0, &spec, &result);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+    munit_assert_long(result.count, ==, 5);
+    munit_assert_double(result.sum, ==, 85.0);
+
+    // JSON predicate
+    const char* filter = "{\"ge\":[\"meta.i\",12]}";
+    ret = yk_doc_aggregate(dbh, "abcd", context->mode|YOKAN_MODE_JSON_FILTER, 0,
+                           filter, strlen(filter), &spec, &result);
+    SKIP_IF_NOT_IMPLEMENTED(ret);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+    munit_assert_long(result.count, ==, 8);
+    munit_assert_long(result.num_values, ==, 8);
+    munit_assert_double(result.min, ==, 12.0);
+    munit_assert_long(result.hist_overflow, ==, 8);
+
+    // collection that does not exist
+    ret = yk_doc_aggregate(dbh, "efgh", context->mode, 0, nullptr, 0, &spec, &result);
+    munit_assert_int(ret, ==, YOKAN_ERR_KEY_NOT_FOUND);
+
+    // invalid arguments
+    ret = yk_doc_aggregate(dbh, "abcd", context->mode, 0, nullptr, 0, nullptr, &result);
+    munit_assert_int(ret, ==, YOKAN_ERR_INVALID_ARGS);
+    ret = yk_doc_aggregate(dbh, "abcd", context->mode, 0, nullptr, 0, &spec, nullptr);
+    munit_assert_int(ret, ==, YOKAN_ERR_INVALID_ARGS);
+
+    return MUNIT_OK;
+}
+
+static char* no_rdma_params[] = {
+    (char*)"true", (char*)"false", NULL
+};
+
+static MunitParameterEnum test_params[] = {
+  { (char*)"backend", (char**)available_backends },
+  { (char*)"no-rdma", (char**)no_rdma_params },
+  { (char*)"min-val-size", NULL },
+  { (char*)"max-val-size", NULL },
+  { (char*)"num-items", NULL },
+  { NULL, NULL }
+};
+
+static MunitTest test_suite_tests[] = {
+    { (char*) "/coll/aggregate", test_coll_aggregate,
+        test_coll_aggregate_context_setup, doc_test_common_context_tear_down,
+        MUNIT_TEST_OPTION_NONE, test_params },
+    { NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
+};
+
+static const MunitSuite test_suite = {
+    (char*) "/yk/database", test_suite_tests, NULL, 1, MUNIT_SUITE_OPTION_NONE
+};
+
+int main(int argc, char* argv[MUNIT_ARRAY_PARAM(argc + 1)]) {
+    return munit_suite_main(&test_suite, (void*) "yk", argc, argv);
+}
@@ -117,6 +117,23 @@ static MunitResult test_coll_create_store_size_last_id(const MunitParameter para
     SKIP_IF_NOT_IMPLEMENTED(ret);
     munit_assert_int(ret, ==, YOKAN_ERR_KEY_NOT_FOUND);
 
+    /* a collection with the same name starts empty */
+    ret = yk_collection_create(dbh, "abcd", 0);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+
+    ret = yk_collection_size(dbh, "abcd", 0, &size);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+    munit_assert_long(size, ==, 0);
+
+    yk_id_t id;
+    ret = yk_doc_store(dbh, "abcd", 0, "new document", 12, &id);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+    munit_assert_long(id, ==, 0);
+
+    ret = yk_collection_size(dbh, "abcd", 0, &size);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+    munit_assert_long(size, ==, 1);
+
     return MUNIT_OK;
 }
 
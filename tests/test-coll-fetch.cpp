@@ -5,6 +5,7 @@
  */
 #include "test-coll-common-setup.hpp"
 #include <yokan/collection.h>
+#include <algorithm>
 #include <functional>
 #include <numeric>
 #include <vector>
@@ -260,6 +261,108 @@ static MunitResult test_doc_fetch_multi_id_not_found(const MunitParameter params
     return MUNIT_OK;
 }
 
+/**
+ * @brief Check that a filter passed to doc_fetch_multi_filtered projects
+ * the documents, and that documents that do not pass it are reported
+ * as not found.
+ */
+static MunitResult test_doc_fetch_filtered(const MunitParameter params[], void* data)
+{
+    (void)params;
+    (void)data;
+    struct doc_test_context* context = (struct doc_test_context*)data;
+    yk_database_handle_t dbh = context->dbh;
+    yk_return_t ret;
+
+    const char* use_pool_str   = munit_parameters_get(params, "use-pool");
+    const char* batch_size_str = munit_parameters_get(params, "batch-size");
+
+    yk_doc_fetch_options_t options;
+    if(strcmp(use_pool_str, "true") == 0)
+        margo_get_progress_pool(context->mid, &options.pool);
+    else
+        options.pool = ABT_POOL_NULL;
+    options.batch_size = atol(batch_size_str);
+
+    struct func_args {
+        std::vector<yk_id_t>     recv_ids;
+        std::vector<std::string> recv_values;
+        std::vector<size_t>      recv_sizes;
+    };
+
+    auto func = [](void* uargs, size_t i, yk_id_t id,
+                   const void* data, size_t size) {
+        auto args = (func_args*)uargs;
+        munit_assert_int(i, ==, args->recv_ids.size());
+        args->recv_ids.emplace_back(id);
+        args->recv_sizes.emplace_back(size);
+        if(size <= YOKAN_LAST_VALID_SIZE)
+            args->recv_values.emplace_back((const char*)data, size);
+        else
+            args->recv_values.emplace_back();
+        return YOKAN_SUCCESS;
+    };
+
+    // every document, projected onto its bytes [1, 5)
+    std::vector<yk_id_t> ids;
+    for(yk_id_t i = 0; i < context->reference.size(); i++)
+        ids.push_back(i);
+    std::string query = "{\"range\":[1,4]}";
+
+    func_args args;
+    ret = yk_doc_fetch_multi_filtered(dbh, "abcd", context->mode|YOKAN_MODE_JSON_FILTER,
+                                      ids.size(), ids.data(), query.data(), query.size(),
+                                      func, &args, &options);
+    SKIP_IF_NOT_IMPLEMENTED(ret);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+
+    munit_assert_size(args.recv_values.size(), ==, context->reference.size());
+    for(size_t i = 0; i < context->reference.size(); i++) {
+        auto& ref = context->reference[i];
+        auto expected = ref.substr(std::min<size_t>(1, ref.size()), 4);
+        munit_assert_long(args.recv_sizes[i], ==, expected.size());
+        munit_assert_memory_equal(expected.size(), args.recv_values[i].data(), expected.data());
+    }
+
+    // JSON documents, only some of which pass the filter
+    ret = yk_collection_create(dbh, "json", 0);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+    for(size_t i = 0; i < 4; i++) {
+        std::string doc = "{\"name\":\"doc" + std::to_string(i) + "\","
+                          "\"meta\":{\"i\":" + std::to_string(i) + "}}";
+        yk_id_t id;
+        ret = yk_doc_store(dbh, "json", context->mode, doc.data(), doc.size(), &id);
+        munit_assert_int(ret, ==, YOKAN_SUCCESS);
+    }
+    query = "{\"where\":{\"ge\":[\"meta.i\",2]},\"select\":[\"name\"]}";
+    std::vector<yk_id_t> json_ids = {3, 1, 2, 0};
+    args = func_args{};
+    ret = yk_doc_fetch_multi_filtered(dbh, "json", context->mode|YOKAN_MODE_JSON_FILTER,
+                                      json_ids.size(), json_ids.data(), query.data(), query.size(),
+                                      func, &args, &options);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+    munit_assert_size(args.recv_sizes.size(), ==, 4);
+    munit_assert_string_equal(args.recv_values[0].c_str(), "{\"name\":\"doc3\"}");
+    munit_assert_long(args.recv_sizes[1], ==, YOKAN_KEY_NOT_FOUND);
+    munit_assert_string_equal(args.recv_values[2].c_str(), "{\"name\":\"doc2\"}");
+    munit_assert_long(args.recv_sizes[3], ==, YOKAN_KEY_NOT_FOUND);
+
+    // single document
+    args = func_args{};
+    ret = yk_doc_fetch_filtered(dbh, "json", context->mode|YOKAN_MODE_JSON_FILTER, 2,
+                                query.data(), query.size(), func, &args);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+    munit_assert_string_equal(args.recv_values[0].c_str(), "{\"name\":\"doc2\"}");
+
+    // invalid filter
+    std::string bad_query = "{\"where\":";
+    ret = yk_doc_fetch_filtered(dbh, "json", context->mode|YOKAN_MODE_JSON_FILTER, 2,
+                                bad_query.data(), bad_query.size(), func, &args);
+    munit_assert_int(ret, ==, YOKAN_ERR_INVALID_FILTER);
+
+    return MUNIT_OK;
+}
+
 static char* true_false_params[] = {
     (char*)"true", (char*)"false", (char*)NULL };
 
@@ -297,6 +400,8 @@ static MunitTest test_suite_tests[] = {
         test_doc_fetch_context_setup, doc_test_common_context_tear_down, MUNIT_TEST_OPTION_NONE, test_multi_params },
     { (char*) "/doc_fetch_multi/id-not-found", test_doc_fetch_multi_id_not_found,
         test_doc_fetch_context_setup, doc_test_common_context_tear_down, MUNIT_TEST_OPTION_NONE, test_multi_params },
+    { (char*) "/doc_fetch_multi/filtered", test_doc_fetch_filtered,
+        test_doc_fetch_context_setup, doc_test_common_context_tear_down, MUNIT_TEST_OPTION_NONE, test_multi_params },
     { NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
 };
 
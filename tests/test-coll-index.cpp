@@ -0,0 +1,338 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#include "test-coll-common-setup.hpp"
+#include <yokan/collection.h>
+#include <vector>
+#include <cstring>
+#include <string>
+
+static std::string make_doc(int n, int i) {
+    return "{\"name\":\"doc" + std::to_string(n) + "\",\"meta\":{\"i\":" + std::to_string(i) + "}}";
+}
+
+static void* test_coll_index_context_setup(const MunitParameter params[], void* user_data)
+{
+    auto context = static_cast<doc_test_context*>(
+        doc_test_common_context_setup(params, user_data));
+
+    yk_collection_create(context->dbh, "abcd", 0);
+
+    // documents {"name":"docN","meta":{"i":N%5}} for N in [0,20)
+    for(int n = 0; n < 20; n++) {
+        auto doc = make_doc(n, n % 5);
+        yk_id_t id;
+        yk_doc_store(context->dbh, "abcd", context->mode, doc.data(), doc.size(), &id);
+    }
+
+    return context;
+}
+
+static void check_ids(const std::vector<yk_id_t>& ids, const std::vector<yk_id_t>& expected) {
+    for(size_t i = 0; i < ids.size(); i++) {
+        if(i < expected.size())
+            munit_assert_long(ids[i], ==, expected[i]);
+        else
+            munit_assert_long(ids[i], ==, YOKAN_NO_MORE_DOCS);
+    }
+}
+
+static MunitResult test_coll_index(const MunitParameter params[], void* data)
+{
+    (void)params;
+    struct doc_test_context* context = (struct doc_test_context*)data;
+    yk_database_handle_t dbh = context->dbh;
+    yk_return_t ret;
+    auto mode = context->mode;
+
+    yk_index_spec_t spec;
+    spec.type      = YOKAN_FIELD_JSON;
+    spec.field     = "meta.i";
+    spec.offset    = 0;
+    spec.extractor = nullptr;
+
+    ret = yk_collection_create_index(dbh, "abcd", mode, "i", &spec);
+    SKIP_IF_NOT_IMPLEMENTED(ret);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+
+    ret = yk_collection_create_index(dbh, "abcd", mode, "i", &spec);
+    munit_assert_int(ret, ==, YOKAN_ERR_KEY_EXISTS);
+
+    std::vector<yk_id_t> ids(6);
+    const char* three = "3";
+    const char* one   = "1";
+
+    // equality
+    ret = yk_doc_query(dbh, "abcd", mode|YOKAN_MODE_INCLUSIVE, "i",
+                       three, 1, three, 1, nullptr, ids.size(), ids.data());
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+    check_ids(ids, {3, 8, 13, 18});
+
+    // equality, page by page
+    char pos_buffer[64];
+    yk_query_position_t position = { pos_buffer, 0, sizeof(pos_buffer) };
+    std::vector<yk_id_t> page(2);
+    ret = yk_doc_query(dbh, "abcd", mode|YOKAN_MODE_INCLUSIVE, "i",
+                       three, 1, three, 1, &position, page.size(), page.data());
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+    check_ids(page, {3, 8});
+    ret = yk_doc_query(dbh, "abcd", mode|YOKAN_MODE_INCLUSIVE, "i",
+                       three, 1, three, 1, &position, page.size(), page.data());
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+    check_ids(page, {13, 18});
+    ret = yk_doc_query(dbh, "abcd", mode|YOKAN_MODE_INCLUSIVE, "i",
+                       three, 1, three, 1, &position, page.size(), page.data());
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+    check_ids(page, {});
+
+    // position buffer too small
+    yk_query_position_t small_position = { pos_buffer, 0, 4 };
+    ret = yk_doc_query(dbh, "abcd", mode|YOKAN_MODE_INCLUSIVE, "i",
+                       three, 1, three, 1, &small_position, page.size(), page.data());
+    munit_assert_int(ret, ==, YOKAN_ERR_BUFFER_SIZE);
+    munit_assert_size(small_position.size, ==, 0);
+
+    // range [1, 3), in index order, limited to the first entries
+    ret = yk_doc_query(dbh, "abcd", mode, "i",
+                       one, 1, three, 1, nullptr, ids.size(), ids.data());
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+    check_ids(ids, {1, 6, 11, 16, 2, 7});
+
+    // the rest of the range, resuming after the last entry
+    position.size = 0;
+    ret = yk_doc_query(dbh, "abcd", mode, "i",
+                       one, 1, three, 1, &position, ids.size(), ids.data());
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+    ret = yk_doc_query(dbh, "abcd", mode, "i",
+                       one, 1, three, 1, &position, ids.size(), ids.data());
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+    check_ids(ids, {12, 17});
+
+    // no lower bound
+    ret = yk_doc_query(dbh, "abcd", mode, "i",
+                       nullptr, 0, one, 1, nullptr, ids.size(), ids.data());
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+    check_ids(ids, {0, 5, 10, 15});
+
+    // documents along with their ids
+    std::vector<char>   docs(1024);
+    std::vector<size_t> doc_sizes(ids.size());
+    ret = yk_doc_query_packed(dbh, "abcd", mode|YOKAN_MODE_INCLUSIVE, "i",
+                              three, 1, three, 1, nullptr, ids.size(), ids.data(),
+                              docs.size(), docs.data(), doc_sizes.data());
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+    check_ids(ids, {3, 8, 13, 18});
+    size_t offset = 0;
+    for(size_t i = 0; i < 4; i++) {
+        auto expected = make_doc(ids[i], 3);
+        munit_assert_long(doc_sizes[i], ==, expected.size());
+        munit_assert_memory_equal(expected.size(), docs.data() + offset, expected.data());
+        offset += doc_sizes[i];
+    }
+    munit_assert_long(doc_sizes[4], ==, YOKAN_NO_MORE_DOCS);
+
+    // the index follows updates, erasures, and new documents
+    auto updated = make_doc(3, 4);
+    ret = yk_doc_update(dbh, "abcd", mode, 3, updated.data(), updated.size());
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+    ret = yk_doc_erase(dbh, "abcd", mode, 8);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+    auto stored = make_doc(20, 3);
+    yk_id_t id;
+    ret = yk_doc_store(dbh, "abcd", mode, stored.data(), stored.size(), &id);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+    ret = yk_doc_query(dbh, "abcd", mode|YOKAN_MODE_INCLUSIVE, "i",
+                       three, 1, three, 1, nullptr, ids.size(), ids.data());
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+    check_ids(ids, {13, 18, 20});
+
+    // invalid bound, unknown index, unknown collection
+    ret = yk_doc_query(dbh, "abcd", mode, "i",
+                       "true", 4, nullptr, 0, nullptr, ids.size(), ids.data());
+    munit_assert_int(ret, ==, YOKAN_ERR_INVALID_ARGS);
+    ret = yk_doc_query(dbh, "abcd", mode, "j",
+                       nullptr, 0, nullptr, 0, nullptr, ids.size(), ids.data());
+    munit_assert_int(ret, ==, YOKAN_ERR_KEY_NOT_FOUND);
+    ret = yk_doc_query(dbh, "efgh", mode, "i",
+                       nullptr, 0, nullptr, 0, nullptr, ids.size(), ids.data());
+    munit_assert_int(ret, ==, YOKAN_ERR_KEY_NOT_FOUND);
+
+    // dropping the index
+    ret = yk_collection_drop_index(dbh, "abcd", mode, "i");
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+    ret = yk_collection_drop_index(dbh, "abcd", mode, "i");
+    munit_assert_int(ret, ==, YOKAN_ERR_KEY_NOT_FOUND);
+    ret = yk_doc_query(dbh, "abcd", mode, "i",
+                       nullptr, 0, nullptr, 0, nullptr, ids.size(), ids.data());
+    munit_assert_int(ret, ==, YOKAN_ERR_KEY_NOT_FOUND);
+
+    return MUNIT_OK;
+}
+
+/**
+ * @brief Check that a batch updating the same document twice only
+ * leaves the last version in the index, and that an index entry that
+ * does not match the current version of its document is skipped by
+ * queries and erased.
+ */
+static MunitResult test_coll_index_stale(const MunitParameter params[], void* data)
+{
+    (void)params;
+    struct doc_test_context* context = (struct doc_test_context*)data;
+    yk_database_handle_t dbh = context->dbh;
+    yk_return_t ret;
+    auto mode = context->mode;
+
+    yk_index_spec_t spec;
+    spec.type      = YOKAN_FIELD_JSON;
+    spec.field     = "meta.i";
+    spec.offset    = 0;
+    spec.extractor = nullptr;
+
+    ret = yk_collection_create_index(dbh, "abcd", mode, "i", &spec);
+    SKIP_IF_NOT_IMPLEMENTED(ret);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+
+    // document 1 goes through i=4 then i=2 in the same batch
+    auto first  = make_doc(1, 4);
+    auto second = make_doc(1, 2);
+    std::vector<yk_id_t> update_ids = {1, 1};
+    std::vector<const void*> update_docs = { first.data(), second.data() };
+    std::vector<size_t> update_sizes = { first.size(), second.size() };
+    ret = yk_doc_update_multi(dbh, "abcd", mode, 2, update_ids.data(),
+                              update_docs.data(), update_sizes.data());
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+
+    std::vector<yk_id_t> ids(6);
+    const char* four = "4";
+    ret = yk_doc_query(dbh, "abcd", mode|YOKAN_MODE_INCLUSIVE, "i",
+                       four, 1, four, 1, nullptr, ids.size(), ids.data());
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+    check_ids(ids, {4, 9, 14, 19});
+    const char* two = "2";
+    ret = yk_doc_query(dbh, "abcd", mode|YOKAN_MODE_INCLUSIVE, "i",
+                       two, 1, two, 1, nullptr, ids.size(), ids.data());
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+    check_ids(ids, {1, 2, 7, 12, 17});
+
+    // an entry left behind by an interrupted update, claiming that
+    // document 3 has the name "doc99", put directly in the database
+    spec.field = "name";
+    ret = yk_collection_create_index(dbh, "abcd", mode, "n", &spec);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+    std::string stale("\0abcd\0n\0\x02" "doc99", 14);
+    stale.append(2, '\0');
+    stale.append(7, '\0');
+    stale.push_back('\x03');
+    ret = yk_put(dbh, 0, stale.data(), stale.size(), "", 0);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+
+    const char* name = "\"doc99\"";
+    ret = yk_doc_query(dbh, "abcd", mode|YOKAN_MODE_INCLUSIVE, "n",
+                       name, strlen(name), name, strlen(name),
+                       nullptr, ids.size(), ids.data());
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+    check_ids(ids, {});
+
+    uint8_t exists = 1;
+    ret = yk_exists(dbh, 0, stale.data(), stale.size(), &exists);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+    munit_assert_int(exists, ==, 0);
+
+    // the entry of the current version is still there
+    name = "\"doc3\"";
+    ret = yk_doc_query(dbh, "abcd", mode|YOKAN_MODE_INCLUSIVE, "n",
+                       name, strlen(name), name, strlen(name),
+                       nullptr, ids.size(), ids.data());
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+    check_ids(ids, {3});
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_coll_index_binary(const MunitParameter params[], void* data)
+{
+    (void)params;
+    struct doc_test_context* context = (struct doc_test_context*)data;
+    yk_database_handle_t dbh = context->dbh;
+    yk_return_t ret;
+    auto mode = context->mode;
+
+    yk_index_spec_t spec;
+    spec.type      = YOKAN_FIELD_INT32;
+    spec.field     = nullptr;
+    spec.offset    = 0;
+    spec.extractor = nullptr;
+
+    yk_collection_create(dbh, "efgh", 0);
+    ret = yk_collection_create_index(dbh, "efgh", mode, "x", &spec);
+    SKIP_IF_NOT_IMPLEMENTED(ret);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+
+    std::vector<int32_t> values = {3, -1, 1000, 0, -70000};
+    for(auto& v : values) {
+        yk_id_t id;
+        ret = yk_doc_store(dbh, "efgh", mode, &v, sizeof(v), &id);
+        munit_assert_int(ret, ==, YOKAN_SUCCESS);
+    }
+
+    // [-1, 1000], with negative numbers sorted before positive ones
+    int32_t lower = -1, upper = 1000;
+    std::vector<yk_id_t> ids(5);
+    ret = yk_doc_query(dbh, "efgh", mode|YOKAN_MODE_INCLUSIVE, "x",
+                       &lower, sizeof(lower), &upper, sizeof(upper),
+                       nullptr, ids.size(), ids.data());
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+    check_ids(ids, {1, 3, 0, 2});
+
+    // bounds must have the size of the field
+    ret = yk_doc_query(dbh, "efgh", mode, "x",
+                       &lower, 2, nullptr, 0, nullptr, ids.size(), ids.data());
+    munit_assert_int(ret, ==, YOKAN_ERR_INVALID_ARGS);
+
+    // dropping the collection drops its index
+    ret = yk_collection_drop(dbh, "efgh", mode);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+    yk_collection_create(dbh, "efgh", 0);
+    ret = yk_doc_query(dbh, "efgh", mode, "x",
+                       nullptr, 0, nullptr, 0, nullptr, ids.size(), ids.data());
+    munit_assert_int(ret, ==, YOKAN_ERR_KEY_NOT_FOUND);
+
+    return MUNIT_OK;
+}
+
+static char* no_rdma_params[] = {
+    (char*)"true", (char*)"false", NULL
+};
+
+static MunitParameterEnum test_params[] = {
+  { (char*)"backend", (char**)available_backends },
+  { (char*)"no-rdma", (char**)no_rdma_params },
+  { (char*)"min-val-size", NULL },
+  { (char*)"max-val-size", NULL },
+  { (char*)"num-items", NULL },
+  { NULL, NULL }
+};
+
+static MunitTest test_suite_tests[] = {
+    { (char*) "/coll/index", test_coll_index,
+        test_coll_index_context_setup, doc_test_common_context_tear_down,
+        MUNIT_TEST_OPTION_NONE, test_params },
+    { (char*) "/coll/index/stale", test_coll_index_stale,
+        test_coll_index_context_setup, doc_test_common_context_tear_down,
+        MUNIT_TEST_OPTION_NONE, test_params },
+    { (char*) "/coll/index/binary", test_coll_index_binary,
+        test_coll_index_context_setup, doc_test_common_context_tear_down,
+        MUNIT_TEST_OPTION_NONE, test_params },
+    { NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
+};
+
+static const MunitSuite test_suite = {
+    (char*) "/yk/database", test_suite_tests, NULL, 1, MUNIT_SUITE_OPTION_NONE
+};
+
+int main(int argc, char* argv[MUNIT_ARRAY_PARAM(argc + 1)]) {
+    return munit_suite_main(&test_suite, (void*) "yk", argc, argv);
+}
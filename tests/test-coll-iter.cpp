@@ -170,6 +170,81 @@ static MunitResult test_coll_iter_lua(const MunitParameter params[], void* data)
     return MUNIT_OK;
 }
 
+static MunitResult test_coll_iter_projection(const MunitParameter params[], void* data)
+{
+    (void)params;
+    (void)data;
+    struct doc_test_context* context = (struct doc_test_context*)data;
+    yk_database_handle_t dbh = context->dbh;
+    yk_return_t ret;
+
+    // every document, projected onto its bytes [1, 5)
+    std::string query = "{\"range\":[1,4]}";
+
+    struct doc_iter_context {
+        std::vector<yk_id_t>     recv_ids;
+        std::vector<std::string> recv_docs;
+    };
+
+    doc_iter_context result;
+
+    auto func = [](void* u, size_t i, yk_id_t id, const void* doc, size_t docsize) -> yk_return_t {
+        (void)i;
+        auto result = static_cast<doc_iter_context*>(u);
+        result->recv_ids.push_back(id);
+        result->recv_docs.emplace_back((const char*)doc, docsize);
+        return YOKAN_SUCCESS;
+    };
+
+    yk_doc_iter_options_t options;
+    options.batch_size = atol(munit_parameters_get(params, "batch-size"));
+    if(to_bool(munit_parameters_get(params, "use-pool"))) {
+        margo_get_progress_pool(context->mid, &options.pool);
+    } else {
+        options.pool = ABT_POOL_NULL;
+    }
+
+    ret = yk_doc_iter(dbh, "abcd", context->mode|YOKAN_MODE_JSON_FILTER,
+                      0, query.data(), query.size(), context->reference.size(),
+                      func, (void*)&result, &options);
+    SKIP_IF_NOT_IMPLEMENTED(ret);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+
+    munit_assert_size(result.recv_ids.size(), ==, context->reference.size());
+    for(size_t i = 0; i < result.recv_ids.size(); i++) {
+        munit_assert_uint64(result.recv_ids[i], ==, i);
+        auto& ref = context->reference[i];
+        auto expected = ref.substr(std::min<size_t>(1, ref.size()), 4);
+        munit_assert_size(result.recv_docs[i].size(), ==, expected.size());
+        munit_assert_memory_equal(expected.size(), result.recv_docs[i].data(), expected.data());
+    }
+
+    // JSON documents, projected onto some of their fields
+    ret = yk_collection_create(dbh, "json", 0);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+    for(size_t i = 0; i < 6; i++) {
+        std::string doc = "{\"name\":\"doc" + std::to_string(i) + "\","
+                          "\"meta\":{\"i\":" + std::to_string(i) + "}}";
+        yk_id_t id;
+        ret = yk_doc_store(dbh, "json", context->mode, doc.data(), doc.size(), &id);
+        munit_assert_int(ret, ==, YOKAN_SUCCESS);
+    }
+    query = "{\"where\":{\"ge\":[\"meta.i\",3]},\"select\":[\"meta.i\"]}";
+    result = doc_iter_context{};
+    ret = yk_doc_iter(dbh, "json", context->mode|YOKAN_MODE_JSON_FILTER,
+                      0, query.data(), query.size(), 6,
+                      func, (void*)&result, &options);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+    munit_assert_size(result.recv_ids.size(), ==, 3);
+    for(size_t i = 0; i < 3; i++) {
+        munit_assert_uint64(result.recv_ids[i], ==, i+3);
+        auto expected = "{\"meta.i\":" + std::to_string(i+3) + "}";
+        munit_assert_string_equal(result.recv_docs[i].c_str(), expected.c_str());
+    }
+
+    return MUNIT_OK;
+}
+
 static MunitResult test_coll_iter_custom_filter(const MunitParameter params[], void* data)
 {
     (void)params;
@@ -252,6 +327,8 @@ static MunitTest test_suite_tests[] = {
         test_coll_iter_context_setup, doc_test_common_context_tear_down, MUNIT_TEST_OPTION_NONE, test_params },
     { (char*) "/coll/iter/lua", test_coll_iter_lua,
         test_coll_iter_context_setup, doc_test_common_context_tear_down, MUNIT_TEST_OPTION_NONE, test_params },
+    { (char*) "/coll/iter/projection", test_coll_iter_projection,
+        test_coll_iter_context_setup, doc_test_common_context_tear_down, MUNIT_TEST_OPTION_NONE, test_params },
     { (char*) "/coll/iter/custom_filter", test_coll_iter_custom_filter,
         test_coll_iter_context_setup, doc_test_common_context_tear_down, MUNIT_TEST_OPTION_NONE, test_params },
     { NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
@@ -10,6 +10,8 @@
 #include <vector>
 #include <array>
 #include <iostream>
+#include <cstring>
+#include <string>
 
 static size_t g_items_per_op = 6;
 
@@ -306,6 +308,61 @@ static MunitResult test_coll_list_packed_lua(const MunitParameter params[], void
     return MUNIT_OK;
 }
 
+/**
+ * @brief Check that Lua code that does not compile is rejected, and
+ * that the globals set by a Lua filter are not seen by later queries.
+ */
+static MunitResult test_coll_list_lua_env(const MunitParameter params[], void* data)
+{
+    (void)params;
+    (void)data;
+    struct doc_test_context* context = (struct doc_test_context*)data;
+    yk_database_handle_t dbh = context->dbh;
+    yk_return_t ret;
+
+    if(context->reference.empty() || g_items_per_op < 2)
+        return MUNIT_SKIP;
+
+    std::vector<std::vector<char>> buffers(g_items_per_op);
+    for(auto& v : buffers) v.resize(g_max_val_size);
+
+    std::vector<void*> buf_ptrs;
+    std::vector<size_t> buf_sizes;
+    for(auto& v : buffers) {
+        buf_ptrs.push_back(v.data());
+        buf_sizes.push_back(g_max_val_size);
+    }
+    std::vector<yk_id_t> ids(g_items_per_op);
+
+    int32_t mode = YOKAN_MODE_LUA_FILTER|context->mode;
+
+    const char* invalid_code = "return ((";
+    for(int i = 0; i < 2; i++) {
+        ret = yk_doc_list(dbh, "abcd", mode, 0,
+                          invalid_code, strlen(invalid_code),
+                          g_items_per_op, ids.data(),
+                          buf_ptrs.data(), buf_sizes.data());
+        SKIP_IF_NOT_IMPLEMENTED(ret);
+        munit_assert_int(ret, ==, YOKAN_ERR_INVALID_FILTER);
+    }
+
+    /* only the first document seen by a filter matches */
+    const char* counting_code = "count = (count or 0) + 1\nreturn count == 1";
+    for(int i = 0; i < 2; i++) {
+        ret = yk_doc_list(dbh, "abcd", mode, 0,
+                          counting_code, strlen(counting_code),
+                          g_items_per_op, ids.data(),
+                          buf_ptrs.data(), buf_sizes.data());
+        SKIP_IF_NOT_IMPLEMENTED(ret);
+        munit_assert_int(ret, ==, YOKAN_SUCCESS);
+        munit_assert_long(ids[0], ==, 0);
+        munit_assert_long(ids[1], ==, YOKAN_NO_MORE_DOCS);
+        for(auto& size : buf_sizes) size = g_max_val_size;
+    }
+
+    return MUNIT_OK;
+}
+
 static MunitResult test_coll_list_custom_filter(const MunitParameter params[], void* data)
 {
     (void)params;
@@ -351,6 +408,91 @@ static MunitResult test_coll_list_custom_filter(const MunitParameter params[], v
     return MUNIT_OK;
 }
 
+static MunitResult test_coll_list_json(const MunitParameter params[], void* data)
+{
+    (void)params;
+    (void)data;
+    struct doc_test_context* context = (struct doc_test_context*)data;
+    yk_database_handle_t dbh = context->dbh;
+    yk_return_t ret;
+
+    ret = yk_collection_create(dbh, "json", 0);
+    SKIP_IF_NOT_IMPLEMENTED(ret);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+
+    const size_t num_docs = 10;
+    for(size_t i = 0; i < num_docs; i++) {
+        std::string doc = "{\"name\":\"doc" + std::to_string(i) + "\","
+                          "\"meta\":{\"i\":" + std::to_string(i) + ",\"tags\":[\"x\"]}}";
+        yk_id_t id;
+        ret = yk_doc_store(dbh, "json", context->mode, doc.data(), doc.size(), &id);
+        munit_assert_int(ret, ==, YOKAN_SUCCESS);
+    }
+
+    std::vector<std::vector<char>> buffers(num_docs);
+    std::vector<void*> buf_ptrs;
+    std::vector<size_t> buf_sizes(num_docs, 128);
+    for(auto& b : buffers) {
+        b.resize(128);
+        buf_ptrs.push_back(b.data());
+    }
+    std::vector<yk_id_t> ids(num_docs);
+
+    std::string filter = "{\"and\":[{\"ge\":[\"meta.i\",3]},{\"lt\":[\"meta.i\",7]},"
+                         "{\"exists\":\"meta.tags.0\"},{\"ne\":[\"name\",\"doc5\"]}]}";
+    ret = yk_doc_list(dbh, "json", YOKAN_MODE_JSON_FILTER|context->mode, 0,
+            filter.data(), filter.size(), num_docs, ids.data(),
+            buf_ptrs.data(), buf_sizes.data());
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+
+    const yk_id_t expected[] = { 3, 4, 6 };
+    for(size_t i = 0; i < num_docs; i++) {
+        if(i >= 3) {
+            munit_assert_long(buf_sizes[i], ==, YOKAN_NO_MORE_DOCS);
+            continue;
+        }
+        munit_assert_long(ids[i], ==, expected[i]);
+        std::string doc(buffers[i].data(), buf_sizes[i]);
+        munit_assert_not_null(strstr(doc.c_str(),
+            ("\"doc" + std::to_string(expected[i]) + "\"").c_str()));
+    }
+
+    // same filter, projecting the documents onto some of their fields
+    std::string query = "{\"where\":" + filter + ",\"select\":[\"meta.i\",\"nope\"]}";
+    std::fill(buf_sizes.begin(), buf_sizes.end(), 128);
+    ret = yk_doc_list(dbh, "json", YOKAN_MODE_JSON_FILTER|context->mode, 0,
+            query.data(), query.size(), num_docs, ids.data(),
+            buf_ptrs.data(), buf_sizes.data());
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+    for(size_t i = 0; i < 3; i++) {
+        munit_assert_long(ids[i], ==, expected[i]);
+        std::string doc(buffers[i].data(), buf_sizes[i]);
+        std::string expected_doc = "{\"meta.i\":" + std::to_string(expected[i]) + "}";
+        munit_assert_string_equal(doc.c_str(), expected_doc.c_str());
+    }
+
+    // same filter, projecting the documents onto a byte range
+    query = "{\"where\":" + filter + ",\"range\":[2,4]}";
+    std::fill(buf_sizes.begin(), buf_sizes.end(), 128);
+    ret = yk_doc_list(dbh, "json", YOKAN_MODE_JSON_FILTER|context->mode, 0,
+            query.data(), query.size(), num_docs, ids.data(),
+            buf_ptrs.data(), buf_sizes.data());
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+    for(size_t i = 0; i < 3; i++) {
+        munit_assert_long(ids[i], ==, expected[i]);
+        munit_assert_long(buf_sizes[i], ==, 4);
+        munit_assert_memory_equal(4, buffers[i].data(), "name");
+    }
+
+    std::string bad_filter = "{\"between\":[\"meta.i\",1,2]}";
+    ret = yk_doc_list(dbh, "json", YOKAN_MODE_JSON_FILTER|context->mode, 0,
+            bad_filter.data(), bad_filter.size(), num_docs, ids.data(),
+            buf_ptrs.data(), buf_sizes.data());
+    munit_assert_int(ret, ==, YOKAN_ERR_INVALID_FILTER);
+
+    return MUNIT_OK;
+}
+
 static char* no_rdma_params[] = {
     (char*)"true", (char*)"false", (char*)NULL };
 
@@ -374,8 +516,12 @@ static MunitTest test_suite_tests[] = {
         test_coll_list_context_setup, doc_test_common_context_tear_down, MUNIT_TEST_OPTION_NONE, test_params },
     { (char*) "/coll/list_packed/lua", test_coll_list_packed_lua,
         test_coll_list_context_setup, doc_test_common_context_tear_down, MUNIT_TEST_OPTION_NONE, test_params },
+    { (char*) "/coll/list/lua/env", test_coll_list_lua_env,
+        test_coll_list_context_setup, doc_test_common_context_tear_down, MUNIT_TEST_OPTION_NONE, test_params },
     { (char*) "/coll/list/custom_filter", test_coll_list_custom_filter,
         test_coll_list_context_setup, doc_test_common_context_tear_down, MUNIT_TEST_OPTION_NONE, test_params },
+    { (char*) "/coll/list/json", test_coll_list_json,
+        test_coll_list_context_setup, doc_test_common_context_tear_down, MUNIT_TEST_OPTION_NONE, test_params },
     { NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
 };
 
@@ -241,6 +241,87 @@ static MunitResult test_coll_load_packed(const MunitParameter params[], void* da
     return MUNIT_OK;
 }
 
+static MunitResult test_coll_load_filtered(const MunitParameter params[], void* data)
+{
+    (void)params;
+    (void)data;
+    struct doc_test_context* context = (struct doc_test_context*)data;
+    yk_database_handle_t dbh = context->dbh;
+    yk_return_t ret;
+    auto mode = context->mode|YOKAN_MODE_JSON_FILTER;
+
+    // the documents projected onto their bytes [1, 5), in a buffer
+    // only large enough for the projections
+    std::string query = "{\"range\":[1,4]}";
+    std::vector<char> buffer(4*g_num_items);
+    std::vector<size_t> sizes(g_num_items+1);
+    std::vector<yk_id_t> ids;
+    ids.push_back(g_num_items); /* id that does not exist */
+    for(unsigned i=0; i < g_num_items; i++)
+        ids.push_back(i);
+
+    ret = yk_doc_load_packed_filtered(dbh, "abcd", mode, g_num_items+1, ids.data(),
+            query.data(), query.size(), buffer.size(), buffer.data(), sizes.data());
+    SKIP_IF_NOT_IMPLEMENTED(ret);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+
+    munit_assert_long(sizes[0], ==, YOKAN_KEY_NOT_FOUND);
+    size_t offset = 0;
+    for(unsigned i=1; i < g_num_items+1; i++) {
+        auto& ref = context->reference[ids[i]];
+        auto expected = ref.substr(std::min<size_t>(1, ref.size()), 4);
+        munit_assert_long(sizes[i], ==, expected.size());
+        munit_assert_memory_equal(expected.size(), buffer.data()+offset, expected.data());
+        offset += sizes[i];
+    }
+
+    // JSON documents, projected onto some of their fields
+    ret = yk_collection_create(dbh, "json", 0);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+    for(size_t i = 0; i < 4; i++) {
+        std::string doc = "{\"name\":\"doc" + std::to_string(i) + "\","
+                          "\"meta\":{\"i\":" + std::to_string(i) + "}}";
+        yk_id_t id;
+        ret = yk_doc_store(dbh, "json", context->mode, doc.data(), doc.size(), &id);
+        munit_assert_int(ret, ==, YOKAN_SUCCESS);
+    }
+    query = "{\"where\":{\"ge\":[\"meta.i\",2]},\"select\":[\"meta.i\"]}";
+    std::string expected = "{\"meta.i\":3}";
+    size_t bufsize = expected.size();
+    ret = yk_doc_load_filtered(dbh, "json", mode, 3, query.data(), query.size(),
+                               buffer.data(), &bufsize);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+    munit_assert_long(bufsize, ==, expected.size());
+    munit_assert_memory_equal(bufsize, buffer.data(), expected.data());
+
+    /* document that does not pass the filter */
+    bufsize = buffer.size();
+    ret = yk_doc_load_filtered(dbh, "json", mode, 1, query.data(), query.size(),
+                               buffer.data(), &bufsize);
+    munit_assert_int(ret, ==, YOKAN_ERR_KEY_NOT_FOUND);
+
+    /* buffer too small for the projection */
+    bufsize = expected.size() - 1;
+    ret = yk_doc_load_filtered(dbh, "json", mode, 3, query.data(), query.size(),
+                               buffer.data(), &bufsize);
+    munit_assert_int(ret, ==, YOKAN_ERR_BUFFER_SIZE);
+
+    /* invalid filter */
+    std::string bad_query = "{\"select\":3}";
+    bufsize = buffer.size();
+    ret = yk_doc_load_filtered(dbh, "json", mode, 3, bad_query.data(), bad_query.size(),
+                               buffer.data(), &bufsize);
+    munit_assert_int(ret, ==, YOKAN_ERR_INVALID_FILTER);
+
+    /* collection that does not exist */
+    bufsize = buffer.size();
+    ret = yk_doc_load_filtered(dbh, "efgh", mode, 0, query.data(), query.size(),
+                               buffer.data(), &bufsize);
+    munit_assert_int(ret, ==, YOKAN_ERR_KEY_NOT_FOUND);
+
+    return MUNIT_OK;
+}
+
 static char* no_rdma_params[] = {
     (char*)"true", (char*)"false", (char*)NULL };
 
@@ -261,6 +342,8 @@ static MunitTest test_suite_tests[] = {
         test_coll_load_context_setup, doc_test_common_context_tear_down, MUNIT_TEST_OPTION_NONE, test_params },
     { (char*) "/coll/load_packed", test_coll_load_packed,
         test_coll_load_context_setup, doc_test_common_context_tear_down, MUNIT_TEST_OPTION_NONE, test_params },
+    { (char*) "/coll/load_filtered", test_coll_load_filtered,
+        test_coll_load_context_setup, doc_test_common_context_tear_down, MUNIT_TEST_OPTION_NONE, test_params },
     { NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
 };
 
@@ -179,6 +179,156 @@ static MunitResult test_coll_store_packed(const MunitParameter params[], void* d
     return MUNIT_OK;
 }
 
+static MunitResult test_coll_store_many(const MunitParameter params[], void* data)
+{
+    (void)params;
+    (void)data;
+    struct doc_test_context* context = (struct doc_test_context*)data;
+    yk_database_handle_t dbh = context->dbh;
+    yk_return_t ret;
+
+    int32_t mode = context->mode;
+
+    /* store enough documents for the collection's metadata
+     * to be checkpointed and its reserved ids to be extended */
+    const size_t batch_size = 100;
+    const size_t num_batches = 15;
+    std::string doc = "some document";
+    std::vector<const void*> docs(batch_size, doc.data());
+    std::vector<size_t> doc_sizes(batch_size, doc.size());
+    std::vector<yk_id_t> ids(batch_size);
+
+    for(size_t i = 0; i < num_batches; i++) {
+        ret = yk_doc_store_multi(dbh, "abcd", mode, batch_size,
+                                 docs.data(), doc_sizes.data(), ids.data());
+        SKIP_IF_NOT_IMPLEMENTED(ret);
+        munit_assert_int(ret, ==, YOKAN_SUCCESS);
+        for(size_t j = 0; j < batch_size; j++)
+            munit_assert_long(ids[j], ==, i*batch_size + j);
+    }
+
+    yk_id_t erased[] = { 0, 700, num_batches*batch_size-1 };
+    ret = yk_doc_erase_multi(dbh, "abcd", mode, 3, erased);
+    SKIP_IF_NOT_IMPLEMENTED(ret);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+
+    size_t size = 0;
+    ret = yk_collection_size(dbh, "abcd", mode, &size);
+    SKIP_IF_NOT_IMPLEMENTED(ret);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+    munit_assert_long(size, ==, num_batches*batch_size - 3);
+
+    yk_id_t last_id = 0;
+    ret = yk_collection_last_id(dbh, "abcd", mode, &last_id);
+    SKIP_IF_NOT_IMPLEMENTED(ret);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+    munit_assert_long(last_id, ==, num_batches*batch_size - 1);
+
+    /* ids are not reused after the last document is erased */
+    yk_id_t id;
+    ret = yk_doc_store(dbh, "abcd", mode, doc.data(), doc.size(), &id);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+    munit_assert_long(id, ==, num_batches*batch_size);
+
+    return MUNIT_OK;
+}
+
+/**
+ * @brief Check that a collection whose metadata was not written back
+ * when its database was closed (e.g. after a crash) recovers its size
+ * and does not reissue ids. The unclean state is obtained by copying the
+ * raw key/value pairs of a live database into another provider.
+ */
+static MunitResult test_coll_store_recover(const MunitParameter params[], void* data)
+{
+    (void)params;
+    (void)data;
+    struct doc_test_context* context = (struct doc_test_context*)data;
+    yk_database_handle_t dbh = context->dbh;
+    yk_return_t ret;
+
+    int32_t mode = context->mode;
+
+    /* set backends drop the collection metadata when copied */
+    if(context->backend == "set" || context->backend == "unordered_set")
+        return MUNIT_SKIP;
+
+    /* store past the first checkpoint, so that the metadata
+     * only records the ids allocated up to that checkpoint */
+    const size_t batch_size = 100;
+    const size_t num_batches = 6;
+    std::string doc = "some document";
+    std::vector<const void*> docs(batch_size, doc.data());
+    std::vector<size_t> doc_sizes(batch_size, doc.size());
+    std::vector<yk_id_t> ids(batch_size);
+
+    for(size_t i = 0; i < num_batches; i++) {
+        ret = yk_doc_store_multi(dbh, "abcd", mode, batch_size,
+                                 docs.data(), doc_sizes.data(), ids.data());
+        SKIP_IF_NOT_IMPLEMENTED(ret);
+        munit_assert_int(ret, ==, YOKAN_SUCCESS);
+    }
+
+    /* copy the raw key/value pairs into a new provider */
+    using keyvals = std::vector<std::pair<std::string,std::string>>;
+    keyvals pairs;
+    auto copy = [](void* uargs, size_t, const void* key, size_t ksize,
+                   const void* val, size_t vsize) -> yk_return_t {
+        static_cast<keyvals*>(uargs)->emplace_back(
+            std::string((const char*)key, ksize), std::string((const char*)val, vsize));
+        return YOKAN_SUCCESS;
+    };
+    ret = yk_iter(dbh, YOKAN_MODE_DEFAULT, nullptr, 0, nullptr, 0,
+                  2*num_batches*batch_size, copy, &pairs, nullptr);
+    SKIP_IF_NOT_IMPLEMENTED(ret);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+
+    auto config = make_provider_config("map");
+    struct yk_provider_args args = YOKAN_PROVIDER_ARGS_INIT;
+    yk_provider_t provider;
+    ret = yk_provider_register(context->mid, provider_id+1, config.c_str(), &args, &provider);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+    yk_database_handle_t copy_dbh;
+    ret = yk_database_handle_create(context->client, context->addr,
+                                    provider_id+1, true, &copy_dbh);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+    for(auto& p : pairs) {
+        ret = yk_put(copy_dbh, YOKAN_MODE_DEFAULT, p.first.data(), p.first.size(),
+                     p.second.data(), p.second.size());
+        munit_assert_int(ret, ==, YOKAN_SUCCESS);
+    }
+
+    /* backends that do not store collections as key/value pairs
+     * have nothing to recover */
+    uint8_t exists = 0;
+    ret = yk_collection_exists(copy_dbh, "abcd", mode, &exists);
+    if(ret == YOKAN_SUCCESS && exists) {
+        size_t size = 0;
+        ret = yk_collection_size(copy_dbh, "abcd", mode, &size);
+        munit_assert_int(ret, ==, YOKAN_SUCCESS);
+        munit_assert_long(size, ==, num_batches*batch_size);
+
+        yk_id_t last_id = 0;
+        ret = yk_collection_last_id(copy_dbh, "abcd", mode, &last_id);
+        munit_assert_int(ret, ==, YOKAN_SUCCESS);
+        munit_assert_long(last_id, ==, num_batches*batch_size - 1);
+
+        yk_id_t id;
+        ret = yk_doc_store(copy_dbh, "abcd", mode, doc.data(), doc.size(), &id);
+        munit_assert_int(ret, ==, YOKAN_SUCCESS);
+        munit_assert_long(id, ==, num_batches*batch_size);
+        ret = yk_collection_size(copy_dbh, "abcd", mode, &size);
+        munit_assert_int(ret, ==, YOKAN_SUCCESS);
+        munit_assert_long(size, ==, num_batches*batch_size + 1);
+    }
+
+    yk_database_handle_release(copy_dbh);
+    ret = yk_provider_destroy(provider);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+
+    return MUNIT_OK;
+}
+
 static char* no_rdma_params[] = {
     (char*)"true", (char*)"false", (char*)NULL };
 
@@ -199,6 +349,10 @@ static MunitTest test_suite_tests[] = {
         test_coll_store_context_setup, doc_test_common_context_tear_down, MUNIT_TEST_OPTION_NONE, test_params },
     { (char*) "/coll/store_packed", test_coll_store_packed,
         test_coll_store_context_setup, doc_test_common_context_tear_down, MUNIT_TEST_OPTION_NONE, test_params },
+    { (char*) "/coll/store_many", test_coll_store_many,
+        test_coll_store_context_setup, doc_test_common_context_tear_down, MUNIT_TEST_OPTION_NONE, test_params },
+    { (char*) "/coll/store_recover", test_coll_store_recover,
+        test_coll_store_context_setup, doc_test_common_context_tear_down, MUNIT_TEST_OPTION_NONE, test_params },
     { NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
 };
 
@@ -298,6 +298,83 @@ static MunitResult test_coll_update_packed(const MunitParameter params[], void*
     return MUNIT_OK;
 }
 
+static MunitResult test_coll_update_reserved(const MunitParameter params[], void* data)
+{
+    (void)params;
+    struct doc_test_context* context = (struct doc_test_context*)data;
+    yk_database_handle_t dbh = context->dbh;
+    yk_return_t ret;
+    yk_id_t count = context->reference.size();
+
+    /* reserves two ranges of ids */
+    yk_id_t first1, first2;
+    ret = yk_collection_reserve_ids(dbh, "abcd", context->mode, 10, &first1);
+    SKIP_IF_NOT_IMPLEMENTED(ret);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+    munit_assert_ulong(first1, ==, count);
+    ret = yk_collection_reserve_ids(dbh, "abcd", context->mode, 5, &first2);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+    munit_assert_ulong(first2, ==, count+10);
+
+    /* documents stored afterward get ids past the reserved ranges */
+    yk_id_t id;
+    ret = yk_doc_store(dbh, "abcd", context->mode, "stored", 6, &id);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+    munit_assert_ulong(id, ==, count+15);
+
+    /* fills some of the reserved ids, out of order */
+    std::vector<yk_id_t> ids = { first2+2, first1+9, first1 };
+    std::string packed_docs = "abcdefghi";
+    std::vector<size_t> sizes = { 3, 3, 3 };
+    ret = yk_doc_update_packed(dbh, "abcd", context->mode | YOKAN_MODE_UPDATE_NEW,
+                               ids.size(), ids.data(), packed_docs.data(), sizes.data());
+    SKIP_IF_NOT_IMPLEMENTED(ret);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+
+    char buffer[16];
+    for(size_t i = 0; i < ids.size(); i++) {
+        size_t bufsize = sizeof(buffer);
+        ret = yk_doc_load(dbh, "abcd", context->mode, ids[i], buffer, &bufsize);
+        munit_assert_int(ret, ==, YOKAN_SUCCESS);
+        munit_assert_long(bufsize, ==, 3);
+        munit_assert_memory_equal(3, buffer, packed_docs.data() + 3*i);
+    }
+
+    /* ids that were reserved but not filled behave like erased documents */
+    size_t bufsize = sizeof(buffer);
+    ret = yk_doc_load(dbh, "abcd", context->mode, first1+1, buffer, &bufsize);
+    munit_assert_int(ret, ==, YOKAN_ERR_KEY_NOT_FOUND);
+
+    /* filling a reserved id again does not count it twice */
+    ret = yk_doc_update(dbh, "abcd", context->mode | YOKAN_MODE_UPDATE_NEW,
+                        first1, "jkl", 3);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+
+    size_t new_count;
+    ret = yk_collection_size(dbh, "abcd", context->mode, &new_count);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+    munit_assert_ulong(new_count, ==, count+4);
+    yk_id_t new_last_id;
+    ret = yk_collection_last_id(dbh, "abcd", context->mode, &new_last_id);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+    munit_assert_ulong(new_last_id, ==, count+15);
+
+    /* tries to reserve ids in an invalid collection */
+    ret = yk_collection_reserve_ids(dbh, "efgh", context->mode, 10, &first1);
+    munit_assert_int(ret, ==, YOKAN_ERR_KEY_NOT_FOUND);
+
+    /* tries to reserve no id, or more than the provider allows */
+    ret = yk_collection_reserve_ids(dbh, "abcd", context->mode, 0, &first1);
+    munit_assert_int(ret, ==, YOKAN_ERR_INVALID_ARGS);
+    ret = yk_collection_reserve_ids(dbh, "abcd", context->mode, SIZE_MAX, &first1);
+    munit_assert_int(ret, ==, YOKAN_ERR_INVALID_ARGS);
+    ret = yk_collection_last_id(dbh, "abcd", context->mode, &new_last_id);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+    munit_assert_ulong(new_last_id, ==, count+15);
+
+    return MUNIT_OK;
+}
+
 static char* no_rdma_params[] = {
     (char*)"true", (char*)"false", (char*)NULL };
 
@@ -317,6 +394,8 @@ static MunitTest test_suite_tests[] = {
         test_coll_update_context_setup, doc_test_common_context_tear_down, MUNIT_TEST_OPTION_NONE, test_params },
     { (char*) "/coll/update_packed", test_coll_update_packed,
         test_coll_update_context_setup, doc_test_common_context_tear_down, MUNIT_TEST_OPTION_NONE, test_params },
+    { (char*) "/coll/update_reserved", test_coll_update_reserved,
+        test_coll_update_context_setup, doc_test_common_context_tear_down, MUNIT_TEST_OPTION_NONE, test_params },
     { NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
 };
 
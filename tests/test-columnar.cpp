@@ -0,0 +1,267 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#include <stdio.h>
+#include <margo.h>
+#include <yokan/server.h>
+#include <yokan/client.h>
+#include <yokan/database.h>
+#include <yokan/collection.h>
+#include "available-backends.h"
+#include "munit/munit.h"
+#include <cstring>
+#include <string>
+#include <vector>
+
+/* The columnar backend only accepts documents of the size given by
+ * the schema of their collection, so it is tested on its own rather
+ * than through the generic collection tests. */
+
+struct record {
+    int64_t  time;
+    double   value;
+    uint32_t flags;
+    uint32_t padding;
+};
+
+static_assert(sizeof(record) == 24, "unexpected record layout");
+
+static const char* columnar_config =
+    "{\"database\":{\"type\":\"columnar\",\"config\":{"
+    "\"chunk_size\":8, \"compression\":\"rle\","
+    "\"schema\":{\"record_size\":24,\"fields\":["
+    "{\"name\":\"time\",\"offset\":0,\"size\":8},"
+    "{\"name\":\"value\",\"offset\":8,\"size\":8},"
+    "{\"name\":\"flags\",\"offset\":16,\"size\":4}]}}}}";
+
+static const size_t num_records = 20;
+
+struct columnar_test_context {
+    margo_instance_id    mid;
+    hg_addr_t            addr;
+    yk_client_t          client;
+    yk_provider_t        provider;
+    yk_database_handle_t dbh;
+    int32_t              mode;
+    std::vector<record>  reference;
+};
+
+static const uint16_t provider_id = 42;
+
+static void* columnar_test_context_setup(const MunitParameter params[], void* user_data)
+{
+    (void) user_data;
+    yk_return_t ret;
+    auto context = new columnar_test_context;
+
+    margo_init_info margo_args = MARGO_INIT_INFO_INITIALIZER;
+    margo_args.json_config = "{ \"handle_cache_size\" : 0 }";
+
+    context->mid = margo_init_ext("ofi+tcp", MARGO_SERVER_MODE, &margo_args);
+    munit_assert_not_null(context->mid);
+    margo_set_global_log_level(MARGO_LOG_WARNING);
+    margo_set_log_level(context->mid, MARGO_LOG_WARNING);
+    hg_return_t hret = margo_addr_self(context->mid, &context->addr);
+    munit_assert_int(hret, ==, HG_SUCCESS);
+    struct yk_provider_args args = YOKAN_PROVIDER_ARGS_INIT;
+    ret = yk_provider_register(
+            context->mid, provider_id, columnar_config, &args,
+            &context->provider);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+    ret = yk_client_init(context->mid, &context->client);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+    ret = yk_database_handle_create(context->client,
+            context->addr, provider_id, true, &context->dbh);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+    context->mode = 0;
+    const char* no_rdma = munit_parameters_get(params, "no-rdma");
+    if(no_rdma && strcmp(no_rdma, "true") == 0)
+        context->mode |= YOKAN_MODE_NO_RDMA;
+
+    ret = yk_collection_create(context->dbh, "abcd", context->mode);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+
+    // value is i/5 so that full chunks are run-length encoded
+    for(size_t i = 0; i < num_records; i++) {
+        record r;
+        std::memset(&r, 0, sizeof(r));
+        r.time  = i;
+        r.value = (double)(i/5);
+        r.flags = i % 2;
+        context->reference.push_back(r);
+    }
+    std::vector<size_t>  sizes(num_records, sizeof(record));
+    std::vector<yk_id_t> ids(num_records);
+    ret = yk_doc_store_packed(context->dbh, "abcd", context->mode, num_records,
+                              context->reference.data(), sizes.data(), ids.data());
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+
+    return context;
+}
+
+static void columnar_test_context_tear_down(void* fixture)
+{
+    auto context = static_cast<columnar_test_context*>(fixture);
+    yk_database_handle_release(context->dbh);
+    yk_client_finalize(context->client);
+    margo_addr_free(context->mid, context->addr);
+    yk_provider_destroy(context->provider);
+    margo_finalize(context->mid);
+    delete context;
+}
+
+static MunitResult test_columnar_store_load(const MunitParameter params[], void* data)
+{
+    (void)params;
+    auto context = static_cast<columnar_test_context*>(data);
+    auto dbh  = context->dbh;
+    auto mode = context->mode;
+    yk_return_t ret;
+
+    for(yk_id_t id = 0; id < num_records; id++) {
+        record r;
+        size_t size = sizeof(r);
+        ret = yk_doc_load(dbh, "abcd", mode, id, &r, &size);
+        munit_assert_int(ret, ==, YOKAN_SUCCESS);
+        munit_assert_size(size, ==, sizeof(r));
+        munit_assert_memory_equal(sizeof(r), &r, &context->reference[id]);
+    }
+
+    // documents of another size are rejected
+    yk_id_t id;
+    ret = yk_doc_store(dbh, "abcd", mode, "abc", 3, &id);
+    munit_assert_int(ret, ==, YOKAN_ERR_INVALID_ARGS);
+
+    // updating a record of an encoded chunk
+    record r = context->reference[3];
+    r.value = 42.0;
+    ret = yk_doc_update(dbh, "abcd", mode, 3, &r, sizeof(r));
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+    record loaded;
+    size_t size = sizeof(loaded);
+    ret = yk_doc_load(dbh, "abcd", mode, 3, &loaded, &size);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+    munit_assert_memory_equal(sizeof(r), &r, &loaded);
+    size = sizeof(loaded);
+    ret = yk_doc_load(dbh, "abcd", mode, 4, &loaded, &size);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+    munit_assert_memory_equal(sizeof(r), &context->reference[4], &loaded);
+
+    // erasing a record
+    ret = yk_doc_erase(dbh, "abcd", mode, 5);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+    size = sizeof(loaded);
+    ret = yk_doc_load(dbh, "abcd", mode, 5, &loaded, &size);
+    munit_assert_int(ret, ==, YOKAN_ERR_KEY_NOT_FOUND);
+
+    // reserving ids then filling one of them
+    yk_id_t first_id;
+    ret = yk_collection_reserve_ids(dbh, "abcd", mode, 4, &first_id);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+    munit_assert_long(first_id, ==, num_records);
+    ret = yk_doc_update(dbh, "abcd", mode, first_id+2, &r, sizeof(r));
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+
+    size_t coll_size;
+    ret = yk_collection_size(dbh, "abcd", mode, &coll_size);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+    munit_assert_size(coll_size, ==, num_records);
+    yk_id_t last_id;
+    ret = yk_collection_last_id(dbh, "abcd", mode, &last_id);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+    munit_assert_long(last_id, ==, num_records+3);
+
+    return MUNIT_OK;
+}
+
+struct iter_result {
+    std::vector<yk_id_t>     ids;
+    std::vector<std::string> docs;
+};
+
+static yk_return_t iter_callback(void* u, size_t i, yk_id_t id, const void* doc, size_t docsize) {
+    (void)i;
+    auto result = static_cast<iter_result*>(u);
+    result->ids.push_back(id);
+    result->docs.emplace_back((const char*)doc, docsize);
+    return YOKAN_SUCCESS;
+}
+
+static MunitResult test_columnar_filter(const MunitParameter params[], void* data)
+{
+    (void)params;
+    auto context = static_cast<columnar_test_context*>(data);
+    auto dbh  = context->dbh;
+    auto mode = context->mode|YOKAN_MODE_LIB_FILTER;
+    yk_return_t ret;
+
+    // records with value 2 and odd flags, projected on their time
+    std::string filter =
+        ":record:{\"where\":["
+        "{\"offset\":8,\"type\":\"double\",\"op\":\"eq\",\"value\":2},"
+        "{\"offset\":16,\"type\":\"uint32\",\"op\":\"eq\",\"value\":1}],"
+        "\"select\":[[0,8]]}";
+    iter_result result;
+    ret = yk_doc_iter(dbh, "abcd", mode, 0, filter.data(), filter.size(),
+                      0, iter_callback, &result, nullptr);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+    munit_assert_size(result.ids.size(), ==, 2);
+    munit_assert_long(result.ids[0], ==, 11);
+    munit_assert_long(result.ids[1], ==, 13);
+    for(size_t i = 0; i < result.ids.size(); i++) {
+        munit_assert_size(result.docs[i].size(), ==, sizeof(int64_t));
+        munit_assert_memory_equal(sizeof(int64_t), result.docs[i].data(),
+                                  &context->reference[result.ids[i]].time);
+    }
+
+    // listed documents are not projected
+    std::vector<yk_id_t> ids(4);
+    std::vector<record>  docs(4);
+    std::vector<size_t>  doc_sizes(4);
+    ret = yk_doc_list_packed(dbh, "abcd", mode, 0, filter.data(), filter.size(),
+                             ids.size(), ids.data(), docs.size()*sizeof(record),
+                             docs.data(), doc_sizes.data());
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+    munit_assert_long(ids[0], ==, 11);
+    munit_assert_long(ids[1], ==, 13);
+    munit_assert_long(ids[2], ==, YOKAN_NO_MORE_DOCS);
+    munit_assert_size(doc_sizes[0], ==, sizeof(record));
+    munit_assert_memory_equal(sizeof(record), &docs[1], &context->reference[13]);
+
+    // invalid queries are rejected
+    std::string invalid = ":record:{\"where\":[{\"offset\":8,\"type\":\"complex\"}]}";
+    ret = yk_doc_iter(dbh, "abcd", mode, 0, invalid.data(), invalid.size(),
+                      0, iter_callback, &result, nullptr);
+    munit_assert_int(ret, ==, YOKAN_ERR_INVALID_FILTER);
+
+    return MUNIT_OK;
+}
+
+static char* no_rdma_params[] = {
+    (char*)"true", (char*)"false", NULL
+};
+
+static MunitParameterEnum test_params[] = {
+  { (char*)"no-rdma", (char**)no_rdma_params },
+  { NULL, NULL }
+};
+
+static MunitTest test_suite_tests[] = {
+    { (char*) "/columnar/store_load", test_columnar_store_load,
+        columnar_test_context_setup, columnar_test_context_tear_down,
+        MUNIT_TEST_OPTION_NONE, test_params },
+    { (char*) "/columnar/filter", test_columnar_filter,
+        columnar_test_context_setup, columnar_test_context_tear_down,
+        MUNIT_TEST_OPTION_NONE, test_params },
+    { NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
+};
+
+static const MunitSuite test_suite = {
+    (char*) "/yk/database", test_suite_tests, NULL, 1, MUNIT_SUITE_OPTION_NONE
+};
+
+int main(int argc, char* argv[MUNIT_ARRAY_PARAM(argc + 1)]) {
+    return munit_suite_main(&test_suite, (void*) "yk", argc, argv);
+}
@@ -63,7 +63,23 @@ static void* kv_test_common_context_setup(const MunitParameter params[], void* u
     const char* num_keyvals  = munit_parameters_get(params, "num-items");
     const char* backend_type = munit_parameters_get(params, "backend");
     const char* no_rdma      = munit_parameters_get(params, "no-rdma");
+    const char* batch_split  = munit_parameters_get(params, "batch-split");
+    const char* rpc_window   = munit_parameters_get(params, "back-rpc-window");
     auto provider_config     = make_provider_config(backend_type);
+    if(batch_split) {
+        // make the provider split batches into segments of batch_split keys
+        provider_config.pop_back();
+        provider_config += ",\"batch_split\":{\"threshold\":";
+        provider_config += batch_split;
+        provider_config += "}}";
+    }
+    if(rpc_window) {
+        // let the provider keep up to rpc_window back-RPCs in flight
+        provider_config.pop_back();
+        provider_config += ",\"back_rpc_window\":";
+        provider_config += rpc_window;
+        provider_config += "}";
+    }
     if(min_key_size) g_min_key_size = std::atol(min_key_size);
     if(max_key_size) g_max_key_size = std::atol(max_key_size);
     if(min_val_size) g_min_val_size = std::atol(min_val_size);
@@ -5,6 +5,7 @@
  */
 #include "test-common-setup.hpp"
 #include <numeric>
+#include <cstring>
 #include <vector>
 #include <array>
 
@@ -57,6 +58,40 @@ static MunitResult test_count(const MunitParameter params[], void* data)
     return MUNIT_OK;
 }
 
+static MunitResult test_stats(const MunitParameter params[], void* data)
+{
+    (void)params;
+    (void)data;
+    struct kv_test_context* context = (struct kv_test_context*)data;
+    yk_database_handle_t dbh = context->dbh;
+    yk_return_t ret;
+
+    size_t count = 0;
+    ret = yk_count(dbh, 0, &count);
+    SKIP_IF_NOT_IMPLEMENTED(ret);
+
+    char* stats = nullptr;
+    ret = yk_get_stats(dbh, &stats);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+    munit_assert_not_null(stats);
+    munit_assert_not_null(strstr(stats, "\"rpcs\""));
+    munit_assert_not_null(strstr(stats, "\"count\""));
+    munit_assert_not_null(strstr(stats, "\"backend\""));
+    munit_assert_not_null(strstr(stats, "\"bulk_cache\""));
+    munit_assert_not_null(strstr(stats, "\"pools\""));
+    free(stats);
+
+    stats = yk_provider_get_stats(context->provider);
+    munit_assert_not_null(stats);
+    munit_assert_not_null(strstr(stats, "\"get_stats\""));
+    free(stats);
+
+    ret = yk_get_stats(dbh, nullptr);
+    munit_assert_int(ret, ==, YOKAN_ERR_INVALID_ARGS);
+
+    return MUNIT_OK;
+}
+
 static MunitParameterEnum test_params[] = {
   { (char*)"backend", (char**)available_backends },
   { (char*)"min-key-size", NULL },
@@ -70,6 +105,8 @@ static MunitParameterEnum test_params[] = {
 static MunitTest test_suite_tests[] = {
     { (char*) "/count", test_count,
         test_get_context_setup, kv_test_common_context_tear_down, MUNIT_TEST_OPTION_NONE, test_params },
+    { (char*) "/stats", test_stats,
+        test_get_context_setup, kv_test_common_context_tear_down, MUNIT_TEST_OPTION_NONE, test_params },
     { NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
 };
 
@@ -0,0 +1,324 @@
+/*
+ * (C) 2021 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#include "test-common-setup.hpp"
+#include <numeric>
+#include <vector>
+#include <cstring>
+#include <iostream>
+#include <map>
+
+inline bool starts_with(const std::string& s, const std::string& prefix) {
+    if(s.size() < prefix.size()) return false;
+    if(prefix.size() == 0) return true;
+    if(std::memcmp(s.data(), prefix.data(), prefix.size()) == 0) return true;
+    return false;
+}
+
+struct cursor_context {
+    kv_test_context*                  base;
+    std::map<std::string,std::string> ordered_ref;
+    std::string                       prefix;
+    size_t                            keys_per_op; // max keys per operation
+};
+
+static void* test_cursor_context_setup(const MunitParameter params[], void* user_data)
+{
+    auto base_context = static_cast<kv_test_context*>(
+        kv_test_common_context_setup(params, user_data));
+
+    auto context = new cursor_context;
+    context->base = base_context;
+
+    context->prefix = munit_parameters_get(params, "prefix");
+    g_max_key_size += context->prefix.size(); // important!
+    const char* keys_per_op_str = munit_parameters_get(params, "keys-per-op");
+    context->keys_per_op = keys_per_op_str ? atol(keys_per_op_str) : 6;
+
+    // modify the key/value pairs in the reference to add a prefix in half of the keys
+    unsigned i = 0;
+    for(auto& p : base_context->reference) {
+        if(i % 2 == 0) {
+            context->ordered_ref[context->prefix + p.first] = p.second;
+        } else {
+            context->ordered_ref[p.first] = p.second;
+        }
+        i += 1;
+    }
+    base_context->reference.clear();
+
+    auto count = context->ordered_ref.size();
+    std::vector<const void*> kptrs;
+    std::vector<size_t>      ksizes;
+    std::vector<const void*> vptrs;
+    std::vector<size_t>      vsizes;
+
+    for(auto& p : context->ordered_ref) {
+        kptrs.push_back(p.first.data());
+        ksizes.push_back(p.first.size());
+        vptrs.push_back(p.second.data());
+        vsizes.push_back(p.second.size());
+    }
+
+    yk_put_multi(base_context->dbh, context->base->mode, count,
+                  kptrs.data(), ksizes.data(),
+                  vptrs.data(), vsizes.data());
+    return context;
+}
+
+static void test_cursor_context_tear_down(void* user_data)
+{
+    auto context = static_cast<cursor_context*>(user_data);
+    kv_test_common_context_tear_down(context->base);
+    delete context;
+}
+
+static MunitResult test_cursor(const MunitParameter params[], void* data)
+{
+    (void)params;
+    auto context = static_cast<cursor_context*>(data);
+    yk_database_handle_t dbh = context->base->dbh;
+    yk_return_t ret;
+
+    if(context->base->backend == "unqlite") return MUNIT_SKIP;
+
+    auto count = context->keys_per_op;
+    std::vector<size_t> packed_ksizes(count);
+    std::vector<size_t> packed_vsizes(count);
+    std::vector<char> packed_keys(count*g_max_key_size);
+    std::vector<char> packed_vals(count*g_max_val_size);
+    std::vector<std::string> expected_keys;
+    std::vector<std::string> expected_vals;
+
+    for(auto& p : context->ordered_ref) {
+        if(starts_with(p.first, context->prefix)) {
+            expected_keys.push_back(p.first);
+            expected_vals.push_back(p.second);
+        }
+    }
+
+    std::string prefix = context->prefix;
+
+    // invalid cases
+    yk_cursor_id_t cursor;
+    if(prefix.size() > 0) {
+        ret = yk_cursor_open(dbh, context->base->mode,
+                nullptr, 0, nullptr, prefix.size(), &cursor);
+        munit_assert_int(ret, ==, YOKAN_ERR_INVALID_ARGS);
+    }
+    ret = yk_cursor_open(dbh, context->base->mode,
+            nullptr, 0, prefix.data(), prefix.size(), nullptr);
+    munit_assert_int(ret, ==, YOKAN_ERR_INVALID_ARGS);
+
+    // correct case
+    ret = yk_cursor_open(dbh, context->base->mode,
+            nullptr, 0, prefix.data(), prefix.size(), &cursor);
+    SKIP_IF_NOT_IMPLEMENTED(ret);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+
+    bool done = false;
+    unsigned i = 0;
+    while(!done) {
+        ret = yk_cursor_next_packed(dbh, cursor, count,
+                packed_keys.data(), packed_keys.size(), packed_ksizes.data(),
+                packed_vals.data(), packed_vals.size(), packed_vsizes.data(),
+                &done);
+        munit_assert_int(ret, ==, YOKAN_SUCCESS);
+
+        size_t key_offset = 0;
+        size_t val_offset = 0;
+        for(unsigned j = 0; j < count; j++) {
+            if(i+j < expected_keys.size()) {
+                auto& exp_key = expected_keys[i+j];
+                auto& exp_val = expected_vals[i+j];
+                munit_assert_long(packed_ksizes[j], ==, exp_key.size());
+                munit_assert_memory_equal(packed_ksizes[j],
+                    packed_keys.data()+key_offset, exp_key.data());
+                munit_assert_long(packed_vsizes[j], ==, exp_val.size());
+                munit_assert_memory_equal(packed_vsizes[j],
+                    packed_vals.data()+val_offset, exp_val.data());
+                key_offset += exp_key.size();
+                val_offset += exp_val.size();
+            } else {
+                munit_assert_long(packed_ksizes[j], ==, YOKAN_NO_MORE_KEYS);
+                munit_assert_long(packed_vsizes[j], ==, YOKAN_NO_MORE_KEYS);
+                munit_assert_true(done);
+            }
+        }
+        i += count;
+        munit_assert_true(done || i <= expected_keys.size());
+    }
+
+    ret = yk_cursor_close(dbh, cursor);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_cursor_keys_only(const MunitParameter params[], void* data)
+{
+    (void)params;
+    auto context = static_cast<cursor_context*>(data);
+    yk_database_handle_t dbh = context->base->dbh;
+    yk_return_t ret;
+
+    if(context->base->backend == "unqlite") return MUNIT_SKIP;
+
+    auto count = context->keys_per_op;
+    std::vector<size_t> packed_ksizes(count);
+    std::vector<char> packed_keys(count*g_max_key_size);
+    std::vector<std::string> expected_keys;
+
+    for(auto& p : context->ordered_ref) {
+        if(starts_with(p.first, context->prefix))
+            expected_keys.push_back(p.first);
+    }
+
+    std::string prefix = context->prefix;
+
+    yk_cursor_id_t cursor;
+    ret = yk_cursor_open(dbh, context->base->mode,
+            nullptr, 0, prefix.data(), prefix.size(), &cursor);
+    SKIP_IF_NOT_IMPLEMENTED(ret);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+
+    std::vector<std::string> received_keys;
+    bool done = false;
+    while(!done) {
+        ret = yk_cursor_next_packed(dbh, cursor, count,
+                packed_keys.data(), packed_keys.size(), packed_ksizes.data(),
+                nullptr, 0, nullptr, &done);
+        munit_assert_int(ret, ==, YOKAN_SUCCESS);
+        size_t key_offset = 0;
+        for(unsigned j = 0; j < count; j++) {
+            if(packed_ksizes[j] == YOKAN_NO_MORE_KEYS) break;
+            received_keys.emplace_back(packed_keys.data()+key_offset, packed_ksizes[j]);
+            key_offset += packed_ksizes[j];
+        }
+    }
+    munit_assert_true(received_keys == expected_keys);
+
+    ret = yk_cursor_close(dbh, cursor);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_cursor_too_small(const MunitParameter params[], void* data)
+{
+    (void)params;
+    auto context = static_cast<cursor_context*>(data);
+    yk_database_handle_t dbh = context->base->dbh;
+    yk_return_t ret;
+
+    if(context->base->backend == "unqlite") return MUNIT_SKIP;
+
+    std::vector<std::string> expected_keys;
+    for(auto& p : context->ordered_ref) {
+        if(starts_with(p.first, context->prefix))
+            expected_keys.push_back(p.first);
+    }
+    if(expected_keys.empty()) return MUNIT_SKIP;
+
+    std::string prefix = context->prefix;
+
+    yk_cursor_id_t cursor;
+    ret = yk_cursor_open(dbh, context->base->mode,
+            nullptr, 0, prefix.data(), prefix.size(), &cursor);
+    SKIP_IF_NOT_IMPLEMENTED(ret);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+
+    // a buffer too small for the first key does not consume it
+    std::vector<size_t> ksizes(2);
+    std::vector<char> keys(expected_keys[0].size() - 1);
+    bool done = false;
+    ret = yk_cursor_next_packed(dbh, cursor, 2,
+            keys.data(), keys.size(), ksizes.data(),
+            nullptr, 0, nullptr, &done);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+    munit_assert_false(done);
+    munit_assert_long(ksizes[0], ==, YOKAN_SIZE_TOO_SMALL);
+    munit_assert_long(ksizes[1], ==, YOKAN_SIZE_TOO_SMALL);
+
+    keys.resize(expected_keys[0].size());
+    ret = yk_cursor_next_packed(dbh, cursor, 1,
+            keys.data(), keys.size(), ksizes.data(),
+            nullptr, 0, nullptr, &done);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+    munit_assert_long(ksizes[0], ==, expected_keys[0].size());
+    munit_assert_memory_equal(ksizes[0], keys.data(), expected_keys[0].data());
+
+    ret = yk_cursor_close(dbh, cursor);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_cursor_close(const MunitParameter params[], void* data)
+{
+    (void)params;
+    auto context = static_cast<cursor_context*>(data);
+    yk_database_handle_t dbh = context->base->dbh;
+    yk_return_t ret;
+
+    if(context->base->backend == "unqlite") return MUNIT_SKIP;
+
+    yk_cursor_id_t cursor;
+    ret = yk_cursor_open(dbh, context->base->mode,
+            nullptr, 0, nullptr, 0, &cursor);
+    SKIP_IF_NOT_IMPLEMENTED(ret);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+
+    ret = yk_cursor_close(dbh, cursor);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+
+    // the cursor does not exist anymore
+    std::vector<size_t> ksizes(1);
+    std::vector<char> keys(g_max_key_size);
+    ret = yk_cursor_next_packed(dbh, cursor, 1,
+            keys.data(), keys.size(), ksizes.data(),
+            nullptr, 0, nullptr, nullptr);
+    munit_assert_int(ret, ==, YOKAN_ERR_EXPIRED);
+    ret = yk_cursor_close(dbh, cursor);
+    munit_assert_int(ret, ==, YOKAN_ERR_EXPIRED);
+
+    return MUNIT_OK;
+}
+
+static char* prefix_params[] = {
+    (char*)"", (char*)"matt", NULL
+};
+
+static MunitParameterEnum test_params[] = {
+  { (char*)"backend", (char**)available_backends },
+  { (char*)"prefix", prefix_params },
+  { (char*)"min-key-size", NULL },
+  { (char*)"max-key-size", NULL },
+  { (char*)"min-val-size", NULL },
+  { (char*)"max-val-size", NULL },
+  { (char*)"num-items", NULL },
+  { (char*)"keys-per-op", NULL },
+  { NULL, NULL }
+};
+
+static MunitTest test_suite_tests[] = {
+    { (char*) "/cursor", test_cursor,
+        test_cursor_context_setup, test_cursor_context_tear_down, MUNIT_TEST_OPTION_NONE, test_params },
+    { (char*) "/cursor/keys_only", test_cursor_keys_only,
+        test_cursor_context_setup, test_cursor_context_tear_down, MUNIT_TEST_OPTION_NONE, test_params },
+    { (char*) "/cursor/too_small", test_cursor_too_small,
+        test_cursor_context_setup, test_cursor_context_tear_down, MUNIT_TEST_OPTION_NONE, test_params },
+    { (char*) "/cursor/close", test_cursor_close,
+        test_cursor_context_setup, test_cursor_context_tear_down, MUNIT_TEST_OPTION_NONE, test_params },
+    { NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
+};
+
+static const MunitSuite test_suite = {
+    (char*) "/yk/database", test_suite_tests, NULL, 1, MUNIT_SUITE_OPTION_NONE
+};
+
+int main(int argc, char* argv[MUNIT_ARRAY_PARAM(argc + 1)]) {
+    return munit_suite_main(&test_suite, (void*) "yk", argc, argv);
+}
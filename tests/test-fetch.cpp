@@ -710,6 +710,99 @@ static MunitResult test_fetch_bulk(const MunitParameter params[], void* data)
     return MUNIT_OK;
 }
 
+/**
+ * @brief Check that fetch_multi and fetch_packed deliver every key/value
+ * pair to the callback with the right index when the provider keeps
+ * several back-RPCs in flight. Callbacks may then run concurrently and
+ * in any order, so results are stored at the index they are given.
+ * Using a batch size smaller than the number of keys also checks that
+ * each batch passes its own keys to the callbacks.
+ */
+static MunitResult test_fetch_window(const MunitParameter params[], void* data)
+{
+    (void)params;
+    (void)data;
+    struct kv_test_context* context = (struct kv_test_context*)data;
+    yk_database_handle_t dbh = context->dbh;
+    yk_return_t ret;
+
+    const char* use_pool_str   = munit_parameters_get(params, "use-pool");
+    const char* batch_size_str = munit_parameters_get(params, "batch-size");
+
+    yk_fetch_options_t options;
+    if(strcmp(use_pool_str, "true") == 0)
+        margo_get_progress_pool(context->mid, &options.pool);
+    else
+        options.pool = ABT_POOL_NULL;
+    options.batch_size = atol(batch_size_str);
+
+    auto count = context->reference.size();
+    std::vector<std::string> keys;
+    std::vector<const void*> kptrs;
+    std::vector<size_t>      ksizes;
+    std::string              packed_keys;
+
+    keys.reserve(count);
+    kptrs.reserve(count);
+    ksizes.reserve(count);
+
+    for(auto& p : context->reference) {
+        keys.push_back(p.first);
+        kptrs.push_back(p.first.data());
+        ksizes.push_back(p.first.size());
+        packed_keys += p.first;
+    }
+
+    struct func_args {
+        std::vector<std::string> recv_keys;
+        std::vector<std::string> recv_values;
+        std::vector<int>         calls;
+    };
+
+    auto func = [](void* uargs, size_t i,
+                   const void* kdata, size_t ksize,
+                   const void* vdata, size_t vsize) {
+        auto args = (func_args*)uargs;
+        munit_assert_size(i, <, args->calls.size());
+        munit_assert_size(vsize, <=, YOKAN_LAST_VALID_SIZE);
+        args->calls[i] += 1;
+        args->recv_keys[i].assign((const char*)kdata, ksize);
+        args->recv_values[i].assign((const char*)vdata, vsize);
+        return YOKAN_SUCCESS;
+    };
+
+    for(int packed = 0; packed < 2; packed++) {
+        func_args args;
+        args.recv_keys.resize(count);
+        args.recv_values.resize(count);
+        args.calls.resize(count, 0);
+
+        if(packed)
+            ret = yk_fetch_packed(dbh, context->mode, count,
+                                  packed_keys.data(), ksizes.data(),
+                                  func, &args, &options);
+        else
+            ret = yk_fetch_multi(dbh, context->mode, count,
+                                 kptrs.data(), ksizes.data(),
+                                 func, &args, &options);
+        SKIP_IF_NOT_IMPLEMENTED(ret);
+        munit_assert_int(ret, ==, YOKAN_SUCCESS);
+
+        for(size_t i = 0; i < count; i++) {
+            munit_assert_int(args.calls[i], ==, 1);
+            munit_assert_size(args.recv_keys[i].size(), ==, keys[i].size());
+            munit_assert_memory_equal(keys[i].size(),
+                args.recv_keys[i].data(), keys[i].data());
+            auto& val = context->reference[keys[i]];
+            munit_assert_size(args.recv_values[i].size(), ==, val.size());
+            munit_assert_memory_equal(val.size(),
+                args.recv_values[i].data(), val.data());
+        }
+    }
+
+    return MUNIT_OK;
+}
+
 static char* true_false_params[] = {
     (char*)"true", (char*)"false", (char*)NULL };
 
@@ -729,6 +822,26 @@ static MunitParameterEnum test_multi_params[] = {
   { NULL, NULL }
 };
 
+static char* window_batch_size_params[] = {
+    (char*)"1", (char*)"5", (char*)NULL };
+
+static char* back_rpc_window_params[] = {
+    (char*)"4", (char*)NULL };
+
+static MunitParameterEnum test_window_params[] = {
+  { (char*)"backend", (char**)available_backends },
+  { (char*)"no-rdma", (char**)true_false_params },
+  { (char*)"batch-size", (char**)window_batch_size_params },
+  { (char*)"back-rpc-window", (char**)back_rpc_window_params },
+  { (char*)"use-pool", (char**)true_false_params },
+  { (char*)"min-key-size", NULL },
+  { (char*)"max-key-size", NULL },
+  { (char*)"min-val-size", NULL },
+  { (char*)"max-val-size", NULL },
+  { (char*)"num-items", NULL },
+  { NULL, NULL }
+};
+
 static MunitParameterEnum test_default_params[] = {
   { (char*)"backend", (char**)available_backends },
   { (char*)"no-rdma", (char**)true_false_params },
@@ -761,6 +874,8 @@ static MunitTest test_suite_tests[] = {
         test_fetch_context_setup, kv_test_common_context_tear_down, MUNIT_TEST_OPTION_NONE, test_multi_params },
     { (char*) "/fetch_bulk", test_fetch_bulk,
         test_fetch_context_setup, kv_test_common_context_tear_down, MUNIT_TEST_OPTION_NONE, test_multi_params },
+    { (char*) "/fetch/window", test_fetch_window,
+        test_fetch_context_setup, kv_test_common_context_tear_down, MUNIT_TEST_OPTION_NONE, test_window_params },
     { NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
 };
 
@@ -765,9 +765,13 @@ static MunitResult test_get_bulk(const MunitParameter params[], void* data)
 static char* no_rdma_params[] = {
     (char*)"true", (char*)"false", (char*)NULL };
 
+static char* batch_split_params[] = {
+    (char*)"0", (char*)"16", (char*)NULL };
+
 static MunitParameterEnum test_params[] = {
   { (char*)"backend", (char**)available_backends },
   { (char*)"no-rdma", (char**)no_rdma_params },
+  { (char*)"batch-split", (char**)batch_split_params },
   { (char*)"min-key-size", NULL },
   { (char*)"max-key-size", NULL },
   { (char*)"min-val-size", NULL },
@@ -254,6 +254,77 @@ static MunitResult test_iter_custom_filter(const MunitParameter params[], void*
     return MUNIT_OK;
 }
 
+/**
+ * @brief Check that iter delivers every key/value pair to the callback
+ * with the right index when the provider keeps several back-RPCs in
+ * flight. Callbacks may then run concurrently and in any order, so
+ * results are stored at the index they are given.
+ */
+static MunitResult test_iter_window(const MunitParameter params[], void* data)
+{
+    (void)params;
+    (void)data;
+    auto context = static_cast<iter_context*>(data);
+    yk_database_handle_t dbh = context->base->dbh;
+    yk_return_t ret;
+
+    std::vector<std::string> expected_keys;
+    std::vector<std::string> expected_vals;
+
+    for(auto& p : context->ordered_ref) {
+        expected_keys.push_back(p.first);
+        expected_vals.push_back(p.second);
+    }
+
+    struct iter_context {
+        std::vector<std::string> recv_key;
+        std::vector<std::string> recv_val;
+        std::vector<int>         calls;
+    };
+
+    auto func = [](void* u, size_t i, const void* key, size_t ksize, const void* val, size_t vsize) -> yk_return_t {
+        auto ctx = (iter_context*)u;
+        munit_assert_size(i, <, ctx->calls.size());
+        ctx->calls[i] += 1;
+        ctx->recv_key[i].assign((const char*)key, ksize);
+        ctx->recv_val[i].assign((const char*)val, vsize);
+        return YOKAN_SUCCESS;
+    };
+
+    iter_context result;
+    result.recv_key.resize(expected_keys.size());
+    result.recv_val.resize(expected_keys.size());
+    result.calls.resize(expected_keys.size(), 0);
+
+    yk_iter_options_t options;
+    options.batch_size = atol(munit_parameters_get(params, "batch-size"));
+    if(to_bool(munit_parameters_get(params, "use-pool"))) {
+        margo_get_progress_pool(context->base->mid, &options.pool);
+    } else {
+        options.pool = ABT_POOL_NULL;
+    }
+    options.ignore_values = false;
+
+    ret = yk_iter(dbh, context->base->mode, nullptr, 0, nullptr, 0,
+                  0, func, &result, &options);
+    SKIP_IF_NOT_IMPLEMENTED(ret);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+
+    for(unsigned i=0; i < expected_keys.size(); ++i) {
+        auto& k_ref = expected_keys[i];
+        auto& v_ref = expected_vals[i];
+        auto& k = result.recv_key[i];
+        auto& v = result.recv_val[i];
+        munit_assert_int(result.calls[i], ==, 1);
+        munit_assert_long(k.size(), ==, k_ref.size());
+        munit_assert_memory_equal(k.size(), k.data(), k_ref.data());
+        munit_assert_long(v.size(), ==, v_ref.size());
+        munit_assert_memory_equal(v.size(), v.data(), v_ref.data());
+    }
+
+    return MUNIT_OK;
+}
+
 static char* true_false_params[] = {
     (char*)"true", (char*)"false", NULL
 };
@@ -268,6 +339,26 @@ static char* batch_size_params[] = {
 static char* keys_per_op_params[] = {
     (char*)"0", (char*)"12", (char*)NULL };
 
+static char* window_batch_size_params[] = {
+    (char*)"1", (char*)"5", (char*)NULL };
+
+static char* back_rpc_window_params[] = {
+    (char*)"4", (char*)NULL };
+
+static MunitParameterEnum test_window_params[] = {
+  { (char*)"backend", (char**)available_backends },
+  { (char*)"no-rdma", (char**)true_false_params },
+  { (char*)"batch-size", (char**)window_batch_size_params },
+  { (char*)"back-rpc-window", (char**)back_rpc_window_params },
+  { (char*)"use-pool", (char**)true_false_params },
+  { (char*)"min-key-size", NULL },
+  { (char*)"max-key-size", NULL },
+  { (char*)"min-val-size", NULL },
+  { (char*)"max-val-size", NULL },
+  { (char*)"num-items", NULL },
+  { NULL, NULL }
+};
+
 static MunitParameterEnum test_params[] = {
   { (char*)"backend", (char**)available_backends },
   { (char*)"no-rdma", (char**)true_false_params },
@@ -306,6 +397,8 @@ static MunitTest test_suite_tests[] = {
         test_iter_context_setup, test_iter_context_tear_down, MUNIT_TEST_OPTION_NONE, test_params_with_prefix },
     { (char*) "/iter/custom_filter", test_iter_custom_filter,
         test_iter_context_setup, test_iter_context_tear_down, MUNIT_TEST_OPTION_NONE, test_params },
+    { (char*) "/iter/window", test_iter_window,
+        test_iter_context_setup, test_iter_context_tear_down, MUNIT_TEST_OPTION_NONE, test_window_params },
     { NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
 };
 
@@ -629,6 +629,101 @@ static MunitResult test_custom_filter(const MunitParameter params[], void* data)
 }
 
 
+static MunitResult check_list_keys_budgeted(list_keys_context* context,
+                                            size_t count, uint64_t max_examined)
+{
+    yk_database_handle_t dbh = context->base->dbh;
+    yk_return_t ret;
+
+    if(context->base->backend == "unqlite") return MUNIT_SKIP;
+
+    std::vector<size_t> packed_ksizes(count);
+    std::vector<char> packed_keys(count*g_max_key_size);
+    std::vector<std::string> expected_keys;
+    std::vector<std::string> received_keys;
+
+    for(auto& p : context->ordered_ref) {
+        auto& key = p.first;
+        if(check_filter(context->base->mode, key, context->filter)) {
+            expected_keys.push_back(key);
+        }
+    }
+
+    // the resume token makes the start key inclusive by itself
+    int32_t mode = context->base->mode & ~(YOKAN_MODE_INCLUSIVE|YOKAN_MODE_NO_RDMA);
+    std::string filter = context->filter;
+    std::string from_key;
+    std::vector<char> token_buffer(g_max_key_size);
+    yk_resume_token_t token = { token_buffer.data(), token_buffer.size(), 0 };
+    yk_scan_budget_t budget = { max_examined, 0 };
+
+    // a token that cannot hold a key
+    yk_resume_token_t small_token = { token_buffer.data(), 0, 0 };
+    if(!expected_keys.empty()) {
+        ret = yk_list_keys_packed_budgeted(dbh, mode,
+                nullptr, 0, filter.data(), filter.size(),
+                count, packed_keys.data(), packed_keys.size(),
+                packed_ksizes.data(), &budget, &small_token);
+        SKIP_IF_NOT_IMPLEMENTED(ret);
+        if(ret != YOKAN_SUCCESS)
+            munit_assert_int(ret, ==, YOKAN_ERR_BUFFER_SIZE);
+    }
+
+    while(true) {
+        ret = yk_list_keys_packed_budgeted(dbh, mode,
+                from_key.data(), from_key.size(),
+                filter.data(), filter.size(),
+                count, packed_keys.data(), packed_keys.size(),
+                packed_ksizes.data(), &budget, &token);
+        SKIP_IF_NOT_IMPLEMENTED(ret);
+        if(ret != YOKAN_SUCCESS)
+            munit_assert_int(ret, ==, YOKAN_ERR_INCOMPLETE);
+
+        size_t offset = 0;
+        size_t j = 0;
+        for(; j < count && packed_ksizes[j] != YOKAN_NO_MORE_KEYS; j++) {
+            received_keys.emplace_back(packed_keys.data()+offset, packed_ksizes[j]);
+            offset += packed_ksizes[j];
+        }
+        munit_assert_long(j, <=, budget.max_examined);
+
+        if(ret == YOKAN_ERR_INCOMPLETE) {
+            munit_assert_long(token.size, >, 0);
+            continue;
+        }
+        munit_assert_long(token.size, ==, 0);
+        if(j < count) break;
+        from_key = received_keys.back();
+    }
+
+    munit_assert_long(received_keys.size(), ==, expected_keys.size());
+    for(size_t i = 0; i < expected_keys.size(); i++) {
+        munit_assert_long(received_keys[i].size(), ==, expected_keys[i].size());
+        munit_assert_memory_equal(received_keys[i].size(),
+            received_keys[i].data(), expected_keys[i].data());
+    }
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_list_keys_budgeted(const MunitParameter params[], void* data)
+{
+    (void)params;
+    auto context = static_cast<list_keys_context*>(data);
+    return check_list_keys_budgeted(context, context->keys_per_op, 3);
+}
+
+static MunitResult test_list_keys_budgeted_selective(const MunitParameter params[], void* data)
+{
+    (void)params;
+    auto context = static_cast<list_keys_context*>(data);
+    // backends check blocks of up to count candidates at once, so a budget
+    // smaller than the block, with a filter that rejects some of the keys
+    // it allows, must neither drop nor repeat any of the matching keys
+    if(context->filter.empty()) return MUNIT_SKIP;
+    return check_list_keys_budgeted(context, context->ordered_ref.size(), 7);
+}
+
 static char* inclusive_params[] = {
     (char*)"true", (char*)"false", NULL
 };
@@ -665,6 +760,10 @@ static MunitTest test_suite_tests[] = {
         test_list_keys_context_setup, test_list_keys_context_tear_down, MUNIT_TEST_OPTION_NONE, test_params },
     { (char*) "/list_keys_bulk", test_list_keys_bulk,
         test_list_keys_context_setup, test_list_keys_context_tear_down, MUNIT_TEST_OPTION_NONE, test_params },
+    { (char*) "/list_keys_budgeted", test_list_keys_budgeted,
+        test_list_keys_context_setup, test_list_keys_context_tear_down, MUNIT_TEST_OPTION_NONE, test_params },
+    { (char*) "/list_keys_budgeted/selective", test_list_keys_budgeted_selective,
+        test_list_keys_context_setup, test_list_keys_context_tear_down, MUNIT_TEST_OPTION_NONE, test_params },
     { (char*) "/list_custom_filter", test_custom_filter,
         test_list_keys_context_setup, test_list_keys_context_tear_down, MUNIT_TEST_OPTION_NONE, test_params },
     { NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
@@ -5,8 +5,13 @@
  */
 #include <stdio.h>
 #include <sstream>
+#include <fstream>
+#include <map>
+#include <unistd.h>
 #include <margo.h>
 #include <yokan/server.h>
+#include <yokan/client.h>
+#include <yokan/database.h>
 #include <nlohmann/json.hpp>
 #include "available-backends.h"
 #include "munit/munit.h"
@@ -93,6 +98,219 @@ static MunitResult test_provider_config(const MunitParameter params[], void* dat
     ret = yk_provider_destroy(provider);
     munit_assert_int(ret, ==, YOKAN_SUCCESS);
 
+    // per-class pools referring to an unknown pool or operation class
+    auto pools_config = json::parse(good_config);
+    pools_config["pools"] = json::object();
+    pools_config["pools"]["scan"] = "unknown_pool";
+    ret = yk_provider_register(
+            context->mid, provider_id, pools_config.dump().c_str(), &args,
+            &provider);
+    munit_assert_int(ret, ==, YOKAN_ERR_INVALID_CONFIG);
+
+    pools_config["pools"] = json::object();
+    pools_config["pools"]["unknown_class"] = "__primary__";
+    ret = yk_provider_register(
+            context->mid, provider_id, pools_config.dump().c_str(), &args,
+            &provider);
+    munit_assert_int(ret, ==, YOKAN_ERR_INVALID_CONFIG);
+
+    // per-class pools referring to an existing pool
+    pools_config["pools"] = json::object();
+    pools_config["pools"]["scan"] = "__primary__";
+    ret = yk_provider_register(
+            context->mid, provider_id, pools_config.dump().c_str(), &args,
+            &provider);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+
+    ret = yk_provider_destroy(provider);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+
+    // window of in-flight back-RPCs
+    auto window_config = json::parse(good_config);
+    window_config["back_rpc_window"] = 0;
+    ret = yk_provider_register(
+            context->mid, provider_id, window_config.dump().c_str(), &args,
+            &provider);
+    munit_assert_int(ret, ==, YOKAN_ERR_INVALID_CONFIG);
+
+    window_config["back_rpc_window"] = 4;
+    ret = yk_provider_register(
+            context->mid, provider_id, window_config.dump().c_str(), &args,
+            &provider);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+
+    config = yk_provider_get_config(provider);
+    munit_assert_not_null(config);
+    json_config = json::parse(config);
+    free(config);
+    munit_assert_int(json_config["back_rpc_window"].get<int>(), ==, 4);
+    munit_assert_int(json_config["max_reserved_ids"].get<int>(), ==, 1048576);
+    // batches are not split by default
+    munit_assert_int(json_config["batch_split"]["threshold"].get<int>(), ==, 0);
+
+    ret = yk_provider_destroy(provider);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+
+    // splitting of large batches
+    auto split_config = json::parse(good_config);
+    split_config["batch_split"] = json::object();
+    split_config["batch_split"]["max_segments"] = 0;
+    ret = yk_provider_register(
+            context->mid, provider_id, split_config.dump().c_str(), &args,
+            &provider);
+    munit_assert_int(ret, ==, YOKAN_ERR_INVALID_CONFIG);
+
+    split_config["batch_split"]["max_segments"] = 4;
+    split_config["batch_split"]["threshold"] = "abc";
+    ret = yk_provider_register(
+            context->mid, provider_id, split_config.dump().c_str(), &args,
+            &provider);
+    munit_assert_int(ret, ==, YOKAN_ERR_INVALID_CONFIG);
+
+    split_config["batch_split"]["threshold"] = 128;
+    ret = yk_provider_register(
+            context->mid, provider_id, split_config.dump().c_str(), &args,
+            &provider);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+
+    config = yk_provider_get_config(provider);
+    munit_assert_not_null(config);
+    json_config = json::parse(config);
+    free(config);
+    munit_assert_int(json_config["batch_split"]["threshold"].get<int>(), ==, 128);
+    munit_assert_int(json_config["batch_split"]["max_segments"].get<int>(), ==, 4);
+
+    ret = yk_provider_destroy(provider);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+
+    // admission control
+    auto admission_config = json::parse(good_config);
+    admission_config["admission"] = json::object();
+    admission_config["admission"]["queue_timeout"] = -1.0;
+    ret = yk_provider_register(
+            context->mid, provider_id, admission_config.dump().c_str(), &args,
+            &provider);
+    munit_assert_int(ret, ==, YOKAN_ERR_INVALID_CONFIG);
+
+    admission_config["admission"]["queue_timeout"] = 0.5;
+    admission_config["admission"]["max_ops"] = 64;
+    admission_config["admission"]["max_bytes"] = 1048576;
+    ret = yk_provider_register(
+            context->mid, provider_id, admission_config.dump().c_str(), &args,
+            &provider);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+
+    config = yk_provider_get_config(provider);
+    munit_assert_not_null(config);
+    json_config = json::parse(config);
+    free(config);
+    munit_assert_int(json_config["admission"]["max_ops"].get<int>(), ==, 64);
+    munit_assert_int(json_config["admission"]["max_bytes"].get<int>(), ==, 1048576);
+
+    ret = yk_provider_destroy(provider);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+
+    // request tracing
+    auto tracing_config = json::parse(good_config);
+    tracing_config["tracing"] = json::object();
+    tracing_config["tracing"]["sample_rate"] = 2.0;
+    ret = yk_provider_register(
+            context->mid, provider_id, tracing_config.dump().c_str(), &args,
+            &provider);
+    munit_assert_int(ret, ==, YOKAN_ERR_INVALID_CONFIG);
+
+    tracing_config["tracing"]["enabled"] = true;
+    tracing_config["tracing"]["sample_rate"] = 1.0;
+    ret = yk_provider_register(
+            context->mid, provider_id, tracing_config.dump().c_str(), &args,
+            &provider);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+
+    char trace_file[] = "/tmp/yk-test-trace-XXXXXX";
+    int fd = mkstemp(trace_file);
+    munit_assert_int(fd, >=, 0);
+    close(fd);
+    ret = yk_provider_dump_trace(provider, trace_file);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+    {
+        std::ifstream trace_stream(trace_file);
+        auto trace = json::parse(trace_stream);
+        munit_assert(trace.contains("traceEvents"));
+    }
+    remove(trace_file);
+    ret = yk_provider_dump_trace(provider, nullptr);
+    munit_assert_int(ret, ==, YOKAN_ERR_INVALID_ARGS);
+
+    ret = yk_provider_destroy(provider);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+
+    // hot key detection
+    auto hot_keys_config = json::parse(good_config);
+    hot_keys_config["hot_keys"] = json::object();
+    hot_keys_config["hot_keys"]["enabled"] = true;
+    hot_keys_config["hot_keys"]["capacity"] = 0;
+    ret = yk_provider_register(
+            context->mid, provider_id, hot_keys_config.dump().c_str(), &args,
+            &provider);
+    munit_assert_int(ret, ==, YOKAN_ERR_INVALID_CONFIG);
+
+    hot_keys_config["hot_keys"]["capacity"] = 16;
+    hot_keys_config["hot_keys"]["sample_rate"] = 0.0;
+    ret = yk_provider_register(
+            context->mid, provider_id, hot_keys_config.dump().c_str(), &args,
+            &provider);
+    munit_assert_int(ret, ==, YOKAN_ERR_INVALID_CONFIG);
+
+    hot_keys_config["hot_keys"]["sample_rate"] = 1.0;
+    ret = yk_provider_register(
+            context->mid, provider_id, hot_keys_config.dump().c_str(), &args,
+            &provider);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+
+    {
+        char* stats = yk_provider_get_stats(provider);
+        munit_assert_not_null(stats);
+        auto json_stats = json::parse(stats);
+        free(stats);
+        munit_assert(json_stats.contains("hot_keys"));
+        munit_assert(json_stats["hot_keys"]["keys"].is_array());
+        munit_assert(json_stats["hot_keys"]["collections"].is_array());
+    }
+
+    {
+        // a printable key that looks hex-encoded and a binary key
+        // are told apart by the encoding of their entry
+        yk_client_t client = YOKAN_CLIENT_NULL;
+        yk_database_handle_t dbh = YOKAN_DATABASE_HANDLE_NULL;
+        ret = yk_client_init(context->mid, &client);
+        munit_assert_int(ret, ==, YOKAN_SUCCESS);
+        ret = yk_database_handle_create(client, context->addr, provider_id, true, &dbh);
+        munit_assert_int(ret, ==, YOKAN_SUCCESS);
+        yk_return_t ret1 = yk_put(dbh, YOKAN_MODE_DEFAULT, "0x4142", 6, "def", 3);
+        yk_return_t ret2 = yk_put(dbh, YOKAN_MODE_DEFAULT, "\x01\x02", 2, "def", 3);
+        yk_database_handle_release(dbh);
+        yk_client_finalize(client);
+        // some backends (e.g. array and log) do not support put
+        if(ret1 != YOKAN_ERR_OP_UNSUPPORTED && ret2 != YOKAN_ERR_OP_UNSUPPORTED) {
+            munit_assert_int(ret1, ==, YOKAN_SUCCESS);
+            munit_assert_int(ret2, ==, YOKAN_SUCCESS);
+
+            char* stats = yk_provider_get_stats(provider);
+            munit_assert_not_null(stats);
+            auto json_stats = json::parse(stats);
+            free(stats);
+            std::map<std::string, std::string> encodings;
+            for(auto& entry : json_stats["hot_keys"]["keys"])
+                encodings[entry["key"].get<std::string>()] = entry["encoding"].get<std::string>();
+            munit_assert_size(encodings.size(), ==, 2);
+            munit_assert_string_equal(encodings["0x4142"].c_str(), "text");
+            munit_assert_string_equal(encodings["0102"].c_str(), "hex");
+        }
+    }
+
+    ret = yk_provider_destroy(provider);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+
     return MUNIT_OK;
 }
 
@@ -126,6 +344,147 @@ static MunitResult test_provider_register_multi(const MunitParameter params[], v
     return MUNIT_OK;
 }
 
+struct blocked_fetch {
+    yk_database_handle_t dbh;
+    ABT_eventual         entered;
+    ABT_eventual         released;
+    yk_return_t          ret;
+};
+
+static yk_return_t blocking_fetch_callback(void* uargs, size_t, const void*, size_t,
+                                           const void*, size_t)
+{
+    auto fetch = static_cast<blocked_fetch*>(uargs);
+    ABT_eventual_set(fetch->entered, nullptr, 0);
+    ABT_eventual_wait(fetch->released, nullptr);
+    return YOKAN_SUCCESS;
+}
+
+static void blocked_fetch_ult(void* uargs)
+{
+    auto fetch = static_cast<blocked_fetch*>(uargs);
+    fetch->ret = yk_fetch(fetch->dbh, YOKAN_MODE_DEFAULT, "abc", 3,
+                          blocking_fetch_callback, fetch);
+}
+
+/**
+ * @brief Starts a fetch whose callback blocks until release_fetch is
+ * called, so that the provider's only admission slot stays taken.
+ */
+static ABT_thread start_blocked_fetch(margo_instance_id mid, blocked_fetch& fetch)
+{
+    ABT_eventual_create(0, &fetch.entered);
+    ABT_eventual_create(0, &fetch.released);
+    ABT_pool pool;
+    margo_get_handler_pool(mid, &pool);
+    ABT_thread ult;
+    int ret = ABT_thread_create(pool, blocked_fetch_ult, &fetch, ABT_THREAD_ATTR_NULL, &ult);
+    munit_assert_int(ret, ==, ABT_SUCCESS);
+    ABT_eventual_wait(fetch.entered, nullptr);
+    return ult;
+}
+
+static void release_fetch(ABT_thread ult, blocked_fetch& fetch)
+{
+    ABT_bool released = ABT_FALSE;
+    ABT_eventual_test(fetch.released, nullptr, &released);
+    if(!released) ABT_eventual_set(fetch.released, nullptr, 0);
+    ABT_thread_join(ult);
+    ABT_thread_free(&ult);
+    munit_assert_int(fetch.ret, ==, YOKAN_SUCCESS);
+    ABT_eventual_free(&fetch.entered);
+    ABT_eventual_free(&fetch.released);
+}
+
+struct delayed_release {
+    margo_instance_id mid;
+    blocked_fetch*    fetch;
+};
+
+static void delayed_release_ult(void* uargs)
+{
+    auto release = static_cast<delayed_release*>(uargs);
+    margo_thread_sleep(release->mid, 50);
+    ABT_eventual_set(release->fetch->released, nullptr, 0);
+}
+
+/**
+ * @brief Check that a provider admitting a single operation at a time
+ * refuses operations while another one is in flight, that the client
+ * retries refused operations until they are admitted, and that it
+ * reports YOKAN_ERR_BUSY once its retries are exhausted.
+ */
+static MunitResult test_provider_admission(const MunitParameter params[], void* data)
+{
+    (void)params;
+    struct test_context* context = (struct test_context*)data;
+    struct yk_provider_args args = YOKAN_PROVIDER_ARGS_INIT;
+    yk_provider_t provider;
+    yk_client_t client;
+    yk_database_handle_t dbh;
+
+    auto config = json::parse(make_provider_config("map"));
+    config["admission"] = json::object();
+    config["admission"]["max_ops"] = 1;
+    config["admission"]["queue_timeout"] = 0.0;
+    yk_return_t ret = yk_provider_register(
+            context->mid, provider_id, config.dump().c_str(), &args,
+            &provider);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+    ret = yk_client_init(context->mid, &client);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+    ret = yk_database_handle_create(client, context->addr, provider_id, true, &dbh);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+
+    ret = yk_put(dbh, YOKAN_MODE_DEFAULT, "abc", 3, "def", 3);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+
+    char value[3];
+    size_t vsize = sizeof(value);
+
+    // without retries, an operation is refused while the fetch is blocked
+    ret = yk_client_set_retry_policy(client, 0, 0.0, 0.0);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+    blocked_fetch fetch;
+    fetch.dbh = dbh;
+    auto ult = start_blocked_fetch(context->mid, fetch);
+    ret = yk_get(dbh, YOKAN_MODE_DEFAULT, "abc", 3, value, &vsize);
+    munit_assert_int(ret, ==, YOKAN_ERR_BUSY);
+    release_fetch(ult, fetch);
+
+    // with retries, it succeeds once the fetch completes
+    ret = yk_client_set_retry_policy(client, 100, 1.0, 10.0);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+    ult = start_blocked_fetch(context->mid, fetch);
+    delayed_release release{context->mid, &fetch};
+    ABT_pool pool;
+    margo_get_handler_pool(context->mid, &pool);
+    ABT_thread release_ult;
+    ABT_thread_create(pool, delayed_release_ult, &release, ABT_THREAD_ATTR_NULL, &release_ult);
+    vsize = sizeof(value);
+    ret = yk_get(dbh, YOKAN_MODE_DEFAULT, "abc", 3, value, &vsize);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+    munit_assert_memory_equal(3, value, "def");
+    ABT_thread_join(release_ult);
+    ABT_thread_free(&release_ult);
+    release_fetch(ult, fetch);
+
+    // the error is reported once the retries are exhausted
+    ret = yk_client_set_retry_policy(client, 3, 1.0, 2.0);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+    ult = start_blocked_fetch(context->mid, fetch);
+    ret = yk_get(dbh, YOKAN_MODE_DEFAULT, "abc", 3, value, &vsize);
+    munit_assert_int(ret, ==, YOKAN_ERR_BUSY);
+    release_fetch(ult, fetch);
+
+    yk_database_handle_release(dbh);
+    yk_client_finalize(client);
+    ret = yk_provider_destroy(provider);
+    munit_assert_int(ret, ==, YOKAN_SUCCESS);
+
+    return MUNIT_OK;
+}
+
 static MunitParameterEnum test_params[] = {
   { (char*)"backend", (char**)available_backends },
   { NULL, NULL }
@@ -134,6 +493,8 @@ static MunitParameterEnum test_params[] = {
 static MunitTest test_suite_tests[] = {
     { (char*) "/provider/config", test_provider_config,
         test_context_setup, test_context_tear_down, MUNIT_TEST_OPTION_NONE, test_params },
+    { (char*) "/provider/admission", test_provider_admission,
+        test_context_setup, test_context_tear_down, MUNIT_TEST_OPTION_NONE, NULL },
     { (char*) "/provider/multi", test_provider_register_multi,
         test_context_setup, test_context_tear_down, MUNIT_TEST_OPTION_NONE, test_params },
     { NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
@@ -0,0 +1,255 @@
+/*
+ * (C) The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#include <stdio.h>
+#include <margo.h>
+#include <yokan/common.h>
+#include "../src/client/registration_cache.hpp"
+#include "munit/munit.h"
+#include <array>
+#include <cstring>
+#include <vector>
+
+/* The registration cache is exercised directly rather than through
+ * a client, so that reuse and eviction of bulk handles can be checked. */
+
+using yokan::RegistrationCache;
+
+struct regcache_test_context {
+    margo_instance_id mid;
+};
+
+static void* regcache_test_context_setup(const MunitParameter params[], void* user_data)
+{
+    (void) params;
+    (void) user_data;
+    auto context = new regcache_test_context;
+
+    margo_init_info margo_args = MARGO_INIT_INFO_INITIALIZER;
+    margo_args.json_config = "{ \"handle_cache_size\" : 0 }";
+
+    context->mid = margo_init_ext("ofi+tcp", MARGO_SERVER_MODE, &margo_args);
+    munit_assert_not_null(context->mid);
+    margo_set_global_log_level(MARGO_LOG_WARNING);
+    margo_set_log_level(context->mid, MARGO_LOG_WARNING);
+
+    return context;
+}
+
+static void regcache_test_context_tear_down(void* fixture)
+{
+    auto context = static_cast<regcache_test_context*>(fixture);
+    margo_finalize(context->mid);
+    delete context;
+}
+
+/**
+ * @brief Segments exposed like in a get operation: key sizes (staged
+ * input), value sizes (staged output), keys, and values.
+ */
+struct get_segments {
+    std::array<size_t, 2> ksizes = {{3, 4}};
+    std::array<size_t, 2> vsizes = {{8, 8}};
+    std::array<char, 7>   keys   = {{'a','b','c','d','e','f','g'}};
+    std::array<char, 16>  vals   = {{0}};
+
+    std::array<void*, 4>     ptrs() {
+        return {{ ksizes.data(), vsizes.data(), keys.data(), vals.data() }};
+    }
+    std::array<hg_size_t, 4> sizes() const {
+        return {{ sizeof(ksizes), sizeof(vsizes), keys.size(), vals.size() }};
+    }
+};
+
+static const std::vector<RegistrationCache::Staged> get_staged = {{0, false}, {1, true}};
+
+static hg_bulk_t create(RegistrationCache& cache, get_segments& s)
+{
+    auto ptrs  = s.ptrs();
+    auto sizes = s.sizes();
+    hg_bulk_t bulk = HG_BULK_NULL;
+    hg_return_t hret = cache.create(ptrs.size(), ptrs.data(), sizes.data(),
+                                    HG_BULK_READWRITE, get_staged, &bulk);
+    munit_assert_int(hret, ==, HG_SUCCESS);
+    return bulk;
+}
+
+/**
+ * @brief Returns the local memory exposed by each segment of the bulk.
+ */
+static std::array<void*, 4> access(hg_bulk_t bulk, get_segments& s)
+{
+    auto sizes = s.sizes();
+    hg_size_t total = 0;
+    for(auto size : sizes) total += size;
+    std::array<void*, 4>     seg_ptrs;
+    std::array<hg_size_t, 4> seg_sizes;
+    hg_uint32_t count = 0;
+    hg_return_t hret = margo_bulk_access(bulk, 0, total, HG_BULK_READWRITE,
+                                         4, seg_ptrs.data(), seg_sizes.data(), &count);
+    munit_assert_int(hret, ==, HG_SUCCESS);
+    munit_assert_int(count, ==, 4);
+    return seg_ptrs;
+}
+
+/**
+ * @brief Check that size arrays are copied into the cache's memory
+ * rather than registered in place, and that only the output ones are
+ * copied back on release, including when the cache is disabled while
+ * the bulk handle is in use.
+ */
+static MunitResult test_regcache_staged_copy_back(const MunitParameter params[], void* data)
+{
+    (void)params;
+    auto context = static_cast<regcache_test_context*>(data);
+    RegistrationCache cache(context->mid, 4);
+    get_segments s;
+
+    for(int disable = 0; disable < 2; disable++) {
+        auto bulk = create(cache, s);
+        auto segs = access(bulk, s);
+        munit_assert_ptr_not_equal(segs[0], s.ksizes.data());
+        munit_assert_ptr_not_equal(segs[1], s.vsizes.data());
+        munit_assert_ptr_equal(segs[2], s.keys.data());
+        munit_assert_ptr_equal(segs[3], s.vals.data());
+        munit_assert_memory_equal(sizeof(s.ksizes), segs[0], s.ksizes.data());
+
+        // what the server would write
+        static_cast<size_t*>(segs[0])[0] = 42;
+        static_cast<size_t*>(segs[1])[0] = 5 + disable;
+        static_cast<size_t*>(segs[1])[1] = YOKAN_KEY_NOT_FOUND;
+        if(disable) cache.setCapacity(0);
+        cache.release(bulk);
+
+        munit_assert_long(s.ksizes[0], ==, 3);
+        munit_assert_long(s.vsizes[0], ==, 5 + disable);
+        munit_assert_long(s.vsizes[1], ==, YOKAN_KEY_NOT_FOUND);
+        s.vsizes = {{8, 8}};
+    }
+
+    // a disabled cache registers everything in place
+    auto bulk = create(cache, s);
+    auto segs = access(bulk, s);
+    munit_assert_ptr_equal(segs[0], s.ksizes.data());
+    munit_assert_ptr_equal(segs[1], s.vsizes.data());
+    cache.release(bulk);
+
+    return MUNIT_OK;
+}
+
+/**
+ * @brief Check that the same segments reuse the same bulk handle, and
+ * that the least recently used entry is evicted once the capacity is
+ * exceeded.
+ */
+static MunitResult test_regcache_lru_eviction(const MunitParameter params[], void* data)
+{
+    (void)params;
+    auto context = static_cast<regcache_test_context*>(data);
+    RegistrationCache cache(context->mid, 2);
+    get_segments a, b, c;
+
+    auto bulk_a = create(cache, a);
+    cache.release(bulk_a);
+    // size arrays at other addresses still hit the same entry
+    get_segments other;
+    auto ptrs  = other.ptrs();
+    auto sizes = other.sizes();
+    ptrs[2] = a.keys.data();
+    ptrs[3] = a.vals.data();
+    hg_bulk_t bulk = HG_BULK_NULL;
+    hg_return_t hret = cache.create(ptrs.size(), ptrs.data(), sizes.data(),
+                                    HG_BULK_READWRITE, get_staged, &bulk);
+    munit_assert_int(hret, ==, HG_SUCCESS);
+    munit_assert_ptr_equal(bulk, bulk_a);
+    cache.release(bulk);
+
+    // keep our own reference to b's handle so that its address
+    // cannot be reused by a new handle after it is evicted
+    auto bulk_b = create(cache, b);
+    margo_bulk_ref_incr(bulk_b);
+    cache.release(bulk_b);
+
+    // touch a, so that b is the least recently used entry
+    bulk = create(cache, a);
+    munit_assert_ptr_equal(bulk, bulk_a);
+    cache.release(bulk);
+
+    // c evicts b
+    auto bulk_c = create(cache, c);
+    cache.release(bulk_c);
+
+    bulk = create(cache, a);
+    munit_assert_ptr_equal(bulk, bulk_a);
+    cache.release(bulk);
+    bulk = create(cache, c);
+    munit_assert_ptr_equal(bulk, bulk_c);
+    cache.release(bulk);
+    bulk = create(cache, b);
+    munit_assert_ptr_not_equal(bulk, bulk_b);
+    cache.release(bulk);
+
+    margo_bulk_free(bulk_b);
+    return MUNIT_OK;
+}
+
+/**
+ * @brief Check that invalidating a range evicts the entries exposing
+ * memory in that range, but not entries whose staged size arrays were
+ * in that range (they are not registered in place).
+ */
+static MunitResult test_regcache_invalidate(const MunitParameter params[], void* data)
+{
+    (void)params;
+    auto context = static_cast<regcache_test_context*>(data);
+    RegistrationCache cache(context->mid, 4);
+    get_segments s;
+
+    auto bulk_s = create(cache, s);
+    margo_bulk_ref_incr(bulk_s);
+    cache.release(bulk_s);
+
+    cache.invalidate(s.ksizes.data(), sizeof(s.ksizes));
+    auto bulk = create(cache, s);
+    munit_assert_ptr_equal(bulk, bulk_s);
+    cache.release(bulk);
+
+    cache.invalidate(s.vals.data() + 4, 1);
+    bulk = create(cache, s);
+    munit_assert_ptr_not_equal(bulk, bulk_s);
+    cache.release(bulk);
+
+    // invalidating while in use keeps the handle valid
+    bulk = create(cache, s);
+    auto segs = access(bulk, s);
+    cache.invalidate(s.keys.data(), s.keys.size());
+    static_cast<size_t*>(segs[1])[0] = 1;
+    cache.release(bulk);
+    munit_assert_long(s.vsizes[0], ==, 1);
+
+    margo_bulk_free(bulk_s);
+    return MUNIT_OK;
+}
+
+static MunitTest test_suite_tests[] = {
+    { (char*) "/regcache/staged-copy-back", test_regcache_staged_copy_back,
+        regcache_test_context_setup, regcache_test_context_tear_down,
+        MUNIT_TEST_OPTION_NONE, NULL },
+    { (char*) "/regcache/lru-eviction", test_regcache_lru_eviction,
+        regcache_test_context_setup, regcache_test_context_tear_down,
+        MUNIT_TEST_OPTION_NONE, NULL },
+    { (char*) "/regcache/invalidate", test_regcache_invalidate,
+        regcache_test_context_setup, regcache_test_context_tear_down,
+        MUNIT_TEST_OPTION_NONE, NULL },
+    { NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
+};
+
+static const MunitSuite test_suite = {
+    (char*) "/yk/client", test_suite_tests, NULL, 1, MUNIT_SUITE_OPTION_NONE
+};
+
+int main(int argc, char* argv[MUNIT_ARRAY_PARAM(argc + 1)]) {
+    return munit_suite_main(&test_suite, (void*) "yk", argc, argv);
+}
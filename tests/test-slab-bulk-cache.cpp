@@ -0,0 +1,283 @@
+/*
+ * (C) The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#include <stdio.h>
+#include <margo.h>
+#include <yokan/bulk-cache.h>
+#include "../src/buffer/slab_bulk_cache.hpp"
+#include "munit/munit.h"
+#include <atomic>
+#include <cstring>
+#include <string>
+#include <vector>
+
+/* The slab bulk cache is exercised directly rather than through a
+ * provider, so that its size classes and capacity can be checked. */
+
+static const size_t min_size          = 1024;
+static const size_t max_size          = 8192;
+static const size_t buffers_per_class = 4;
+static const size_t num_classes       = 4; // 1024, 2048, 4096, 8192
+
+struct slab_test_context {
+    margo_instance_id mid;
+    void*             cache;
+};
+
+static void* slab_test_context_setup(const MunitParameter params[], void* user_data)
+{
+    (void) params;
+    (void) user_data;
+    auto context = new slab_test_context;
+
+    margo_init_info margo_args = MARGO_INIT_INFO_INITIALIZER;
+    margo_args.json_config = "{ \"handle_cache_size\" : 0 }";
+
+    context->mid = margo_init_ext("ofi+tcp", MARGO_SERVER_MODE, &margo_args);
+    munit_assert_not_null(context->mid);
+    margo_set_global_log_level(MARGO_LOG_WARNING);
+    margo_set_log_level(context->mid, MARGO_LOG_WARNING);
+
+    std::string config = "{\"min_size\":" + std::to_string(min_size)
+                       + ",\"max_size\":" + std::to_string(max_size)
+                       + ",\"buffers_per_class\":" + std::to_string(buffers_per_class)
+                       + "}";
+    context->cache = yk_slab_bulk_cache.init(context->mid, config.c_str());
+    munit_assert_not_null(context->cache);
+
+    return context;
+}
+
+static void slab_test_context_tear_down(void* fixture)
+{
+    auto context = static_cast<slab_test_context*>(fixture);
+    yk_slab_bulk_cache.finalize(context->cache);
+    margo_finalize(context->mid);
+    delete context;
+}
+
+/**
+ * @brief Check that requests are served from the smallest size class
+ * that fits them, and that larger requests fall back to allocation.
+ */
+static MunitResult test_slab_size_classes(const MunitParameter params[], void* data)
+{
+    (void)params;
+    auto context = static_cast<slab_test_context*>(data);
+    auto cache = context->cache;
+    uint64_t hits, misses;
+
+    struct { size_t requested; size_t expected; } cases[] = {
+        { 1, 1024 }, { 1024, 1024 }, { 1025, 2048 },
+        { 3000, 4096 }, { 5000, 8192 }, { 8192, 8192 }
+    };
+    std::vector<yk_buffer_t> buffers;
+    for(auto& c : cases) {
+        auto buffer = yk_slab_bulk_cache.get(cache, c.requested, HG_BULK_READWRITE);
+        munit_assert_not_null(buffer);
+        munit_assert_size(buffer->size, ==, c.expected);
+        munit_assert_not_null(buffer->data);
+        munit_assert_ptr_not_equal(buffer->bulk, HG_BULK_NULL);
+        buffers.push_back(buffer);
+    }
+    yk_slab_bulk_cache_stats(cache, &hits, &misses);
+    munit_assert_long(hits, ==, 6);
+    munit_assert_long(misses, ==, 0);
+
+    auto large = yk_slab_bulk_cache.get(cache, max_size+1, HG_BULK_READWRITE);
+    munit_assert_not_null(large);
+    munit_assert_size(large->size, >=, max_size+1);
+    yk_slab_bulk_cache_stats(cache, &hits, &misses);
+    munit_assert_long(hits, ==, 6);
+    munit_assert_long(misses, ==, 1);
+    buffers.push_back(large);
+
+    for(auto buffer : buffers)
+        yk_slab_bulk_cache.release(cache, buffer);
+
+    return MUNIT_OK;
+}
+
+/**
+ * @brief Check that released buffers are handed out again, that each
+ * class serves at most buffers_per_class buffers at a time, and that
+ * the cache falls back to allocation when a class is exhausted.
+ */
+static MunitResult test_slab_reuse_and_capacity(const MunitParameter params[], void* data)
+{
+    (void)params;
+    auto context = static_cast<slab_test_context*>(data);
+    auto cache = context->cache;
+    uint64_t hits, misses;
+
+    auto buffer = yk_slab_bulk_cache.get(cache, 100, HG_BULK_READWRITE);
+    munit_assert_not_null(buffer);
+    yk_slab_bulk_cache.release(cache, buffer);
+    auto again = yk_slab_bulk_cache.get(cache, 100, HG_BULK_READWRITE);
+    munit_assert_ptr_equal(again, buffer);
+    yk_slab_bulk_cache.release(cache, again);
+
+    for(int round = 0; round < 2; round++) {
+        std::vector<yk_buffer_t> buffers;
+        for(size_t i = 0; i < buffers_per_class; i++) {
+            auto b = yk_slab_bulk_cache.get(cache, 2048, HG_BULK_READWRITE);
+            munit_assert_not_null(b);
+            munit_assert_size(b->size, ==, 2048);
+            for(auto other : buffers) {
+                munit_assert_ptr_not_equal(b, other);
+                munit_assert_ptr_not_equal(b->data, other->data);
+            }
+            buffers.push_back(b);
+        }
+        yk_slab_bulk_cache_stats(cache, &hits, &misses);
+        munit_assert_long(misses, ==, round);
+
+        // the class is exhausted, so the next request is a fallback
+        auto extra = yk_slab_bulk_cache.get(cache, 2048, HG_BULK_READWRITE);
+        munit_assert_not_null(extra);
+        munit_assert_size(extra->size, >=, 2048);
+        for(auto other : buffers)
+            munit_assert_ptr_not_equal(extra, other);
+        yk_slab_bulk_cache_stats(cache, &hits, &misses);
+        munit_assert_long(misses, ==, round+1);
+
+        yk_slab_bulk_cache.release(cache, extra);
+        for(auto b : buffers)
+            yk_slab_bulk_cache.release(cache, b);
+    }
+    yk_slab_bulk_cache_stats(cache, &hits, &misses);
+    munit_assert_long(hits, ==, 2 + 2*buffers_per_class);
+
+    return MUNIT_OK;
+}
+
+struct slab_worker_args {
+    void*             cache;
+    unsigned          seed;
+    std::atomic<int>* errors;
+    std::atomic<int>* gets;
+};
+
+static const int iterations_per_worker = 500;
+
+static void slab_worker(void* a)
+{
+    auto args = static_cast<slab_worker_args*>(a);
+    unsigned seed = args->seed;
+    for(int i = 0; i < iterations_per_worker; i++) {
+        seed = seed*1103515245 + 12345;
+        size_t size = 1 + (seed >> 8) % max_size;
+        auto buffer = yk_slab_bulk_cache.get(args->cache, size, HG_BULK_READWRITE);
+        *args->gets += 1;
+        if(!buffer || buffer->size < size) {
+            *args->errors += 1;
+            continue;
+        }
+        // a buffer handed out twice would see its pattern overwritten
+        char pattern = (char)(args->seed + i);
+        std::memset(buffer->data, pattern, size);
+        ABT_thread_yield();
+        for(size_t j = 0; j < size; j++) {
+            if(buffer->data[j] != pattern) {
+                *args->errors += 1;
+                break;
+            }
+        }
+        yk_slab_bulk_cache.release(args->cache, buffer);
+    }
+}
+
+/**
+ * @brief Check that buffers are never handed out twice when several
+ * execution streams get and release buffers concurrently, and that all
+ * the buffers of each class are available again afterwards.
+ */
+static MunitResult test_slab_concurrent(const MunitParameter params[], void* data)
+{
+    (void)params;
+    auto context = static_cast<slab_test_context*>(data);
+    auto cache = context->cache;
+    const size_t num_xstreams = 4;
+    const size_t ults_per_xstream = 4;
+    std::atomic<int> errors{0};
+    std::atomic<int> gets{0};
+    int ret;
+
+    std::vector<ABT_xstream>      xstreams(num_xstreams);
+    std::vector<ABT_thread>       ults;
+    std::vector<slab_worker_args> args(num_xstreams*ults_per_xstream);
+
+    for(size_t i = 0; i < num_xstreams; i++) {
+        ret = ABT_xstream_create(ABT_SCHED_NULL, &xstreams[i]);
+        munit_assert_int(ret, ==, ABT_SUCCESS);
+        ABT_pool pool;
+        ret = ABT_xstream_get_main_pools(xstreams[i], 1, &pool);
+        munit_assert_int(ret, ==, ABT_SUCCESS);
+        for(size_t j = 0; j < ults_per_xstream; j++) {
+            auto& a = args[i*ults_per_xstream + j];
+            a.cache  = cache;
+            a.seed   = i*ults_per_xstream + j + 1;
+            a.errors = &errors;
+            a.gets   = &gets;
+            ABT_thread ult;
+            ret = ABT_thread_create(pool, slab_worker, &a, ABT_THREAD_ATTR_NULL, &ult);
+            munit_assert_int(ret, ==, ABT_SUCCESS);
+            ults.push_back(ult);
+        }
+    }
+    ABT_thread_join_many(ults.size(), ults.data());
+    ABT_thread_free_many(ults.size(), ults.data());
+    for(auto& xstream : xstreams) {
+        ABT_xstream_join(xstream);
+        ABT_xstream_free(&xstream);
+    }
+
+    munit_assert_int(errors.load(), ==, 0);
+    uint64_t hits, misses;
+    yk_slab_bulk_cache_stats(cache, &hits, &misses);
+    munit_assert_long(hits + misses, ==, gets.load());
+    munit_assert_long(hits, >, 0);
+
+    // no buffer is stranded on the execution streams that released it,
+    // so each class can serve buffers_per_class buffers again
+    auto misses_before = misses;
+    std::vector<yk_buffer_t> buffers;
+    size_t size = min_size;
+    for(size_t c = 0; c < num_classes; c++, size *= 2) {
+        for(size_t i = 0; i < buffers_per_class; i++) {
+            auto b = yk_slab_bulk_cache.get(cache, size, HG_BULK_READWRITE);
+            munit_assert_not_null(b);
+            munit_assert_size(b->size, ==, size);
+            buffers.push_back(b);
+        }
+    }
+    yk_slab_bulk_cache_stats(cache, &hits, &misses);
+    munit_assert_long(misses, ==, misses_before);
+    for(auto b : buffers)
+        yk_slab_bulk_cache.release(cache, b);
+
+    return MUNIT_OK;
+}
+
+static MunitTest test_suite_tests[] = {
+    { (char*) "/slab/size-classes", test_slab_size_classes,
+        slab_test_context_setup, slab_test_context_tear_down,
+        MUNIT_TEST_OPTION_NONE, NULL },
+    { (char*) "/slab/reuse-and-capacity", test_slab_reuse_and_capacity,
+        slab_test_context_setup, slab_test_context_tear_down,
+        MUNIT_TEST_OPTION_NONE, NULL },
+    { (char*) "/slab/concurrent", test_slab_concurrent,
+        slab_test_context_setup, slab_test_context_tear_down,
+        MUNIT_TEST_OPTION_NONE, NULL },
+    { NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
+};
+
+static const MunitSuite test_suite = {
+    (char*) "/yk/bulk-cache", test_suite_tests, NULL, 1, MUNIT_SUITE_OPTION_NONE
+};
+
+int main(int argc, char* argv[MUNIT_ARRAY_PARAM(argc + 1)]) {
+    return munit_suite_main(&test_suite, (void*) "yk", argc, argv);
+}